@@ -0,0 +1,91 @@
+/*
+ * ADC Sampler — cached readings from a continuous channel scan
+ *
+ * The platform scans every configured ADC channel (J1772 pilot, current
+ * clamp when fitted) in one SAADC sequence every ADC_SAMPLER_PERIOD_MS.
+ * A scan is a burst of ADC_SAMPLER_BURST samplings spread over one 1 kHz
+ * pilot PWM period. Each completed scan is published here from the ADC
+ * callback; adc_read_mv(), adc_get_mv() and adc_get_burst() then answer
+ * from memory instead of running a blocking conversion per call.
+ *
+ * Scans go into two banks that alternate under a sequence counter, so
+ * the ISR never waits for a reader and a reader never sees half of one
+ * scan and half of the next. Each channel keeps an exponential moving
+ * average of its burst medians (weight 1 / 2^filter_shift), alongside
+ * the raw samples of the latest burst.
+ */
+
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <zephyr/sys/atomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADC_SAMPLER_MAX_CHANNELS  4
+#define ADC_SAMPLER_PERIOD_MS     500   /* the app's sensor poll rate */
+#define ADC_SAMPLER_FILTER_SHIFT  1     /* EMA weight 1/2: a J1772 step
+					 * crosses its threshold in 2 scans */
+#define ADC_SAMPLER_STALE_MS      (10 * ADC_SAMPLER_PERIOD_MS)
+#define ADC_SAMPLER_BURST         16    /* samplings per scan */
+#define ADC_SAMPLER_BURST_GAP_US  62    /* 16 x 62 us: one 1 kHz period, so
+					 * a PWM high phase of 6% or more is
+					 * always sampled */
+
+struct adc_sampler_stats {
+	uint32_t scans;         /* scans published since init */
+	uint32_t last_ms;       /* uptime of the latest scan */
+	uint32_t retries;       /* reads that raced a publish and re-copied */
+};
+
+/**
+ * Reset the cache for `channels` channels (clamped to
+ * ADC_SAMPLER_MAX_CHANNELS). No reading is available until the first
+ * adc_sampler_publish().
+ */
+void adc_sampler_init(uint8_t channels, uint8_t filter_shift);
+
+/**
+ * Publish one scan: mv[i] for each channel, taken at now_ms.
+ * Called from the ADC completion callback (ISR); never blocks.
+ */
+void adc_sampler_publish(const int32_t *mv, uint32_t now_ms);
+
+/**
+ * Publish one burst scan of `samplings` samplings (clamped to
+ * ADC_SAMPLER_BURST), laid out as the SAADC buffer is:
+ * mv[s * channels + i] is sampling s of channel i.
+ */
+void adc_sampler_publish_burst(const int32_t *mv, uint8_t samplings, uint32_t now_ms);
+
+/**
+ * Latest filtered reading of a channel.
+ * @param now_ms     current uptime, for the staleness check
+ * @param sample_ms  optional: uptime of the scan the value comes from
+ * @return millivolts; -EINVAL bad channel, -EAGAIN no scan yet,
+ *         -ETIMEDOUT no scan for ADC_SAMPLER_STALE_MS
+ */
+int adc_sampler_get(int channel, uint32_t now_ms, uint32_t *sample_ms);
+
+/**
+ * Raw samples of a channel from the latest scan, oldest first.
+ * @param mv   receives up to `max` samples
+ * @return number of samples copied; errors as adc_sampler_get()
+ */
+int adc_sampler_get_burst(int channel, uint32_t now_ms, int16_t *mv, size_t max,
+			  uint32_t *sample_ms);
+
+bool adc_sampler_running(void);
+
+void adc_sampler_stats(struct adc_sampler_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADC_SAMPLER_H */
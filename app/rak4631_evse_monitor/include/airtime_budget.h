@@ -0,0 +1,89 @@
+/*
+ * Airtime Budget — link-aware uplink rate limiter
+ *
+ * Two limits, both checked before every app uplink:
+ *
+ *  1. A per-link token bucket on frame count. LoRa/FSK keep the old
+ *     one-per-5s pace with a burst of two; BLE (no duty cycle, tiny
+ *     airtime) refills every second and bursts up to five.
+ *
+ *  2. A rolling one-hour airtime window for LoRa/FSK. Each frame's
+ *     time-on-air is estimated from its length and the LoRa spreading
+ *     factor, and the sum over the last hour may not exceed
+ *     AIRTIME_HOURLY_BUDGET_MS (1% duty cycle). Background traffic
+ *     (drain) also leaves AIRTIME_LIVE_RESERVE_MS for live transitions.
+ *
+ * Link is taken from the Sidewalk link mask: any LoRa bit means LoRa,
+ * else FSK, else BLE. An unknown (0) mask is treated as LoRa.
+ */
+
+#ifndef AIRTIME_BUDGET_H
+#define AIRTIME_BUDGET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum airtime_link {
+	AIRTIME_LINK_BLE = 0,   /* SID_LINK_TYPE_1 */
+	AIRTIME_LINK_FSK,       /* SID_LINK_TYPE_2 */
+	AIRTIME_LINK_LORA,      /* SID_LINK_TYPE_3 */
+};
+
+#ifndef AIRTIME_LORA_SF
+#define AIRTIME_LORA_SF            7        /* 125 kHz, CR 4/5 */
+#endif
+#define AIRTIME_FRAME_OVERHEAD     12       /* Sidewalk header + MIC, approx. */
+#define AIRTIME_HOURLY_BUDGET_MS   36000    /* 1% of an hour */
+#define AIRTIME_LIVE_RESERVE_MS    3600     /* kept back from background sends */
+#define AIRTIME_WINDOW_BINS        12       /* 5-minute bins */
+
+/**
+ * Map a Sidewalk link mask to the link whose limits apply.
+ */
+enum airtime_link airtime_link_from_mask(uint32_t link_mask);
+
+/**
+ * Estimated time-on-air of one uplink carrying len app bytes.
+ */
+uint32_t airtime_estimate_us(enum airtime_link link, size_t len);
+
+/**
+ * Reset both limits to full budget.
+ */
+void airtime_budget_init(void);
+
+/**
+ * True if an uplink of len bytes may go out now. Background sends
+ * need a full frame bucket and leave the live reserve untouched.
+ */
+bool airtime_budget_allows(uint32_t link_mask, size_t len, bool background,
+			   uint32_t now_ms);
+
+/**
+ * ms until airtime_budget_allows() could pass for the same uplink: the
+ * frame bucket refilling, or, with the hour spent, the next 5-minute bin
+ * boundary. 0 if it passes now.
+ */
+uint32_t airtime_budget_wait_ms(uint32_t link_mask, size_t len, bool background,
+				uint32_t now_ms);
+
+/**
+ * Account an uplink that was handed to the platform.
+ */
+void airtime_budget_spend(uint32_t link_mask, size_t len, uint32_t now_ms);
+
+/**
+ * LoRa/FSK airtime left in the rolling hour, in ms.
+ */
+uint32_t airtime_budget_remaining_ms(uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIRTIME_BUDGET_H */
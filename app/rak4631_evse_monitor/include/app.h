@@ -12,6 +12,7 @@
 #include <stddef.h>
 
 struct app_callbacks;  /* forward declaration */
+struct platform_gpio_edge;
 
 /**
  * @brief Start Sidewalk end device application.
@@ -54,4 +55,11 @@ int app_set_timer_interval(uint32_t interval_ms);
  */
 void app_route_message(const uint8_t *data, size_t len);
 
+/**
+ * @brief Hand a batch of debounced GPIO edges to the app's on_gpio_edges.
+ *
+ * Called from the platform's edge work item; dropped if no app is loaded.
+ */
+void app_notify_gpio_edges(const struct platform_gpio_edge *edges, size_t count);
+
 #endif /* APP_H */
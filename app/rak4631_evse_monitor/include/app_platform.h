@@ -14,4 +14,45 @@ extern const struct platform_api *platform;
 #define LOG_WRN(...) do { if (platform) platform->log_wrn(__VA_ARGS__); } while (0)
 #define LOG_ERR(...) do { if (platform) platform->log_err(__VA_ARGS__); } while (0)
 
+/* True when the platform provides the persistent record log (API v4+) */
+static inline bool app_platform_has_event_log(void)
+{
+	return platform && platform->version >= PLATFORM_API_VERSION_EVENT_LOG &&
+	       platform->log_append && platform->log_read && platform->log_trim;
+}
+
+/* True when send_msg() returns a msg_id for the send callbacks (API v5+) */
+static inline bool app_platform_has_msg_ids(void)
+{
+	return platform && platform->version >= PLATFORM_API_VERSION_MSG_ID;
+}
+
+/* True when the platform keeps cached ADC readings (API v6+) */
+static inline bool app_platform_has_adc_cache(void)
+{
+	return platform && platform->version >= PLATFORM_API_VERSION_ADC_CACHE &&
+	       platform->adc_get_mv;
+}
+
+/* True when the platform keeps each scan's raw burst (API v7+) */
+static inline bool app_platform_has_adc_burst(void)
+{
+	return platform && platform->version >= PLATFORM_API_VERSION_ADC_BURST &&
+	       platform->adc_get_burst;
+}
+
+/* True when the platform delivers GPIO edges to on_gpio_edges (API v8+) */
+static inline bool app_platform_has_gpio_edges(void)
+{
+	return platform && platform->version >= PLATFORM_API_VERSION_GPIO_EDGE &&
+	       platform->gpio_subscribe;
+}
+
+/* True when the platform plays LED patterns in hardware (API v9+) */
+static inline bool app_platform_has_led_pattern(void)
+{
+	return platform && platform->version >= PLATFORM_API_VERSION_LED_PATTERN &&
+	       platform->led_pattern;
+}
+
 #endif /* APP_PLATFORM_H */
@@ -14,10 +14,69 @@ extern "C" {
 
 struct event_snapshot;   /* forward declaration */
 
+/* Batched drain frame (payload v0x0B) — see app_tx_send_batch() */
+#define APP_TX_MTU_LORA          19   /* LoRa/FSK uplink payload limit */
+#define APP_TX_MTU_BLE           64   /* BLE: larger frames, same encoding */
+#define APP_TX_BATCH_HDR_SIZE    7    /* magic, version, count, base timestamp */
+#define APP_TX_BATCH_ENTRY_SIZE  4    /* +1 when a transition reason follows */
+#define APP_TX_BATCH_MAX \
+	((APP_TX_MTU_BLE - APP_TX_BATCH_HDR_SIZE) / APP_TX_BATCH_ENTRY_SIZE)
+
+/* Live uplink queue — see app_tx_send_evse_data() */
+#define APP_TX_QUEUE_DEPTH       4
+#define APP_TX_PRIO_HEARTBEAT    0
+#define APP_TX_PRIO_TRANSITION   1
+
 void app_tx_init(void);
 void app_tx_set_ready(bool ready);
+
+/**
+ * Send a v0x0A uplink of the current state (a state transition). If the
+ * shared uplink budget is spent, the payload is queued — state and
+ * timestamp as of now — and goes out from app_tx_flush() in the next
+ * window, ahead of heartbeats and drain frames.
+ *
+ * @return 0 if sent or queued, -1 if not ready, negative errno on send failure
+ */
 int app_tx_send_evse_data(void);
+
+/**
+ * Same as app_tx_send_evse_data() at heartbeat priority: coalesced into
+ * any queued uplink, and replaced by a later transition.
+ */
+int app_tx_send_heartbeat(void);
+
+/**
+ * Send the highest-priority queued uplink if budget allows. Call every
+ * poll cycle.
+ * @return 1 if sent, 0 if nothing sent, negative errno on send failure
+ */
+int app_tx_flush(void);
+
+/**
+ * ms until the shared budget lets an uplink out: a queued live uplink, or
+ * a drain frame if `background`. 0 if one may go now; UINT32_MAX while
+ * Sidewalk is not ready.
+ */
+uint32_t app_tx_wait_ms(bool background);
+
+uint8_t app_tx_queue_depth(void);
+uint32_t app_tx_queue_coalesced(void);
+uint32_t app_tx_queue_dropped(void);
+
 int app_tx_send_snapshot(const struct event_snapshot *snap);
+
+/**
+ * Send as many of snaps[0..count) as fit in one v0x0B frame for the
+ * current link MTU. Snapshots must be in buffer (time) order.
+ *
+ * @param msg_id  Optional; set to the platform msg_id of the frame
+ *                (0 on platforms before API v4)
+ * @return number of snapshots sent (>0), 0 if rate-limited or the
+ *         platform reported backpressure, -1 on error
+ */
+int app_tx_send_batch(const struct event_snapshot *snaps, int count,
+		      uint32_t *msg_id);
 void app_tx_set_link_mask(uint32_t link_mask);
 bool app_tx_is_ready(void);
 uint32_t app_tx_get_link_mask(void);
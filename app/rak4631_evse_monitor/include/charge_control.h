@@ -44,6 +44,12 @@ void charge_control_get_state(charge_control_state_t *state);
 bool charge_control_is_allowed(void);
 void charge_control_tick(void);
 
+/**
+ * ms until charge_control_tick() next has work: a delay window starting
+ * or ending, or the auto-resume timer. UINT32_MAX if nothing is pending.
+ */
+uint32_t charge_control_next_ms(void);
+
 /**
  * Get the reason for the most recent charge_allowed transition.
  * Returns TRANSITION_REASON_NONE if no transition has occurred since last read.
@@ -27,6 +27,7 @@ void charge_now_init(void);
 void charge_now_activate(void);
 void charge_now_cancel(void);
 void charge_now_tick(uint8_t j1772_state);  /* check expiry and unplug */
+uint32_t charge_now_next_ms(void);          /* until expiry; UINT32_MAX if inactive */
 bool charge_now_is_active(void);
 
 #ifdef __cplusplus
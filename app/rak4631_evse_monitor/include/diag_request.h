@@ -23,8 +23,8 @@ extern "C" {
 
 /* Diagnostics response payload constants */
 #define DIAG_MAGIC    0xE6
-#define DIAG_VERSION  0x01
-#define DIAG_PAYLOAD_SIZE  15
+#define DIAG_VERSION  0x02
+#define DIAG_PAYLOAD_SIZE  17   /* v0x01 was 15: no airtime budget */
 
 /* State flags byte (byte 11) bit definitions */
 #define DIAG_FLAG_SIDEWALK_READY  0x01
@@ -0,0 +1,95 @@
+/*
+ * Drain In-Flight Table — delivery tracking for event-buffer drain uplinks
+ *
+ * Every drain frame covers a range of event-buffer sequence numbers. The
+ * platform returns a msg_id from send_msg() and later reports it through
+ * on_msg_sent() or on_send_error(). This table maps msg_ids back to their
+ * sequence ranges so a failed frame is retransmitted (with exponential
+ * backoff) and a confirmed frame is never sent again.
+ *
+ * A frame that gets no callback within DRAIN_CONFIRM_TIMEOUT_MS counts as
+ * failed. If its on_msg_sent() still arrives before the range is resent,
+ * the range is confirmed after all. A msg_id of 0 (platform before API
+ * v5, no ids) counts as confirmed.
+ */
+
+#ifndef DRAIN_INFLIGHT_H
+#define DRAIN_INFLIGHT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DRAIN_INFLIGHT_SLOTS       4
+#define DRAIN_RETRY_BASE_MS        10000    /* first retry after 10s */
+#define DRAIN_RETRY_MAX_MS         300000   /* backoff cap: 5 min */
+#define DRAIN_CONFIRM_TIMEOUT_MS   120000   /* 2x Sidewalk TTL (60s) */
+
+/**
+ * Clear all slots and counters.
+ */
+void drain_inflight_init(void);
+
+/**
+ * True if a new (not retransmitted) frame may be sent.
+ */
+bool drain_inflight_can_send(void);
+
+/**
+ * Record a new frame covering sequence numbers [first_seq, first_seq + count).
+ */
+void drain_inflight_sent(uint32_t msg_id, uint32_t first_seq, uint8_t count,
+			 uint32_t now_ms);
+
+/**
+ * on_msg_sent(): the frame was delivered, also if it timed out and is
+ * waiting for retry. Returns false for unknown ids (live uplinks,
+ * diagnostics).
+ */
+bool drain_inflight_confirm(uint32_t msg_id);
+
+/**
+ * on_send_error(): schedule the frame for retransmit with backoff.
+ * Returns false for unknown ids and frames already due for retry.
+ */
+bool drain_inflight_fail(uint32_t msg_id, uint32_t now_ms);
+
+/**
+ * Find the oldest range due for retransmit (also times out unconfirmed
+ * frames). Returns the slot index, or -1 if nothing is due.
+ */
+int drain_inflight_due(uint32_t now_ms, uint32_t *first_seq, uint8_t *count);
+
+/**
+ * ms until drain_inflight_due() has work: a retransmit falling due or an
+ * unconfirmed frame timing out. 0 if one is due now, UINT32_MAX if none.
+ */
+uint32_t drain_inflight_next_ms(uint32_t now_ms);
+
+/**
+ * A due slot was retransmitted as msg_id, carrying `sent` entries from
+ * first_seq on (first_seq may have moved up if older entries were ACKed
+ * meanwhile). Entries that did not fit stay due once this frame confirms.
+ */
+void drain_inflight_resent(int slot, uint32_t msg_id, uint32_t first_seq,
+			   uint8_t sent, uint32_t now_ms);
+
+/**
+ * Drop a due slot whose entries have all left the event buffer.
+ */
+void drain_inflight_drop(int slot);
+
+/** Slots in use (awaiting confirm or retry). */
+uint8_t drain_inflight_count(void);
+
+/** Total retransmits since init. */
+uint32_t drain_inflight_retries(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DRAIN_INFLIGHT_H */
@@ -1,12 +1,20 @@
 /*
  * Event Buffer — ring buffer of timestamped EVSE state snapshots
  *
- * Captures sensor state on every poll cycle (500ms). The cloud ACKs
- * received data via the ACK watermark in TIME_SYNC (0x30). The device
- * trims all entries at or before the watermark. If no ACK arrives,
- * the buffer wraps and overwrites the oldest entries.
+ * Captures sensor state on state change or heartbeat (see event_filter).
+ * The cloud ACKs received data via the ACK watermark in TIME_SYNC (0x30).
+ * The device trims all entries at or before the watermark. If no ACK
+ * arrives, the buffer wraps and overwrites the oldest entries.
  *
- * 50 entries × 12 bytes = 600 bytes from the app's 8KB RAM budget.
+ * Entries are delta-encoded into a 600-byte byte ring: only the oldest
+ * and newest snapshots are held decoded, everything in between is stored
+ * as a header byte plus the fields that changed. A heartbeat with no
+ * change costs 1-3 bytes instead of 12, so the same 600 bytes hold
+ * several hundred entries (capped at EVENT_BUFFER_CAPACITY).
+ *
+ * Not reentrant: adds, trims and cursor reads all run on the system work
+ * queue. A watermark that arrives on the Sidewalk thread is handed over
+ * with event_buffer_trim_later() and applied by event_buffer_trim_pending().
  */
 
 #ifndef EVENT_BUFFER_H
@@ -14,12 +22,14 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <zephyr/sys/atomic.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#define EVENT_BUFFER_CAPACITY  50
+#define EVENT_BUFFER_CAPACITY  500   /* max entries (bounds peek_at walk) */
+#define EVENT_BUFFER_BYTES     600   /* encoded ring size */
 
 /* 12-byte snapshot — naturally aligned, no packing needed */
 struct event_snapshot {
@@ -35,6 +45,22 @@ struct event_snapshot {
 /* charge_flags bit definitions */
 #define EVENT_FLAG_CHARGE_ALLOWED  0x01
 
+/*
+ * Read cursor addressed by sequence number. Every added entry gets the
+ * next sequence number; trims and overflow only move the oldest seq
+ * forward, so a cursor stays valid and never re-reads or skips a
+ * surviving entry. Fields other than seq are a private decode cache
+ * that makes sequential reads O(1).
+ */
+typedef struct {
+	uint32_t seq;                    /* next entry to read */
+	uint32_t cache_seq;              /* entry decoded into cache_snap */
+	struct event_snapshot cache_snap;
+	uint32_t cache_delta;
+	uint16_t cache_pos;              /* ring offset of record cache_seq + 1 */
+	bool     cache_valid;
+} event_buffer_cursor_t;
+
 /**
  * Initialize the event buffer. Clears all entries.
  */
@@ -55,19 +81,69 @@ bool event_buffer_get_latest(struct event_snapshot *out);
 /**
  * Trim all entries with timestamp <= ack_watermark.
  * Called when a TIME_SYNC delivers a new ACK watermark.
+ *
+ * Only advances the tail: O(1) when nothing or everything is trimmed,
+ * otherwise one record decode per trimmed entry. Cursors stay valid.
  */
 void event_buffer_trim(uint32_t ack_watermark);
 
+/**
+ * Request event_buffer_trim(ack_watermark) from another thread. Only the
+ * latest request is kept. Safe from any thread; touches no buffer state.
+ */
+void event_buffer_trim_later(uint32_t ack_watermark);
+
+/**
+ * Apply the trim requested by event_buffer_trim_later(), if any.
+ * @return true if a trim was applied
+ */
+bool event_buffer_trim_pending(void);
+
 /**
  * Current number of entries in the buffer.
  */
-uint8_t event_buffer_count(void);
+uint16_t event_buffer_count(void);
+
+/**
+ * Bytes of the encoded ring currently in use (0..EVENT_BUFFER_BYTES).
+ * The oldest and newest entries are held decoded and not counted.
+ */
+uint16_t event_buffer_bytes_used(void);
 
 /**
  * Peek at a buffered entry by index (0 = oldest, count-1 = newest).
  * Returns false if index >= count or out is NULL.
+ *
+ * Decodes forward from the oldest entry, so cost is O(index).
+ */
+bool event_buffer_peek_at(uint16_t index, struct event_snapshot *out);
+
+/**
+ * Sequence number of the oldest entry (== next seq when empty).
+ */
+uint32_t event_buffer_oldest_seq(void);
+
+/**
+ * Point a cursor at the oldest buffered entry.
+ */
+void event_buffer_cursor_init(event_buffer_cursor_t *cur);
+
+/**
+ * Read the entry at the cursor without advancing it. If that entry was
+ * trimmed or overwritten, the cursor first moves up to the oldest
+ * surviving entry. Returns false when the cursor has caught up.
+ */
+bool event_buffer_cursor_peek(event_buffer_cursor_t *cur, struct event_snapshot *out);
+
+/**
+ * Move the cursor past the entry returned by the last peek.
+ */
+void event_buffer_cursor_advance(event_buffer_cursor_t *cur);
+
+/**
+ * Entries at or after the cursor that have not been read yet.
  */
-bool event_buffer_peek_at(uint8_t index, struct event_snapshot *out);
+uint16_t event_buffer_cursor_remaining(const event_buffer_cursor_t *cur);
 
 /**
  * Get the oldest entry's timestamp. Returns 0 if empty.
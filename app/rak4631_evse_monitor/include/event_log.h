@@ -0,0 +1,85 @@
+/*
+ * Event Log — append-only persistent record log in spare app flash
+ *
+ * Platform service behind platform_api log_append/log_read/log_trim.
+ * Keeps small fixed-size records (the app stores struct event_snapshot)
+ * across brownouts, watchdog resets, and OTA apply reboots.
+ *
+ * The platform knows nothing about the record contents except that the
+ * first 4 bytes (little-endian) are a key — the app uses the snapshot
+ * timestamp — so log_trim() can drop the oldest records up to the
+ * cloud's ACK watermark. What was trimmed is kept as a position in the
+ * log, not a key, so records keyed by a clock that stepped back are not
+ * hidden by an older, higher watermark.
+ *
+ * Layout: EVENT_LOG_FLASH_PAGES pages used as a ring. Each page starts
+ * with a header slot (magic, page sequence, trim watermark) followed by
+ * 16-byte record slots. A record is one aligned 16-byte program with a
+ * CRC, so a power loss mid-append leaves a torn slot that the boot scan
+ * skips. Pages are erased only when the ring rotates onto them.
+ */
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <ota_flash.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Spare pages at the top of the app primary partition, just below the
+ * OTA metadata page. Apps are capped at OTA_STAGING_SIZE (~148KB), so
+ * this never overlaps an image; OTA stale-page cleanup stops here. */
+#define EVENT_LOG_FLASH_ADDR      0xCB000
+#define EVENT_LOG_FLASH_PAGES     4
+#define EVENT_LOG_FLASH_SIZE      (EVENT_LOG_FLASH_PAGES * OTA_FLASH_PAGE_SIZE)
+
+#define EVENT_LOG_RECORD_MAX      12    /* payload bytes per record */
+#define EVENT_LOG_SLOT_SIZE       16    /* payload + kind + len + CRC16 */
+#define EVENT_LOG_SLOTS_PER_PAGE  (OTA_FLASH_PAGE_SIZE / EVENT_LOG_SLOT_SIZE - 1)
+#define EVENT_LOG_CAPACITY        (EVENT_LOG_FLASH_PAGES * EVENT_LOG_SLOTS_PER_PAGE)
+
+/**
+ * Scan flash and rebuild the in-RAM index. Called lazily by the other
+ * functions; safe to call again (e.g. from tests to simulate a reboot).
+ * @return 0 on success, negative errno on flash failure
+ */
+int event_log_init(void);
+
+/**
+ * Append one record (1..EVENT_LOG_RECORD_MAX bytes). When the log is
+ * full, the oldest page of records is dropped.
+ * @return 0 on success, -EINVAL on bad length, negative errno on flash failure
+ */
+int event_log_append(const void *rec, size_t len);
+
+/**
+ * Read the index-th untrimmed record (0 = oldest). Sequential reads are
+ * O(1) flash reads each.
+ * @param rec  Output buffer, len bytes (record is truncated / zero-padded)
+ * @return 0 on success, -ENOENT past the end
+ */
+int event_log_read(uint32_t index, void *rec, size_t len);
+
+/**
+ * Drop the oldest records, up to the first whose key is > key_watermark
+ * or lower than the one before it. How far the log was trimmed is
+ * persisted, so trimmed records stay trimmed after a reboot; records
+ * appended later are never affected.
+ * @return 0 on success, negative errno on flash failure
+ */
+int event_log_trim(uint32_t key_watermark);
+
+/**
+ * Number of untrimmed records.
+ */
+uint32_t event_log_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_LOG_H */
@@ -25,6 +25,31 @@ typedef enum {
 /* Current clamp threshold: >= this value means "charging current flowing" */
 #define CURRENT_ON_THRESHOLD_MA  500
 
+/* How a pilot burst (platform API v7+) is reduced to one reading */
+#define EVSE_PILOT_FILTER_MEDIAN        0
+#define EVSE_PILOT_FILTER_TRIMMED_MEAN  1   /* mean of the middle half */
+
+#define EVSE_PILOT_DEBOUNCE_MAX  15
+
+/*
+ * J1772 classifier tuning. A state is left only once the reading is
+ * hysteresis_mv past the threshold, and a new state is accepted only
+ * after `debounce` consecutive fresh readings agree on it (a fresh
+ * reading is a new platform scan, or any blocking read).
+ */
+struct evse_pilot_config {
+	uint16_t threshold_mv[4];   /* A/B, B/C, C/D, D/E; strictly descending */
+	uint16_t hysteresis_mv;     /* less than half the smallest threshold gap */
+	uint8_t  debounce;          /* 1 (no debounce) .. EVSE_PILOT_DEBOUNCE_MAX */
+	uint8_t  filter;            /* EVSE_PILOT_FILTER_* */
+};
+
+struct evse_pilot_stats {
+	uint32_t transitions;       /* state changes accepted */
+	uint32_t suppressed;        /* candidate states dropped before the debounce */
+};
+
+/* Resets the classifier's accepted state; keeps the tuning */
 int evse_sensors_init(void);
 int evse_pilot_voltage_read(uint16_t *voltage_mv);
 int evse_j1772_state_get(j1772_state_t *state, uint16_t *voltage_mv);
@@ -33,6 +58,15 @@ const char *evse_j1772_state_to_string(j1772_state_t state);
 void evse_sensors_simulate_state(uint8_t j1772_state, uint32_t duration_ms);
 bool evse_sensors_is_simulating(void);
 
+/* True while a new pilot state is waiting out its debounce */
+bool evse_pilot_settling(void);
+
+/* Validate and apply new tuning. Returns 0, or -1 (tuning unchanged) */
+int evse_pilot_config_set(const struct evse_pilot_config *cfg);
+void evse_pilot_config_get(struct evse_pilot_config *cfg);
+void evse_pilot_config_defaults(struct evse_pilot_config *cfg);
+void evse_pilot_stats_get(struct evse_pilot_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
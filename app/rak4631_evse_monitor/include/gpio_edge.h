@@ -0,0 +1,71 @@
+/*
+ * GPIO Edges — debounced input changes for the app's on_gpio_edges
+ *
+ * The platform's GPIO interrupt handler reports every raw edge of a
+ * subscribed pin here, with the pin's level and the uptime. A pin that
+ * has held its level for its debounce time is settled: if it settled on
+ * a new level the change is queued, stamped with the time of the first
+ * edge of the burst; if it bounced back, nothing is queued. The platform
+ * work queue then collects everything queued in one batch.
+ *
+ * Not reentrant: the platform calls gpio_edge_isr() and
+ * gpio_edge_collect() under one spinlock.
+ */
+
+#ifndef GPIO_EDGE_H
+#define GPIO_EDGE_H
+
+#include <platform_api.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPIO_EDGE_MAX_PINS         4     /* abstract pin indices 0-3 */
+#define GPIO_EDGE_QUEUE            8     /* settled changes awaiting collection */
+#define GPIO_EDGE_DEBOUNCE_MAX_MS  1000
+
+struct gpio_edge_stats {
+	uint32_t edges;         /* raw interrupts */
+	uint32_t delivered;     /* settled changes collected */
+	uint32_t bounces;       /* bursts that settled back on the old level */
+	uint32_t dropped;       /* changes lost to a full queue */
+};
+
+void gpio_edge_init(void);
+
+/**
+ * Watch a pin whose current level is `level`. Subscribing again only
+ * changes the debounce time.
+ * @return 0; -EINVAL bad pin or debounce_ms over GPIO_EDGE_DEBOUNCE_MAX_MS
+ */
+int gpio_edge_subscribe(int pin, int level, uint32_t debounce_ms);
+
+bool gpio_edge_subscribed(int pin);
+
+/**
+ * Raw edge: `pin` reads `level` at now_ms. Called from the GPIO ISR.
+ * @return ms until the pin settles, when gpio_edge_collect() should
+ *         run; 0 if the pin is not subscribed
+ */
+uint32_t gpio_edge_isr(int pin, int level, uint32_t now_ms);
+
+/**
+ * Settle every pin due at now_ms and move up to `max` queued changes,
+ * oldest first, to `out` (max >= GPIO_EDGE_QUEUE empties the queue).
+ * @param count  receives the number of changes copied
+ * @return ms until the next pin settles; 0 if none is bouncing
+ */
+uint32_t gpio_edge_collect(uint32_t now_ms, struct platform_gpio_edge *out,
+			   size_t max, size_t *count);
+
+void gpio_edge_stats(struct gpio_edge_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GPIO_EDGE_H */
@@ -3,7 +3,10 @@
  *
  * Table-driven blink engine for a single green LED.  Eight priority levels
  * from error (highest, 5Hz) through idle heartbeat (lowest, blip every 10s).
- * Ticks at 100ms resolution from app_on_timer().
+ * Ticks at 100ms resolution from app_on_timer(), which sleeps until
+ * led_engine_next_ms() says the LED must change.  On platform API v9+
+ * the pattern is uploaded to led_pattern() and played in hardware, so
+ * only priority changes and the end of a button ack need a tick.
  *
  * Yields to selftest_trigger blink codes when a button-triggered self-test
  * is running.  A short button-ack overlay (3 blinks) is available for
@@ -33,6 +36,8 @@ typedef enum {
 	LED_PRI_COUNT
 } led_priority_t;
 
+#define LED_TICK_MS                 100      /* pattern resolution */
+
 /* Timeouts */
 #define LED_COMMISSION_TIMEOUT_MS   300000   /* 5 minutes */
 #define LED_SIDEWALK_TIMEOUT_MS     600000   /* 10 minutes */
@@ -40,7 +45,22 @@ typedef enum {
 
 /* Module lifecycle */
 void led_engine_init(void);
-void led_engine_tick(void);   /* call every 100ms from app_on_timer */
+void led_engine_tick(void);   /* one 100ms tick */
+
+/*
+ * Catch up `ticks` ticks at once after a longer sleep: the skipped ones
+ * only move the playback position, the last one drives the LED.
+ */
+void led_engine_advance(uint32_t ticks);
+
+/*
+ * Time until the LED must change, in ms from the last tick:
+ * LED_TICK_MS while the button-ack overlay plays, UINT32_MAX for a
+ * solid pattern or while the self-test blink codes own the LED.  With
+ * hardware playback: UINT32_MAX once the pattern is uploaded, or the
+ * rest of the ack one-shot.
+ */
+uint32_t led_engine_next_ms(void);
 
 /* State notifications */
 void led_engine_notify_uplink_sent(void);
@@ -0,0 +1,48 @@
+/*
+ * LED Pattern — PWM sequences for the platform's led_pattern()
+ *
+ * An LED pattern plays from the nRF PWM peripheral: one PWM period per
+ * sequence value, each value either fully on or fully off, and the
+ * peripheral's EasyDMA walks the sequence with the CPU asleep. Each
+ * value is held for `refresh` extra periods, so steps are first scaled
+ * down by the greatest common divisor of their tick counts (a 1 s on /
+ * 1 s off blink is two values, not twenty).
+ */
+
+#ifndef LED_PATTERN_H
+#define LED_PATTERN_H
+
+#include <platform_api.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_PATTERN_MAX_VALUES  128     /* sequence RAM: 256 bytes */
+#define LED_PATTERN_COUNTERTOP  12500   /* 125 kHz: one PLATFORM_LED_TICK_MS period */
+#define LED_PATTERN_POLARITY    0x8000  /* output high for COMPARE counts */
+#define LED_PATTERN_ON          (LED_PATTERN_POLARITY | LED_PATTERN_COUNTERTOP)
+#define LED_PATTERN_OFF         (LED_PATTERN_POLARITY | 0)
+
+struct led_pattern_seq {
+	uint16_t values[LED_PATTERN_MAX_VALUES];
+	uint16_t length;        /* values in use */
+	uint16_t refresh;       /* extra PWM periods each value is held */
+};
+
+/**
+ * Build the PWM sequence for `count` steps.
+ * @return 0; -EINVAL no steps, more than PLATFORM_LED_MAX_STEPS, a step
+ *         of 0 ticks, or more than LED_PATTERN_MAX_VALUES values after
+ *         scaling
+ */
+int led_pattern_build(const struct platform_led_step *steps, size_t count,
+		      struct led_pattern_seq *seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LED_PATTERN_H */
@@ -0,0 +1,73 @@
+/*
+ * Message Pool — fixed-slot, lock-free allocator for Sidewalk events
+ *
+ * Replaces per-event sid_hal_malloc() on the uplink and status paths.
+ * Each pool is a static array of up to 32 equally sized slots with an
+ * atomic bitmap of the ones in use, so alloc/free are a CAS loop and
+ * safe from any thread or ISR. Running out of slots is backpressure,
+ * not an allocation failure: callers report it as -ENOBUFS.
+ *
+ * Each pool keeps a high-water mark and an exhaustion counter for the
+ * `sid status` shell.
+ */
+
+#ifndef MSG_POOL_H
+#define MSG_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <zephyr/sys/atomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MSG_POOL_MAX_SLOTS  32
+
+struct msg_pool {
+	uint8_t *buf;
+	uint16_t slot_size;
+	uint8_t slots;
+	atomic_t used;          /* bit i set = slot i allocated */
+	atomic_t high_water;    /* most slots ever in use at once */
+	atomic_t exhausted;     /* allocs refused because the pool was full */
+};
+
+struct msg_pool_stats {
+	uint8_t slots;
+	uint8_t in_use;
+	uint8_t high_water;
+	uint32_t exhausted;
+};
+
+/**
+ * Define a pool of n slots, each holding one `type`.
+ */
+#define MSG_POOL_DEFINE(name, type, n)                                     \
+	_Static_assert((n) > 0 && (n) <= MSG_POOL_MAX_SLOTS, "pool size"); \
+	static type name##_slots[n];                                       \
+	struct msg_pool name = {                                           \
+		.buf = (uint8_t *)name##_slots,                            \
+		.slot_size = sizeof(type),                                 \
+		.slots = (n),                                              \
+	}
+
+/**
+ * Take a free slot (contents undefined).
+ * @return slot pointer, or NULL if every slot is in use
+ */
+void *msg_pool_alloc(struct msg_pool *pool);
+
+/**
+ * Return a slot to the pool. NULL and pointers outside the pool are ignored.
+ */
+void msg_pool_free(struct msg_pool *pool, void *slot);
+
+void msg_pool_stats(struct msg_pool *pool, struct msg_pool_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MSG_POOL_H */
@@ -0,0 +1,63 @@
+/*
+ * Message Track — Sidewalk message ids back to send_msg() tokens
+ *
+ * send_msg() returns before the Sidewalk thread calls sid_put_msg(), so
+ * the app gets a platform token as its msg_id. Once the stack has
+ * assigned its own id, the pair is recorded here; the sent and error
+ * callbacks take the token back out by the stack's id. Each pair also
+ * says whether the app sent the uplink: the platform's own (OTA ACKs
+ * and status) get tokens too, but are not the app's.
+ *
+ * Sized for every uplink the platform can have queued
+ * (SIDEWALK_MSG_POOL_SLOTS) plus those the stack still holds after
+ * sid_put_msg(). When all slots are taken the oldest pair is evicted and
+ * counted: that uplink's result reaches the app with msg_id 0.
+ *
+ * Not reentrant: all calls run on the Sidewalk thread.
+ */
+
+#ifndef MSG_TRACK_H
+#define MSG_TRACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MSG_TRACK_SDK_QUEUE  8      /* uplinks the stack holds: queued or in retry */
+#define MSG_TRACK_SLOTS      16     /* >= SIDEWALK_MSG_POOL_SLOTS + MSG_TRACK_SDK_QUEUE */
+
+struct msg_track_stats {
+	uint32_t tracked;       /* pairs recorded */
+	uint32_t evicted;       /* pairs pushed out before their result */
+	uint32_t untracked;     /* results for ids not in the table */
+	uint8_t in_use;
+	uint8_t high_water;
+};
+
+void msg_track_init(void);
+
+/**
+ * Record that the stack sent token's uplink as sid_id. A pair already
+ * holding sid_id is replaced.
+ * @param app  the app sent it through send_msg(), not the platform
+ * @return the token of the pair evicted to make room, or 0
+ */
+uint32_t msg_track_add(uint16_t sid_id, uint32_t token, bool app);
+
+/**
+ * Take the token for a stack id out of the table.
+ * @param app  (optional) set to whether the app sent it; false if untracked
+ * @return the token, or 0 if sid_id is not tracked (counted as untracked)
+ */
+uint32_t msg_track_take(uint16_t sid_id, bool *app);
+
+void msg_track_stats(struct msg_track_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MSG_TRACK_H */
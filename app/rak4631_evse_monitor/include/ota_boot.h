@@ -0,0 +1,143 @@
+/*
+ * A/B App Slots — Boot Record
+ *
+ * The app partition holds two slots, each with its own build of the app
+ * (app.ld is linked once per slot address). Slot A is the app primary;
+ * slot B reuses the OTA staging area. A small append-only record page
+ * says which slot boots, so an OTA update writes the inactive slot and
+ * flips the record instead of copying the image over the running one.
+ *
+ * A newly activated slot runs on trial: it is confirmed by its first
+ * uplink, and rolled back to the other slot if it fails to initialize,
+ * keeps rebooting, or stays silent while the link is up.
+ */
+
+#ifndef OTA_BOOT_H
+#define OTA_BOOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ota_update.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ------------------------------------------------------------------ */
+/*  Slots                                                               */
+/* ------------------------------------------------------------------ */
+
+#define OTA_SLOT_A              0
+#define OTA_SLOT_B              1
+#define OTA_SLOT_COUNT          2
+
+#define OTA_SLOT_A_ADDR         OTA_APP_PRIMARY_ADDR
+#define OTA_SLOT_B_ADDR         OTA_STAGING_ADDR
+#define OTA_SLOT_SIZE           OTA_STAGING_SIZE   /* largest image in either slot */
+
+#define OTA_SLOT_NAME(slot)     ((slot) == OTA_SLOT_A ? 'A' : 'B')
+
+/* Boots a trial slot gets before it is rolled back unconfirmed */
+#define OTA_BOOT_TRIAL_BOOTS    3
+
+/* ------------------------------------------------------------------ */
+/*  Boot record (stored at OTA_BOOT_RECORD_ADDR)                        */
+/* ------------------------------------------------------------------ */
+
+/* Record kinds */
+#define OTA_BOOT_REC_IMAGE      0x01  /* slot holds this image */
+#define OTA_BOOT_REC_ACTIVATE   0x02  /* slot holds this image and boots next, on trial */
+#define OTA_BOOT_REC_TRY        0x03  /* one more boot of the trial slot */
+#define OTA_BOOT_REC_CONFIRM    0x04  /* trial slot confirmed */
+#define OTA_BOOT_REC_REVERT     0x05  /* slot failed: boot the other one */
+#define OTA_BOOT_REC_PAGE       0x06  /* page header: image_size is its generation */
+
+/*
+ * One record slot, programmed once into erased flash. The record area is
+ * two pages; the one whose first slot holds the PAGE header with the
+ * higher generation is current. Its records replay in order; an erased
+ * slot ends the page and a slot failing its check (torn by power loss)
+ * is skipped. No header on either page is a device that never had an A/B
+ * update: slot A boots, confirmed. A full page is carried over to the
+ * other page as a snapshot of the replayed state, header last.
+ */
+struct ota_boot_rec {
+	uint32_t image_size;     /* IMAGE/ACTIVATE: the slot's image, else 0 */
+	uint32_t image_crc32;
+	uint32_t app_version;
+	uint8_t  kind;           /* OTA_BOOT_REC_* */
+	uint8_t  slot;           /* OTA_SLOT_* the record is about */
+	uint16_t check;          /* Low 16 bits of CRC32 over the fields above */
+};
+
+#define OTA_BOOT_RECORD_PAGES   2
+#define OTA_BOOT_SLOTS          (OTA_FLASH_PAGE_SIZE / sizeof(struct ota_boot_rec))
+
+/* An image as recorded for a slot */
+struct ota_boot_image {
+	uint32_t size;
+	uint32_t crc32;
+	uint32_t version;
+};
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                          */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Replay the boot record and count this boot against a trial slot,
+ * rolling it back once it has used up OTA_BOOT_TRIAL_BOOTS. Call once at
+ * boot, before the app image is discovered.
+ * @return the slot to boot
+ */
+uint8_t ota_boot_init(void);
+
+/** Slot the device boots from. */
+uint8_t ota_boot_active_slot(void);
+
+/** Flash address of a slot (its app callback table). */
+uint32_t ota_boot_slot_addr(uint8_t slot);
+
+/** True while the active slot is on trial. */
+bool ota_boot_in_trial(void);
+
+/**
+ * Image recorded for a slot.
+ * @return false if the record does not say what the slot holds
+ */
+bool ota_boot_slot_image(uint8_t slot, struct ota_boot_image *img);
+
+/**
+ * Whether a slot can be booted as a fallback: its recorded image is
+ * still there (CRC32 over flash), or it is slot A on a device without
+ * A/B records. A slot rolled back from is never valid.
+ */
+bool ota_boot_slot_valid(uint8_t slot);
+
+/**
+ * Boot a freshly written slot from the next reset, on trial.
+ * @return 0 on success, negative errno on flash failure
+ */
+int ota_boot_activate(uint8_t slot, const struct ota_boot_image *img);
+
+/**
+ * Note that the active slot was rewritten in place (OTA copy path). A
+ * device without A/B records is left without them.
+ */
+int ota_boot_set_image(uint8_t slot, const struct ota_boot_image *img);
+
+/** Confirm the trial slot (no-op otherwise). */
+void ota_boot_confirm(void);
+
+/**
+ * Give up on the active slot and boot the other one from now on.
+ * @return 0 on success, -ENOENT if the other slot is not valid,
+ *         negative errno on flash failure
+ */
+int ota_boot_revert(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OTA_BOOT_H */
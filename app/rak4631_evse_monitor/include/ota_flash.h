@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +39,7 @@ int ota_flash_erase_pages(uint32_t addr, size_t size);
 /**
  * Write data to flash with nRF52840 NVMC 4-byte alignment handling.
  * Pads with 0xFF on both sides if address or length is not 4-byte aligned.
+ * Any length and alignment is accepted.
  * @param addr  Flash address to write to
  * @param data  Data buffer to write
  * @param len   Number of bytes to write
@@ -45,6 +47,79 @@ int ota_flash_erase_pages(uint32_t addr, size_t size);
  */
 int ota_flash_write(uint32_t addr, const uint8_t *data, size_t len);
 
+/* Bytes gathered per program by the write combiner */
+#define OTA_FLASH_RUN_SIZE      256
+
+/*
+ * Write combiner: gathers small sequential writes (OTA chunks, decoder
+ * output) in RAM and programs them as word-aligned runs of up to
+ * OTA_FLASH_RUN_SIZE bytes.
+ *
+ * A run is one contiguous range. It starts at the first put, padded
+ * with 0xFF back to a word boundary, and ends at a put that is not
+ * contiguous or at ota_flash_writer_finish(). Within a run each flash
+ * word is programmed exactly once: when the buffer fills, or at a flush
+ * once the word is complete. ota_flash_writer_flush() leaves a partial
+ * last word in RAM; only finish programs it, padded with 0xFF.
+ *
+ * A word is programmed again only when two runs share it: a run ending
+ * mid-word and another starting in the same word. The 0xFF padding
+ * leaves the other run's bytes as they are. Each run touches a word
+ * once, so a word shared by two runs is programmed twice. That is the
+ * nRF52840 NVMC limit between erases (nWRITE = 2). Callers must not
+ * let three runs share a word. Runs that end on chunk boundaries meet
+ * this whenever chunks are at least 4 bytes long.
+ */
+struct ota_flash_writer {
+	uint32_t addr;           /* flash address of buf[0], word aligned */
+	uint16_t len;            /* bytes in buf, including head padding */
+	uint8_t  buf[OTA_FLASH_RUN_SIZE];
+};
+
+/** Start with nothing buffered (drops anything not yet flushed). */
+void ota_flash_writer_init(struct ota_flash_writer *w);
+
+/**
+ * Queue len bytes for addr. Target flash must be erased. Bytes that do
+ * not follow the run in progress finish it and start a new one.
+ * @return 0, or the error of a run programmed on the way
+ */
+int ota_flash_writer_put(struct ota_flash_writer *w, uint32_t addr,
+			 const uint8_t *data, size_t len);
+
+/**
+ * Program every complete word buffered; the run continues. Up to 3 bytes
+ * of a partial last word stay in RAM (see ota_flash_writer_held()).
+ * @return 0 on success, negative errno on failure
+ */
+int ota_flash_writer_flush(struct ota_flash_writer *w);
+
+/**
+ * Program everything buffered, the partial last word padded with 0xFF,
+ * and end the run. Call before reading the written range back.
+ * @return 0 on success, negative errno on failure
+ */
+int ota_flash_writer_finish(struct ota_flash_writer *w);
+
+/**
+ * Bytes buffered and not yet in flash, from *addr on (head padding
+ * included). After ota_flash_writer_flush() at most 3.
+ */
+size_t ota_flash_writer_held(const struct ota_flash_writer *w, uint32_t *addr);
+
+/**
+ * True if flash at addr holds exactly data (false on read error). Reads
+ * in 256-byte pieces; any alignment and length. Used to skip programming
+ * bytes already there, e.g. when a resumed session is sent again.
+ */
+bool ota_flash_equals(uint32_t addr, const uint8_t *data, size_t len);
+
+/**
+ * True if the range reads as erased, all 0xFF (false on read error).
+ * Any alignment and length. Used to skip erasing pages already erased.
+ */
+bool ota_flash_is_erased(uint32_t addr, size_t len);
+
 /**
  * Read data from flash.
  * @param addr  Flash address to read from
@@ -63,6 +138,20 @@ int ota_flash_read(uint32_t addr, uint8_t *buf, size_t len);
  */
 uint32_t ota_flash_compute_crc32(uint32_t addr, size_t size);
 
+/**
+ * CRC32 of the concatenation A||B from crc1 = CRC32(A), crc2 = CRC32(B)
+ * and the length of B, without touching the data (zlib's crc32_combine).
+ * Both CRCs are the IEEE values ota_flash_compute_crc32() returns, and
+ * combine(0, crc2, len2) == crc2. Lets cached per-page CRCs stand in for
+ * pages that were not reread. The shift operator for the last len2 is
+ * kept in a static, so runs of equal-length pages cost one 32x32
+ * bit-matrix product each; not reentrant, call from one thread.
+ */
+uint32_t ota_crc32_combine(uint32_t crc1, uint32_t crc2, size_t len2);
+
+/** Receives image bytes in order; returns 0 or a negative errno. */
+typedef int (*ota_image_sink_t)(void *ctx, const uint8_t *data, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,67 @@
+/*
+ * OTA LZ — streaming decompressor for compressed OTA chunk streams
+ *
+ * The stream is heatshrink-format LZSS (window 2^12, lookahead 2^4), read
+ * MSB-first: a 1 bit is followed by an 8-bit literal, a 0 bit by a 12-bit
+ * (distance - 1) and a 4-bit (length - 1) back-reference. The final byte is
+ * zero-padded; the decoder stops after out_size bytes, so padding is never
+ * mistaken for a back-reference. The encoder is aws/ota_compress.py.
+ *
+ * History lives in a caller-supplied OTA_LZ_WINDOW_SIZE buffer. Decoded
+ * bytes are handed to a sink in OTA_LZ_SINK_BLOCK pieces as the history
+ * fills, so RAM use is the window plus this struct, whatever the image size.
+ */
+
+#ifndef OTA_LZ_H
+#define OTA_LZ_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <ota_flash.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OTA_LZ_WINDOW_BITS      12
+#define OTA_LZ_LOOKAHEAD_BITS   4
+#define OTA_LZ_WINDOW_SIZE      (1u << OTA_LZ_WINDOW_BITS)
+#define OTA_LZ_SINK_BLOCK       256   /* divides the window; 4-byte aligned */
+
+struct ota_lz {
+	uint8_t      *window;
+	ota_image_sink_t sink;
+	void         *sink_ctx;
+	uint32_t      out_size;
+	uint32_t      out_len;     /* bytes decoded */
+	uint32_t      bits;        /* unread input bits, right-aligned */
+	uint8_t       bit_count;
+	bool          failed;
+};
+
+/**
+ * Start decompressing a stream that expands to out_size bytes.
+ * @param window  OTA_LZ_WINDOW_SIZE bytes, owned by the decoder until finish
+ */
+void ota_lz_init(struct ota_lz *z, uint8_t *window, uint32_t out_size,
+		 ota_image_sink_t sink, void *sink_ctx);
+
+/**
+ * Decode the next len bytes of compressed input.
+ * @return 0, -EBADMSG for a corrupt stream (bad distance, output past
+ *         out_size, trailing input), or the sink's error
+ */
+int ota_lz_feed(struct ota_lz *z, const uint8_t *data, size_t len);
+
+/**
+ * End of input: pass the last partial block to the sink.
+ * @return 0 if exactly out_size bytes were decoded, -EBADMSG otherwise
+ */
+int ota_lz_finish(struct ota_lz *z);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OTA_LZ_H */
@@ -0,0 +1,100 @@
+/*
+ * OTA Patch — streaming binary-diff patcher
+ *
+ * Rebuilds a new app image in staging from the current primary image and a
+ * bsdiff-style patch that arrives as a stream of OTA chunks. Patch bytes are
+ * consumed as they arrive; the only RAM used is this state struct and a
+ * small output window, so image size is bounded by staging, not by RAM.
+ *
+ * Patch format (all integers little-endian; varints are unsigned LEB128):
+ *
+ *   header:  magic "EVP1"(4) old_size(4) old_crc32(4)
+ *   record:  seek(zigzag varint) diff_len(varint) extra_len(varint)
+ *            diff tokens, then extra_len raw bytes
+ *
+ * A record first moves the old-image cursor by seek, then emits diff_len
+ * bytes of old[cursor + i] + delta[i] (advancing the cursor), then the
+ * extra bytes verbatim. The delta bytes are mostly zero, so they are sent
+ * as tokens: zeros(varint) lits(varint) lits×delta-byte, repeated until
+ * diff_len bytes are covered. Records repeat until new_size bytes have
+ * been emitted. The generator is aws/ota_patch.py.
+ */
+
+#ifndef OTA_PATCH_H
+#define OTA_PATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <ota_flash.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OTA_PATCH_MAGIC         0x31505645  /* "EVP1" */
+#define OTA_PATCH_HDR_SIZE      12
+#define OTA_PATCH_WINDOW        256         /* output bytes buffered per write */
+
+struct ota_patch {
+	uint8_t  state;
+	uint8_t  varint_shift;
+	uint8_t  hdr_len;
+	uint32_t varint;
+	uint8_t  hdr[OTA_PATCH_HDR_SIZE];
+
+	uint32_t old_addr;      /* old image base (primary) */
+	uint32_t old_size;
+	uint32_t old_pos;       /* cursor into the old image */
+	uint32_t out_addr;      /* output base (staging) */
+	uint32_t new_size;
+	uint32_t out_len;       /* bytes emitted, including the window */
+
+	uint32_t diff_left;     /* diff bytes left in this record */
+	uint32_t extra_left;    /* extra bytes left in this record */
+	uint32_t run_left;      /* zeros or literals left in this token */
+
+	ota_image_sink_t sink;  /* optional; replaces the write to out_addr */
+	void    *sink_ctx;
+
+	uint16_t win_len;
+	uint8_t  win[OTA_PATCH_WINDOW];
+};
+
+/**
+ * Start a patch session.
+ * @param old_addr  Flash address of the old image
+ * @param out_addr  Flash address to write the new image to (erased)
+ * @param new_size  Size of the image the patch must produce
+ */
+void ota_patch_init(struct ota_patch *p, uint32_t old_addr, uint32_t out_addr,
+		    uint32_t new_size);
+
+/**
+ * Hand each output window to sink instead of writing it at out_addr, e.g.
+ * to digest the new image on its way to flash. Call after ota_patch_init().
+ */
+void ota_patch_set_sink(struct ota_patch *p, ota_image_sink_t sink, void *ctx);
+
+/**
+ * Consume the next len bytes of the patch stream. The header's old_size
+ * and old_crc32 are checked against the old image as soon as it is in.
+ * @return 0 on success, -EINVAL if the old image is not the patch base,
+ *         -EBADMSG if the patch is malformed, or a flash error
+ */
+int ota_patch_feed(struct ota_patch *p, const uint8_t *data, size_t len);
+
+/**
+ * End of the patch stream: write out the last window.
+ * @return 0 if exactly new_size bytes were produced, -EBADMSG otherwise
+ */
+int ota_patch_finish(struct ota_patch *p);
+
+/** True once every output byte has been produced. */
+bool ota_patch_done(const struct ota_patch *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OTA_PATCH_H */
@@ -4,6 +4,11 @@
  * Verifies that OTA firmware images are signed with the trusted
  * developer key before applying updates. Uses a 32-byte ED25519
  * public key compiled into the platform firmware.
+ *
+ * The signature covers the SHA-256 digest of the firmware, not the
+ * firmware itself, so the image can be hashed incrementally while it is
+ * read from flash a page at a time: begin(), update() per piece, then
+ * finish() with the signature. aws/ota_signing.py signs the same way.
  */
 
 #ifndef OTA_SIGNING_H
@@ -17,9 +22,29 @@ extern "C" {
 #endif
 
 #define OTA_SIG_SIZE 64
+#define OTA_DIGEST_SIZE 32   /* SHA-256 */
+
+/**
+ * Start hashing a firmware image. Aborts any verification in progress.
+ * @return 0 on success, negative error code on failure
+ */
+int ota_verify_begin(void);
+
+/**
+ * Feed the next piece of firmware data (without signature).
+ * @return 0 on success, negative error code on failure
+ */
+int ota_verify_update(const uint8_t *data, size_t len);
+
+/**
+ * Finish the hash and verify the ED25519 signature over the digest.
+ * @param sig  64-byte ED25519 signature
+ * @return 0 on success, negative error code on failure
+ */
+int ota_verify_finish(const uint8_t *sig);
 
 /**
- * Verify an ED25519 signature over firmware data.
+ * One-shot verification of firmware held in RAM (begin/update/finish).
  *
  * @param data  Firmware data (without signature)
  * @param len   Length of firmware data
@@ -3,7 +3,9 @@
  *
  * Receives firmware chunks for the EVSE app partition via Sidewalk
  * downlinks, stages them in flash, validates CRC, and applies the
- * update by copying staging → primary app partition.
+ * update by copying staging → primary app partition — or, for an image
+ * built for the inactive A/B slot (ota_boot.h), receives it straight
+ * into that slot and switches slots.
  *
  * Protocol: cmd type 0x20, subtypes for START/CHUNK/ABORT (downlink)
  * and ACK/COMPLETE/STATUS (uplink).
@@ -44,9 +46,25 @@ extern "C" {
 #define OTA_STATUS_NO_SESSION   3
 #define OTA_STATUS_SIZE_ERR     4
 #define OTA_STATUS_SIG_ERR      5
+#define OTA_STATUS_PATCH_ERR    6   /* patch or compressed stream undecodable,
+					 * or patch not for this primary */
+#define OTA_STATUS_SLOT_ERR     7   /* slot B image while slot B runs */
 
 /* OTA_START flags byte (byte 19, optional) */
 #define OTA_START_FLAGS_SIGNED  0x01
+#define OTA_START_FLAGS_PATCH   0x02  /* chunks carry an ota_patch stream */
+#define OTA_START_FLAGS_COMPRESSED 0x04 /* chunks carry an ota_lz stream */
+#define OTA_START_FLAGS_SLOT_B  0x08  /* image is linked for slot B */
+/* Bits 4-7: delta sessions ACK every N new chunks with a bitmap ACK
+ * instead of after each one (0 = every chunk) */
+#define OTA_START_FLAGS_ACK_SHIFT 4
+#define OTA_START_ACK_EVERY(flags) ((uint8_t)(flags) >> OTA_START_FLAGS_ACK_SHIFT)
+
+/* Bitmap ACK: the 7-byte ACK, then base(2) and OTA_ACK_BITMAP_BITS
+ * receive bits for chunks base.. (LSB first) */
+#define OTA_ACK_LEN             7
+#define OTA_ACK_BITMAP_LEN      17
+#define OTA_ACK_BITMAP_BITS     64
 
 /* ED25519 signature size */
 #define OTA_SIG_SIZE            64
@@ -57,12 +75,16 @@ extern "C" {
 
 #define OTA_APP_PRIMARY_ADDR    0x90000   /* App primary (256KB region) */
 #define OTA_APP_PRIMARY_SIZE    0x40000   /* 256KB */
+#define OTA_BOOT_RECORD_ADDR    0xC8000   /* A/B boot record (two pages, below checkpoints) */
+#define OTA_RX_STATE_ADDR       0xCA000   /* Receive checkpoints (one page, below event log) */
+#define OTA_JOURNAL_ADDR        0xCF000   /* Apply journal (same page as metadata) */
 #define OTA_METADATA_ADDR       0xCFF00   /* Recovery metadata (256B) */
 #define OTA_STAGING_ADDR        0xD0000   /* Staging area for incoming image */
 #define OTA_STAGING_SIZE        0x24FFF   /* ~148KB (up to 0xF4FFF) */
 
-/* OTA_FLASH_PAGE_SIZE is defined in ota_flash.h */
-#define OTA_VERIFY_BUF_SIZE     16384     /* ED25519 verify buffer — must hold full app image */
+/* OTA_FLASH_PAGE_SIZE is defined in ota_flash.h. Page copies and signature
+ * hashing share one page-sized buffer, so signed images may use the whole
+ * staging area. */
 
 /* Recovery metadata magic */
 #define OTA_META_MAGIC          0x4F544155  /* "OTAU" */
@@ -70,7 +92,29 @@ extern "C" {
 /* Recovery metadata states */
 #define OTA_META_STATE_NONE     0x00
 #define OTA_META_STATE_STAGED   0x01  /* Image staged, ready to apply */
-#define OTA_META_STATE_APPLYING 0x02  /* Copy in progress */
+#define OTA_META_STATE_APPLYING 0x02  /* Copy in progress (see journal) */
+
+/* Largest image, in pages (bounded by staging) */
+#define OTA_META_MAX_PAGES \
+	((OTA_STAGING_SIZE + OTA_FLASH_PAGE_SIZE - 1) / OTA_FLASH_PAGE_SIZE)
+
+/* Delta mode tracks received chunks across the whole staging area at the
+ * sender's 15-byte chunk size; a smaller chunk size caps the image lower */
+#define OTA_DELTA_MIN_CHUNK_SIZE 15
+#define OTA_DELTA_MAX_CHUNKS \
+	((OTA_STAGING_SIZE + OTA_DELTA_MIN_CHUNK_SIZE - 1) / OTA_DELTA_MIN_CHUNK_SIZE)
+
+/* Apply journal: page records, closed by a DONE record */
+#define OTA_JOURNAL_SIZE        (OTA_METADATA_ADDR - OTA_JOURNAL_ADDR)
+#define OTA_JOURNAL_SLOTS       (OTA_JOURNAL_SIZE / sizeof(struct ota_journal_rec))
+#define OTA_JOURNAL_DONE        0xD04E  /* page value of the closing record */
+
+/* Receive checkpoints: session header, then progress records */
+#define OTA_RX_MAGIC            0x4F545258  /* "OTRX" */
+#define OTA_RX_RECS_ADDR        (OTA_RX_STATE_ADDR + 32)
+#define OTA_RX_SLOTS \
+	((OTA_FLASH_PAGE_SIZE - 32) / sizeof(struct ota_rx_rec))
+#define OTA_RX_CHECKPOINT_CHUNKS 16   /* chunks received between checkpoints */
 
 /* ------------------------------------------------------------------ */
 /*  OTA state machine phases                                            */
@@ -89,6 +133,13 @@ enum ota_phase {
 /*  Recovery metadata (stored at OTA_METADATA_ADDR)                     */
 /* ------------------------------------------------------------------ */
 
+/*
+ * Written once, right after the erase that starts an apply. Progress is
+ * then appended to the journal below it, one record per copied page, so
+ * the page is not erased again until the next apply. A journal closed
+ * with a DONE record turns the pair into a cache of the primary image's
+ * CRC32 and page CRCs, rechecked against primary at boot.
+ */
 struct ota_metadata {
 	uint32_t magic;          /* OTA_META_MAGIC */
 	uint8_t  state;          /* OTA_META_STATE_* */
@@ -96,10 +147,57 @@ struct ota_metadata {
 	uint32_t image_size;     /* Size of staged image */
 	uint32_t image_crc32;    /* Expected CRC32 of staged image */
 	uint32_t app_version;    /* Version from OTA_START */
-	uint32_t pages_copied;   /* Progress tracking for apply */
+	uint32_t pages_copied;   /* Pages copied before the journal started */
 	uint32_t total_pages;    /* Total pages to copy */
 };
 
+/*
+ * One journal slot, programmed once into erased flash. Records for pages
+ * pages_copied, pages_copied + 1, ... follow in slot order; an erased slot
+ * ends the journal and a slot failing its check (torn by power loss) is
+ * skipped.
+ */
+struct ota_journal_rec {
+	uint32_t page_crc32;     /* CRC32 of the page written (image CRC32 for DONE) */
+	uint16_t page;           /* Page index, or OTA_JOURNAL_DONE */
+	uint16_t check;          /* Low 16 bits of CRC32 over the fields above */
+};
+
+/* ------------------------------------------------------------------ */
+/*  Receive checkpoints (stored at OTA_RX_STATE_ADDR)                   */
+/* ------------------------------------------------------------------ */
+
+/*
+ * Written after the erase that starts a full or delta receive session; a
+ * matching OTA_START after a reboot picks the session up from its last
+ * checkpoint instead of erasing staging. Patch and compressed sessions
+ * keep decoder state in RAM only and always start over. The magic is
+ * programmed to zero when the session ends.
+ */
+struct ota_rx_session {
+	uint32_t magic;          /* OTA_RX_MAGIC, or 0 once ended */
+	uint32_t total_size;     /* OTA_START fields identifying the session */
+	uint32_t crc32;
+	uint32_t version;
+	uint16_t total_chunks;
+	uint16_t chunk_size;
+	uint8_t  flags;
+	uint8_t  reserved[3];
+	uint32_t check;          /* CRC32 of the fields above */
+};
+
+/*
+ * One checkpoint slot, programmed once into erased flash. Full mode: the
+ * latest record is the resume point. Delta mode: records OR together into
+ * the received-chunk bitmap. Erased and torn slots are handled as in the
+ * apply journal.
+ */
+struct ota_rx_rec {
+	uint32_t value;          /* full: CRC32 of the image so far; delta: received bits */
+	uint16_t chunk;          /* full: chunks received; delta: chunk of bit 0 */
+	uint16_t check;          /* Low 16 bits of CRC32 over the fields above */
+};
+
 /* ------------------------------------------------------------------ */
 /*  Public API                                                          */
 /* ------------------------------------------------------------------ */
@@ -0,0 +1,47 @@
+/*
+ * Pilot Config Interface — remote J1772 classifier tuning via 0x50 downlink
+ *
+ * The cloud sends a 0x50 command carrying the four state thresholds,
+ * the hysteresis band, the debounce count and the burst filter. A bare
+ * 0x50 restores the compiled-in defaults. Tuning lives in RAM: a reboot
+ * also restores the defaults.
+ *
+ * Authenticated like charge control (cmd_auth.h) when a key is set.
+ * See TDD §4.6.
+ */
+
+#ifndef PILOT_CONFIG_H
+#define PILOT_CONFIG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Command type for pilot config downlink */
+#define PILOT_CONFIG_CMD_TYPE  0x50
+
+/* cmd(1) + thresholds(4 x 2) + hysteresis(1) + debounce/filter(1) = 11 bytes;
+ * 19 with the auth tag */
+#define PILOT_CONFIG_PAYLOAD_SIZE  11
+#define PILOT_CONFIG_RESET_SIZE    1
+
+#define PILOT_CONFIG_HYSTERESIS_UNIT_MV  10
+
+/**
+ * Process a pilot config downlink (cmd type 0x50), tag already removed.
+ *
+ * @param data  Payload starting with the 0x50 command byte
+ * @param len   PILOT_CONFIG_RESET_SIZE to restore defaults, or
+ *              >= PILOT_CONFIG_PAYLOAD_SIZE to apply new tuning
+ * @return 0 on success, <0 on a malformed or rejected config
+ */
+int pilot_config_process_cmd(const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PILOT_CONFIG_H */
@@ -40,13 +40,44 @@ extern "C" {
 /* ------------------------------------------------------------------ */
 
 #define PLATFORM_API_MAGIC      0x504C4154  /* "PLAT" */
-#define PLATFORM_API_VERSION    3
+#define PLATFORM_API_VERSION    9
+#define PLATFORM_API_VERSION_EVENT_LOG  4  /* first version with log_* */
+#define PLATFORM_API_VERSION_MSG_ID     5  /* first version whose send_msg returns a msg_id */
+#define PLATFORM_API_VERSION_ADC_CACHE  6  /* first version with adc_get_mv */
+#define PLATFORM_API_VERSION_ADC_BURST  7  /* first version with adc_get_burst */
+#define PLATFORM_API_VERSION_GPIO_EDGE  8  /* first version with gpio_subscribe */
+#define PLATFORM_API_VERSION_LED_PATTERN 9 /* first version with led_pattern */
+
+#define PLATFORM_SEND_NOBUFS    (-105)  /* -ENOBUFS from send_msg(): backpressure */
+#define PLATFORM_ADC_NO_SAMPLE  (-11)   /* -EAGAIN from adc_get_mv(): no scan yet */
+
+/* One debounced input change, delivered to the app's on_gpio_edges */
+struct platform_gpio_edge {
+    uint32_t at_ms;     /* uptime of the first edge of the change */
+    uint8_t  pin;       /* abstract pin index, as for gpio_get() */
+    uint8_t  level;     /* level it settled on, 0/1 as gpio_get() */
+};
+
+/* One step of an LED pattern played by the platform's led_pattern() */
+#define PLATFORM_LED_TICK_MS         100  /* step duration unit */
+#define PLATFORM_LED_MAX_STEPS       8
+#define PLATFORM_LED_REPEAT_FOREVER  0
+
+struct platform_led_step {
+    uint8_t  ticks;     /* duration in PLATFORM_LED_TICK_MS, 1-255 */
+    uint8_t  on;        /* LED level for the step, 0/1 */
+};
 
 struct platform_api {
     uint32_t magic;
     uint32_t version;
 
     /* --- Sidewalk --- */
+    /* Queue an uplink. >=0 on success: from API v5 the msg_id (>0)
+     * later passed to on_msg_sent/on_send_error; apps ignore the value
+     * on older platforms. <0 on error;
+     * PLATFORM_SEND_NOBUFS means the platform's message slots are all
+     * queued — nothing was lost, retry on a later tick. */
     int   (*send_msg)(const uint8_t *data, size_t len);
     bool  (*is_ready)(void);
     int   (*get_link_mask)(void);
@@ -64,7 +95,7 @@ struct platform_api {
     void     (*reboot)(void);
 
     /* --- Timer --- */
-    int   (*set_timer_interval)(uint32_t interval_ms);  /* configure on_timer period */
+    int   (*set_timer_interval)(uint32_t interval_ms);  /* on_timer period; restarts a running timer */
 
     /* --- Logging (variadic, printf-style) --- */
     void (*log_inf)(const char *fmt, ...);
@@ -82,6 +113,47 @@ struct platform_api {
     /* --- MFG diagnostics --- */
     uint32_t (*mfg_get_version)(void);
     bool     (*mfg_get_dev_id)(uint8_t *id_out);
+
+    /* --- Persistent record log (added in API v4) ---
+     * Small records kept in flash across resets. The first 4 bytes of each
+     * record (LE) are a key; log_trim drops the oldest records up to the
+     * first key > watermark. */
+    int   (*log_append)(const void *rec, size_t len);         /* 0 or -errno */
+    int   (*log_read)(uint32_t index, void *rec, size_t len); /* -ENOENT past end */
+    int   (*log_trim)(uint32_t key_watermark);
+
+    /* --- Cached ADC readings (added in API v6) ---
+     * The platform scans all ADC channels on a timer; this returns the
+     * latest filtered value without touching the peripheral. sample_ms
+     * (optional) gets the uptime of that scan. PLATFORM_ADC_NO_SAMPLE
+     * before the first scan; adc_read_mv() still works then. */
+    int   (*adc_get_mv)(int channel, uint32_t *sample_ms);  /* mV, <0 on error */
+
+    /* --- ADC bursts (added in API v7) ---
+     * Each scan samples every channel several times over about 1 ms.
+     * This copies up to `max` unfiltered samples of the latest scan,
+     * oldest first, and returns how many were copied. Same errors as
+     * adc_get_mv(). */
+    int   (*adc_get_burst)(int channel, int16_t *mv, size_t max,
+                           uint32_t *sample_ms);
+
+    /* --- GPIO edges (added in API v8) ---
+     * Interrupt on both edges of an input pin. A change that holds for
+     * debounce_ms (max 1000) is delivered to the app's on_gpio_edges on
+     * the platform work queue, batched with any other pin that settled
+     * by then. Subscribing again only changes debounce_ms. 0, -EINVAL
+     * not an input, -ENODEV not fitted on this board. */
+    int   (*gpio_subscribe)(int pin_index, uint32_t debounce_ms);
+
+    /* --- LED patterns (added in API v9) ---
+     * Play up to PLATFORM_LED_MAX_STEPS steps on an LED from hardware,
+     * with no CPU wakeups: `repeat` times through, or until replaced for
+     * PLATFORM_LED_REPEAT_FOREVER. A finished pattern leaves the LED at
+     * its last step's level. A new pattern or led_set() on the same LED
+     * replaces it. 0, -EINVAL bad steps, -ENODEV no pattern hardware
+     * for this LED. */
+    int   (*led_pattern)(int led_id, const struct platform_led_step *steps,
+                         size_t count, uint8_t repeat);
 };
 
 /* ------------------------------------------------------------------ */
@@ -103,7 +175,10 @@ struct platform_api {
 #ifndef PLATFORM_BUILD_VERSION
 #define PLATFORM_BUILD_VERSION  0  /* 0 = untagged dev build */
 #endif
-#define APP_CALLBACK_VERSION    4
+/* v5: on_msg_sent/on_send_error take the msg_id send_msg() returned. The
+ * bump keeps apps that treat a non-zero send_msg() result as an error
+ * off platforms that return ids (ADR-001 hard stop). */
+#define APP_CALLBACK_VERSION    6
 
 struct app_callbacks {
     uint32_t magic;
@@ -113,7 +188,9 @@ struct app_callbacks {
     int   (*init)(const struct platform_api *api);
     void  (*on_ready)(bool ready);
 
-    /* Messages */
+    /* Messages. The send results run on the same work queue as
+     * on_timer, never concurrently with it. msg_id 0: an uplink the
+     * platform has no id for (its own, or one it lost track of). */
     void  (*on_msg_received)(const uint8_t *data, size_t len);
     void  (*on_msg_sent)(uint32_t msg_id);
     void  (*on_send_error)(uint32_t msg_id, int error);
@@ -128,6 +205,11 @@ struct app_callbacks {
 
     /* Build metadata (added in API v4) */
     uint8_t build_version;
+
+    /* GPIO edges (added in API v6): `count` debounced changes of pins
+     * subscribed with gpio_subscribe(), oldest first. Runs on the same
+     * work queue as on_timer, never concurrently with it. */
+    void  (*on_gpio_edges)(const struct platform_gpio_edge *edges, size_t count);
 };
 
 #ifdef __cplusplus
@@ -14,6 +14,7 @@
 #ifndef SELFTEST_TRIGGER_H
 #define SELFTEST_TRIGGER_H
 
+#include <platform_api.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -29,7 +30,8 @@ extern "C" {
 #define LED_RED    2
 
 /* 5 presses within 5 seconds triggers self-test.
- * Window is 5s to accommodate 500ms GPIO polling resolution. */
+ * Window is 5s to accommodate 500ms GPIO polling resolution on
+ * platforms without edge interrupts (API < v8). */
 #define TRIGGER_PRESS_COUNT    5
 #define TRIGGER_WINDOW_MS      5000
 
@@ -39,6 +41,9 @@ extern "C" {
 /* Long press: held continuously for this duration cancels Charge Now */
 #define LONG_PRESS_MS            3000
 
+/* Edge debounce for the button contacts */
+#define BUTTON_DEBOUNCE_MS       20
+
 /* Pause between green and red blink sequences (in 500ms ticks) */
 #define BLINK_PAUSE_TICKS      2
 
@@ -50,9 +55,17 @@ typedef int (*selftest_send_fn)(void);
 
 void selftest_trigger_set_send_fn(selftest_send_fn fn);
 void selftest_trigger_init(void);
-void selftest_trigger_tick(void);       /* call from app_on_timer every 500ms */
+void selftest_trigger_tick(void);       /* each sensor cycle of app_on_timer */
+bool selftest_trigger_on_edge(const struct platform_gpio_edge *edge); /* false: other pin */
 bool selftest_trigger_is_running(void); /* true while test running or blinking */
 
+/**
+ * ms until selftest_trigger_tick() next has work: a single-press or
+ * long-press timeout. 0 while the blink codes play or the button is
+ * polled (every tick); UINT32_MAX if nothing is pending.
+ */
+uint32_t selftest_trigger_next_ms(void);
+
 #ifdef __cplusplus
 }
 #endif
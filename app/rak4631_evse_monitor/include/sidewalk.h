@@ -7,11 +7,13 @@
 #define SIDEWALK_H
 
 #include <sid_api.h>
+#include <msg_pool.h>
+#include <sidewalk_evq.h>
 
 #include <zephyr/kernel.h>
 #include <zephyr/sys/slist.h>
 
-typedef struct {
+typedef struct sidewalk_ctx {
 	struct sid_handle *handle;
 	struct sid_config config;
 	struct sid_status last_status;
@@ -19,18 +21,28 @@ typedef struct {
 
 typedef void (*event_handler_t)(sidewalk_ctx_t *sid, void *ctx);
 typedef void (*ctx_free)(void *ctx);
-typedef struct {
-	event_handler_t handler;
-	void *ctx;
-	ctx_free ctx_free;
-} sidewalk_ctx_event_t;
+typedef struct sidewalk_evq_event sidewalk_ctx_event_t;
+
+/* Uplinks up to the LoRa/FSK MTU are carried inside the pool slot; only
+ * larger (BLE) payloads are copied to the heap. */
+#define SIDEWALK_MSG_INLINE_MAX    19
+#define SIDEWALK_MSG_POOL_SLOTS    8
+#define SIDEWALK_STATUS_POOL_SLOTS 4
 
 typedef struct {
 	sys_snode_t node;
 	struct sid_msg msg;
 	struct sid_msg_desc desc;
+	uint32_t token;        /* msg_id returned to the app by send_msg() */
+	bool app;              /* from the app's send_msg(), not a platform uplink */
+	uint8_t inline_data[SIDEWALK_MSG_INLINE_MAX];
 } sidewalk_msg_t;
 
+/* Slots for queued uplinks (sidewalk_msg_t) and status events
+ * (struct sid_status); freed once the Sidewalk thread handles them. */
+extern struct msg_pool sidewalk_msg_pool;
+extern struct msg_pool sidewalk_status_pool;
+
 typedef struct {
 	enum sid_option option;
 	void *data;
@@ -40,8 +52,22 @@ typedef struct {
 
 void sidewalk_start(sidewalk_ctx_t *context);
 
+/**
+ * Queue a handler to run on the Sidewalk thread. sidewalk_event_process
+ * goes in the RADIO class, sidewalk_event_send_msg in UPLINK, anything
+ * else in CONTROL (see sidewalk_evq.h). Never blocks.
+ * @return 0 on success (ctx is freed by the thread), -ENOMSG if the
+ *         class is full (caller still owns ctx)
+ */
 int sidewalk_event_send(event_handler_t event, void *ctx, ctx_free free);
 
+/** Same, in an explicit class — e.g. OTA uplinks as CONTROL. */
+int sidewalk_event_send_class(enum sidewalk_evq_class cls, event_handler_t event,
+			      void *ctx, ctx_free free);
+
+/** Snapshot of the event queue counters for `sid status`. */
+void sidewalk_event_queue_stats(struct sidewalk_evq_stats *stats);
+
 /**
  * @brief Sidewalk initialization state tracking
  */
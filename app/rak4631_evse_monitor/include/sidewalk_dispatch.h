@@ -28,6 +28,24 @@ void sidewalk_dispatch_fill_callbacks(struct sid_event_callbacks *cbs,
  */
 int sidewalk_dispatch_register_gatt_auth(void);
 
+/**
+ * Record the Sidewalk message id assigned to an uplink so the sent/error
+ * callbacks can report the app's msg_id (token) instead. app is false
+ * for the platform's own uplinks (OTA), which report as msg_id 0.
+ * Called from the Sidewalk thread right after sid_put_msg().
+ */
+void sidewalk_dispatch_track_msg(uint16_t sid_id, uint32_t token, bool app);
+
+/**
+ * Report an uplink that never reached the stack (sid_put_msg failed)
+ * to the app as a send error. Like every send result, it reaches the
+ * app's on_send_error from the system work queue.
+ */
+void sidewalk_dispatch_send_failed(uint32_t token, int error);
+
+/** Send results lost because the work queue fell behind. */
+uint32_t sidewalk_dispatch_results_dropped(void);
+
 #ifdef __cplusplus
 }
 #endif
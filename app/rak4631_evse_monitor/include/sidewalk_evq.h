@@ -0,0 +1,90 @@
+/*
+ * Sidewalk Event Queue — prioritized, coalescing work queue for the
+ * Sidewalk thread
+ *
+ * Every call into the Sidewalk stack runs on one thread, fed through
+ * sidewalk_event_send(). Events are split into three classes, served
+ * strictly in order:
+ *
+ *   RADIO    sid_process() requests from the stack's event callback
+ *            (often from ISR). Duplicates of a pending handler collapse
+ *            into the one already queued — one sid_process() drains all
+ *            stack work, so a radio burst costs one slot, not one each.
+ *   CONTROL  status updates, link/init/reset requests, OTA uplinks
+ *   UPLINK   app uplinks (send_msg)
+ *
+ * Downlinks (and the OTA chunks in them) are delivered from sid_process(),
+ * so they are never stuck behind a backlog of app uplinks.
+ *
+ * Each class has its own ring; a full ring drops the new event and
+ * counts it, without affecting the other classes. The queue itself is
+ * not locked — sidewalk.c wraps it in a spinlock.
+ */
+
+#ifndef SIDEWALK_EVQ_H
+#define SIDEWALK_EVQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIDEWALK_EVQ_DEPTH  8   /* events per class */
+
+enum sidewalk_evq_class {
+	SIDEWALK_EVQ_RADIO = 0,
+	SIDEWALK_EVQ_CONTROL,
+	SIDEWALK_EVQ_UPLINK,
+	SIDEWALK_EVQ_CLASSES,
+};
+
+struct sidewalk_ctx;
+
+struct sidewalk_evq_event {
+	void (*handler)(struct sidewalk_ctx *sid, void *ctx);
+	void *ctx;
+	void (*ctx_free)(void *ctx);
+};
+
+struct sidewalk_evq_stats {
+	uint8_t depth;                               /* events queued now */
+	uint8_t high_water;                          /* most ever queued at once */
+	uint32_t coalesced;                          /* RADIO duplicates folded */
+	uint32_t dropped[SIDEWALK_EVQ_CLASSES];      /* refused, ring full */
+};
+
+struct sidewalk_evq_ring {
+	struct sidewalk_evq_event ev[SIDEWALK_EVQ_DEPTH];
+	uint8_t head;
+	uint8_t len;
+};
+
+struct sidewalk_evq {
+	struct sidewalk_evq_ring ring[SIDEWALK_EVQ_CLASSES];
+	struct sidewalk_evq_stats stats;
+};
+
+void sidewalk_evq_init(struct sidewalk_evq *q);
+
+/**
+ * Queue an event. A RADIO event whose handler is already pending is
+ * folded into it (its ctx is freed, if it has a ctx_free).
+ * @return 0 if queued or coalesced, -ENOMSG if the class ring is full
+ *         (the caller still owns ctx)
+ */
+int sidewalk_evq_push(struct sidewalk_evq *q, enum sidewalk_evq_class cls,
+		      const struct sidewalk_evq_event *ev);
+
+/**
+ * Take the next event: the oldest of the highest non-empty class.
+ * @return false if the queue is empty
+ */
+bool sidewalk_evq_pop(struct sidewalk_evq *q, struct sidewalk_evq_event *ev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIDEWALK_EVQ_H */
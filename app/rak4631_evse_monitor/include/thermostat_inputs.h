@@ -1,10 +1,15 @@
 /*
  * Thermostat Digital Input Interface
+ *
+ * On an API v8+ platform the cool call follows GPIO edge interrupts
+ * (thermostat_inputs_on_edge) and reads come from that; older platforms
+ * are read with gpio_get() on every call.
  */
 
 #ifndef THERMOSTAT_INPUTS_H
 #define THERMOSTAT_INPUTS_H
 
+#include <platform_api.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -15,10 +20,27 @@ extern "C" {
 /* Bit 0 reserved (heat call wired but unused in v1.0) */
 #define THERMOSTAT_FLAG_COOL    (1 << 1)
 
+/* GPIO pin index of the cool call — must match platform board-level mapping */
+#define THERMOSTAT_PIN_COOL     2
+
+/* Contactor bounce on the 24VAC call line settles well within this */
+#define THERMOSTAT_DEBOUNCE_MS  50
+
 int thermostat_inputs_init(void);
 bool thermostat_inputs_cool_call_get(void);
 uint8_t thermostat_inputs_flags_get(void);
 
+/**
+ * Apply a debounced cool-call edge. Returns false for other pins.
+ */
+bool thermostat_inputs_on_edge(const struct platform_gpio_edge *edge);
+
+/* True when the cool call is interrupt-driven rather than polled */
+bool thermostat_inputs_edge_driven(void);
+
+/* Uptime of the last cool-call change seen as an edge (0 = none yet) */
+uint32_t thermostat_inputs_changed_ms(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,6 +49,12 @@ int time_sync_process_cmd(const uint8_t *data, size_t len);
  */
 uint32_t time_sync_get_epoch(void);
 
+/**
+ * Device epoch at an earlier uptime (e.g. a GPIO edge's at_ms), rounded
+ * down to the second. Returns 0 if time has not been synced.
+ */
+uint32_t time_sync_epoch_at(uint32_t uptime_ms);
+
 /**
  * Get the most recent ACK watermark from the cloud.
  * Returns 0 if no TIME_SYNC has been received.
@@ -0,0 +1,175 @@
+/*
+ * ADC Sampler — cached readings from a continuous channel scan
+ *
+ * Single writer (the ADC callback), any number of thread readers. The
+ * writer fills the bank readers are not pointed at and then bumps the
+ * sequence counter. The callback runs to completion before an
+ * interrupted reader resumes, so a reader's bank can only be overwritten
+ * if two scans land during its copy; it then sees the counter move by
+ * two and copies again.
+ */
+
+#include <adc_sampler.h>
+
+#include <errno.h>
+#include <string.h>
+
+struct adc_bank {
+	int32_t mv[ADC_SAMPLER_MAX_CHANNELS];
+	int16_t raw[ADC_SAMPLER_MAX_CHANNELS][ADC_SAMPLER_BURST];
+	uint8_t samplings;
+	uint32_t ms;
+};
+
+static struct {
+	uint8_t channels;
+	uint8_t shift;
+	bool running;
+	int32_t acc[ADC_SAMPLER_MAX_CHANNELS];  /* EMA state, mV << shift (writer only) */
+	struct adc_bank bank[2];
+	atomic_t seq;                           /* scans published; bank[seq & 1] is the latest */
+	atomic_t retries;
+} sampler;
+
+void adc_sampler_init(uint8_t channels, uint8_t filter_shift)
+{
+	memset(&sampler, 0, sizeof(sampler));
+	sampler.channels = channels < ADC_SAMPLER_MAX_CHANNELS ?
+			   channels : ADC_SAMPLER_MAX_CHANNELS;
+	sampler.shift = filter_shift < 8 ? filter_shift : 8;
+	sampler.running = sampler.channels > 0;
+}
+
+/* Insertion sort: at most ADC_SAMPLER_BURST values, in the ISR */
+static int32_t burst_median(const int16_t *raw, uint8_t n)
+{
+	int16_t v[ADC_SAMPLER_BURST];
+
+	for (uint8_t i = 0; i < n; i++) {
+		uint8_t j = i;
+
+		for (; j > 0 && v[j - 1] > raw[i]; j--) {
+			v[j] = v[j - 1];
+		}
+		v[j] = raw[i];
+	}
+	return v[n / 2];
+}
+
+void adc_sampler_publish_burst(const int32_t *mv, uint8_t samplings, uint32_t now_ms)
+{
+	uint32_t seq = (uint32_t)atomic_get(&sampler.seq);
+	struct adc_bank *b = &sampler.bank[(seq + 1) & 1];
+	uint8_t n = samplings < ADC_SAMPLER_BURST ? samplings : ADC_SAMPLER_BURST;
+
+	if (n == 0) {
+		return;
+	}
+	for (uint8_t i = 0; i < sampler.channels; i++) {
+		for (uint8_t s = 0; s < n; s++) {
+			/* Single-ended inputs read a few counts below zero at 0V;
+			 * a negative reading would look like an error code */
+			int32_t v = mv[s * sampler.channels + i];
+
+			b->raw[i][s] = (int16_t)(v < 0 ? 0 : v > INT16_MAX ? INT16_MAX : v);
+		}
+
+		int32_t v = burst_median(b->raw[i], n);
+
+		if (seq == 0) {
+			sampler.acc[i] = v << sampler.shift;
+		} else {
+			sampler.acc[i] += v - (sampler.acc[i] >> sampler.shift);
+		}
+		b->mv[i] = sampler.acc[i] >> sampler.shift;
+	}
+	b->samplings = n;
+	b->ms = now_ms;
+	atomic_set(&sampler.seq, (atomic_val_t)(seq + 1));
+}
+
+void adc_sampler_publish(const int32_t *mv, uint32_t now_ms)
+{
+	adc_sampler_publish_burst(mv, 1, now_ms);
+}
+
+int adc_sampler_get(int channel, uint32_t now_ms, uint32_t *sample_ms)
+{
+	if (channel < 0 || channel >= sampler.channels) {
+		return -EINVAL;
+	}
+
+	int32_t mv;
+	uint32_t ms;
+
+	for (;;) {
+		uint32_t seq = (uint32_t)atomic_get(&sampler.seq);
+
+		if (seq == 0) {
+			return -EAGAIN;
+		}
+		mv = sampler.bank[seq & 1].mv[channel];
+		ms = sampler.bank[seq & 1].ms;
+		if ((uint32_t)atomic_get(&sampler.seq) - seq < 2) {
+			break;
+		}
+		atomic_inc(&sampler.retries);
+	}
+
+	if (now_ms - ms > ADC_SAMPLER_STALE_MS) {
+		return -ETIMEDOUT;
+	}
+	if (sample_ms) {
+		*sample_ms = ms;
+	}
+	return (int)mv;
+}
+
+int adc_sampler_get_burst(int channel, uint32_t now_ms, int16_t *mv, size_t max,
+			  uint32_t *sample_ms)
+{
+	if (channel < 0 || channel >= sampler.channels || !mv) {
+		return -EINVAL;
+	}
+
+	size_t n;
+	uint32_t ms;
+
+	for (;;) {
+		uint32_t seq = (uint32_t)atomic_get(&sampler.seq);
+		const struct adc_bank *b = &sampler.bank[seq & 1];
+
+		if (seq == 0) {
+			return -EAGAIN;
+		}
+		n = b->samplings < max ? b->samplings : max;
+		memcpy(mv, b->raw[channel], n * sizeof(mv[0]));
+		ms = b->ms;
+		if ((uint32_t)atomic_get(&sampler.seq) - seq < 2) {
+			break;
+		}
+		atomic_inc(&sampler.retries);
+	}
+
+	if (now_ms - ms > ADC_SAMPLER_STALE_MS) {
+		return -ETIMEDOUT;
+	}
+	if (sample_ms) {
+		*sample_ms = ms;
+	}
+	return (int)n;
+}
+
+bool adc_sampler_running(void)
+{
+	return sampler.running;
+}
+
+void adc_sampler_stats(struct adc_sampler_stats *stats)
+{
+	uint32_t seq = (uint32_t)atomic_get(&sampler.seq);
+
+	stats->scans = seq;
+	stats->last_ms = seq ? sampler.bank[seq & 1].ms : 0;
+	stats->retries = (uint32_t)atomic_get(&sampler.retries);
+}
@@ -1,8 +1,9 @@
 /*
  * Platform-side App Loader — Boot Sequence
  *
- * Discovers the app callback table at 0x90000, initializes OTA,
- * configures Sidewalk, and starts the periodic timer.
+ * Picks the A/B slot to boot from the boot record, discovers the app
+ * callback table at its start (falling back to the other slot), initializes
+ * OTA, configures Sidewalk, and starts the periodic timer.
  */
 
 #include <sidewalk.h>
@@ -13,9 +14,13 @@
 #include <app_subGHz_config.h>
 #include <platform_api.h>
 #include <ota_update.h>
+#include <ota_boot.h>
 #include <sidewalk_dispatch.h>
+#include <tx_state.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/logging/log_ctrl.h>
+#include <zephyr/sys/reboot.h>
 #include <string.h>
 #ifdef CONFIG_SIDEWALK_FILE_TRANSFER_DFU
 #include <sbdt/dfu_file_transfer.h>
@@ -28,14 +33,18 @@ LOG_MODULE_REGISTER(app, CONFIG_SIDEWALK_LOG_LEVEL);
 /* ------------------------------------------------------------------ */
 
 extern const struct platform_api platform_api_table;
+extern int platform_send_ota_msg(const uint8_t *data, size_t len);
+extern int platform_adc_start(void);
 
 /* ------------------------------------------------------------------ */
 /*  App callback table discovery                                       */
 /* ------------------------------------------------------------------ */
 
 #ifdef HOST_TEST
-/* Test mode: discover_app_image reads from this pointer instead of flash */
+/* Test mode: discover_app_image reads slot A's and slot B's callback tables
+ * from these pointers instead of flash */
 const struct app_callbacks *test_app_cb_addr;
+const struct app_callbacks *test_app_cb_b;
 #endif
 
 static const struct app_callbacks *app_cb;
@@ -56,31 +65,25 @@ const char *app_get_reject_reason(void)
 	return app_reject_reason;
 }
 
-#ifdef HOST_TEST
-void
-#else
-static void
-#endif
-discover_app_image(void)
+/* Check the callback table at the start of a slot.
+ * Returns NULL if it can be used, else why not. */
+static const char *check_app_image(uint8_t slot, const struct app_callbacks **out)
 {
+	uint32_t addr = ota_boot_slot_addr(slot);
 #ifdef HOST_TEST
-	const struct app_callbacks *cb = test_app_cb_addr;
+	const struct app_callbacks *cb = slot == OTA_SLOT_A ? test_app_cb_addr : test_app_cb_b;
+	ARG_UNUSED(addr);   /* only logged */
 	if (!cb) {
-		app_cb = NULL;
-		app_reject_reason = "no test address set";
-		return;
+		return "no test address set";
 	}
 #else
-	const struct app_callbacks *cb =
-		(const struct app_callbacks *)APP_CALLBACKS_ADDR;
+	const struct app_callbacks *cb = (const struct app_callbacks *)addr;
 #endif
 
 	if (cb->magic != APP_CALLBACK_MAGIC) {
 		LOG_ERR("No valid app image at 0x%08x (magic=0x%08x, expected=0x%08x)",
-			APP_CALLBACKS_ADDR, cb->magic, APP_CALLBACK_MAGIC);
-		app_cb = NULL;
-		app_reject_reason = "bad magic";
-		return;
+			addr, cb->magic, APP_CALLBACK_MAGIC);
+		return "bad magic";
 	}
 
 	if (cb->version != APP_CALLBACK_VERSION) {
@@ -96,14 +99,50 @@ discover_app_image(void)
 		LOG_ERR("App API version mismatch (app=%u, platform=%u) — refusing to load. "
 			"Mismatched function pointer tables cause hard faults.",
 			cb->version, APP_CALLBACK_VERSION);
-		app_cb = NULL;
-		app_reject_reason = "version mismatch";
-		return;
+		return "version mismatch";
+	}
+
+#ifndef HOST_TEST
+	/* Each slot has its own build (app.ld linked at the slot address):
+	 * a table pointing outside the slot belongs to the other one */
+	if (cb->init && (uint32_t)(uintptr_t)cb->init - addr >= OTA_SLOT_SIZE) {
+		LOG_ERR("App image at 0x%08x is linked for another slot (init=%p)",
+			addr, cb->init);
+		return "linked for other slot";
 	}
+#endif
 
-	app_cb = cb;
-	app_reject_reason = NULL;
-	LOG_INF("App image found at 0x%08x (version %u)", APP_CALLBACKS_ADDR, cb->version);
+	*out = cb;
+	return NULL;
+}
+
+#ifdef HOST_TEST
+void
+#else
+static void
+#endif
+discover_app_image(void)
+{
+	uint8_t slot = ota_boot_active_slot();
+	const struct app_callbacks *cb = NULL;
+	const char *reason = check_app_image(slot, &cb);
+
+	/* Active slot unusable: boot the other one if it still holds the
+	 * image it had, and make the switch stick */
+	if (reason && ota_boot_slot_valid(slot ^ 1) &&
+	    !check_app_image(slot ^ 1, &cb) && ota_boot_revert() == 0) {
+		LOG_WRN("Slot %c: %s, fell back to slot %c", OTA_SLOT_NAME(slot),
+			reason, OTA_SLOT_NAME(slot ^ 1));
+		slot ^= 1;
+		reason = NULL;
+	}
+
+	app_cb = reason ? NULL : cb;
+	app_reject_reason = reason;
+	if (!reason) {
+		LOG_INF("App image found at 0x%08x (slot %c, version %u)",
+			ota_boot_slot_addr(slot), OTA_SLOT_NAME(slot), cb->version);
+	}
 }
 
 /* ------------------------------------------------------------------ */
@@ -123,13 +162,14 @@ void app_route_message(const uint8_t *data, size_t len)
 }
 
 /* ------------------------------------------------------------------ */
-/*  Timer — periodic sensor/TX tick                                    */
+/*  Timer — app_on_timer, re-armed by the app for its next deadline    */
 /* ------------------------------------------------------------------ */
 
 #define NOTIFY_TIMER_INITIAL_MS (10000)
 #define NOTIFY_TIMER_DEFAULT_MS (60000)
 
 static uint32_t timer_interval_ms;  /* 0 = use default */
+static bool timer_running;
 
 static void notify_timer_cb(struct k_timer *timer_id);
 K_TIMER_DEFINE(notify_timer, notify_timer_cb, NULL);
@@ -149,16 +189,114 @@ static void notify_timer_cb(struct k_timer *timer_id)
 	k_work_submit(&timer_work);
 }
 
+/* Once the timer runs, a new interval restarts it: the next on_timer
+ * comes interval_ms from now. It stays periodic, so an app that sets one
+ * interval at init still gets a steady tick; a tickless app re-arms it
+ * for its next deadline on every call. */
 int app_set_timer_interval(uint32_t interval_ms)
 {
 	if (interval_ms < 100 || interval_ms > 300000) {
 		return -1;
 	}
 	timer_interval_ms = interval_ms;
-	LOG_INF("Timer interval set to %u ms", interval_ms);
+	if (timer_running) {
+		k_timer_start(&notify_timer, K_MSEC(interval_ms), K_MSEC(interval_ms));
+	}
+	LOG_DBG("Timer interval set to %u ms", interval_ms);
 	return 0;
 }
 
+/* ------------------------------------------------------------------ */
+/*  GPIO edges — batches from the platform's edge work item            */
+/* ------------------------------------------------------------------ */
+
+void app_notify_gpio_edges(const struct platform_gpio_edge *edges, size_t count)
+{
+	if (app_image_valid() && app_cb->on_gpio_edges) {
+		app_cb->on_gpio_edges(edges, count);
+	}
+}
+
+/* ------------------------------------------------------------------ */
+/*  Trial image — init, confirm or roll back                            */
+/* ------------------------------------------------------------------ */
+
+/* A trial image confirms itself with its first uplink (sidewalk_dispatch.c).
+ * One that stays silent for APP_TRIAL_CONFIRM_MIN minutes of link-up time
+ * is rolled back; minutes without a link do not count against it. */
+#define APP_TRIAL_CHECK_MS      60000
+#define APP_TRIAL_CONFIRM_MIN   30
+
+static uint32_t trial_ready_min;
+
+static void trial_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(trial_work, trial_work_handler);
+
+static void trial_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+	if (!ota_boot_in_trial()) {
+		return;
+	}
+	if (tx_state_is_ready() && ++trial_ready_min >= APP_TRIAL_CONFIRM_MIN) {
+		if (ota_boot_revert() == 0) {
+			LOG_ERR("App sent no uplink in %u min on trial, rolled back, rebooting",
+				APP_TRIAL_CONFIRM_MIN);
+			LOG_PANIC();
+			sys_reboot(SYS_REBOOT_WARM);
+		}
+		return;
+	}
+	k_work_schedule(&trial_work, K_MSEC(APP_TRIAL_CHECK_MS));
+}
+
+static int start_app(void)
+{
+#ifndef HOST_TEST
+	/* Zero app RAM before init (no C runtime BSS init in split-image arch) */
+	memset((void *)APP_RAM_ADDR, 0, APP_RAM_SIZE);
+#endif
+	return app_cb->init(&platform_api_table);
+}
+
+/* Initialize the discovered app. A trial image whose init() fails is
+ * rolled back on the spot and the other slot's app started instead,
+ * without a reboot. */
+#ifdef HOST_TEST
+void
+#else
+static void
+#endif
+init_app_image(void)
+{
+	if (!app_image_valid() || !app_cb->init) {
+		LOG_WRN("Running in platform-only mode (no app image)");
+		return;
+	}
+
+	int err = start_app();
+
+	if (err && ota_boot_in_trial() && ota_boot_revert() == 0) {
+		LOG_ERR("App init failed on trial: %d, starting slot %c",
+			err, OTA_SLOT_NAME(ota_boot_active_slot()));
+		discover_app_image();
+		if (app_image_valid() && app_cb->init) {
+			err = start_app();
+		}
+	}
+	if (err) {
+		LOG_ERR("App init failed: %d", err);
+		app_cb = NULL;
+	} else {
+		LOG_INF("App loaded and initialized");
+	}
+
+	if (ota_boot_in_trial()) {
+		trial_ready_min = 0;
+		k_work_schedule(&trial_work, K_MSEC(APP_TRIAL_CHECK_MS));
+	}
+}
+
 /* ------------------------------------------------------------------ */
 /*  App start — boot sequence                                          */
 /* ------------------------------------------------------------------ */
@@ -168,6 +306,7 @@ static sidewalk_ctx_t sid_ctx;
 static void prepare_for_ota_apply(void)
 {
 	LOG_WRN("OTA: stopping app callbacks for apply");
+	timer_running = false;
 	k_timer_stop(&notify_timer);
 	app_cb = NULL;
 }
@@ -180,32 +319,22 @@ void app_start(void)
 		LOG_ERR("Cannot init leds");
 	}
 
-	/* Initialize OTA module and check for interrupted apply */
-	ota_init(platform_api_table.send_msg);
+	/* Sensor scan runs from here on; the app's ADC reads are cached */
+	platform_adc_start();
+
+	/* Pick the A/B slot (counts a trial boot), then initialize OTA and
+	 * check for an interrupted apply */
+	ota_boot_init();
+	ota_init(platform_send_ota_msg);
 	ota_set_pre_apply_hook(prepare_for_ota_apply);
 	if (ota_boot_recovery_check()) {
 		/* Recovery in progress — will reboot when done */
 		return;
 	}
 
-	/* Discover app image */
+	/* Discover and initialize the app image */
 	discover_app_image();
-
-	/* Zero app RAM before init (no C runtime BSS init in split-image arch) */
-	memset((void *)APP_RAM_ADDR, 0, APP_RAM_SIZE);
-
-	/* Initialize app if present */
-	if (app_image_valid() && app_cb->init) {
-		int err = app_cb->init(&platform_api_table);
-		if (err) {
-			LOG_ERR("App init failed: %d", err);
-			app_cb = NULL;
-		} else {
-			LOG_INF("App loaded and initialized");
-		}
-	} else {
-		LOG_WRN("Running in platform-only mode (no app image)");
-	}
+	init_app_image();
 
 	/* Configure Sidewalk */
 	static struct sid_event_callbacks event_callbacks;
@@ -236,8 +365,9 @@ void app_start(void)
 	sidewalk_event_send(sidewalk_event_platform_init, NULL, NULL);
 	sidewalk_event_send(sidewalk_event_autostart, NULL, NULL);
 
-	/* Start periodic timer — interval configurable via app's set_timer_interval() */
+	/* Start the app timer — the app re-arms it via set_timer_interval() */
 	uint32_t interval = timer_interval_ms ? timer_interval_ms : NOTIFY_TIMER_DEFAULT_MS;
 	LOG_INF("Starting app timer (10s delay, %ums period)", interval);
 	k_timer_start(&notify_timer, K_MSEC(NOTIFY_TIMER_INITIAL_MS), K_MSEC(interval));
+	timer_running = true;
 }
@@ -0,0 +1,198 @@
+/*
+ * Airtime Budget — link-aware uplink rate limiter
+ */
+
+#include <airtime_budget.h>
+#include <string.h>
+
+/* Sidewalk link mask bits (SID_LINK_TYPE_1/2/3) */
+#define LINK_MASK_FSK   0x02
+#define LINK_MASK_LORA  0x04
+
+#define WINDOW_BIN_MS   (3600000u / AIRTIME_WINDOW_BINS)
+
+struct link_limits {
+	uint32_t interval_ms;   /* one frame of credit per interval */
+	uint32_t depth;         /* frames the bucket holds */
+};
+
+static const struct link_limits limits[] = {
+	[AIRTIME_LINK_BLE]  = { .interval_ms = 1000, .depth = 5 },
+	[AIRTIME_LINK_FSK]  = { .interval_ms = 5000, .depth = 2 },
+	[AIRTIME_LINK_LORA] = { .interval_ms = 5000, .depth = 2 },
+};
+
+/* Frame bucket, in ms of refill time for bucket_link */
+static enum airtime_link bucket_link;
+static uint32_t bucket_ms;
+static uint32_t bucket_stamp_ms;
+
+/* Rolling hour of LoRa/FSK airtime: bin_us[i] covers 5-minute slot
+ * bin_slot[i]; a bin from an older slot is stale and reads as zero */
+static uint32_t bin_us[AIRTIME_WINDOW_BINS];
+static uint32_t bin_slot[AIRTIME_WINDOW_BINS];
+
+enum airtime_link airtime_link_from_mask(uint32_t link_mask)
+{
+	if (link_mask & LINK_MASK_LORA || link_mask == 0) {
+		return AIRTIME_LINK_LORA;
+	}
+	if (link_mask & LINK_MASK_FSK) {
+		return AIRTIME_LINK_FSK;
+	}
+	return AIRTIME_LINK_BLE;
+}
+
+/* Semtech AN1200.13: 125 kHz, CR 4/5, 8-symbol preamble, explicit
+ * header, CRC on, low-data-rate optimisation from SF11 */
+static uint32_t lora_airtime_us(size_t len, uint32_t sf)
+{
+	uint32_t tsym_us = (1u << sf) * 8u;   /* 2^SF / 125 kHz */
+	uint32_t de = (sf >= 11) ? 1 : 0;
+	int32_t num = 8 * (int32_t)len - 4 * (int32_t)sf + 28 + 16;
+	int32_t den = 4 * (int32_t)(sf - 2 * de);
+	uint32_t blocks = (num > 0) ? (uint32_t)((num + den - 1) / den) : 0;
+	uint32_t symbols = 8 + blocks * 5;
+
+	/* preamble is 8 + 4.25 symbols */
+	return tsym_us * 49u / 4u + symbols * tsym_us;
+}
+
+uint32_t airtime_estimate_us(enum airtime_link link, size_t len)
+{
+	size_t frame = len + AIRTIME_FRAME_OVERHEAD;
+
+	switch (link) {
+	case AIRTIME_LINK_LORA:
+		return lora_airtime_us(frame, AIRTIME_LORA_SF);
+	case AIRTIME_LINK_FSK:
+		/* 50 kbps; preamble, sync word, header and CRC add 11 bytes */
+		return (uint32_t)(frame + 11) * 8u * 20u;
+	default:
+		/* BLE 1M PHY: 10 bytes of link-layer framing */
+		return (uint32_t)(frame + 10) * 8u;
+	}
+}
+
+void airtime_budget_init(void)
+{
+	bucket_link = AIRTIME_LINK_LORA;
+	bucket_ms = limits[AIRTIME_LINK_LORA].interval_ms * limits[AIRTIME_LINK_LORA].depth;
+	bucket_stamp_ms = 0;
+	memset(bin_us, 0, sizeof(bin_us));
+	memset(bin_slot, 0, sizeof(bin_slot));
+}
+
+/* Refill the frame bucket for link, rescaling credit on a link change */
+static void bucket_refill(enum airtime_link link, uint32_t now)
+{
+	const struct link_limits *l = &limits[link];
+	uint32_t full = l->interval_ms * l->depth;
+
+	if (link != bucket_link) {
+		/* Keep the fill level: a full bucket stays full */
+		const struct link_limits *old = &limits[bucket_link];
+		uint32_t old_full = old->interval_ms * old->depth;
+		bucket_ms = (uint32_t)((uint64_t)bucket_ms * full / old_full);
+		bucket_link = link;
+	}
+
+	uint32_t elapsed = now - bucket_stamp_ms;
+	bucket_stamp_ms = now;
+	bucket_ms = (bucket_ms >= full || elapsed >= full - bucket_ms)
+		    ? full : bucket_ms + elapsed;
+}
+
+static uint32_t window_used_us(uint32_t now)
+{
+	uint32_t slot = now / WINDOW_BIN_MS;
+	uint32_t used = 0;
+
+	for (int i = 0; i < AIRTIME_WINDOW_BINS; i++) {
+		if (slot - bin_slot[i] < AIRTIME_WINDOW_BINS) {
+			used += bin_us[i];
+		}
+	}
+	return used;
+}
+
+bool airtime_budget_allows(uint32_t link_mask, size_t len, bool background,
+			   uint32_t now_ms)
+{
+	enum airtime_link link = airtime_link_from_mask(link_mask);
+	const struct link_limits *l = &limits[link];
+
+	bucket_refill(link, now_ms);
+	uint32_t need = background ? l->interval_ms * l->depth : l->interval_ms;
+	if (bucket_ms < need) {
+		return false;
+	}
+
+	if (link == AIRTIME_LINK_BLE) {
+		return true;
+	}
+
+	uint32_t budget_us = AIRTIME_HOURLY_BUDGET_MS * 1000u;
+	if (background) {
+		budget_us -= AIRTIME_LIVE_RESERVE_MS * 1000u;
+	}
+	return window_used_us(now_ms) + airtime_estimate_us(link, len) <= budget_us;
+}
+
+uint32_t airtime_budget_wait_ms(uint32_t link_mask, size_t len, bool background,
+				uint32_t now_ms)
+{
+	enum airtime_link link = airtime_link_from_mask(link_mask);
+	const struct link_limits *l = &limits[link];
+
+	bucket_refill(link, now_ms);
+
+	uint32_t need = background ? l->interval_ms * l->depth : l->interval_ms;
+	uint32_t wait = (bucket_ms < need) ? need - bucket_ms : 0;
+
+	if (link == AIRTIME_LINK_BLE) {
+		return wait;
+	}
+
+	uint32_t budget_us = AIRTIME_HOURLY_BUDGET_MS * 1000u;
+	if (background) {
+		budget_us -= AIRTIME_LIVE_RESERVE_MS * 1000u;
+	}
+	if (window_used_us(now_ms) + airtime_estimate_us(link, len) > budget_us) {
+		/* Airtime comes back as the oldest bin ages out */
+		uint32_t to_bin = WINDOW_BIN_MS - now_ms % WINDOW_BIN_MS;
+
+		if (to_bin > wait) {
+			wait = to_bin;
+		}
+	}
+	return wait;
+}
+
+void airtime_budget_spend(uint32_t link_mask, size_t len, uint32_t now_ms)
+{
+	enum airtime_link link = airtime_link_from_mask(link_mask);
+	uint32_t interval = limits[link].interval_ms;
+
+	bucket_refill(link, now_ms);
+	bucket_ms = (bucket_ms > interval) ? bucket_ms - interval : 0;
+
+	if (link == AIRTIME_LINK_BLE) {
+		return;
+	}
+
+	uint32_t slot = now_ms / WINDOW_BIN_MS;
+	int i = slot % AIRTIME_WINDOW_BINS;
+	if (bin_slot[i] != slot) {
+		bin_slot[i] = slot;
+		bin_us[i] = 0;
+	}
+	bin_us[i] += airtime_estimate_us(link, len);
+}
+
+uint32_t airtime_budget_remaining_ms(uint32_t now_ms)
+{
+	uint32_t used_ms = (window_used_us(now_ms) + 999u) / 1000u;
+	return (used_ms >= AIRTIME_HOURLY_BUDGET_MS) ? 0
+	       : AIRTIME_HOURLY_BUDGET_MS - used_ms;
+}
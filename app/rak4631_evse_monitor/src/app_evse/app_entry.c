@@ -27,6 +27,8 @@
 #include <time_sync.h>
 #include <event_buffer.h>
 #include <event_filter.h>
+#include <drain_inflight.h>
+#include <airtime_budget.h>
 #include <led_engine.h>
 #include <string.h>
 
@@ -34,23 +36,48 @@
 /*  Polling and change detection                                       */
 /* ------------------------------------------------------------------ */
 
-#define POLL_INTERVAL_MS        100
-#define SENSOR_DECIMATION       5
+#define POLL_INTERVAL_MS        LED_TICK_MS  /* shortest timer wait */
+#define SENSOR_POLL_MS          500      /* sensor cycle while active */
+#define IDLE_POLL_MS            5000     /* sensor cycle with no vehicle */
+#define MAX_WAIT_MS             300000
 #ifndef HEARTBEAT_INTERVAL_MS
 #define HEARTBEAT_INTERVAL_MS   900000   /* 15 min; override with -DHEARTBEAT_INTERVAL_MS=60000 for dev */
 #endif
-static uint8_t decimation_counter;
 static j1772_state_t last_j1772_state;
 static bool last_current_on;
 static uint8_t last_thermostat_flags;
 static uint32_t last_heartbeat_ms;
 
-/* Event buffer drain state — walks buffer sending one entry per rate-limit window.
- * Drain only starts after the first live uplink so initial state is established. */
-static uint8_t drain_cursor;
-static uint32_t drain_oldest_ts;
+/* Readings of the last sensor cycle, for snapshots recorded between
+ * cycles. A thermostat edge records its change at once but leaves the
+ * uplink to the next cycle, so a burst of edges sends once. */
+static uint16_t last_pilot_mv;
+static uint16_t last_current_ma;
+static bool change_unsent;
+
+/* Event buffer drain state — walks buffer sending one batch per rate-limit window.
+ * Drain only starts after the first live uplink so initial state is established.
+ * The cursor is sequence-based, so ACK trims never shift it. Frames past the
+ * cursor stay in drain_inflight until the platform confirms them; failed
+ * frames are rebuilt from their sequence range and sent again. */
+static event_buffer_cursor_t drain_cursor;
 static bool drain_active;
 
+/* Tickless timer: app_on_timer() re-arms set_timer_interval() with the
+ * earliest module deadline. The sensor cycle runs on any wake at least
+ * SENSOR_POLL_MS after the last one; the LED engine catches up on the
+ * 100ms ticks it slept through. */
+static uint32_t last_cycle_ms;
+static uint32_t led_tick_ms;
+static uint32_t timer_armed_ms;
+static uint32_t timer_wait_ms;
+
+/* app_wake() also runs on the Sidewalk and shell threads, so it leaves
+ * the two above to arm_timer() on the work queue and only flags that
+ * it restarted the timer behind them. */
+static volatile bool timer_woken;
+static volatile uint32_t timer_woken_ms;
+
 /* ------------------------------------------------------------------ */
 /*  Shell command dispatch table                                       */
 /* ------------------------------------------------------------------ */
@@ -76,9 +103,17 @@ static int shell_evse_status(void (*print)(const char *, ...), void (*error)(con
 	charge_control_state_t cc_state;
 	charge_control_get_state(&cc_state);
 
+	struct evse_pilot_config pilot;
+	struct evse_pilot_stats pilot_stats;
+	evse_pilot_config_get(&pilot);
+	evse_pilot_stats_get(&pilot_stats);
+
 	print("EVSE Status:");
 	print("  J1772 state: %s", evse_j1772_state_to_string(state));
 	print("  Pilot voltage: %d mV", voltage_mv);
+	print("  Pilot filter: %d mV hysteresis, %d-read debounce "
+	      "(%u changes, %u suppressed)", pilot.hysteresis_mv, pilot.debounce,
+	      pilot_stats.transitions, pilot_stats.suppressed);
 	print("  Current: %d mA", current_ma);
 	print("  Charging allowed: %s", cc_state.charging_allowed ? "YES" : "NO");
 	print("  Charge Now active: %s", charge_now_is_active() ? "YES" : "NO");
@@ -92,9 +127,40 @@ static int shell_hvac_status(void (*print)(const char *, ...), void (*error)(con
 	uint8_t flags = thermostat_inputs_flags_get();
 	print("Thermostat flags: 0x%02x", flags);
 	print("  Cool: %s", (flags & THERMOSTAT_FLAG_COOL) ? "ON" : "OFF");
+	if (!thermostat_inputs_edge_driven()) {
+		print("  Input: polled");
+	} else if (thermostat_inputs_changed_ms()) {
+		print("  Input: edge interrupts, last change %u ms ago",
+		      platform->uptime_ms() - thermostat_inputs_changed_ms());
+	} else {
+		print("  Input: edge interrupts, no change yet");
+	}
 	return 0;
 }
 
+/* ------------------------------------------------------------------ */
+/*  Event log restore                                                  */
+/* ------------------------------------------------------------------ */
+
+/* Reload un-ACKed snapshots persisted by the platform before the last
+ * reset. The RAM buffer keeps the newest ones if the log holds more. */
+static void restore_event_buffer(void)
+{
+	if (!app_platform_has_event_log()) {
+		return;
+	}
+
+	struct event_snapshot snap;
+	uint32_t restored = 0;
+	while (platform->log_read(restored, &snap, sizeof(snap)) == 0) {
+		event_buffer_add(&snap);
+		restored++;
+	}
+	if (restored) {
+		platform->log_inf("Restored %u events from flash log", restored);
+	}
+}
+
 /* ------------------------------------------------------------------ */
 /*  Callback implementations                                          */
 /* ------------------------------------------------------------------ */
@@ -122,6 +188,7 @@ static int app_init(const struct platform_api *api)
 	time_sync_init();
 	delay_window_init();
 	event_buffer_init();
+	restore_event_buffer();
 	event_filter_init();
 	charge_now_init();
 	app_tx_init();
@@ -137,38 +204,82 @@ static int app_init(const struct platform_api *api)
 			     selftest_get_fault_flags());
 	}
 
-	/* Request 500ms poll interval from platform */
+	/* First wake one LED tick out; app_on_timer() schedules from there */
+	timer_armed_ms = platform->uptime_ms();
+	timer_wait_ms = POLL_INTERVAL_MS;
+	timer_woken = false;
 	platform->set_timer_interval(POLL_INTERVAL_MS);
 
 	/* Read initial sensor state */
 	uint16_t mv = 0;
 	evse_j1772_state_get(&last_j1772_state, &mv);
+	last_pilot_mv = mv;
 
 	uint16_t ma = 0;
 	if (evse_current_read(&ma) == 0) {
 		last_current_on = (ma >= CURRENT_ON_THRESHOLD_MA);
 	}
+	last_current_ma = ma;
+	change_unsent = false;
 
 	last_thermostat_flags = thermostat_inputs_flags_get();
 	last_heartbeat_ms = platform->uptime_ms();
-	decimation_counter = 0;
+	last_cycle_ms = timer_armed_ms;
+	led_tick_ms = timer_armed_ms;
 	drain_active = false;
-	drain_cursor = 0;
-	drain_oldest_ts = 0;
+	event_buffer_cursor_init(&drain_cursor);
+	drain_inflight_init();
 
-	platform->log_inf("App initialized (build v%d, API v%d, poll=%dms)",
-		     APP_BUILD_VERSION, APP_CALLBACK_VERSION, POLL_INTERVAL_MS);
+	platform->log_inf("App initialized (build v%d, API v%d, poll=%d/%dms)",
+		     APP_BUILD_VERSION, APP_CALLBACK_VERSION, SENSOR_POLL_MS, IDLE_POLL_MS);
 	return 0;
 }
 
+static void arm_timer(uint32_t now, uint32_t wait_ms)
+{
+	timer_armed_ms = now;
+	if (wait_ms != timer_wait_ms || timer_woken) {
+		timer_woken = false;
+		timer_wait_ms = wait_ms;
+		platform->set_timer_interval(wait_ms);
+	}
+}
+
+/* Something outside the timer changed module state (a downlink, a send
+ * result, an input edge): look again at the deadlines within one LED
+ * tick, unless the timer fires sooner anyway. */
+static void app_wake(void)
+{
+	if (!platform) {
+		return;
+	}
+
+	uint32_t now = platform->uptime_ms();
+	uint32_t elapsed = now - timer_armed_ms;
+
+	if (elapsed < timer_wait_ms && timer_wait_ms - elapsed <= POLL_INTERVAL_MS) {
+		return;
+	}
+	if (timer_woken && now - timer_woken_ms < POLL_INTERVAL_MS) {
+		return;
+	}
+	/* Flag after the restart: an on_timer() that runs in between sees
+	 * the new state anyway, and the flag makes the next one re-arm */
+	timer_woken_ms = now;
+	platform->set_timer_interval(POLL_INTERVAL_MS);
+	timer_woken = true;
+}
+
 static void app_on_ready(bool ready)
 {
 	app_tx_set_ready(ready);
+	app_wake();
 }
 
 static void app_on_msg_received(const uint8_t *data, size_t len)
 {
 	app_rx_process_msg(data, len);
+	app_wake();
 }
 
 static void app_on_msg_sent(uint32_t msg_id)
@@ -176,38 +287,127 @@ static void app_on_msg_sent(uint32_t msg_id)
 	if (platform) {
 		platform->log_inf("Message %u sent OK", msg_id);
 	}
+	drain_inflight_confirm(msg_id);
 	led_engine_notify_uplink_sent();
+	app_wake();
 }
 
 static void app_on_send_error(uint32_t msg_id, int error)
 {
 	if (platform) {
 		platform->log_err("Message %u send error: %d", msg_id, error);
+		if (drain_inflight_fail(msg_id, platform->uptime_ms())) {
+			platform->log_wrn("Drain frame %u scheduled for retry", msg_id);
+		}
 	}
+	app_wake();
 }
 
-static void app_on_timer(void)
+/* Collect up to APP_TX_BATCH_MAX entries from cur, stopping at end_seq */
+static int drain_collect(event_buffer_cursor_t *cur, uint32_t end_seq,
+			 struct event_snapshot *batch)
 {
-	if (!platform) {
+	int n = 0;
+	while (n < APP_TX_BATCH_MAX && cur->seq < end_seq &&
+	       event_buffer_cursor_peek(cur, &batch[n])) {
+		event_buffer_cursor_advance(cur);
+		n++;
+	}
+	return n;
+}
+
+/* One drain step: retransmit a failed frame if one is due, else send the
+ * next entries past drain_cursor while in-flight slots are free. */
+static void drain_tick(uint32_t now)
+{
+	struct event_snapshot batch[APP_TX_BATCH_MAX];
+	uint32_t msg_id = 0;
+	uint32_t first_seq;
+	uint8_t count;
+
+	int slot = drain_inflight_due(now, &first_seq, &count);
+	if (slot >= 0) {
+		event_buffer_cursor_t scan;
+		event_buffer_cursor_init(&scan);
+		if (scan.seq < first_seq) {
+			scan.seq = first_seq;
+		}
+		uint32_t start = scan.seq;
+		int n = drain_collect(&scan, first_seq + count, batch);
+		if (n == 0) {
+			/* Everything in the range was ACKed or overwritten */
+			drain_inflight_drop(slot);
+			return;
+		}
+		int ret = app_tx_send_batch(batch, n, &msg_id);
+		if (ret > 0) {
+			drain_inflight_resent(slot, msg_id, start, (uint8_t)ret, now);
+		}
 		return;
 	}
 
-	/* LED engine ticks every 100ms (every call) */
-	led_engine_tick();
+	if (!drain_inflight_can_send()) {
+		return;
+	}
 
-	/* All other logic runs at the original 500ms rate */
-	decimation_counter++;
-	if (decimation_counter < SENSOR_DECIMATION) {
+	event_buffer_cursor_t scan = drain_cursor;
+	int n = drain_collect(&scan, UINT32_MAX, batch);
+	if (n == 0) {
 		return;
 	}
-	decimation_counter = 0;
+	uint32_t start = scan.seq - n;
+	int ret = app_tx_send_batch(batch, n, &msg_id);
+	/* ret > 0: that many entries went out in one frame. Skip any
+	 * entries trimmed under the cursor first so it lands past them. */
+	if (ret > 0 && drain_cursor.seq < start) {
+		drain_cursor.seq = start;
+	}
+	for (int i = 0; i < ret; i++) {
+		event_buffer_cursor_advance(&drain_cursor);
+	}
+	if (ret > 0) {
+		drain_inflight_sent(msg_id, start, (uint8_t)ret, now);
+	}
+	/* ret == 0: rate-limited, retry next tick */
+	/* ret < 0: send error, retry next tick */
+}
 
-	/* Check auto-resume timer */
-	charge_control_tick();
+/* Record the current state in the event buffer, stamped with event_ms */
+static void record_snapshot(uint32_t event_ms)
+{
+	struct event_snapshot snap = {
+		.timestamp = time_sync_epoch_at(event_ms),
+		.pilot_voltage_mv = last_pilot_mv,
+		.current_ma = last_current_ma,
+		.j1772_state = (uint8_t)last_j1772_state,
+		.thermostat_flags = last_thermostat_flags,
+		.charge_flags = charge_control_is_allowed()
+				? EVENT_FLAG_CHARGE_ALLOWED : 0,
+		.transition_reason = charge_control_get_last_reason(),
+	};
+	event_filter_submit(&snap, platform->uptime_ms());
+	charge_control_clear_last_reason();
+}
 
-	/* Poll Charge Now button for 5-press self-test trigger */
-	selftest_trigger_tick();
+/* Record a thermostat change at the time of its edge; the next sensor
+ * cycle sends it. */
+static void thermostat_record(uint32_t event_ms)
+{
+	uint8_t flags = thermostat_inputs_flags_get();
 
+	if (flags == last_thermostat_flags) {
+		return;
+	}
+	platform->log_inf("Thermostat: cool=%d", (flags & THERMOSTAT_FLAG_COOL) ? 1 : 0);
+	last_thermostat_flags = flags;
+	change_unsent = true;
+	record_snapshot(event_ms);
+}
+
+/* Read the sensors, record and send what changed, including thermostat
+ * changes recorded by edges since the last cycle. */
+static void sensor_poll(uint32_t event_ms)
+{
 	/* --- Poll sensors and detect changes --- */
 	bool changed = false;
 
@@ -245,22 +445,15 @@ static void app_on_timer(void)
 		last_thermostat_flags = flags;
 		changed = true;
 	}
+	if (change_unsent) {
+		change_unsent = false;
+		changed = true;
+	}
 
 	/* --- Record snapshot in event buffer (only on change or heartbeat) --- */
-	{
-		struct event_snapshot snap = {
-			.timestamp = time_sync_get_epoch(),
-			.pilot_voltage_mv = voltage_mv,
-			.current_ma = current_ma,
-			.j1772_state = (uint8_t)last_j1772_state,
-			.thermostat_flags = last_thermostat_flags,
-			.charge_flags = charge_control_is_allowed()
-					? EVENT_FLAG_CHARGE_ALLOWED : 0,
-			.transition_reason = charge_control_get_last_reason(),
-		};
-		event_filter_submit(&snap, platform->uptime_ms());
-		charge_control_clear_last_reason();
-	}
+	last_pilot_mv = voltage_mv;
+	last_current_ma = current_ma;
+	record_snapshot(event_ms);
 
 	/* --- Charge Now latch expiry/cancel check --- */
 	charge_now_tick((uint8_t)last_j1772_state);
@@ -275,39 +468,149 @@ static void app_on_timer(void)
 			     (now - last_heartbeat_ms) >= HEARTBEAT_INTERVAL_MS;
 
 	if (changed || heartbeat_due) {
-		app_tx_send_evse_data();
+		if (changed) {
+			app_tx_send_evse_data();
+		} else {
+			app_tx_send_heartbeat();
+		}
 		if (heartbeat_due) {
 			last_heartbeat_ms = now;
 		}
 		/* Enable drain after first live send */
 		drain_active = true;
-	} else if (drain_active && event_buffer_count() > 0) {
-		/* --- Drain buffered events during idle ticks --- */
-
-		/* Reset cursor when buffer is trimmed (entries shift) */
-		uint32_t oldest_ts = event_buffer_oldest_timestamp();
-		if (oldest_ts != drain_oldest_ts) {
-			drain_cursor = 0;
-			drain_oldest_ts = oldest_ts;
+	} else if (app_tx_queue_depth() > 0) {
+		/* --- Live uplinks held back by the rate limit go first --- */
+		app_tx_flush();
+	} else if (drain_active) {
+		/* --- Drain buffered events during idle ticks, batched --- */
+		drain_tick(now);
+	}
+}
+
+static uint32_t min_ms(uint32_t a, uint32_t b)
+{
+	return (a < b) ? a : b;
+}
+
+static uint32_t max_ms(uint32_t a, uint32_t b)
+{
+	return (a > b) ? a : b;
+}
+
+/* ms until the sensor cycle next has work. The pilot is sampled every
+ * SENSOR_POLL_MS while a vehicle is plugged in, a pilot change is
+ * debouncing, a state is simulated or the thermostat is polled; with no
+ * vehicle every IDLE_POLL_MS, between the deadlines of timed work. */
+static uint32_t cycle_wait_ms(uint32_t now)
+{
+	bool active = last_j1772_state != J1772_STATE_A || last_current_on ||
+		      evse_pilot_settling() || evse_sensors_is_simulating() ||
+		      !thermostat_inputs_edge_driven();
+	uint32_t poll = active ? SENSOR_POLL_MS : IDLE_POLL_MS;
+	uint32_t since = now - last_cycle_ms;
+
+	uint32_t work = min_ms(charge_control_next_ms(), charge_now_next_ms());
+	work = min_ms(work, selftest_trigger_next_ms());
+
+	uint32_t hb = now - last_heartbeat_ms;
+	if (change_unsent || !last_heartbeat_ms || hb >= HEARTBEAT_INTERVAL_MS) {
+		work = 0;
+	} else {
+		work = min_ms(work, HEARTBEAT_INTERVAL_MS - hb);
+	}
+
+	/* Uplinks wait for the airtime budget, not the next cycle */
+	if (app_tx_queue_depth() > 0) {
+		work = min_ms(work, app_tx_wait_ms(false));
+	} else if (drain_active) {
+		uint32_t drain = drain_inflight_next_ms(now);
+
+		if (drain_inflight_can_send() &&
+		    event_buffer_cursor_remaining(&drain_cursor) > 0) {
+			drain = 0;
 		}
+		if (drain != UINT32_MAX) {
+			work = min_ms(work, max_ms(drain, app_tx_wait_ms(true)));
+		}
+	}
 
-		if (drain_cursor < event_buffer_count()) {
-			struct event_snapshot snap;
-			if (event_buffer_peek_at(drain_cursor, &snap)) {
-				int ret = app_tx_send_snapshot(&snap);
-				if (ret > 0) {
-					drain_cursor++;
-				}
-				/* ret == 0: rate-limited, retry next tick */
-				/* ret < 0: send error, retry next tick */
-			}
+	uint32_t wait = min_ms(work, (since < poll) ? poll - since : 0);
+
+	/* The cycle itself never runs closer than SENSOR_POLL_MS */
+	return max_ms(wait, (since < SENSOR_POLL_MS) ? SENSOR_POLL_MS - since : 0);
+}
+
+/* Arm the timer for the earliest deadline: the sensor cycle or the next
+ * LED step, between one LED tick and MAX_WAIT_MS. */
+static void schedule(uint32_t now)
+{
+	uint32_t wait = cycle_wait_ms(now);
+	uint32_t led = led_engine_next_ms();
+
+	if (led != UINT32_MAX) {
+		uint32_t since = now - led_tick_ms;
+
+		wait = min_ms(wait, (led > since) ? led - since : 0);
+	}
+	wait = max_ms(wait, POLL_INTERVAL_MS);
+	arm_timer(now, min_ms(wait, MAX_WAIT_MS));
+}
+
+static void app_on_timer(void)
+{
+	if (!platform) {
+		return;
+	}
+
+	uint32_t now = platform->uptime_ms();
+
+	/* An ACK watermark from a downlink, before anything reads the buffer */
+	event_buffer_trim_pending();
+
+	if (now - last_cycle_ms >= SENSOR_POLL_MS) {
+		last_cycle_ms = now;
+
+		/* Check auto-resume timer */
+		charge_control_tick();
+
+		/* Charge Now button: press timeouts, or polling before API v8 */
+		selftest_trigger_tick();
+
+		sensor_poll(now);
+	}
+
+	/* LED engine catches up on the 100ms ticks since the last wake,
+	 * after the sensors so a new priority shows at once */
+	uint32_t ticks = (now - led_tick_ms) / POLL_INTERVAL_MS;
+	if (ticks) {
+		led_engine_advance(ticks);
+		led_tick_ms += ticks * POLL_INTERVAL_MS;
+	}
+
+	schedule(now);
+}
+
+/* Debounced input changes from the platform (API v8+), oldest first */
+static void app_on_gpio_edges(const struct platform_gpio_edge *edges, size_t count)
+{
+	if (!platform) {
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (thermostat_inputs_on_edge(&edges[i])) {
+			/* Record the compressor change now; the cycle sends it */
+			thermostat_record(edges[i].at_ms);
+		} else {
+			selftest_trigger_on_edge(&edges[i]);
 		}
 	}
+	app_wake();
 }
 
-static int app_on_shell_cmd(const char *cmd, const char *args,
-			    void (*print)(const char *fmt, ...),
-			    void (*error)(const char *fmt, ...))
+static int shell_dispatch(const char *cmd, const char *args,
+			  void (*print)(const char *fmt, ...),
+			  void (*error)(const char *fmt, ...))
 {
 	/* evse commands */
 	if (strcmp(cmd, "evse") == 0) {
@@ -337,12 +640,21 @@ static int app_on_shell_cmd(const char *cmd, const char *args,
 			print("Charging PAUSED (charge_block high)");
 			return 0;
 		} else if (strcmp(args, "buffer") == 0) {
-			uint8_t cnt = event_buffer_count();
-			print("Event buffer: %d/%d entries", cnt, EVENT_BUFFER_CAPACITY);
+			uint16_t cnt = event_buffer_count();
+			print("Event buffer: %d/%d entries, %d/%d bytes", cnt, EVENT_BUFFER_CAPACITY,
+			      event_buffer_bytes_used(), EVENT_BUFFER_BYTES);
 			if (cnt > 0) {
 				print("  Oldest: %u", event_buffer_oldest_timestamp());
 				print("  Newest: %u", event_buffer_newest_timestamp());
+				print("  Undrained: %d", event_buffer_cursor_remaining(&drain_cursor));
 			}
+			print("  In flight: %d frames, %u retries", drain_inflight_count(),
+			      drain_inflight_retries());
+			print("  TX queue: %d queued, %u coalesced, %u dropped",
+			      app_tx_queue_depth(), app_tx_queue_coalesced(),
+			      app_tx_queue_dropped());
+			print("  Airtime left: %u ms this hour",
+			      airtime_budget_remaining_ms(platform->uptime_ms()));
 			return 0;
 		}
 		error("Unknown evse subcommand: %s", args);
@@ -394,6 +706,17 @@ static int app_on_shell_cmd(const char *cmd, const char *args,
 	return -1;
 }
 
+static int app_on_shell_cmd(const char *cmd, const char *args,
+			    void (*print)(const char *fmt, ...),
+			    void (*error)(const char *fmt, ...))
+{
+	int ret = shell_dispatch(cmd, args, print, error);
+
+	/* A simulated pilot state needs the fast sensor cycle */
+	app_wake();
+	return ret;
+}
+
 /* ------------------------------------------------------------------ */
 /*  App callback table — placed at start of app partition              */
 /* ------------------------------------------------------------------ */
@@ -414,4 +737,5 @@ const struct app_callbacks app_cb = {
 	.on_timer        = app_on_timer,
 	.on_shell_cmd    = app_on_shell_cmd,
 	.build_version   = APP_BUILD_VERSION,
+	.on_gpio_edges   = app_on_gpio_edges,
 };
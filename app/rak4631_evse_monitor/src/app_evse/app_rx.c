@@ -13,6 +13,7 @@
 #include <delay_window.h>
 #include <time_sync.h>
 #include <diag_request.h>
+#include <pilot_config.h>
 #include <event_buffer.h>
 #include <app_platform.h>
 #include <string.h>
@@ -90,8 +91,14 @@ void app_rx_process_msg(const uint8_t *data, size_t len)
 		if (ret < 0) {
 			platform->log_err("TIME_SYNC processing failed: %d", ret);
 		} else {
-			/* Trim event buffer with new ACK watermark */
-			event_buffer_trim(time_sync_get_ack_watermark());
+			/* Trim event buffer (and its flash copy) with new ACK
+			 * watermark; the buffer is trimmed on the work queue,
+			 * where the drain cursor reads it */
+			uint32_t wm = time_sync_get_ack_watermark();
+			event_buffer_trim_later(wm);
+			if (app_platform_has_event_log()) {
+				platform->log_trim(wm);
+			}
 		}
 		return;
 	}
@@ -105,5 +112,34 @@ void app_rx_process_msg(const uint8_t *data, size_t len)
 		return;
 	}
 
+	/* Pilot classifier tuning (0x50) */
+	if (data[0] == PILOT_CONFIG_CMD_TYPE) {
+		size_t tag_len = cmd_auth_is_configured() ? CMD_AUTH_TAG_SIZE : 0;
+		size_t payload_len = len >= PILOT_CONFIG_PAYLOAD_SIZE + tag_len ?
+				     PILOT_CONFIG_PAYLOAD_SIZE : PILOT_CONFIG_RESET_SIZE;
+
+		if (tag_len) {
+			if (len < payload_len + tag_len) {
+				platform->log_err("Pilot config: missing auth tag "
+					     "(got %zu, need %zu)", len,
+					     payload_len + tag_len);
+				return;
+			}
+			if (!cmd_auth_verify(data, payload_len,
+					     data + payload_len)) {
+				platform->log_err("Pilot config: auth verification "
+					     "failed");
+				return;
+			}
+		} else {
+			payload_len = len;
+		}
+		int ret = pilot_config_process_cmd(data, payload_len);
+		if (ret < 0) {
+			platform->log_err("Pilot config processing failed: %d", ret);
+		}
+		return;
+	}
+
 	platform->log_wrn("Unknown RX message (first byte=0x%02x, len=%zu)", data[0], len);
 }
@@ -9,29 +9,55 @@
 #include <charge_control.h>
 #include <charge_now.h>
 #include <time_sync.h>
+#include <airtime_budget.h>
 #include <app_platform.h>
 #include <string.h>
 
 /* EVSE payload format constants */
 #define PAYLOAD_VERSION 0x0A
 #define TELEMETRY_PAYLOAD_SIZE 15
+#define BATCH_PAYLOAD_VERSION 0x0B
 
 /* Control flag bits in flags byte (byte 7), bits 2-3 */
 #define FLAG_CHARGE_ALLOWED  0x04   /* bit 2 */
 #define FLAG_CHARGE_NOW      0x08   /* bit 3 */
 
-/* Minimum interval between uplinks to avoid flooding on rapid state changes */
-#define MIN_SEND_INTERVAL_MS  5000
+/* Batch entry byte 2: state (bits 0-2), reason-follows (bit 3),
+ * v0x0A flags nibble (bits 4-7) */
+#define BATCH_STATE_MASK     0x07
+#define BATCH_HAS_REASON     0x08
+#define BATCH_CURRENT_UNIT_MA  200  /* byte 3: current in 200 mA steps */
+
+/* Sidewalk link mask bit for BLE (SID_LINK_TYPE_1) */
+#define LINK_MASK_BLE        0x01
+
+/* Live uplinks, drain frames and snapshots share one budget, enforced by
+ * airtime_budget: a per-link frame bucket (LoRa: one per 5s, burst of
+ * two) and a rolling hourly LoRa/FSK airtime cap. Drain frames spend
+ * only from a full bucket, leaving the burst for transitions. */
+
+struct tx_item {
+	uint8_t prio;
+	uint8_t payload[TELEMETRY_PAYLOAD_SIZE];
+};
 
 static bool sidewalk_ready;
 static uint32_t last_link_mask;
-static uint32_t last_send_ms;
+
+/* Live uplinks waiting for budget, oldest first */
+static struct tx_item tx_queue[APP_TX_QUEUE_DEPTH];
+static uint8_t tx_queue_len;
+static uint32_t tx_coalesced;
+static uint32_t tx_dropped;
 
 void app_tx_init(void)
 {
 	sidewalk_ready = false;
 	last_link_mask = 0;
-	last_send_ms = 0;
+	airtime_budget_init();
+	tx_queue_len = 0;
+	tx_coalesced = 0;
+	tx_dropped = 0;
 }
 
 void app_tx_set_ready(bool ready)
@@ -57,24 +83,22 @@ uint32_t app_tx_get_link_mask(void)
 	return last_link_mask;
 }
 
-int app_tx_send_evse_data(void)
+/* Check the shared budget for a len-byte uplink on the current link */
+static bool budget_allows(size_t len, bool background)
 {
-	if (!platform) {
-		return -1;
-	}
-
-	if (!platform->is_ready()) {
-		platform->log_wrn("Sidewalk not ready, skipping send");
-		return -1;
-	}
+	return airtime_budget_allows((uint32_t)platform->get_link_mask(), len,
+				     background, platform->uptime_ms());
+}
 
-	/* Rate limit: don't send more often than every 5s */
-	uint32_t now = platform->uptime_ms();
-	if (last_send_ms && (now - last_send_ms) < MIN_SEND_INTERVAL_MS) {
-		platform->log_inf("TX rate-limited, skipping");
-		return 0;
-	}
+static void budget_spend(size_t len)
+{
+	airtime_budget_spend((uint32_t)platform->get_link_mask(), len,
+			     platform->uptime_ms());
+}
 
+/* Build a 15-byte v0x0A payload from the current sensor state */
+static void build_evse_payload(uint8_t payload[TELEMETRY_PAYLOAD_SIZE])
+{
 	/* Read current sensor data */
 	evse_payload_t data = evse_payload_get();
 
@@ -93,38 +117,164 @@ int app_tx_send_evse_data(void)
 	/* Get transition reason (0 = no transition this cycle) */
 	uint8_t reason = charge_control_get_last_reason();
 
-	/* Build 15-byte v0x0A payload */
-	uint8_t payload[TELEMETRY_PAYLOAD_SIZE] = {
-		TELEMETRY_MAGIC,
-		PAYLOAD_VERSION,
-		data.j1772_state,
-		data.j1772_mv & 0xFF,
-		(data.j1772_mv >> 8) & 0xFF,
-		data.current_ma & 0xFF,
-		(data.current_ma >> 8) & 0xFF,
-		flags,
-		timestamp & 0xFF,
-		(timestamp >> 8) & 0xFF,
-		(timestamp >> 16) & 0xFF,
-		(timestamp >> 24) & 0xFF,
-		reason,
-		APP_BUILD_VERSION,       /* byte 13: app build version */
-		PLATFORM_BUILD_VERSION,  /* byte 14: platform build version */
-	};
+	payload[0] = TELEMETRY_MAGIC;
+	payload[1] = PAYLOAD_VERSION;
+	payload[2] = data.j1772_state;
+	payload[3] = data.j1772_mv & 0xFF;
+	payload[4] = (data.j1772_mv >> 8) & 0xFF;
+	payload[5] = data.current_ma & 0xFF;
+	payload[6] = (data.current_ma >> 8) & 0xFF;
+	payload[7] = flags;
+	payload[8] = timestamp & 0xFF;
+	payload[9] = (timestamp >> 8) & 0xFF;
+	payload[10] = (timestamp >> 16) & 0xFF;
+	payload[11] = (timestamp >> 24) & 0xFF;
+	payload[12] = reason;
+	payload[13] = APP_BUILD_VERSION;       /* app build version */
+	payload[14] = PLATFORM_BUILD_VERSION;  /* platform build version */
 
 	platform->log_inf("EVSE TX v%02x: state=%d, pilot=%dmV, current=%dmA, flags=0x%02x, ts=%u, reason=%d, build=v%d/v%d",
 		     PAYLOAD_VERSION, data.j1772_state, data.j1772_mv, data.current_ma,
 		     flags, timestamp, reason, APP_BUILD_VERSION, PLATFORM_BUILD_VERSION);
+}
+
+static void queue_remove(int idx)
+{
+	memmove(&tx_queue[idx], &tx_queue[idx + 1],
+		(tx_queue_len - idx - 1) * sizeof(tx_queue[0]));
+	tx_queue_len--;
+}
+
+/*
+ * Queue a live uplink, coalescing what it supersedes:
+ *  - a heartbeat is redundant behind any queued item (nothing changed
+ *    since, or a transition would have been queued)
+ *  - a transition replaces queued heartbeats
+ *  - a transition equal to the newest queued one (state, flags, reason)
+ *    only refreshes its readings and timestamp
+ * When full, the oldest item is dropped; its snapshot is still in the
+ * event buffer and reaches the cloud through the drain.
+ */
+static void queue_push(uint8_t prio, const uint8_t *payload)
+{
+	if (prio == APP_TX_PRIO_HEARTBEAT && tx_queue_len > 0) {
+		tx_coalesced++;
+		return;
+	}
+	for (int i = tx_queue_len - 1; i >= 0; i--) {
+		if (tx_queue[i].prio == APP_TX_PRIO_HEARTBEAT) {
+			queue_remove(i);
+			tx_coalesced++;
+		}
+	}
+	if (tx_queue_len > 0) {
+		struct tx_item *last = &tx_queue[tx_queue_len - 1];
+		if (last->payload[2] == payload[2] && last->payload[7] == payload[7] &&
+		    last->payload[12] == payload[12]) {
+			memcpy(last->payload, payload, TELEMETRY_PAYLOAD_SIZE);
+			tx_coalesced++;
+			return;
+		}
+	}
+	if (tx_queue_len == APP_TX_QUEUE_DEPTH) {
+		platform->log_wrn("TX queue full, dropping oldest (drain resends it)");
+		queue_remove(0);
+		tx_dropped++;
+	}
+	tx_queue[tx_queue_len].prio = prio;
+	memcpy(tx_queue[tx_queue_len].payload, payload, TELEMETRY_PAYLOAD_SIZE);
+	tx_queue_len++;
+}
+
+int app_tx_flush(void)
+{
+	if (!platform || tx_queue_len == 0 || !platform->is_ready()) {
+		return 0;
+	}
+	if (!budget_allows(TELEMETRY_PAYLOAD_SIZE, false)) {
+		return 0;
+	}
+
+	/* Highest priority first, oldest first within a priority */
+	int pick = 0;
+	for (int i = 1; i < tx_queue_len; i++) {
+		if (tx_queue[i].prio > tx_queue[pick].prio) {
+			pick = i;
+		}
+	}
+
+	int ret = platform->send_msg(tx_queue[pick].payload, TELEMETRY_PAYLOAD_SIZE);
+	if (ret == PLATFORM_SEND_NOBUFS) {
+		return 0;   /* platform backpressure: stays queued for the next tick */
+	}
+	queue_remove(pick);
+	budget_spend(TELEMETRY_PAYLOAD_SIZE);
+	return (ret < 0) ? ret : 1;
+}
+
+static int submit(uint8_t prio)
+{
+	if (!platform) {
+		return -1;
+	}
+
+	if (!platform->is_ready()) {
+		platform->log_wrn("Sidewalk not ready, skipping send");
+		return -1;
+	}
+
+	uint8_t payload[TELEMETRY_PAYLOAD_SIZE];
+	build_evse_payload(payload);
+	queue_push(prio, payload);
+
+	int ret = app_tx_flush();
+	if (ret == 0) {
+		platform->log_inf("TX rate-limited, queued (depth %d)", tx_queue_len);
+	}
+	return (ret < 0) ? ret : 0;
+}
+
+int app_tx_send_evse_data(void)
+{
+	return submit(APP_TX_PRIO_TRANSITION);
+}
+
+int app_tx_send_heartbeat(void)
+{
+	return submit(APP_TX_PRIO_HEARTBEAT);
+}
+
+uint32_t app_tx_wait_ms(bool background)
+{
+	if (!platform || !platform->is_ready()) {
+		return UINT32_MAX;
+	}
+	/* A drain frame is at most one LoRa MTU on the duty-cycled links */
+	return airtime_budget_wait_ms((uint32_t)platform->get_link_mask(),
+				      background ? APP_TX_MTU_LORA : TELEMETRY_PAYLOAD_SIZE,
+				      background, platform->uptime_ms());
+}
+
+uint8_t app_tx_queue_depth(void)
+{
+	return tx_queue_len;
+}
 
-	last_send_ms = now;
-	return platform->send_msg(payload, sizeof(payload));
+uint32_t app_tx_queue_coalesced(void)
+{
+	return tx_coalesced;
+}
+
+uint32_t app_tx_queue_dropped(void)
+{
+	return tx_dropped;
 }
 
 /**
  * Send a buffered event snapshot as a v0x0A uplink.
  *
  * Returns:  1 = sent successfully
- *           0 = rate-limited (try again later)
+ *           0 = rate-limited or platform backpressure (try again later)
  *          -1 = error (not ready, null args)
  */
 int app_tx_send_snapshot(const struct event_snapshot *snap)
@@ -137,9 +287,8 @@ int app_tx_send_snapshot(const struct event_snapshot *snap)
 		return -1;
 	}
 
-	/* Shared rate limit with send_evse_data */
-	uint32_t now = platform->uptime_ms();
-	if (last_send_ms && (now - last_send_ms) < MIN_SEND_INTERVAL_MS) {
+	/* Shared budget with live uplinks, which go first */
+	if (tx_queue_len > 0 || !budget_allows(TELEMETRY_PAYLOAD_SIZE, true)) {
 		return 0;
 	}
 
@@ -170,6 +319,113 @@ int app_tx_send_snapshot(const struct event_snapshot *snap)
 	platform->log_inf("EVSE TX buffered: state=%d, ts=%u, reason=%d",
 		     snap->j1772_state, snap->timestamp, snap->transition_reason);
 
-	last_send_ms = now;
-	return (platform->send_msg(payload, sizeof(payload)) == 0) ? 1 : -1;
+	int ret = platform->send_msg(payload, sizeof(payload));
+	if (ret == PLATFORM_SEND_NOBUFS) {
+		return 0;
+	}
+	budget_spend(sizeof(payload));
+	return (ret < 0) ? -1 : 1;
+}
+
+/**
+ * Send buffered snapshots as one batched v0x0B uplink.
+ *
+ * Frame: magic, 0x0B, entry count, base timestamp (u32 LE, = first entry),
+ * then per entry:
+ *   [0-1] seconds since base (u16 LE)
+ *   [2]   state | BATCH_HAS_REASON | flags nibble << 4
+ *   [3]   current_ma / 200, saturating at 255
+ *   [4]   transition reason (only if BATCH_HAS_REASON)
+ *
+ * Pilot millivolts are dropped — the state code carries the same
+ * information for history. The frame ends early at an entry more than
+ * 18 h after the base or earlier than it (clock step), so the next
+ * batch starts a new base there.
+ *
+ * *msg_id receives the platform's id for the frame (0 if the platform
+ * predates msg ids, API v5) so the caller can match on_msg_sent/
+ * on_send_error.
+ */
+int app_tx_send_batch(const struct event_snapshot *snaps, int count,
+		      uint32_t *msg_id)
+{
+	if (!platform || !snaps || count <= 0) {
+		return -1;
+	}
+
+	if (!platform->is_ready()) {
+		return -1;
+	}
+
+	/* Shared budget with live uplinks, which go first */
+	if (tx_queue_len > 0) {
+		return 0;
+	}
+
+	/* BLE-only links take the bigger frame; anything with LoRa/FSK in
+	 * the mask may go out over it, so size for the smaller MTU. */
+	int mask = platform->get_link_mask();
+	size_t mtu = (mask == LINK_MASK_BLE) ? APP_TX_MTU_BLE : APP_TX_MTU_LORA;
+
+	uint8_t payload[APP_TX_MTU_BLE];
+	uint32_t base = snaps[0].timestamp;
+	size_t pos = APP_TX_BATCH_HDR_SIZE;
+	int n = 0;
+
+	while (n < count) {
+		const struct event_snapshot *s = &snaps[n];
+		size_t need = APP_TX_BATCH_ENTRY_SIZE + (s->transition_reason ? 1 : 0);
+
+		if (pos + need > mtu || s->timestamp < base ||
+		    s->timestamp - base > 0xFFFF) {
+			break;
+		}
+
+		uint16_t offset = (uint16_t)(s->timestamp - base);
+		uint8_t flags = s->thermostat_flags & 0x03;
+		if (s->charge_flags & EVENT_FLAG_CHARGE_ALLOWED) {
+			flags |= FLAG_CHARGE_ALLOWED;
+		}
+		uint32_t cur = s->current_ma / BATCH_CURRENT_UNIT_MA;
+
+		payload[pos++] = offset & 0xFF;
+		payload[pos++] = (offset >> 8) & 0xFF;
+		payload[pos++] = (s->j1772_state & BATCH_STATE_MASK) |
+				 (s->transition_reason ? BATCH_HAS_REASON : 0) |
+				 (flags << 4);
+		payload[pos++] = (cur > 0xFF) ? 0xFF : (uint8_t)cur;
+		if (s->transition_reason) {
+			payload[pos++] = s->transition_reason;
+		}
+		n++;
+	}
+
+	payload[0] = TELEMETRY_MAGIC;
+	payload[1] = BATCH_PAYLOAD_VERSION;
+	payload[2] = (uint8_t)n;
+	payload[3] = base & 0xFF;
+	payload[4] = (base >> 8) & 0xFF;
+	payload[5] = (base >> 16) & 0xFF;
+	payload[6] = (base >> 24) & 0xFF;
+
+	/* Budget is checked against the actual frame length */
+	if (!budget_allows(pos, true)) {
+		return 0;
+	}
+
+	platform->log_inf("EVSE TX batch v%02x: %d entries, base ts=%u, %d bytes",
+		     BATCH_PAYLOAD_VERSION, n, base, (int)pos);
+
+	int ret = platform->send_msg(payload, pos);
+	if (ret == PLATFORM_SEND_NOBUFS) {
+		return 0;   /* platform backpressure: same as rate-limited */
+	}
+	budget_spend(pos);
+	if (ret < 0) {
+		return -1;
+	}
+	if (msg_id) {
+		*msg_id = app_platform_has_msg_ids() ? (uint32_t)ret : 0;
+	}
+	return n;
 }
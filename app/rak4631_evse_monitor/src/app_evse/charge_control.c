@@ -174,3 +174,42 @@ void charge_control_tick(void)
 		}
 	}
 }
+
+/* Epoch seconds to ms, saturating */
+static uint32_t secs_to_ms(uint32_t secs)
+{
+	return (secs >= UINT32_MAX / 1000) ? UINT32_MAX : secs * 1000;
+}
+
+uint32_t charge_control_next_ms(void)
+{
+	if (!platform) {
+		return UINT32_MAX;
+	}
+
+	if (delay_window_has_window()) {
+		uint32_t now = time_sync_get_epoch();
+		if (now != 0) {
+			uint32_t start, end;
+			delay_window_get(&start, &end);
+
+			if (now > end || (now >= start && current_state.charging_allowed)) {
+				return 0;
+			}
+			/* Pauses at start, resumes once past end */
+			return secs_to_ms(now < start ? start - now : end - now + 1);
+		}
+	}
+
+	if (!current_state.charging_allowed &&
+	    current_state.auto_resume_min > 0 &&
+	    current_state.pause_timestamp_ms > 0) {
+		int64_t elapsed_ms = (int64_t)platform->uptime_ms() -
+				     current_state.pause_timestamp_ms;
+		int64_t left_ms = (int64_t)current_state.auto_resume_min * 60 * 1000 -
+				  elapsed_ms;
+
+		return (left_ms > 0) ? (uint32_t)left_ms : 0;
+	}
+	return UINT32_MAX;
+}
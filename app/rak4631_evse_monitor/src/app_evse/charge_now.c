@@ -75,6 +75,16 @@ void charge_now_tick(uint8_t j1772_state)
 	}
 }
 
+uint32_t charge_now_next_ms(void)
+{
+	if (!active || !platform) {
+		return UINT32_MAX;
+	}
+
+	uint32_t elapsed = platform->uptime_ms() - start_ms;
+	return (elapsed >= CHARGE_NOW_DURATION_MS) ? 0 : CHARGE_NOW_DURATION_MS - elapsed;
+}
+
 bool charge_now_is_active(void)
 {
 	return active;
@@ -2,8 +2,8 @@
  * Diagnostics Request — handles 0x40 downlink, sends 0xE6 response
  *
  * Gathers device state from existing app modules (selftest, charge control,
- * time sync, event buffer, app_tx) and encodes a 14-byte diagnostics
- * response uplink.
+ * time sync, event buffer, app_tx, airtime budget) and encodes a 17-byte
+ * diagnostics response uplink.
  */
 
 #include <diag_request.h>
@@ -14,6 +14,7 @@
 #include <time_sync.h>
 #include <event_buffer.h>
 #include <app_tx.h>
+#include <airtime_budget.h>
 #include <string.h>
 
 uint8_t diag_request_get_error_code(void)
@@ -84,7 +85,10 @@ int diag_request_build_response(uint8_t *buf)
 	uint16_t boot_count = 0;  /* No persistent storage yet (future) */
 	uint8_t error_code = diag_request_get_error_code();
 	uint8_t state_flags = diag_request_get_state_flags();
-	uint8_t pending = event_buffer_count();
+	uint16_t buffered = event_buffer_count();  /* saturates in the 1-byte field */
+	uint8_t pending = (buffered > 0xFF) ? 0xFF : (uint8_t)buffered;
+	uint32_t airtime_ms = airtime_budget_remaining_ms(platform->uptime_ms());
+	uint16_t airtime = (airtime_ms > 0xFFFF) ? 0xFFFF : (uint16_t)airtime_ms;
 
 	buf[0] = DIAG_MAGIC;
 	buf[1] = DIAG_VERSION;
@@ -101,6 +105,8 @@ int diag_request_build_response(uint8_t *buf)
 	buf[12] = pending;
 	buf[13] = APP_BUILD_VERSION;
 	buf[14] = PLATFORM_BUILD_VERSION;
+	buf[15] = airtime & 0xFF;
+	buf[16] = (airtime >> 8) & 0xFF;
 
 	return DIAG_PAYLOAD_SIZE;
 }
@@ -129,5 +135,9 @@ int diag_request_process_cmd(const uint8_t *data, size_t len)
 		     (response[4] | (response[5] << 8) | (response[6] << 16) | (response[7] << 24)),
 		     response[10], response[11], response[12]);
 
-	return platform->send_msg(response, DIAG_PAYLOAD_SIZE);
+	/* On-demand: counted against the airtime budget but never held back */
+	airtime_budget_spend((uint32_t)platform->get_link_mask(), DIAG_PAYLOAD_SIZE,
+			     platform->uptime_ms());
+	ret = platform->send_msg(response, DIAG_PAYLOAD_SIZE);
+	return (ret < 0) ? ret : 0;
 }
@@ -0,0 +1,229 @@
+/*
+ * Drain In-Flight Table — delivery tracking for event-buffer drain uplinks
+ */
+
+#include <drain_inflight.h>
+#include <string.h>
+
+enum slot_state {
+	SLOT_FREE = 0,
+	SLOT_WAIT,     /* sent, awaiting on_msg_sent / on_send_error */
+	SLOT_RETRY,    /* failed or partially sent, due at retry_at_ms */
+};
+
+struct inflight_slot {
+	uint8_t  state;
+	uint8_t  attempts;      /* failures so far (drives backoff) */
+	uint8_t  count;         /* entries in range */
+	uint8_t  sent;          /* entries in the frame awaiting confirm */
+	uint32_t msg_id;
+	uint32_t first_seq;
+	uint32_t when_ms;       /* WAIT: send time; RETRY: due time */
+};
+
+static struct inflight_slot slots[DRAIN_INFLIGHT_SLOTS];
+static uint32_t retries;
+
+void drain_inflight_init(void)
+{
+	memset(slots, 0, sizeof(slots));
+	retries = 0;
+}
+
+/* A RETRY slot keeps the id of the frame that timed out, so a result
+ * arriving after the timeout still finds it until the range is resent */
+static struct inflight_slot *find(uint32_t msg_id)
+{
+	if (msg_id == 0) {
+		return NULL;
+	}
+	for (int i = 0; i < DRAIN_INFLIGHT_SLOTS; i++) {
+		if (slots[i].state != SLOT_FREE && slots[i].msg_id == msg_id) {
+			return &slots[i];
+		}
+	}
+	return NULL;
+}
+
+static uint32_t backoff_ms(uint8_t attempts)
+{
+	uint8_t shift = (attempts > 1) ? (uint8_t)(attempts - 1) : 0;
+	if (shift > 5) {
+		shift = 5;
+	}
+	uint32_t delay = (uint32_t)DRAIN_RETRY_BASE_MS << shift;
+	return (delay > DRAIN_RETRY_MAX_MS) ? DRAIN_RETRY_MAX_MS : delay;
+}
+
+/* Frame confirmed: free the slot, or keep what did not fit as due now */
+static void confirm_slot(struct inflight_slot *s, uint32_t now_ms)
+{
+	if (s->sent < s->count) {
+		s->first_seq += s->sent;
+		s->count -= s->sent;
+		s->state = SLOT_RETRY;
+		s->when_ms = now_ms;
+		s->attempts = 0;
+	} else {
+		memset(s, 0, sizeof(*s));
+	}
+}
+
+static void fail_slot(struct inflight_slot *s, uint32_t now_ms)
+{
+	if (s->attempts < UINT8_MAX) {
+		s->attempts++;
+	}
+	s->state = SLOT_RETRY;
+	s->when_ms = now_ms + backoff_ms(s->attempts);
+}
+
+bool drain_inflight_can_send(void)
+{
+	for (int i = 0; i < DRAIN_INFLIGHT_SLOTS; i++) {
+		if (slots[i].state == SLOT_FREE) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void drain_inflight_sent(uint32_t msg_id, uint32_t first_seq, uint8_t count,
+			 uint32_t now_ms)
+{
+	if (msg_id == 0 || count == 0) {
+		return;  /* no id to track: treated as delivered */
+	}
+	for (int i = 0; i < DRAIN_INFLIGHT_SLOTS; i++) {
+		if (slots[i].state == SLOT_FREE) {
+			slots[i] = (struct inflight_slot){
+				.state = SLOT_WAIT,
+				.count = count,
+				.sent = count,
+				.msg_id = msg_id,
+				.first_seq = first_seq,
+				.when_ms = now_ms,
+			};
+			return;
+		}
+	}
+}
+
+bool drain_inflight_confirm(uint32_t msg_id)
+{
+	struct inflight_slot *s = find(msg_id);
+	if (!s) {
+		return false;
+	}
+	confirm_slot(s, s->when_ms);
+	return true;
+}
+
+bool drain_inflight_fail(uint32_t msg_id, uint32_t now_ms)
+{
+	struct inflight_slot *s = find(msg_id);
+	if (!s || s->state != SLOT_WAIT) {
+		return false;  /* timed out: already due for retry */
+	}
+	fail_slot(s, now_ms);
+	return true;
+}
+
+int drain_inflight_due(uint32_t now_ms, uint32_t *first_seq, uint8_t *count)
+{
+	int best = -1;
+
+	for (int i = 0; i < DRAIN_INFLIGHT_SLOTS; i++) {
+		struct inflight_slot *s = &slots[i];
+
+		if (s->state == SLOT_WAIT &&
+		    (now_ms - s->when_ms) >= DRAIN_CONFIRM_TIMEOUT_MS) {
+			fail_slot(s, now_ms);
+		}
+		if (s->state == SLOT_RETRY && (int32_t)(now_ms - s->when_ms) >= 0 &&
+		    (best < 0 || s->first_seq < slots[best].first_seq)) {
+			best = i;
+		}
+	}
+
+	if (best >= 0) {
+		*first_seq = slots[best].first_seq;
+		*count = slots[best].count;
+	}
+	return best;
+}
+
+uint32_t drain_inflight_next_ms(uint32_t now_ms)
+{
+	uint32_t next = UINT32_MAX;
+
+	for (int i = 0; i < DRAIN_INFLIGHT_SLOTS; i++) {
+		const struct inflight_slot *s = &slots[i];
+		int32_t left;
+
+		if (s->state == SLOT_WAIT) {
+			left = (int32_t)(DRAIN_CONFIRM_TIMEOUT_MS - (now_ms - s->when_ms));
+		} else if (s->state == SLOT_RETRY) {
+			left = (int32_t)(s->when_ms - now_ms);
+		} else {
+			continue;
+		}
+		if (left <= 0) {
+			return 0;
+		}
+		if ((uint32_t)left < next) {
+			next = (uint32_t)left;
+		}
+	}
+	return next;
+}
+
+void drain_inflight_resent(int slot, uint32_t msg_id, uint32_t first_seq,
+			   uint8_t sent, uint32_t now_ms)
+{
+	if (slot < 0 || slot >= DRAIN_INFLIGHT_SLOTS ||
+	    slots[slot].state != SLOT_RETRY) {
+		return;
+	}
+	struct inflight_slot *s = &slots[slot];
+	uint32_t end = s->first_seq + s->count;
+
+	if (first_seq >= end) {
+		drain_inflight_drop(slot);
+		return;
+	}
+	s->first_seq = first_seq;
+	s->count = (uint8_t)(end - first_seq);
+	s->sent = (sent > s->count) ? s->count : sent;
+	s->msg_id = msg_id;
+	s->state = SLOT_WAIT;
+	s->when_ms = now_ms;
+	retries++;
+
+	if (msg_id == 0) {
+		confirm_slot(s, now_ms);
+	}
+}
+
+void drain_inflight_drop(int slot)
+{
+	if (slot >= 0 && slot < DRAIN_INFLIGHT_SLOTS) {
+		memset(&slots[slot], 0, sizeof(slots[slot]));
+	}
+}
+
+uint8_t drain_inflight_count(void)
+{
+	uint8_t n = 0;
+	for (int i = 0; i < DRAIN_INFLIGHT_SLOTS; i++) {
+		if (slots[i].state != SLOT_FREE) {
+			n++;
+		}
+	}
+	return n;
+}
+
+uint32_t drain_inflight_retries(void)
+{
+	return retries;
+}
@@ -1,149 +1,470 @@
 /*
- * Event Buffer — ring buffer of timestamped EVSE state snapshots
+ * Event Buffer — delta-encoded ring of timestamped EVSE state snapshots
  *
- * Fixed-size circular buffer. Head points to the next write position.
- * When full, new entries overwrite the oldest. Trim removes entries
- * with timestamp <= the ACK watermark.
+ * The oldest entry (base) and the newest entry (head) are kept decoded.
+ * Every entry after the base is stored in a byte ring as a record that
+ * describes how it differs from the entry before it:
+ *
+ *   byte 0      header (EB_HDR_* bits below)
+ *   [ts]        varint second-delta, or u32 LE absolute (EB_TS_ABSOLUTE)
+ *   [pilot]     zigzag varint pilot_voltage_mv delta
+ *   [current]   zigzag varint current_ma delta
+ *   [state]     j1772_state byte
+ *   [thermo]    thermostat_flags byte
+ *   [charge]    charge_flags byte
+ *   [reason]    transition_reason byte
+ *
+ * Optional fields are present only when their header bit is set. A
+ * heartbeat at the same cadence as the previous entry with no field
+ * change is a single header byte.
+ *
+ * Dropping the oldest entry decodes the first record into the base and
+ * advances the ring read offset. When the ring (or entry cap) is full,
+ * the oldest entries are dropped until the new record fits. Records are
+ * never moved once written, so a cursor can cache a ring offset for as
+ * long as its sequence number is still buffered. Each read checks the
+ * cached offset against the buffered sequence range and the used bytes
+ * before resuming from it.
  */
 
 #include <event_buffer.h>
 #include <string.h>
 
-static struct event_snapshot buf[EVENT_BUFFER_CAPACITY];
-static uint8_t head;   /* next write index */
-static uint8_t count;  /* valid entries (0..CAPACITY) */
+/* Header bits 0-1: timestamp encoding */
+#define EB_TS_MASK          0x03
+#define EB_TS_VARINT        0x00  /* varint delta from previous timestamp */
+#define EB_TS_REPEAT        0x01  /* same delta as previous record, no bytes */
+#define EB_TS_ABSOLUTE      0x02  /* u32 LE (clock stepped backwards) */
+
+/* Header bits 2-7: field present */
+#define EB_HDR_PILOT        0x04
+#define EB_HDR_CURRENT      0x08
+#define EB_HDR_STATE        0x10
+#define EB_HDR_THERMO       0x20
+#define EB_HDR_CHARGE       0x40
+#define EB_HDR_REASON       0x80
+
+/* 1 header + 5 varint ts + 3 pilot + 3 current + 4 byte fields */
+#define EB_MAX_RECORD       16
+
+static uint8_t ring[EVENT_BUFFER_BYTES];
+static uint16_t rd;       /* ring offset of the oldest record */
+static uint16_t used;     /* bytes of records in the ring */
+static uint16_t count;    /* valid entries (base + records) */
+static uint32_t next_seq; /* sequence number of the next added entry */
+
+static struct event_snapshot base;   /* decoded oldest entry */
+static uint32_t base_delta;          /* ts delta that produced base */
+static struct event_snapshot head;   /* decoded newest entry */
+static uint32_t head_delta;          /* ts delta that produced head */
+
+/* Trim handed over from another thread: the watermark, then the flag */
+static atomic_t trim_wm;
+static atomic_t trim_req;
 
 void event_buffer_init(void)
 {
-	memset(buf, 0, sizeof(buf));
-	head = 0;
+	memset(ring, 0, sizeof(ring));
+	memset(&base, 0, sizeof(base));
+	memset(&head, 0, sizeof(head));
+	rd = 0;
+	used = 0;
 	count = 0;
+	next_seq = 0;
+	base_delta = 0;
+	head_delta = 0;
+	atomic_set(&trim_req, 0);
 }
 
-void event_buffer_add(const struct event_snapshot *snap)
+/* ------------------------------------------------------------------ */
+/*  Record encoding                                                    */
+/* ------------------------------------------------------------------ */
+
+static uint8_t put_varint(uint8_t *p, uint32_t v)
 {
-	if (!snap) {
-		return;
+	uint8_t n = 0;
+
+	while (v >= 0x80) {
+		p[n++] = (uint8_t)(v | 0x80);
+		v >>= 7;
 	}
+	p[n++] = (uint8_t)v;
+	return n;
+}
+
+static uint32_t zigzag(int32_t v)
+{
+	return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v)
+{
+	return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/**
+ * Encode snap relative to prev into rec. Returns the record length and
+ * stores the resulting timestamp delta in *delta_out.
+ */
+static uint8_t encode_record(const struct event_snapshot *snap,
+			     const struct event_snapshot *prev, uint32_t prev_delta,
+			     uint8_t *rec, uint32_t *delta_out)
+{
+	uint8_t hdr = 0;
+	uint8_t n = 1;
 
-	buf[head] = *snap;
-	head = (head + 1) % EVENT_BUFFER_CAPACITY;
+	if (snap->timestamp < prev->timestamp) {
+		hdr |= EB_TS_ABSOLUTE;
+		rec[n++] = snap->timestamp & 0xFF;
+		rec[n++] = (snap->timestamp >> 8) & 0xFF;
+		rec[n++] = (snap->timestamp >> 16) & 0xFF;
+		rec[n++] = (snap->timestamp >> 24) & 0xFF;
+		*delta_out = 0;
+	} else {
+		uint32_t delta = snap->timestamp - prev->timestamp;
+
+		if (delta == prev_delta) {
+			hdr |= EB_TS_REPEAT;
+		} else {
+			n += put_varint(&rec[n], delta);
+		}
+		*delta_out = delta;
+	}
 
-	if (count < EVENT_BUFFER_CAPACITY) {
-		count++;
+	if (snap->pilot_voltage_mv != prev->pilot_voltage_mv) {
+		hdr |= EB_HDR_PILOT;
+		n += put_varint(&rec[n], zigzag((int32_t)snap->pilot_voltage_mv -
+						(int32_t)prev->pilot_voltage_mv));
 	}
-	/* else: wrapped — oldest entry was overwritten */
+	if (snap->current_ma != prev->current_ma) {
+		hdr |= EB_HDR_CURRENT;
+		n += put_varint(&rec[n], zigzag((int32_t)snap->current_ma -
+						(int32_t)prev->current_ma));
+	}
+	if (snap->j1772_state != prev->j1772_state) {
+		hdr |= EB_HDR_STATE;
+		rec[n++] = snap->j1772_state;
+	}
+	if (snap->thermostat_flags != prev->thermostat_flags) {
+		hdr |= EB_HDR_THERMO;
+		rec[n++] = snap->thermostat_flags;
+	}
+	if (snap->charge_flags != prev->charge_flags) {
+		hdr |= EB_HDR_CHARGE;
+		rec[n++] = snap->charge_flags;
+	}
+	if (snap->transition_reason != prev->transition_reason) {
+		hdr |= EB_HDR_REASON;
+		rec[n++] = snap->transition_reason;
+	}
+
+	rec[0] = hdr;
+	return n;
 }
 
-bool event_buffer_get_latest(struct event_snapshot *out)
+/* ------------------------------------------------------------------ */
+/*  Record decoding (reads straight from the ring, handles wrap)       */
+/* ------------------------------------------------------------------ */
+
+static uint8_t ring_byte(uint16_t *pos)
 {
-	if (!out || count == 0) {
-		return false;
+	uint8_t b = ring[*pos];
+
+	*pos = (*pos + 1) % EVENT_BUFFER_BYTES;
+	return b;
+}
+
+static uint32_t ring_varint(uint16_t *pos)
+{
+	uint32_t v = 0;
+	uint8_t shift = 0;
+	uint8_t b;
+
+	do {
+		b = ring_byte(pos);
+		v |= (uint32_t)(b & 0x7F) << shift;
+		shift += 7;
+	} while ((b & 0x80) && shift < 35);
+
+	return v;
+}
+
+/**
+ * Apply the record at ring offset pos to *snap / *delta.
+ * Returns the ring offset just past the record.
+ */
+static uint16_t decode_record(uint16_t pos, struct event_snapshot *snap,
+			      uint32_t *delta)
+{
+	uint8_t hdr = ring_byte(&pos);
+
+	switch (hdr & EB_TS_MASK) {
+	case EB_TS_ABSOLUTE: {
+		uint32_t ts = ring_byte(&pos);
+		ts |= (uint32_t)ring_byte(&pos) << 8;
+		ts |= (uint32_t)ring_byte(&pos) << 16;
+		ts |= (uint32_t)ring_byte(&pos) << 24;
+		snap->timestamp = ts;
+		*delta = 0;
+		break;
+	}
+	case EB_TS_REPEAT:
+		snap->timestamp += *delta;
+		break;
+	default:
+		*delta = ring_varint(&pos);
+		snap->timestamp += *delta;
+		break;
 	}
 
-	/* Latest entry is one before head */
-	uint8_t idx = (head == 0) ? EVENT_BUFFER_CAPACITY - 1 : head - 1;
-	*out = buf[idx];
-	return true;
+	if (hdr & EB_HDR_PILOT) {
+		snap->pilot_voltage_mv = (uint16_t)((int32_t)snap->pilot_voltage_mv +
+						    unzigzag(ring_varint(&pos)));
+	}
+	if (hdr & EB_HDR_CURRENT) {
+		snap->current_ma = (uint16_t)((int32_t)snap->current_ma +
+					      unzigzag(ring_varint(&pos)));
+	}
+	if (hdr & EB_HDR_STATE) {
+		snap->j1772_state = ring_byte(&pos);
+	}
+	if (hdr & EB_HDR_THERMO) {
+		snap->thermostat_flags = ring_byte(&pos);
+	}
+	if (hdr & EB_HDR_CHARGE) {
+		snap->charge_flags = ring_byte(&pos);
+	}
+	if (hdr & EB_HDR_REASON) {
+		snap->transition_reason = ring_byte(&pos);
+	}
+
+	return pos;
 }
 
 /**
- * Get the index of the oldest entry.
- * When count < CAPACITY, tail is 0. When full, tail == head.
+ * Drop the oldest entry: decode the first record into the base.
  */
-static uint8_t tail_index(void)
+static void drop_oldest(void)
 {
-	if (count < EVENT_BUFFER_CAPACITY) {
-		return 0;
+	if (count <= 1) {
+		count = 0;
+		used = 0;
+		return;
 	}
-	return head; /* when full, head == tail (just got overwritten) */
+
+	uint16_t next = decode_record(rd, &base, &base_delta);
+	uint16_t len = (next + EVENT_BUFFER_BYTES - rd) % EVENT_BUFFER_BYTES;
+
+	rd = next;
+	used -= len;
+	count--;
 }
 
-void event_buffer_trim(uint32_t ack_watermark)
+static uint32_t oldest_seq(void)
 {
+	return next_seq - count;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                         */
+/* ------------------------------------------------------------------ */
+
+void event_buffer_add(const struct event_snapshot *snap)
+{
+	if (!snap) {
+		return;
+	}
+
 	if (count == 0) {
+		base = *snap;
+		head = *snap;
+		base_delta = 0;
+		head_delta = 0;
+		count = 1;
+		next_seq++;
 		return;
 	}
 
-	/*
-	 * Walk from oldest to newest, removing entries with
-	 * timestamp <= ack_watermark. Since timestamps are monotonically
-	 * increasing (from time_sync), we can stop at the first entry
-	 * that is newer than the watermark.
-	 *
-	 * We rebuild by counting how many to trim from the tail.
-	 */
-	uint8_t tail = tail_index();
-	uint8_t trimmed = 0;
+	uint8_t rec[EB_MAX_RECORD];
+	uint32_t delta;
+	uint8_t len = encode_record(snap, &head, head_delta, rec, &delta);
 
-	for (uint8_t i = 0; i < count; i++) {
-		uint8_t idx = (tail + i) % EVENT_BUFFER_CAPACITY;
-		if (buf[idx].timestamp <= ack_watermark) {
-			trimmed++;
-		} else {
-			break; /* timestamps are monotonic — done */
-		}
+	/* Make room — count >= 2 whenever the ring holds records */
+	while (count >= EVENT_BUFFER_CAPACITY || used + len > EVENT_BUFFER_BYTES) {
+		drop_oldest();
 	}
 
-	if (trimmed == 0) {
-		return;
+	uint16_t wr = (rd + used) % EVENT_BUFFER_BYTES;
+	for (uint8_t i = 0; i < len; i++) {
+		ring[wr] = rec[i];
+		wr = (wr + 1) % EVENT_BUFFER_BYTES;
 	}
+	used += len;
+	count++;
+	next_seq++;
 
-	if (trimmed >= count) {
-		/* All entries trimmed */
-		count = 0;
-		head = 0;
-		return;
+	head = *snap;
+	head_delta = delta;
+}
+
+bool event_buffer_get_latest(struct event_snapshot *out)
+{
+	if (!out || count == 0) {
+		return false;
 	}
 
+	*out = head;
+	return true;
+}
+
+void event_buffer_trim(uint32_t ack_watermark)
+{
 	/*
-	 * Compact: shift remaining entries to the start of the buffer.
-	 * This simplifies tail_index() and avoids fragmented state.
-	 * When the source range wraps around the ring, in-place copy
-	 * would overwrite unread entries — use a temp buffer in that case.
+	 * Timestamps are monotonically increasing (from time_sync), so
+	 * drop from the oldest end until the first entry newer than the
+	 * watermark. A full ACK (the common case) just empties the ring.
 	 */
-	uint8_t new_count = count - trimmed;
-	uint8_t src = (tail + trimmed) % EVENT_BUFFER_CAPACITY;
+	if (count > 0 && head.timestamp <= ack_watermark) {
+		count = 0;
+		used = 0;
+		return;
+	}
 
-	if (src + new_count <= EVENT_BUFFER_CAPACITY) {
-		/* No wrap — safe to memmove */
-		memmove(buf, &buf[src], new_count * sizeof(struct event_snapshot));
-	} else {
-		/* Source wraps — copy via temp to avoid overwrite */
-		struct event_snapshot tmp[EVENT_BUFFER_CAPACITY] = {0};
-		for (uint8_t i = 0; i < new_count; i++) {
-			tmp[i] = buf[(src + i) % EVENT_BUFFER_CAPACITY];
-		}
-		memcpy(buf, tmp, new_count * sizeof(struct event_snapshot));
+	while (count > 0 && base.timestamp <= ack_watermark) {
+		drop_oldest();
 	}
+}
 
-	count = new_count;
-	head = new_count;
+void event_buffer_trim_later(uint32_t ack_watermark)
+{
+	atomic_set(&trim_wm, (atomic_val_t)ack_watermark);
+	atomic_set(&trim_req, 1);
 }
 
-bool event_buffer_peek_at(uint8_t index, struct event_snapshot *out)
+bool event_buffer_trim_pending(void)
+{
+	if (!atomic_cas(&trim_req, 1, 0)) {
+		return false;
+	}
+	/* A request racing in after the flag is cleared sets it again */
+	event_buffer_trim((uint32_t)atomic_get(&trim_wm));
+	return true;
+}
+
+bool event_buffer_peek_at(uint16_t index, struct event_snapshot *out)
 {
 	if (!out || index >= count) {
 		return false;
 	}
 
-	uint8_t tail = tail_index();
-	uint8_t idx = (tail + index) % EVENT_BUFFER_CAPACITY;
-	*out = buf[idx];
+	if (index == count - 1) {
+		*out = head;
+		return true;
+	}
+
+	struct event_snapshot snap = base;
+	uint32_t delta = base_delta;
+	uint16_t pos = rd;
+
+	for (uint16_t i = 0; i < index; i++) {
+		pos = decode_record(pos, &snap, &delta);
+	}
+
+	*out = snap;
 	return true;
 }
 
-uint8_t event_buffer_count(void)
+uint32_t event_buffer_oldest_seq(void)
+{
+	return oldest_seq();
+}
+
+void event_buffer_cursor_init(event_buffer_cursor_t *cur)
+{
+	if (!cur) {
+		return;
+	}
+	memset(cur, 0, sizeof(*cur));
+	cur->seq = oldest_seq();
+}
+
+bool event_buffer_cursor_peek(event_buffer_cursor_t *cur, struct event_snapshot *out)
+{
+	if (!cur || !out) {
+		return false;
+	}
+
+	uint32_t oldest = oldest_seq();
+
+	/* Entries before the oldest were ACKed or overwritten */
+	if (cur->seq < oldest) {
+		cur->seq = oldest;
+	}
+	if (cur->seq >= next_seq) {
+		return false;
+	}
+
+	if (cur->seq == next_seq - 1) {
+		*out = head;
+		return true;
+	}
+
+	/* Resume from the cache only if it holds a buffered entry before the
+	 * head, and its offset (record cache_seq + 1) lies in the used bytes */
+	uint16_t cache_off = (uint16_t)((cur->cache_pos + EVENT_BUFFER_BYTES - rd) %
+					EVENT_BUFFER_BYTES);
+
+	if (!cur->cache_valid || cur->cache_seq < oldest || cur->cache_seq > cur->seq ||
+	    cur->cache_seq >= next_seq - 1 || cache_off >= used) {
+		cur->cache_seq = oldest;
+		cur->cache_snap = base;
+		cur->cache_delta = base_delta;
+		cur->cache_pos = rd;
+		cur->cache_valid = true;
+	}
+
+	while (cur->cache_seq < cur->seq) {
+		cur->cache_pos = decode_record(cur->cache_pos, &cur->cache_snap,
+					       &cur->cache_delta);
+		cur->cache_seq++;
+	}
+
+	*out = cur->cache_snap;
+	return true;
+}
+
+void event_buffer_cursor_advance(event_buffer_cursor_t *cur)
+{
+	if (cur && cur->seq < next_seq) {
+		cur->seq++;
+	}
+}
+
+uint16_t event_buffer_cursor_remaining(const event_buffer_cursor_t *cur)
+{
+	if (!cur) {
+		return 0;
+	}
+	uint32_t from = (cur->seq < oldest_seq()) ? oldest_seq() : cur->seq;
+	return (from >= next_seq) ? 0 : (uint16_t)(next_seq - from);
+}
+
+uint16_t event_buffer_count(void)
 {
 	return count;
 }
 
+uint16_t event_buffer_bytes_used(void)
+{
+	return used;
+}
+
 uint32_t event_buffer_oldest_timestamp(void)
 {
 	if (count == 0) {
 		return 0;
 	}
-	return buf[tail_index()].timestamp;
+	return base.timestamp;
 }
 
 uint32_t event_buffer_newest_timestamp(void)
@@ -151,6 +472,5 @@ uint32_t event_buffer_newest_timestamp(void)
 	if (count == 0) {
 		return 0;
 	}
-	uint8_t idx = (head == 0) ? EVENT_BUFFER_CAPACITY - 1 : head - 1;
-	return buf[idx].timestamp;
+	return head.timestamp;
 }
@@ -8,6 +8,7 @@
 
 #include <event_filter.h>
 #include <event_buffer.h>
+#include <app_platform.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -82,6 +83,10 @@ bool event_filter_submit(const struct event_snapshot *snap, uint32_t uptime_ms)
 
 	if (changed || heartbeat) {
 		event_buffer_add(snap);
+		if (app_platform_has_event_log()) {
+			/* Persist for restore after a reset; RAM copy is authoritative */
+			platform->log_append(snap, sizeof(*snap));
+		}
 		last = *snap;
 		has_baseline = true;
 		last_write_ms = uptime_ms;
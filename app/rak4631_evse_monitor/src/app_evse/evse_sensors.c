@@ -11,34 +11,132 @@
 /* ADC channel indices (match platform devicetree order) */
 #define ADC_CHANNEL_PILOT   0
 
-/* Voltage thresholds at ADC input (in mV) with hysteresis */
+/* Default voltage thresholds at ADC input (in mV); tunable, see
+ * evse_pilot_config_set() */
 #define J1772_THRESHOLD_A_B_MV      2600
 #define J1772_THRESHOLD_B_C_MV      1850
 #define J1772_THRESHOLD_C_D_MV      1100
 #define J1772_THRESHOLD_D_E_MV      350
+#define J1772_HYSTERESIS_MV         150
+#define J1772_DEBOUNCE_READS        3
+
+/* Burst samples read per pilot reading (platform API v7+) */
+#define PILOT_BURST_MAX             16
 
 /* Current clamp calibration: 0-3.3V = 0-30A */
 #define CURRENT_CLAMP_MAX_MA        30000
 #define CURRENT_CLAMP_VOLTAGE_MV    3300
 
+#define PILOT_CONFIG_DEFAULTS { \
+	.threshold_mv = { J1772_THRESHOLD_A_B_MV, J1772_THRESHOLD_B_C_MV, \
+			  J1772_THRESHOLD_C_D_MV, J1772_THRESHOLD_D_E_MV }, \
+	.hysteresis_mv = J1772_HYSTERESIS_MV, \
+	.debounce = J1772_DEBOUNCE_READS, \
+	.filter = EVSE_PILOT_FILTER_MEDIAN, \
+}
+
 /* Simulation mode state */
 static bool simulation_active;
 static j1772_state_t simulated_state;
 static uint32_t simulation_end_ms;
 
+/* Classifier state */
+static struct evse_pilot_config pilot_cfg = PILOT_CONFIG_DEFAULTS;
+static j1772_state_t accepted_state = J1772_STATE_UNKNOWN;
+static j1772_state_t candidate_state;
+static uint8_t candidate_reads;
+static bool have_sample_ms;
+static uint32_t last_sample_ms;
+static struct evse_pilot_stats pilot_stats;
+
 int evse_sensors_init(void)
 {
-	/* No init needed — platform owns the ADC hardware */
+	/* No hardware init — platform owns the ADC hardware */
+	accepted_state = J1772_STATE_UNKNOWN;
+	candidate_reads = 0;
+	have_sample_ms = false;
+	memset(&pilot_stats, 0, sizeof(pilot_stats));
 	LOG_INF("EVSE sensors ready (platform ADC)");
 	return 0;
 }
 
-int evse_pilot_voltage_read(uint16_t *voltage_mv)
+/*
+ * Reduce a burst to one pilot level. While the EVSE offers current the
+ * pilot is a 1 kHz PWM between the state level and -12 V, which the
+ * divider clamps to 0 mV. Samples at or below the D/E threshold are that
+ * low phase unless the whole burst is down there (state E).
+ */
+static uint16_t pilot_reduce(int16_t *mv, int n)
 {
-	if (!voltage_mv || !platform) {
-		return -1;
+	int high = 0;
+
+	for (int i = 0; i < n; i++) {
+		if (mv[i] > pilot_cfg.threshold_mv[3]) {
+			mv[high++] = mv[i];
+		}
+	}
+	if (high > 0) {
+		n = high;
+	}
+
+	for (int i = 1; i < n; i++) {
+		int16_t v = mv[i];
+		int j = i;
+
+		for (; j > 0 && mv[j - 1] > v; j--) {
+			mv[j] = mv[j - 1];
+		}
+		mv[j] = v;
+	}
+
+	if (pilot_cfg.filter == EVSE_PILOT_FILTER_TRIMMED_MEAN) {
+		int drop = n / 4;
+		int32_t sum = 0;
+
+		for (int i = drop; i < n - drop; i++) {
+			sum += mv[i];
+		}
+		return (uint16_t)(sum / (n - 2 * drop));
+	}
+	if (n % 2) {
+		return (uint16_t)mv[n / 2];
+	}
+	return (uint16_t)((mv[n / 2 - 1] + mv[n / 2]) / 2);
+}
+
+/*
+ * One pilot reading. *timed is set when it came from a platform scan,
+ * with *sample_ms the uptime of that scan; blocking reads are untimed.
+ */
+static int pilot_read(uint16_t *voltage_mv, uint32_t *sample_ms, bool *timed)
+{
+	int mv = PLATFORM_ADC_NO_SAMPLE;
+
+	*timed = false;
+
+	/* The platform's scan burst (API v7+) or cached reading (API v6)
+	 * is a memory load; older platforms, or no scan yet, convert on
+	 * demand */
+	if (app_platform_has_adc_burst()) {
+		int16_t burst[PILOT_BURST_MAX];
+		int n = platform->adc_get_burst(ADC_CHANNEL_PILOT, burst,
+						PILOT_BURST_MAX, sample_ms);
+
+		if (n > 0) {
+			*voltage_mv = pilot_reduce(burst, n);
+			*timed = true;
+			return 0;
+		}
+		if (n < 0) {
+			mv = n;
+		}
+	} else if (app_platform_has_adc_cache()) {
+		mv = platform->adc_get_mv(ADC_CHANNEL_PILOT, sample_ms);
+		*timed = mv >= 0;
+	}
+	if (mv == PLATFORM_ADC_NO_SAMPLE) {
+		mv = platform->adc_read_mv(ADC_CHANNEL_PILOT);
 	}
-	int mv = platform->adc_read_mv(ADC_CHANNEL_PILOT);
 	if (mv < 0) {
 		return mv;
 	}
@@ -46,6 +144,67 @@ int evse_pilot_voltage_read(uint16_t *voltage_mv)
 	return 0;
 }
 
+int evse_pilot_voltage_read(uint16_t *voltage_mv)
+{
+	if (!voltage_mv || !platform) {
+		return -1;
+	}
+	uint32_t sample_ms;
+	bool timed;
+
+	return pilot_read(voltage_mv, &sample_ms, &timed);
+}
+
+/* Threshold ladder, with each boundary moved hysteresis_mv away from
+ * the current state */
+static j1772_state_t pilot_classify(uint16_t mv, j1772_state_t from)
+{
+	for (int i = 0; i < 4; i++) {
+		int32_t threshold = pilot_cfg.threshold_mv[i];
+
+		/* Boundary i separates state i (above) from state i + 1 */
+		if (from <= J1772_STATE_E) {
+			threshold += (int)from <= i ? -(int32_t)pilot_cfg.hysteresis_mv
+						    : (int32_t)pilot_cfg.hysteresis_mv;
+		}
+		if (mv > threshold) {
+			return (j1772_state_t)i;
+		}
+	}
+	return J1772_STATE_E;
+}
+
+static void pilot_debounce(j1772_state_t raw, bool fresh)
+{
+	/* First reading after init: nothing to debounce against */
+	if (accepted_state == J1772_STATE_UNKNOWN) {
+		accepted_state = raw;
+		candidate_reads = 0;
+		return;
+	}
+	/* Re-reading the same scan is not a second vote */
+	if (!fresh) {
+		return;
+	}
+	if (raw == accepted_state) {
+		if (candidate_reads) {
+			pilot_stats.suppressed++;
+		}
+		candidate_reads = 0;
+		return;
+	}
+	if (candidate_reads && raw != candidate_state) {
+		pilot_stats.suppressed++;
+		candidate_reads = 0;
+	}
+	candidate_state = raw;
+	if (++candidate_reads >= pilot_cfg.debounce) {
+		accepted_state = raw;
+		candidate_reads = 0;
+		pilot_stats.transitions++;
+	}
+}
+
 int evse_j1772_state_get(j1772_state_t *state, uint16_t *voltage_mv)
 {
 	if (!state || !platform) {
@@ -70,7 +229,9 @@ int evse_j1772_state_get(j1772_state_t *state, uint16_t *voltage_mv)
 	}
 
 	uint16_t mv;
-	int err = evse_pilot_voltage_read(&mv);
+	uint32_t sample_ms = 0;
+	bool timed;
+	int err = pilot_read(&mv, &sample_ms, &timed);
 	if (err) {
 		*state = J1772_STATE_UNKNOWN;
 		return err;
@@ -80,17 +241,14 @@ int evse_j1772_state_get(j1772_state_t *state, uint16_t *voltage_mv)
 		*voltage_mv = mv;
 	}
 
-	if (mv > J1772_THRESHOLD_A_B_MV) {
-		*state = J1772_STATE_A;
-	} else if (mv > J1772_THRESHOLD_B_C_MV) {
-		*state = J1772_STATE_B;
-	} else if (mv > J1772_THRESHOLD_C_D_MV) {
-		*state = J1772_STATE_C;
-	} else if (mv > J1772_THRESHOLD_D_E_MV) {
-		*state = J1772_STATE_D;
-	} else {
-		*state = J1772_STATE_E;
+	bool fresh = !timed || !have_sample_ms || sample_ms != last_sample_ms;
+
+	if (timed) {
+		have_sample_ms = true;
+		last_sample_ms = sample_ms;
 	}
+	pilot_debounce(pilot_classify(mv, accepted_state), fresh);
+	*state = accepted_state;
 
 	return 0;
 }
@@ -148,3 +306,44 @@ bool evse_sensors_is_simulating(void)
 {
 	return simulation_active;
 }
+
+bool evse_pilot_settling(void)
+{
+	return candidate_reads > 0;
+}
+
+int evse_pilot_config_set(const struct evse_pilot_config *cfg)
+{
+	if (!cfg || cfg->debounce < 1 || cfg->debounce > EVSE_PILOT_DEBOUNCE_MAX ||
+	    cfg->filter > EVSE_PILOT_FILTER_TRIMMED_MEAN) {
+		return -1;
+	}
+	/* Bands of neighbouring thresholds must not overlap */
+	for (int i = 0; i < 3; i++) {
+		if (cfg->threshold_mv[i] <= cfg->threshold_mv[i + 1] ||
+		    cfg->threshold_mv[i] - cfg->threshold_mv[i + 1] <=
+		    2 * cfg->hysteresis_mv) {
+			return -1;
+		}
+	}
+	pilot_cfg = *cfg;
+	candidate_reads = 0;
+	return 0;
+}
+
+void evse_pilot_config_get(struct evse_pilot_config *cfg)
+{
+	*cfg = pilot_cfg;
+}
+
+void evse_pilot_config_defaults(struct evse_pilot_config *cfg)
+{
+	const struct evse_pilot_config defaults = PILOT_CONFIG_DEFAULTS;
+
+	*cfg = defaults;
+}
+
+void evse_pilot_stats_get(struct evse_pilot_stats *stats)
+{
+	*stats = pilot_stats;
+}
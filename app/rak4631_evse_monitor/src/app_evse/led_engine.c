@@ -2,8 +2,13 @@
  * LED Blink Priority State Machine
  *
  * Table-driven blink engine.  Each priority level has a pattern of
- * {duration_ticks, led_on} steps at 100ms resolution.  The highest-priority
- * active condition wins and drives the LED.
+ * {ticks, on} steps at 100ms resolution.  The highest-priority active
+ * condition wins and drives the LED.
+ *
+ * On platform API v9+ the platform plays the pattern from hardware: the
+ * engine uploads it when the priority changes and the CPU sleeps in
+ * between.  Older platforms, or one whose led_pattern() fails, get the
+ * pattern stepped here with led_set() on every tick.
  */
 
 #include <led_engine.h>
@@ -18,17 +23,15 @@
 /*  Pattern table                                                      */
 /* ------------------------------------------------------------------ */
 
-struct blink_step {
-	uint8_t duration;   /* ticks (100ms each) */
-	bool    on;
-};
+/* Steps are in the platform's led_pattern() format: {ticks (100ms
+ * each), on} */
 
-/* Maximum steps in any pattern */
+/* Maximum steps in any pattern (<= PLATFORM_LED_MAX_STEPS) */
 #define MAX_STEPS 6
 
 struct blink_pattern {
 	uint8_t step_count;
-	struct blink_step steps[MAX_STEPS];
+	struct platform_led_step steps[MAX_STEPS];
 };
 
 /* Priority 0 — Error: 5Hz = 100ms on, 100ms off */
@@ -104,6 +107,14 @@ static bool    ack_active;
 static uint8_t ack_step;
 static uint8_t ack_remaining;
 
+/* Hardware playback: the priority whose pattern the platform is playing
+ * (PUSHED_NONE after led_set() took the LED), and the ack one-shot */
+#define PUSHED_NONE 0xFF
+static uint8_t pushed;
+static bool    ack_pushed;
+static uint8_t ack_ticks_left;  /* ticks until the one-shot has played */
+static bool    hw_failed;       /* led_pattern() refused: step in software */
+
 /* Commissioning lifecycle */
 static bool commissioning_active;
 static bool first_uplink_sent;
@@ -234,7 +245,7 @@ static led_priority_t evaluate_priority(void)
 
 #define ACK_STEPS 6
 
-static const struct blink_step ack_pattern[ACK_STEPS] = {
+static const struct platform_led_step ack_pattern[ACK_STEPS] = {
 	{1, true}, {1, false},
 	{1, true}, {1, false},
 	{1, true}, {1, false},
@@ -254,6 +265,11 @@ void led_engine_init(void)
 	ack_step = 0;
 	ack_remaining = 0;
 
+	pushed = PUSHED_NONE;
+	ack_pushed = false;
+	ack_ticks_left = 0;
+	hw_failed = false;
+
 	commissioning_active = true;
 	first_uplink_sent = false;
 
@@ -270,16 +286,135 @@ void led_engine_init(void)
 	sidewalk_timeout_start_ms = 0;
 }
 
+/* Play one tick of the button-ack overlay; drive the LED if asked.
+ * Returns false once the overlay has finished (the tick is not used). */
+static bool ack_play(bool drive)
+{
+	if (!ack_active) {
+		return false;
+	}
+	if (ack_step >= ACK_STEPS) {
+		ack_active = false;
+		return false;
+	}
+	if (ack_remaining == 0) {
+		ack_remaining = ack_pattern[ack_step].ticks;
+	}
+	if (drive) {
+		platform->led_set(LED_GREEN, ack_pattern[ack_step].on);
+	}
+	ack_remaining--;
+	if (ack_remaining == 0) {
+		ack_step++;
+	}
+	return true;
+}
+
+/* Play one tick of the active priority's pattern; drive the LED if asked */
+static void pattern_play(bool drive)
+{
+	const struct blink_pattern *pat = patterns[active_priority];
+
+	/* Start step if remaining is 0 */
+	if (remaining == 0) {
+		if (step_index >= pat->step_count) {
+			step_index = 0;
+		}
+		remaining = pat->steps[step_index].ticks;
+	}
+
+	/* Drive LED */
+	if (drive) {
+		platform->led_set(LED_GREEN, pat->steps[step_index].on);
+	}
+
+	/* Advance */
+	remaining--;
+	if (remaining == 0) {
+		step_index++;
+		if (step_index >= pat->step_count) {
+			step_index = 0;
+		}
+	}
+}
+
+static uint32_t pattern_ticks(const struct blink_pattern *pat)
+{
+	uint32_t total = 0;
+
+	for (uint8_t i = 0; i < pat->step_count; i++) {
+		total += pat->steps[i].ticks;
+	}
+	return total;
+}
+
+static bool hw_playback(void)
+{
+	return !hw_failed && app_platform_has_led_pattern();
+}
+
+/* Upload steps to the platform; on failure fall back to software */
+static bool push(const struct platform_led_step *steps, uint8_t count, uint8_t repeat)
+{
+	int err = platform->led_pattern(LED_GREEN, steps, count, repeat);
+
+	if (err) {
+		LOG_WRN("LED pattern upload failed (%d), stepping in software", err);
+		hw_failed = true;
+		pushed = PUSHED_NONE;
+		return false;
+	}
+	return true;
+}
+
+/* One tick with the platform playing the patterns: upload the ack
+ * one-shot, or the priority's pattern when it changed. Returns false
+ * if the upload failed and this tick must be stepped in software. */
+static bool hw_tick(void)
+{
+	if (ack_active) {
+		if (!ack_pushed) {
+			if (!push(ack_pattern, ACK_STEPS, 1)) {
+				return false;
+			}
+			ack_pushed = true;
+			ack_ticks_left = ACK_STEPS;
+			pushed = PUSHED_NONE;  /* restore the pattern afterwards */
+			return true;
+		}
+		if (--ack_ticks_left > 0) {
+			return true;
+		}
+		ack_active = false;
+		ack_pushed = false;
+	}
+
+	led_priority_t pri = evaluate_priority();
+
+	active_priority = pri;
+	if (pushed != (uint8_t)pri) {
+		const struct blink_pattern *pat = patterns[pri];
+
+		if (!push(pat->steps, pat->step_count, PLATFORM_LED_REPEAT_FOREVER)) {
+			return false;
+		}
+		pushed = (uint8_t)pri;
+	}
+	return true;
+}
+
 void led_engine_tick(void)
 {
 	if (!platform) {
 		return;
 	}
 
-	/* Yield to selftest_trigger blink codes */
+	/* Yield to selftest_trigger blink codes; its led_set() calls stop
+	 * any hardware pattern, so upload again afterwards */
 	if (selftest_trigger_is_running()) {
 		step_index = 0;
 		remaining = 0;
+		pushed = PUSHED_NONE;
 		return;
 	}
 
@@ -300,21 +435,14 @@ void led_engine_tick(void)
 		sidewalk_timeout_started = false;
 	}
 
+	/* Platform plays the patterns (API v9+) */
+	if (hw_playback() && hw_tick()) {
+		return;
+	}
+
 	/* Button-ack overlay */
-	if (ack_active) {
-		if (ack_step >= ACK_STEPS) {
-			ack_active = false;
-		} else {
-			if (ack_remaining == 0) {
-				ack_remaining = ack_pattern[ack_step].duration;
-			}
-			platform->led_set(LED_GREEN, ack_pattern[ack_step].on);
-			ack_remaining--;
-			if (ack_remaining == 0) {
-				ack_step++;
-			}
-			return;
-		}
+	if (ack_play(true)) {
+		return;
 	}
 
 	/* Evaluate current priority */
@@ -327,27 +455,59 @@ void led_engine_tick(void)
 		remaining = 0;
 	}
 
-	const struct blink_pattern *pat = patterns[active_priority];
+	pattern_play(true);
+}
 
-	/* Start step if remaining is 0 */
-	if (remaining == 0) {
-		if (step_index >= pat->step_count) {
-			step_index = 0;
-		}
-		remaining = pat->steps[step_index].duration;
+void led_engine_advance(uint32_t ticks)
+{
+	if (ticks == 0 || !platform) {
+		return;
 	}
 
-	/* Drive LED */
-	platform->led_set(LED_GREEN, pat->steps[step_index].on);
+	/* The LED held its level through the skipped ticks: step the
+	 * playback position past them, then play the current tick */
+	if (hw_playback()) {
+		/* The platform played them; only the one-shot counts down */
+		if (ack_pushed && ack_ticks_left > ticks - 1) {
+			ack_ticks_left -= (uint8_t)(ticks - 1);
+		} else if (ack_pushed) {
+			ack_ticks_left = 1;
+		}
+	} else if (!selftest_trigger_is_running()) {
+		uint32_t skip = ticks - 1;
 
-	/* Advance */
-	remaining--;
-	if (remaining == 0) {
-		step_index++;
-		if (step_index >= pat->step_count) {
-			step_index = 0;
+		while (skip > 0 && ack_play(false)) {
+			skip--;
 		}
+		skip %= pattern_ticks(patterns[active_priority]);
+		while (skip-- > 0) {
+			pattern_play(false);
+		}
+	}
+	led_engine_tick();
+}
+
+uint32_t led_engine_next_ms(void)
+{
+	if (selftest_trigger_is_running()) {
+		return UINT32_MAX;
+	}
+	if (hw_playback()) {
+		if (ack_pushed) {
+			return (uint32_t)ack_ticks_left * LED_TICK_MS;
+		}
+		/* Only an upload still to do needs a tick */
+		return (ack_active || pushed != (uint8_t)active_priority) ?
+		       LED_TICK_MS : UINT32_MAX;
+	}
+	if (ack_active) {
+		return LED_TICK_MS;
+	}
+	if (patterns[active_priority]->step_count == 1) {
+		return UINT32_MAX;      /* solid: nothing changes until priority does */
 	}
+	/* The step playing now has `remaining` more ticks */
+	return ((uint32_t)remaining + 1) * LED_TICK_MS;
 }
 
 void led_engine_notify_uplink_sent(void)
@@ -401,6 +561,7 @@ void led_engine_button_ack(void)
 	ack_active = true;
 	ack_step = 0;
 	ack_remaining = 0;
+	ack_pushed = false;
 }
 
 led_priority_t led_engine_get_active_priority(void)
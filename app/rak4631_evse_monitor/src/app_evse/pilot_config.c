@@ -0,0 +1,46 @@
+/*
+ * Pilot Config — remote J1772 classifier tuning via 0x50 downlink
+ *
+ * Decodes the downlink into an evse_pilot_config; evse_sensors.c
+ * validates and applies it.
+ */
+
+#include <pilot_config.h>
+#include <evse_sensors.h>
+#include <app_platform.h>
+
+int pilot_config_process_cmd(const uint8_t *data, size_t len)
+{
+	if (!data || len < PILOT_CONFIG_RESET_SIZE || data[0] != PILOT_CONFIG_CMD_TYPE) {
+		return -1;
+	}
+
+	struct evse_pilot_config cfg;
+
+	if (len < PILOT_CONFIG_PAYLOAD_SIZE) {
+		if (len != PILOT_CONFIG_RESET_SIZE) {
+			LOG_ERR("Pilot config: bad length %zu", len);
+			return -1;
+		}
+		evse_pilot_config_defaults(&cfg);
+	} else {
+		for (int i = 0; i < 4; i++) {
+			cfg.threshold_mv[i] = (uint16_t)(data[1 + 2 * i] |
+							 (data[2 + 2 * i] << 8));
+		}
+		cfg.hysteresis_mv = (uint16_t)(data[9] * PILOT_CONFIG_HYSTERESIS_UNIT_MV);
+		cfg.debounce = data[10] & 0x0F;
+		cfg.filter = data[10] >> 4;
+	}
+
+	if (evse_pilot_config_set(&cfg) < 0) {
+		LOG_ERR("Pilot config rejected: %u/%u/%u/%u mV, +/-%u mV, %u reads, filter %u",
+			cfg.threshold_mv[0], cfg.threshold_mv[1], cfg.threshold_mv[2],
+			cfg.threshold_mv[3], cfg.hysteresis_mv, cfg.debounce, cfg.filter);
+		return -1;
+	}
+	LOG_INF("Pilot config: %u/%u/%u/%u mV, +/-%u mV, %u reads, filter %u",
+		cfg.threshold_mv[0], cfg.threshold_mv[1], cfg.threshold_mv[2],
+		cfg.threshold_mv[3], cfg.hysteresis_mv, cfg.debounce, cfg.filter);
+	return 0;
+}
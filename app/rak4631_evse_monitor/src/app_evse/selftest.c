@@ -67,7 +67,8 @@ int selftest_boot(selftest_boot_result_t *result)
 	result->all_pass = false;
 
 	/* 1. ADC pilot channel readable */
-	result->adc_pilot_ok = (platform->adc_read_mv(0) >= 0);
+	uint16_t pilot_mv;
+	result->adc_pilot_ok = (evse_pilot_voltage_read(&pilot_mv) == 0);
 
 	/* 2. GPIO cool input readable */
 	result->gpio_cool_ok = (platform->gpio_get(PIN_COOL) >= 0);
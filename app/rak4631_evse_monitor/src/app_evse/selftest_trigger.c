@@ -1,7 +1,9 @@
 /*
  * Button Event Handler + Self-Test Trigger
  *
- * Polls the Charge Now button GPIO every 500ms tick.  Dispatches:
+ * Takes Charge Now button presses from GPIO edge interrupts (API v8+),
+ * timestamped by the platform, or polls the button every 500ms tick on
+ * older platforms. Dispatches:
  *   - Single press (1 press, 1.5s timeout) → charge_now_activate()
  *   - Long press (held 3s) → charge_now_cancel()
  *   - 5 presses within 5s → self-test with LED blink codes
@@ -25,6 +27,7 @@ static selftest_send_fn send_fn;
 static uint32_t press_times[TRIGGER_PRESS_COUNT];
 static int press_count;
 static bool last_button_pressed;
+static bool edge_driven;        /* presses arrive via selftest_trigger_on_edge */
 
 /* Single-press detection */
 static bool single_press_pending;
@@ -76,6 +79,12 @@ void selftest_trigger_init(void)
 	button_held_since = 0;
 	tracking_hold = false;
 	long_press_fired = false;
+
+	edge_driven = app_platform_has_gpio_edges() &&
+		      platform->gpio_subscribe(PIN_CHARGE_NOW_BUTTON, BUTTON_DEBOUNCE_MS) == 0;
+	if (edge_driven) {
+		last_button_pressed = (platform->gpio_get(PIN_CHARGE_NOW_BUTTON) == 1);
+	}
 }
 
 bool selftest_trigger_is_running(void)
@@ -128,17 +137,14 @@ static void start_selftest(void)
 }
 
 /* ------------------------------------------------------------------ */
-/*  Button polling                                                     */
+/*  Button presses                                                     */
 /* ------------------------------------------------------------------ */
 
-static void poll_button(void)
+/* The button changed to `pressed` at `now` */
+static void button_changed(bool pressed, uint32_t now)
 {
-	/* platform guaranteed non-NULL by selftest_trigger_tick() */
-	bool pressed = (platform->gpio_get(PIN_CHARGE_NOW_BUTTON) == 1);
-	uint32_t now = platform->uptime_ms();
-
 	/* Rising edge — new press */
-	if (pressed && !last_button_pressed) {
+	if (pressed) {
 		/* Expire old presses outside window */
 		while (press_count > 0 &&
 		       (now - press_times[0]) > TRIGGER_WINDOW_MS) {
@@ -173,10 +179,18 @@ static void poll_button(void)
 	}
 
 	/* Falling edge — button released */
-	if (!pressed && last_button_pressed) {
+	if (!pressed) {
 		tracking_hold = false;
 	}
 
+	last_button_pressed = pressed;
+}
+
+/* Long-press and single-press timeouts, with the button as last seen */
+static void button_timeouts(uint32_t now)
+{
+	bool pressed = last_button_pressed;
+
 	/* Long press check: held continuously for 3s */
 	if (pressed && tracking_hold && !long_press_fired) {
 		if ((now - button_held_since) >= LONG_PRESS_MS) {
@@ -197,8 +211,67 @@ static void poll_button(void)
 			charge_now_activate();
 		}
 	}
+}
 
-	last_button_pressed = pressed;
+static void poll_button(void)
+{
+	/* platform guaranteed non-NULL by selftest_trigger_tick() */
+	bool pressed = (platform->gpio_get(PIN_CHARGE_NOW_BUTTON) == 1);
+	uint32_t now = platform->uptime_ms();
+
+	if (pressed != last_button_pressed) {
+		button_changed(pressed, now);
+	}
+	button_timeouts(now);
+}
+
+bool selftest_trigger_on_edge(const struct platform_gpio_edge *edge)
+{
+	if (edge->pin != PIN_CHARGE_NOW_BUTTON) {
+		return false;
+	}
+
+	bool pressed = (edge->level == 1);
+
+	if (state != TRIG_IDLE) {
+		/* Presses during the blink codes are ignored, as when polling */
+		last_button_pressed = pressed;
+		tracking_hold = false;
+	} else if (pressed != last_button_pressed) {
+		button_changed(pressed, edge->at_ms);
+	}
+	return true;
+}
+
+/* ms left of `timeout` when `elapsed` has passed */
+static uint32_t time_left(uint32_t timeout, uint32_t elapsed)
+{
+	return (elapsed >= timeout) ? 0 : timeout - elapsed;
+}
+
+uint32_t selftest_trigger_next_ms(void)
+{
+	if (!platform) {
+		return UINT32_MAX;
+	}
+	if (state != TRIG_IDLE || !edge_driven) {
+		return 0;
+	}
+
+	uint32_t now = platform->uptime_ms();
+	uint32_t next = UINT32_MAX;
+
+	if (last_button_pressed && tracking_hold && !long_press_fired) {
+		next = time_left(LONG_PRESS_MS, now - button_held_since);
+	}
+	if (single_press_pending && !last_button_pressed) {
+		uint32_t left = time_left(SINGLE_PRESS_TIMEOUT_MS, now - single_press_time);
+
+		if (left < next) {
+			next = left;
+		}
+	}
+	return next;
 }
 
 /* ------------------------------------------------------------------ */
@@ -250,7 +323,11 @@ void selftest_trigger_tick(void)
 
 	switch (state) {
 	case TRIG_IDLE:
-		poll_button();
+		if (edge_driven) {
+			button_timeouts(platform->uptime_ms());
+		} else {
+			poll_button();
+		}
 		break;
 	case TRIG_BLINKING:
 		drive_blinks();
@@ -7,12 +7,22 @@
 #include <thermostat_inputs.h>
 #include <app_platform.h>
 
-/* GPIO pin indices — must match platform board-level mapping */
-#define PIN_COOL   2
+static bool edge_driven;
+static bool cool_call;          /* level from the last edge (edge_driven) */
+static uint32_t cool_changed_ms;
 
 int thermostat_inputs_init(void)
 {
 	/* Platform owns GPIO init */
+	edge_driven = false;
+	cool_changed_ms = 0;
+
+	if (app_platform_has_gpio_edges() &&
+	    platform->gpio_subscribe(THERMOSTAT_PIN_COOL, THERMOSTAT_DEBOUNCE_MS) == 0) {
+		/* Read after subscribing: a change from here on arrives as an edge */
+		cool_call = platform->gpio_get(THERMOSTAT_PIN_COOL) > 0;
+		edge_driven = true;
+	}
 	return 0;
 }
 
@@ -21,7 +31,10 @@ bool thermostat_inputs_cool_call_get(void)
 	if (!platform) {
 		return false;
 	}
-	int val = platform->gpio_get(PIN_COOL);
+	if (edge_driven) {
+		return cool_call;
+	}
+	int val = platform->gpio_get(THERMOSTAT_PIN_COOL);
 	return (val > 0);
 }
 
@@ -35,3 +48,23 @@ uint8_t thermostat_inputs_flags_get(void)
 
 	return flags;
 }
+
+bool thermostat_inputs_on_edge(const struct platform_gpio_edge *edge)
+{
+	if (edge->pin != THERMOSTAT_PIN_COOL) {
+		return false;
+	}
+	cool_call = edge->level != 0;
+	cool_changed_ms = edge->at_ms;
+	return true;
+}
+
+bool thermostat_inputs_edge_driven(void)
+{
+	return edge_driven;
+}
+
+uint32_t thermostat_inputs_changed_ms(void)
+{
+	return cool_changed_ms;
+}
@@ -75,6 +75,23 @@ uint32_t time_sync_get_epoch(void)
 	return sync_epoch + elapsed_s;
 }
 
+uint32_t time_sync_epoch_at(uint32_t uptime_ms)
+{
+	if (!synced || !platform) {
+		return 0;
+	}
+
+	/* Measured back from now, so it holds however long ago the sync was */
+	uint32_t now_ms = platform->uptime_ms();
+	uint32_t since_sync = now_ms - sync_uptime_ms;
+	uint32_t age = now_ms - uptime_ms;
+
+	if (age <= since_sync) {
+		return sync_epoch + (since_sync - age) / 1000;
+	}
+	return sync_epoch - (age - since_sync + 999) / 1000;
+}
+
 uint32_t time_sync_get_ack_watermark(void)
 {
 	return ack_watermark;
@@ -0,0 +1,491 @@
+/*
+ * Event Log — append-only persistent record log in spare app flash
+ *
+ * Slot format (16 bytes, one aligned program per slot):
+ *   [0..11]  payload (zero-padded to 12 bytes)
+ *   [12]     kind (HEADER / RECORD / TRIM)
+ *   [13]     payload length
+ *   [14..15] low 16 bits of CRC32 over bytes 0..13
+ *
+ * Slot 0 of every page is a HEADER (magic, page sequence, and the trim
+ * point at the time the page was started). Pages are filled in ring
+ * order; the page with the highest sequence is the head. An erased slot
+ * is all 0xFF; a slot with a bad CRC is a torn append and is skipped.
+ *
+ * Every slot has a position, page sequence << 8 | slot, that only grows
+ * in append order. The trim point is the position of the newest trimmed
+ * record: records after it are live whatever their keys, so records
+ * keyed by a clock that stepped back stay live. It is persisted as a
+ * TRIM slot whenever it advances, and again in each new page header, so
+ * it survives the page holding the last TRIM slot being recycled.
+ */
+
+#include <event_log.h>
+#include <ota_flash.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(event_log, CONFIG_SIDEWALK_LOG_LEVEL);
+
+#define EVENT_LOG_MAGIC        0x32474C45  /* "ELG2": trimmed by position */
+
+#define SLOT_KIND_HEADER       0x5A
+#define SLOT_KIND_RECORD       0x01
+#define SLOT_KIND_TRIM         0x02
+#define SLOT_ERASED            0x100       /* read_slot() results beyond kind bytes */
+#define SLOT_TORN              0x101
+
+#define SLOT_KIND_OFF          12
+#define SLOT_LEN_OFF           13
+#define SLOT_CRC_OFF           14
+
+_Static_assert(EVENT_LOG_SLOTS_PER_PAGE <= 0xFF, "slot must fit the low byte of a position");
+
+struct log_pos {
+	uint8_t  page;
+	uint16_t slot;
+};
+
+static bool initialized;
+static uint32_t page_seq[EVENT_LOG_FLASH_PAGES];  /* 0 = no valid header */
+static uint32_t max_seq;
+static bool have_head;
+static uint8_t head_page;
+static uint16_t head_slot;           /* next free slot in head page */
+
+static bool have_trim;
+static uint32_t trim_pos;            /* position of the newest trimmed record */
+
+static uint32_t count;               /* untrimmed records */
+static struct log_pos tail;          /* oldest untrimmed record (valid if count) */
+
+/* Sequential read cache */
+static bool rd_valid;
+static uint32_t rd_index;
+static struct log_pos rd_pos;
+
+/* ------------------------------------------------------------------ */
+/*  Slot I/O                                                           */
+/* ------------------------------------------------------------------ */
+
+static uint32_t slot_addr(uint8_t page, uint16_t slot)
+{
+	return EVENT_LOG_FLASH_ADDR + (uint32_t)page * OTA_FLASH_PAGE_SIZE +
+	       (uint32_t)slot * EVENT_LOG_SLOT_SIZE;
+}
+
+static uint16_t slot_crc(const uint8_t *slot)
+{
+	return (uint16_t)crc32_ieee_update(0, slot, SLOT_CRC_OFF);
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+	p[0] = v & 0xFF;
+	p[1] = (v >> 8) & 0xFF;
+	p[2] = (v >> 16) & 0xFF;
+	p[3] = (v >> 24) & 0xFF;
+}
+
+/**
+ * Read and classify a slot. Returns the slot kind, SLOT_ERASED or SLOT_TORN.
+ */
+static int read_slot(uint8_t page, uint16_t slot, uint8_t *buf)
+{
+	if (ota_flash_read(slot_addr(page, slot), buf, EVENT_LOG_SLOT_SIZE)) {
+		return SLOT_TORN;
+	}
+
+	bool erased = true;
+	for (int i = 0; i < EVENT_LOG_SLOT_SIZE; i++) {
+		if (buf[i] != 0xFF) {
+			erased = false;
+			break;
+		}
+	}
+	if (erased) {
+		return SLOT_ERASED;
+	}
+
+	uint16_t crc = buf[SLOT_CRC_OFF] | (buf[SLOT_CRC_OFF + 1] << 8);
+	if (crc != slot_crc(buf) || buf[SLOT_LEN_OFF] > EVENT_LOG_RECORD_MAX) {
+		return SLOT_TORN;
+	}
+	return buf[SLOT_KIND_OFF];
+}
+
+static int write_slot(uint8_t page, uint16_t slot, uint8_t kind,
+		      const void *data, size_t len)
+{
+	uint8_t buf[EVENT_LOG_SLOT_SIZE];
+
+	memset(buf, 0, EVENT_LOG_RECORD_MAX);
+	memcpy(buf, data, len);
+	buf[SLOT_KIND_OFF] = kind;
+	buf[SLOT_LEN_OFF] = (uint8_t)len;
+	uint16_t crc = slot_crc(buf);
+	buf[SLOT_CRC_OFF] = crc & 0xFF;
+	buf[SLOT_CRC_OFF + 1] = (crc >> 8) & 0xFF;
+
+	return ota_flash_write(slot_addr(page, slot), buf, sizeof(buf));
+}
+
+/* ------------------------------------------------------------------ */
+/*  Chronological iteration                                            */
+/* ------------------------------------------------------------------ */
+
+static uint32_t slot_pos(uint8_t page, uint16_t slot)
+{
+	return (page_seq[page] << 8) | slot;
+}
+
+static bool record_live(uint8_t page, uint16_t slot)
+{
+	return !have_trim || slot_pos(page, slot) > trim_pos;
+}
+
+static struct log_pos oldest_pos(void)
+{
+	struct log_pos p = { .page = head_page, .slot = 1 };
+
+	for (int i = 1; i <= EVENT_LOG_FLASH_PAGES; i++) {
+		uint8_t page = (head_page + i) % EVENT_LOG_FLASH_PAGES;
+		if (page_seq[page] != 0) {
+			p.page = page;
+			break;
+		}
+	}
+	return p;
+}
+
+/**
+ * Move p forward (inclusive) to the next untrimmed record.
+ * Returns false when the head is reached.
+ */
+static bool seek_record(struct log_pos *p, uint8_t *buf)
+{
+	if (!have_head) {
+		return false;
+	}
+
+	while (true) {
+		uint16_t limit = (p->page == head_page) ? head_slot
+							: EVENT_LOG_SLOTS_PER_PAGE + 1;
+
+		if (p->slot < limit) {
+			if (read_slot(p->page, p->slot, buf) == SLOT_KIND_RECORD &&
+			    record_live(p->page, p->slot)) {
+				return true;
+			}
+			p->slot++;
+			continue;
+		}
+
+		if (p->page == head_page) {
+			return false;
+		}
+		do {
+			p->page = (p->page + 1) % EVENT_LOG_FLASH_PAGES;
+		} while (page_seq[p->page] == 0 && p->page != head_page);
+		p->slot = 1;
+	}
+}
+
+static void recount(void)
+{
+	uint8_t buf[EVENT_LOG_SLOT_SIZE];
+	struct log_pos p = oldest_pos();
+
+	count = 0;
+	rd_valid = false;
+	if (!seek_record(&p, buf)) {
+		return;
+	}
+	tail = p;
+	do {
+		count++;
+		p.slot++;
+	} while (seek_record(&p, buf));
+}
+
+/* ------------------------------------------------------------------ */
+/*  Boot scan                                                          */
+/* ------------------------------------------------------------------ */
+
+int event_log_init(void)
+{
+	uint8_t buf[EVENT_LOG_SLOT_SIZE];
+
+	int err = ota_flash_init();
+	if (err) {
+		return err;
+	}
+
+	have_head = false;
+	have_trim = false;
+	trim_pos = 0;
+	max_seq = 0;
+
+	for (uint8_t page = 0; page < EVENT_LOG_FLASH_PAGES; page++) {
+		page_seq[page] = 0;
+		if (read_slot(page, 0, buf) != SLOT_KIND_HEADER ||
+		    get_le32(buf) != EVENT_LOG_MAGIC) {
+			continue;
+		}
+		page_seq[page] = get_le32(&buf[4]);
+		if (page_seq[page] > max_seq) {
+			max_seq = page_seq[page];
+			head_page = page;
+			have_head = true;
+		}
+		if (buf[SLOT_LEN_OFF] == 12) {
+			uint32_t pos = get_le32(&buf[8]);
+			if (!have_trim || pos > trim_pos) {
+				trim_pos = pos;
+				have_trim = true;
+			}
+		}
+	}
+
+	/* Latest TRIM slot anywhere, and the head's first free slot. A torn
+	 * slot counts as used — flash cannot be reprogrammed without erase. */
+	head_slot = 1;
+	for (uint8_t page = 0; page < EVENT_LOG_FLASH_PAGES; page++) {
+		if (page_seq[page] == 0) {
+			continue;
+		}
+		for (uint16_t slot = 1; slot <= EVENT_LOG_SLOTS_PER_PAGE; slot++) {
+			int kind = read_slot(page, slot, buf);
+			if (kind == SLOT_ERASED) {
+				continue;
+			}
+			if (page == head_page) {
+				head_slot = slot + 1;
+			}
+			if (kind == SLOT_KIND_TRIM) {
+				uint32_t pos = get_le32(buf);
+				if (!have_trim || pos > trim_pos) {
+					trim_pos = pos;
+					have_trim = true;
+				}
+			}
+		}
+	}
+
+	recount();
+	initialized = true;
+
+	LOG_INF("Event log: %u records, %s page %u slot %u", count,
+		have_head ? "head" : "empty,", head_page, head_slot);
+	return 0;
+}
+
+static int ensure_init(void)
+{
+	return initialized ? 0 : event_log_init();
+}
+
+/* ------------------------------------------------------------------ */
+/*  Append / rotate                                                    */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Start the next page in ring order: drop any records it still holds,
+ * erase it once, and write its header.
+ */
+static int start_page(void)
+{
+	uint8_t buf[EVENT_LOG_SLOT_SIZE];
+	uint8_t next = have_head ? (head_page + 1) % EVENT_LOG_FLASH_PAGES : 0;
+	bool dropped = false;
+
+	if (page_seq[next] != 0 && have_head && next != head_page) {
+		for (uint16_t slot = 1; slot <= EVENT_LOG_SLOTS_PER_PAGE; slot++) {
+			if (read_slot(next, slot, buf) == SLOT_KIND_RECORD &&
+			    record_live(next, slot)) {
+				dropped = true;
+				break;
+			}
+		}
+		if (dropped) {
+			LOG_WRN("Event log full: dropping oldest page");
+		}
+	}
+	page_seq[next] = 0;
+
+	int err = ota_flash_erase_pages(slot_addr(next, 0), OTA_FLASH_PAGE_SIZE);
+	if (err) {
+		LOG_ERR("Event log: erase page %u failed: %d", next, err);
+		return err;
+	}
+
+	uint8_t hdr[EVENT_LOG_RECORD_MAX];
+	put_le32(&hdr[0], EVENT_LOG_MAGIC);
+	put_le32(&hdr[4], max_seq + 1);
+	put_le32(&hdr[8], trim_pos);
+	err = write_slot(next, 0, SLOT_KIND_HEADER, hdr, have_trim ? 12 : 8);
+	if (err) {
+		LOG_ERR("Event log: header write failed: %d", err);
+		return err;
+	}
+
+	max_seq++;
+	page_seq[next] = max_seq;
+	head_page = next;
+	head_slot = 1;
+	have_head = true;
+
+	if (dropped) {
+		recount();
+	}
+	return 0;
+}
+
+static int append_slot(uint8_t kind, const void *data, size_t len)
+{
+	if (!have_head || head_slot > EVENT_LOG_SLOTS_PER_PAGE) {
+		int err = start_page();
+		if (err) {
+			return err;
+		}
+	}
+
+	uint16_t slot = head_slot++;  /* consumed even on failure (may be torn) */
+	return write_slot(head_page, slot, kind, data, len);
+}
+
+int event_log_append(const void *rec, size_t len)
+{
+	if (!rec || len == 0 || len > EVENT_LOG_RECORD_MAX) {
+		return -EINVAL;
+	}
+	int err = ensure_init();
+	if (err) {
+		return err;
+	}
+
+	err = append_slot(SLOT_KIND_RECORD, rec, len);
+	if (err) {
+		return err;
+	}
+
+	if (count == 0) {
+		tail.page = head_page;
+		tail.slot = head_slot - 1;
+	}
+	count++;
+	return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Read / trim                                                        */
+/* ------------------------------------------------------------------ */
+
+int event_log_read(uint32_t index, void *rec, size_t len)
+{
+	uint8_t buf[EVENT_LOG_SLOT_SIZE];
+
+	if (!rec || ensure_init()) {
+		return -EINVAL;
+	}
+	if (index >= count) {
+		return -ENOENT;
+	}
+
+	struct log_pos p;
+	uint32_t i;
+
+	if (rd_valid && index >= rd_index) {
+		p = rd_pos;
+		i = rd_index;
+		if (index > i) {
+			p.slot++;
+			i++;
+		}
+	} else {
+		p = tail;
+		i = 0;
+	}
+
+	while (true) {
+		if (!seek_record(&p, buf)) {
+			rd_valid = false;
+			return -ENOENT;
+		}
+		if (i == index) {
+			break;
+		}
+		p.slot++;
+		i++;
+	}
+
+	rd_valid = true;
+	rd_index = index;
+	rd_pos = p;
+
+	size_t n = buf[SLOT_LEN_OFF];
+	memset(rec, 0, len);
+	memcpy(rec, buf, (len < n) ? len : n);
+	return 0;
+}
+
+int event_log_trim(uint32_t key_watermark)
+{
+	uint8_t buf[EVENT_LOG_SLOT_SIZE];
+
+	int err = ensure_init();
+	if (err) {
+		return err;
+	}
+	/* Walk from the tail until the first newer record, or the first
+	 * whose key went back (clock stepped back): the watermark says
+	 * nothing about those. The trim point is a position, not the key, so
+	 * what follows stays live whatever its key. */
+	struct log_pos p = tail;
+	struct log_pos last = p;
+	uint32_t trimmed = 0;
+	uint32_t prev = 0;
+	while (trimmed < count && seek_record(&p, buf)) {
+		uint32_t key = get_le32(buf);
+
+		if (key > key_watermark || key < prev) {
+			break;
+		}
+		prev = key;
+		last = p;
+		trimmed++;
+		p.slot++;
+	}
+
+	if (trimmed == 0) {
+		return 0;
+	}
+
+	trim_pos = slot_pos(last.page, last.slot);
+	have_trim = true;
+	rd_valid = false;
+	count -= trimmed;
+	if (count > 0) {
+		seek_record(&p, buf);
+		tail = p;
+	}
+
+	return append_slot(SLOT_KIND_TRIM, &trim_pos, sizeof(trim_pos));
+}
+
+uint32_t event_log_count(void)
+{
+	if (ensure_init()) {
+		return 0;
+	}
+	return count;
+}
@@ -0,0 +1,148 @@
+/*
+ * GPIO Edges — per-pin debounce and the settled-change queue
+ *
+ * Each subscribed pin tracks the level last delivered (stable) and the
+ * latest raw level. A raw edge away from stable opens a burst; the pin
+ * settles once no edge has arrived for its debounce time. A burst whose
+ * settle is overdue when the next edge arrives (the work queue ran late)
+ * is settled first, so that change is not lost.
+ */
+
+#include <gpio_edge.h>
+
+#include <errno.h>
+#include <string.h>
+
+struct edge_pin {
+	bool subscribed;
+	bool bouncing;
+	uint8_t stable;         /* level last queued */
+	uint8_t raw;            /* level at the latest edge */
+	uint32_t debounce_ms;
+	uint32_t first_ms;      /* first edge of the burst */
+	uint32_t last_ms;       /* latest edge */
+};
+
+static struct {
+	struct edge_pin pin[GPIO_EDGE_MAX_PINS];
+	struct platform_gpio_edge queue[GPIO_EDGE_QUEUE];
+	uint8_t head;           /* oldest queued change */
+	uint8_t len;
+	struct gpio_edge_stats stats;
+} edges;
+
+void gpio_edge_init(void)
+{
+	memset(&edges, 0, sizeof(edges));
+}
+
+int gpio_edge_subscribe(int pin, int level, uint32_t debounce_ms)
+{
+	if (pin < 0 || pin >= GPIO_EDGE_MAX_PINS || debounce_ms > GPIO_EDGE_DEBOUNCE_MAX_MS) {
+		return -EINVAL;
+	}
+
+	struct edge_pin *p = &edges.pin[pin];
+
+	if (!p->subscribed) {
+		p->subscribed = true;
+		p->bouncing = false;
+		p->stable = level ? 1 : 0;
+		p->raw = p->stable;
+	}
+	p->debounce_ms = debounce_ms;
+	return 0;
+}
+
+bool gpio_edge_subscribed(int pin)
+{
+	return pin >= 0 && pin < GPIO_EDGE_MAX_PINS && edges.pin[pin].subscribed;
+}
+
+static void settle(int pin)
+{
+	struct edge_pin *p = &edges.pin[pin];
+
+	p->bouncing = false;
+	if (p->raw == p->stable) {
+		edges.stats.bounces++;
+		return;
+	}
+	p->stable = p->raw;
+	if (edges.len == GPIO_EDGE_QUEUE) {
+		edges.stats.dropped++;
+		return;
+	}
+	edges.queue[(edges.head + edges.len) % GPIO_EDGE_QUEUE] = (struct platform_gpio_edge){
+		.at_ms = p->first_ms,
+		.pin = (uint8_t)pin,
+		.level = p->raw,
+	};
+	edges.len++;
+}
+
+static bool due(const struct edge_pin *p, uint32_t now_ms)
+{
+	return p->bouncing && (now_ms - p->last_ms) >= p->debounce_ms;
+}
+
+uint32_t gpio_edge_isr(int pin, int level, uint32_t now_ms)
+{
+	if (!gpio_edge_subscribed(pin)) {
+		return 0;
+	}
+
+	struct edge_pin *p = &edges.pin[pin];
+	uint8_t lvl = level ? 1 : 0;
+
+	edges.stats.edges++;
+	if (due(p, now_ms)) {
+		settle(pin);
+	}
+	if (!p->bouncing) {
+		if (lvl == p->stable) {
+			return 0;       /* interrupt without a change */
+		}
+		p->bouncing = true;
+		p->first_ms = now_ms;
+	}
+	p->raw = lvl;
+	p->last_ms = now_ms;
+	return p->debounce_ms ? p->debounce_ms : 1;
+}
+
+uint32_t gpio_edge_collect(uint32_t now_ms, struct platform_gpio_edge *out,
+			   size_t max, size_t *count)
+{
+	uint32_t next = 0;
+
+	for (int i = 0; i < GPIO_EDGE_MAX_PINS; i++) {
+		struct edge_pin *p = &edges.pin[i];
+
+		if (due(p, now_ms)) {
+			settle(i);
+		} else if (p->bouncing) {
+			uint32_t left = p->debounce_ms - (now_ms - p->last_ms);
+
+			if (!next || left < next) {
+				next = left;
+			}
+		}
+	}
+
+	size_t n = 0;
+
+	while (n < max && edges.len) {
+		out[n++] = edges.queue[edges.head];
+		edges.head = (edges.head + 1) % GPIO_EDGE_QUEUE;
+		edges.len--;
+	}
+	edges.stats.delivered += n;
+	*count = n;
+	return next;
+}
+
+void gpio_edge_stats(struct gpio_edge_stats *stats)
+{
+	*stats = edges.stats;
+}
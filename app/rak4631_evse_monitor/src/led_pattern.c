@@ -0,0 +1,55 @@
+/*
+ * LED Pattern — steps to a PWM sequence
+ *
+ * The sequence repeats as a whole, so the pattern's period must fit in
+ * LED_PATTERN_MAX_VALUES values once scaled: the idle blip (1 + 99
+ * ticks, no common divisor) is the longest the app plays.
+ */
+
+#include <led_pattern.h>
+
+#include <errno.h>
+
+static uint16_t gcd(uint16_t a, uint16_t b)
+{
+	while (b) {
+		uint16_t t = a % b;
+
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+int led_pattern_build(const struct platform_led_step *steps, size_t count,
+		      struct led_pattern_seq *seq)
+{
+	if (!count || count > PLATFORM_LED_MAX_STEPS) {
+		return -EINVAL;
+	}
+
+	uint16_t unit = 0;
+	uint16_t total = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		if (!steps[i].ticks) {
+			return -EINVAL;
+		}
+		unit = gcd(unit, steps[i].ticks);
+		total += steps[i].ticks;
+	}
+	if (total / unit > LED_PATTERN_MAX_VALUES) {
+		return -EINVAL;
+	}
+
+	uint16_t n = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		for (uint16_t t = 0; t < steps[i].ticks / unit; t++) {
+			seq->values[n++] = steps[i].on ? LED_PATTERN_ON : LED_PATTERN_OFF;
+		}
+	}
+	seq->length = n;
+	seq->refresh = unit - 1;
+	return 0;
+}
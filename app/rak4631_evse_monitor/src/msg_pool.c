@@ -0,0 +1,63 @@
+/*
+ * Message Pool — fixed-slot, lock-free allocator for Sidewalk events
+ */
+
+#include <msg_pool.h>
+
+static uint8_t bit_count(uint32_t v)
+{
+	uint8_t n = 0;
+	while (v) {
+		v &= v - 1;
+		n++;
+	}
+	return n;
+}
+
+void *msg_pool_alloc(struct msg_pool *pool)
+{
+	uint32_t all = (pool->slots == 32) ? UINT32_MAX : ((1u << pool->slots) - 1);
+
+	for (;;) {
+		uint32_t used = (uint32_t)atomic_get(&pool->used);
+		uint32_t free_bits = ~used & all;
+
+		if (!free_bits) {
+			atomic_inc(&pool->exhausted);
+			return NULL;
+		}
+		int idx = __builtin_ctz(free_bits);   /* lowest free slot */
+		uint32_t bit = 1u << idx;
+
+		if (!atomic_cas(&pool->used, (atomic_val_t)used, (atomic_val_t)(used | bit))) {
+			continue;   /* raced with another alloc/free */
+		}
+
+		atomic_val_t in_use = bit_count(used | bit);
+		atomic_val_t hw = atomic_get(&pool->high_water);
+		while (in_use > hw && !atomic_cas(&pool->high_water, hw, in_use)) {
+			hw = atomic_get(&pool->high_water);
+		}
+		return pool->buf + (size_t)idx * pool->slot_size;
+	}
+}
+
+void msg_pool_free(struct msg_pool *pool, void *slot)
+{
+	uint8_t *p = slot;
+
+	if (!p || p < pool->buf ||
+	    p >= pool->buf + (size_t)pool->slots * pool->slot_size) {
+		return;
+	}
+	size_t idx = (size_t)(p - pool->buf) / pool->slot_size;
+	atomic_and(&pool->used, ~(atomic_val_t)(1u << idx));
+}
+
+void msg_pool_stats(struct msg_pool *pool, struct msg_pool_stats *stats)
+{
+	stats->slots = pool->slots;
+	stats->in_use = bit_count((uint32_t)atomic_get(&pool->used));
+	stats->high_water = (uint8_t)atomic_get(&pool->high_water);
+	stats->exhausted = (uint32_t)atomic_get(&pool->exhausted);
+}
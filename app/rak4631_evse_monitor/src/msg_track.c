@@ -0,0 +1,105 @@
+/*
+ * Message Track — Sidewalk message ids back to send_msg() tokens
+ *
+ * A slot with token 0 is free. Each pair carries the order it was added
+ * in, so a full table evicts the oldest pair, not whichever slot comes
+ * next.
+ */
+
+#include <msg_track.h>
+
+#include <string.h>
+
+struct track_slot {
+	uint32_t token;         /* 0: free */
+	uint32_t order;         /* msg_track_add() count when recorded */
+	uint16_t sid_id;
+	bool app;               /* sent by the app, not the platform */
+};
+
+static struct {
+	struct track_slot slot[MSG_TRACK_SLOTS];
+	uint32_t order;
+	struct msg_track_stats stats;
+} track;
+
+void msg_track_init(void)
+{
+	memset(&track, 0, sizeof(track));
+}
+
+static struct track_slot *find(uint16_t sid_id)
+{
+	for (int i = 0; i < MSG_TRACK_SLOTS; i++) {
+		if (track.slot[i].token && track.slot[i].sid_id == sid_id) {
+			return &track.slot[i];
+		}
+	}
+	return NULL;
+}
+
+uint32_t msg_track_add(uint16_t sid_id, uint32_t token, bool app)
+{
+	struct track_slot *s = find(sid_id);
+	uint32_t evicted = 0;
+
+	if (s) {
+		/* The stack reused the id: the old pair's result is gone */
+		evicted = s->token;
+		track.stats.evicted++;
+	} else {
+		/* A free slot, else the oldest pair */
+		s = &track.slot[0];
+		for (int i = 0; i < MSG_TRACK_SLOTS; i++) {
+			struct track_slot *t = &track.slot[i];
+
+			if (!t->token) {
+				s = t;
+				break;
+			}
+			if (track.order - t->order > track.order - s->order) {
+				s = t;
+			}
+		}
+		if (s->token) {
+			evicted = s->token;
+			track.stats.evicted++;
+		} else {
+			track.stats.in_use++;
+			if (track.stats.in_use > track.stats.high_water) {
+				track.stats.high_water = track.stats.in_use;
+			}
+		}
+	}
+
+	s->sid_id = sid_id;
+	s->token = token;
+	s->app = app;
+	s->order = track.order++;
+	track.stats.tracked++;
+	return evicted;
+}
+
+uint32_t msg_track_take(uint16_t sid_id, bool *app)
+{
+	struct track_slot *s = find(sid_id);
+
+	if (app) {
+		*app = s && s->app;
+	}
+	if (!s) {
+		track.stats.untracked++;
+		return 0;
+	}
+
+	uint32_t token = s->token;
+
+	s->token = 0;
+	track.stats.in_use--;
+	return token;
+}
+
+void msg_track_stats(struct msg_track_stats *stats)
+{
+	*stats = track.stats;
+}
@@ -0,0 +1,385 @@
+/*
+ * A/B App Slots — Boot Record
+ *
+ * Replays the append-only record page at OTA_BOOT_RECORD_ADDR into the
+ * active slot, its trial state and what each slot holds. Every change is
+ * one 16-byte program into erased flash, so flipping slots, counting a
+ * trial boot or confirming costs no erase, and power loss mid-append only
+ * leaves a torn record that the scan skips. The two record pages take
+ * turns: a full page is compacted into the other one, which becomes
+ * current only once its header is programmed.
+ */
+
+#include <ota_boot.h>
+#include <ota_flash.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <errno.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(ota_boot, CONFIG_SIDEWALK_LOG_LEVEL);
+
+_Static_assert(sizeof(struct ota_boot_rec) == 16, "boot record is one 16-byte program");
+_Static_assert(OTA_BOOT_RECORD_ADDR + OTA_BOOT_RECORD_PAGES * OTA_FLASH_PAGE_SIZE <=
+	       OTA_RX_STATE_ADDR,
+	       "boot record pages must sit below the receive checkpoints");
+_Static_assert(OTA_SLOT_A_ADDR + OTA_SLOT_SIZE <= OTA_BOOT_RECORD_ADDR,
+	       "slot A must end below the boot record pages");
+
+/* What the record says about a slot */
+enum slot_state {
+	SLOT_UNKNOWN = 0,    /* never recorded: only slot A's legacy image */
+	SLOT_IMAGE,          /* holds image[] */
+	SLOT_FAILED,         /* rolled back from, never booted again */
+};
+
+static struct {
+	uint8_t  active;
+	bool     trial;
+	uint8_t  tries;                          /* trial boots so far */
+	uint8_t  page;                           /* current record page */
+	uint16_t next;                           /* next free record slot, 0 = no page yet */
+	uint32_t gen;                            /* current page's generation */
+	uint8_t  state[OTA_SLOT_COUNT];
+	struct ota_boot_image image[OTA_SLOT_COUNT];
+	int8_t   valid[OTA_SLOT_COUNT];          /* CRC check result, -1 = not run */
+} boot;
+
+static uint16_t rec_check(const struct ota_boot_rec *rec)
+{
+	return (uint16_t)crc32_ieee_update(0, (const uint8_t *)rec,
+					   offsetof(struct ota_boot_rec, check));
+}
+
+static uint32_t rec_addr(uint8_t page, uint16_t slot)
+{
+	return OTA_BOOT_RECORD_ADDR + (uint32_t)page * OTA_FLASH_PAGE_SIZE +
+	       (uint32_t)slot * sizeof(struct ota_boot_rec);
+}
+
+/* Fold one record into the boot state */
+static void rec_replay(const struct ota_boot_rec *rec)
+{
+	uint8_t slot = rec->slot;
+
+	if (slot >= OTA_SLOT_COUNT) {
+		return;
+	}
+	switch (rec->kind) {
+	case OTA_BOOT_REC_ACTIVATE:
+		boot.active = slot;
+		boot.trial = true;
+		boot.tries = 0;
+		/* fall through */
+	case OTA_BOOT_REC_IMAGE:
+		boot.image[slot].size = rec->image_size;
+		boot.image[slot].crc32 = rec->image_crc32;
+		boot.image[slot].version = rec->app_version;
+		boot.state[slot] = rec->image_size ? SLOT_IMAGE : SLOT_UNKNOWN;
+		break;
+	case OTA_BOOT_REC_TRY:
+		if (boot.trial && slot == boot.active && boot.tries < UINT8_MAX) {
+			boot.tries++;
+		}
+		break;
+	case OTA_BOOT_REC_CONFIRM:
+		if (slot == boot.active) {
+			boot.trial = false;
+			boot.tries = 0;
+		}
+		break;
+	case OTA_BOOT_REC_REVERT:
+		boot.state[slot] = SLOT_FAILED;
+		boot.active = slot ^ 1;
+		boot.trial = false;
+		boot.tries = 0;
+		break;
+	default:
+		break;
+	}
+}
+
+static void rec_init(struct ota_boot_rec *rec, uint8_t kind, uint8_t slot,
+		     const struct ota_boot_image *img)
+{
+	memset(rec, 0, sizeof(*rec));
+	rec->kind = kind;
+	rec->slot = slot;
+	if (img) {
+		rec->image_size = img->size;
+		rec->image_crc32 = img->crc32;
+		rec->app_version = img->version;
+	}
+	rec->check = rec_check(rec);
+}
+
+static int rec_write(uint8_t kind, uint8_t slot, const struct ota_boot_image *img)
+{
+	struct ota_boot_rec rec;
+
+	rec_init(&rec, kind, slot, img);
+	return ota_flash_write(rec_addr(boot.page, boot.next++),
+			       (const uint8_t *)&rec, sizeof(rec));
+}
+
+/* Generation of a page whose header is intact */
+static bool page_gen(uint8_t page, uint32_t *gen)
+{
+	struct ota_boot_rec rec;
+
+	if (ota_flash_read(rec_addr(page, 0), (uint8_t *)&rec, sizeof(rec)) != 0 ||
+	    rec.kind != OTA_BOOT_REC_PAGE || rec.check != rec_check(&rec)) {
+		return false;
+	}
+	*gen = rec.image_size;
+	return true;
+}
+
+/* The current state as at most OTA_BOOT_TRIAL_BOOTS + 3 records */
+static int rec_snapshot(void)
+{
+	uint8_t other = boot.active ^ 1;
+	int err = 0;
+
+	if (boot.state[other] == SLOT_IMAGE) {
+		err = rec_write(OTA_BOOT_REC_IMAGE, other, &boot.image[other]);
+	}
+	if (!err && boot.state[other] == SLOT_FAILED) {
+		err = rec_write(OTA_BOOT_REC_REVERT, other, NULL);
+	}
+	if (!err) {
+		err = rec_write(OTA_BOOT_REC_ACTIVATE, boot.active,
+				boot.state[boot.active] == SLOT_IMAGE ?
+				&boot.image[boot.active] : NULL);
+	}
+	for (uint8_t i = 0; !err && boot.trial && i < boot.tries; i++) {
+		err = rec_write(OTA_BOOT_REC_TRY, boot.active, NULL);
+	}
+	if (!err && !boot.trial) {
+		err = rec_write(OTA_BOOT_REC_CONFIRM, boot.active, NULL);
+	}
+	return err;
+}
+
+/* Start the other page: the snapshot first, then the header one
+ * generation up. Until the header is in, the old page is still the
+ * newest, so power loss at any point boots the state from before. The
+ * first record of a device without any goes to a page of its own the
+ * same way, with nothing to snapshot. */
+static int rec_compact(void)
+{
+	uint8_t from = boot.page;
+	uint16_t next = boot.next;
+	uint8_t to = next ? (from + 1) % OTA_BOOT_RECORD_PAGES : 0;
+	uint32_t addr = rec_addr(to, 0);
+	struct ota_boot_rec rec;
+	int err = 0;
+
+	if (!ota_flash_is_erased(addr, OTA_FLASH_PAGE_SIZE)) {
+		err = ota_flash_erase_pages(addr, OTA_FLASH_PAGE_SIZE);
+	}
+	boot.page = to;
+	boot.next = 1;
+	if (!err && next) {
+		err = rec_snapshot();
+	}
+	if (!err) {
+		rec_init(&rec, OTA_BOOT_REC_PAGE, 0, NULL);
+		rec.image_size = boot.gen + 1;
+		rec.check = rec_check(&rec);
+		err = ota_flash_write(addr, (const uint8_t *)&rec, sizeof(rec));
+	}
+	if (err) {
+		boot.page = from;
+		boot.next = next;
+		return err;
+	}
+	boot.gen++;
+	return 0;
+}
+
+/* Append a record and replay it */
+static int rec_append(uint8_t kind, uint8_t slot, const struct ota_boot_image *img)
+{
+	struct ota_boot_rec rec;
+	int err = 0;
+
+	if (boot.next == 0 || boot.next >= OTA_BOOT_SLOTS) {
+		err = rec_compact();
+	}
+	if (!err) {
+		err = rec_write(kind, slot, img);
+	}
+	if (err) {
+		LOG_ERR("Boot record write failed: %d", err);
+		return err;
+	}
+	rec_init(&rec, kind, slot, img);
+	rec_replay(&rec);
+	return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                          */
+/* ------------------------------------------------------------------ */
+
+uint8_t ota_boot_init(void)
+{
+	memset(&boot, 0, sizeof(boot));
+	memset(boot.valid, -1, sizeof(boot.valid));
+	boot.active = OTA_SLOT_A;
+
+	/* The page with the newest intact header; neither is no records */
+	for (uint8_t page = 0; page < OTA_BOOT_RECORD_PAGES; page++) {
+		uint32_t gen;
+
+		if (page_gen(page, &gen) &&
+		    (!boot.next || (int32_t)(gen - boot.gen) > 0)) {
+			boot.page = page;
+			boot.gen = gen;
+			boot.next = 1;
+		}
+	}
+
+	for (; boot.next && boot.next < OTA_BOOT_SLOTS; boot.next++) {
+		struct ota_boot_rec rec;
+
+		if (ota_flash_read(rec_addr(boot.page, boot.next), (uint8_t *)&rec,
+				   sizeof(rec)) != 0) {
+			break;
+		}
+		if (rec.image_size == 0xFFFFFFFFu && rec.kind == 0xFF &&
+		    rec.check == 0xFFFF) {
+			break;                  /* erased: end of records */
+		}
+		if (rec.check != rec_check(&rec)) {
+			continue;               /* torn append */
+		}
+		rec_replay(&rec);
+	}
+
+	if (boot.trial) {
+		if (boot.tries < OTA_BOOT_TRIAL_BOOTS) {
+			rec_append(OTA_BOOT_REC_TRY, boot.active, NULL);
+			LOG_WRN("Boot: slot %c on trial (boot %u/%u)",
+				OTA_SLOT_NAME(boot.active), boot.tries, OTA_BOOT_TRIAL_BOOTS);
+		} else if (ota_boot_revert() == 0) {
+			LOG_ERR("Boot: slot %c unconfirmed after %u boots, rolled back",
+				OTA_SLOT_NAME(boot.active ^ 1), OTA_BOOT_TRIAL_BOOTS);
+		} else {
+			/* Nothing to go back to: keep the only image there is */
+			LOG_ERR("Boot: slot %c unconfirmed, no fallback, keeping it",
+				OTA_SLOT_NAME(boot.active));
+			ota_boot_confirm();
+		}
+	}
+
+	LOG_INF("Boot: slot %c at 0x%08x", OTA_SLOT_NAME(boot.active),
+		ota_boot_slot_addr(boot.active));
+	return boot.active;
+}
+
+uint8_t ota_boot_active_slot(void)
+{
+	return boot.active;
+}
+
+uint32_t ota_boot_slot_addr(uint8_t slot)
+{
+	return slot == OTA_SLOT_B ? OTA_SLOT_B_ADDR : OTA_SLOT_A_ADDR;
+}
+
+bool ota_boot_in_trial(void)
+{
+	return boot.trial;
+}
+
+bool ota_boot_slot_image(uint8_t slot, struct ota_boot_image *img)
+{
+	if (slot >= OTA_SLOT_COUNT || boot.state[slot] != SLOT_IMAGE) {
+		return false;
+	}
+	*img = boot.image[slot];
+	return true;
+}
+
+bool ota_boot_slot_valid(uint8_t slot)
+{
+	if (slot >= OTA_SLOT_COUNT) {
+		return false;
+	}
+	switch (boot.state[slot]) {
+	case SLOT_UNKNOWN:
+		/* The image flashed before A/B records existed; discovery
+		 * still checks its magic and version */
+		return slot == OTA_SLOT_A;
+	case SLOT_IMAGE:
+		if (boot.valid[slot] < 0) {
+			const struct ota_boot_image *img = &boot.image[slot];
+
+			boot.valid[slot] = img->size <= OTA_SLOT_SIZE &&
+				ota_flash_compute_crc32(ota_boot_slot_addr(slot),
+							img->size) == img->crc32;
+		}
+		return boot.valid[slot] > 0;
+	default:
+		return false;
+	}
+}
+
+int ota_boot_activate(uint8_t slot, const struct ota_boot_image *img)
+{
+	if (slot >= OTA_SLOT_COUNT) {
+		return -EINVAL;
+	}
+	boot.valid[slot] = -1;
+	int err = rec_append(OTA_BOOT_REC_ACTIVATE, slot, img);
+
+	if (!err) {
+		LOG_INF("Boot: slot %c activated (size=%u, crc=0x%08x, ver=%u)",
+			OTA_SLOT_NAME(slot), img->size, img->crc32, img->version);
+	}
+	return err;
+}
+
+int ota_boot_set_image(uint8_t slot, const struct ota_boot_image *img)
+{
+	if (slot >= OTA_SLOT_COUNT) {
+		return -EINVAL;
+	}
+	boot.valid[slot] = -1;
+	if (boot.next == 0) {
+		return 0;
+	}
+	return rec_append(OTA_BOOT_REC_IMAGE, slot, img);
+}
+
+void ota_boot_confirm(void)
+{
+	if (!boot.trial) {
+		return;
+	}
+	if (rec_append(OTA_BOOT_REC_CONFIRM, boot.active, NULL) == 0) {
+		LOG_INF("Boot: slot %c confirmed", OTA_SLOT_NAME(boot.active));
+	}
+}
+
+int ota_boot_revert(void)
+{
+	uint8_t failed = boot.active;
+
+	if (!ota_boot_slot_valid(failed ^ 1)) {
+		LOG_ERR("Boot: slot %c has no valid image to roll back to",
+			OTA_SLOT_NAME(failed ^ 1));
+		return -ENOENT;
+	}
+	int err = rec_append(OTA_BOOT_REC_REVERT, failed, NULL);
+
+	if (!err) {
+		LOG_WRN("Boot: slot %c abandoned, slot %c active",
+			OTA_SLOT_NAME(failed), OTA_SLOT_NAME(boot.active));
+	}
+	return err;
+}
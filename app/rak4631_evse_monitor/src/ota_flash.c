@@ -2,13 +2,19 @@
  * OTA Flash Abstraction — Low-level flash I/O for OTA updates
  *
  * Handles nRF52840 internal flash: init, erase, read, write (with
- * 4-byte alignment padding), and CRC32 computation over flash regions.
+ * 4-byte alignment padding), write combining, comparison, and CRC32
+ * computation over flash regions.
+ *
+ * The NVMC programs a 32-bit word at most twice between erases
+ * (nWRITE = 2). The write combiner keeps to that by programming each
+ * word once per run; see ota_flash.h.
  */
 
 #include <ota_flash.h>
 
 #include <errno.h>
 #include <zephyr/device.h>
+#include <zephyr/kernel.h>
 #include <zephyr/drivers/flash.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/crc.h>
@@ -60,7 +66,8 @@ int ota_flash_write(uint32_t addr, const uint8_t *data, size_t len)
 	}
 
 	/* nRF52840 NVMC requires 4-byte aligned address AND length.
-	 * Pad with 0xFF (erased flash value) on both sides. */
+	 * Pad with 0xFF (erased flash value) on both sides: programming
+	 * 0xFF leaves the neighbouring bytes of a word as they are. */
 	uint32_t aligned_addr = addr & ~3u;
 	uint32_t pre_pad = addr - aligned_addr;
 	size_t aligned_len = (pre_pad + len + 3u) & ~3u;
@@ -69,28 +76,170 @@ int ota_flash_write(uint32_t addr, const uint8_t *data, size_t len)
 		return flash_write(flash_dev, addr, data, len);
 	}
 
-	uint8_t buf[24]; /* max: 3 pre-pad + 15 data + 2 post-pad */
-	if (aligned_len > sizeof(buf)) {
-		if (pre_pad != 0) {
-			return -ENOMEM;
+	/* Short writes (one OTA chunk): a single padded program */
+	uint8_t buf[24];
+	if (aligned_len <= sizeof(buf)) {
+		memset(buf, 0xFF, aligned_len);
+		memcpy(buf + pre_pad, data, len);
+		return flash_write(flash_dev, aligned_addr, buf, aligned_len);
+	}
+
+	/* Longer: padded head word, aligned body, padded tail word */
+	if (pre_pad) {
+		size_t n = 4 - pre_pad;
+
+		memset(buf, 0xFF, 4);
+		memcpy(buf + pre_pad, data, n);
+		err = flash_write(flash_dev, aligned_addr, buf, 4);
+		addr += n;
+		data += n;
+		len -= n;
+	}
+	size_t body = len & ~3u;
+	if (!err && body) {
+		err = flash_write(flash_dev, addr, data, body);
+	}
+	if (!err && body < len) {
+		memset(buf, 0xFF, 4);
+		memcpy(buf, data + body, len - body);
+		err = flash_write(flash_dev, addr + body, buf, 4);
+	}
+	return err;
+}
+
+void ota_flash_writer_init(struct ota_flash_writer *w)
+{
+	w->len = 0;
+}
+
+/* Program the whole (word-aligned) buffer and start an empty run after it */
+static int writer_program_run(struct ota_flash_writer *w)
+{
+	int err = ota_flash_write(w->addr, w->buf, OTA_FLASH_RUN_SIZE);
+
+	w->addr += OTA_FLASH_RUN_SIZE;
+	w->len = 0;
+	return err;
+}
+
+int ota_flash_writer_put(struct ota_flash_writer *w, uint32_t addr,
+			 const uint8_t *data, size_t len)
+{
+	int err;
+
+	/* Not contiguous: finish the current run and start a new one */
+	if (w->len && addr != w->addr + w->len) {
+		err = ota_flash_writer_finish(w);
+		if (err) {
+			return err;
+		}
+	}
+	if (w->len == 0) {
+		uint32_t head = addr & 3u;
+
+		w->addr = addr - head;
+		memset(w->buf, 0xFF, head);
+		w->len = head;
+	}
+
+	while (len) {
+		size_t n = MIN(len, (size_t)(OTA_FLASH_RUN_SIZE - w->len));
+
+		memcpy(&w->buf[w->len], data, n);
+		w->len += n;
+		data += n;
+		len -= n;
+		if (w->len == OTA_FLASH_RUN_SIZE) {
+			err = writer_program_run(w);
+			if (err) {
+				return err;
+			}
+		}
+	}
+	return 0;
+}
+
+int ota_flash_writer_flush(struct ota_flash_writer *w)
+{
+	uint16_t keep = w->len & 3u;
+	uint16_t whole = w->len - keep;
+
+	if (whole == 0) {
+		return 0;
+	}
+
+	/* The partial last word stays in RAM until the bytes that complete
+	 * it arrive, so the run programs each of its words once */
+	int err = ota_flash_write(w->addr, w->buf, whole);
+	if (err) {
+		return err;
+	}
+	memmove(w->buf, &w->buf[whole], keep);
+	w->addr += whole;
+	w->len = keep;
+	return 0;
+}
+
+int ota_flash_writer_finish(struct ota_flash_writer *w)
+{
+	if (w->len == 0) {
+		return 0;
+	}
+
+	/* Pad the last word, so the rest of the run is one aligned program;
+	 * the run ends here */
+	uint16_t padded = (w->len + 3u) & ~3u;
+
+	memset(&w->buf[w->len], 0xFF, padded - w->len);
+	int err = ota_flash_write(w->addr, w->buf, padded);
+
+	w->len = 0;
+	return err;
+}
+
+size_t ota_flash_writer_held(const struct ota_flash_writer *w, uint32_t *addr)
+{
+	*addr = w->addr;
+	return w->len;
+}
+
+bool ota_flash_equals(uint32_t addr, const uint8_t *data, size_t len)
+{
+	uint8_t buf[256];
+
+	for (size_t off = 0; off < len; off += sizeof(buf)) {
+		size_t n = MIN(len - off, sizeof(buf));
+
+		if (ota_flash_read(addr + off, buf, n) != 0 ||
+		    memcmp(buf, data + off, n) != 0) {
+			return false;
 		}
-		/* Large aligned-address write: split into aligned body + padded tail */
-		size_t body = len & ~3u;
-		int ret = 0;
-		if (body > 0) {
-			ret = flash_write(flash_dev, addr, data, body);
+	}
+	return true;
+}
+
+bool ota_flash_is_erased(uint32_t addr, size_t len)
+{
+	uint32_t buf[64];
+
+	for (size_t off = 0; off < len; off += sizeof(buf)) {
+		size_t n = MIN(len - off, sizeof(buf));
+
+		if (ota_flash_read(addr + off, (uint8_t *)buf, n) != 0) {
+			return false;
+		}
+		for (size_t i = 0; i < n / 4; i++) {
+			if (buf[i] != 0xFFFFFFFFu) {
+				return false;
+			}
 		}
-		if (ret == 0 && body < aligned_len) {
-			uint8_t tail[4];
-			memset(tail, 0xFF, 4);
-			memcpy(tail, data + body, len - body);
-			ret = flash_write(flash_dev, addr + body, tail, 4);
+		for (size_t i = n & ~3u; i < n; i++) {
+			if (((uint8_t *)buf)[i] != 0xFF) {
+				return false;
+			}
 		}
-		return ret;
 	}
-	memset(buf, 0xFF, aligned_len);
-	memcpy(buf + pre_pad, data, len);
-	return flash_write(flash_dev, aligned_addr, buf, aligned_len);
+	return true;
 }
 
 int ota_flash_read(uint32_t addr, uint8_t *buf, size_t len)
@@ -124,3 +273,83 @@ uint32_t ota_flash_compute_crc32(uint32_t addr, size_t size)
 
 	return crc;
 }
+
+/* GF(2) 32x32 matrix helpers for ota_crc32_combine() */
+static uint32_t gf2_times(const uint32_t *mat, uint32_t vec)
+{
+	uint32_t sum = 0;
+
+	for (; vec; vec >>= 1, mat++) {
+		if (vec & 1) {
+			sum ^= *mat;
+		}
+	}
+	return sum;
+}
+
+static void gf2_square(uint32_t *square, const uint32_t *mat)
+{
+	for (int n = 0; n < 32; n++) {
+		square[n] = gf2_times(mat, mat[n]);
+	}
+}
+
+/* Operator that appends combine_len zero bytes to a CRC, kept because
+ * callers combine runs of equal-length pages */
+static size_t combine_len;
+static uint32_t combine_op[32];
+
+static void build_combine_op(size_t len2)
+{
+	uint32_t even[32];
+	uint32_t odd[32];
+	uint32_t tmp[32];
+
+	for (int n = 0; n < 32; n++) {
+		combine_op[n] = 1u << n;
+	}
+
+	/* Operator for one zero bit, then two, then four */
+	odd[0] = 0xEDB88320;
+	for (int n = 1; n < 32; n++) {
+		odd[n] = 1u << (n - 1);
+	}
+	gf2_square(even, odd);
+	gf2_square(odd, even);
+
+	/* Square up through the bits of len2, folding each set bit's
+	 * operator into the product */
+	do {
+		gf2_square(even, odd);
+		if (len2 & 1) {
+			for (int n = 0; n < 32; n++) {
+				tmp[n] = gf2_times(even, combine_op[n]);
+			}
+			memcpy(combine_op, tmp, sizeof(tmp));
+		}
+		len2 >>= 1;
+		if (len2 == 0) {
+			break;
+		}
+		gf2_square(odd, even);
+		if (len2 & 1) {
+			for (int n = 0; n < 32; n++) {
+				tmp[n] = gf2_times(odd, combine_op[n]);
+			}
+			memcpy(combine_op, tmp, sizeof(tmp));
+		}
+		len2 >>= 1;
+	} while (len2);
+}
+
+uint32_t ota_crc32_combine(uint32_t crc1, uint32_t crc2, size_t len2)
+{
+	if (len2 == 0) {
+		return crc1;
+	}
+	if (len2 != combine_len) {
+		build_combine_op(len2);
+		combine_len = len2;
+	}
+	return gf2_times(combine_op, crc1) ^ crc2;
+}
@@ -0,0 +1,116 @@
+/*
+ * OTA LZ — streaming decompressor for compressed OTA chunk streams
+ *
+ * Input bits are shifted into a small accumulator one byte at a time and
+ * decoded as soon as a whole literal (9 bits) or back-reference (17 bits)
+ * is available, so chunk boundaries can fall anywhere in the bitstream.
+ */
+
+#include <ota_lz.h>
+
+#include <errno.h>
+
+#define WINDOW_MASK     (OTA_LZ_WINDOW_SIZE - 1)
+#define LITERAL_BITS    9
+#define BACKREF_BITS    (1 + OTA_LZ_WINDOW_BITS + OTA_LZ_LOOKAHEAD_BITS)
+
+void ota_lz_init(struct ota_lz *z, uint8_t *window, uint32_t out_size,
+		 ota_image_sink_t sink, void *sink_ctx)
+{
+	z->window = window;
+	z->sink = sink;
+	z->sink_ctx = sink_ctx;
+	z->out_size = out_size;
+	z->out_len = 0;
+	z->bits = 0;
+	z->bit_count = 0;
+	z->failed = false;
+}
+
+/* Append one byte to the history; hand each completed block to the sink */
+static int emit(struct ota_lz *z, uint8_t b)
+{
+	z->window[z->out_len & WINDOW_MASK] = b;
+	z->out_len++;
+	if (z->out_len % OTA_LZ_SINK_BLOCK == 0) {
+		uint32_t start = (z->out_len - OTA_LZ_SINK_BLOCK) & WINDOW_MASK;
+		return z->sink(z->sink_ctx, &z->window[start], OTA_LZ_SINK_BLOCK);
+	}
+	return 0;
+}
+
+static uint32_t take_bits(struct ota_lz *z, uint8_t n)
+{
+	z->bit_count -= n;
+	return (z->bits >> z->bit_count) & ((1u << n) - 1);
+}
+
+/* Decode every complete token in the accumulator */
+static int decode(struct ota_lz *z)
+{
+	int err = 0;
+
+	while (!err && z->out_len < z->out_size && z->bit_count > 0) {
+		bool literal = (z->bits >> (z->bit_count - 1)) & 1;
+
+		if (literal) {
+			if (z->bit_count < LITERAL_BITS) {
+				break;
+			}
+			err = emit(z, (uint8_t)take_bits(z, LITERAL_BITS));
+			continue;
+		}
+
+		if (z->bit_count < BACKREF_BITS) {
+			break;
+		}
+		take_bits(z, 1);
+		uint32_t dist = take_bits(z, OTA_LZ_WINDOW_BITS) + 1;
+		uint32_t count = take_bits(z, OTA_LZ_LOOKAHEAD_BITS) + 1;
+
+		if (dist > z->out_len || count > z->out_size - z->out_len) {
+			return -EBADMSG;
+		}
+		while (!err && count--) {
+			err = emit(z, z->window[(z->out_len - dist) & WINDOW_MASK]);
+		}
+	}
+
+	z->bits &= (1u << z->bit_count) - 1;
+	return err;
+}
+
+int ota_lz_feed(struct ota_lz *z, const uint8_t *data, size_t len)
+{
+	int err = z->failed ? -EBADMSG : 0;
+
+	for (size_t i = 0; !err && i < len; i++) {
+		if (z->out_len == z->out_size) {
+			err = -EBADMSG;     /* input past the end of the image */
+			break;
+		}
+		z->bits = (z->bits << 8) | data[i];
+		z->bit_count += 8;
+		err = decode(z);
+	}
+
+	if (err) {
+		z->failed = true;
+	}
+	return err;
+}
+
+int ota_lz_finish(struct ota_lz *z)
+{
+	if (z->failed || z->out_len != z->out_size) {
+		z->failed = true;
+		return -EBADMSG;
+	}
+
+	uint32_t tail = z->out_len % OTA_LZ_SINK_BLOCK;
+	if (tail == 0) {
+		return 0;
+	}
+	uint32_t start = (z->out_len - tail) & WINDOW_MASK;
+	return z->sink(z->sink_ctx, &z->window[start], tail);
+}
@@ -0,0 +1,297 @@
+/*
+ * OTA Patch — streaming binary-diff patcher
+ *
+ * A byte-driven state machine over the patch stream (see ota_patch.h).
+ * Output goes through a 256-byte window that is written to flash each time
+ * it fills, so staging is programmed strictly in order with 4-byte aligned
+ * writes; old-image bytes are read from flash straight into that window.
+ */
+
+#include <ota_patch.h>
+#include <ota_flash.h>
+
+#include <zephyr/kernel.h>
+#include <errno.h>
+#include <string.h>
+
+enum patch_state {
+	ST_HEADER = 0,
+	ST_SEEK,
+	ST_DIFF_LEN,
+	ST_EXTRA_LEN,
+	ST_ZEROS,
+	ST_LIT_LEN,
+	ST_LITS,
+	ST_EXTRA,
+	ST_FAILED,
+};
+
+void ota_patch_init(struct ota_patch *p, uint32_t old_addr, uint32_t out_addr,
+		    uint32_t new_size)
+{
+	memset(p, 0, sizeof(*p));
+	p->state = ST_HEADER;
+	p->old_addr = old_addr;
+	p->out_addr = out_addr;
+	p->new_size = new_size;
+}
+
+void ota_patch_set_sink(struct ota_patch *p, ota_image_sink_t sink, void *ctx)
+{
+	p->sink = sink;
+	p->sink_ctx = ctx;
+}
+
+bool ota_patch_done(const struct ota_patch *p)
+{
+	return p->state == ST_SEEK && p->out_len == p->new_size;
+}
+
+static int flush_window(struct ota_patch *p)
+{
+	if (p->win_len == 0) {
+		return 0;
+	}
+	int err = p->sink
+		? p->sink(p->sink_ctx, p->win, p->win_len)
+		: ota_flash_write(p->out_addr + p->out_len - p->win_len,
+				  p->win, p->win_len);
+	p->win_len = 0;
+	return err;
+}
+
+/* Free space in the output window, flushing it first if it is full */
+static int window_room(struct ota_patch *p, uint32_t *room)
+{
+	if (p->win_len == OTA_PATCH_WINDOW) {
+		int err = flush_window(p);
+		if (err) {
+			return err;
+		}
+	}
+	*room = OTA_PATCH_WINDOW - p->win_len;
+	return 0;
+}
+
+/* Append n old-image bytes at the cursor to the window */
+static int read_old(struct ota_patch *p, uint32_t n)
+{
+	int err = ota_flash_read(p->old_addr + p->old_pos, &p->win[p->win_len], n);
+	if (err) {
+		return err;
+	}
+	p->old_pos += n;
+	p->diff_left -= n;
+	p->win_len += n;
+	p->out_len += n;
+	return 0;
+}
+
+/* Accumulate one varint byte: 1 when the value is complete, 0 for more */
+static int varint_step(struct ota_patch *p, uint8_t b, uint32_t *value)
+{
+	if (p->varint_shift > 28 || (p->varint_shift == 28 && (b & 0x70))) {
+		return -EBADMSG;
+	}
+	p->varint |= (uint32_t)(b & 0x7F) << p->varint_shift;
+	p->varint_shift += 7;
+	if (b & 0x80) {
+		return 0;
+	}
+	*value = p->varint;
+	p->varint = 0;
+	p->varint_shift = 0;
+	return 1;
+}
+
+static void next_part(struct ota_patch *p)
+{
+	if (p->diff_left) {
+		p->state = ST_ZEROS;
+	} else if (p->extra_left) {
+		p->state = ST_EXTRA;
+	} else {
+		p->state = ST_SEEK;
+	}
+}
+
+static int parse_header(struct ota_patch *p)
+{
+	const uint8_t *h = p->hdr;
+	uint32_t magic   = h[0] | (h[1] << 8) | (h[2] << 16) | ((uint32_t)h[3] << 24);
+	uint32_t size    = h[4] | (h[5] << 8) | (h[6] << 16) | ((uint32_t)h[7] << 24);
+	uint32_t crc32   = h[8] | (h[9] << 8) | (h[10] << 16) | ((uint32_t)h[11] << 24);
+
+	if (magic != OTA_PATCH_MAGIC) {
+		return -EBADMSG;
+	}
+	if (ota_flash_compute_crc32(p->old_addr, size) != crc32) {
+		return -EINVAL;
+	}
+	p->old_size = size;
+	p->state = ST_SEEK;
+	return 0;
+}
+
+/* Control fields are in: check the record stays inside both images */
+static int start_record(struct ota_patch *p)
+{
+	if ((uint64_t)p->old_pos + p->diff_left > p->old_size ||
+	    (uint64_t)p->out_len + p->diff_left + p->extra_left > p->new_size) {
+		return -EBADMSG;
+	}
+	next_part(p);
+	return 0;
+}
+
+int ota_patch_feed(struct ota_patch *p, const uint8_t *data, size_t len)
+{
+	size_t i = 0;
+	int err = 0;
+
+	while (!err && i < len) {
+		uint32_t v = 0;
+		uint32_t room;
+		int got;
+
+		switch (p->state) {
+		case ST_HEADER:
+			p->hdr[p->hdr_len++] = data[i++];
+			if (p->hdr_len == OTA_PATCH_HDR_SIZE) {
+				err = parse_header(p);
+			}
+			break;
+
+		case ST_SEEK:
+			if (p->out_len == p->new_size) {
+				err = -EBADMSG;     /* trailing bytes */
+				break;
+			}
+			got = varint_step(p, data[i++], &v);
+			if (got > 0) {
+				/* zigzag: 0, -1, 1, -2, ... */
+				int64_t pos = (int64_t)p->old_pos +
+					      (int32_t)((v >> 1) ^ (0u - (v & 1)));
+				if (pos < 0 || pos > p->old_size) {
+					err = -EBADMSG;
+					break;
+				}
+				p->old_pos = (uint32_t)pos;
+				p->state = ST_DIFF_LEN;
+			}
+			err = (got < 0) ? got : err;
+			break;
+
+		case ST_DIFF_LEN:
+			got = varint_step(p, data[i++], &v);
+			if (got > 0) {
+				p->diff_left = v;
+				p->state = ST_EXTRA_LEN;
+			}
+			err = (got < 0) ? got : 0;
+			break;
+
+		case ST_EXTRA_LEN:
+			got = varint_step(p, data[i++], &v);
+			if (got > 0) {
+				p->extra_left = v;
+				err = start_record(p);
+			}
+			err = (got < 0) ? got : err;
+			break;
+
+		case ST_ZEROS:
+			got = varint_step(p, data[i++], &v);
+			if (got < 0 || (got > 0 && v > p->diff_left)) {
+				err = -EBADMSG;
+				break;
+			}
+			if (got == 0) {
+				break;
+			}
+			/* Zero delta: copy old bytes, no patch input needed */
+			while (!err && v > 0) {
+				err = window_room(p, &room);
+				if (!err) {
+					uint32_t n = MIN(v, room);
+					err = read_old(p, n);
+					v -= n;
+				}
+			}
+			p->state = ST_LIT_LEN;
+			break;
+
+		case ST_LIT_LEN:
+			got = varint_step(p, data[i++], &v);
+			if (got < 0 || (got > 0 && v > p->diff_left)) {
+				err = -EBADMSG;
+				break;
+			}
+			if (got > 0) {
+				p->run_left = v;
+				if (v > 0) {
+					p->state = ST_LITS;
+				} else {
+					next_part(p);
+				}
+			}
+			break;
+
+		case ST_LITS: {
+			err = window_room(p, &room);
+			if (err) {
+				break;
+			}
+			uint32_t n = MIN(MIN(p->run_left, room), (uint32_t)(len - i));
+			uint8_t *out = &p->win[p->win_len];
+
+			err = read_old(p, n);
+			for (uint32_t k = 0; !err && k < n; k++) {
+				out[k] += data[i + k];
+			}
+			i += n;
+			p->run_left -= n;
+			if (p->run_left == 0) {
+				next_part(p);
+			}
+			break;
+		}
+
+		case ST_EXTRA: {
+			err = window_room(p, &room);
+			if (err) {
+				break;
+			}
+			uint32_t n = MIN(MIN(p->extra_left, room), (uint32_t)(len - i));
+
+			memcpy(&p->win[p->win_len], &data[i], n);
+			p->win_len += n;
+			p->out_len += n;
+			p->extra_left -= n;
+			i += n;
+			if (p->extra_left == 0) {
+				next_part(p);
+			}
+			break;
+		}
+
+		default:
+			err = -EBADMSG;
+			break;
+		}
+	}
+
+	if (err) {
+		p->state = ST_FAILED;
+	}
+	return err;
+}
+
+int ota_patch_finish(struct ota_patch *p)
+{
+	if (!ota_patch_done(p)) {
+		p->state = ST_FAILED;
+		return -EBADMSG;
+	}
+	return flush_window(p);
+}
@@ -2,6 +2,8 @@
  * OTA Firmware Signing — ED25519 signature verification via PSA Crypto.
  *
  * Uses the PSA Crypto API (PSA_ALG_PURE_EDDSA) provided by NCS nrf_security.
+ * The signed message is the 32-byte SHA-256 digest of the image, hashed
+ * incrementally (PSA_ALG_SHA_256, CC310-accelerated).
  * The nRF52840's CC310 does not support Ed25519, so verification runs via
  * the Oberon software backend (CONFIG_PSA_WANT_ALG_PURE_EDDSA=y).
  *
@@ -31,11 +33,46 @@ static const uint8_t ota_public_key[32] = {
 	0xa0, 0xc4, 0xa3, 0xfa, 0xf2, 0xe0, 0xad, 0xb2,
 };
 
-int ota_verify_signature(const uint8_t *data, size_t len, const uint8_t *sig)
+static psa_hash_operation_t hash_op;
+
+int ota_verify_begin(void)
+{
+	psa_hash_abort(&hash_op);
+	hash_op = psa_hash_operation_init();
+
+	psa_status_t status = psa_hash_setup(&hash_op, PSA_ALG_SHA_256);
+	if (status != PSA_SUCCESS) {
+		LOG_ERR("OTA sign: hash setup failed (PSA %d)", (int)status);
+		return -1;
+	}
+	return 0;
+}
+
+int ota_verify_update(const uint8_t *data, size_t len)
+{
+	psa_status_t status = psa_hash_update(&hash_op, data, len);
+	if (status != PSA_SUCCESS) {
+		LOG_ERR("OTA sign: hash update failed (PSA %d)", (int)status);
+		psa_hash_abort(&hash_op);
+		return -1;
+	}
+	return 0;
+}
+
+int ota_verify_finish(const uint8_t *sig)
 {
 	psa_status_t status;
 	psa_key_id_t key_id = 0;
 	psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+	uint8_t digest[OTA_DIGEST_SIZE];
+	size_t digest_len;
+
+	status = psa_hash_finish(&hash_op, digest, sizeof(digest), &digest_len);
+	if (status != PSA_SUCCESS) {
+		LOG_ERR("OTA sign: hash finish failed (PSA %d)", (int)status);
+		psa_hash_abort(&hash_op);
+		return -1;
+	}
 
 	/* Configure key attributes for Ed25519 public key, verify-only */
 	psa_set_key_type(&attr,
@@ -52,9 +89,9 @@ int ota_verify_signature(const uint8_t *data, size_t len, const uint8_t *sig)
 		return -1;
 	}
 
-	/* Verify ED25519 signature over the firmware data */
+	/* Verify ED25519 signature over the firmware digest */
 	status = psa_verify_message(key_id, PSA_ALG_PURE_EDDSA,
-				    data, len, sig, OTA_SIG_SIZE);
+				    digest, digest_len, sig, OTA_SIG_SIZE);
 
 	psa_destroy_key(key_id);
 
@@ -66,3 +103,12 @@ int ota_verify_signature(const uint8_t *data, size_t len, const uint8_t *sig)
 	LOG_INF("OTA sign: ED25519 signature verified OK");
 	return 0;
 }
+
+int ota_verify_signature(const uint8_t *data, size_t len, const uint8_t *sig)
+{
+	int err = ota_verify_begin();
+	if (!err) {
+		err = ota_verify_update(data, len);
+	}
+	return err ? err : ota_verify_finish(sig);
+}
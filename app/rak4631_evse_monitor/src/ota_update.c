@@ -6,12 +6,17 @@
  * Receives firmware chunks via Sidewalk downlinks, writes them to a
  * staging area in flash, validates the full CRC32, then copies to the
  * app primary partition. Recovery metadata survives power loss during
- * the apply phase.
+ * the apply phase. An image built for the inactive A/B slot is received
+ * straight into that slot instead and activated without a copy.
  */
 
 #include <ota_update.h>
+#include <ota_boot.h>
 #include <ota_flash.h>
 #include <ota_signing.h>
+#include <ota_patch.h>
+#include <ota_lz.h>
+#include <event_log.h>
 #include <platform_api.h>
 
 #include <zephyr/kernel.h>
@@ -19,6 +24,7 @@
 #include <zephyr/logging/log_ctrl.h>
 #include <zephyr/sys/crc.h>
 #include <zephyr/sys/reboot.h>
+#include <errno.h>
 #include <string.h>
 
 LOG_MODULE_REGISTER(ota_update, CONFIG_SIDEWALK_LOG_LEVEL);
@@ -35,6 +41,13 @@ static K_WORK_DELAYABLE_DEFINE(ota_deferred_apply_work, ota_deferred_apply_handl
 /*  Internal state                                                      */
 /* ------------------------------------------------------------------ */
 
+/* Delta received-chunk set: a two-level bitmap. One bit per chunk in
+ * 32-bit words covers the whole staging area (O(1) lookup); one summary
+ * bit per word says the word is non-zero, so walking the received chunks
+ * of a range skips empty stretches 1024 chunks at a time. */
+#define DELTA_WORDS         ((OTA_DELTA_MAX_CHUNKS + 31) / 32)
+#define DELTA_SUMMARY_WORDS ((DELTA_WORDS + 31) / 32)
+
 static struct {
 	enum ota_phase phase;
 	uint32_t total_size;
@@ -48,10 +61,89 @@ static struct {
 	bool     is_signed;
 	/* Delta mode: total_chunks < full image chunks */
 	bool     delta_mode;
-	uint16_t full_image_chunks;    /* chunks in the full image */
-	uint8_t  delta_received[128];  /* bitfield: up to 1024 chunks (~15KB) */
+	uint32_t full_image_chunks;    /* chunks in the full image */
+	uint32_t delta_received[DELTA_WORDS];
+	uint32_t delta_summary[DELTA_SUMMARY_WORDS];
+	uint32_t delta_dirty[DELTA_SUMMARY_WORDS];   /* words not yet checkpointed */
+	/* Delta bitmap ACKs: one per ack_every new chunks (0 = ACK each);
+	 * ack_lo is the lowest chunk received since the last one */
+	uint8_t  ack_every;
+	uint8_t  ack_pending;
+	uint16_t ack_lo;
+	/* Patch mode: chunks are a binary patch against primary */
+	bool     patch_mode;
+	/* Compressed mode: chunks are the LZ-compressed full image */
+	bool     compressed;
+	/* In-order modes: image bytes staged so far and their running CRC32;
+	 * while rx_hashing they are also fed to the signature hash */
+	uint32_t staged_len;
+	uint32_t rx_crc32;
+	bool     rx_hashing;
+	/* Resumed session: chunks already in staging are compared, not
+	 * programmed again */
+	bool     rx_verify;
+	/* Where the image is received: staging, or the inactive A/B slot
+	 * (slot_direct), which is then activated in place */
+	uint32_t rx_addr;
+	bool     slot_direct;
+	uint8_t  slot;
+	/* Delta and patch baseline: the running slot */
+	uint32_t base_addr;
 } ota_state;
 
+static inline bool delta_chunk_received(uint16_t idx)
+{
+	return (ota_state.delta_received[idx / 32] >> (idx % 32)) & 1u;
+}
+
+static void delta_mark_received(uint16_t idx)
+{
+	ota_state.delta_received[idx / 32] |= 1u << (idx % 32);
+	ota_state.delta_summary[idx / 1024] |= 1u << ((idx / 32) % 32);
+	ota_state.delta_dirty[idx / 1024] |= 1u << ((idx / 32) % 32);
+}
+
+/* First received chunk in [first, last], or last + 1 if there is none */
+static uint32_t delta_next_received(uint32_t first, uint32_t last)
+{
+	if (first > last) {
+		return last + 1;
+	}
+
+	uint32_t w = first / 32;
+	uint32_t bits = ota_state.delta_received[w] & (~0u << (first % 32));
+
+	while (!bits) {
+		/* Next non-empty word, from the summary */
+		if (++w * 32 > last) {
+			return last + 1;
+		}
+		uint32_t s = w / 32;
+		uint32_t sbits = ota_state.delta_summary[s] & (~0u << (w % 32));
+
+		while (!sbits) {
+			if (++s * 1024 > last) {
+				return last + 1;
+			}
+			sbits = ota_state.delta_summary[s];
+		}
+		w = s * 32 + __builtin_ctz(sbits);
+		bits = ota_state.delta_received[w];
+	}
+
+	uint32_t idx = w * 32 + __builtin_ctz(bits);
+	return MIN(idx, last + 1);
+}
+
+/* Stream decoders for patch and compressed modes; each rebuilds the image
+ * into staging as chunks arrive */
+static struct ota_patch ota_patch;
+static struct ota_lz ota_lz;
+static struct ota_flash_writer ota_stage_writer;   /* chunks → staging */
+
+#define OTA_STREAM_NAME     (ota_state.patch_mode ? "PATCH" : "LZ")
+#define OTA_STREAM_OUT_LEN  (ota_state.patch_mode ? ota_patch.out_len : ota_lz.out_len)
+
 static int (*ota_send_msg)(const uint8_t *data, size_t len);
 static void (*ota_pre_apply_hook)(void);
 
@@ -65,7 +157,7 @@ static void send_ack(uint8_t status, uint16_t next_chunk, uint16_t chunks_receiv
 		return;
 	}
 
-	uint8_t buf[7];
+	uint8_t buf[OTA_ACK_LEN];
 	buf[0] = OTA_CMD_TYPE;
 	buf[1] = OTA_SUB_ACK;
 	buf[2] = status;
@@ -77,6 +169,39 @@ static void send_ack(uint8_t status, uint16_t next_chunk, uint16_t chunks_receiv
 	ota_send_msg(buf, sizeof(buf));
 }
 
+/* Delta ACK carrying the receive bitfield from the 32-chunk word holding
+ * chunk lo, so the sender can tell which chunks in flight were lost */
+static void send_ack_bitmap(uint16_t lo)
+{
+	if (!ota_send_msg) {
+		return;
+	}
+
+	uint16_t base = lo & ~31u;
+	uint8_t buf[OTA_ACK_BITMAP_LEN];
+	buf[0] = OTA_CMD_TYPE;
+	buf[1] = OTA_SUB_ACK;
+	buf[2] = OTA_STATUS_OK;
+	buf[3] = (uint8_t)(ota_state.chunks_received & 0xFF);
+	buf[4] = (uint8_t)(ota_state.chunks_received >> 8);
+	buf[5] = (uint8_t)(ota_state.chunks_received & 0xFF);
+	buf[6] = (uint8_t)(ota_state.chunks_received >> 8);
+	buf[7] = (uint8_t)(base & 0xFF);
+	buf[8] = (uint8_t)(base >> 8);
+	for (uint32_t i = 0; i < OTA_ACK_BITMAP_BITS / 32; i++) {
+		uint32_t w = base / 32 + i;
+		uint32_t bits = w < DELTA_WORDS ? ota_state.delta_received[w] : 0;
+
+		buf[9 + i * 4] = (uint8_t)(bits & 0xFF);
+		buf[10 + i * 4] = (uint8_t)((bits >> 8) & 0xFF);
+		buf[11 + i * 4] = (uint8_t)((bits >> 16) & 0xFF);
+		buf[12 + i * 4] = (uint8_t)(bits >> 24);
+	}
+
+	ota_state.ack_pending = 0;
+	ota_send_msg(buf, sizeof(buf));
+}
+
 static void send_complete(uint8_t result, uint32_t crc32_calc)
 {
 	if (!ota_send_msg) {
@@ -99,6 +224,19 @@ static void send_complete(uint8_t result, uint32_t crc32_calc)
 /*  Recovery metadata                                                   */
 /* ------------------------------------------------------------------ */
 
+_Static_assert(sizeof(struct ota_metadata) <= OTA_STAGING_ADDR - OTA_METADATA_ADDR,
+	       "metadata must fit below staging");
+_Static_assert(OTA_JOURNAL_SLOTS > 2 * OTA_META_MAX_PAGES,
+	       "journal must hold an apply even with a torn slot per page");
+
+/* Journal of the current record, as replayed by journal_scan() or built
+ * by the apply in progress */
+static uint32_t ota_page_crc[OTA_META_MAX_PAGES];
+static uint32_t ota_journal_first;   /* record's pages_copied */
+static uint32_t ota_journal_next;    /* next page to copy */
+static uint16_t ota_journal_slot;    /* next free slot */
+static bool ota_journal_done;
+
 static int write_metadata(uint8_t state, uint32_t image_size, uint32_t image_crc32,
 			  uint32_t app_version, uint32_t pages_copied, uint32_t total_pages)
 {
@@ -112,6 +250,7 @@ static int write_metadata(uint8_t state, uint32_t image_size, uint32_t image_crc
 		.total_pages = total_pages,
 	};
 
+	/* One erase clears the journal too */
 	int err = ota_flash_erase_pages(OTA_METADATA_ADDR, sizeof(meta));
 	if (err) {
 		LOG_ERR("OTA: metadata erase failed: %d", err);
@@ -137,9 +276,158 @@ static int read_metadata(struct ota_metadata *meta)
 	return 0;
 }
 
+/* Erase the journal/metadata page only: a page's length from
+ * OTA_METADATA_ADDR would run into slot B */
 static int clear_metadata(void)
 {
-	return ota_flash_erase_pages(OTA_METADATA_ADDR, OTA_FLASH_PAGE_SIZE);
+	return ota_flash_erase_pages(OTA_METADATA_ADDR, sizeof(struct ota_metadata));
+}
+
+/* ------------------------------------------------------------------ */
+/*  Apply journal — append-only progress below the metadata            */
+/* ------------------------------------------------------------------ */
+
+static uint16_t journal_check(const struct ota_journal_rec *rec)
+{
+	return (uint16_t)crc32_ieee_update(0, (const uint8_t *)rec,
+					   offsetof(struct ota_journal_rec, check));
+}
+
+static uint32_t journal_slot_addr(uint16_t slot)
+{
+	return OTA_JOURNAL_ADDR + (uint32_t)slot * sizeof(struct ota_journal_rec);
+}
+
+/* Start an apply: erase the metadata page, write the record, empty journal */
+static int journal_begin(uint32_t image_size, uint32_t image_crc32,
+			 uint32_t app_version, uint32_t total_pages)
+{
+	ota_journal_first = 0;
+	ota_journal_next = 0;
+	ota_journal_slot = 0;
+	ota_journal_done = false;
+	return write_metadata(OTA_META_STATE_APPLYING, image_size, image_crc32,
+			      app_version, 0, total_pages);
+}
+
+/* Replay the journal that follows a record: page progress, page CRCs,
+ * DONE, and the slot the next record goes in */
+static void journal_scan(const struct ota_metadata *meta)
+{
+	ota_journal_first = meta->pages_copied;
+	ota_journal_next = meta->pages_copied;
+	ota_journal_done = false;
+
+	for (ota_journal_slot = 0; ota_journal_slot < OTA_JOURNAL_SLOTS; ota_journal_slot++) {
+		struct ota_journal_rec rec;
+
+		if (ota_flash_read(journal_slot_addr(ota_journal_slot), (uint8_t *)&rec,
+				   sizeof(rec)) != 0) {
+			break;
+		}
+		if (rec.page_crc32 == 0xFFFFFFFFu && rec.page == 0xFFFF &&
+		    rec.check == 0xFFFF) {
+			return;                 /* erased: end of journal */
+		}
+		if (rec.check != journal_check(&rec)) {
+			continue;               /* torn append */
+		}
+		if (rec.page == OTA_JOURNAL_DONE) {
+			ota_journal_done = true;
+		} else if (rec.page == ota_journal_next && rec.page < OTA_META_MAX_PAGES) {
+			ota_page_crc[rec.page] = rec.page_crc32;
+			ota_journal_next++;
+		}
+	}
+}
+
+/* Program the next free slot. A failed or interrupted program leaves at
+ * worst a torn slot, which the scan skips. */
+static int journal_append(uint16_t page, uint32_t crc)
+{
+	struct ota_journal_rec rec = {
+		.page_crc32 = crc,
+		.page = page,
+	};
+
+	if (ota_journal_slot >= OTA_JOURNAL_SLOTS) {
+		return -ENOSPC;
+	}
+	rec.check = journal_check(&rec);
+	return ota_flash_write(journal_slot_addr(ota_journal_slot++),
+			       (const uint8_t *)&rec, sizeof(rec));
+}
+
+/* One page copied: record its CRC, taken from the buffer just written */
+static void journal_page_copied(uint32_t page, const uint8_t *data, uint32_t len)
+{
+	uint32_t crc = crc32_ieee_update(0, data, len);
+
+	if (page < OTA_META_MAX_PAGES) {
+		ota_page_crc[page] = crc;
+	}
+	ota_journal_next = page + 1;
+	journal_append(page, crc);
+}
+
+/* Apply done: close the journal so it caches primary's CRCs, or drop the
+ * record if some page CRCs are unknown (apply resumed from a record that
+ * predates the journal) */
+static void journal_finish(uint32_t image_crc32, uint32_t total_pages)
+{
+	if (ota_journal_first == 0 && ota_journal_next == total_pages &&
+	    journal_append(OTA_JOURNAL_DONE, image_crc32) == 0) {
+		return;
+	}
+	clear_metadata();
+}
+
+/* After journal_scan(): a closed journal with every page's CRC */
+static bool journal_caches_primary(const struct ota_metadata *meta)
+{
+	return ota_journal_done && ota_journal_first == 0 &&
+	       meta->image_size > 0 && meta->image_size <= OTA_STAGING_SIZE &&
+	       ota_journal_next * OTA_FLASH_PAGE_SIZE >= meta->image_size;
+}
+
+/* The primary cache left by the last apply, if any; page CRCs land in
+ * ota_page_crc[] */
+static bool read_primary_cache(struct ota_metadata *meta)
+{
+	if (read_metadata(meta) != 0 || meta->state != OTA_META_STATE_APPLYING) {
+		return false;
+	}
+	journal_scan(meta);
+	return journal_caches_primary(meta);
+}
+
+/* Bytes of the cached image in a page (0 past its end) */
+static uint32_t cached_page_len(const struct ota_metadata *meta, uint32_t page)
+{
+	uint32_t offset = page * OTA_FLASH_PAGE_SIZE;
+
+	if (offset >= meta->image_size) {
+		return 0;
+	}
+	return MIN(meta->image_size - offset, OTA_FLASH_PAGE_SIZE);
+}
+
+/* Reread primary and check it against the cache, page by page */
+static bool primary_cache_matches(const struct ota_metadata *meta)
+{
+	uint32_t crc = 0;
+
+	for (uint32_t page = 0; page * OTA_FLASH_PAGE_SIZE < meta->image_size; page++) {
+		uint32_t n = cached_page_len(meta, page);
+		uint32_t page_crc = ota_flash_compute_crc32(
+			OTA_APP_PRIMARY_ADDR + page * OTA_FLASH_PAGE_SIZE, n);
+
+		if (page_crc != ota_page_crc[page]) {
+			return false;
+		}
+		crc = ota_crc32_combine(crc, page_crc, n);
+	}
+	return crc == meta->image_crc32;
 }
 
 /* ------------------------------------------------------------------ */
@@ -150,26 +438,78 @@ static void erase_stale_app_pages(uint32_t image_size)
 {
 	uint32_t next_page = OTA_APP_PRIMARY_ADDR +
 		((image_size + OTA_FLASH_PAGE_SIZE - 1) & ~(OTA_FLASH_PAGE_SIZE - 1));
-	uint32_t metadata_page = OTA_METADATA_ADDR & ~(OTA_FLASH_PAGE_SIZE - 1);
+	/* Stop below the A/B boot record, the OTA receive checkpoints and
+	 * the persistent event log, which live in the top pages of the
+	 * primary partition and must survive an app update. */
+	uint32_t end_page = OTA_BOOT_RECORD_ADDR;
 
-	if (next_page >= metadata_page) {
+	if (next_page >= end_page) {
 		return;
 	}
 
-	uint32_t erase_size = metadata_page - next_page;
-	LOG_INF("OTA: erasing %u stale pages at 0x%08x",
-		erase_size / OTA_FLASH_PAGE_SIZE, next_page);
-	ota_flash_erase_pages(next_page, erase_size);
+	/* Only pages still holding data: after a same-size or smaller
+	 * update most of them are erased already */
+	uint32_t erased = 0;
+	for (uint32_t addr = next_page; addr < end_page; addr += OTA_FLASH_PAGE_SIZE) {
+		if (ota_flash_is_erased(addr, OTA_FLASH_PAGE_SIZE)) {
+			continue;
+		}
+		ota_flash_erase_pages(addr, OTA_FLASH_PAGE_SIZE);
+		erased++;
+	}
+	LOG_INF("OTA: erased %u stale pages at 0x%08x", erased, next_page);
+}
+
+/* Primary (slot A) was rewritten by the copy path: keep the A/B boot
+ * record in step, if the device has one */
+static void boot_record_primary(uint32_t image_size, uint32_t image_crc32,
+				uint32_t app_version)
+{
+	struct ota_boot_image img = {
+		.size = image_size,
+		.crc32 = image_crc32,
+		.version = app_version,
+	};
+
+	ota_boot_set_image(OTA_SLOT_A, &img);
 }
 
 /* ------------------------------------------------------------------ */
 /*  Apply: copy staging → primary                                       */
 /* ------------------------------------------------------------------ */
 
-/* Static buffer for page-at-a-time copy AND ED25519 signature verify.
- * Must be large enough to hold the full app image for signature verification
- * (ED25519 is not streaming — needs entire message at once). */
-static uint8_t ota_page_buf[OTA_VERIFY_BUF_SIZE];
+/* Static buffer for page-at-a-time copy AND streaming signature verify
+ * (the signature covers SHA-256 of the image, hashed one page at a time). */
+static uint8_t ota_page_buf[OTA_FLASH_PAGE_SIZE];
+
+/* Bring one primary page to the new contents in page_buf (len bytes, the
+ * rest of the page erased) and journal it. A page primary already holds —
+ * code that did not change, or a page copied before a power loss — is
+ * neither erased nor reprogrammed.
+ * Returns 1 if the page was left as it was, 0 if written, negative on error. */
+static int apply_page(uint32_t page, uint8_t *page_buf, uint32_t len)
+{
+	uint32_t dst = OTA_APP_PRIMARY_ADDR + (page * OTA_FLASH_PAGE_SIZE);
+	int unchanged;
+
+	memset(&page_buf[len], 0xFF, OTA_FLASH_PAGE_SIZE - len);
+	unchanged = ota_flash_equals(dst, page_buf, OTA_FLASH_PAGE_SIZE);
+	if (!unchanged) {
+		int err = ota_flash_erase_pages(dst, OTA_FLASH_PAGE_SIZE);
+		if (err) {
+			LOG_ERR("OTA: primary erase failed page %u: %d", page, err);
+			return err;
+		}
+		err = ota_flash_write(dst, page_buf, len);
+		if (err) {
+			LOG_ERR("OTA: primary write failed page %u: %d", page, err);
+			return err;
+		}
+	}
+
+	journal_page_copied(page, page_buf, len);
+	return unchanged;
+}
 
 static int ota_apply(void)
 {
@@ -185,20 +525,19 @@ static int ota_apply(void)
 	uint32_t total_pages = (ota_state.total_size + OTA_FLASH_PAGE_SIZE - 1) /
 			       OTA_FLASH_PAGE_SIZE;
 
-	/* Write recovery metadata — APPLYING state */
-	int err = write_metadata(OTA_META_STATE_APPLYING, ota_state.total_size,
-				 ota_state.expected_crc32, ota_state.app_version,
-				 0, total_pages);
+	/* Write recovery metadata — APPLYING state, empty journal */
+	int err = journal_begin(ota_state.total_size, ota_state.expected_crc32,
+				ota_state.app_version, total_pages);
 	if (err) {
 		return err;
 	}
 
-	/* Copy page by page: erase primary page, read staging, write primary */
+	/* Copy page by page: read staging, update the primary page */
 	uint8_t *page_buf = ota_page_buf;
+	uint32_t unchanged = 0;
 
 	for (uint32_t page = 0; page < total_pages; page++) {
 		uint32_t src = OTA_STAGING_ADDR + (page * OTA_FLASH_PAGE_SIZE);
-		uint32_t dst = OTA_APP_PRIMARY_ADDR + (page * OTA_FLASH_PAGE_SIZE);
 		uint32_t copy_size = OTA_FLASH_PAGE_SIZE;
 
 		/* Last page may be partial */
@@ -213,27 +552,16 @@ static int ota_apply(void)
 			return err;
 		}
 
-		/* Erase primary page */
-		err = ota_flash_erase_pages(dst, OTA_FLASH_PAGE_SIZE);
-		if (err) {
-			LOG_ERR("OTA: primary erase failed page %u: %d", page, err);
-			return err;
-		}
-
-		/* Write to primary */
-		err = ota_flash_write(dst, page_buf, copy_size);
-		if (err) {
-			LOG_ERR("OTA: primary write failed page %u: %d", page, err);
+		/* Erase and write primary unless identical; journal it */
+		err = apply_page(page, page_buf, copy_size);
+		if (err < 0) {
 			return err;
 		}
-
-		/* Update progress in metadata */
-		write_metadata(OTA_META_STATE_APPLYING, ota_state.total_size,
-			       ota_state.expected_crc32, ota_state.app_version,
-			       page + 1, total_pages);
+		unchanged += err;
 
 		LOG_DBG("OTA: copied page %u/%u", page + 1, total_pages);
 	}
+	LOG_INF("OTA: %u of %u pages unchanged", unchanged, total_pages);
 
 	/* Erase stale pages beyond new image to prevent inflated baselines */
 	erase_stale_app_pages(ota_state.total_size);
@@ -246,8 +574,10 @@ static int ota_apply(void)
 		return -EINVAL;
 	}
 
-	LOG_INF("OTA: apply complete, clearing metadata and rebooting");
-	clear_metadata();
+	LOG_INF("OTA: apply complete, caching image CRCs and rebooting");
+	journal_finish(ota_state.expected_crc32, total_pages);
+	boot_record_primary(ota_state.total_size, ota_state.expected_crc32,
+			    ota_state.app_version);
 
 	/* Reboot to load new app */
 	LOG_PANIC();
@@ -257,20 +587,51 @@ static int ota_apply(void)
 	return 0;
 }
 
+/* A/B update: the image is already in the inactive slot. Point the boot
+ * record at it and reboot; nothing is copied, and the slot that was
+ * running stays as it is to fall back to. */
+static int ota_activate_slot(void)
+{
+	uint32_t magic;
+
+	ota_flash_read(ota_state.rx_addr, (uint8_t *)&magic, sizeof(magic));
+	if (magic != APP_CALLBACK_MAGIC) {
+		LOG_ERR("OTA: slot %c magic check failed (got 0x%08x)",
+			OTA_SLOT_NAME(ota_state.slot), magic);
+		return -EINVAL;
+	}
+
+	struct ota_boot_image img = {
+		.size = ota_state.total_size,
+		.crc32 = ota_state.expected_crc32,
+		.version = ota_state.app_version,
+	};
+	int err = ota_boot_activate(ota_state.slot, &img);
+	if (err) {
+		return err;
+	}
+
+	LOG_INF("OTA: slot %c activated, rebooting", OTA_SLOT_NAME(ota_state.slot));
+	LOG_PANIC();
+	sys_reboot(SYS_REBOOT_WARM);
+	return 0;
+}
+
 /* ------------------------------------------------------------------ */
 /*  Boot recovery — resume interrupted apply                            */
 /* ------------------------------------------------------------------ */
 
+/* Resume where the journal left off (journal_scan() has replayed it) and
+ * keep appending to it */
 static int ota_resume_apply(const struct ota_metadata *meta)
 {
 	LOG_WRN("OTA: resuming interrupted apply (page %u/%u)",
-		meta->pages_copied, meta->total_pages);
+		ota_journal_next, meta->total_pages);
 
 	uint8_t *page_buf = ota_page_buf;
 
-	for (uint32_t page = meta->pages_copied; page < meta->total_pages; page++) {
+	for (uint32_t page = ota_journal_next; page < meta->total_pages; page++) {
 		uint32_t src = OTA_STAGING_ADDR + (page * OTA_FLASH_PAGE_SIZE);
-		uint32_t dst = OTA_APP_PRIMARY_ADDR + (page * OTA_FLASH_PAGE_SIZE);
 		uint32_t copy_size = OTA_FLASH_PAGE_SIZE;
 
 		if ((page + 1) * OTA_FLASH_PAGE_SIZE > meta->image_size) {
@@ -282,23 +643,11 @@ static int ota_resume_apply(const struct ota_metadata *meta)
 			LOG_ERR("OTA recovery: staging read failed page %u: %d", page, err);
 			return err;
 		}
-
-		err = ota_flash_erase_pages(dst, OTA_FLASH_PAGE_SIZE);
-		if (err) {
-			LOG_ERR("OTA recovery: primary erase failed page %u: %d", page, err);
+		/* The page cut off by the power loss may already be complete */
+		err = apply_page(page, page_buf, copy_size);
+		if (err < 0) {
 			return err;
 		}
-
-		err = ota_flash_write(dst, page_buf, copy_size);
-		if (err) {
-			LOG_ERR("OTA recovery: primary write failed page %u: %d", page, err);
-			return err;
-		}
-
-		/* Update progress */
-		write_metadata(OTA_META_STATE_APPLYING, meta->image_size,
-			       meta->image_crc32, meta->app_version,
-			       page + 1, meta->total_pages);
 	}
 
 	/* Erase stale pages beyond new image to prevent inflated baselines */
@@ -312,13 +661,316 @@ static int ota_resume_apply(const struct ota_metadata *meta)
 		return -EINVAL;
 	}
 
-	LOG_INF("OTA recovery: complete, clearing metadata and rebooting");
-	clear_metadata();
+	LOG_INF("OTA recovery: complete, rebooting");
+	journal_finish(meta->image_crc32, meta->total_pages);
+	boot_record_primary(meta->image_size, meta->image_crc32, meta->app_version);
 	LOG_PANIC();
 	sys_reboot(SYS_REBOOT_WARM);
 	return 0;
 }
 
+/* ------------------------------------------------------------------ */
+/*  Staging — in-order image bytes, digested on the way to flash        */
+/* ------------------------------------------------------------------ */
+
+/* Sink for full, patch and compressed modes: queue the next bytes of
+ * the image on the write combiner and fold them into the running CRC32 and signature hash, so
+ * validation need not read the image back */
+static int stage_sink(void *ctx, const uint8_t *data, size_t len)
+{
+	ARG_UNUSED(ctx);
+
+	uint32_t addr = ota_state.rx_addr + ota_state.staged_len;
+
+	/* Resumed session: leave bytes staged before the reboot alone, up to
+	 * the first that differ */
+	if (!ota_state.rx_verify || !ota_flash_equals(addr, data, len)) {
+		ota_state.rx_verify = false;
+		int err = ota_flash_writer_put(&ota_stage_writer, addr, data, len);
+		if (err) {
+			return err;
+		}
+	}
+
+	ota_state.rx_crc32 = crc32_ieee_update(ota_state.rx_crc32, data, len);
+
+	/* The signature covers everything but its own trailing 64 bytes */
+	uint32_t fw_size = ota_state.total_size - OTA_SIG_SIZE;
+	if (ota_state.rx_hashing && ota_state.staged_len < fw_size) {
+		uint32_t n = MIN(len, fw_size - ota_state.staged_len);
+
+		if (ota_verify_update(data, n) != 0) {
+			/* Fall back to hashing staging at validation */
+			ota_state.rx_hashing = false;
+		}
+	}
+
+	ota_state.staged_len += len;
+	return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Receive checkpoints — resume a session after a reboot               */
+/* ------------------------------------------------------------------ */
+
+_Static_assert(sizeof(struct ota_rx_session) <= OTA_RX_RECS_ADDR - OTA_RX_STATE_ADDR,
+	       "session header must fit below the checkpoint slots");
+_Static_assert(OTA_RX_SLOTS > DELTA_WORDS,
+	       "a compacted delta checkpoint must fit the page");
+
+static struct ota_rx_session ota_rx_id;   /* session being received */
+static uint16_t ota_rx_slot;              /* next free checkpoint slot */
+static bool ota_rx_live;                  /* a session header is on flash */
+
+static void rx_session_init(struct ota_rx_session *id, uint32_t total_size,
+			    uint16_t total_chunks, uint16_t chunk_size,
+			    uint32_t crc32, uint32_t version, uint8_t flags)
+{
+	memset(id, 0, sizeof(*id));
+	id->magic = OTA_RX_MAGIC;
+	id->total_size = total_size;
+	id->crc32 = crc32;
+	id->version = version;
+	id->total_chunks = total_chunks;
+	id->chunk_size = chunk_size;
+	id->flags = flags;
+	id->check = crc32_ieee_update(0, (const uint8_t *)id,
+				      offsetof(struct ota_rx_session, check));
+}
+
+static uint16_t rx_rec_check(const struct ota_rx_rec *rec)
+{
+	return (uint16_t)crc32_ieee_update(0, (const uint8_t *)rec,
+					   offsetof(struct ota_rx_rec, check));
+}
+
+/* Erase the checkpoint page and write the session header */
+static int rx_begin(void)
+{
+	ota_rx_slot = 0;
+	ota_rx_live = false;
+
+	int err = ota_flash_erase_pages(OTA_RX_STATE_ADDR, OTA_FLASH_PAGE_SIZE);
+	if (!err) {
+		err = ota_flash_write(OTA_RX_STATE_ADDR, (const uint8_t *)&ota_rx_id,
+				      sizeof(ota_rx_id));
+	}
+	if (err) {
+		LOG_WRN("OTA: checkpoint page write failed: %d", err);
+		return err;
+	}
+	ota_rx_live = true;
+	return 0;
+}
+
+/* End the session on flash: a later START can no longer resume it */
+static void rx_retire(void)
+{
+	uint32_t magic = 0;
+
+	if (ota_rx_live) {
+		ota_rx_live = false;
+		ota_flash_write(OTA_RX_STATE_ADDR, (const uint8_t *)&magic, sizeof(magic));
+	}
+}
+
+/* Read the session header left on flash, e.g. from before a reboot.
+ * Returns true if it is ota_rx_id's. */
+static bool rx_load(void)
+{
+	struct ota_rx_session hdr;
+
+	if (ota_flash_read(OTA_RX_STATE_ADDR, (uint8_t *)&hdr, sizeof(hdr)) != 0) {
+		return false;
+	}
+	ota_rx_live = hdr.magic == OTA_RX_MAGIC;
+	return memcmp(&hdr, &ota_rx_id, sizeof(hdr)) == 0;
+}
+
+static int rx_append(uint32_t value, uint16_t chunk)
+{
+	struct ota_rx_rec rec = {
+		.value = value,
+		.chunk = chunk,
+	};
+
+	if (ota_rx_slot >= OTA_RX_SLOTS) {
+		return -ENOSPC;
+	}
+	rec.check = rx_rec_check(&rec);
+	return ota_flash_write(OTA_RX_RECS_ADDR +
+			       (uint32_t)ota_rx_slot++ * sizeof(rec),
+			       (const uint8_t *)&rec, sizeof(rec));
+}
+
+/* One record per delta bitmap word flagged in set[] (summary layout) */
+static int rx_append_words(uint32_t *set)
+{
+	for (uint32_t s = 0; s < DELTA_SUMMARY_WORDS; s++) {
+		while (set[s]) {
+			uint32_t w = s * 32 + __builtin_ctz(set[s]);
+			int err = rx_append(ota_state.delta_received[w], w * 32);
+
+			if (err) {
+				return err;
+			}
+			set[s] &= set[s] - 1;
+		}
+	}
+	return 0;
+}
+
+static int rx_write_progress(bool compact)
+{
+	if (!ota_state.delta_mode) {
+		return rx_append(ota_state.rx_crc32, ota_state.chunks_received);
+	}
+	if (!compact) {
+		return rx_append_words(ota_state.delta_dirty);
+	}
+
+	uint32_t all[DELTA_SUMMARY_WORDS];
+
+	memcpy(all, ota_state.delta_summary, sizeof(all));
+	memset(ota_state.delta_dirty, 0, sizeof(ota_state.delta_dirty));
+	return rx_append_words(all);
+}
+
+/* Record progress so far. Staged words go to flash first, so a record
+ * never covers data that was still in the write combiner: the bytes of
+ * a partial last word stay there, and delta mode leaves the chunks they
+ * belong to for the next checkpoint. Full mode checkpoints every
+ * OTA_RX_CHECKPOINT_CHUNKS chunks, a whole number of words. Full mode
+ * takes one slot; delta mode one per bitmap word changed since the last
+ * checkpoint. A full page is rewritten with the header and a single
+ * snapshot. On failure the session just stops being resumable. */
+static void rx_checkpoint(void)
+{
+	if (!ota_rx_live) {
+		return;
+	}
+	/* Full mode resumes at chunks_received * chunk_size */
+	if (!ota_state.delta_mode &&
+	    ota_state.staged_len != (uint32_t)ota_state.chunks_received * ota_state.chunk_size) {
+		return;
+	}
+
+	int err = ota_flash_writer_flush(&ota_stage_writer);
+	uint32_t held_addr;
+	size_t held = err ? 0 : ota_flash_writer_held(&ota_stage_writer, &held_addr);
+	uint32_t held_first = 0;
+	uint32_t held_mask = 0;         /* held chunks taken out, from held_first */
+
+	if (held && !ota_state.delta_mode) {
+		return;
+	}
+	if (held) {
+		/* At most two chunks: delta chunks are longer than a word */
+		uint32_t last = (held_addr + held - 1 - ota_state.rx_addr) / ota_state.chunk_size;
+
+		held_first = (held_addr - ota_state.rx_addr) / ota_state.chunk_size;
+		for (uint32_t i = held_first; i <= last; i++) {
+			uint32_t bit = 1u << (i % 32);
+
+			if (ota_state.delta_received[i / 32] & bit) {
+				ota_state.delta_received[i / 32] &= ~bit;
+				held_mask |= 1u << (i - held_first);
+			}
+		}
+	}
+
+	if (!err) {
+		uint32_t needed = 1;
+
+		if (ota_state.delta_mode) {
+			needed = 0;
+			for (uint32_t s = 0; s < DELTA_SUMMARY_WORDS; s++) {
+				needed += __builtin_popcount(ota_state.delta_dirty[s]);
+			}
+		}
+		if (ota_rx_slot + needed > OTA_RX_SLOTS) {
+			err = rx_begin();
+			if (!err) {
+				err = rx_write_progress(true);
+			}
+		} else {
+			err = rx_write_progress(false);
+		}
+	}
+	/* Back in the bitmap, and dirty so the next checkpoint records them */
+	for (uint32_t i = held_first; held_mask; i++, held_mask >>= 1) {
+		if (held_mask & 1) {
+			delta_mark_received((uint16_t)i);
+		}
+	}
+	if (err) {
+		LOG_WRN("OTA: checkpoint failed (%d), session no longer resumable", err);
+		rx_retire();
+	}
+}
+
+/* After rx_load() found the session: replay its checkpoints into
+ * ota_state. Torn slots are skipped; an erased slot ends the log. Full
+ * mode resumes from the latest record, delta mode from the union of the
+ * recorded bitmap words. Returns false if nothing usable was recorded. */
+static bool rx_resume(void)
+{
+	if (ota_state.delta_mode) {
+		memset(ota_state.delta_received, 0, sizeof(ota_state.delta_received));
+		memset(ota_state.delta_summary, 0, sizeof(ota_state.delta_summary));
+		memset(ota_state.delta_dirty, 0, sizeof(ota_state.delta_dirty));
+	}
+
+	uint16_t chunks = 0;
+	uint32_t crc = 0;
+
+	for (ota_rx_slot = 0; ota_rx_slot < OTA_RX_SLOTS; ota_rx_slot++) {
+		struct ota_rx_rec rec;
+
+		if (ota_flash_read(OTA_RX_RECS_ADDR + (uint32_t)ota_rx_slot * sizeof(rec),
+				   (uint8_t *)&rec, sizeof(rec)) != 0) {
+			return false;
+		}
+		if (rec.value == 0xFFFFFFFFu && rec.chunk == 0xFFFF &&
+		    rec.check == 0xFFFF) {
+			break;                  /* erased: end of checkpoints */
+		}
+		if (rec.check != rx_rec_check(&rec)) {
+			continue;               /* torn append */
+		}
+		if (!ota_state.delta_mode) {
+			chunks = rec.chunk;
+			crc = rec.value;
+		} else if (rec.chunk % 32 == 0 && rec.chunk < ota_state.full_image_chunks) {
+			uint32_t w = rec.chunk / 32;
+
+			ota_state.delta_received[w] |= rec.value;
+			if (ota_state.delta_received[w]) {
+				ota_state.delta_summary[w / 32] |= 1u << (w % 32);
+			}
+		}
+	}
+
+	if (ota_state.delta_mode) {
+		chunks = 0;
+		for (uint32_t w = 0; w < DELTA_WORDS; w++) {
+			chunks += __builtin_popcount(ota_state.delta_received[w]);
+		}
+	}
+	if (chunks == 0 || chunks >= ota_state.total_chunks) {
+		return false;
+	}
+
+	ota_state.chunks_received = chunks;
+	ota_state.bytes_written = (uint32_t)chunks * ota_state.chunk_size;
+	if (!ota_state.delta_mode) {
+		ota_state.staged_len = ota_state.bytes_written;
+		ota_state.rx_crc32 = crc;
+	}
+	ota_state.rx_verify = true;
+	return true;
+}
+
 /* ------------------------------------------------------------------ */
 /*  Message handlers                                                    */
 /* ------------------------------------------------------------------ */
@@ -333,10 +985,6 @@ static void handle_ota_start(const uint8_t *data, size_t len)
 		return;
 	}
 
-	if (ota_state.phase == OTA_PHASE_RECEIVING) {
-		LOG_WRN("OTA START: aborting previous session");
-	}
-
 	const uint8_t *p = data + 2;
 	uint32_t total_size   = p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);
 	uint16_t total_chunks = p[4] | (p[5] << 8);
@@ -350,14 +998,52 @@ static void handle_ota_start(const uint8_t *data, size_t len)
 		flags = data[18];
 	}
 	bool is_signed = (flags & OTA_START_FLAGS_SIGNED) != 0;
+	bool is_patch = (flags & OTA_START_FLAGS_PATCH) != 0;
+	bool is_compressed = (flags & OTA_START_FLAGS_COMPRESSED) != 0;
 
-	/* Detect delta mode: fewer chunks than the full image requires */
-	uint16_t full_image_chunks = (total_size + chunk_size - 1) / chunk_size;
-	bool is_delta = (total_chunks < full_image_chunks);
+	if (chunk_size == 0) {
+		LOG_ERR("OTA START: chunk size 0");
+		send_ack(OTA_STATUS_SIZE_ERR, 0, 0);
+		return;
+	}
+
+	/* Detect delta mode: fewer chunks than the full image requires.
+	 * Patch and compressed streams are sequential, whatever their
+	 * chunk count. */
+	uint32_t full_image_chunks = (total_size + chunk_size - 1) / chunk_size;
+	bool is_delta = !is_patch && !is_compressed &&
+			(total_chunks < full_image_chunks);
 
-	LOG_INF("OTA START: size=%u chunks=%u/%u chunk_size=%u crc=0x%08x ver=%u%s%s",
+	LOG_INF("OTA START: size=%u chunks=%u/%u chunk_size=%u crc=0x%08x ver=%u%s%s%s%s",
 		total_size, total_chunks, full_image_chunks, chunk_size, crc32,
-		version, is_delta ? " DELTA" : "", is_signed ? " SIGNED" : "");
+		version, is_delta ? " DELTA" : "", is_patch ? " PATCH" : "",
+		is_compressed ? " LZ" : "", is_signed ? " SIGNED" : "");
+
+	/* Compression applies to full images only */
+	if (is_patch && is_compressed) {
+		LOG_ERR("OTA START: compressed patches are not supported");
+		send_ack(OTA_STATUS_PATCH_ERR, 0, 0);
+		return;
+	}
+
+	struct ota_rx_session id;
+
+	rx_session_init(&id, total_size, total_chunks, chunk_size, crc32, version, flags);
+
+	/* START repeated for the session in progress (its ACK was lost):
+	 * report progress instead of starting over */
+	if (ota_state.phase == OTA_PHASE_RECEIVING &&
+	    memcmp(&id, &ota_rx_id, sizeof(id)) == 0) {
+		LOG_INF("OTA START: session in progress, %u chunks received",
+			ota_state.chunks_received);
+		ota_state.ack_pending = 0;
+		send_ack(OTA_STATUS_OK, ota_state.chunks_received, ota_state.chunks_received);
+		return;
+	}
+
+	if (ota_state.phase == OTA_PHASE_RECEIVING) {
+		LOG_WRN("OTA START: aborting previous session");
+	}
 
 	/* Reject START during active apply phases */
 	if (ota_state.phase == OTA_PHASE_APPLYING || ota_state.phase == OTA_PHASE_COMPLETE) {
@@ -366,41 +1052,74 @@ static void handle_ota_start(const uint8_t *data, size_t len)
 		return;
 	}
 
-	/* Check if firmware already applied (handles lost COMPLETE after reboot) */
-	uint32_t primary_crc = ota_flash_compute_crc32(OTA_APP_PRIMARY_ADDR, total_size);
-	if (primary_crc == crc32) {
+	/* Check if firmware already applied (handles lost COMPLETE after reboot).
+	 * The running slot's A/B record, or the CRC cached by the last copy,
+	 * answers without reading primary. */
+	uint8_t active = ota_boot_active_slot();
+	struct ota_boot_image running;
+	struct ota_metadata primary;
+	bool applied;
+
+	if (ota_boot_slot_image(active, &running)) {
+		applied = running.size == total_size && running.crc32 == crc32;
+	} else if (read_primary_cache(&primary)) {
+		applied = primary.image_size == total_size && primary.image_crc32 == crc32;
+	} else {
+		applied = ota_flash_compute_crc32(OTA_APP_PRIMARY_ADDR, total_size) == crc32;
+	}
+	if (applied) {
 		LOG_INF("OTA START: firmware already applied (CRC 0x%08x), sending COMPLETE", crc32);
-		send_complete(OTA_STATUS_OK, primary_crc);
+		send_complete(OTA_STATUS_OK, crc32);
 		return;
 	}
 
-	/* Validate size fits staging area */
+	/* The slot a trial image falls back to must stay intact until the
+	 * trial image confirms */
+	if (ota_boot_in_trial()) {
+		LOG_WRN("OTA START: slot %c still on trial, rejecting",
+			OTA_SLOT_NAME(active));
+		send_ack(OTA_STATUS_NO_SESSION, 0, 0);
+		return;
+	}
+
+	/* A/B: an image for the inactive slot is received straight into it;
+	 * a delta's unchanged chunks are copied in from the running slot
+	 * before activation. One for slot A while A runs goes through
+	 * staging and the copy path; one for slot B while B runs has nowhere
+	 * to go, since staging is slot B. */
+	uint8_t slot = (flags & OTA_START_FLAGS_SLOT_B) ? OTA_SLOT_B : OTA_SLOT_A;
+	bool direct = slot != active;
+
+	if (!direct && slot != OTA_SLOT_A) {
+		LOG_ERR("OTA START: image for slot %c, slot %c running",
+			OTA_SLOT_NAME(slot), OTA_SLOT_NAME(active));
+		send_ack(OTA_STATUS_SLOT_ERR, 0, 0);
+		return;
+	}
+
+	/* Validate size fits staging area (and so either slot) */
 	if (total_size > OTA_STAGING_SIZE || total_size == 0) {
 		LOG_ERR("OTA START: invalid size %u (max %u)", total_size, OTA_STAGING_SIZE);
 		send_ack(OTA_STATUS_SIZE_ERR, 0, 0);
 		return;
 	}
 
-	/* Delta mode: validate bitfield capacity */
-	if (is_delta && full_image_chunks > sizeof(ota_state.delta_received) * 8) {
-		LOG_ERR("OTA START: image too large for delta (%u chunks, max %u)",
-			full_image_chunks, sizeof(ota_state.delta_received) * 8);
+	/* Delta mode: the received-chunk bitmap is sized for chunks of at
+	 * least OTA_DELTA_MIN_CHUNK_SIZE over the largest image */
+	if (is_delta && chunk_size < OTA_DELTA_MIN_CHUNK_SIZE) {
+		LOG_ERR("OTA START: delta chunk size %u below %u",
+			chunk_size, OTA_DELTA_MIN_CHUNK_SIZE);
 		send_ack(OTA_STATUS_SIZE_ERR, 0, 0);
 		return;
 	}
-
-	/* Erase staging area */
-	uint32_t erase_size = (total_size + OTA_FLASH_PAGE_SIZE - 1) &
-			      ~(OTA_FLASH_PAGE_SIZE - 1);
-	int err = ota_flash_erase_pages(OTA_STAGING_ADDR, erase_size);
-	if (err) {
-		LOG_ERR("OTA START: staging erase failed: %d", err);
-		send_ack(OTA_STATUS_FLASH_ERR, 0, 0);
+	if (is_delta && full_image_chunks > OTA_DELTA_MAX_CHUNKS) {
+		LOG_ERR("OTA START: image too large for delta (%u chunks, max %u)",
+			full_image_chunks, OTA_DELTA_MAX_CHUNKS);
+		send_ack(OTA_STATUS_SIZE_ERR, 0, 0);
 		return;
 	}
 
 	/* Initialize session state */
-	ota_state.phase = OTA_PHASE_RECEIVING;
 	ota_state.total_size = total_size;
 	ota_state.total_chunks = total_chunks;
 	ota_state.chunk_size = chunk_size;
@@ -410,14 +1129,81 @@ static void handle_ota_start(const uint8_t *data, size_t len)
 	ota_state.bytes_written = 0;
 	ota_state.is_signed = is_signed;
 	ota_state.delta_mode = is_delta;
+	ota_state.ack_every = is_delta ? OTA_START_ACK_EVERY(flags) : 0;
+	ota_state.ack_pending = 0;
 	ota_state.full_image_chunks = full_image_chunks;
-	if (is_delta) {
-		memset(ota_state.delta_received, 0, sizeof(ota_state.delta_received));
+	ota_state.patch_mode = is_patch;
+	ota_state.compressed = is_compressed;
+	ota_state.staged_len = 0;
+	ota_state.rx_crc32 = 0;
+	ota_state.rx_verify = false;
+	ota_state.slot = slot;
+	ota_state.slot_direct = direct;
+	ota_state.rx_addr = direct ? ota_boot_slot_addr(slot) : OTA_STAGING_ADDR;
+	ota_state.base_addr = ota_boot_slot_addr(active);
+	ota_rx_id = id;
+
+	/* Full and delta sessions pick up from their last checkpoint after a
+	 * reboot; the patch and LZ decoders keep their state in RAM only */
+	bool resumed = rx_load() && !is_patch && !is_compressed && rx_resume();
+
+	if (!resumed) {
+		if (is_delta) {
+			memset(ota_state.delta_received, 0, sizeof(ota_state.delta_received));
+			memset(ota_state.delta_summary, 0, sizeof(ota_state.delta_summary));
+			memset(ota_state.delta_dirty, 0, sizeof(ota_state.delta_dirty));
+		}
+
+		/* The old session's checkpoints must not outlive its staging */
+		rx_retire();
+
+		/* Slot A is about to change under the CRCs cached by the last copy */
+		if (ota_state.rx_addr == OTA_APP_PRIMARY_ADDR && read_metadata(&primary) == 0) {
+			clear_metadata();
+		}
+
+		/* Erase staging area (or the slot) */
+		uint32_t erase_size = (total_size + OTA_FLASH_PAGE_SIZE - 1) &
+				      ~(OTA_FLASH_PAGE_SIZE - 1);
+		int err = ota_flash_erase_pages(ota_state.rx_addr, erase_size);
+		if (err) {
+			LOG_ERR("OTA START: staging erase failed: %d", err);
+			ota_state.phase = OTA_PHASE_IDLE;
+			send_ack(OTA_STATUS_FLASH_ERR, 0, 0);
+			return;
+		}
+
+		if (!is_patch && !is_compressed) {
+			rx_begin();
+		}
 	}
 
-	LOG_INF("OTA: staging erased, ready for chunks%s",
-		is_delta ? " (delta mode)" : "");
-	send_ack(OTA_STATUS_OK, 0, 0);
+	ota_state.phase = OTA_PHASE_RECEIVING;
+	if (is_patch) {
+		/* The patch base is whatever runs now */
+		ota_patch_init(&ota_patch, ota_state.base_addr, ota_state.rx_addr,
+			       total_size);
+		ota_patch_set_sink(&ota_patch, stage_sink, NULL);
+	}
+	if (is_compressed) {
+		/* The page buffer is idle until validation: use it as history */
+		ota_lz_init(&ota_lz, ota_page_buf, total_size, stage_sink, NULL);
+	}
+	ota_flash_writer_init(&ota_stage_writer);
+	/* A resumed signed image is hashed from staging at validation */
+	ota_state.rx_hashing = !resumed && is_signed && !is_delta &&
+			       total_size > OTA_SIG_SIZE && ota_verify_begin() == 0;
+
+	if (resumed) {
+		LOG_INF("OTA: resuming session at %u/%u chunks",
+			ota_state.chunks_received, total_chunks);
+	} else {
+		LOG_INF("OTA: %s erased, ready for chunks%s",
+			direct ? "slot" : "staging",
+			is_delta ? " (delta mode)" : is_patch ? " (patch mode)" :
+			is_compressed ? " (compressed)" : "");
+	}
+	send_ack(OTA_STATUS_OK, ota_state.chunks_received, ota_state.chunks_received);
 }
 
 static void delta_validate_and_apply(void);
@@ -444,27 +1230,42 @@ static int ota_verify_staged_signature(uint32_t staging_addr, uint32_t total_siz
 		return err;
 	}
 
-	/* Verify signature over firmware data (read in chunks to avoid
-	 * allocating the entire firmware in RAM). For the initial
-	 * implementation, ota_verify_signature() reads from the provided
-	 * buffer, so we pass staging address and let the verify function
-	 * handle it. However, the current API takes a flat buffer.
-	 *
-	 * Compromise: ED25519 requires the full message at once (not streaming),
-	 * so we read the entire firmware into ota_page_buf (16KB). */
-	if (fw_size > OTA_VERIFY_BUF_SIZE) {
-		LOG_ERR("OTA: signed firmware too large for verify buffer (%u > %u)",
-			fw_size, OTA_VERIFY_BUF_SIZE);
-		return -ENOMEM;
-	}
+	/* Hash the firmware one page at a time, then check the signature */
+	err = ota_verify_begin();
+	for (uint32_t off = 0; !err && off < fw_size; off += OTA_FLASH_PAGE_SIZE) {
+		uint32_t n = MIN(fw_size - off, OTA_FLASH_PAGE_SIZE);
 
-	err = ota_flash_read(staging_addr, ota_page_buf, fw_size);
+		err = ota_flash_read(staging_addr + off, ota_page_buf, n);
+		if (err) {
+			LOG_ERR("OTA: failed to read firmware for verify: %d", err);
+			return err;
+		}
+		err = ota_verify_update(ota_page_buf, n);
+	}
+	if (!err) {
+		err = ota_verify_finish(ota_sig_buf);
+	}
 	if (err) {
-		LOG_ERR("OTA: failed to read firmware for verify: %d", err);
+		LOG_ERR("OTA: ED25519 signature verification failed: %d", err);
 		return err;
 	}
 
-	err = ota_verify_signature(ota_page_buf, fw_size, ota_sig_buf);
+	LOG_INF("OTA: ED25519 signature verified OK (%u bytes firmware)", fw_size);
+	return 0;
+}
+
+/* Finish the hash fed by stage_sink() and check it against the signature
+ * at the end of staging */
+static int ota_verify_received_signature(void)
+{
+	uint32_t fw_size = ota_state.total_size - OTA_SIG_SIZE;
+	int err = ota_flash_read(ota_state.rx_addr + fw_size, ota_sig_buf, OTA_SIG_SIZE);
+
+	if (err) {
+		LOG_ERR("OTA: failed to read signature: %d", err);
+		return err;
+	}
+	err = ota_verify_finish(ota_sig_buf);
 	if (err) {
 		LOG_ERR("OTA: ED25519 signature verification failed: %d", err);
 		return err;
@@ -476,6 +1277,18 @@ static int ota_verify_staged_signature(uint32_t staging_addr, uint32_t total_siz
 
 static void ota_validate_and_apply(void)
 {
+	/* Every chunk is in: pass or fail, the session cannot be resumed */
+	rx_retire();
+
+	/* Program the write combiner's last run before anything reads staging */
+	int err = ota_flash_writer_finish(&ota_stage_writer);
+	if (err) {
+		LOG_ERR("OTA: staging flush failed: %d", err);
+		send_complete(OTA_STATUS_FLASH_ERR, 0);
+		ota_state.phase = OTA_PHASE_ERROR;
+		return;
+	}
+
 	if (ota_state.delta_mode) {
 		delta_validate_and_apply();
 		return;
@@ -484,9 +1297,9 @@ static void ota_validate_and_apply(void)
 	LOG_INF("OTA: all chunks received, validating...");
 	ota_state.phase = OTA_PHASE_VALIDATING;
 
-	/* Compute CRC32 over staged image (includes signature if signed) */
-	uint32_t calc_crc32 = ota_flash_compute_crc32(OTA_STAGING_ADDR,
-						  ota_state.total_size);
+	/* CRC32 of the staged image (includes signature if signed), summed as
+	 * it was written */
+	uint32_t calc_crc32 = ota_state.rx_crc32;
 	if (calc_crc32 != ota_state.expected_crc32) {
 		LOG_ERR("OTA: CRC32 mismatch (calc=0x%08x, expected=0x%08x)",
 			calc_crc32, ota_state.expected_crc32);
@@ -495,10 +1308,12 @@ static void ota_validate_and_apply(void)
 		return;
 	}
 
-	/* ED25519 signature verification (if flagged as signed) */
+	/* ED25519 signature verification (if flagged as signed). The image was
+	 * normally hashed on receipt; only the signature is read back. */
 	if (ota_state.is_signed) {
-		int sig_err = ota_verify_staged_signature(OTA_STAGING_ADDR,
-							  ota_state.total_size);
+		int sig_err = ota_state.rx_hashing
+			? ota_verify_received_signature()
+			: ota_verify_staged_signature(ota_state.rx_addr, ota_state.total_size);
 		if (sig_err) {
 			send_complete(OTA_STATUS_SIG_ERR, calc_crc32);
 			ota_state.phase = OTA_PHASE_ERROR;
@@ -513,12 +1328,49 @@ static void ota_validate_and_apply(void)
 }
 
 /* ------------------------------------------------------------------ */
-/*  Delta OTA: merge staging + primary, validate CRC, apply             */
+/*  Delta OTA: merge received chunks + baseline, validate CRC, apply    */
 /* ------------------------------------------------------------------ */
 
-static inline bool delta_chunk_received(uint16_t idx)
+/* Read [offset, offset + len) of the new image: the running slot's
+ * baseline with received chunks laid over it */
+static int delta_read_merged(uint32_t offset, uint8_t *buf, uint32_t len)
+{
+	int err = ota_flash_read(ota_state.base_addr + offset, buf, len);
+	if (err) {
+		return err;
+	}
+
+	uint32_t first_chunk = offset / ota_state.chunk_size;
+	uint32_t last_chunk = (offset + len - 1) / ota_state.chunk_size;
+	if (last_chunk >= ota_state.full_image_chunks) {
+		last_chunk = ota_state.full_image_chunks - 1;
+	}
+
+	for (uint32_t ci = delta_next_received(first_chunk, last_chunk);
+	     ci <= last_chunk; ci = delta_next_received(ci + 1, last_chunk)) {
+		uint32_t chunk_start = (uint32_t)ci * ota_state.chunk_size;
+		uint32_t start = MAX(chunk_start, offset);
+		uint32_t end = MIN(chunk_start + ota_state.chunk_size, offset + len);
+
+		err = ota_flash_read(ota_state.rx_addr + start, &buf[start - offset],
+				     end - start);
+		if (err) {
+			return err;
+		}
+	}
+	return 0;
+}
+
+/* True if a received chunk overlaps [offset, offset + len) of the image */
+static bool delta_range_touched(uint32_t offset, uint32_t len)
 {
-	return (ota_state.delta_received[idx / 8] >> (idx % 8)) & 1u;
+	uint32_t first_chunk = offset / ota_state.chunk_size;
+	uint32_t last_chunk = (offset + len - 1) / ota_state.chunk_size;
+
+	if (last_chunk >= ota_state.full_image_chunks) {
+		last_chunk = ota_state.full_image_chunks - 1;
+	}
+	return delta_next_received(first_chunk, last_chunk) <= last_chunk;
 }
 
 static void delta_validate_and_apply(void)
@@ -527,33 +1379,49 @@ static void delta_validate_and_apply(void)
 		ota_state.chunks_received, ota_state.full_image_chunks);
 	ota_state.phase = OTA_PHASE_VALIDATING;
 
-	/* CRC32 over merged image: staging (received) + primary (baseline) */
+	/* CRC32 over the merged image, a page at a time. A page no chunk
+	 * touched is still the baseline's, so on primary the CRC cached by
+	 * the last apply stands in for it. A signed image has to be hashed in
+	 * full anyway: each page is read once, for the CRC and the hash
+	 * together. */
+	struct ota_metadata primary;
+	bool hashing = ota_state.is_signed && ota_state.total_size > OTA_SIG_SIZE;
+	bool cached = !ota_state.is_signed &&
+		      ota_state.base_addr == OTA_APP_PRIMARY_ADDR &&
+		      read_primary_cache(&primary);
+	uint32_t fw_size = hashing ? ota_state.total_size - OTA_SIG_SIZE : 0;
+	int sig_err = hashing ? ota_verify_begin() : 0;
 	uint32_t crc = 0;
-	uint8_t buf[16];
-
-	for (uint16_t i = 0; i < ota_state.full_image_chunks; i++) {
-		uint32_t offset = (uint32_t)i * ota_state.chunk_size;
-		uint16_t read_size = ota_state.chunk_size;
-		uint32_t remaining = ota_state.total_size - offset;
-
-		if (remaining < read_size) {
-			read_size = (uint16_t)remaining;
-		}
+	uint32_t pages_read = 0;
 
-		uint32_t addr = delta_chunk_received(i)
-			? (OTA_STAGING_ADDR + offset)
-			: (OTA_APP_PRIMARY_ADDR + offset);
+	for (uint32_t offset = 0; offset < ota_state.total_size; offset += OTA_FLASH_PAGE_SIZE) {
+		uint32_t page = offset / OTA_FLASH_PAGE_SIZE;
+		uint32_t n = MIN(ota_state.total_size - offset, OTA_FLASH_PAGE_SIZE);
+		uint32_t page_crc;
 
-		int err = ota_flash_read(addr, buf, read_size);
-		if (err) {
-			LOG_ERR("OTA: delta CRC read failed at 0x%08x: %d",
-				addr, err);
-			send_complete(OTA_STATUS_FLASH_ERR, 0);
-			ota_state.phase = OTA_PHASE_ERROR;
-			return;
+		if (cached && cached_page_len(&primary, page) == n &&
+		    !delta_range_touched(offset, n)) {
+			page_crc = ota_page_crc[page];
+		} else {
+			int err = delta_read_merged(offset, ota_page_buf, n);
+			if (err) {
+				LOG_ERR("OTA: delta read failed at offset %u: %d",
+					offset, err);
+				send_complete(OTA_STATUS_FLASH_ERR, 0);
+				ota_state.phase = OTA_PHASE_ERROR;
+				return;
+			}
+			page_crc = crc32_ieee_update(0, ota_page_buf, n);
+			if (hashing && !sig_err && offset < fw_size) {
+				sig_err = ota_verify_update(ota_page_buf,
+							    MIN(n, fw_size - offset));
+			}
+			pages_read++;
 		}
-		crc = crc32_ieee_update(crc, buf, read_size);
+		crc = ota_crc32_combine(crc, page_crc, n);
 	}
+	LOG_INF("OTA: delta CRC over %u pages, %u read", (ota_state.total_size +
+		OTA_FLASH_PAGE_SIZE - 1) / OTA_FLASH_PAGE_SIZE, pages_read);
 
 	if (crc != ota_state.expected_crc32) {
 		LOG_ERR("OTA: delta CRC32 mismatch (calc=0x%08x, expected=0x%08x)",
@@ -563,51 +1431,12 @@ static void delta_validate_and_apply(void)
 		return;
 	}
 
-	/* ED25519 signature verification for delta mode.
-	 * The merged image is firmware+signature; we need to read the
-	 * merged content into RAM for verification. ED25519 requires the
-	 * full message, so ota_page_buf must be large enough. */
+	/* ED25519 signature over the merged image; the signature itself is
+	 * its last 64 bytes */
 	if (ota_state.is_signed) {
-		if (ota_state.total_size <= OTA_SIG_SIZE ||
-		    ota_state.total_size > OTA_VERIFY_BUF_SIZE) {
-			LOG_ERR("OTA: delta signed image too large for verify (%u > %u)",
-				ota_state.total_size, OTA_VERIFY_BUF_SIZE);
-			send_complete(OTA_STATUS_SIG_ERR, crc);
-			ota_state.phase = OTA_PHASE_ERROR;
-			return;
-		}
-
-		uint32_t fw_size = ota_state.total_size - OTA_SIG_SIZE;
-
-		/* Read merged image into ota_page_buf (same merge logic as CRC) */
-		for (uint16_t ci = 0; ci < ota_state.full_image_chunks; ci++) {
-			uint32_t offset = (uint32_t)ci * ota_state.chunk_size;
-			uint16_t read_size = ota_state.chunk_size;
-			uint32_t remaining = ota_state.total_size - offset;
-
-			if (remaining < read_size) {
-				read_size = (uint16_t)remaining;
-			}
-
-			uint32_t addr = delta_chunk_received(ci)
-				? (OTA_STAGING_ADDR + offset)
-				: (OTA_APP_PRIMARY_ADDR + offset);
-
-			int err = ota_flash_read(addr, &ota_page_buf[offset],
-						 read_size);
-			if (err) {
-				LOG_ERR("OTA: delta sig read chunk %u: %d",
-					ci, err);
-				send_complete(OTA_STATUS_SIG_ERR, crc);
-				ota_state.phase = OTA_PHASE_ERROR;
-				return;
-			}
-		}
-
-		/* Signature is last 64 bytes of merged image */
-		int sig_err = ota_verify_signature(ota_page_buf, fw_size,
-						   &ota_page_buf[fw_size]);
-		if (sig_err) {
+		if (!hashing || sig_err ||
+		    delta_read_merged(fw_size, ota_sig_buf, OTA_SIG_SIZE) != 0 ||
+		    ota_verify_finish(ota_sig_buf) != 0) {
 			LOG_ERR("OTA: delta ED25519 signature verification failed");
 			send_complete(OTA_STATUS_SIG_ERR, crc);
 			ota_state.phase = OTA_PHASE_ERROR;
@@ -637,10 +1466,10 @@ static void delta_apply(void)
 	uint32_t total_pages = (ota_state.total_size + OTA_FLASH_PAGE_SIZE - 1) /
 			       OTA_FLASH_PAGE_SIZE;
 	uint8_t *page_buf = ota_page_buf;
+	uint32_t unchanged = 0;
 
-	int err = write_metadata(OTA_META_STATE_APPLYING, ota_state.total_size,
-				 ota_state.expected_crc32, ota_state.app_version,
-				 0, total_pages);
+	int err = journal_begin(ota_state.total_size, ota_state.expected_crc32,
+				ota_state.app_version, total_pages);
 	if (err) {
 		ota_state.phase = OTA_PHASE_ERROR;
 		return;
@@ -654,72 +1483,25 @@ static void delta_apply(void)
 			copy_size = ota_state.total_size - page_offset;
 		}
 
-		/* Read baseline from primary first */
-		err = ota_flash_read(OTA_APP_PRIMARY_ADDR + page_offset,
-				     page_buf, copy_size);
+		/* Baseline from primary with received chunks overlaid */
+		err = delta_read_merged(page_offset, page_buf, copy_size);
 		if (err) {
-			LOG_ERR("OTA: delta baseline read failed page %u: %d",
+			LOG_ERR("OTA: delta merge read failed page %u: %d",
 				page, err);
 			ota_state.phase = OTA_PHASE_ERROR;
 			return;
 		}
 
-		/* Overlay received chunks from staging */
-		uint16_t first_chunk = page_offset / ota_state.chunk_size;
-		uint16_t last_chunk = (page_offset + copy_size - 1) /
-				      ota_state.chunk_size;
-		if (last_chunk >= ota_state.full_image_chunks) {
-			last_chunk = ota_state.full_image_chunks - 1;
-		}
-
-		for (uint16_t ci = first_chunk; ci <= last_chunk; ci++) {
-			if (!delta_chunk_received(ci)) {
-				continue;
-			}
-			/* Chunk start/end within this page */
-			uint32_t chunk_abs = (uint32_t)ci * ota_state.chunk_size;
-			uint32_t start = (chunk_abs > page_offset)
-				? (chunk_abs - page_offset) : 0;
-			uint32_t src_offset = (chunk_abs > page_offset)
-				? 0 : (page_offset - chunk_abs);
-			uint32_t end = ((uint32_t)(ci + 1) * ota_state.chunk_size)
-				       - page_offset;
-			if (end > copy_size) {
-				end = copy_size;
-			}
-			uint16_t len = (uint16_t)(end - start);
-
-			err = ota_flash_read(OTA_STAGING_ADDR + chunk_abs + src_offset,
-					     &page_buf[start], len);
-			if (err) {
-				LOG_ERR("OTA: delta staging read ci=%u: %d",
-					ci, err);
-				ota_state.phase = OTA_PHASE_ERROR;
-				return;
-			}
-		}
-
-		/* Erase primary page and write assembled data */
-		err = ota_flash_erase_pages(OTA_APP_PRIMARY_ADDR + page_offset,
-					    OTA_FLASH_PAGE_SIZE);
-		if (err) {
-			LOG_ERR("OTA: delta primary erase page %u: %d", page, err);
-			ota_state.phase = OTA_PHASE_ERROR;
-			return;
-		}
-
-		err = ota_flash_write(OTA_APP_PRIMARY_ADDR + page_offset,
-				      page_buf, copy_size);
-		if (err) {
-			LOG_ERR("OTA: delta primary write page %u: %d", page, err);
+		/* Erase primary page and write assembled data, unless no
+		 * chunk changed it */
+		err = apply_page(page, page_buf, copy_size);
+		if (err < 0) {
 			ota_state.phase = OTA_PHASE_ERROR;
 			return;
 		}
-
-		write_metadata(OTA_META_STATE_APPLYING, ota_state.total_size,
-			       ota_state.expected_crc32, ota_state.app_version,
-			       page + 1, total_pages);
+		unchanged += err;
 	}
+	LOG_INF("OTA: delta left %u of %u pages unchanged", unchanged, total_pages);
 
 	/* Erase stale pages beyond new image to prevent inflated baselines */
 	erase_stale_app_pages(ota_state.total_size);
@@ -734,11 +1516,45 @@ static void delta_apply(void)
 	}
 
 	LOG_INF("OTA: delta apply complete, rebooting");
-	clear_metadata();
+	journal_finish(ota_state.expected_crc32, total_pages);
+	boot_record_primary(ota_state.total_size, ota_state.expected_crc32,
+			    ota_state.app_version);
 	LOG_PANIC();
 	sys_reboot(SYS_REBOOT_WARM);
 }
 
+/* Direct delta: the received chunks are in the new slot already. Copy
+ * the unchanged ones in from the running slot, a page at a time; a range
+ * that already matches (apply run again after a reset) is left alone. */
+static int delta_fill_slot(void)
+{
+	uint32_t last = ota_state.full_image_chunks - 1;
+	uint32_t offset = 0;
+
+	while (offset < ota_state.total_size) {
+		uint32_t next = delta_next_received(offset / ota_state.chunk_size, last);
+		uint32_t end = MIN(next * ota_state.chunk_size, ota_state.total_size);
+
+		while (offset < end) {
+			uint32_t n = MIN(end - offset, OTA_FLASH_PAGE_SIZE);
+			int err = ota_flash_read(ota_state.base_addr + offset, ota_page_buf, n);
+
+			if (!err && !ota_flash_equals(ota_state.rx_addr + offset,
+						      ota_page_buf, n)) {
+				err = ota_flash_write(ota_state.rx_addr + offset,
+						      ota_page_buf, n);
+			}
+			if (err) {
+				LOG_ERR("OTA: delta fill failed at offset %u: %d", offset, err);
+				return err;
+			}
+			offset += n;
+		}
+		offset = (next + 1) * ota_state.chunk_size;
+	}
+	return 0;
+}
+
 static void ota_deferred_apply_handler(struct k_work *work)
 {
 	if (ota_state.phase != OTA_PHASE_COMPLETE) {
@@ -746,11 +1562,20 @@ static void ota_deferred_apply_handler(struct k_work *work)
 		return;
 	}
 	LOG_INF("OTA: deferred apply firing after %ds delay", OTA_APPLY_DELAY_SEC);
-	if (ota_state.delta_mode) {
+	if (ota_state.delta_mode && !ota_state.slot_direct) {
 		delta_apply();
 	} else {
 		ota_state.phase = OTA_PHASE_APPLYING;
-		int ret = ota_apply();
+		int ret;
+
+		if (!ota_state.slot_direct) {
+			ret = ota_apply();
+		} else {
+			ret = ota_state.delta_mode ? delta_fill_slot() : 0;
+			if (!ret) {
+				ret = ota_activate_slot();
+			}
+		}
 		if (ret) {
 			LOG_ERR("OTA: apply failed: %d", ret);
 			ota_state.phase = OTA_PHASE_ERROR;
@@ -794,15 +1619,29 @@ static void handle_ota_chunk(const uint8_t *data, size_t len)
 
 		if (delta_chunk_received(chunk_idx)) {
 			LOG_WRN("OTA DELTA %u: dup, ACK ok", chunk_idx);
-			send_ack(OTA_STATUS_OK,
-				 ota_state.chunks_received,
-				 ota_state.chunks_received);
+			/* A resend means the sender lost track: answer at once,
+			 * with the bitmap around it when it takes one */
+			if (ota_state.ack_every) {
+				send_ack_bitmap(chunk_idx);
+			} else {
+				send_ack(OTA_STATUS_OK,
+					 ota_state.chunks_received,
+					 ota_state.chunks_received);
+			}
 			return;
 		}
 
-		uint32_t write_addr = OTA_STAGING_ADDR +
+		uint32_t write_addr = ota_state.rx_addr +
 				      (uint32_t)chunk_idx * ota_state.chunk_size;
-		int err = ota_flash_write(write_addr, chunk_data, data_len);
+		int err = 0;
+
+		/* Resumed session: a chunk staged after the last checkpoint
+		 * may already be on flash */
+		if (!ota_state.rx_verify ||
+		    !ota_flash_equals(write_addr, chunk_data, data_len)) {
+			err = ota_flash_writer_put(&ota_stage_writer, write_addr,
+						   chunk_data, data_len);
+		}
 		if (err) {
 			LOG_ERR("OTA DELTA %u: flash write err %d",
 				chunk_idx, err);
@@ -812,8 +1651,7 @@ static void handle_ota_chunk(const uint8_t *data, size_t len)
 			return;
 		}
 
-		ota_state.delta_received[chunk_idx / 8] |=
-			(1u << (chunk_idx % 8));
+		delta_mark_received(chunk_idx);
 		ota_state.chunks_received++;
 		ota_state.bytes_written += data_len;
 
@@ -824,9 +1662,21 @@ static void handle_ota_chunk(const uint8_t *data, size_t len)
 		if (ota_state.chunks_received >= ota_state.total_chunks) {
 			ota_validate_and_apply();
 		} else {
-			send_ack(OTA_STATUS_OK,
-				 ota_state.chunks_received,
-				 ota_state.chunks_received);
+			if (ota_state.chunks_received % OTA_RX_CHECKPOINT_CHUNKS == 0) {
+				rx_checkpoint();
+			}
+			if (!ota_state.ack_every) {
+				send_ack(OTA_STATUS_OK,
+					 ota_state.chunks_received,
+					 ota_state.chunks_received);
+			} else {
+				if (ota_state.ack_pending == 0 || chunk_idx < ota_state.ack_lo) {
+					ota_state.ack_lo = chunk_idx;
+				}
+				if (++ota_state.ack_pending >= ota_state.ack_every) {
+					send_ack_bitmap(ota_state.ack_lo);
+				}
+			}
 		}
 		return;
 	}
@@ -848,12 +1698,57 @@ static void handle_ota_chunk(const uint8_t *data, size_t len)
 		return;
 	}
 
+	/* Patch and compressed modes: the chunk is encoded stream, decoded
+	 * into staging as it arrives */
+	if (ota_state.patch_mode || ota_state.compressed) {
+		int err = ota_state.patch_mode
+			? ota_patch_feed(&ota_patch, chunk_data, data_len)
+			: ota_lz_feed(&ota_lz, chunk_data, data_len);
+		if (err == -EINVAL || err == -EBADMSG) {
+			LOG_ERR("OTA %s %u: %s", OTA_STREAM_NAME, chunk_idx,
+				err == -EINVAL ? "base image mismatch" : "malformed");
+			send_ack(OTA_STATUS_PATCH_ERR, chunk_idx, ota_state.chunks_received);
+			ota_state.phase = OTA_PHASE_ERROR;
+			return;
+		}
+		if (err) {
+			LOG_ERR("OTA %s %u: flash error %d", OTA_STREAM_NAME, chunk_idx, err);
+			send_ack(OTA_STATUS_FLASH_ERR, chunk_idx, ota_state.chunks_received);
+			ota_state.phase = OTA_PHASE_ERROR;
+			return;
+		}
+
+		ota_state.chunks_received++;
+		ota_state.bytes_written += data_len;
+		LOG_INF("OTA %s %u/%u: image %u/%u bytes", OTA_STREAM_NAME,
+			chunk_idx + 1, ota_state.total_chunks,
+			OTA_STREAM_OUT_LEN, ota_state.total_size);
+
+		if (ota_state.chunks_received < ota_state.total_chunks) {
+			send_ack(OTA_STATUS_OK, ota_state.chunks_received,
+				 ota_state.chunks_received);
+			return;
+		}
+		err = ota_state.patch_mode ? ota_patch_finish(&ota_patch)
+					   : ota_lz_finish(&ota_lz);
+		if (err) {
+			LOG_ERR("OTA: %s stream ended at %u of %u image bytes (%d)",
+				OTA_STREAM_NAME, OTA_STREAM_OUT_LEN,
+				ota_state.total_size, err);
+			send_complete(err == -EBADMSG ? OTA_STATUS_PATCH_ERR
+						      : OTA_STATUS_FLASH_ERR, 0);
+			ota_state.phase = OTA_PHASE_ERROR;
+			return;
+		}
+		ota_validate_and_apply();
+		return;
+	}
+
 	/* Write to staging */
-	uint32_t write_addr = OTA_STAGING_ADDR + ota_state.bytes_written;
-	int err = ota_flash_write(write_addr, chunk_data, data_len);
+	int err = stage_sink(NULL, chunk_data, data_len);
 	if (err) {
 		LOG_ERR("OTA CHUNK %u: flash write failed at 0x%08x: %d",
-			chunk_idx, write_addr, err);
+			chunk_idx, ota_state.rx_addr + ota_state.staged_len, err);
 		send_ack(OTA_STATUS_FLASH_ERR, chunk_idx, ota_state.chunks_received);
 		return;
 	}
@@ -861,9 +1756,8 @@ static void handle_ota_chunk(const uint8_t *data, size_t len)
 	ota_state.chunks_received++;
 	ota_state.bytes_written += data_len;
 
-	LOG_INF("OTA CHUNK %u/%u: %u bytes at 0x%08x (total %u/%u)",
-		chunk_idx + 1, ota_state.total_chunks,
-		data_len, write_addr,
+	LOG_INF("OTA CHUNK %u/%u: %u bytes (total %u/%u)",
+		chunk_idx + 1, ota_state.total_chunks, data_len,
 		ota_state.bytes_written, ota_state.total_size);
 
 	/* Check if this was the last chunk */
@@ -874,11 +1768,15 @@ static void handle_ota_chunk(const uint8_t *data, size_t len)
 				ota_state.bytes_written, ota_state.total_size);
 			send_complete(OTA_STATUS_SIZE_ERR, 0);
 			ota_state.phase = OTA_PHASE_ERROR;
+			rx_retire();
 			return;
 		}
 
 		ota_validate_and_apply();
 	} else {
+		if (ota_state.chunks_received % OTA_RX_CHECKPOINT_CHUNKS == 0) {
+			rx_checkpoint();
+		}
 		/* ACK with next expected chunk */
 		send_ack(OTA_STATUS_OK, ota_state.chunks_received, ota_state.chunks_received);
 	}
@@ -888,6 +1786,7 @@ static void handle_ota_abort(void)
 {
 	k_work_cancel_delayable(&ota_deferred_apply_work);
 	LOG_WRN("OTA: abort received");
+	rx_retire();
 	ota_state.phase = OTA_PHASE_IDLE;
 	memset(&ota_state, 0, sizeof(ota_state));
 }
@@ -927,6 +1826,10 @@ bool ota_boot_recovery_check(void)
 	}
 
 	if (meta.state == OTA_META_STATE_APPLYING) {
+		journal_scan(&meta);
+	}
+
+	if (meta.state == OTA_META_STATE_APPLYING && !ota_journal_done) {
 		LOG_WRN("OTA: detected interrupted apply, resuming...");
 		ota_state.total_size = meta.image_size;
 		ota_state.expected_crc32 = meta.image_crc32;
@@ -942,6 +1845,13 @@ bool ota_boot_recovery_check(void)
 		clear_metadata();
 	}
 
+	if (meta.state == OTA_META_STATE_APPLYING &&
+	    (!journal_caches_primary(&meta) || !primary_cache_matches(&meta))) {
+		/* Primary was rewritten outside OTA (debugger flash) */
+		LOG_WRN("OTA: primary no longer matches cached CRCs, dropping cache");
+		clear_metadata();
+	}
+
 	return false;
 }
 
@@ -982,6 +1892,7 @@ void ota_abort(void)
 		LOG_WRN("OTA: manually aborted (was in phase %s)",
 			ota_phase_str(ota_state.phase));
 	}
+	rx_retire();
 	ota_state.phase = OTA_PHASE_IDLE;
 	memset(&ota_state, 0, sizeof(ota_state));
 }
@@ -1029,7 +1940,10 @@ void ota_test_delta_setup(uint16_t chunk_size, uint16_t total_delta_chunks,
 	 * After calling this, use pyOCD to write changed chunks to staging,
 	 * then call ota_test_delta_mark_chunk() for each, then ota_test_delta(). */
 	memset(&ota_state, 0, sizeof(ota_state));
+	ota_flash_writer_init(&ota_stage_writer);
 	ota_state.phase = OTA_PHASE_RECEIVING;
+	ota_state.rx_addr = OTA_STAGING_ADDR;
+	ota_state.base_addr = OTA_APP_PRIMARY_ADDR;
 	ota_state.delta_mode = true;
 	ota_state.chunk_size = chunk_size;
 	ota_state.total_chunks = total_delta_chunks;
@@ -1042,9 +1956,8 @@ void ota_test_delta_setup(uint16_t chunk_size, uint16_t total_delta_chunks,
 
 void ota_test_delta_mark_chunk(uint16_t abs_chunk_idx)
 {
-	if (abs_chunk_idx < sizeof(ota_state.delta_received) * 8) {
-		ota_state.delta_received[abs_chunk_idx / 8] |=
-			(1u << (abs_chunk_idx % 8));
+	if (abs_chunk_idx < OTA_DELTA_MAX_CHUNKS) {
+		delta_mark_received(abs_chunk_idx);
 		ota_state.chunks_received++;
 	}
 }
@@ -6,9 +6,13 @@
  */
 
 #include <platform_api.h>
+#include <adc_sampler.h>
+#include <gpio_edge.h>
+#include <led_pattern.h>
 #include <sidewalk.h>
 #include <tx_state.h>
 #include <app_leds.h>
+#include <event_log.h>
 #include <sid_hal_memory_ifc.h>
 #include <sid_pal_mfg_store_ifc.h>
 
@@ -18,6 +22,8 @@
 #include <zephyr/drivers/adc.h>
 #include <hal/nrf_saadc.h>
 #include <zephyr/drivers/gpio.h>
+#include <nrfx_pwm.h>
+#include <hal/nrf_gpio.h>
 #include <zephyr/sys/reboot.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/logging/log_ctrl.h>
@@ -31,6 +37,7 @@ LOG_MODULE_REGISTER(platform_api, CONFIG_SIDEWALK_LOG_LEVEL);
  * physical pin assignment. */
 #define GPIO_PIN_0   0   /* output: charge block relay */
 #define GPIO_PIN_2   2   /* input: cool call */
+#define GPIO_PIN_3   3   /* input: Charge Now button (production PCB only) */
 
 /* ------------------------------------------------------------------ */
 /*  ADC hardware                                                       */
@@ -41,23 +48,29 @@ LOG_MODULE_REGISTER(platform_api, CONFIG_SIDEWALK_LOG_LEVEL);
 
 #define PLATFORM_HAS_ADC 1
 
+#define PLATFORM_ADC_SPEC(node, prop, idx) ADC_DT_SPEC_GET_BY_IDX(node, idx),
+
+/* In io-channels order: 0 = J1772 pilot, 1 = current clamp (when fitted).
+ * Every channel listed joins the same scan. */
 static const struct adc_dt_spec platform_adc_channels[] = {
-	ADC_DT_SPEC_GET_BY_IDX(DT_PATH(zephyr_user), 0),
+	DT_FOREACH_PROP_ELEM(DT_PATH(zephyr_user), io_channels, PLATFORM_ADC_SPEC)
 };
 #define PLATFORM_ADC_CHANNEL_COUNT ARRAY_SIZE(platform_adc_channels)
+BUILD_ASSERT(PLATFORM_ADC_CHANNEL_COUNT <= ADC_SAMPLER_MAX_CHANNELS, "ADC channels");
 
 static bool adc_initialized;
 
 static int platform_adc_init(void)
 {
+	if (adc_initialized) {
+		return 0;
+	}
+
 	/* nRF52840 SAADC errata workaround: the analog mux can latch pins
 	 * to ground across reboot cycles. Force-disable the peripheral to
-	 * release any latched pins before re-initializing. */
+	 * release any latched pins before the first channel setup. */
 	nrf_saadc_disable(NRF_SAADC);
 
-	if (adc_initialized) {
-		return 0;
-	}
 	for (size_t i = 0; i < PLATFORM_ADC_CHANNEL_COUNT; i++) {
 		if (!adc_is_ready_dt(&platform_adc_channels[i])) {
 			LOG_ERR("ADC ch %zu not ready", i);
@@ -72,9 +85,123 @@ static int platform_adc_init(void)
 	adc_initialized = true;
 	return 0;
 }
+
+static int platform_adc_raw_to_mv(size_t i, int16_t raw)
+{
+	int32_t val_mv = raw;
+
+	if (adc_raw_to_millivolts_dt(&platform_adc_channels[i], &val_mv) < 0) {
+		/* Fallback: gain 1/6, internal ref 0.6V → 3.6V full scale, 12-bit */
+		val_mv = (raw * 3600) / 4096;
+	}
+	return (int)val_mv;
+}
+
+/* Continuous scan: every ADC_SAMPLER_PERIOD_MS a timer queues one
+ * sequence over every channel, ADC_SAMPLER_BURST samplings long and paced
+ * by the ADC driver's interval timer. The driver disables the SAADC
+ * between scans. The callback runs in the SAADC ISR after each sampling;
+ * once the burst is complete it converts the buffer into the sampler.
+ * Samples land in channel_id order, which io-channels follows.
+ *
+ * Not one endless sequence repeated with ADC_ACTION_REPEAT into
+ * alternating buffers: the driver paces every sampling of a sequence
+ * at the one interval_us, so a continuous scan would sample every 62 us
+ * around the clock to keep the burst inside one PWM period. The burst
+ * leaves the ADC idle between scans; the sampler's two banks give the
+ * readers the double buffering. */
+static int16_t scan_buf[ADC_SAMPLER_BURST][PLATFORM_ADC_CHANNEL_COUNT];
+
+static enum adc_action scan_done(const struct device *dev,
+				 const struct adc_sequence *seq, uint16_t index)
+{
+	int32_t mv[ADC_SAMPLER_BURST * PLATFORM_ADC_CHANNEL_COUNT];
+
+	ARG_UNUSED(dev); ARG_UNUSED(seq);
+	if (index + 1 < ADC_SAMPLER_BURST) {
+		return ADC_ACTION_CONTINUE;
+	}
+	for (size_t s = 0; s < ADC_SAMPLER_BURST; s++) {
+		for (size_t i = 0; i < PLATFORM_ADC_CHANNEL_COUNT; i++) {
+			mv[s * PLATFORM_ADC_CHANNEL_COUNT + i] =
+				platform_adc_raw_to_mv(i, scan_buf[s][i]);
+		}
+	}
+	adc_sampler_publish_burst(mv, ADC_SAMPLER_BURST, k_uptime_get_32());
+	return ADC_ACTION_FINISH;
+}
+
+static const struct adc_sequence_options scan_options = {
+	.interval_us = ADC_SAMPLER_BURST_GAP_US,
+	.callback = scan_done,
+	.extra_samplings = ADC_SAMPLER_BURST - 1,
+};
+
+static struct adc_sequence scan_seq = {
+	.options = &scan_options,
+	.buffer = scan_buf,
+	.buffer_size = sizeof(scan_buf),
+};
+
+/* adc_read_async() takes the ADC lock, so bursts start from the system
+ * work queue rather than the timer ISR */
+static void scan_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+	int err = adc_read_async(platform_adc_channels[0].dev, &scan_seq, NULL);
+
+	if (err) {
+		LOG_WRN("ADC scan start err %d", err);
+	}
+}
+
+static K_WORK_DEFINE(scan_work, scan_work_handler);
+
+static void scan_timer_expiry(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+	k_work_submit(&scan_work);
+}
+
+static K_TIMER_DEFINE(scan_timer, scan_timer_expiry, NULL);
+
+int platform_adc_start(void)
+{
+	int err = platform_adc_init();
+	if (err) {
+		return err;
+	}
+
+	err = adc_sequence_init_dt(&platform_adc_channels[0], &scan_seq);
+	for (size_t i = 1; !err && i < PLATFORM_ADC_CHANNEL_COUNT; i++) {
+		if (platform_adc_channels[i].dev != platform_adc_channels[0].dev) {
+			err = -EINVAL;
+			break;
+		}
+		scan_seq.channels |= BIT(platform_adc_channels[i].channel_id);
+	}
+	if (!err) {
+		adc_sampler_init(PLATFORM_ADC_CHANNEL_COUNT, ADC_SAMPLER_FILTER_SHIFT);
+		err = adc_read_async(platform_adc_channels[0].dev, &scan_seq, NULL);
+	}
+	if (!err) {
+		k_timer_start(&scan_timer, K_MSEC(ADC_SAMPLER_PERIOD_MS),
+			      K_MSEC(ADC_SAMPLER_PERIOD_MS));
+	}
+	if (err) {
+		adc_sampler_init(0, 0);
+		LOG_ERR("ADC scan not started (%d), reads stay blocking", err);
+		return err;
+	}
+	LOG_INF("ADC scan: %u channels x %u samplings every %u ms",
+		(unsigned)PLATFORM_ADC_CHANNEL_COUNT, ADC_SAMPLER_BURST,
+		ADC_SAMPLER_PERIOD_MS);
+	return 0;
+}
 #else
 #define PLATFORM_HAS_ADC 0
 static int platform_adc_init(void) { return -ENODEV; }
+int platform_adc_start(void) { return -ENODEV; }
 #endif
 
 /* ------------------------------------------------------------------ */
@@ -89,8 +216,25 @@ static const struct gpio_dt_spec charge_block_gpio =
 static const struct gpio_dt_spec cool_call_gpio =
 	GPIO_DT_SPEC_GET(COOL_CALL_NODE, gpios);
 
+/* Not on the RAK19007 J11 header; boards that fit it label it charge_now_button */
+static const struct gpio_dt_spec charge_now_button_gpio =
+	GPIO_DT_SPEC_GET_OR(DT_NODELABEL(charge_now_button), gpios, {0});
+
 static bool gpio_initialized;
 
+/* Input pins by abstract index, NULL for outputs and unknown indices */
+static const struct gpio_dt_spec *gpio_input_spec(int pin_index)
+{
+	switch (pin_index) {
+	case GPIO_PIN_2:
+		return &cool_call_gpio;
+	case GPIO_PIN_3:
+		return &charge_now_button_gpio;
+	default:
+		return NULL;
+	}
+}
+
 static int platform_gpio_init(void)
 {
 	if (gpio_initialized) {
@@ -117,6 +261,16 @@ static int platform_gpio_init(void)
 		}
 	}
 
+	/* Charge Now button input */
+	if (gpio_is_ready_dt(&charge_now_button_gpio)) {
+		int err = gpio_pin_configure_dt(&charge_now_button_gpio, GPIO_INPUT);
+		if (err < 0) {
+			LOG_ERR("charge_now_button GPIO config err %d", err);
+			return err;
+		}
+	}
+
+	gpio_edge_init();
 	gpio_initialized = true;
 	return 0;
 }
@@ -133,25 +287,50 @@ static void platform_send_msg_free(void *ctx)
 	if (!sid_msg) {
 		return;
 	}
-	if (sid_msg->msg.data) {
+	if (sid_msg->msg.data && sid_msg->msg.data != sid_msg->inline_data) {
 		sid_hal_free(sid_msg->msg.data);
 	}
-	sid_hal_free(sid_msg);
+	msg_pool_free(&sidewalk_msg_pool, sid_msg);
 }
 
-static int platform_send_msg(const uint8_t *data, size_t len)
+BUILD_ASSERT(PLATFORM_SEND_NOBUFS == -ENOBUFS, "send_msg backpressure code");
+
+/* App-visible msg_id for each uplink (API v5); never 0, which the send
+ * callbacks use for "no id" */
+static atomic_t send_token;
+
+/* 1..INT32_MAX, then back to 1. The app and the OTA path send
+ * concurrently, so the wrap is a CAS: no token is handed out twice or
+ * skipped. */
+static uint32_t send_token_next(void)
+{
+	atomic_val_t old, next;
+
+	do {
+		old = atomic_get(&send_token);
+		next = (old <= 0 || old >= INT32_MAX) ? 1 : old + 1;
+	} while (!atomic_cas(&send_token, old, next));
+	return (uint32_t)next;
+}
+
+static int send_msg_class(const uint8_t *data, size_t len, enum sidewalk_evq_class cls,
+			  bool app)
 {
-	sidewalk_msg_t *sid_msg = sid_hal_malloc(sizeof(sidewalk_msg_t));
+	sidewalk_msg_t *sid_msg = msg_pool_alloc(&sidewalk_msg_pool);
 	if (!sid_msg) {
-		return -ENOMEM;
+		return PLATFORM_SEND_NOBUFS;
 	}
 	memset(sid_msg, 0, sizeof(*sid_msg));
 
 	sid_msg->msg.size = len;
-	sid_msg->msg.data = sid_hal_malloc(len);
-	if (!sid_msg->msg.data) {
-		sid_hal_free(sid_msg);
-		return -ENOMEM;
+	if (len <= sizeof(sid_msg->inline_data)) {
+		sid_msg->msg.data = sid_msg->inline_data;
+	} else {
+		sid_msg->msg.data = sid_hal_malloc(len);
+		if (!sid_msg->msg.data) {
+			msg_pool_free(&sidewalk_msg_pool, sid_msg);
+			return -ENOMEM;
+		}
 	}
 	memcpy(sid_msg->msg.data, data, len);
 
@@ -163,17 +342,32 @@ static int platform_send_msg(const uint8_t *data, size_t len)
 	sid_msg->desc.msg_desc_attr.tx_attr.num_retries = 3;
 	sid_msg->desc.msg_desc_attr.tx_attr.request_ack = true;
 
+	uint32_t token = send_token_next();
+	sid_msg->token = token;
+	sid_msg->app = app;
+
 	if (link_mask & SID_LINK_TYPE_1) {
 		sidewalk_event_send(sidewalk_event_connect, NULL, NULL);
 	}
 
-	int err = sidewalk_event_send(sidewalk_event_send_msg, sid_msg,
-				      platform_send_msg_free);
+	int err = sidewalk_event_send_class(cls, sidewalk_event_send_msg, sid_msg,
+					    platform_send_msg_free);
 	if (err) {
 		platform_send_msg_free(sid_msg);
 		return -EIO;
 	}
-	return 0;
+	return (int)token;
+}
+
+static int platform_send_msg(const uint8_t *data, size_t len)
+{
+	return send_msg_class(data, len, SIDEWALK_EVQ_UPLINK, true);
+}
+
+/* OTA ACKs and status go ahead of queued app uplinks */
+int platform_send_ota_msg(const uint8_t *data, size_t len)
+{
+	return send_msg_class(data, len, SIDEWALK_EVQ_CONTROL, false);
 }
 
 static bool platform_is_ready(void)
@@ -194,11 +388,84 @@ static int platform_set_link_mask(uint32_t mask)
 	return 0;
 }
 
+/* --- LED patterns --- */
+
+/* The green LED (led0) plays patterns from PWM1. While the PWM runs it
+ * owns the pin; releasing it hands the pin back to the DK library's
+ * GPIO (uninit leaves it a disconnected input, so make it an output
+ * again). */
+#define LED_PATTERN_ID   0
+#define LED_PATTERN_PIN  NRF_DT_GPIOS_TO_PSEL(DT_ALIAS(led0), gpios)
+
+static const nrfx_pwm_t led_pwm = NRFX_PWM_INSTANCE(1);
+static struct led_pattern_seq led_seq;  /* EasyDMA reads it during playback */
+static bool led_pwm_active;
+
+static void led_pattern_release(void)
+{
+	if (led_pwm_active) {
+		nrfx_pwm_stop(&led_pwm, true);
+		nrfx_pwm_uninit(&led_pwm);
+		nrf_gpio_cfg_output(LED_PATTERN_PIN);
+		led_pwm_active = false;
+	}
+}
+
+static int platform_led_pattern(int led_id, const struct platform_led_step *steps,
+				size_t count, uint8_t repeat)
+{
+	if (led_id < 0 || led_id >= LED_ID_LAST) {
+		return -EINVAL;
+	}
+	if (led_id != LED_PATTERN_ID) {
+		return -ENODEV;
+	}
+
+	if (led_pwm_active) {
+		nrfx_pwm_stop(&led_pwm, true);
+	} else {
+		nrfx_pwm_config_t cfg = NRFX_PWM_DEFAULT_CONFIG(LED_PATTERN_PIN,
+				NRF_PWM_PIN_NOT_CONNECTED, NRF_PWM_PIN_NOT_CONNECTED,
+				NRF_PWM_PIN_NOT_CONNECTED);
+
+		cfg.base_clock = NRF_PWM_CLK_125kHz;
+		cfg.count_mode = NRF_PWM_MODE_UP;
+		cfg.top_value = LED_PATTERN_COUNTERTOP;
+		cfg.load_mode = NRF_PWM_LOAD_COMMON;
+		cfg.step_mode = NRF_PWM_STEP_AUTO;
+		if (nrfx_pwm_init(&led_pwm, &cfg, NULL, NULL) != NRFX_SUCCESS) {
+			LOG_ERR("LED pattern PWM init failed");
+			return -ENODEV;
+		}
+		led_pwm_active = true;
+	}
+
+	/* Built only once the old playback has stopped reading led_seq */
+	int err = led_pattern_build(steps, count, &led_seq);
+	if (err) {
+		led_pattern_release();
+		return err;
+	}
+
+	nrf_pwm_sequence_t seq = {
+		.values.p_common = led_seq.values,
+		.length = led_seq.length,
+		.repeats = led_seq.refresh,
+		.end_delay = 0,
+	};
+	nrfx_pwm_simple_playback(&led_pwm, &seq, repeat ? repeat : 1,
+				 repeat ? NRFX_PWM_FLAG_STOP : NRFX_PWM_FLAG_LOOP);
+	return 0;
+}
+
 static void platform_led_set(int led_id, bool on)
 {
 	if (led_id < 0 || led_id >= LED_ID_LAST) {
 		return;
 	}
+	if (led_id == LED_PATTERN_ID) {
+		led_pattern_release();
+	}
 	if (on) {
 		app_led_turn_on((leds_id_t)led_id);
 	} else {
@@ -213,9 +480,36 @@ static int platform_factory_reset(void)
 
 /* --- Hardware --- */
 
+static int platform_adc_get_mv(int channel, uint32_t *sample_ms)
+{
+	if (!adc_sampler_running()) {
+		return -ENODEV;
+	}
+	return adc_sampler_get(channel, k_uptime_get_32(), sample_ms);
+}
+
+BUILD_ASSERT(PLATFORM_ADC_NO_SAMPLE == -EAGAIN, "adc_get_mv no-sample code");
+
+static int platform_adc_get_burst(int channel, int16_t *mv, size_t max,
+				  uint32_t *sample_ms)
+{
+	if (!adc_sampler_running()) {
+		return -ENODEV;
+	}
+	return adc_sampler_get_burst(channel, k_uptime_get_32(), mv, max, sample_ms);
+}
+
 static int platform_adc_read_mv(int channel)
 {
 #if PLATFORM_HAS_ADC
+	/* The scan holds the ADC for as long as it runs: serve the cached
+	 * value. On-demand conversion is only left for when it never started. */
+	if (adc_sampler_running()) {
+		int mv = adc_sampler_get(channel, k_uptime_get_32(), NULL);
+
+		return mv == -EAGAIN ? -EBUSY : mv;
+	}
+
 	int err = platform_adc_init();
 	if (err) {
 		return err;
@@ -240,13 +534,7 @@ static int platform_adc_read_mv(int channel)
 		return err;
 	}
 
-	int32_t val_mv = buf;
-	err = adc_raw_to_millivolts_dt(&platform_adc_channels[channel], &val_mv);
-	if (err < 0) {
-		/* Fallback: gain 1/6, internal ref 0.6V → 3.6V full scale, 12-bit */
-		val_mv = (buf * 3600) / 4096;
-	}
-	return (int)val_mv;
+	return platform_adc_raw_to_mv(channel, buf);
 #else
 	return -ENODEV;
 #endif
@@ -259,20 +547,22 @@ static int platform_gpio_get(int pin_index)
 		return err;
 	}
 
-	switch (pin_index) {
-	case GPIO_PIN_0:
+	if (pin_index == GPIO_PIN_0) {
 		if (!gpio_is_ready_dt(&charge_block_gpio)) {
 			return -ENODEV;
 		}
 		return gpio_pin_get_dt(&charge_block_gpio);
-	case GPIO_PIN_2:
-		if (!gpio_is_ready_dt(&cool_call_gpio)) {
-			return -ENODEV;
-		}
-		return gpio_pin_get_dt(&cool_call_gpio);
-	default:
+	}
+
+	const struct gpio_dt_spec *spec = gpio_input_spec(pin_index);
+
+	if (!spec) {
 		return -EINVAL;
 	}
+	if (!gpio_is_ready_dt(spec)) {
+		return -ENODEV;
+	}
+	return gpio_pin_get_dt(spec);
 }
 
 static int platform_gpio_set(int pin_index, int val)
@@ -293,6 +583,105 @@ static int platform_gpio_set(int pin_index, int val)
 	}
 }
 
+/* --- GPIO edges --- */
+
+/* Delivers a batch to the app's on_gpio_edges — implemented in app.c,
+ * which owns the app callback table */
+extern void app_notify_gpio_edges(const struct platform_gpio_edge *edges, size_t count);
+
+static struct gpio_callback edge_callbacks[GPIO_EDGE_MAX_PINS];
+static struct k_spinlock edge_lock;
+
+static void edge_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(edge_work, edge_work_handler);
+
+/* System work queue, like the app timer: on_gpio_edges never runs
+ * alongside on_timer */
+static void edge_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+	struct platform_gpio_edge batch[GPIO_EDGE_QUEUE];
+	size_t n;
+
+	k_spinlock_key_t key = k_spin_lock(&edge_lock);
+	uint32_t next_ms = gpio_edge_collect(k_uptime_get_32(), batch, ARRAY_SIZE(batch), &n);
+	k_spin_unlock(&edge_lock, key);
+
+	if (n) {
+		app_notify_gpio_edges(batch, n);
+	}
+	if (next_ms) {
+		k_work_schedule(&edge_work, K_MSEC(next_ms));
+	}
+}
+
+static void edge_isr(const struct device *port, struct gpio_callback *cb,
+		     gpio_port_pins_t pins)
+{
+	ARG_UNUSED(port);
+	ARG_UNUSED(pins);
+	int pin = (int)(cb - edge_callbacks);
+	int level = gpio_pin_get_dt(gpio_input_spec(pin));
+
+	if (level < 0) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&edge_lock);
+	uint32_t settle_ms = gpio_edge_isr(pin, level, k_uptime_get_32());
+	k_spin_unlock(&edge_lock, key);
+
+	/* Keep an earlier pending collect; the handler re-arms for the rest */
+	if (settle_ms && (!k_work_delayable_is_pending(&edge_work) ||
+			  k_ticks_to_ms_ceil32(k_work_delayable_remaining_get(&edge_work)) >
+			  settle_ms)) {
+		k_work_reschedule(&edge_work, K_MSEC(settle_ms));
+	}
+}
+
+static int platform_gpio_subscribe(int pin_index, uint32_t debounce_ms)
+{
+	int err = platform_gpio_init();
+	if (err) {
+		return err;
+	}
+
+	const struct gpio_dt_spec *spec = gpio_input_spec(pin_index);
+
+	if (!spec || debounce_ms > GPIO_EDGE_DEBOUNCE_MAX_MS) {
+		return -EINVAL;
+	}
+	if (!gpio_is_ready_dt(spec)) {
+		return -ENODEV;
+	}
+
+	bool first = !gpio_edge_subscribed(pin_index);
+
+	if (first) {
+		/* Edges before gpio_edge_subscribe() are ignored; the level read
+		 * after it is where the pin starts */
+		gpio_init_callback(&edge_callbacks[pin_index], edge_isr, BIT(spec->pin));
+		err = gpio_add_callback_dt(spec, &edge_callbacks[pin_index]);
+		if (!err) {
+			err = gpio_pin_interrupt_configure_dt(spec, GPIO_INT_EDGE_BOTH);
+		}
+		if (err) {
+			LOG_ERR("GPIO %d edge interrupt err %d", pin_index, err);
+			return err;
+		}
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&edge_lock);
+	int level = gpio_pin_get_dt(spec);
+	gpio_edge_subscribe(pin_index, level > 0, debounce_ms);
+	k_spin_unlock(&edge_lock, key);
+
+	if (first) {
+		LOG_INF("GPIO %d: edge interrupts, %u ms debounce", pin_index, debounce_ms);
+	}
+	return 0;
+}
+
 /* --- System --- */
 
 static uint32_t platform_uptime_ms(void)
@@ -447,4 +836,19 @@ const struct platform_api platform_api_table = {
 	/* MFG */
 	.mfg_get_version = platform_mfg_get_version,
 	.mfg_get_dev_id  = platform_mfg_get_dev_id,
+
+	/* Persistent record log */
+	.log_append      = event_log_append,
+	.log_read        = event_log_read,
+	.log_trim        = event_log_trim,
+
+	/* Cached ADC */
+	.adc_get_mv      = platform_adc_get_mv,
+	.adc_get_burst   = platform_adc_get_burst,
+
+	/* GPIO edges */
+	.gpio_subscribe  = platform_gpio_subscribe,
+
+	/* LED patterns */
+	.led_pattern     = platform_led_pattern,
 };
@@ -12,6 +12,10 @@
 #include <tx_state.h>
 #include <sidewalk.h>
 #include <ota_update.h>
+#include <sidewalk_dispatch.h>
+#include <msg_track.h>
+#include <adc_sampler.h>
+#include <gpio_edge.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/shell/shell.h>
@@ -135,6 +139,13 @@ static int cmd_sid_status(const struct shell *sh, size_t argc, char **argv)
 		}
 	}
 
+	struct msg_track_stats track;
+	msg_track_stats(&track);
+	shell_print(sh, "  Uplink ids: %u/%u tracked, high-water %u, evicted %u, untracked %u",
+		    track.in_use, MSG_TRACK_SLOTS, track.high_water, track.evicted,
+		    track.untracked);
+	shell_print(sh, "  Send results: %u dropped", sidewalk_dispatch_results_dropped());
+
 	switch (init.state) {
 	case SID_INIT_NOT_STARTED:
 		shell_warn(sh, "  -> Init never ran.");
@@ -162,6 +173,36 @@ static int cmd_sid_status(const struct shell *sh, size_t argc, char **argv)
 		}
 		break;
 	}
+
+	struct msg_pool_stats msgs, status;
+	msg_pool_stats(&sidewalk_msg_pool, &msgs);
+	msg_pool_stats(&sidewalk_status_pool, &status);
+	shell_print(sh, "  Msg pool: %u/%u in use, high-water %u, exhausted %u",
+		    msgs.in_use, msgs.slots, msgs.high_water, msgs.exhausted);
+	shell_print(sh, "  Status pool: %u/%u in use, high-water %u, exhausted %u",
+		    status.in_use, status.slots, status.high_water, status.exhausted);
+
+	struct sidewalk_evq_stats evq;
+	sidewalk_event_queue_stats(&evq);
+	shell_print(sh, "  Event queue: %u queued, high-water %u, coalesced %u",
+		    evq.depth, evq.high_water, evq.coalesced);
+	shell_print(sh, "  Event drops: radio %u, control %u, uplink %u",
+		    evq.dropped[SIDEWALK_EVQ_RADIO], evq.dropped[SIDEWALK_EVQ_CONTROL],
+		    evq.dropped[SIDEWALK_EVQ_UPLINK]);
+
+	struct adc_sampler_stats adc;
+	adc_sampler_stats(&adc);
+	if (adc_sampler_running()) {
+		shell_print(sh, "  ADC scan: %u scans, last %u ms ago, %u read retries",
+			    adc.scans, k_uptime_get_32() - adc.last_ms, adc.retries);
+	} else {
+		shell_print(sh, "  ADC scan: not running (blocking reads)");
+	}
+
+	struct gpio_edge_stats edges;
+	gpio_edge_stats(&edges);
+	shell_print(sh, "  GPIO edges: %u interrupts, %u delivered, %u bounces, %u dropped",
+		    edges.edges, edges.delivered, edges.bounces, edges.dropped);
 	return 0;
 }
 
@@ -13,10 +13,26 @@ LOG_MODULE_REGISTER(sidewalk_app, CONFIG_SIDEWALK_LOG_LEVEL);
 static struct k_thread sid_thread;
 K_THREAD_STACK_DEFINE(sid_thread_stack, CONFIG_SIDEWALK_THREAD_STACK_SIZE);
 
-K_MSGQ_DEFINE(sidewalk_thread_msgq, sizeof(sidewalk_ctx_event_t), CONFIG_SIDEWALK_THREAD_QUEUE_SIZE,
-	      4);
+static struct sidewalk_evq event_queue;
+static struct k_spinlock event_queue_lock;
+K_SEM_DEFINE(event_queue_sem, 0, 1);
+
+MSG_POOL_DEFINE(sidewalk_msg_pool, sidewalk_msg_t, SIDEWALK_MSG_POOL_SLOTS);
+MSG_POOL_DEFINE(sidewalk_status_pool, struct sid_status, SIDEWALK_STATUS_POOL_SLOTS);
+
+/* Uplinks hit pool backpressure (-ENOBUFS) before the queue drops them */
+BUILD_ASSERT(SIDEWALK_MSG_POOL_SLOTS <= SIDEWALK_EVQ_DEPTH);
 
 K_SEM_DEFINE(sid_thread_started, 0, 1);
+
+static bool event_queue_pop(sidewalk_ctx_event_t *event)
+{
+	k_spinlock_key_t key = k_spin_lock(&event_queue_lock);
+	bool found = sidewalk_evq_pop(&event_queue, event);
+	k_spin_unlock(&event_queue_lock, key);
+	return found;
+}
+
 static void sid_thread_entry(void *context, void *unused, void *unused2)
 {
 	ARG_UNUSED(unused);
@@ -28,16 +44,16 @@ static void sid_thread_entry(void *context, void *unused, void *unused2)
 	k_sem_give(&sid_thread_started);
 
 	while (1) {
-		int err = k_msgq_get(&sidewalk_thread_msgq, &event, K_FOREVER);
-		if (!err) {
+		/* Binary semaphore: one give per idle->busy edge is enough,
+		 * the inner loop drains everything queued meanwhile */
+		k_sem_take(&event_queue_sem, K_FOREVER);
+		while (event_queue_pop(&event)) {
 			if (event.handler) {
 				event.handler(sid, event.ctx);
 			}
 			if (event.ctx_free) {
 				event.ctx_free(event.ctx);
 			}
-		} else {
-			LOG_ERR("Sidewalk msgq err %d", err);
 		}
 	}
 
@@ -53,7 +69,8 @@ void sidewalk_start(sidewalk_ctx_t *context)
 	k_sem_take(&sid_thread_started, K_FOREVER);
 }
 
-int sidewalk_event_send(event_handler_t event, void *ctx, ctx_free free)
+int sidewalk_event_send_class(enum sidewalk_evq_class cls, event_handler_t event,
+			      void *ctx, ctx_free free)
 {
 	sidewalk_ctx_event_t ctx_event = {
 		.handler = event,
@@ -61,18 +78,34 @@ int sidewalk_event_send(event_handler_t event, void *ctx, ctx_free free)
 		.ctx_free = free,
 	};
 
-	k_timeout_t timeout = K_NO_WAIT;
-	int result = -EFAULT;
+	k_spinlock_key_t key = k_spin_lock(&event_queue_lock);
+	int result = sidewalk_evq_push(&event_queue, cls, &ctx_event);
+	k_spin_unlock(&event_queue_lock, key);
 
-#if defined(CONFIG_SIDEWALK_THREAD_QUEUE_TIMEOUT_VALUE) && CONFIG_SIDEWALK_THREAD_QUEUE_TIMEOUT_VALUE > 0
-	if (!k_is_in_isr()) {
-		timeout = K_MSEC(CONFIG_SIDEWALK_THREAD_QUEUE_TIMEOUT_VALUE);
+	if (result == 0) {
+		k_sem_give(&event_queue_sem);
 	}
-#endif /* CONFIG_SIDEWALK_THREAD_QUEUE_TIMEOUT_VALUE > 0 */
-
-	result = k_msgq_put(&sidewalk_thread_msgq, (void *)&ctx_event, timeout);
-	LOG_DBG("sidewalk_event_send event = %p, context = %p, k_msgq_put result %d", (void *)event,
-		ctx, result);
+	LOG_DBG("sidewalk_event_send event = %p, context = %p, class %d, result %d",
+		(void *)event, ctx, (int)cls, result);
 
 	return result;
 }
+
+int sidewalk_event_send(event_handler_t event, void *ctx, ctx_free free)
+{
+	enum sidewalk_evq_class cls = SIDEWALK_EVQ_CONTROL;
+
+	if (event == sidewalk_event_process) {
+		cls = SIDEWALK_EVQ_RADIO;
+	} else if (event == sidewalk_event_send_msg) {
+		cls = SIDEWALK_EVQ_UPLINK;
+	}
+	return sidewalk_event_send_class(cls, event, ctx, free);
+}
+
+void sidewalk_event_queue_stats(struct sidewalk_evq_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&event_queue_lock);
+	*stats = event_queue.stats;
+	k_spin_unlock(&event_queue_lock, key);
+}
@@ -6,12 +6,14 @@
  */
 
 #include <sidewalk.h>
+#include <sidewalk_dispatch.h>
+#include <msg_track.h>
 #include <tx_state.h>
 #include <app.h>
 #include <platform_api.h>
 #include <ota_update.h>
+#include <ota_boot.h>
 #include <sid_hal_reset_ifc.h>
-#include <sid_hal_memory_ifc.h>
 #include <zephyr/logging/log.h>
 #include <string.h>
 #include <bt_app_callbacks.h>
@@ -19,6 +21,109 @@
 
 LOG_MODULE_REGISTER(sidewalk_dispatch, CONFIG_SIDEWALK_LOG_LEVEL);
 
+/* ------------------------------------------------------------------ */
+/*  Uplink id tracking                                                 */
+/* ------------------------------------------------------------------ */
+
+/* Every queued uplink and every one the stack still holds has a slot
+ * (msg_track.c); all calls run on the Sidewalk thread */
+BUILD_ASSERT(MSG_TRACK_SLOTS >= SIDEWALK_MSG_POOL_SLOTS + MSG_TRACK_SDK_QUEUE,
+	     "msg_track sized for the uplink pool and the stack's queue");
+
+void sidewalk_dispatch_track_msg(uint16_t sid_id, uint32_t token, bool app)
+{
+	uint32_t evicted = msg_track_add(sid_id, token, app);
+
+	if (evicted) {
+		LOG_WRN("Uplink id table full, msg %u reports as 0", evicted);
+	}
+}
+
+/* ------------------------------------------------------------------ */
+/*  Send results                                                       */
+/* ------------------------------------------------------------------ */
+
+/* The stack reports send results on the Sidewalk thread. The app's
+ * on_msg_sent/on_send_error update state that on_timer also uses, so
+ * they are queued here and delivered from the system work queue, like
+ * on_timer and on_gpio_edges. */
+#define SEND_RESULT_SLOTS MSG_TRACK_SLOTS
+
+static struct send_result {
+	uint32_t token;
+	int error;              /* 0: sent */
+} send_results[SEND_RESULT_SLOTS];
+static uint8_t send_result_head;
+static uint8_t send_result_len;
+static uint32_t send_result_dropped;
+static struct k_spinlock send_result_lock;
+
+static void send_result_work_handler(struct k_work *work);
+static K_WORK_DEFINE(send_result_work, send_result_work_handler);
+
+static void send_result_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	for (;;) {
+		struct send_result r;
+
+		k_spinlock_key_t key = k_spin_lock(&send_result_lock);
+		if (!send_result_len) {
+			k_spin_unlock(&send_result_lock, key);
+			return;
+		}
+		r = send_results[send_result_head];
+		send_result_head = (send_result_head + 1) % SEND_RESULT_SLOTS;
+		send_result_len--;
+		k_spin_unlock(&send_result_lock, key);
+
+		if (!app_image_valid()) {
+			continue;
+		}
+		const struct app_callbacks *cb = app_get_callbacks();
+		if (!r.error && cb->on_msg_sent) {
+			cb->on_msg_sent(r.token);
+		} else if (r.error && cb->on_send_error) {
+			cb->on_send_error(r.token, r.error);
+		}
+	}
+}
+
+static void send_result_post(uint32_t token, int error)
+{
+	bool queued = false;
+
+	k_spinlock_key_t key = k_spin_lock(&send_result_lock);
+	if (send_result_len < SEND_RESULT_SLOTS) {
+		send_results[(send_result_head + send_result_len) % SEND_RESULT_SLOTS] =
+			(struct send_result){ .token = token, .error = error };
+		send_result_len++;
+		queued = true;
+	} else {
+		send_result_dropped++;
+	}
+	k_spin_unlock(&send_result_lock, key);
+
+	if (queued) {
+		k_work_submit(&send_result_work);
+	} else {
+		LOG_WRN("Send result queue full, dropped result for msg %u", token);
+	}
+}
+
+uint32_t sidewalk_dispatch_results_dropped(void)
+{
+	return send_result_dropped;
+}
+
+void sidewalk_dispatch_send_failed(uint32_t token, int error)
+{
+	if (token) {
+		send_result_post(token, error);
+	}
+}
+
 /* ------------------------------------------------------------------ */
 /*  Sidewalk event callbacks                                           */
 /* ------------------------------------------------------------------ */
@@ -49,24 +154,26 @@ static void on_sidewalk_msg_received(const struct sid_msg_desc *msg_desc,
 static void on_sidewalk_msg_sent(const struct sid_msg_desc *msg_desc, void *context)
 {
 	LOG_DBG("sent message(type: %d, id: %u)", (int)msg_desc->type, msg_desc->id);
-	if (app_image_valid()) {
-		const struct app_callbacks *cb = app_get_callbacks();
-		if (cb->on_msg_sent) {
-			cb->on_msg_sent(msg_desc->id);
-		}
+	bool app;
+	uint32_t token = msg_track_take(msg_desc->id, &app);
+
+	/* An app that gets its own uplink out after an update is good. The
+	 * platform's OTA ACKs and status frames say nothing about the app. */
+	if (app && app_image_valid()) {
+		ota_boot_confirm();
 	}
+	/* Platform and untracked (evicted) uplinks report as msg_id 0 */
+	send_result_post(app ? token : 0, 0);
 }
 
 static void on_sidewalk_send_error(sid_error_t error, const struct sid_msg_desc *msg_desc,
 				   void *context)
 {
 	LOG_ERR("Send message err %d (%s)", (int)error, SID_ERROR_T_STR(error));
-	if (app_image_valid()) {
-		const struct app_callbacks *cb = app_get_callbacks();
-		if (cb->on_send_error) {
-			cb->on_send_error(msg_desc->id, (int)error);
-		}
-	}
+	bool app;
+	uint32_t token = msg_track_take(msg_desc->id, &app);
+
+	send_result_post(app ? token : 0, (int)error);
 }
 
 static void on_sidewalk_factory_reset(void *context)
@@ -78,15 +185,24 @@ static void on_sidewalk_factory_reset(void *context)
 	}
 }
 
+static void status_event_free(void *ctx)
+{
+	msg_pool_free(&sidewalk_status_pool, ctx);
+}
+
 static void on_sidewalk_status_changed(const struct sid_status *status, void *context)
 {
-	struct sid_status *new_status = sid_hal_malloc(sizeof(struct sid_status));
+	struct sid_status *new_status = msg_pool_alloc(&sidewalk_status_pool);
 	if (!new_status) {
-		LOG_ERR("Failed to allocate memory for new status value");
+		/* The queued ones are older; tx_state below still sees this one */
+		LOG_WRN("Status pool full, dropping status event");
 	} else {
 		memcpy(new_status, status, sizeof(struct sid_status));
+		if (sidewalk_event_send(sidewalk_event_new_status, new_status,
+					status_event_free)) {
+			status_event_free(new_status);
+		}
 	}
-	sidewalk_event_send(sidewalk_event_new_status, new_status, sid_hal_free);
 
 	/* Update platform TX module */
 	tx_state_set_link_mask(status->detail.link_status_mask);
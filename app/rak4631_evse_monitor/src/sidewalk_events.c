@@ -6,6 +6,7 @@
 
 #include "json_printer/sidTypes2str.h"
 #include <sidewalk.h>
+#include <sidewalk_dispatch.h>
 #include <sid_error.h>
 #include <app_mfg_config.h>
 #include <sid_pal_common_ifc.h>
@@ -256,8 +257,10 @@ void sidewalk_event_send_msg(sidewalk_ctx_t *sid, void *ctx)
 	sid_error_t e = sid_put_msg(sid->handle, &p_msg->msg, &p_msg->desc);
 	if (e) {
 		LOG_ERR("sid send err %d", (int)e);
+		sidewalk_dispatch_send_failed(p_msg->app ? p_msg->token : 0, (int)e);
 		return;
 	}
+	sidewalk_dispatch_track_msg(p_msg->desc.id, p_msg->token, p_msg->app);
 	LOG_DBG("sid send (type: %d, id: %u)", (int)p_msg->desc.type, p_msg->desc.id);
 }
 void sidewalk_event_connect(sidewalk_ctx_t *sid, void *ctx)
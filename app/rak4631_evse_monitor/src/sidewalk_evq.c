@@ -0,0 +1,64 @@
+/*
+ * Sidewalk Event Queue — prioritized, coalescing work queue for the
+ * Sidewalk thread
+ */
+
+#include <sidewalk_evq.h>
+
+#include <errno.h>
+#include <string.h>
+
+void sidewalk_evq_init(struct sidewalk_evq *q)
+{
+	memset(q, 0, sizeof(*q));
+}
+
+int sidewalk_evq_push(struct sidewalk_evq *q, enum sidewalk_evq_class cls,
+		      const struct sidewalk_evq_event *ev)
+{
+	if (cls >= SIDEWALK_EVQ_CLASSES) {
+		return -EINVAL;
+	}
+	struct sidewalk_evq_ring *r = &q->ring[cls];
+
+	if (cls == SIDEWALK_EVQ_RADIO) {
+		for (uint8_t i = 0; i < r->len; i++) {
+			if (r->ev[(r->head + i) % SIDEWALK_EVQ_DEPTH].handler == ev->handler) {
+				if (ev->ctx_free) {
+					ev->ctx_free(ev->ctx);
+				}
+				q->stats.coalesced++;
+				return 0;
+			}
+		}
+	}
+
+	if (r->len == SIDEWALK_EVQ_DEPTH) {
+		q->stats.dropped[cls]++;
+		return -ENOMSG;
+	}
+	r->ev[(r->head + r->len) % SIDEWALK_EVQ_DEPTH] = *ev;
+	r->len++;
+
+	q->stats.depth++;
+	if (q->stats.depth > q->stats.high_water) {
+		q->stats.high_water = q->stats.depth;
+	}
+	return 0;
+}
+
+bool sidewalk_evq_pop(struct sidewalk_evq *q, struct sidewalk_evq_event *ev)
+{
+	for (int cls = 0; cls < SIDEWALK_EVQ_CLASSES; cls++) {
+		struct sidewalk_evq_ring *r = &q->ring[cls];
+
+		if (r->len > 0) {
+			*ev = r->ev[r->head];
+			r->head = (r->head + 1) % SIDEWALK_EVQ_DEPTH;
+			r->len--;
+			q->stats.depth--;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,260 @@
+"""
+Stable app layout — keep functions and const data where the last release
+put them, so chunk-aligned delta OTA only resends what changed.
+
+The app is compiled with -ffunction-sections/-fdata-sections, so every
+function and const object is its own input section, but a default link
+packs them back to back: one function growing by an instruction moves
+everything after it, and every chunk from there on differs. This tool
+reads a release's linker map (app.map) and writes app_layout.ld, which
+app.ld includes when the app is built with -DAPP_STABLE_LAYOUT=ON:
+
+- Each .text/.rodata input section of the release gets a slot. A slot
+  from the release's own slot map that still has room is kept as it was.
+  Sections that filled their slot, or were packed by a default link, get
+  a new slot with PAD_PERCENT headroom. The first stable build therefore
+  moves everything once; after that, unchanged functions keep their
+  addresses.
+- A section that outgrows its slot pushes the following ones along
+  (". = MAX(., offset)"), it does not break the link. Removed sections
+  leave their slot empty.
+- New sections go after the last slot. .rodata starts at a fixed offset
+  past the text slots, with TEXT_RESERVE_PERCENT room for new code.
+
+Mergeable string/constant sections (.rodata.str1.1, .rodata.<fn>.str1.4,
+.rodata.cst8, ...) are left to the linker: they are merged across objects
+and cannot be placed one by one.
+
+Usage:
+    python3 app_layout.py build_app/app.map [-o app_layout.ld]
+"""
+
+import argparse
+import collections
+import os
+import re
+import sys
+
+PAD_PERCENT = 12            # headroom given to a slot, % of the section size
+PAD_MIN = 8                 # ...and at least this many bytes
+SLOT_ALIGN = 8              # slots start on this boundary
+MAX_ALIGN = 32              # largest input section alignment assumed
+TEXT_RESERVE_PERCENT = 6    # room for new functions before .rodata
+TEXT_RESERVE_MIN = 256
+RODATA_ALIGN = 256
+
+LAYOUT_SECTIONS = (".text", ".rodata")
+HEADER_SECTION = ".app_header"   # starts the slot (APP_SLOT_ADDR)
+
+DEFAULT_OUTPUT = os.path.join(os.path.dirname(__file__), "..",
+                              "app", "rak4631_evse_monitor", "app_layout.ld")
+
+# slotted: placed by an app_layout.ld line (the map echoes the script)
+Section = collections.namedtuple("Section", "name obj offset size slotted")
+
+_HEX = re.compile(r"^0x[0-9a-fA-F]+$")
+
+
+def _round_up(value, align):
+    return (value + align - 1) // align * align
+
+
+def slot_align(section):
+    """Alignment for a new slot. The map does not record a section's
+    alignment, but its offset there was a multiple of it."""
+    low = section.offset & -section.offset if section.offset else MAX_ALIGN
+    return max(SLOT_ALIGN, min(low, MAX_ALIGN))
+
+
+def padded(size):
+    """Slot size for a section of `size` bytes."""
+    return _round_up(size + max(size * PAD_PERCENT // 100, PAD_MIN), SLOT_ALIGN)
+
+
+def parse_map(text):
+    """Output section addresses and the input sections placed in .text and
+    .rodata, from a GNU ld map file.
+
+    Returns (starts, sizes, sections): starts/sizes by output section name,
+    sections[out] a list of Section with offsets from the output section's
+    start, in address order.
+    """
+    starts, sizes = {}, {}
+    sections = {name: [] for name in LAYOUT_SECTIONS}
+    specs = set()
+    out = None
+    pending = None
+    in_map = False
+
+    for line in text.splitlines():
+        if line.startswith("Linker script and memory map"):
+            in_map = True
+            continue
+        if not in_map or not line.strip():
+            continue
+        parts = line.split()
+
+        if not line[0].isspace():
+            # Output section: ".text  0x00090040  0x4a20", name may wrap
+            out = parts[0]
+            pending = None
+            if len(parts) >= 3 and _HEX.match(parts[1]) and _HEX.match(parts[2]):
+                starts[out] = int(parts[1], 16)
+                sizes[out] = int(parts[2], 16)
+            continue
+        if out not in sections:
+            continue
+
+        # Script statement echoed before the sections it placed
+        if len(parts) == 1 and parts[0].startswith("*") and parts[0].endswith(")"):
+            specs.add(parts[0])
+            continue
+
+        # Input section: " .text.foo  0x00090040  0x24 obj", name may wrap
+        if pending:
+            parts = [pending] + parts
+            pending = None
+        if len(parts) == 1 and parts[0].startswith("."):
+            pending = parts[0]
+            continue
+        if (len(parts) >= 4 and parts[0].startswith(".")
+                and _HEX.match(parts[1]) and _HEX.match(parts[2])):
+            size = int(parts[2], 16)
+            if size and out in starts:
+                sections[out].append(Section(parts[0], " ".join(parts[3:]),
+                                             int(parts[1], 16) - starts[out], size,
+                                             False))
+
+    for out, secs in sections.items():
+        secs[:] = sorted((s._replace(slotted=input_spec(s) in specs) for s in secs),
+                         key=lambda s: s.offset)
+    return starts, sizes, sections
+
+
+_MERGEABLE = re.compile(r"(^|\.)(str\d+\.\d+|cst\d+)$")
+
+
+def placeable(section):
+    """Whether a section can be given a slot of its own."""
+    return not _MERGEABLE.search(section.name)
+
+
+def input_spec(section):
+    """Linker script input section spec matching this section only."""
+    obj = section.obj
+    member = re.match(r"^(.*)\((.+)\)$", obj)
+    if member:
+        # Archive member: "path/libc_nano.a(lib_a-memcpy.o)"
+        pattern = f"*{os.path.basename(member.group(1))}:{member.group(2)}"
+    else:
+        pattern = f"*/{os.path.basename(obj)}" if "/" in obj else obj
+    return f"{pattern}({section.name})"
+
+
+def plan_slots(sections, out_size):
+    """Slot offsets for one output section's input sections.
+
+    Returns ([(section, offset)], end): end is where the slots stop and
+    new sections start.
+    """
+    slots = []
+    cur = 0
+    for i, s in enumerate(sections):
+        if not placeable(s):
+            continue
+        nxt = sections[i + 1].offset if i + 1 < len(sections) else out_size
+        if s.slotted:
+            # Keep the slot, and the hole of any removed section before it
+            start = max(s.offset, cur)
+            if start == s.offset and nxt - s.offset > _round_up(s.size, SLOT_ALIGN):
+                slots.append((s, start))
+                cur = nxt
+                continue
+        else:
+            start = cur                 # packed by the linker: lay out anew
+        start = _round_up(start, slot_align(s))
+        slots.append((s, start))
+        cur = start + padded(s.size)
+    return slots, cur
+
+
+def plan_layout(starts, sizes, sections):
+    """Slots for .text and .rodata, and the .rodata offset in the slot."""
+    origin = starts.get(HEADER_SECTION, starts[".text"])
+    text_off = starts[".text"] - origin
+    text, text_end = plan_slots(sections[".text"], sizes[".text"])
+    rodata, rodata_end = plan_slots(sections[".rodata"], sizes.get(".rodata", 0))
+
+    # Keep .rodata where it was unless the text slots reach it
+    rodata_off = starts.get(".rodata", starts[".text"] + sizes[".text"]) - origin
+    if rodata_off < text_off + text_end:
+        reserve = max(text_end * TEXT_RESERVE_PERCENT // 100, TEXT_RESERVE_MIN)
+        rodata_off = _round_up(text_off + text_end + reserve, RODATA_ALIGN)
+
+    return {
+        "text": text,
+        "text_end": text_end,
+        "rodata": rodata,
+        "rodata_end": rodata_end,
+        "rodata_offset": rodata_off,
+    }
+
+
+def _slot_lines(slots, end):
+    lines = [f". = MAX(., 0x{offset:05x}); {input_spec(s)}" for s, offset in slots]
+    lines.append(f". = MAX(., 0x{end:05x});")
+    return lines
+
+
+def render(layout, source="app.map"):
+    """app_layout.ld text for a plan_layout() result."""
+    lines = [
+        "/*",
+        f" * Stable app layout — generated by aws/app_layout.py from {source}.",
+        " * Included by app.ld when the app is built with -DAPP_STABLE_LAYOUT=ON;",
+        " * offsets are from the start of the output section. Do not edit:",
+        " * `firmware.py release` regenerates it from each release's map.",
+        " */",
+        "#if defined(APP_LAYOUT_TEXT)",
+        *_slot_lines(layout["text"], layout["text_end"]),
+        "#elif defined(APP_LAYOUT_RODATA)",
+        *_slot_lines(layout["rodata"], layout["rodata_end"]),
+        "#else",
+        f"#define APP_LAYOUT_RODATA_OFFSET 0x{layout['rodata_offset']:05x}",
+        "#endif",
+    ]
+    return "\n".join(lines) + "\n"
+
+
+def generate(map_path, out_path=DEFAULT_OUTPUT, source=None):
+    """Write app_layout.ld from a linker map. Returns the plan."""
+    with open(map_path, "r") as f:
+        starts, sizes, sections = parse_map(f.read())
+    if ".text" not in starts:
+        raise ValueError(f"{map_path}: no .text output section")
+    layout = plan_layout(starts, sizes, sections)
+    with open(out_path, "w") as f:
+        f.write(render(layout, source or os.path.basename(map_path)))
+    return layout
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Generate app_layout.ld (stable function slots) from an app.map")
+    parser.add_argument("map", help="linker map of the release to keep stable")
+    parser.add_argument("-o", "--output", default=DEFAULT_OUTPUT)
+    args = parser.parse_args(argv)
+
+    try:
+        layout = generate(args.map, args.output)
+    except (OSError, ValueError) as e:
+        print(f"ERROR: {e}")
+        return 1
+    print(f"{args.output}: {len(layout['text'])} text and {len(layout['rodata'])} "
+          f"rodata slots, text slots end at 0x{layout['text_end']:x}, "
+          f".rodata at +0x{layout['rodata_offset']:x}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,7 +1,9 @@
 """
 Lambda function to decode EVSE Sidewalk sensor data.
 
-Supports five payload formats:
+Supports seven payload formats:
+0. v0x0B batch format (7 + 4-5 bytes per entry): buffered snapshots drained
+   from the device event buffer; fanned out into one DynamoDB event each
 1. v0x0A raw format (15 bytes): Magic 0xE5, J1772, voltage, current, flags+control,
    timestamp, transition reason, app build version, platform build version
 2. v0x09 raw format (13 bytes): Same as v0x0A without build versions
@@ -75,6 +77,12 @@ TELEMETRY_PAYLOAD_SIZE_V07 = 12
 TELEMETRY_PAYLOAD_SIZE_V09 = 13
 TELEMETRY_PAYLOAD_SIZE_V0A = 15
 
+# Batched drain frame v0x0B (must match app_tx.c app_tx_send_batch)
+BATCH_PAYLOAD_VERSION = 0x0B
+BATCH_HDR_SIZE = 7
+BATCH_HAS_REASON = 0x08
+BATCH_CURRENT_UNIT_MA = 200
+
 # Diagnostics payload size (TASK-029 Tier 2)
 DIAG_PAYLOAD_SIZE = 15
 
@@ -399,6 +407,83 @@ def decode_raw_evse_payload(raw_bytes):
     return result
 
 
+def decode_batch_evse_payload(raw_bytes):
+    """
+    Decode a batched v0x0B drain frame into a list of EVSE events.
+
+    Header (7 bytes):
+      Byte 0: Magic (0xE5)
+      Byte 1: Version (0x0B)
+      Byte 2: Entry count
+      Byte 3-6: Base device epoch timestamp (LE uint32)
+
+    Each entry (4 bytes, +1 if a transition reason follows):
+      Byte 0-1: Seconds since base (LE uint16)
+      Byte 2: J1772 state (bits 0-2), reason follows (bit 3),
+              v0x0A flags nibble (bits 4-7: cool=bit 5, charge_allowed=bit 6)
+      Byte 3: Current in 200 mA steps (255 = saturated)
+      Byte 4: Transition reason (optional)
+
+    Pilot voltage is not carried; the state code stands in for it.
+    Returns None if the frame is malformed.
+    """
+    if len(raw_bytes) < BATCH_HDR_SIZE:
+        return None
+    if raw_bytes[0] != TELEMETRY_MAGIC or raw_bytes[1] != BATCH_PAYLOAD_VERSION:
+        return None
+
+    count = raw_bytes[2]
+    base = int.from_bytes(raw_bytes[3:7], 'little')
+    pos = BATCH_HDR_SIZE
+    events = []
+
+    for _ in range(count):
+        if pos + 4 > len(raw_bytes):
+            return None
+        offset = int.from_bytes(raw_bytes[pos:pos + 2], 'little')
+        packed = raw_bytes[pos + 2]
+        current_ma = raw_bytes[pos + 3] * BATCH_CURRENT_UNIT_MA
+        pos += 4
+
+        j1772_state = packed & 0x07
+        flags = packed >> 4
+        if j1772_state > 6:
+            return None
+
+        reason_code = 0
+        if packed & BATCH_HAS_REASON:
+            if pos >= len(raw_bytes):
+                return None
+            reason_code = raw_bytes[pos]
+            pos += 1
+
+        sc_epoch = base + offset if base > 0 else 0
+        events.append({
+            'payload_type': 'evse',
+            'format': 'raw_batch',
+            'version': BATCH_PAYLOAD_VERSION,
+            'j1772_state_code': j1772_state,
+            'j1772_state': J1772_STATES.get(j1772_state, 'UNKNOWN'),
+            'current_ma': current_ma,
+            'thermostat_bits': flags & 0x02,
+            'thermostat_cool': bool(flags & 0x02),
+            'charge_allowed': bool(flags & 0x04),
+            'charge_now': False,
+            'device_timestamp_epoch': sc_epoch,
+            'device_timestamp_unix': sc_epoch + EPOCH_OFFSET if sc_epoch > 0 else None,
+            'transition_reason_code': reason_code,
+            'transition_reason': TRANSITION_REASONS.get(reason_code, f'unknown_{reason_code}'),
+        })
+
+    return {
+        'payload_type': 'evse_batch',
+        'format': 'raw_batch',
+        'version': BATCH_PAYLOAD_VERSION,
+        'base_timestamp_epoch': base,
+        'events': events,
+    }
+
+
 def decode_legacy_sid_demo_payload(raw_bytes):
     """
     Decode legacy sid_demo format payload.
@@ -446,7 +531,8 @@ def decode_ota_uplink(raw_bytes):
     """
     Decode OTA uplink messages (cmd type 0x20).
 
-    ACK (0x80):      status(1) next_chunk(2) chunks_received(2) = 7B total
+    ACK (0x80):      status(1) next_chunk(2) chunks_received(2) = 7B total,
+                     + base(2) bitmap(8) = 17B for a delta bitmap ACK
     COMPLETE (0x81): result(1) crc32_calc(4) = 7B total
     STATUS (0x82):   phase(1) chunks_rcvd(2) total_chunks(2) app_ver(4) = 11B total
     """
@@ -456,13 +542,18 @@ def decode_ota_uplink(raw_bytes):
     subtype = raw_bytes[1]
 
     if subtype == OTA_SUB_ACK and len(raw_bytes) >= 7:
-        return {
+        ack = {
             'payload_type': 'ota',
             'ota_type': 'ack',
             'status': raw_bytes[2],
             'next_chunk': int.from_bytes(raw_bytes[3:5], 'little'),
             'chunks_received': int.from_bytes(raw_bytes[5:7], 'little'),
         }
+        if len(raw_bytes) >= 17:
+            # Bit i set: delta chunk ack_base + i received
+            ack['ack_base'] = int.from_bytes(raw_bytes[7:9], 'little')
+            ack['ack_bitmap'] = int.from_bytes(raw_bytes[9:17], 'little')
+        return ack
 
     if subtype == OTA_SUB_COMPLETE and len(raw_bytes) >= 7:
         return {
@@ -492,9 +583,10 @@ def decode_ota_uplink(raw_bytes):
 
 def decode_diag_payload(raw_bytes):
     """
-    Decode extended diagnostics payload (magic 0xE6, 14 bytes).
+    Decode extended diagnostics payload (magic 0xE6, 15 bytes; 17 from v0x02).
 
     Sent by the device in response to a 0x40 diagnostics request.
+    v0x02 adds the LoRa/FSK airtime left in the device's rolling hour.
     See TDD §3.5.
     """
     if len(raw_bytes) < DIAG_PAYLOAD_SIZE:
@@ -512,6 +604,8 @@ def decode_diag_payload(raw_bytes):
     event_buf_pending = raw_bytes[12]
     app_build_version = raw_bytes[13] if len(raw_bytes) > 13 else 0
     platform_build_version = raw_bytes[14] if len(raw_bytes) > 14 else 0
+    airtime_remaining_ms = (int.from_bytes(raw_bytes[15:17], 'little')
+                            if len(raw_bytes) >= 17 else None)
 
     # Map error code to name
     error_names = {0: 'none', 1: 'sensor', 2: 'clamp', 3: 'interlock', 4: 'selftest'}
@@ -536,6 +630,7 @@ def decode_diag_payload(raw_bytes):
         'ota_in_progress': bool(state_flags & 0x20),
         'time_synced': bool(state_flags & 0x40),
         'event_buffer_pending': event_buf_pending,
+        'airtime_remaining_ms': airtime_remaining_ms,
     }
 
 
@@ -573,6 +668,14 @@ def decode_payload(raw_payload_b64):
                 print("Decoded as diagnostics response")
                 return decoded
 
+        # Batched drain frame (magic 0xE5, version 0x0B)
+        if len(raw_bytes) >= 2 and raw_bytes[0] == TELEMETRY_MAGIC and \
+                raw_bytes[1] == BATCH_PAYLOAD_VERSION:
+            decoded = decode_batch_evse_payload(raw_bytes)
+            if decoded:
+                print(f"Decoded as EVSE batch ({len(decoded['events'])} events)")
+                return decoded
+
         # Try new raw format first (magic byte 0xE5)
         decoded = decode_raw_evse_payload(raw_bytes)
         if decoded:
@@ -635,6 +738,84 @@ def store_transition_event(device_id, effective_ms, cloud_received_mt,
     print(f"Stored transition: charge_allowed={charge_allowed}, reason={reason}")
 
 
+def batch_event_timestamp_ms(event, index, cloud_timestamp_ms, raw_payload_b64):
+    """Return (effective_ms, source) for entry `index` of a v0x0B batch.
+
+    Same rule as compute_event_timestamp_ms, but the ms fraction is offset
+    by the entry index so entries sharing a second get distinct sort keys,
+    and a redelivered frame maps every entry to the same key again.
+    """
+    device_ts_unix = event.get('device_timestamp_unix')
+    if device_ts_unix:
+        fraction = (_payload_ms_fraction(raw_payload_b64) + index) % 1000
+        return device_ts_unix * 1000 + fraction, 'device'
+    return cloud_timestamp_ms + index, 'cloud_presync'
+
+
+def store_batch_events(sc_id, wireless_device_id, decoded, payload_data,
+                       cloud_timestamp_ms, base_item):
+    """Fan a v0x0B batch out into one evse_telemetry item per entry.
+
+    Buffered entries are history, so only per-event side effects run
+    (transition logging); live-state ones (device-state snapshot, charge
+    now, divergence check) are left to live v0x0A uplinks.
+    Returns (stored, duplicates).
+    """
+    cloud_received_mt = unix_ms_to_mt(cloud_timestamp_ms)
+    stored = 0
+    duplicates = 0
+    batch = decoded['events']
+
+    for index, ev in enumerate(batch):
+        effective_ms, source = batch_event_timestamp_ms(
+            ev, index, cloud_timestamp_ms, payload_data)
+        evse_data = {
+            'format': ev['format'],
+            'version': ev['version'],
+            'pilot_state': ev['j1772_state'],
+            'pilot_state_code': ev['j1772_state_code'],
+            'current_draw_ma': ev['current_ma'],
+            'thermostat_bits': ev['thermostat_bits'],
+            'thermostat_cool_active': ev['thermostat_cool'],
+            'charge_allowed': ev['charge_allowed'],
+            'charge_now': ev['charge_now'],
+            'device_timestamp_epoch': ev['device_timestamp_epoch'],
+        }
+        if ev.get('device_timestamp_unix') is not None:
+            evse_data['device_timestamp_unix'] = ev['device_timestamp_unix']
+
+        item = dict(base_item)
+        item.update({
+            'timestamp_mt': unix_ms_to_mt(effective_ms),
+            'timestamp_source': source,
+            'batch_index': index,
+            'batch_size': len(batch),
+            'data': {'evse': evse_data},
+        })
+        item = json.loads(json.dumps(item), parse_float=Decimal)
+
+        try:
+            table.put_item(
+                Item=item,
+                ConditionExpression='attribute_not_exists(device_id) AND attribute_not_exists(timestamp_mt)',
+            )
+        except ClientError as e:
+            if e.response['Error']['Code'] == 'ConditionalCheckFailedException':
+                duplicates += 1
+                continue
+            raise
+        stored += 1
+
+        if ev.get('transition_reason_code', 0) != 0:
+            try:
+                store_transition_event(sc_id, effective_ms, cloud_received_mt,
+                                       source, ev)
+            except Exception as e:
+                print(f"Transition event error: {e}")
+
+    return stored, duplicates
+
+
 def lambda_handler(event, context):
     """
     Process Sidewalk EVSE messages and store decoded data in DynamoDB.
@@ -666,6 +847,49 @@ def lambda_handler(event, context):
         timestamp_mt_str = unix_ms_to_mt(effective_ms)
         ttl_seconds = int(cloud_timestamp_ms / 1000) + 7776000  # 90-day retention (cloud time)
 
+        if decoded.get('payload_type') == 'evse_batch':
+            base_item = {
+                'device_id': sc_id,
+                'wireless_device_id': wireless_device_id,
+                'ttl': ttl_seconds,
+                'event_type': 'evse_telemetry',
+                'device_type': 'evse',
+                'schema_version': '3.0',
+                'link_type': link_type,
+                'rssi': rssi,
+                'seq': seq,
+                'sidewalk_id': sidewalk_id,
+                'timestamp_str': timestamp_str,
+                'raw_payload': payload_data,
+                'cloud_received_mt': cloud_received_mt,
+            }
+            stored, duplicates = store_batch_events(
+                sc_id, wireless_device_id, decoded, payload_data,
+                cloud_timestamp_ms, base_item)
+            print(f"Stored EVSE batch: {stored} events, {duplicates} duplicates")
+
+            if decoded['events']:
+                try:
+                    maybe_send_time_sync(
+                        sc_id, device_timestamp=decoded['events'][-1]['device_timestamp_epoch'])
+                except Exception as e:
+                    print(f"TIME_SYNC error: {e}")
+            try:
+                device_registry.get_or_create_device(registry_table, wireless_device_id, sidewalk_id)
+                device_registry.update_last_seen(registry_table, wireless_device_id)
+            except Exception as e:
+                print(f"Device registry update failed (non-fatal): {e}")
+
+            return {
+                'statusCode': 200,
+                'body': json.dumps({
+                    'message': 'EVSE batch processed',
+                    'device_id': sc_id,
+                    'stored': stored,
+                    'duplicates': duplicates,
+                })
+            }
+
         item = {
             'device_id': sc_id,
             'timestamp_mt': timestamp_mt_str,
@@ -3,7 +3,8 @@
 Firmware CLI — build, release, flash, and deploy firmware.
 
 Usage:
-    python aws/firmware.py release --version N    # patch, commit, tag, build
+    python aws/firmware.py release --version N    # patch, build, commit, tag
+                               [--baseline PATH]  # ...and report delta vs PATH
     python aws/firmware.py flash [app|all]        # USB flash via pyocd
     python aws/firmware.py deploy --version N     # OTA upload + monitor
     python aws/firmware.py baseline               # capture device state to S3
@@ -21,6 +22,8 @@ import time
 sys.path.insert(0, os.path.dirname(__file__))
 
 import ota
+import ota_compress
+import ota_patch
 import release
 from protocol_constants import crc32
 
@@ -41,7 +44,20 @@ def cmd_release(args):
     release.git_check_clean()
     release.git_check_tag(tag)
     release.set_app_version(args.version)
-    release.build_app()
+    bin_path = release.build_app(stable=True)
+    release.update_layout(args.version)
+
+    # What a delta OTA of this release would cost
+    try:
+        if args.baseline:
+            with open(args.baseline, "rb") as f:
+                baseline = f.read()
+        else:
+            baseline = ota.s3_download(ota.BASELINE_KEY)
+        release.report_delta(bin_path, baseline)
+    except Exception as e:
+        print(f"No baseline for the delta report ({e})")
+
     release.git_commit_and_tag(args.version)
 
     print(f"\nRelease {tag} ready. Deploy with:")
@@ -106,7 +122,9 @@ def cmd_deploy(args):
         print("Run 'firmware baseline' first to capture device state.")
         sys.exit(1)
 
-    if not args.remote:
+    if not args.remote and ota.baseline_slot() == "b":
+        print("Device runs slot B: primary is not the baseline, skipping verification")
+    elif not args.remote:
         print("\nVerifying S3 baseline matches device primary...")
         device_data = ota.pyocd_read_primary()
         device_crc = crc32(device_data)
@@ -123,11 +141,19 @@ def cmd_deploy(args):
     # Preview delta
     changed = ota.compute_delta_chunks(baseline, firmware, ota.CHUNK_DATA_SIZE)
     full_chunks = (len(firmware) + ota.CHUNK_DATA_SIZE - 1) // ota.CHUNK_DATA_SIZE
-    est_time = len(changed) * 15
+    patch_chunks = ota_patch.patch_chunks(ota_patch.make_patch(baseline, firmware),
+                                          ota.CHUNK_DATA_SIZE)
+    lz_bytes = len(ota_compress.compress(firmware))
+    lz_chunks = (lz_bytes + ota.CHUNK_DATA_SIZE - 1) // ota.CHUNK_DATA_SIZE
+    est_time = min(len(changed), patch_chunks, lz_chunks) * 15
 
     print("\nDelta preview:")
     print(f"  Changed: {len(changed)}/{full_chunks} chunks")
     print(f"  Indices: {changed}")
+    print(f"  Patch:   {patch_chunks} chunks"
+          f"{' (sender will use patch mode)' if patch_chunks < min(len(changed), lz_chunks) else ''}")
+    print(f"  Compressed: {lz_chunks} chunks ({lz_bytes}/{len(firmware)}B, "
+          f"{100 * (1 - lz_bytes / len(firmware)):.0f}% smaller)")
     print(f"  Est. transfer: ~{ota.format_duration(est_time)}")
 
     if not changed:
@@ -159,6 +185,18 @@ def cmd_deploy(args):
     if is_signed:
         s3_metadata["signed"] = "true"
 
+    # Slot B build goes up first: the upload of the slot A key triggers the
+    # sender, which sends it instead when the device runs slot A
+    abs_bin_b = os.path.join("/Users/emilyf/sidewalk-projects", ota.APP_B_BIN)
+    if os.path.exists(abs_bin_b):
+        with open(abs_bin_b, "rb") as f:
+            upload_b = f.read()
+        if is_signed:
+            upload_b = sign_firmware(upload_b, private_key)
+        s3_key_b = f"firmware/app-v{args.version}.slot_b.bin"
+        print(f"Uploading slot B build to s3://{ota.OTA_BUCKET}/{s3_key_b} ...")
+        ota.s3_upload(s3_key_b, upload_b, metadata=s3_metadata if s3_metadata else None)
+
     print(f"Uploading to s3://{ota.OTA_BUCKET}/{s3_key} ...")
     ota.s3_upload(s3_key, upload_data, metadata=s3_metadata if s3_metadata else None)
     suffix = " (signed)" if is_signed else ""
@@ -280,6 +318,10 @@ def main():
         "--version", type=int, default=None,
         help="Build version number (required, >= 1)",
     )
+    p_release.add_argument(
+        "--baseline", default=None,
+        help="Image to report the delta against (default: S3 baseline)",
+    )
 
     # flash
     p_flash = sub.add_parser("flash", help="Flash firmware via pyocd")
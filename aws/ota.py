@@ -25,6 +25,7 @@ PRIMARY_SIZE = 256 * 1024  # 256KB primary partition
 PYOCD = "/Users/emilyf/sidewalk-env/bin/pyocd"
 BUILD_APP_DIR = "build_app"
 APP_BIN = os.path.join(BUILD_APP_DIR, "app.bin")
+APP_B_BIN = os.path.join(BUILD_APP_DIR, "app_b.bin")   # slot B link of the same app
 
 sys.path.insert(0, os.path.dirname(__file__))
 
@@ -112,6 +113,16 @@ def s3_download(key):
     return resp["Body"].read()
 
 
+def baseline_slot():
+    """A/B slot the device runs, as recorded with the S3 baseline ("a" if
+    the baseline has no slot metadata)."""
+    try:
+        head = get_s3().head_object(Bucket=OTA_BUCKET, Key=BASELINE_KEY)
+        return head.get("Metadata", {}).get("slot", "a")
+    except Exception:
+        return "a"
+
+
 def s3_upload(key, data, metadata=None):
     """Upload bytes to the OTA bucket."""
     s3 = get_s3()
@@ -0,0 +1,158 @@
+"""
+OTA image compression — LZSS stream for compressed full-image OTA.
+
+The device decodes this stream chunk by chunk straight into its staging
+partition (src/ota_lz.c), so a full image costs as many chunks as its
+compressed size. The format is heatshrink's (window 2^12, lookahead 2^4):
+
+    1 bit  1 + 8-bit literal
+    1 bit  0 + 12-bit (distance - 1) + 4-bit (length - 1)
+
+read MSB-first, the last byte zero-padded. The decoder stops at the image
+size from OTA_START, so the padding never decodes as a back-reference.
+
+The encoder parses optimally (shortest bit count) over hash-chain match
+candidates; it is slower than heatshrink's greedy encoder but only runs
+once per firmware upload.
+"""
+
+WINDOW_BITS = 12
+LOOKAHEAD_BITS = 4
+WINDOW_SIZE = 1 << WINDOW_BITS
+MAX_MATCH = 1 << LOOKAHEAD_BITS
+MIN_MATCH = 2          # a 2-byte back-reference (17 bits) beats 2 literals (18)
+
+LITERAL_COST = 1 + 8
+BACKREF_COST = 1 + WINDOW_BITS + LOOKAHEAD_BITS
+
+HASH_LEN = 3           # bytes hashed to find match candidates
+MAX_CHAIN = 48         # candidates tried per position
+
+
+def _longest_matches(data):
+    """Per position, the longest match within the window and its distance."""
+    n = len(data)
+    best_len = [0] * n
+    best_dist = [0] * n
+    heads = {}
+    prev = [-1] * n
+
+    for i in range(n):
+        if i + HASH_LEN <= n:
+            key = data[i:i + HASH_LEN]
+            limit = min(MAX_MATCH, n - i)
+            cand = heads.get(key, -1)
+            tries = 0
+            while cand >= 0 and i - cand <= WINDOW_SIZE and tries < MAX_CHAIN:
+                length = HASH_LEN
+                while length < limit and data[cand + length] == data[i + length]:
+                    length += 1
+                if length > best_len[i]:
+                    best_len[i], best_dist[i] = length, i - cand
+                    if length == limit:
+                        break
+                cand = prev[cand]
+                tries += 1
+            prev[i] = heads.get(key, -1)
+            heads[key] = i
+
+        # Two-byte matches fall outside the hash; try the nearest one cheaply
+        if best_len[i] < MIN_MATCH and i >= 1 and i + MIN_MATCH <= n:
+            for d in range(1, min(i, 16) + 1):
+                if data[i - d:i - d + MIN_MATCH] == data[i:i + MIN_MATCH]:
+                    best_len[i], best_dist[i] = MIN_MATCH, d
+                    break
+
+    return best_len, best_dist
+
+
+def _parse(data):
+    """Cheapest token sequence as (length, distance); distance 0 = literal."""
+    n = len(data)
+    best_len, best_dist = _longest_matches(data)
+    cost = [0] * (n + 1)
+    step = [1] * n
+
+    for i in range(n - 1, -1, -1):
+        cost[i] = LITERAL_COST + cost[i + 1]
+        for length in range(MIN_MATCH, best_len[i] + 1):
+            c = BACKREF_COST + cost[i + length]
+            if c < cost[i]:
+                cost[i], step[i] = c, length
+
+    tokens = []
+    i = 0
+    while i < n:
+        if step[i] == 1:
+            tokens.append((1, 0))
+        else:
+            tokens.append((step[i], best_dist[i]))
+        i += step[i]
+    return tokens
+
+
+class _BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.acc = 0
+        self.count = 0
+
+    def put(self, value, bits):
+        self.acc = (self.acc << bits) | value
+        self.count += bits
+        while self.count >= 8:
+            self.count -= 8
+            self.out.append((self.acc >> self.count) & 0xFF)
+        self.acc &= (1 << self.count) - 1
+
+    def finish(self):
+        if self.count:
+            self.out.append((self.acc << (8 - self.count)) & 0xFF)
+        return bytes(self.out)
+
+
+def compress(data):
+    """Compress an image for OTA_START_FLAGS_COMPRESSED."""
+    w = _BitWriter()
+    pos = 0
+    for length, dist in _parse(data):
+        if dist == 0:
+            w.put(0x100 | data[pos], 9)
+        else:
+            w.put(0, 1)
+            w.put(dist - 1, WINDOW_BITS)
+            w.put(length - 1, LOOKAHEAD_BITS)
+        pos += length
+    return w.finish()
+
+
+def decompress(stream, size):
+    """Reference decoder — mirrors the device's streaming decoder."""
+    out = bytearray()
+    bitpos = 0
+    total_bits = len(stream) * 8
+
+    def take(bits):
+        nonlocal bitpos
+        if bitpos + bits > total_bits:
+            raise ValueError("stream ends before image size")
+        value = 0
+        for _ in range(bits):
+            value = (value << 1) | ((stream[bitpos >> 3] >> (7 - (bitpos & 7))) & 1)
+            bitpos += 1
+        return value
+
+    while len(out) < size:
+        if take(1):
+            out.append(take(8))
+            continue
+        dist = take(WINDOW_BITS) + 1
+        length = take(LOOKAHEAD_BITS) + 1
+        if dist > len(out) or len(out) + length > size:
+            raise ValueError("back-reference outside image")
+        for _ in range(length):
+            out.append(out[-dist])
+
+    if (bitpos + 7) // 8 != len(stream):
+        raise ValueError("trailing data after image")
+    return bytes(out)
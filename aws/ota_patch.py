@@ -0,0 +1,351 @@
+"""
+OTA binary patches — bsdiff-style diff of two app images for patch-mode OTA.
+
+Chunk-aligned delta mode (ota_sender_lambda.compute_delta_chunks) only skips
+15-byte chunks that are identical at the same offset, so one inserted
+instruction resends everything after it. A patch instead describes the new
+image as runs copied from the old one (with a sparse byte delta for moved
+branch targets and literal pools) plus literal inserts. The device applies it
+as a stream against its primary partition (src/ota_patch.c).
+
+Format (must match ota_patch.h):
+    header  "EVP1" old_size(u32 LE) old_crc32(u32 LE)
+    record  seek(zigzag varint) diff_len(varint) extra_len(varint)
+            diff tokens: zeros(varint) lits(varint) lits delta bytes, repeated
+            extra_len literal bytes
+
+Usage as a benchmark (chunk counts for delta vs full vs patch):
+    python3 ota_patch.py OLD.bin NEW.bin [NEW2.bin ...]
+    python3 ota_patch.py --revs REV1 REV2 [REV3 ...]
+"""
+
+import argparse
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(__file__))
+
+from protocol_constants import crc32  # noqa: E402
+
+PATCH_MAGIC = b"EVP1"
+PATCH_HDR_SIZE = 12
+CHUNK_DATA_SIZE = 15   # OTA chunk payload (19B LoRa MTU - 4B header)
+
+SEED_LEN = 8           # bytes hashed to find candidate matches
+MIN_MATCH = 16         # shorter matches cost more than sending the bytes
+MAX_CANDIDATES = 16    # old offsets remembered per seed
+MISMATCH_RUN = 32      # stop extending a match after this many misses
+
+
+# --- Encoding helpers ---
+
+
+def _varint(value):
+    out = bytearray()
+    while True:
+        b = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def _zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def _read_varint(data, pos):
+    value = shift = 0
+    while True:
+        if pos >= len(data) or shift > 28:
+            raise ValueError("truncated or oversized varint")
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, pos
+
+
+# --- Matching ---
+
+
+def _seed_index(old):
+    """Map every SEED_LEN-byte window of old to its first offsets."""
+    index = {}
+    for i in range(len(old) - SEED_LEN + 1):
+        key = old[i:i + SEED_LEN]
+        offsets = index.get(key)
+        if offsets is None:
+            index[key] = [i]
+        elif len(offsets) < MAX_CANDIDATES:
+            offsets.append(i)
+    return index
+
+
+def _extend(old, new, o, n):
+    """Length of the approximate match old[o:] ~ new[n:].
+
+    Scores +1 per equal byte and -1 per differing byte and returns the
+    length with the best score, so the run is always mostly equal bytes.
+    """
+    limit = min(len(old) - o, len(new) - n)
+    score = best_score = best = misses = 0
+    for k in range(limit):
+        if old[o + k] == new[n + k]:
+            score += 1
+            misses = 0
+            if score > best_score:
+                best_score, best = score, k + 1
+        else:
+            score -= 1
+            misses += 1
+            if misses > MISMATCH_RUN:
+                break
+    return best
+
+
+def _find_matches(old, new):
+    """Greedy left-to-right list of (new_off, old_off, length) matches."""
+    index = _seed_index(old)
+    matches = []
+    shift = None   # old_off - new_off of the last match
+    n = lit_start = 0
+
+    while n < len(new):
+        candidates = []
+        if shift is not None and 0 <= n + shift < len(old):
+            candidates.append(n + shift)
+        candidates += index.get(new[n:n + SEED_LEN], [])
+
+        best_o, best_len = 0, 0
+        for o in candidates:
+            length = _extend(old, new, o, n)
+            if length > best_len:
+                best_o, best_len = o, length
+
+        if best_len < MIN_MATCH:
+            n += 1
+            continue
+
+        # Pull the match back over equal bytes still pending as literals
+        while n > lit_start and best_o > 0 and old[best_o - 1] == new[n - 1]:
+            n -= 1
+            best_o -= 1
+            best_len += 1
+
+        matches.append((n, best_o, best_len))
+        shift = best_o - n
+        n += best_len
+        lit_start = n
+
+    return matches
+
+
+def _diff_tokens(old, o, new, n, length):
+    """Encode new[n:n+length] - old[o:o+length] as zero-run/literal tokens."""
+    delta = bytes((new[n + k] - old[o + k]) & 0xFF for k in range(length))
+    out = bytearray()
+    k = 0
+    while k < length:
+        z = k
+        while z < length and delta[z] == 0:
+            z += 1
+        e = z
+        # Literal run; short zero gaps are cheaper inline than a new token
+        while e < length:
+            if delta[e]:
+                e += 1
+                continue
+            gap = 1
+            while gap < 3 and e + gap < length and delta[e + gap] == 0:
+                gap += 1
+            if gap == 3 or e + gap == length:
+                break
+            e += gap
+        out += _varint(z - k) + _varint(e - z) + delta[z:e]
+        k = e
+    return bytes(out)
+
+
+# --- Public API ---
+
+
+def make_patch(old, new):
+    """Build a patch that turns old into new."""
+    out = bytearray(PATCH_MAGIC + struct.pack("<II", len(old), crc32(old)))
+    matches = _find_matches(old, new)
+
+    # Records are (old_off, new_off, diff_len, extra_end)
+    records = []
+    if not matches or matches[0][0] > 0:
+        first = matches[0][0] if matches else len(new)
+        records.append((0, 0, 0, first))
+    for i, (n, o, length) in enumerate(matches):
+        extra_end = matches[i + 1][0] if i + 1 < len(matches) else len(new)
+        records.append((o, n, length, extra_end))
+
+    old_pos = 0
+    for o, n, length, extra_end in records:
+        extra = new[n + length:extra_end]
+        out += _varint(_zigzag(o - old_pos)) + _varint(length) + _varint(len(extra))
+        if length:
+            out += _diff_tokens(old, o, new, n, length)
+        out += extra
+        old_pos = o + length
+
+    return bytes(out)
+
+
+def apply_patch(old, patch):
+    """Reference decoder — mirrors the device's streaming patcher."""
+    if patch[:4] != PATCH_MAGIC or len(patch) < PATCH_HDR_SIZE:
+        raise ValueError("not an EVP1 patch")
+    old_size, old_crc = struct.unpack_from("<II", patch, 4)
+    if len(old) < old_size or crc32(old[:old_size]) != old_crc:
+        raise ValueError("patch base mismatch")
+
+    new = bytearray()
+    pos, old_pos = PATCH_HDR_SIZE, 0
+    while pos < len(patch):
+        seek, pos = _read_varint(patch, pos)
+        diff_len, pos = _read_varint(patch, pos)
+        extra_len, pos = _read_varint(patch, pos)
+        old_pos += (seek >> 1) ^ -(seek & 1)
+        if old_pos < 0 or old_pos + diff_len > old_size:
+            raise ValueError("diff outside old image")
+
+        left = diff_len
+        while left:
+            zeros, pos = _read_varint(patch, pos)
+            lits, pos = _read_varint(patch, pos)
+            if zeros + lits > left:
+                raise ValueError("diff token overruns record")
+            new += old[old_pos:old_pos + zeros]
+            old_pos += zeros
+            for k in range(lits):
+                new.append((old[old_pos + k] + patch[pos + k]) & 0xFF)
+            old_pos += lits
+            pos += lits
+            left -= zeros + lits
+
+        new += patch[pos:pos + extra_len]
+        pos += extra_len
+    return bytes(new)
+
+
+def patch_chunks(patch, chunk_size=CHUNK_DATA_SIZE):
+    """OTA chunks needed to send a patch."""
+    return (len(patch) + chunk_size - 1) // chunk_size
+
+
+# --- Benchmark ---
+
+
+def _delta_chunks(old, new, chunk_size):
+    from ota import compute_delta_chunks
+    return len(compute_delta_chunks(old, new, chunk_size))
+
+
+def compare(old, new, chunk_size=CHUNK_DATA_SIZE):
+    """Chunk counts for one image pair: full, aligned delta, patch."""
+    patch = make_patch(old, new)
+    if apply_patch(old, patch) != new:
+        raise AssertionError("patch does not reproduce the new image")
+    return {
+        "size": len(new),
+        "full": (len(new) + chunk_size - 1) // chunk_size,
+        "delta": _delta_chunks(old, new, chunk_size),
+        "patch": patch_chunks(patch, chunk_size),
+        "patch_bytes": len(patch),
+    }
+
+
+APP_DIR = "app/rak4631_evse_monitor"
+
+
+def build_rev_image(repo, rev, cc):
+    """Build the EVSE app sources at a git revision into a flat code image.
+
+    With arm-none-eabi-gcc this is the app as the device would see it;
+    with a host compiler it is a stand-in with the same function order and
+    call structure, good enough to compare transfer strategies.
+    """
+    tmp = tempfile.mkdtemp(prefix="ota_patch_")
+    try:
+        archive = subprocess.run(
+            ["git", "-C", repo, "archive", rev, APP_DIR, "tests/mocks"],
+            check=True, capture_output=True).stdout
+        subprocess.run(["tar", "-x", "-C", tmp], input=archive, check=True)
+
+        app = os.path.join(tmp, APP_DIR)
+        src_dir = os.path.join(app, "src", "app_evse")
+        sources = sorted(os.path.join(src_dir, f) for f in os.listdir(src_dir)
+                         if f.endswith(".c"))
+        elf = os.path.join(tmp, "app.elf")
+        flags = ["-Os", "-ffunction-sections", "-fdata-sections", "-std=c11",
+                 "-w", "-DHOST_TEST", "-D__ZEPHYR__=0",
+                 "-I", os.path.join(app, "include"),
+                 "-I", os.path.join(tmp, "tests", "mocks")]
+        if "arm-none-eabi" in cc:
+            flags += ["-mcpu=cortex-m4", "-mthumb", "-nostdlib",
+                      "-Wl,--unresolved-symbols=ignore-all", "-Wl,-e,0"]
+        else:
+            flags += ["-fPIC", "-shared"]
+        subprocess.run([cc, *flags, *sources, "-o", elf],
+                       check=True, capture_output=True)
+
+        image = os.path.join(tmp, "app.bin")
+        subprocess.run(["objcopy", "-O", "binary", "-j", ".text", "-j", ".rodata",
+                        elf, image], check=True)
+        with open(image, "rb") as f:
+            return f.read()
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+
+def _print_row(label, r):
+    saved = 100 * (1 - r["patch"] / r["delta"]) if r["delta"] else 0.0
+    print(f"{label:<24} {r['size']:>7} {r['full']:>6} {r['delta']:>6} "
+          f"{r['patch']:>6} {saved:>6.0f}%")
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Compare OTA chunk counts: full image vs aligned delta vs patch")
+    parser.add_argument("images", nargs="*",
+                        help="app.bin files, oldest first (each compared to the previous)")
+    parser.add_argument("--revs", nargs="+", metavar="REV",
+                        help="git revisions to build and compare, oldest first")
+    parser.add_argument("--repo", default=os.path.join(os.path.dirname(__file__), ".."))
+    parser.add_argument("--cc", default=shutil.which("arm-none-eabi-gcc") or "cc")
+    parser.add_argument("--chunk-size", type=int, default=CHUNK_DATA_SIZE)
+    args = parser.parse_args(argv)
+
+    if args.revs:
+        labels = args.revs
+        images = [build_rev_image(args.repo, rev, args.cc) for rev in args.revs]
+        print(f"Built with {args.cc}")
+    else:
+        labels = [os.path.basename(p) for p in args.images]
+        images = []
+        for path in args.images:
+            with open(path, "rb") as f:
+                images.append(f.read())
+    if len(images) < 2:
+        parser.error("need at least two images or revisions")
+
+    print(f"{'pair':<24} {'bytes':>7} {'full':>6} {'delta':>6} {'patch':>6} {'vs delta':>7}")
+    for i in range(1, len(images)):
+        _print_row(f"{labels[i - 1][:11]}..{labels[i][:11]}",
+                   compare(images[i - 1], images[i], args.chunk_size))
+
+
+if __name__ == "__main__":
+    main()
@@ -4,6 +4,7 @@ OTA Sender Lambda — orchestrates app-only firmware updates over Sidewalk.
 Two trigger modes:
 1. S3 PutObject: new firmware binary uploaded → start OTA session
 2. Async invoke from decode Lambda: device ACK received → send next chunk
+   (delta sessions: settle a window of chunks against a bitmap ACK)
 
 Session state tracked in DynamoDB (sentinel key timestamp=-1).
 Firmware cached in /tmp for the duration of the Lambda container.
@@ -28,12 +29,16 @@ TABLE_NAME = os.environ.get("DYNAMODB_TABLE", "evse-events")
 OTA_BUCKET = os.environ.get("OTA_BUCKET", "evse-ota-firmware-dev")
 MAX_RETRIES = int(os.environ.get("OTA_MAX_RETRIES", "5"))
 CHUNK_DATA_SIZE = int(os.environ.get("OTA_CHUNK_SIZE", "15"))  # 15B data + 4B header = 19B (full LoRa MTU)
+# Delta sessions: chunks per device bitmap ACK (0 = ACK every chunk, max 15)
+ACK_EVERY = min(int(os.environ.get("OTA_ACK_EVERY", "8")), 15)
 
 table = dynamodb.Table(TABLE_NAME)
 DEVICE_STATE_TABLE = os.environ.get('DEVICE_STATE_TABLE', 'evse-device-state')
 state_table = dynamodb.Table(DEVICE_STATE_TABLE)
 
 import device_registry  # noqa: E402
+import ota_compress  # noqa: E402
+import ota_patch  # noqa: E402
 from protocol_constants import OTA_CMD_TYPE, crc32, unix_ms_to_mt  # noqa: E402
 
 # --- Protocol constants (must match ota_update.h) ---
@@ -48,9 +53,26 @@ OTA_STATUS_FLASH_ERR = 2
 OTA_STATUS_NO_SESSION = 3
 OTA_STATUS_SIZE_ERR = 4
 OTA_STATUS_SIG_ERR = 5
+OTA_STATUS_PATCH_ERR = 6
+OTA_STATUS_SLOT_ERR = 7
 
 # OTA_START flags
 OTA_START_FLAGS_SIGNED = 0x01
+OTA_START_FLAGS_PATCH = 0x02
+OTA_START_FLAGS_COMPRESSED = 0x04
+OTA_START_FLAGS_SLOT_B = 0x08
+OTA_START_FLAGS_ACK_SHIFT = 4   # bits 4-7: delta ACK interval
+
+# Bitmap ACK: bit i of ack_bitmap = delta chunk ack_base + i received
+OTA_ACK_BITMAP_BITS = 64
+
+PATCH_PREFIX = "ota/patches/"
+COMPRESSED_PREFIX = "ota/compressed/"
+
+# A/B slots: firmware/app-vN.bin is linked for slot A, and its slot B
+# build (if any) is uploaded next to it as firmware/app-vN.slot_b.bin.
+# The baseline's "slot" metadata says which slot the device runs.
+SLOT_B_SUFFIX = ".slot_b.bin"
 
 # Module-level cache
 _firmware_cache = {}  # key -> bytes
@@ -99,6 +121,39 @@ def load_firmware(bucket, key):
     return data
 
 
+def load_payload(session):
+    """Bytes the chunks are cut from: the patch or compressed image when the
+    session has a payload_key, else the firmware."""
+    return load_firmware(session["s3_bucket"],
+                         session.get("payload_key") or session["s3_key"])
+
+
+def slot_b_key(key):
+    """S3 key of the slot B build of a slot A firmware key."""
+    return key[:-len(".bin")] + SLOT_B_SUFFIX if key.endswith(".bin") else key + SLOT_B_SUFFIX
+
+
+def session_start_flags(session):
+    """OTA_START flags byte for a session."""
+    flags = OTA_START_FLAGS_SIGNED if session.get("is_signed") else 0
+    if session.get("slot") == "b":
+        flags |= OTA_START_FLAGS_SLOT_B
+    if session.get("payload_key"):
+        # Sessions written before payload_flags existed were all patches
+        flags |= int(session.get("payload_flags", OTA_START_FLAGS_PATCH))
+    if session.get("delta_chunks"):
+        # Part of the session's identity on the device: kept even once
+        # the sender has fallen back to per-chunk ACKs
+        flags |= int(session.get("ack_every", 0)) << OTA_START_FLAGS_ACK_SHIFT
+    return flags
+
+
+def store_payload(bucket, key, data):
+    """Upload a derived payload and keep it in the firmware cache."""
+    s3.put_object(Bucket=bucket, Key=key, Body=data)
+    _firmware_cache[f"{bucket}/{key}"] = data
+
+
 # --- Session state in device-state table (ADR-006) ---
 
 def _get_sc_id():
@@ -183,6 +238,32 @@ def log_ota_event(event_type, details):
     table.put_item(Item=item)
 
 
+def count_uplink(session):
+    """Count a device uplink against the session. Stored on its own so
+    that ACKs the sender ignores do not refresh updated_at."""
+    uplinks = int(session.get("uplinks", 0)) + 1
+    session["uplinks"] = uplinks
+    state_table.update_item(
+        Key={"device_id": _get_sc_id()},
+        UpdateExpression="SET ota_uplinks = :n",
+        ExpressionAttributeValues={":n": uplinks},
+    )
+
+
+def session_metrics(session):
+    """Cost of a session so far, for its ota_complete/ota_aborted event."""
+    if not session:
+        return {}
+    started_at = int(session.get("started_at", 0))
+    return {
+        "uplinks": int(session.get("uplinks", 0)),
+        "wall_s": int(time.time()) - started_at if started_at else None,
+        "mode": session.get("mode"),
+        "ack_every": int(session.get("ack_every", 0)),
+        "total_chunks": int(session.get("total_chunks", 0)),
+    }
+
+
 # --- OTA message builders ---
 
 def build_ota_start(total_size, total_chunks, chunk_size, fw_crc32, version, flags=0):
@@ -253,6 +334,36 @@ def handle_s3_trigger(record):
     if key.endswith("/baseline.bin"):
         print(f"Skipping baseline file: {key}")
         return
+    if key.endswith(SLOT_B_SUFFIX):
+        print(f"Skipping slot B build (sent with its slot A key): {key}")
+        return
+
+    # Slot the device runs, as recorded with the baseline by the last
+    # successful update. Devices that never had an A/B update run A.
+    baseline_key = "ota/baseline.bin"
+    device_slot = "a"
+    try:
+        head = s3.head_object(Bucket=bucket, Key=baseline_key)
+        device_slot = head.get("Metadata", {}).get("slot", "a")
+    except Exception:
+        pass
+
+    # Running A with a slot B build available: send that one, received
+    # straight into slot B. Running B: the slot A build goes into slot A.
+    # Otherwise slot A is rewritten through staging (copy path).
+    slot = "a"
+    alt_key = ""
+    if device_slot == "a":
+        try:
+            load_firmware(bucket, slot_b_key(key))
+            slot = "b"
+            alt_key = key
+            key = slot_b_key(key)
+        except Exception:
+            pass
+    direct = slot != device_slot
+    print(f"Device runs slot {device_slot.upper()}, sending slot {slot.upper()} build"
+          f"{' (direct)' if direct else ''}: {key}")
 
     firmware = load_firmware(bucket, key)
     fw_size = len(firmware)
@@ -279,11 +390,11 @@ def handle_s3_trigger(record):
         except ValueError:
             pass
 
-    # Check for baseline firmware to enable delta mode
+    # Check for baseline firmware to enable delta and patch modes
     delta_chunks_list = None
-    baseline_key = "ota/baseline.bin"
     baseline_crc = None
     baseline_size = None
+    patch = None
     try:
         baseline = load_firmware(bucket, baseline_key)
         baseline_crc = crc32(baseline)
@@ -291,13 +402,44 @@ def handle_s3_trigger(record):
         delta_chunks_list = compute_delta_chunks(baseline, firmware, CHUNK_DATA_SIZE)
         print(f"Delta mode: {len(delta_chunks_list)}/{full_chunks} chunks changed: {delta_chunks_list}")
         print(f"Baseline: {baseline_size}B, CRC32=0x{baseline_crc:08x}")
+        patch = ota_patch.make_patch(baseline, firmware)
+        print(f"Patch mode: {len(patch)}B, {ota_patch.patch_chunks(patch, CHUNK_DATA_SIZE)} chunks")
     except Exception as e:
         print(f"No baseline ({e}), using full OTA")
 
-    # Delta mode: send fewer chunks
-    if delta_chunks_list is not None and len(delta_chunks_list) < full_chunks:
-        total_chunks = len(delta_chunks_list)
+    # A full image goes out compressed when that saves chunks
+    compressed = ota_compress.compress(firmware)
+    lz_count = (len(compressed) + CHUNK_DATA_SIZE - 1) // CHUNK_DATA_SIZE
+    print(f"Compressed: {len(compressed)}/{fw_size}B "
+          f"({100 * (1 - len(compressed) / max(fw_size, 1)):.0f}% smaller), {lz_count} chunks")
+
+    # Delta and patch are both against the running slot (the baseline): a
+    # direct delta has its unchanged chunks copied over from it
+    delta_count = len(delta_chunks_list) if delta_chunks_list is not None else full_chunks
+    patch_count = ota_patch.patch_chunks(patch, CHUNK_DATA_SIZE) if patch else full_chunks
+
+    # Send whichever of patch, delta, compressed and raw image takes the
+    # fewest chunks
+    payload_key = ""
+    payload_flags = 0
+    name = key.rsplit("/", 1)[-1]
+    if patch_count < min(delta_count, full_chunks, lz_count):
+        total_chunks = patch_count
+        delta_chunks_list = None
+        mode = "patch"
+        payload_key = PATCH_PREFIX + name + ".patch"
+        payload_flags = OTA_START_FLAGS_PATCH
+        store_payload(bucket, payload_key, patch)
+    elif delta_count < min(full_chunks, lz_count):
+        total_chunks = delta_count
         mode = "delta"
+    elif lz_count < full_chunks:
+        total_chunks = lz_count
+        delta_chunks_list = None
+        mode = "compressed"
+        payload_key = COMPRESSED_PREFIX + name + ".lz"
+        payload_flags = OTA_START_FLAGS_COMPRESSED
+        store_payload(bucket, payload_key, compressed)
     else:
         total_chunks = full_chunks
         delta_chunks_list = None
@@ -308,7 +450,11 @@ def handle_s3_trigger(record):
           f"mode={mode}")
 
     # Compute flags byte for OTA_START
-    ota_flags = OTA_START_FLAGS_SIGNED if is_signed else 0
+    ota_flags = (OTA_START_FLAGS_SIGNED if is_signed else 0) | payload_flags
+    if slot == "b":
+        ota_flags |= OTA_START_FLAGS_SLOT_B
+    ack_every = ACK_EVERY if delta_chunks_list is not None else 0
+    ota_flags |= ack_every << OTA_START_FLAGS_ACK_SHIFT
 
     # Save session state
     session_data = {
@@ -324,13 +470,24 @@ def handle_s3_trigger(record):
         "retries": 0,
         "started_at": int(time.time()),
         "is_signed": is_signed,
+        "slot": slot,
+        "mode": mode,
+        "uplinks": 0,
     }
+    if alt_key:
+        session_data["alt_key"] = alt_key
+    if payload_key:
+        session_data["payload_key"] = payload_key
+        session_data["payload_flags"] = payload_flags
     if baseline_crc is not None:
         session_data["baseline_crc32"] = baseline_crc
         session_data["baseline_size"] = baseline_size
     if delta_chunks_list is not None:
         session_data["delta_chunks"] = json.dumps(delta_chunks_list)
         session_data["delta_cursor"] = 0
+        session_data["ack_every"] = ack_every
+        session_data["windowed"] = ack_every > 0
+        session_data["in_flight"] = "[]"
     write_session(session_data)
 
     log_ota_event("ota_start", {
@@ -342,10 +499,14 @@ def handle_s3_trigger(record):
         "version": version,
         "mode": mode,
         "delta_chunks": delta_chunks_list,
+        "patch_chunks": patch_count if patch else None,
+        "compressed_chunks": lz_count,
         "is_signed": is_signed,
+        "slot": slot,
+        "ack_every": ack_every,
     })
 
-    # Send OTA_START (with flags byte if signed)
+    # Send OTA_START (with flags byte if signed, patch or compressed)
     msg = build_ota_start(fw_size, total_chunks, CHUNK_DATA_SIZE, fw_crc, version,
                           flags=ota_flags)
     send_sidewalk_msg(msg)
@@ -365,6 +526,7 @@ def handle_device_ack(ack_data):
     if not session:
         print("No active OTA session, ignoring ACK")
         return {"statusCode": 200, "body": "no session"}
+    count_uplink(session)
 
     if status != OTA_STATUS_OK:
         # NO_SESSION: device has no active OTA session. Re-send START so it
@@ -373,14 +535,15 @@ def handle_device_ack(ack_data):
             restarts = int(session.get("restarts", 0)) + 1
             if restarts > 3:
                 print("NO_SESSION: restart limit (3) exceeded, aborting")
-                log_ota_event("ota_aborted", {"reason": "no_session_max_restarts"})
+                log_ota_event("ota_aborted", {"reason": "no_session_max_restarts",
+                                              **session_metrics(session)})
                 clear_session()
                 return {"statusCode": 200, "body": "aborted: no_session restarts"}
 
             print(f"NO_SESSION: re-sending OTA_START (restart {restarts}/3)")
             firmware = load_firmware(session["s3_bucket"], session["s3_key"])
             fw_crc = crc32(firmware)
-            retry_flags = OTA_START_FLAGS_SIGNED if session.get("is_signed") else 0
+            retry_flags = session_start_flags(session)
             msg = build_ota_start(
                 int(session["fw_size"]),
                 int(session["total_chunks"]),
@@ -396,24 +559,30 @@ def handle_device_ack(ack_data):
             send_sidewalk_msg(msg)
             return {"statusCode": 200, "body": f"no_session: resent START (restart {restarts})"}
 
+        # PATCH_ERR: the device's primary is not the patch base, or the
+        # patch or compressed stream would not decode. Start over with the
+        # raw image.
+        if status == OTA_STATUS_PATCH_ERR and session.get("payload_key"):
+            return restart_full_image(session)
+
+        # SLOT_ERR: the device does not run the slot the baseline says
+        if status == OTA_STATUS_SLOT_ERR:
+            return restart_other_slot(session)
+
         retries = int(session.get("retries", 0)) + 1
         if retries > MAX_RETRIES:
             print(f"Max retries ({MAX_RETRIES}) exceeded, aborting OTA")
-            log_ota_event("ota_aborted", {"reason": "max_retries", "last_status": status})
+            log_ota_event("ota_aborted", {"reason": "max_retries", "last_status": status,
+                                          **session_metrics(session)})
             clear_session()
             send_sidewalk_msg(build_ota_abort())
             return {"statusCode": 200, "body": "aborted: max retries"}
 
         # Retry the chunk that failed — in delta mode, look up correct abs index
-        delta_chunks_json = session.get("delta_chunks")
-        if delta_chunks_json:
-            delta_list = json.loads(delta_chunks_json)
-            delta_cursor = int(session.get("delta_cursor", 0))
-            if delta_cursor < len(delta_list):
-                retry_idx = delta_list[delta_cursor]
-            else:
-                retry_idx = int(next_chunk)
-        else:
+        retry_idx = None
+        if session.get("delta_chunks"):
+            retry_idx = delta_retry_idx(session, 0)
+        if retry_idx is None:
             retry_idx = int(next_chunk)
 
         print(f"Retrying chunk {retry_idx} (attempt {retries})")
@@ -423,20 +592,37 @@ def handle_device_ack(ack_data):
                        "retries": retries,
                        "status": "retrying"})
 
-        firmware = load_firmware(session["s3_bucket"], session["s3_key"])
-        send_chunk(firmware, retry_idx, int(session["chunk_size"]))
+        send_chunk(load_payload(session), retry_idx, int(session["chunk_size"]))
         return {"statusCode": 200, "body": f"retrying chunk {retry_idx}"}
 
     # Success — send next chunk (ignore stale/duplicate ACKs)
     total_chunks = int(session["total_chunks"])
     highest_acked = int(session.get("highest_acked", 0))
 
-    if chunks_received < highest_acked:
+    # Reply to OTA_START: 0 for a fresh session, or how far a session that
+    # survived a device reboot got. Resume from there, even if it is behind
+    # what was ACKed before the reboot.
+    start_reply = session.get("status") in ("starting", "restarting")
+    if start_reply and chunks_received:
+        print(f"Device resumed session at {chunks_received}/{total_chunks} chunks")
+        log_ota_event("ota_resumed", {"chunks_received": chunks_received,
+                                      "highest_acked": highest_acked,
+                                      "total_chunks": total_chunks})
+    elif not start_reply and chunks_received < highest_acked:
         print(f"Stale ACK: device reports {chunks_received} received but we saw {highest_acked}, ignoring")
         return {"statusCode": 200, "body": f"stale ack {chunks_received}"}
 
-    # Delta mode: map sequential ACK counter to absolute chunk index
+    # Windowed delta: the START reply opens the window, bitmap ACKs move it
     delta_chunks_json = session.get("delta_chunks")
+    if delta_chunks_json and session.get("windowed"):
+        if start_reply or "ack_bitmap" in ack_data:
+            return send_delta_window(session, ack_data, start_reply)
+        # Firmware without bitmap ACKs answers each chunk with a plain ACK
+        print("Plain ACK in a windowed session: falling back to per-chunk ACKs")
+        session["windowed"] = False
+        session["in_flight"] = "[]"
+
+    # Delta mode: map sequential ACK counter to absolute chunk index
     if delta_chunks_json:
         delta_list = json.loads(delta_chunks_json)
         delta_cursor = int(chunks_received)  # device counts received deltas sequentially
@@ -468,7 +654,8 @@ def handle_device_ack(ack_data):
     # Full mode: next_chunk is the sequential index
     chunk_idx = int(next_chunk)
 
-    if chunks_received == highest_acked and chunk_idx <= int(session.get("next_chunk", 0)):
+    if (not start_reply and chunks_received == highest_acked
+            and chunk_idx <= int(session.get("next_chunk", 0))):
         print(f"Duplicate ACK: chunk {chunk_idx} already sent (received={chunks_received}), ignoring")
         return {"statusCode": 200, "body": f"dup ack {chunk_idx}"}
 
@@ -488,12 +675,173 @@ def handle_device_ack(ack_data):
                    "status": "sending",
                    "highest_acked": chunks_received})
 
-    firmware = load_firmware(session["s3_bucket"], session["s3_key"])
-    send_chunk(firmware, chunk_idx, int(session["chunk_size"]))
+    send_chunk(load_payload(session), chunk_idx, int(session["chunk_size"]))
 
     return {"statusCode": 200, "body": f"sent chunk {chunk_idx}/{total_chunks}"}
 
 
+def bitmap_chunks(ack_data):
+    """Absolute chunk indices a bitmap ACK shows the device holding."""
+    if "ack_bitmap" not in ack_data:
+        return set()
+    base = int(ack_data.get("ack_base", 0))
+    bitmap = int(ack_data["ack_bitmap"])
+    return {base + i for i in range(OTA_ACK_BITMAP_BITS) if bitmap >> i & 1}
+
+
+def delta_retry_idx(session, default_cursor):
+    """Absolute index to resend in a delta session: the oldest chunk in
+    flight, else the one at the cursor. None past the end of the list."""
+    delta_list = json.loads(session["delta_chunks"])
+    in_flight = json.loads(session.get("in_flight") or "[]")
+    pos = min(in_flight) if in_flight else int(session.get("delta_cursor", default_cursor))
+    return delta_list[pos] if pos < len(delta_list) else None
+
+
+def send_delta_window(session, ack_data, start_reply):
+    """Windowed delta session: settle the chunks in flight against the
+    device's bitmap ACK, resend the ones it skipped and top the window up
+    to twice the ACK interval.
+
+    in_flight holds positions in delta_chunks, delta_cursor the next one
+    not yet sent. delta_chunks is ascending and the device ACKs from the
+    lowest chunk it got since its last ACK, so a chunk still in flight
+    below one the ACK shows received was lost."""
+    delta_list = json.loads(session["delta_chunks"])
+    window = 2 * int(session["ack_every"])
+    chunks_received = int(ack_data.get("chunks_received", 0))
+    in_flight = json.loads(session.get("in_flight") or "[]")
+    cursor = int(session.get("delta_cursor", 0))
+    held = bitmap_chunks(ack_data)
+
+    if start_reply:
+        # A resumed session restarts a window behind the device's count;
+        # chunks it already holds come back as duplicate bitmap ACKs
+        in_flight = []
+        cursor = max(0, chunks_received - window)
+
+    acked = {p for p in in_flight if delta_list[p] in held}
+    top = max(acked, default=-1)
+    in_flight = [p for p in in_flight if p not in acked]
+    resend = [p for p in in_flight if p < top]
+
+    def fill(cursor):
+        sent = []
+        while len(in_flight) < window and cursor < len(delta_list):
+            if delta_list[cursor] not in held:
+                in_flight.append(cursor)
+                sent.append(cursor)
+            cursor += 1
+        return cursor, sent
+
+    cursor, new = fill(cursor)
+    if not in_flight and chunks_received < len(delta_list):
+        # Everything was sent, yet chunks are missing below where a
+        # resumed window started: go over the list again
+        print(f"Delta window: device has {chunks_received}/{len(delta_list)}, rescanning")
+        cursor, new = fill(0)
+
+    status = "sending" if in_flight else "validating"
+    write_session({**{k: v for k, v in session.items()
+                     if k not in ("device_id", "updated_at")},
+                   "delta_cursor": cursor,
+                   "in_flight": json.dumps(sorted(in_flight)),
+                   "retries": 0,
+                   "status": status,
+                   "highest_acked": chunks_received})
+
+    firmware = load_firmware(session["s3_bucket"], session["s3_key"])
+    chunk_size = int(session["chunk_size"])
+    for p in resend + new:
+        send_chunk(firmware, delta_list[p], chunk_size)
+
+    print(f"Delta window: {len(acked)} acked, {len(resend)} resent, {len(new)} new, "
+          f"{len(in_flight)} in flight, cursor {cursor}/{len(delta_list)}")
+    if not in_flight:
+        return {"statusCode": 200, "body": "all delta chunks sent, awaiting COMPLETE"}
+    return {"statusCode": 200,
+            "body": f"delta window: {len(resend)} resent, {len(new)} new, "
+                    f"cursor {cursor}/{len(delta_list)}"}
+
+
+def restart_full_image(session):
+    """Drop patch/compressed mode and restart the session with the raw image."""
+    firmware = load_firmware(session["s3_bucket"], session["s3_key"])
+    chunk_size = int(session["chunk_size"])
+    full_chunks = (len(firmware) + chunk_size - 1) // chunk_size
+    print(f"PATCH_ERR: payload rejected, restarting with full image ({full_chunks} chunks)")
+    log_ota_event("ota_patch_rejected", {"payload_key": session.get("payload_key")})
+
+    write_session({**{k: v for k, v in session.items()
+                     if k not in ("device_id", "updated_at")},
+                   "payload_key": "",
+                   "payload_flags": 0,
+                   "mode": "legacy",
+                   "total_chunks": full_chunks,
+                   "next_chunk": 0,
+                   "highest_acked": 0,
+                   "retries": 0,
+                   "status": "starting"})
+    flags = OTA_START_FLAGS_SIGNED if session.get("is_signed") else 0
+    if session.get("slot") == "b":
+        flags |= OTA_START_FLAGS_SLOT_B
+    send_sidewalk_msg(build_ota_start(len(firmware), full_chunks, chunk_size,
+                                      crc32(firmware), int(session.get("version", 0)),
+                                      flags=flags))
+    return {"statusCode": 200, "body": f"patch rejected: full image restart ({full_chunks} chunks)"}
+
+
+def restart_other_slot(session):
+    """The device rejected the session's slot: it got a slot B build while
+    running B. Restart once with the raw slot A build, which every device
+    can take."""
+    if session.get("slot_retried"):
+        print("SLOT_ERR: slot A build rejected too, aborting")
+        log_ota_event("ota_aborted", {"reason": "slot_err", **session_metrics(session)})
+        clear_session()
+        return {"statusCode": 200, "body": "aborted: slot_err"}
+
+    key = session.get("alt_key") or session["s3_key"]
+    firmware = load_firmware(session["s3_bucket"], key)
+    chunk_size = int(session["chunk_size"])
+    full_chunks = (len(firmware) + chunk_size - 1) // chunk_size
+    print(f"SLOT_ERR: device runs the other slot, restarting with {key} "
+          f"({full_chunks} chunks)")
+    log_ota_event("ota_slot_rejected", {"slot": session.get("slot", "a"), "s3_key": key})
+
+    session = {k: v for k, v in session.items()
+               if k not in ("device_id", "updated_at", "delta_chunks",
+                            "delta_cursor", "alt_key", "ack_every", "windowed",
+                            "in_flight")}
+    is_signed = session.get("is_signed")
+    if key != session["s3_key"]:
+        try:
+            head = s3.head_object(Bucket=session["s3_bucket"], Key=key)
+            is_signed = head.get("Metadata", {}).get("signed", "").lower() == "true"
+        except Exception as e:
+            print(f"Warning: could not read S3 metadata: {e}")
+    write_session({**session,
+                   "s3_key": key,
+                   "slot": "a",
+                   "slot_retried": True,
+                   "is_signed": is_signed,
+                   "fw_size": len(firmware),
+                   "fw_crc32": crc32(firmware),
+                   "payload_key": "",
+                   "payload_flags": 0,
+                   "mode": "legacy",
+                   "total_chunks": full_chunks,
+                   "next_chunk": 0,
+                   "highest_acked": 0,
+                   "retries": 0,
+                   "status": "starting"})
+    flags = OTA_START_FLAGS_SIGNED if is_signed else 0
+    send_sidewalk_msg(build_ota_start(len(firmware), full_chunks, chunk_size,
+                                      crc32(firmware), int(session.get("version", 0)),
+                                      flags=flags))
+    return {"statusCode": 200, "body": f"slot rejected: slot A restart ({full_chunks} chunks)"}
+
+
 def handle_device_complete(complete_data):
     """Device finished — log result and clean up session."""
     result = complete_data.get("result", 255)
@@ -502,24 +850,31 @@ def handle_device_complete(complete_data):
     print(f"Device COMPLETE: result={result} crc={crc_calc}")
 
     session = get_session()
+    if session:
+        session["uplinks"] = int(session.get("uplinks", 0)) + 1
 
     log_ota_event("ota_complete", {
         "result": result,
         "crc32_calc": crc_calc,
         "success": result == OTA_STATUS_OK,
+        **session_metrics(session),
     })
 
     if result == OTA_STATUS_OK and session:
-        # Save successful firmware as baseline for future delta OTAs
+        # Save successful firmware as baseline for future delta OTAs, with
+        # the slot the device now runs
         try:
             src_bucket = session.get("s3_bucket", OTA_BUCKET)
             src_key = session["s3_key"]
+            slot = session.get("slot", "a")
             s3.copy_object(
                 Bucket=src_bucket,
                 CopySource={"Bucket": src_bucket, "Key": src_key},
                 Key="ota/baseline.bin",
+                Metadata={"slot": slot},
+                MetadataDirective="REPLACE",
             )
-            print(f"Saved baseline: s3://{src_bucket}/ota/baseline.bin")
+            print(f"Saved baseline: s3://{src_bucket}/ota/baseline.bin (slot {slot.upper()})")
         except Exception as e:
             print(f"Failed to save baseline: {e}")
 
@@ -549,7 +904,8 @@ def handle_retry_check(event):
     retries = int(session.get("retries", 0)) + 1
     if retries > MAX_RETRIES:
         print("Session stale and max retries exceeded, aborting")
-        log_ota_event("ota_aborted", {"reason": "stale_max_retries"})
+        log_ota_event("ota_aborted", {"reason": "stale_max_retries",
+                                      **session_metrics(session)})
         clear_session()
         return {"statusCode": 200, "body": "aborted: stale"}
 
@@ -558,17 +914,26 @@ def handle_retry_check(event):
 
     print(f"Session stale ({elapsed}s), retrying: status={status} chunk={next_chunk}")
 
+    resend_start = status in ("starting", "validating", "restarting")
+    if not resend_start:
+        retry_status = "retrying"
+    elif status == "starting":
+        retry_status = "starting"
+    else:
+        # The device's answer to this START says where it resumes
+        retry_status = "restarting"
+
     write_session({**{k: v for k, v in session.items()
                      if k not in ("device_id", "updated_at")},
                    "retries": retries,
-                   "status": "retrying"})
+                   "status": retry_status})
 
-    if status in ("starting", "validating", "restarting"):
+    if resend_start:
         # Re-send START — covers initial start, lost COMPLETE (validating),
         # and NO_SESSION restart. Device will reply COMPLETE if already applied.
         firmware = load_firmware(session["s3_bucket"], session["s3_key"])
         fw_crc = crc32(firmware)
-        retry_flags = OTA_START_FLAGS_SIGNED if session.get("is_signed") else 0
+        retry_flags = session_start_flags(session)
         msg = build_ota_start(
             int(session["fw_size"]),
             int(session["total_chunks"]),
@@ -580,19 +945,18 @@ def handle_retry_check(event):
         send_sidewalk_msg(msg)
     else:
         # Re-send the chunk the device is waiting for
-        firmware = load_firmware(session["s3_bucket"], session["s3_key"])
-
-        # Delta mode: look up absolute index from delta list
-        delta_chunks_json = session.get("delta_chunks")
-        if delta_chunks_json:
-            delta_list = json.loads(delta_chunks_json)
-            delta_cursor = int(session.get("delta_cursor", next_chunk))
-            if delta_cursor < len(delta_list):
-                abs_idx = delta_list[delta_cursor]
-                print(f"Delta retry: cursor={delta_cursor} abs_idx={abs_idx}")
+        firmware = load_payload(session)
+
+        # Delta mode: look up absolute index from delta list. A windowed
+        # session resends its oldest chunk in flight: if the device has
+        # it, its duplicate ACK carries the bitmap that moves the window.
+        if session.get("delta_chunks"):
+            abs_idx = delta_retry_idx(session, next_chunk)
+            if abs_idx is not None:
+                print(f"Delta retry: abs_idx={abs_idx}")
                 send_chunk(firmware, abs_idx, int(session["chunk_size"]))
             else:
-                print(f"Delta retry: cursor {delta_cursor} past end, ignoring")
+                print("Delta retry: cursor past end, ignoring")
         else:
             send_chunk(firmware, next_chunk, int(session["chunk_size"]))
 
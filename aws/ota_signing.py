@@ -1,14 +1,17 @@
 """
 OTA Firmware Signing — ED25519 sign/verify for app OTA images.
 
-Signs firmware binaries by appending a 64-byte ED25519 signature.
-The device verifies the signature before applying the update.
+Signs firmware binaries by appending a 64-byte ED25519 signature over
+the SHA-256 digest of the firmware. Signing the digest rather than the
+image lets the device hash staging flash page by page and verify with
+one page of RAM, for images up to the full staging size.
 
 Key storage:
     Private key: ~/.evse-monitor/ota_signing.key (PEM)
     Public key:  ~/.evse-monitor/ota_signing.pub (PEM)
 """
 
+import hashlib
 import os
 
 from cryptography.hazmat.primitives.asymmetric.ed25519 import (
@@ -66,9 +69,14 @@ def load_public_key():
         return load_pem_public_key(f.read())
 
 
+def firmware_digest(firmware):
+    """SHA-256 digest of the firmware: the message the signature covers."""
+    return hashlib.sha256(firmware).digest()
+
+
 def sign_firmware(firmware, private_key):
     """Sign firmware and return firmware + 64-byte ED25519 signature appended."""
-    signature = private_key.sign(firmware)
+    signature = private_key.sign(firmware_digest(firmware))
     assert len(signature) == OTA_SIG_SIZE
     return firmware + signature
 
@@ -80,7 +88,7 @@ def verify_signature(signed_bin, public_key):
     firmware = signed_bin[:-OTA_SIG_SIZE]
     signature = signed_bin[-OTA_SIG_SIZE:]
     try:
-        public_key.verify(signature, firmware)
+        public_key.verify(signature, firmware_digest(firmware))
         return True
     except Exception:
         return False
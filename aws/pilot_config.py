@@ -0,0 +1,128 @@
+"""
+Pilot config downlink — tune the device's J1772 pilot classifier.
+
+Encodes the 0x50 downlink (firmware pilot_config.h, TDD §4.6):
+
+    [0x50, a_b_le16, b_c_le16, c_d_le16, d_e_le16, hyst_10mv, debounce|filter<<4]
+
+A bare [0x50] restores the compiled-in defaults. Tuning lives in RAM
+and reverts to the defaults on reboot. When CMD_AUTH_KEY is set the
+payload is signed like charge control (8-byte HMAC tag appended).
+
+Usage:
+    python3 pilot_config.py --hysteresis 200 --debounce 4
+    python3 pilot_config.py --thresholds 2600 1850 1100 350 --filter trimmed
+    python3 pilot_config.py --reset
+"""
+
+import argparse
+import struct
+import sys
+
+from cmd_auth import get_auth_key, sign_command
+from sidewalk_utils import send_sidewalk_msg
+
+PILOT_CONFIG_CMD = 0x50
+HYSTERESIS_UNIT_MV = 10
+
+FILTER_MEDIAN = 0
+FILTER_TRIMMED_MEAN = 1
+FILTERS = {"median": FILTER_MEDIAN, "trimmed": FILTER_TRIMMED_MEAN}
+
+# Must match the defaults in evse_sensors.c
+DEFAULT_THRESHOLDS_MV = (2600, 1850, 1100, 350)   # A/B, B/C, C/D, D/E
+DEFAULT_HYSTERESIS_MV = 150
+DEFAULT_DEBOUNCE = 3
+DEBOUNCE_MAX = 15
+
+
+def encode_pilot_config(thresholds_mv=DEFAULT_THRESHOLDS_MV,
+                        hysteresis_mv=DEFAULT_HYSTERESIS_MV,
+                        debounce=DEFAULT_DEBOUNCE, filter=FILTER_MEDIAN):
+    """Build the 11-byte 0x50 payload (unsigned).
+
+    Applies the same checks as the firmware, so a config it would
+    reject is refused here instead of being sent.
+    """
+    if len(thresholds_mv) != 4:
+        raise ValueError("need four thresholds (A/B, B/C, C/D, D/E)")
+    if hysteresis_mv % HYSTERESIS_UNIT_MV or not 0 <= hysteresis_mv <= 255 * HYSTERESIS_UNIT_MV:
+        raise ValueError(f"hysteresis must be 0..{255 * HYSTERESIS_UNIT_MV} mV "
+                         f"in {HYSTERESIS_UNIT_MV} mV steps")
+    if not 1 <= debounce <= DEBOUNCE_MAX:
+        raise ValueError(f"debounce must be 1..{DEBOUNCE_MAX} reads")
+    if filter not in FILTERS.values():
+        raise ValueError(f"unknown filter {filter}")
+    for t in thresholds_mv:
+        if not 0 <= t <= 0xFFFF:
+            raise ValueError(f"threshold {t} mV out of range")
+    for hi, lo in zip(thresholds_mv, thresholds_mv[1:]):
+        if hi - lo <= 2 * hysteresis_mv:
+            raise ValueError(f"thresholds {hi} and {lo} mV must be more than "
+                             f"twice the hysteresis apart")
+
+    return (bytes([PILOT_CONFIG_CMD])
+            + struct.pack("<4H", *thresholds_mv)
+            + bytes([hysteresis_mv // HYSTERESIS_UNIT_MV, debounce | (filter << 4)]))
+
+
+def encode_pilot_reset():
+    """Build the 1-byte payload that restores the defaults."""
+    return bytes([PILOT_CONFIG_CMD])
+
+
+def sign(payload_bytes, auth_key=None):
+    """Append the command auth tag when a key is configured."""
+    key = auth_key if auth_key is not None else get_auth_key()
+    if key:
+        return payload_bytes + sign_command(payload_bytes, key)
+    return payload_bytes
+
+
+def send_pilot_config(payload_bytes, wireless_device_id=None):
+    """Sign and send a 0x50 payload. Returns the bytes sent."""
+    payload_bytes = sign(payload_bytes)
+    send_sidewalk_msg(payload_bytes, transmit_mode=1,
+                      wireless_device_id=wireless_device_id)
+    return payload_bytes
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Send a J1772 pilot classifier config (0x50) downlink")
+    parser.add_argument("--thresholds", type=int, nargs=4,
+                        default=list(DEFAULT_THRESHOLDS_MV),
+                        metavar=("A_B", "B_C", "C_D", "D_E"),
+                        help="state boundaries in mV (default: %(default)s)")
+    parser.add_argument("--hysteresis", type=int, default=DEFAULT_HYSTERESIS_MV,
+                        help="mV either side of a boundary (default: %(default)s)")
+    parser.add_argument("--debounce", type=int, default=DEFAULT_DEBOUNCE,
+                        help="consecutive scans to accept a change (default: %(default)s)")
+    parser.add_argument("--filter", choices=sorted(FILTERS), default="median",
+                        help="burst reduction (default: %(default)s)")
+    parser.add_argument("--reset", action="store_true",
+                        help="restore the device defaults")
+    parser.add_argument("--device", help="wireless device id (default: first found)")
+    parser.add_argument("--dry-run", action="store_true",
+                        help="print the payload without sending it")
+    args = parser.parse_args(argv)
+
+    try:
+        if args.reset:
+            payload = encode_pilot_reset()
+        else:
+            payload = encode_pilot_config(tuple(args.thresholds), args.hysteresis,
+                                          args.debounce, FILTERS[args.filter])
+    except ValueError as e:
+        print(f"ERROR: {e}")
+        return 1
+
+    if args.dry_run:
+        print(f"{sign(payload).hex()} ({len(sign(payload))}B)")
+        return 0
+    send_pilot_config(payload, args.device)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
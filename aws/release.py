@@ -8,14 +8,19 @@ import os
 import subprocess
 import sys
 
+import app_layout
+import ota_patch
+
 # --- Paths ---
 REPO_ROOT = "/Users/emilyf/sidewalk-projects/rak-sid"
 VERSION_PATH = os.path.join(REPO_ROOT, "app/rak4631_evse_monitor/BUILD_VERSION")
 PLATFORM_VERSION_PATH = os.path.join(REPO_ROOT, "app/rak4631_evse_monitor/PLATFORM_BUILD_VERSION")
+LAYOUT_PATH = os.path.join(REPO_ROOT, "app/rak4631_evse_monitor/app_layout.ld")
 PYOCD = "/Users/emilyf/sidewalk-env/bin/pyocd"
 BUILD_APP_DIR = "build_app"
 APP_BIN = os.path.join(BUILD_APP_DIR, "app.bin")
 APP_HEX = os.path.join(BUILD_APP_DIR, "app.hex")
+APP_MAP = os.path.join(BUILD_APP_DIR, "app.map")
 FLASH_SCRIPT = os.path.join(REPO_ROOT, "app/rak4631_evse_monitor/flash.sh")
 
 NRFUTIL_PREFIX = (
@@ -81,11 +86,15 @@ def git_check_tag(tag):
 
 
 def git_commit_and_tag(version, tag_prefix="app-v"):
-    """Commit the VERSION file change and create an annotated git tag."""
+    """Commit the VERSION file (and app layout) change and create an
+    annotated git tag."""
     tag = f"{tag_prefix}{version}"
 
+    paths = [VERSION_PATH]
+    if os.path.exists(LAYOUT_PATH):
+        paths.append(LAYOUT_PATH)
     subprocess.run(
-        ["git", "add", VERSION_PATH], check=True, cwd=REPO_ROOT,
+        ["git", "add", *paths], check=True, cwd=REPO_ROOT,
     )
     subprocess.run(
         ["git", "commit", "-m", f"Release {tag}"],
@@ -101,13 +110,18 @@ def git_commit_and_tag(version, tag_prefix="app-v"):
 # --- Build helpers ---
 
 
-def build_app():
-    """Build the EVSE app via nrfutil toolchain-manager."""
-    print("Building app...")
+def build_app(stable=False):
+    """Build the EVSE app via nrfutil toolchain-manager.
+
+    stable: link with the previous release's slot map (app_layout.ld) so
+    unchanged functions keep their addresses for delta OTA.
+    """
+    print(f"Building app{' (stable layout)' if stable else ''}...")
+    layout_opt = " -DAPP_STABLE_LAYOUT=ON" if stable else ""
     build_cmd = (
         f"rm -rf {BUILD_APP_DIR} && mkdir {BUILD_APP_DIR} && "
         f"cd {BUILD_APP_DIR} && "
-        f"cmake ../rak-sid/app/rak4631_evse_monitor/app_evse && make"
+        f"cmake{layout_opt} ../rak-sid/app/rak4631_evse_monitor/app_evse && make"
     )
     result = subprocess.run(
         f'{NRFUTIL_PREFIX} "{build_cmd}"',
@@ -123,6 +137,27 @@ def build_app():
     return bin_path
 
 
+def update_layout(version):
+    """Regenerate app_layout.ld from the build's linker map, so the next
+    release keeps this one's function addresses."""
+    map_path = os.path.join("/Users/emilyf/sidewalk-projects", APP_MAP)
+    layout = app_layout.generate(map_path, LAYOUT_PATH, source=f"app-v{version}")
+    print(f"Layout: {len(layout['text'])} text, {len(layout['rodata'])} rodata slots "
+          f"-> {LAYOUT_PATH}")
+    return layout
+
+
+def report_delta(bin_path, baseline):
+    """Print what a delta OTA from `baseline` (image bytes) to the built
+    app would send. Returns the ota_patch.compare() counts."""
+    with open(bin_path, "rb") as f:
+        firmware = f.read()
+    counts = ota_patch.compare(baseline, firmware)
+    print(f"Delta vs baseline: {counts['delta']}/{counts['full']} chunks changed, "
+          f"patch {counts['patch']} chunks ({counts['patch_bytes']}B)")
+    return counts
+
+
 def build_platform():
     """Build the platform image via west."""
     print("Building platform...")
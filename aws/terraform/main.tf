@@ -410,6 +410,14 @@ data "archive_file" "ota_sender_zip" {
     content  = file("${path.module}/../protocol_constants.py")
     filename = "protocol_constants.py"
   }
+  source {
+    content  = file("${path.module}/../ota_patch.py")
+    filename = "ota_patch.py"
+  }
+  source {
+    content  = file("${path.module}/../ota_compress.py")
+    filename = "ota_compress.py"
+  }
 }
 
 # IAM role for OTA sender Lambda
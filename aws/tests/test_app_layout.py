@@ -0,0 +1,293 @@
+"""Tests for app_layout — stable function slots from a linker map."""
+
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), ".."))
+import app_layout  # noqa: E402
+import release  # noqa: E402
+from app_layout import Section  # noqa: E402
+
+OBJ = "CMakeFiles/app.dir/src"
+LIBC = "/opt/arm/lib/thumb/v7e-m/libc_nano.a"
+
+# A default (packed) link, trimmed from a real app.map
+DEFAULT_MAP = f"""\
+Memory Configuration
+
+Name             Origin             Length             Attributes
+FLASH            0x00090000         0x00024fff         xr
+
+Linker script and memory map
+
+.app_header     0x00090000       0x40
+ *(.app_header)
+ .app_header    0x00090000       0x40 {OBJ}/app_entry.c.obj
+
+.text           0x00090040       0xa0
+ *(.text*)
+ .text.app_init
+                0x00090040       0x24 {OBJ}/app_entry.c.obj
+                0x00090040                app_init
+ .text.charge_control_process_command_with_a_long_name
+                0x00090064       0x42 {OBJ}/charge_control.c.obj
+ *fill*         0x000900a6        0x2
+ .text.memcpy   0x000900a8       0x10 {LIBC}(lib_a-memcpy.o)
+ .text.empty    0x000900b8        0x0 {OBJ}/app_entry.c.obj
+ .text.thermostat_tick
+                0x000900b8       0x28 {OBJ}/thermostat.c.obj
+
+.rodata         0x000900e0       0x50
+ *(.rodata*)
+ .rodata.limits
+                0x000900e0       0x20 {OBJ}/airtime_budget.c.obj
+ .rodata.str1.1
+                0x00090100       0x11 {OBJ}/app_entry.c.obj
+ .rodata.app_init.str1.4
+                0x00090114        0xc {OBJ}/app_entry.c.obj
+ .rodata.cst8   0x00090120        0x8 {OBJ}/thermostat.c.obj
+ .rodata.app_cb
+                0x00090128       0x08 {OBJ}/app_entry.c.obj
+
+.data           0x2003e000        0x4
+"""
+
+
+def link(layout, text_sizes, rodata_sizes, origin=0x90000, text_off=0x40):
+    """Map text for a stable link of `layout`, with section sizes changed
+    to text_sizes/rodata_sizes (name -> size, None = removed). Places
+    sections the way app.ld's MAX(., offset) statements would."""
+    lines = ["Linker script and memory map", "",
+             f".app_header     0x{origin:08x}       0x40"]
+
+    def place(out, start, slots, end, sizes):
+        body, cur = [], 0
+        for s, offset in slots:
+            size = sizes.get(s.name, s.size)
+            cur = max(cur, offset)
+            body.append(f" {app_layout.input_spec(s)}")
+            if size is None:
+                continue
+            align = app_layout.slot_align(s)
+            cur = (cur + align - 1) // align * align
+            body.append(f" {s.name}")
+            body.append(f"                0x{start + cur:08x}  0x{size:x} {s.obj}")
+            cur += size
+        cur = max(cur, end)
+        lines.append(f"{out}  0x{start:08x}  0x{cur:x}")
+        lines.extend(body)
+        return cur
+
+    text_end = place(".text", origin + text_off, layout["text"], layout["text_end"],
+                     text_sizes)
+    rodata = max(origin + text_off + text_end, origin + layout["rodata_offset"])
+    place(".rodata", rodata, layout["rodata"], layout["rodata_end"], rodata_sizes)
+    return "\n".join(lines) + "\n"
+
+
+def plan(text):
+    return app_layout.plan_layout(*app_layout.parse_map(text))
+
+
+def offsets(slots):
+    return {s.name: offset for s, offset in slots}
+
+
+# --- Map parsing ---
+
+class TestParseMap:
+    def test_output_sections(self):
+        starts, sizes, _ = app_layout.parse_map(DEFAULT_MAP)
+        assert starts[".app_header"] == 0x90000
+        assert starts[".text"] == 0x90040
+        assert sizes[".text"] == 0xa0
+        assert starts[".rodata"] == 0x900e0
+
+    def test_input_sections_relative_to_output(self):
+        _, _, sections = app_layout.parse_map(DEFAULT_MAP)
+        text = sections[".text"]
+        assert [s.name for s in text] == [
+            ".text.app_init",
+            ".text.charge_control_process_command_with_a_long_name",
+            ".text.memcpy",
+            ".text.thermostat_tick",
+        ]
+        assert [s.offset for s in text] == [0x0, 0x24, 0x68, 0x78]
+        assert text[1].size == 0x42
+        assert text[2].obj == f"{LIBC}(lib_a-memcpy.o)"
+
+    def test_empty_sections_and_fill_skipped(self):
+        _, _, sections = app_layout.parse_map(DEFAULT_MAP)
+        names = [s.name for s in sections[".text"]]
+        assert ".text.empty" not in names
+        assert "*fill*" not in names
+
+    def test_default_link_not_slotted(self):
+        _, _, sections = app_layout.parse_map(DEFAULT_MAP)
+        assert not any(s.slotted for secs in sections.values() for s in secs)
+
+    def test_ignores_memory_configuration(self):
+        starts, _, _ = app_layout.parse_map(DEFAULT_MAP)
+        assert "FLASH" not in starts
+
+
+class TestInputSpec:
+    def test_object_file(self):
+        s = Section(".text.app_init", f"{OBJ}/app_entry.c.obj", 0, 4, False)
+        assert app_layout.input_spec(s) == "*/app_entry.c.obj(.text.app_init)"
+
+    def test_archive_member(self):
+        s = Section(".text.memcpy", f"{LIBC}(lib_a-memcpy.o)", 0, 4, False)
+        assert app_layout.input_spec(s) == "*libc_nano.a:lib_a-memcpy.o(.text.memcpy)"
+
+    def test_mergeable_not_placeable(self):
+        for name in (".rodata.str1.1", ".rodata.app_init.str1.4", ".rodata.cst8",
+                     ".rodata.fn.cst16"):
+            assert not app_layout.placeable(Section(name, "a.o", 0, 4, False))
+        assert app_layout.placeable(Section(".rodata.strings", "a.o", 0, 4, False))
+
+
+# --- Slot planning ---
+
+class TestPlanSlots:
+    def test_default_map_padded_in_order(self):
+        layout = plan(DEFAULT_MAP)
+        slots = layout["text"]
+        assert [s.name for s, _ in slots] == [
+            ".text.app_init",
+            ".text.charge_control_process_command_with_a_long_name",
+            ".text.memcpy",
+            ".text.thermostat_tick",
+        ]
+        for (s, offset), (_, nxt) in zip(slots, slots[1:]):
+            assert nxt - offset >= app_layout.padded(s.size) > s.size
+            assert offset % app_layout.SLOT_ALIGN == 0
+        last, offset = slots[-1]
+        assert layout["text_end"] == offset + app_layout.padded(last.size)
+
+    def test_padding(self):
+        assert app_layout.padded(0x24) == 0x30        # 36 + 8 -> 48
+        assert app_layout.padded(1000) == 1120        # 12%
+        assert app_layout.padded(1000) % app_layout.SLOT_ALIGN == 0
+
+    def test_alignment_from_offset(self):
+        # Packed at 0x20: may need 32-byte alignment, keep it
+        s = Section(".rodata.table", "a.o", 0x20, 0x40, False)
+        assert app_layout.slot_align(s) == 32
+        s = Section(".rodata.table", "a.o", 0x24, 0x40, False)
+        assert app_layout.slot_align(s) == app_layout.SLOT_ALIGN
+
+    def test_mergeable_rodata_left_to_linker(self):
+        names = [s.name for s, _ in plan(DEFAULT_MAP)["rodata"]]
+        assert names == [".rodata.limits", ".rodata.app_cb"]
+
+    def test_rodata_moved_past_text_slots(self):
+        layout = plan(DEFAULT_MAP)
+        text_end = 0x40 + layout["text_end"]
+        assert layout["rodata_offset"] >= text_end + app_layout.TEXT_RESERVE_MIN
+        assert layout["rodata_offset"] % app_layout.RODATA_ALIGN == 0
+
+    def test_rodata_kept_when_text_fits(self):
+        layout = plan(DEFAULT_MAP)
+        stable = plan(link(layout, {}, {}))
+        assert stable["rodata_offset"] == layout["rodata_offset"]
+
+
+class TestStableLink:
+    def test_regenerate_is_idempotent(self):
+        layout = plan(DEFAULT_MAP)
+        again = plan(link(layout, {}, {}))
+        assert app_layout.render(again) == app_layout.render(layout)
+
+    def test_slotted_sections_marked(self):
+        layout = plan(DEFAULT_MAP)
+        _, _, sections = app_layout.parse_map(link(layout, {}, {}))
+        assert all(s.slotted for s in sections[".text"])
+
+    def test_growth_within_slot_moves_nothing(self):
+        layout = plan(DEFAULT_MAP)
+        grown = plan(link(layout, {".text.app_init": 0x28}, {}))
+        assert offsets(grown["text"]) == offsets(layout["text"])
+        assert grown["rodata_offset"] == layout["rodata_offset"]
+
+    def test_overflow_resizes_only_what_it_reaches(self):
+        layout = plan(DEFAULT_MAP)
+        before = offsets(layout["text"])
+        name = ".text.charge_control_process_command_with_a_long_name"
+        grown = plan(link(layout, {name: 0x80}, {}))
+        after = offsets(grown["text"])
+        assert after[".text.app_init"] == before[".text.app_init"]
+        assert after[name] == before[name]
+        # The next slot is pushed along and gets a padded slot of its own
+        assert after[".text.memcpy"] >= before[name] + 0x80
+        assert grown["text_end"] > layout["text_end"]
+
+    def test_removed_section_leaves_hole(self):
+        layout = plan(DEFAULT_MAP)
+        shrunk = plan(link(layout, {".text.memcpy": None}, {}))
+        after = offsets(shrunk["text"])
+        assert ".text.memcpy" not in after
+        assert after[".text.thermostat_tick"] == \
+            offsets(layout["text"])[".text.thermostat_tick"]
+
+    def test_new_section_after_last_slot(self):
+        layout = plan(DEFAULT_MAP)
+        text = link(layout, {}, {})
+        new = 0x90040 + layout["text_end"]
+        text = text.replace(
+            "\n.rodata",
+            f"\n .text.new_fn\n                0x{new:08x}  0x30 {OBJ}/new.c.obj\n.rodata",
+            1)
+        grown = plan(text)
+        after = offsets(grown["text"])
+        assert after[".text.new_fn"] == layout["text_end"]
+        for name, offset in offsets(layout["text"]).items():
+            assert after[name] == offset
+
+
+# --- Output ---
+
+class TestRender:
+    def test_sections_and_offset(self):
+        out = app_layout.render(plan(DEFAULT_MAP), "app-v7")
+        assert "from app-v7" in out
+        assert out.index("#if defined(APP_LAYOUT_TEXT)") < \
+            out.index("#elif defined(APP_LAYOUT_RODATA)") < \
+            out.index("#define APP_LAYOUT_RODATA_OFFSET") < out.index("#endif")
+        assert ". = MAX(., 0x00000); */app_entry.c.obj(.text.app_init)" in out
+        assert "*libc_nano.a:lib_a-memcpy.o(.text.memcpy)" in out
+        assert ".rodata.str1.1" not in out
+
+    def test_generate_writes_file(self, tmp_path):
+        map_path = tmp_path / "app.map"
+        map_path.write_text(DEFAULT_MAP)
+        out = tmp_path / "app_layout.ld"
+        layout = app_layout.generate(str(map_path), str(out))
+        assert out.read_text() == app_layout.render(layout, "app.map")
+
+    def test_generate_rejects_map_without_text(self, tmp_path):
+        map_path = tmp_path / "app.map"
+        map_path.write_text("Linker script and memory map\n\n.data 0x2003e000 0x4\n")
+        with pytest.raises(ValueError):
+            app_layout.generate(str(map_path), str(tmp_path / "out.ld"))
+
+    def test_main_reports_error(self, tmp_path, capsys):
+        assert app_layout.main([str(tmp_path / "missing.map")]) == 1
+        assert "ERROR" in capsys.readouterr().out
+
+
+# --- Release delta report ---
+
+class TestReportDelta:
+    def test_counts_against_baseline(self, tmp_path, capsys):
+        old = bytes(range(256)) * 8
+        new = bytearray(old)
+        new[100] ^= 0xFF
+        bin_path = tmp_path / "app.bin"
+        bin_path.write_bytes(bytes(new))
+        counts = release.report_delta(str(bin_path), old)
+        assert counts["delta"] == 1
+        assert counts["full"] > 1
+        assert "1/" in capsys.readouterr().out
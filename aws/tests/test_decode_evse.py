@@ -124,6 +124,18 @@ class TestDecodeOtaUplink:
         assert result["next_chunk"] == 5
         assert result["chunks_received"] == 5
 
+    def test_bitmap_ack_payload(self):
+        raw = struct.pack("<BBbHHHQ", 0x20, 0x80, 0, 8, 8, 32, 0x1700)
+        result = decode.decode_ota_uplink(raw)
+        assert result["ota_type"] == "ack"
+        assert result["chunks_received"] == 8
+        assert result["ack_base"] == 32
+        assert result["ack_bitmap"] == 0x1700
+
+    def test_plain_ack_has_no_bitmap(self):
+        raw = struct.pack("<BBbHH", 0x20, 0x80, 0, 5, 5)
+        assert "ack_bitmap" not in decode.decode_ota_uplink(raw)
+
     def test_complete_payload(self):
         raw = struct.pack("<BBbI", 0x20, 0x81, 0, 0xDEADBEEF)
         result = decode.decode_ota_uplink(raw)
@@ -562,6 +574,19 @@ class TestDecodeDiagPayload:
         result = decode.decode_diag_payload(raw)
         assert result["uptime_seconds"] == 97200
 
+    def test_v1_has_no_airtime_field(self):
+        """15-byte v0x01 payload decodes with airtime_remaining_ms None."""
+        result = decode.decode_diag_payload(self._make_diag())
+        assert result["airtime_remaining_ms"] is None
+
+    def test_v2_airtime_remaining(self):
+        """v0x02 appends remaining hourly airtime (ms, u16 LE) at bytes 15-16."""
+        raw = self._make_diag(diag_ver=2) + (35933).to_bytes(2, 'little')
+        result = decode.decode_diag_payload(raw)
+        assert result["diag_version"] == 2
+        assert result["airtime_remaining_ms"] == 35933
+        assert result["event_buffer_pending"] == 5
+
     def test_too_short_returns_none(self):
         """Payload shorter than 14 bytes returns None."""
         raw = bytes([0xE6, 0x01, 0x03, 0x00])
@@ -1575,3 +1600,136 @@ class TestDeduplication:
             mock_table.put_item = mock_put
             with pytest.raises(ClientError):
                 decode.lambda_handler(self._make_event(raw), None)
+
+
+# --- v0x0B batched drain frame ---
+
+def make_batch(base, entries):
+    """Build a v0x0B frame. entries: (offset, state, flags_nibble, current_units, reason)."""
+    out = bytearray([0xE5, 0x0B, len(entries)]) + struct.pack("<I", base)
+    for offset, state, flags, cur, reason in entries:
+        packed = state | (flags << 4) | (0x08 if reason else 0)
+        out += struct.pack("<HBB", offset, packed, cur)
+        if reason:
+            out.append(reason)
+    return bytes(out)
+
+
+class TestDecodeV0BBatch:
+    def test_decodes_entries_with_offsets(self):
+        raw = make_batch(1000, [(0, 1, 0, 0, 0), (300, 2, 0x06, 80, 0)])
+        result = decode.decode_batch_evse_payload(raw)
+        assert result["payload_type"] == "evse_batch"
+        events = result["events"]
+        assert len(events) == 2
+        assert events[0]["j1772_state"] == "B"
+        assert events[0]["device_timestamp_epoch"] == 1000
+        assert events[1]["j1772_state"] == "C"
+        assert events[1]["device_timestamp_epoch"] == 1300
+        assert events[1]["device_timestamp_unix"] == 1300 + decode.EPOCH_OFFSET
+        assert events[1]["current_ma"] == 16000
+        assert events[1]["thermostat_cool"] is True
+        assert events[1]["charge_allowed"] is True
+
+    def test_reason_byte(self):
+        raw = make_batch(1000, [(0, 2, 0, 0, 0x01), (10, 1, 0, 0, 0)])
+        events = decode.decode_batch_evse_payload(raw)["events"]
+        assert events[0]["transition_reason"] == "cloud_cmd"
+        assert events[1]["transition_reason_code"] == 0
+        assert events[1]["device_timestamp_epoch"] == 1010
+
+    def test_presync_base_zero(self):
+        raw = make_batch(0, [(0, 0, 0, 0, 0)])
+        ev = decode.decode_batch_evse_payload(raw)["events"][0]
+        assert ev["device_timestamp_epoch"] == 0
+        assert ev["device_timestamp_unix"] is None
+
+    def test_truncated_returns_none(self):
+        raw = make_batch(1000, [(0, 1, 0, 0, 0), (5, 1, 0, 0, 0)])
+        assert decode.decode_batch_evse_payload(raw[:-1]) is None
+
+    def test_bad_state_returns_none(self):
+        raw = make_batch(1000, [(0, 7, 0, 0, 0)])
+        assert decode.decode_batch_evse_payload(raw) is None
+
+    def test_decode_payload_routes_batch(self):
+        raw = make_batch(1000, [(0, 1, 0, 0, 0)])
+        result = decode.decode_payload(encode_b64(raw))
+        assert result["payload_type"] == "evse_batch"
+
+
+class TestBatchHandler:
+    @pytest.fixture(autouse=True)
+    def mock_deps(self):
+        with patch.object(decode, "table") as mock_table, \
+             patch.object(decode, "state_table") as mock_state, \
+             patch.object(decode, "maybe_send_time_sync") as mock_sync, \
+             patch.object(decode, "check_scheduler_divergence") as mock_div, \
+             patch.object(decode.device_registry, "generate_sc_short_id", return_value="SC-TEST01"), \
+             patch.object(decode.device_registry, "get_or_create_device"), \
+             patch.object(decode.device_registry, "update_last_seen"):
+            mock_table.put_item = MagicMock()
+            self.mock_table = mock_table
+            self.mock_state = mock_state
+            self.mock_sync = mock_sync
+            self.mock_div = mock_div
+            yield
+
+    def _make_event(self, raw_bytes):
+        return {
+            "WirelessDeviceId": "test-device",
+            "PayloadData": encode_b64(raw_bytes),
+            "WirelessMetadata": {"Sidewalk": {"LinkType": "LoRa", "Seq": 7}},
+            "timestamp_override_ms": 1800000000000,
+        }
+
+    def _items(self):
+        return [c[1]["Item"] for c in self.mock_table.put_item.call_args_list]
+
+    def test_fans_out_one_item_per_entry(self):
+        raw = make_batch(1000, [(0, 1, 0, 0, 0), (60, 2, 0, 50, 0), (120, 1, 0, 0, 0)])
+        result = decode.lambda_handler(self._make_event(raw), None)
+        assert result["statusCode"] == 200
+        items = self._items()
+        assert len(items) == 3
+        assert [i["batch_index"] for i in items] == [0, 1, 2]
+        assert all(i["event_type"] == "evse_telemetry" for i in items)
+        assert all(i["timestamp_source"] == "device" for i in items)
+        assert items[1]["data"]["evse"]["current_draw_ma"] == 10000
+
+    def test_sort_keys_follow_device_time(self):
+        raw = make_batch(1000, [(0, 1, 0, 0, 0), (60, 2, 0, 0, 0)])
+        decode.lambda_handler(self._make_event(raw), None)
+        items = self._items()
+        t0 = datetime.strptime(items[0]["timestamp_mt"][:19], "%Y-%m-%d %H:%M:%S")
+        t1 = datetime.strptime(items[1]["timestamp_mt"][:19], "%Y-%m-%d %H:%M:%S")
+        assert (t1 - t0).total_seconds() == 60
+
+    def test_same_second_entries_get_distinct_keys(self):
+        raw = make_batch(1000, [(0, 1, 0, 0, 0), (0, 2, 0, 0, 0)])
+        decode.lambda_handler(self._make_event(raw), None)
+        keys = [i["timestamp_mt"] for i in self._items()]
+        assert keys[0] != keys[1]
+
+    def test_redelivery_maps_to_same_keys(self):
+        raw = make_batch(1000, [(0, 1, 0, 0, 0), (60, 2, 0, 0, 0)])
+        decode.lambda_handler(self._make_event(raw), None)
+        first = [i["timestamp_mt"] for i in self._items()]
+        self.mock_table.put_item.reset_mock()
+        decode.lambda_handler(self._make_event(raw), None)
+        assert [i["timestamp_mt"] for i in self._items()] == first
+
+    def test_transition_entry_logged(self):
+        raw = make_batch(1000, [(0, 2, 0x04, 0, 0x02)])
+        decode.lambda_handler(self._make_event(raw), None)
+        items = self._items()
+        assert len(items) == 2
+        assert items[1]["event_type"] == "interlock_transition"
+        assert items[1]["transition_reason"] == "delay_window"
+
+    def test_history_skips_live_side_effects(self):
+        raw = make_batch(1000, [(0, 2, 0x04, 0, 0)])
+        decode.lambda_handler(self._make_event(raw), None)
+        self.mock_state.update_item.assert_not_called()
+        self.mock_div.assert_not_called()
+        self.mock_sync.assert_called_once()
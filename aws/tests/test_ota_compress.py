@@ -0,0 +1,72 @@
+"""Tests for ota_compress.py — LZSS encoder, reference decoder, device vector."""
+
+import os
+import random
+import struct
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), ".."))
+import ota_compress  # noqa: E402
+
+
+def fake_code(size, seed=1):
+    """Pseudo-random 'code' with repeated instruction-like words."""
+    rng = random.Random(seed)
+    words = [rng.getrandbits(32) for _ in range(64)]
+    out = bytearray()
+    while len(out) < size:
+        out += struct.pack("<I", rng.choice(words) ^ rng.getrandbits(8))
+    return bytes(out[:size])
+
+
+class TestRoundTrip:
+    @pytest.mark.parametrize("data", [
+        b"",
+        b"A",
+        b"AB",
+        b"\xff" * 5000,
+        bytes(range(256)) * 3,
+    ])
+    def test_small_and_degenerate_inputs(self, data):
+        assert ota_compress.decompress(ota_compress.compress(data), len(data)) == data
+
+    def test_code_like_image_shrinks(self):
+        data = fake_code(20000)
+        stream = ota_compress.compress(data)
+        assert ota_compress.decompress(stream, len(data)) == data
+        assert len(stream) < 0.8 * len(data)
+
+    def test_matches_reach_back_a_full_window(self):
+        block = bytes(random.Random(3).getrandbits(8) for _ in range(4000))
+        data = block + b"\x00" * 96 + block
+        stream = ota_compress.compress(data)
+        assert ota_compress.decompress(stream, len(data)) == data
+        assert len(stream) < 4000 + 600
+
+    def test_random_data_costs_at_most_one_bit_per_byte(self):
+        data = bytes(random.Random(7).getrandbits(8) for _ in range(3000))
+        assert len(ota_compress.compress(data)) <= (len(data) * 9 + 7) // 8
+
+
+class TestFormat:
+    def test_device_vector(self):
+        """Same vector as tests/app/test_ota_lz.c test_cloud_vector_decodes."""
+        data = b"EVSE monitor " * 4 + bytes(range(20))
+        assert ota_compress.compress(data).hex() == (
+            "a2d5aa745905b6df6eb4dd2df729000318019e00cf804060503824160d07"
+            "84426150b864361d0f8844625130")
+
+    def test_literal_and_backref_bits(self):
+        # 'a' literal, then a distance-1 length-5 back-reference
+        assert ota_compress.compress(b"aaaaaa") == bytes([0xB0, 0x80, 0x01, 0x00])
+
+    def test_bad_distance_rejected(self):
+        with pytest.raises(ValueError, match="outside image"):
+            ota_compress.decompress(bytes([0x00, 0x00, 0x10]), 4)
+
+    def test_trailing_data_rejected(self):
+        stream = ota_compress.compress(b"abc") + b"\x00"
+        with pytest.raises(ValueError, match="trailing"):
+            ota_compress.decompress(stream, 3)
@@ -0,0 +1,111 @@
+"""Tests for ota_patch.py — binary patch encoder, reference decoder, chunk counts."""
+
+import os
+import random
+import struct
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), ".."))
+import ota_patch  # noqa: E402
+from ota import compute_delta_chunks  # noqa: E402
+from protocol_constants import crc32  # noqa: E402
+
+
+def fake_code(size, seed=1):
+    """Pseudo-random 'code' with repeated instruction-like words."""
+    rng = random.Random(seed)
+    words = [rng.getrandbits(32) for _ in range(64)]
+    out = bytearray()
+    while len(out) < size:
+        out += struct.pack("<I", rng.choice(words) ^ rng.getrandbits(8))
+    return bytes(out[:size])
+
+
+class TestRoundTrip:
+    def test_identical_images(self):
+        old = fake_code(4000)
+        patch = ota_patch.make_patch(old, old)
+        assert ota_patch.apply_patch(old, patch) == old
+        assert ota_patch.patch_chunks(patch) <= 2
+
+    def test_insertion_shifts_rest_of_image(self):
+        old = fake_code(20000)
+        new = old[:5000] + b"\x00\xbf" * 20 + old[5000:]
+        patch = ota_patch.make_patch(old, new)
+        assert ota_patch.apply_patch(old, patch) == new
+
+        delta = len(compute_delta_chunks(old, new, 15))
+        assert delta > 1000   # everything after the insert moved
+        assert ota_patch.patch_chunks(patch) < 10
+
+    def test_sparse_byte_changes_use_diff_literals(self):
+        old = fake_code(8000)
+        new = bytearray(old)
+        for off in range(100, 8000, 400):   # relocated call targets
+            new[off] = (new[off] + 4) & 0xFF
+        new = bytes(new)
+        patch = ota_patch.make_patch(old, new)
+        assert ota_patch.apply_patch(old, patch) == new
+        assert len(patch) < 200
+
+    def test_deletion_and_growth(self):
+        old = fake_code(10000)
+        new = old[:2000] + old[2600:9000] + fake_code(700, seed=9) + old[9000:]
+        patch = ota_patch.make_patch(old, new)
+        assert ota_patch.apply_patch(old, patch) == new
+
+    def test_unrelated_images(self):
+        old = fake_code(3000, seed=1)
+        new = bytes(random.Random(5).getrandbits(8) for _ in range(3000))
+        patch = ota_patch.make_patch(old, new)
+        assert ota_patch.apply_patch(old, patch) == new
+
+    def test_empty_old_image(self):
+        new = fake_code(500)
+        patch = ota_patch.make_patch(b"", new)
+        assert ota_patch.apply_patch(b"", patch) == new
+
+
+class TestFormat:
+    def test_header(self):
+        old = fake_code(256)
+        patch = ota_patch.make_patch(old, old)
+        assert patch[:4] == b"EVP1"
+        assert struct.unpack_from("<II", patch, 4) == (len(old), crc32(old))
+
+    def test_base_mismatch_rejected(self):
+        old = fake_code(256)
+        patch = ota_patch.make_patch(old, old[::-1])
+        with pytest.raises(ValueError, match="base mismatch"):
+            ota_patch.apply_patch(b"\x00" + old[1:], patch)
+
+    def test_device_vector(self):
+        """Same vector as tests/app/test_ota_patch.c test_cloud_vector_rebuilds_image."""
+        old = bytes((i * 7 + 3) & 0xFF for i in range(96))
+        new = old[:40] + b"NEWCODE!" + old[40:60] + bytes([old[60] + 1]) + old[61:]
+        assert ota_patch.make_patch(old, new).hex() == (
+            "4556503160000000ed2886ee00280828004e4557434f4445"
+            "210038001401012300")
+
+
+class TestCompare:
+    def test_reports_all_three_counts(self):
+        old = fake_code(3000)
+        new = old[:100] + b"\x01\x02\x03" + old[100:]
+        r = ota_patch.compare(old, new)
+        assert r["full"] == (len(new) + 14) // 15
+        assert r["delta"] > r["patch"]
+        assert r["patch"] == ota_patch.patch_chunks(ota_patch.make_patch(old, new))
+
+    def test_cli_with_image_files(self, tmp_path, capsys):
+        old = fake_code(2000)
+        paths = []
+        for i, img in enumerate([old, old[:50] + b"xyz" + old[50:]]):
+            p = tmp_path / f"app-v{i}.bin"
+            p.write_bytes(img)
+            paths.append(str(p))
+        ota_patch.main(paths)
+        out = capsys.readouterr().out
+        assert "app-v0.bin..app-v1.bin" in out
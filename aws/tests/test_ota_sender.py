@@ -6,6 +6,11 @@ Covers:
 - Stale "validating" retry: re-sends START instead of chunk
 - Happy path: delta ACK sends correct next chunk
 - Happy path: full-mode ACK sends correct next chunk
+- Patch mode: chunks cut from the patch, PATCH_ERR falls back to full image
+- Resumed sessions: the START reply's chunk count is the new cursor
+- A/B slots: the inactive slot's build is sent whole, SLOT_ERR falls back
+- Windowed delta: bitmap ACKs settle a window of chunks, gaps are resent
+- Session metrics: uplink count and wall time on ota_complete/ota_aborted
 """
 
 import json
@@ -418,6 +423,88 @@ class TestFullModeAckHappyPath:
         assert "awaiting COMPLETE" in result["body"]
 
 
+# --- Resumed sessions: the START reply carries the resume point ---
+
+class TestResumedSession:
+    """After a device reboot, a matching START resumes from the device's last
+    checkpoint; its ACK says how many chunks survived."""
+
+    def _start_reply(self, session, received):
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "log_ota_event") as mock_log, \
+             patch.object(ota, "send_chunk") as mock_send:
+
+            ota.handle_device_ack({
+                "type": "ack",
+                "status": ota.OTA_STATUS_OK,
+                "next_chunk": received,
+                "chunks_received": received,
+            })
+        return mock_write, mock_log, mock_send
+
+    def test_initial_start_ack_sends_first_chunk(self):
+        session = make_full_session(status="starting")
+        _, mock_log, mock_send = self._start_reply(session, 0)
+
+        assert mock_send.call_args[0][1] == 0
+        mock_log.assert_not_called()
+
+    def test_full_session_resumes_behind_highest_acked(self):
+        # Device had ACKed 3 chunks, but its last checkpoint covers 2
+        session = make_full_session(status="restarting", next_chunk=3, highest_acked=3)
+        mock_write, mock_log, mock_send = self._start_reply(session, 2)
+
+        assert mock_send.call_args[0][1] == 2
+        written = mock_write.call_args[0][0]
+        assert written["next_chunk"] == 2
+        assert written["highest_acked"] == 2
+        assert mock_log.call_args[0][0] == "ota_resumed"
+
+    def test_delta_session_resumes_at_device_cursor(self):
+        session = make_delta_session(delta_chunks=[0, 1, 2, 3], status="restarting",
+                                     delta_cursor=3, highest_acked=3)
+        mock_write, _, mock_send = self._start_reply(session, 2)
+
+        assert mock_send.call_args[0][1] == 2  # delta_list[2]
+        assert mock_write.call_args[0][0]["delta_cursor"] == 2
+
+    def test_fresh_start_after_restart_begins_at_zero(self):
+        session = make_full_session(status="restarting", next_chunk=3, highest_acked=3)
+        _, mock_log, mock_send = self._start_reply(session, 0)
+
+        assert mock_send.call_args[0][1] == 0
+        mock_log.assert_not_called()
+
+    def test_stale_ack_while_sending_still_ignored(self):
+        session = make_full_session(status="sending", next_chunk=3, highest_acked=3)
+        _, _, mock_send = self._start_reply(session, 2)
+
+        mock_send.assert_not_called()
+
+    def test_stale_validating_resends_start_as_restarting(self):
+        session = make_full_session(status="validating", updated_at=0)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "send_sidewalk_msg"):
+
+            ota.handle_retry_check({"source": "aws.events"})
+
+        assert mock_write.call_args[0][0]["status"] == "restarting"
+
+    def test_stale_starting_stays_starting(self):
+        session = make_full_session(status="starting", updated_at=0)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "send_sidewalk_msg"):
+
+            ota.handle_retry_check({"source": "aws.events"})
+
+        assert mock_write.call_args[0][0]["status"] == "starting"
+
+
 # --- COMPLETE handler ---
 
 class TestDeviceComplete:
@@ -470,6 +557,487 @@ class TestNoActiveSession:
         assert "no active session" in result["body"]
 
 
+# --- Patch mode ---
+
+PATCH = b"EVP1" + b"\x5a" * 28   # 32 bytes: 3 chunks
+PATCH_KEY = "ota/patches/app-v2.bin.patch"
+
+
+def make_patch_session(**overrides):
+    """Build a patch-mode OTA session dict."""
+    return make_full_session(total_chunks=3, payload_key=PATCH_KEY, **overrides)
+
+
+class TestPatchMode:
+    @pytest.fixture(autouse=True)
+    def cache_patch(self):
+        ota._firmware_cache[f"test-bucket/{PATCH_KEY}"] = PATCH
+
+    def test_start_flags_include_patch(self):
+        assert ota.session_start_flags(make_patch_session()) == ota.OTA_START_FLAGS_PATCH
+        assert ota.session_start_flags(make_patch_session(is_signed=True)) == (
+            ota.OTA_START_FLAGS_PATCH | ota.OTA_START_FLAGS_SIGNED)
+        assert ota.session_start_flags(make_full_session(payload_key="")) == 0
+
+    def test_ack_sends_chunk_cut_from_patch(self):
+        session = make_patch_session(next_chunk=0, highest_acked=0)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session"), \
+             patch.object(ota, "send_sidewalk_msg") as mock_send:
+
+            ota.handle_device_ack({
+                "type": "ack",
+                "status": ota.OTA_STATUS_OK,
+                "next_chunk": 2,
+                "chunks_received": 2,
+            })
+
+        sent = mock_send.call_args[0][0]
+        assert sent[2:4] == b"\x02\x00"
+        assert sent[4:] == PATCH[30:]
+
+    def test_stale_start_resent_with_patch_flag(self):
+        session = make_patch_session(status="starting", updated_at=0)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session"), \
+             patch.object(ota, "send_sidewalk_msg") as mock_send:
+
+            ota.handle_retry_check({"source": "aws.events"})
+
+        sent = mock_send.call_args[0][0]
+        assert sent[1] == ota.OTA_SUB_START
+        assert sent[18] == ota.OTA_START_FLAGS_PATCH
+
+    def test_patch_err_restarts_with_full_image(self):
+        session = make_patch_session(next_chunk=1, highest_acked=1)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "send_sidewalk_msg") as mock_send:
+
+            result = ota.handle_device_ack({
+                "type": "ack",
+                "status": ota.OTA_STATUS_PATCH_ERR,
+                "next_chunk": 1,
+                "chunks_received": 1,
+            })
+
+        assert "full image" in result["body"]
+        written = mock_write.call_args[0][0]
+        assert written["payload_key"] == ""
+        assert written["total_chunks"] == FULL_CHUNKS
+        sent = mock_send.call_args[0][0]
+        assert sent[1] == ota.OTA_SUB_START
+        assert len(sent) == 18   # no flags byte: unsigned, not a patch
+
+
+# --- Compressed mode ---
+
+LZ_KEY = "ota/compressed/app-v2.bin.lz"
+
+
+def make_lz_session(**overrides):
+    """Build a compressed-image OTA session dict."""
+    stream = ota.ota_compress.compress(FIRMWARE)
+    ota._firmware_cache[f"test-bucket/{LZ_KEY}"] = stream
+    return make_full_session(total_chunks=(len(stream) + CHUNK_SIZE - 1) // CHUNK_SIZE,
+                             payload_key=LZ_KEY,
+                             payload_flags=ota.OTA_START_FLAGS_COMPRESSED,
+                             **overrides)
+
+
+def s3_record(key="firmware/app-v2.bin"):
+    return {"s3": {"bucket": {"name": "test-bucket"}, "object": {"key": key}}}
+
+
+class TestCompressedMode:
+    def test_start_flags_include_compressed(self):
+        assert ota.session_start_flags(make_lz_session()) == ota.OTA_START_FLAGS_COMPRESSED
+        assert ota.session_start_flags(make_lz_session(is_signed=True)) == (
+            ota.OTA_START_FLAGS_COMPRESSED | ota.OTA_START_FLAGS_SIGNED)
+
+    def test_legacy_patch_session_keeps_patch_flag(self):
+        """Sessions written before payload_flags existed are patches."""
+        session = make_patch_session()
+        assert "payload_flags" not in session
+        assert ota.session_start_flags(session) == ota.OTA_START_FLAGS_PATCH
+
+    def test_s3_trigger_sends_compressible_image_compressed(self):
+        with patch.object(ota, "s3") as mock_s3, \
+             patch.object(ota, "load_firmware", side_effect=self._no_baseline), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "send_sidewalk_msg") as mock_send:
+            mock_s3.head_object.return_value = {"Metadata": {}}
+            result = ota.handle_s3_trigger(s3_record())
+
+        assert "compressed" in result["body"]
+        stream = mock_s3.put_object.call_args.kwargs["Body"]
+        assert mock_s3.put_object.call_args.kwargs["Key"] == LZ_KEY
+        assert ota.ota_compress.decompress(stream, len(FIRMWARE)) == FIRMWARE
+
+        written = mock_write.call_args[0][0]
+        assert written["payload_key"] == LZ_KEY
+        assert written["payload_flags"] == ota.OTA_START_FLAGS_COMPRESSED
+        assert written["total_chunks"] < FULL_CHUNKS
+        sent = mock_send.call_args[0][0]
+        assert sent[2:6] == len(FIRMWARE).to_bytes(4, "little")  # image size, not stream
+        assert sent[18] == ota.OTA_START_FLAGS_COMPRESSED
+
+    def test_s3_trigger_sends_incompressible_image_raw(self):
+        firmware = bytes((i * 73 + (i >> 3) * 151) & 0xFF for i in range(60))
+        ota._firmware_cache["test-bucket/firmware/app-v2.bin"] = firmware
+
+        with patch.object(ota, "s3") as mock_s3, \
+             patch.object(ota, "load_firmware", side_effect=self._no_baseline), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "send_sidewalk_msg"):
+            mock_s3.head_object.return_value = {"Metadata": {}}
+            result = ota.handle_s3_trigger(s3_record())
+
+        assert "legacy" in result["body"]
+        mock_s3.put_object.assert_not_called()
+        assert "payload_key" not in mock_write.call_args[0][0]
+
+    def test_patch_err_restarts_with_raw_image(self):
+        session = make_lz_session(next_chunk=1, highest_acked=1)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "send_sidewalk_msg") as mock_send:
+
+            ota.handle_device_ack({
+                "type": "ack",
+                "status": ota.OTA_STATUS_PATCH_ERR,
+                "next_chunk": 1,
+                "chunks_received": 1,
+            })
+
+        written = mock_write.call_args[0][0]
+        assert written["payload_key"] == ""
+        assert written["payload_flags"] == 0
+        assert written["total_chunks"] == FULL_CHUNKS
+        assert len(mock_send.call_args[0][0]) == 18
+
+    @staticmethod
+    def _no_baseline(bucket, key):
+        if key == "ota/baseline.bin":
+            raise FileNotFoundError(key)
+        return ota._firmware_cache[f"{bucket}/{key}"]
+
+
+
+# --- A/B slots ---
+
+SLOT_B_KEY = "firmware/app-v2.slot_b.bin"
+# Slot B build: same code linked at the other address
+FIRMWARE_B = b"\x45\x56\x53\x45" + bytes(range(1, 57))
+# One chunk changed from the baseline: a delta would win on the copy path
+FIRMWARE_V2 = FIRMWARE[:20] + b"\x99" + FIRMWARE[21:]
+
+
+class TestAbSlots:
+    @staticmethod
+    def _trigger(device_slot, slot_b_build=True):
+        files = {"ota/baseline.bin": FIRMWARE,
+                 "firmware/app-v2.bin": FIRMWARE_V2}
+        if slot_b_build:
+            files[SLOT_B_KEY] = FIRMWARE_B
+
+        def load(bucket, key):
+            return files[key]
+
+        def head(Bucket, Key):
+            if Key == "ota/baseline.bin" and device_slot:
+                return {"Metadata": {"slot": device_slot}}
+            return {"Metadata": {}}
+
+        with patch.object(ota, "s3") as mock_s3, \
+             patch.object(ota, "load_firmware", side_effect=load), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "log_ota_event"), \
+             patch.object(ota, "send_sidewalk_msg") as mock_send:
+            mock_s3.head_object.side_effect = head
+            result = ota.handle_s3_trigger(s3_record())
+        return result, mock_write.call_args[0][0], mock_send.call_args[0][0]
+
+    def test_device_on_a_gets_slot_b_build(self):
+        result, session, sent = self._trigger(device_slot=None)
+
+        assert session["slot"] == "b"
+        assert session["s3_key"] == SLOT_B_KEY
+        assert session["alt_key"] == "firmware/app-v2.bin"
+        assert session["fw_crc32"] == ota.crc32(FIRMWARE_B)
+        assert "delta_chunks" not in session
+        assert sent[18] & ota.OTA_START_FLAGS_SLOT_B
+
+    def test_device_on_b_gets_slot_a_build_as_delta(self):
+        result, session, sent = self._trigger(device_slot="b")
+
+        assert "delta" in result["body"]
+        assert session["slot"] == "a"
+        assert session["s3_key"] == "firmware/app-v2.bin"
+        assert json.loads(session["delta_chunks"]) == [1]
+        assert not sent[18] & ota.OTA_START_FLAGS_SLOT_B
+
+    def test_without_slot_b_build_copy_path_keeps_delta(self):
+        result, session, sent = self._trigger(device_slot=None, slot_b_build=False)
+
+        assert "delta" in result["body"]
+        assert session["slot"] == "a"
+        assert json.loads(session["delta_chunks"]) == [1]
+
+    def test_slot_b_upload_does_not_start_session(self):
+        with patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "send_sidewalk_msg") as mock_send:
+            ota.handle_s3_trigger(s3_record(SLOT_B_KEY))
+        mock_write.assert_not_called()
+        mock_send.assert_not_called()
+
+    def test_start_flags_include_slot_b(self):
+        assert ota.session_start_flags(make_full_session(slot="b")) == ota.OTA_START_FLAGS_SLOT_B
+        assert ota.session_start_flags(make_full_session(slot="a")) == 0
+
+    def test_slot_err_restarts_with_slot_a_build(self):
+        ota._firmware_cache[f"test-bucket/{SLOT_B_KEY}"] = FIRMWARE_B
+        session = make_full_session(s3_key=SLOT_B_KEY, slot="b",
+                                    alt_key="firmware/app-v2.bin",
+                                    status="starting")
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "s3") as mock_s3, \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "log_ota_event"), \
+             patch.object(ota, "send_sidewalk_msg") as mock_send:
+            mock_s3.head_object.return_value = {"Metadata": {}}
+            result = ota.handle_device_ack({
+                "type": "ack",
+                "status": ota.OTA_STATUS_SLOT_ERR,
+                "next_chunk": 0,
+                "chunks_received": 0,
+            })
+
+        assert "slot A restart" in result["body"]
+        written = mock_write.call_args[0][0]
+        assert written["s3_key"] == "firmware/app-v2.bin"
+        assert written["slot"] == "a"
+        assert written["fw_crc32"] == FIRMWARE_CRC
+        assert written["total_chunks"] == FULL_CHUNKS
+        assert "alt_key" not in written
+        sent = mock_send.call_args[0][0]
+        assert sent[1] == ota.OTA_SUB_START
+        assert len(sent) == 18   # raw, unsigned, slot A
+
+    def test_slot_err_drops_delta(self):
+        session = make_delta_session(slot="a", status="starting")
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "log_ota_event"), \
+             patch.object(ota, "send_sidewalk_msg"):
+            ota.handle_device_ack({
+                "type": "ack",
+                "status": ota.OTA_STATUS_SLOT_ERR,
+                "next_chunk": 0,
+                "chunks_received": 0,
+            })
+
+        written = mock_write.call_args[0][0]
+        assert "delta_chunks" not in written
+        assert written["total_chunks"] == FULL_CHUNKS
+
+    def test_second_slot_err_aborts(self):
+        session = make_full_session(slot="a", slot_retried=True)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "clear_session") as mock_clear, \
+             patch.object(ota, "log_ota_event"), \
+             patch.object(ota, "send_sidewalk_msg") as mock_send:
+            result = ota.handle_device_ack({
+                "type": "ack",
+                "status": ota.OTA_STATUS_SLOT_ERR,
+                "next_chunk": 0,
+                "chunks_received": 0,
+            })
+
+        assert "aborted" in result["body"]
+        mock_clear.assert_called_once()
+        mock_send.assert_not_called()
+
+    def test_complete_records_running_slot_with_baseline(self):
+        session = make_full_session(s3_key=SLOT_B_KEY, slot="b")
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "clear_session"), \
+             patch.object(ota, "log_ota_event"), \
+             patch.object(ota.s3, "copy_object") as mock_copy:
+            ota.handle_device_complete({"type": "complete", "result": ota.OTA_STATUS_OK})
+
+        kwargs = mock_copy.call_args.kwargs
+        assert kwargs["CopySource"]["Key"] == SLOT_B_KEY
+        assert kwargs["Metadata"] == {"slot": "b"}
+        assert kwargs["MetadataDirective"] == "REPLACE"
+
+# --- Windowed delta: bitmap ACKs every N chunks ---
+
+WINDOW_DELTA = list(range(10, 30))   # 20 changed chunks, abs idx 10..29
+
+
+def make_windowed_session(**overrides):
+    fields = {"ack_every": 4, "windowed": True, "in_flight": "[]", **overrides}
+    return make_delta_session(delta_chunks=WINDOW_DELTA, **fields)
+
+
+def bitmap_ack(received, held, base=0):
+    bits = sum(1 << (idx - base) for idx in held)
+    return {"type": "ack", "status": ota.OTA_STATUS_OK, "next_chunk": received,
+            "chunks_received": received, "ack_base": base, "ack_bitmap": bits}
+
+
+class TestWindowedDelta:
+    @staticmethod
+    def _ack(session, ack):
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "log_ota_event"), \
+             patch.object(ota, "send_chunk") as mock_send:
+            result = ota.handle_device_ack(ack)
+        sent = [c[0][1] for c in mock_send.call_args_list]
+        return result, mock_write.call_args[0][0], sent
+
+    def test_trigger_asks_for_bitmap_acks(self):
+        result, session, sent = TestAbSlots._trigger(device_slot=None, slot_b_build=False)
+
+        assert sent[18] >> ota.OTA_START_FLAGS_ACK_SHIFT == ota.ACK_EVERY
+        assert session["ack_every"] == ota.ACK_EVERY
+        assert session["windowed"] is True
+        assert ota.session_start_flags(session) == sent[18]
+
+    def test_start_reply_opens_window(self):
+        session = make_windowed_session(status="starting")
+        _, written, sent = self._ack(session, {"type": "ack", "status": 0,
+                                               "next_chunk": 0, "chunks_received": 0})
+
+        assert sent == WINDOW_DELTA[:8]
+        assert json.loads(written["in_flight"]) == list(range(8))
+        assert written["delta_cursor"] == 8
+
+    def test_gap_resent_and_window_topped_up(self):
+        session = make_windowed_session(in_flight=json.dumps(list(range(8))), delta_cursor=8)
+        # 12 lost, 15.. still on their way
+        _, written, sent = self._ack(session, bitmap_ack(4, [10, 11, 13, 14]))
+
+        assert sent == [12, 18, 19, 20, 21]
+        assert json.loads(written["in_flight"]) == [2, 5, 6, 7, 8, 9, 10, 11]
+        assert written["delta_cursor"] == 12
+
+    def test_chunks_shown_held_are_skipped(self):
+        # Resumed at 10: the window restarts 8 behind, and the duplicate's
+        # bitmap shows the device has all of them
+        session = make_windowed_session(status="restarting")
+        _, written, sent = self._ack(session, {"type": "ack", "status": 0,
+                                               "next_chunk": 10, "chunks_received": 10})
+        assert sent == WINDOW_DELTA[2:10]
+
+        session = make_windowed_session(in_flight=written["in_flight"],
+                                        delta_cursor=written["delta_cursor"])
+        _, written, sent = self._ack(session, bitmap_ack(10, range(10, 20)))
+        assert sent == WINDOW_DELTA[10:18]
+
+    def test_last_chunks_acked_awaits_complete(self):
+        session = make_windowed_session(in_flight="[19]", delta_cursor=20)
+        result, written, sent = self._ack(session, bitmap_ack(20, [29], base=0))
+
+        assert sent == []
+        assert written["status"] == "validating"
+        assert "awaiting COMPLETE" in result["body"]
+
+    def test_missing_below_window_rescans(self):
+        session = make_windowed_session(in_flight="[19]", delta_cursor=20)
+        _, written, sent = self._ack(session, bitmap_ack(18, [29]))
+
+        assert sent == WINDOW_DELTA[:8]
+        assert written["status"] == "sending"
+
+    def test_plain_ack_falls_back_to_per_chunk(self):
+        session = make_windowed_session(in_flight=json.dumps(list(range(8))), delta_cursor=8)
+        _, written, sent = self._ack(session, {"type": "ack", "status": 0,
+                                               "next_chunk": 1, "chunks_received": 1})
+
+        assert sent == [11]
+        assert written["windowed"] is False
+        assert ota.session_start_flags(written) >> ota.OTA_START_FLAGS_ACK_SHIFT == 4
+
+    def test_stale_window_resends_oldest_in_flight(self):
+        session = make_windowed_session(in_flight="[3, 5]", delta_cursor=9, updated_at=0)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session"), \
+             patch.object(ota, "send_chunk") as mock_send:
+            ota.handle_retry_check({"source": "aws.events"})
+
+        assert mock_send.call_args[0][1] == 13
+
+
+class TestSessionMetrics:
+    def test_ack_counts_uplink(self):
+        session = make_delta_session(uplinks=4)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "send_chunk"):
+            ota.handle_device_ack({"type": "ack", "status": 0,
+                                   "next_chunk": 0, "chunks_received": 0})
+
+        assert mock_write.call_args[0][0]["uplinks"] == 5
+        kwargs = ota.state_table.update_item.call_args.kwargs
+        assert kwargs["UpdateExpression"] == "SET ota_uplinks = :n"
+
+    def test_ignored_ack_counted_without_refreshing_session(self):
+        session = make_full_session(next_chunk=3, highest_acked=3)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "write_session") as mock_write, \
+             patch.object(ota, "send_chunk"):
+            ota.handle_device_ack({"type": "ack", "status": 0,
+                                   "next_chunk": 2, "chunks_received": 2})
+
+        mock_write.assert_not_called()
+        assert ota.state_table.update_item.call_args.kwargs[
+            "ExpressionAttributeValues"] == {":n": 1}
+
+    def test_complete_logs_uplinks_and_wall_time(self):
+        session = make_windowed_session(uplinks=6, mode="delta",
+                                        started_at=int(ota.time.time()) - 100)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "clear_session"), \
+             patch.object(ota, "log_ota_event") as mock_log, \
+             patch.object(ota.s3, "copy_object"):
+            ota.handle_device_complete({"type": "complete", "result": ota.OTA_STATUS_OK})
+
+        event, details = mock_log.call_args[0]
+        assert event == "ota_complete"
+        assert details["uplinks"] == 7
+        assert 100 <= details["wall_s"] <= 102
+        assert details["mode"] == "delta"
+        assert details["ack_every"] == 4
+        assert details["total_chunks"] == len(WINDOW_DELTA)
+
+    def test_abort_logs_metrics(self):
+        session = make_full_session(uplinks=9, retries=ota.MAX_RETRIES, updated_at=0)
+
+        with patch.object(ota, "get_session", return_value=session), \
+             patch.object(ota, "clear_session"), \
+             patch.object(ota, "log_ota_event") as mock_log:
+            ota.handle_retry_check({"source": "aws.events"})
+
+        event, details = mock_log.call_args[0]
+        assert event == "ota_aborted"
+        assert details["uplinks"] == 9
+
+
 # --- compute_delta_chunks edge cases ---
 
 class TestComputeDeltaChunks:
@@ -128,6 +128,25 @@ class TestSignAndVerify:
         assert verify_signature(b"", pub) is False
         assert verify_signature(b"\x00" * 64, pub) is False  # Exactly sig size
 
+    def test_signature_covers_sha256_digest(self):
+        """Device verifies Ed25519 over SHA-256(firmware), streamed from flash."""
+        import hashlib
+
+        from ota_signing import OTA_SIG_SIZE, sign_firmware
+
+        priv, pub = self._make_keys()
+        firmware = bytes(range(256)) * 4
+        sig = sign_firmware(firmware, priv)[-OTA_SIG_SIZE:]
+        pub.verify(sig, hashlib.sha256(firmware).digest())
+
+    def test_full_staging_size_image(self):
+        """Images up to the 148KB staging area sign and verify."""
+        from ota_signing import sign_firmware, verify_signature
+
+        priv, pub = self._make_keys()
+        firmware = os.urandom(0x24FFF - 64)
+        assert verify_signature(sign_firmware(firmware, priv), pub) is True
+
     def test_ed25519_is_deterministic(self):
         from ota_signing import sign_firmware
 
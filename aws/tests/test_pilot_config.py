@@ -0,0 +1,96 @@
+"""Tests for pilot_config.py — J1772 classifier tuning downlink."""
+
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), ".."))
+import pilot_config  # noqa: E402
+from pilot_config import (  # noqa: E402
+    FILTER_MEDIAN,
+    FILTER_TRIMMED_MEAN,
+    encode_pilot_config,
+    encode_pilot_reset,
+)
+
+# Same key as the C tests: 32 bytes of 0xAA
+TEST_KEY = bytes([0xAA] * 32)
+
+
+class TestEncode:
+    def test_defaults(self):
+        payload = encode_pilot_config()
+        assert payload == bytes.fromhex("50280a3a074c045e010f03")
+        assert len(payload) == 11
+
+    def test_fields(self):
+        """Matches the payload the firmware tests decode."""
+        payload = encode_pilot_config((2650, 1850, 1100, 300), 200, 4, FILTER_TRIMMED_MEAN)
+        assert payload == bytes.fromhex("505a0a3a074c042c011414")
+
+    def test_reset(self):
+        assert encode_pilot_reset() == bytes([0x50])
+
+    @pytest.mark.parametrize("kwargs", [
+        {"debounce": 0},
+        {"debounce": 16},
+        {"filter": 2},
+        {"hysteresis_mv": 155},
+        {"hysteresis_mv": 2560},
+        {"thresholds_mv": (2600, 1850, 1100)},
+        {"thresholds_mv": (2600, 1100, 1850, 350)},
+        {"thresholds_mv": (2600, 2400, 1100, 350)},   # 200 mV gap, 150 mV band
+        {"thresholds_mv": (70000, 1850, 1100, 350)},
+    ])
+    def test_rejects_what_the_firmware_rejects(self, kwargs):
+        with pytest.raises(ValueError):
+            encode_pilot_config(**kwargs)
+
+    def test_zero_hysteresis_single_read(self):
+        payload = encode_pilot_config(hysteresis_mv=0, debounce=1, filter=FILTER_MEDIAN)
+        assert payload[9:] == bytes([0x00, 0x01])
+
+
+class TestSign:
+    def test_signed_config_matches_firmware_vector(self):
+        payload = encode_pilot_config((2650, 1850, 1100, 300), 200, 4, FILTER_TRIMMED_MEAN)
+        signed = pilot_config.sign(payload, TEST_KEY)
+        assert signed[11:] == bytes.fromhex("f02706170ea0799f")
+        assert len(signed) == 19
+
+    def test_signed_reset_matches_firmware_vector(self):
+        signed = pilot_config.sign(encode_pilot_reset(), TEST_KEY)
+        assert signed == bytes.fromhex("50d21c5cb41bf1c041")
+
+    def test_unsigned_without_key(self, monkeypatch):
+        monkeypatch.delenv("CMD_AUTH_KEY", raising=False)
+        assert pilot_config.sign(encode_pilot_reset()) == bytes([0x50])
+
+
+class TestCli:
+    def test_send_signed(self, monkeypatch):
+        monkeypatch.setenv("CMD_AUTH_KEY", TEST_KEY.hex())
+        sent = []
+        monkeypatch.setattr(pilot_config, "send_sidewalk_msg",
+                            lambda p, transmit_mode, wireless_device_id: sent.append(p))
+        assert pilot_config.main(["--hysteresis", "200", "--debounce", "4",
+                                  "--thresholds", "2650", "1850", "1100", "300",
+                                  "--filter", "trimmed"]) == 0
+        assert sent == [bytes.fromhex("505a0a3a074c042c011414f02706170ea0799f")]
+
+    def test_reset(self, monkeypatch):
+        monkeypatch.delenv("CMD_AUTH_KEY", raising=False)
+        sent = []
+        monkeypatch.setattr(pilot_config, "send_sidewalk_msg",
+                            lambda p, transmit_mode, wireless_device_id: sent.append(p))
+        assert pilot_config.main(["--reset"]) == 0
+        assert sent == [bytes([0x50])]
+
+    def test_invalid_not_sent(self, monkeypatch, capsys):
+        sent = []
+        monkeypatch.setattr(pilot_config, "send_sidewalk_msg",
+                            lambda *a, **k: sent.append(a))
+        assert pilot_config.main(["--debounce", "0"]) == 1
+        assert sent == []
+        assert "ERROR" in capsys.readouterr().out
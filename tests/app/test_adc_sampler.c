@@ -0,0 +1,231 @@
+/*
+ * Unit tests for adc_sampler.c — cached readings behind platform
+ * adc_read_mv()/adc_get_mv()/adc_get_burst(), published by the
+ * continuous ADC scan.
+ */
+
+#include "unity.h"
+#include <adc_sampler.h>
+#include <errno.h>
+
+static void publish2(int32_t ch0, int32_t ch1, uint32_t now_ms)
+{
+	const int32_t mv[2] = { ch0, ch1 };
+
+	adc_sampler_publish(mv, now_ms);
+}
+
+void setUp(void)
+{
+	adc_sampler_init(2, ADC_SAMPLER_FILTER_SHIFT);
+}
+
+void tearDown(void) { }
+
+static void test_no_reading_before_first_scan(void)
+{
+	TEST_ASSERT_TRUE(adc_sampler_running());
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, adc_sampler_get(0, 0, NULL));
+}
+
+static void test_bad_channel(void)
+{
+	publish2(1000, 3300, 10);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, adc_sampler_get(-1, 10, NULL));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, adc_sampler_get(2, 10, NULL));
+}
+
+static void test_first_scan_seeds_filter(void)
+{
+	publish2(2980, 3300, 10);
+	TEST_ASSERT_EQUAL_INT(2980, adc_sampler_get(0, 10, NULL));
+	TEST_ASSERT_EQUAL_INT(3300, adc_sampler_get(1, 10, NULL));
+}
+
+static void test_filter_moves_a_quarter_per_scan(void)
+{
+	adc_sampler_init(2, 2);
+	publish2(0, 0, 0);
+	publish2(1000, 0, 100);
+	TEST_ASSERT_EQUAL_INT(250, adc_sampler_get(0, 100, NULL));
+	publish2(1000, 0, 200);
+	TEST_ASSERT_EQUAL_INT(437, adc_sampler_get(0, 200, NULL));
+
+	for (uint32_t t = 300; t < 3000; t += 100) {
+		publish2(1000, 0, t);
+	}
+	TEST_ASSERT_INT_WITHIN(4, 1000, adc_sampler_get(0, 2900, NULL));
+}
+
+static void test_default_filter_crosses_j1772_step_in_two_scans(void)
+{
+	/* B (2234mV) -> C (1489mV), B/C threshold at 1850mV */
+	publish2(2234, 0, 0);
+	publish2(1489, 0, ADC_SAMPLER_PERIOD_MS);
+	TEST_ASSERT_GREATER_THAN_INT(1850, adc_sampler_get(0, ADC_SAMPLER_PERIOD_MS, NULL));
+	publish2(1489, 0, 2 * ADC_SAMPLER_PERIOD_MS);
+	TEST_ASSERT_LESS_THAN_INT(1850, adc_sampler_get(0, 2 * ADC_SAMPLER_PERIOD_MS, NULL));
+}
+
+static void test_unfiltered_follows_latest_scan(void)
+{
+	adc_sampler_init(2, 0);
+	publish2(0, 0, 0);
+	publish2(1500, 0, 100);
+	TEST_ASSERT_EQUAL_INT(1500, adc_sampler_get(0, 100, NULL));
+}
+
+static void test_negative_reading_clamped(void)
+{
+	publish2(-3, 0, 0);
+	TEST_ASSERT_EQUAL_INT(0, adc_sampler_get(0, 0, NULL));
+}
+
+static void test_sample_time_and_staleness(void)
+{
+	uint32_t ms = 0;
+
+	publish2(2234, 0, 5000);
+	TEST_ASSERT_EQUAL_INT(2234, adc_sampler_get(0, 5040, &ms));
+	TEST_ASSERT_EQUAL_UINT32(5000, ms);
+	TEST_ASSERT_EQUAL_INT(2234, adc_sampler_get(0, 5000 + ADC_SAMPLER_STALE_MS, NULL));
+	TEST_ASSERT_EQUAL_INT(-ETIMEDOUT,
+			      adc_sampler_get(0, 5001 + ADC_SAMPLER_STALE_MS, NULL));
+}
+
+static void test_staleness_across_uptime_wrap(void)
+{
+	publish2(2234, 0, UINT32_MAX - 50);
+	TEST_ASSERT_EQUAL_INT(2234, adc_sampler_get(0, 49, NULL));
+}
+
+static void test_scans_alternate_banks(void)
+{
+	/* Every publish leaves the previous scan intact in the other bank,
+	 * and readers always see the newest */
+	for (uint32_t i = 1; i <= 5; i++) {
+		adc_sampler_init(2, 0);
+		for (uint32_t k = 1; k <= i; k++) {
+			publish2((int32_t)k * 100, (int32_t)k * 200, k);
+		}
+		TEST_ASSERT_EQUAL_INT((int)i * 100, adc_sampler_get(0, i, NULL));
+		TEST_ASSERT_EQUAL_INT((int)i * 200, adc_sampler_get(1, i, NULL));
+	}
+}
+
+static void test_stats(void)
+{
+	struct adc_sampler_stats st;
+
+	adc_sampler_stats(&st);
+	TEST_ASSERT_EQUAL_UINT32(0, st.scans);
+
+	publish2(1, 1, 100);
+	publish2(1, 1, 200);
+	adc_sampler_stats(&st);
+	TEST_ASSERT_EQUAL_UINT32(2, st.scans);
+	TEST_ASSERT_EQUAL_UINT32(200, st.last_ms);
+	TEST_ASSERT_EQUAL_UINT32(0, st.retries);
+}
+
+static void test_channel_count_clamped(void)
+{
+	const int32_t mv[ADC_SAMPLER_MAX_CHANNELS] = { 1, 2, 3, 4 };
+
+	adc_sampler_init(ADC_SAMPLER_MAX_CHANNELS + 2, 0);
+	adc_sampler_publish(mv, 0);
+	TEST_ASSERT_EQUAL_INT(4, adc_sampler_get(ADC_SAMPLER_MAX_CHANNELS - 1, 0, NULL));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, adc_sampler_get(ADC_SAMPLER_MAX_CHANNELS, 0, NULL));
+}
+
+static void test_burst_layout_and_copy(void)
+{
+	/* Two channels, three samplings: s0c0 s0c1 s1c0 s1c1 s2c0 s2c1 */
+	const int32_t mv[] = { 100, 3300, 0, 3290, -4, 3310 };
+	int16_t out[4] = { 0 };
+	uint32_t ms = 0;
+
+	adc_sampler_publish_burst(mv, 3, 700);
+	TEST_ASSERT_EQUAL_INT(3, adc_sampler_get_burst(0, 700, out, 4, &ms));
+	TEST_ASSERT_EQUAL_INT16(100, out[0]);
+	TEST_ASSERT_EQUAL_INT16(0, out[1]);
+	TEST_ASSERT_EQUAL_INT16(0, out[2]);     /* clamped */
+	TEST_ASSERT_EQUAL_UINT32(700, ms);
+	TEST_ASSERT_EQUAL_INT(3, adc_sampler_get_burst(1, 700, out, 4, NULL));
+	TEST_ASSERT_EQUAL_INT16(3290, out[1]);
+}
+
+static void test_burst_copy_limited_to_max(void)
+{
+	const int32_t mv[] = { 1, 0, 2, 0, 3, 0 };
+	int16_t out[2] = { 0 };
+
+	adc_sampler_publish_burst(mv, 3, 0);
+	TEST_ASSERT_EQUAL_INT(2, adc_sampler_get_burst(0, 0, out, 2, NULL));
+	TEST_ASSERT_EQUAL_INT16(2, out[1]);
+}
+
+static void test_burst_filtered_value_is_median(void)
+{
+	/* A PWM-like burst with one spike: the EMA input is the median */
+	const int32_t mv[] = { 2234, 0, 0, 0, 2234, 0, 3300, 0, 2240, 0 };
+
+	adc_sampler_publish_burst(mv, 5, 0);
+	TEST_ASSERT_EQUAL_INT(2234, adc_sampler_get(0, 0, NULL));
+}
+
+static void test_burst_errors(void)
+{
+	int16_t out[4];
+	const int32_t mv[] = { 1, 2 };
+
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, adc_sampler_get_burst(0, 0, out, 4, NULL));
+	adc_sampler_publish_burst(mv, 0, 0);    /* empty burst: not a scan */
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, adc_sampler_get_burst(0, 0, out, 4, NULL));
+	adc_sampler_publish_burst(mv, 1, 0);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, adc_sampler_get_burst(2, 0, out, 4, NULL));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, adc_sampler_get_burst(0, 0, NULL, 4, NULL));
+	TEST_ASSERT_EQUAL_INT(-ETIMEDOUT,
+			      adc_sampler_get_burst(0, ADC_SAMPLER_STALE_MS + 1, out, 4, NULL));
+}
+
+static void test_burst_samplings_clamped(void)
+{
+	int32_t mv[2 * (ADC_SAMPLER_BURST + 2)] = { 0 };
+	int16_t out[ADC_SAMPLER_BURST + 2];
+
+	adc_sampler_publish_burst(mv, ADC_SAMPLER_BURST + 2, 0);
+	TEST_ASSERT_EQUAL_INT(ADC_SAMPLER_BURST,
+			      adc_sampler_get_burst(0, 0, out, ADC_SAMPLER_BURST + 2, NULL));
+}
+
+static void test_not_running_without_channels(void)
+{
+	adc_sampler_init(0, 0);
+	TEST_ASSERT_FALSE(adc_sampler_running());
+	TEST_ASSERT_EQUAL_INT(-EINVAL, adc_sampler_get(0, 0, NULL));
+}
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_no_reading_before_first_scan);
+	RUN_TEST(test_bad_channel);
+	RUN_TEST(test_first_scan_seeds_filter);
+	RUN_TEST(test_filter_moves_a_quarter_per_scan);
+	RUN_TEST(test_default_filter_crosses_j1772_step_in_two_scans);
+	RUN_TEST(test_unfiltered_follows_latest_scan);
+	RUN_TEST(test_negative_reading_clamped);
+	RUN_TEST(test_sample_time_and_staleness);
+	RUN_TEST(test_staleness_across_uptime_wrap);
+	RUN_TEST(test_scans_alternate_banks);
+	RUN_TEST(test_stats);
+	RUN_TEST(test_channel_count_clamped);
+	RUN_TEST(test_burst_layout_and_copy);
+	RUN_TEST(test_burst_copy_limited_to_max);
+	RUN_TEST(test_burst_filtered_value_is_median);
+	RUN_TEST(test_burst_errors);
+	RUN_TEST(test_burst_samplings_clamped);
+	RUN_TEST(test_not_running_without_channels);
+	return UNITY_END();
+}
@@ -0,0 +1,210 @@
+/*
+ * Unit tests for airtime_budget.c — per-link frame buckets, LoRa
+ * airtime estimates, and the rolling hourly duty-cycle window.
+ */
+
+#include "unity.h"
+#include <airtime_budget.h>
+#include <stdio.h>
+
+#define MASK_BLE   0x01
+#define MASK_FSK   0x02
+#define MASK_LORA  0x04
+
+void setUp(void)
+{
+	airtime_budget_init();
+}
+
+void tearDown(void) { }
+
+/* --- Link selection and estimates --- */
+
+static void test_link_from_mask(void)
+{
+	TEST_ASSERT_EQUAL_INT(AIRTIME_LINK_BLE, airtime_link_from_mask(MASK_BLE));
+	TEST_ASSERT_EQUAL_INT(AIRTIME_LINK_FSK, airtime_link_from_mask(MASK_FSK));
+	TEST_ASSERT_EQUAL_INT(AIRTIME_LINK_LORA, airtime_link_from_mask(MASK_LORA));
+	TEST_ASSERT_EQUAL_INT(AIRTIME_LINK_LORA,
+			      airtime_link_from_mask(MASK_BLE | MASK_LORA));
+	TEST_ASSERT_EQUAL_INT(AIRTIME_LINK_LORA, airtime_link_from_mask(0));
+}
+
+static void test_lora_estimate_matches_an1200(void)
+{
+	/* SF7/125k, 27-byte frame (15 app + 12 overhead):
+	 * 12.25 preamble + 8 + ceil(232/28)*5 = 65.25 symbols of 1.024 ms */
+	TEST_ASSERT_EQUAL_UINT32(66816, airtime_estimate_us(AIRTIME_LINK_LORA, 15));
+}
+
+static void test_estimate_grows_with_length_and_ble_is_cheap(void)
+{
+	uint32_t lora_small = airtime_estimate_us(AIRTIME_LINK_LORA, 7);
+	uint32_t lora_big = airtime_estimate_us(AIRTIME_LINK_LORA, 19);
+	TEST_ASSERT_TRUE(lora_big > lora_small);
+	TEST_ASSERT_TRUE(airtime_estimate_us(AIRTIME_LINK_FSK, 19) < lora_big);
+	TEST_ASSERT_TRUE(airtime_estimate_us(AIRTIME_LINK_BLE, 64) < 1000);
+}
+
+/* --- Frame bucket --- */
+
+static int burst(uint32_t mask, uint32_t now, int max)
+{
+	int n = 0;
+	while (n < max && airtime_budget_allows(mask, 15, false, now)) {
+		airtime_budget_spend(mask, 15, now);
+		n++;
+	}
+	return n;
+}
+
+static void test_lora_burst_of_two_then_one_per_5s(void)
+{
+	TEST_ASSERT_EQUAL_INT(2, burst(MASK_LORA, 1000, 10));
+	TEST_ASSERT_FALSE(airtime_budget_allows(MASK_LORA, 15, false, 5999));
+	TEST_ASSERT_EQUAL_INT(1, burst(MASK_LORA, 6000, 10));
+}
+
+static void test_ble_allows_bigger_faster_bursts(void)
+{
+	TEST_ASSERT_EQUAL_INT(5, burst(MASK_BLE, 1000, 10));
+	TEST_ASSERT_EQUAL_INT(1, burst(MASK_BLE, 2000, 10));
+}
+
+static void test_background_needs_full_bucket(void)
+{
+	airtime_budget_spend(MASK_LORA, 15, 1000);
+	TEST_ASSERT_TRUE(airtime_budget_allows(MASK_LORA, 15, false, 1000));
+	TEST_ASSERT_FALSE(airtime_budget_allows(MASK_LORA, 15, true, 1000));
+	TEST_ASSERT_TRUE(airtime_budget_allows(MASK_LORA, 15, true, 6000));
+}
+
+static void test_link_switch_rescales_credit(void)
+{
+	/* A full LoRa bucket carries over as a full BLE bucket */
+	TEST_ASSERT_EQUAL_INT(5, burst(MASK_BLE, 0, 10));
+	/* Empty BLE bucket stays empty on switching back */
+	TEST_ASSERT_FALSE(airtime_budget_allows(MASK_LORA, 15, false, 0));
+}
+
+/* --- Hourly airtime window --- */
+
+static void test_remaining_starts_full_and_drops_per_frame(void)
+{
+	TEST_ASSERT_EQUAL_UINT32(AIRTIME_HOURLY_BUDGET_MS, airtime_budget_remaining_ms(0));
+	airtime_budget_spend(MASK_LORA, 15, 0);
+	TEST_ASSERT_EQUAL_UINT32(AIRTIME_HOURLY_BUDGET_MS - 67,
+				 airtime_budget_remaining_ms(0));
+	/* BLE costs nothing against the duty cycle */
+	airtime_budget_spend(MASK_BLE, 64, 0);
+	TEST_ASSERT_EQUAL_UINT32(AIRTIME_HOURLY_BUDGET_MS - 67,
+				 airtime_budget_remaining_ms(0));
+}
+
+static void test_hourly_cap_blocks_until_window_rolls(void)
+{
+	/* Exhaust the hour at max frame size, ignoring the frame bucket */
+	uint32_t t = 0;
+	while (airtime_budget_remaining_ms(t) >= 50) {
+		airtime_budget_spend(MASK_LORA, 19, t);
+		t += 1;
+	}
+	TEST_ASSERT_FALSE(airtime_budget_allows(MASK_LORA, 19, false, 10000));
+
+	/* Once the 5-minute bin holding that airtime ages out, sends resume */
+	TEST_ASSERT_FALSE(airtime_budget_allows(MASK_LORA, 19, false, 3599999));
+	TEST_ASSERT_TRUE(airtime_budget_allows(MASK_LORA, 19, false, 3600000));
+	TEST_ASSERT_EQUAL_UINT32(AIRTIME_HOURLY_BUDGET_MS,
+				 airtime_budget_remaining_ms(3600000));
+}
+
+static void test_wait_ms_for_bucket_refill(void)
+{
+	TEST_ASSERT_EQUAL_UINT32(0, airtime_budget_wait_ms(MASK_LORA, 15, false, 1000));
+	burst(MASK_LORA, 1000, 10);
+
+	/* Live needs one interval of credit, background a full bucket */
+	TEST_ASSERT_EQUAL_UINT32(4000, airtime_budget_wait_ms(MASK_LORA, 15, false, 2000));
+	TEST_ASSERT_EQUAL_UINT32(9000, airtime_budget_wait_ms(MASK_LORA, 15, true, 2000));
+	TEST_ASSERT_EQUAL_UINT32(0, airtime_budget_wait_ms(MASK_LORA, 15, false, 6000));
+	TEST_ASSERT_TRUE(airtime_budget_allows(MASK_LORA, 15, false, 6000));
+
+	/* BLE refills in a second */
+	airtime_budget_init();
+	burst(MASK_BLE, 0, 10);
+	TEST_ASSERT_EQUAL_UINT32(1000, airtime_budget_wait_ms(MASK_BLE, 15, false, 0));
+}
+
+static void test_wait_ms_for_spent_hour(void)
+{
+	uint32_t t = 0;
+	while (airtime_budget_remaining_ms(t) >= 50) {
+		airtime_budget_spend(MASK_LORA, 19, t);
+		t += 1;
+	}
+
+	/* Bucket long refilled; the hour frees up at the next bin boundary */
+	TEST_ASSERT_EQUAL_UINT32(290000, airtime_budget_wait_ms(MASK_LORA, 19, false, 10000));
+	TEST_ASSERT_EQUAL_UINT32(1, airtime_budget_wait_ms(MASK_LORA, 19, false, 3599999));
+	TEST_ASSERT_EQUAL_UINT32(0, airtime_budget_wait_ms(MASK_LORA, 19, false, 3600000));
+}
+
+static void test_background_leaves_live_reserve(void)
+{
+	uint32_t t = 0;
+	while (airtime_budget_remaining_ms(t) > AIRTIME_LIVE_RESERVE_MS + 1000) {
+		airtime_budget_spend(MASK_LORA, 19, t);
+	}
+	t = 20000;  /* frame bucket full again */
+	while (airtime_budget_allows(MASK_LORA, 19, true, t)) {
+		airtime_budget_spend(MASK_LORA, 19, t);
+		t += 10000;
+	}
+	/* Drain stopped at the reserve; a live transition still fits */
+	TEST_ASSERT_TRUE(airtime_budget_remaining_ms(t) >= AIRTIME_LIVE_RESERVE_MS - 100);
+	TEST_ASSERT_TRUE(airtime_budget_allows(MASK_LORA, 15, false, t));
+}
+
+static void test_bench_sustained_rate_within_duty_cycle(void)
+{
+	/* Offer a 15-byte uplink every second for an hour: the frame bucket
+	 * alone would pass 720; the duty-cycle window is the tighter limit */
+	int sent = 0;
+	for (uint32_t t = 0; t < 3600000; t += 1000) {
+		if (airtime_budget_allows(MASK_LORA, 15, false, t)) {
+			airtime_budget_spend(MASK_LORA, 15, t);
+			sent++;
+		}
+	}
+	uint32_t used_ms = AIRTIME_HOURLY_BUDGET_MS - airtime_budget_remaining_ms(3599999);
+	printf("  LoRa SF%d, 1 offer/s for 1h: %d sent, %u ms airtime (budget %d ms)\n",
+	       AIRTIME_LORA_SF, sent, used_ms, AIRTIME_HOURLY_BUDGET_MS);
+	TEST_ASSERT_LESS_OR_EQUAL_UINT32(AIRTIME_HOURLY_BUDGET_MS, used_ms);
+	TEST_ASSERT_LESS_OR_EQUAL_INT(3600 / 5 + 2, sent);
+}
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	/* Link selection and estimates */
+	RUN_TEST(test_link_from_mask);
+	RUN_TEST(test_lora_estimate_matches_an1200);
+	RUN_TEST(test_estimate_grows_with_length_and_ble_is_cheap);
+
+	/* Frame bucket */
+	RUN_TEST(test_lora_burst_of_two_then_one_per_5s);
+	RUN_TEST(test_ble_allows_bigger_faster_bursts);
+	RUN_TEST(test_background_needs_full_bucket);
+	RUN_TEST(test_link_switch_rescales_credit);
+
+	/* Hourly airtime window */
+	RUN_TEST(test_remaining_starts_full_and_drops_per_frame);
+	RUN_TEST(test_hourly_cap_blocks_until_window_rolls);
+	RUN_TEST(test_wait_ms_for_bucket_refill);
+	RUN_TEST(test_wait_ms_for_spent_hour);
+	RUN_TEST(test_background_leaves_live_reserve);
+	RUN_TEST(test_bench_sustained_rate_within_duty_cycle);
+
+	return UNITY_END();
+}
@@ -28,8 +28,12 @@
 #include <time_sync.h>
 #include <event_buffer.h>
 #include <event_filter.h>
+#include <drain_inflight.h>
+#include <airtime_budget.h>
 #include <delay_window.h>
+#include <pilot_config.h>
 #include <led_engine.h>
+#include <adc_sampler.h>
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
@@ -57,6 +61,7 @@ static void test_j1772_state_a_high_voltage(void)
 	mock_platform_api_reset();
 	mock_adc_values[0] = 2980;  /* ~12V after divider */
 	platform = mock_platform_api_get();
+	evse_sensors_init();
 
 	j1772_state_t state;
 	uint16_t mv;
@@ -70,6 +75,7 @@ static void test_j1772_state_b_connected(void)
 	mock_platform_api_reset();
 	mock_adc_values[0] = 2234;  /* ~9V */
 	platform = mock_platform_api_get();
+	evse_sensors_init();
 
 	j1772_state_t state;
 	uint16_t mv;
@@ -82,6 +88,7 @@ static void test_j1772_state_c_charging(void)
 	mock_platform_api_reset();
 	mock_adc_values[0] = 1489;  /* ~6V */
 	platform = mock_platform_api_get();
+	evse_sensors_init();
 
 	j1772_state_t state;
 	uint16_t mv;
@@ -94,6 +101,7 @@ static void test_j1772_state_d_ventilation(void)
 	mock_platform_api_reset();
 	mock_adc_values[0] = 745;  /* ~3V */
 	platform = mock_platform_api_get();
+	evse_sensors_init();
 
 	j1772_state_t state;
 	uint16_t mv;
@@ -106,6 +114,7 @@ static void test_j1772_state_e_error(void)
 	mock_platform_api_reset();
 	mock_adc_values[0] = 100;  /* ~0V */
 	platform = mock_platform_api_get();
+	evse_sensors_init();
 
 	j1772_state_t state;
 	uint16_t mv;
@@ -117,6 +126,7 @@ static void test_j1772_boundary_a_b(void)
 {
 	mock_platform_api_reset();
 	platform = mock_platform_api_get();
+	evse_sensors_init();
 
 	j1772_state_t state;
 	uint16_t mv;
@@ -126,7 +136,8 @@ static void test_j1772_boundary_a_b(void)
 	assert(evse_j1772_state_get(&state, &mv) == 0);
 	assert(state == J1772_STATE_A);
 
-	/* At threshold -> B */
+	/* At threshold -> B (from a fresh start: no hysteresis yet) */
+	evse_sensors_init();
 	mock_adc_values[0] = 2600;
 	assert(evse_j1772_state_get(&state, &mv) == 0);
 	assert(state == J1772_STATE_B);
@@ -136,6 +147,7 @@ static void test_j1772_boundary_b_c(void)
 {
 	mock_platform_api_reset();
 	platform = mock_platform_api_get();
+	evse_sensors_init();
 
 	j1772_state_t state;
 	uint16_t mv;
@@ -144,11 +156,33 @@ static void test_j1772_boundary_b_c(void)
 	assert(evse_j1772_state_get(&state, &mv) == 0);
 	assert(state == J1772_STATE_B);
 
+	evse_sensors_init();
 	mock_adc_values[0] = 1850;
 	assert(evse_j1772_state_get(&state, &mv) == 0);
 	assert(state == J1772_STATE_C);
 }
 
+/* Pilot at mv, accepted at the next read without the debounce, for
+ * tests about what a J1772 state drives rather than its detection */
+static void pilot_set_settled(int mv)
+{
+	mock_adc_values[0] = mv;
+	evse_sensors_init();
+}
+
+/* Default classifier tuning, optionally without the debounce for tests
+ * that script one pilot change per sensor cycle */
+static void pilot_tuning_defaults(bool debounce)
+{
+	struct evse_pilot_config cfg;
+
+	evse_pilot_config_defaults(&cfg);
+	if (!debounce) {
+		cfg.debounce = 1;
+	}
+	assert(evse_pilot_config_set(&cfg) == 0);
+}
+
 static void test_j1772_null_api_returns_error(void)
 {
 	platform = NULL;
@@ -186,6 +220,7 @@ static void test_simulation_overrides_adc(void)
 	mock_adc_values[0] = 2980;  /* real = State A */
 	mock_uptime_ms = 1000;
 	platform = mock_platform_api_get();
+	evse_sensors_init();
 
 	/* Simulate State C for 10s */
 	evse_sensors_simulate_state(J1772_STATE_C, 10000);
@@ -205,11 +240,23 @@ static void test_simulation_overrides_adc(void)
 /*  thermostat_inputs: GPIO flag reading                               */
 /* ================================================================== */
 
+/* The mock table as a platform without GPIO edges (API v7): inputs are
+ * read with gpio_get() */
+static const struct platform_api *polled_platform(void)
+{
+	static struct platform_api polled;
+
+	polled = *mock_platform_api_get();
+	polled.version = PLATFORM_API_VERSION_ADC_BURST;
+	return &polled;
+}
+
 static void test_thermostat_no_calls(void)
 {
 	mock_platform_api_reset();
 	mock_gpio_values[2] = 0;  /* cool off */
 	platform = mock_platform_api_get();
+	thermostat_inputs_init();
 
 	assert(thermostat_inputs_flags_get() == 0x00);
 }
@@ -219,6 +266,7 @@ static void test_thermostat_cool_only(void)
 	mock_platform_api_reset();
 	mock_gpio_values[2] = 1;  /* cool on */
 	platform = mock_platform_api_get();
+	thermostat_inputs_init();
 
 	assert(thermostat_inputs_flags_get() == 0x02);
 }
@@ -228,6 +276,7 @@ static void test_thermostat_both_calls(void)
 	mock_platform_api_reset();
 	mock_gpio_values[2] = 1;
 	platform = mock_platform_api_get();
+	thermostat_inputs_init();
 
 	assert(thermostat_inputs_flags_get() == 0x02);
 }
@@ -351,23 +400,33 @@ static void test_app_tx_rate_limits(void)
 	mock_sidewalk_ready = true;
 
 	platform = mock_platform_api_get();
-	platform = mock_platform_api_get();
-	platform = mock_platform_api_get();
+	app_tx_init();
 	app_tx_set_ready(true);
 
 	/* First send succeeds */
 	assert(app_tx_send_evse_data() == 0);
 	assert(mock_send_count == 1);
 
-	/* Second send within 5s is rate-limited */
+	/* A second transition right behind it spends the burst token */
 	mock_uptime_ms = 102000;
-	assert(app_tx_send_evse_data() == 0);  /* returns 0 (rate-limited, not error) */
-	assert(mock_send_count == 1);   /* still 1 */
-
-	/* After 5s, send works */
-	mock_uptime_ms = 106000;
 	assert(app_tx_send_evse_data() == 0);
 	assert(mock_send_count == 2);
+
+	/* Third within the window is queued, not dropped */
+	mock_uptime_ms = 103000;
+	assert(app_tx_send_evse_data() == 0);  /* returns 0 (queued, not error) */
+	assert(mock_send_count == 2);
+	assert(app_tx_queue_depth() == 1);
+
+	mock_uptime_ms = 104000;
+	assert(app_tx_flush() == 0);
+	assert(mock_send_count == 2);
+
+	/* Budget refills at one uplink per 5s: the queued one goes out */
+	mock_uptime_ms = 105000;
+	assert(app_tx_flush() == 1);
+	assert(mock_send_count == 3);
+	assert(app_tx_queue_depth() == 0);
 }
 
 static void test_app_tx_not_ready_skips(void)
@@ -388,11 +447,23 @@ static void test_app_tx_not_ready_skips(void)
 
 static uint32_t timer_test_base;
 
-/* Call on_timer 5 times (decimation) so sensor logic executes once */
+/* Fire on_timer at the current uptime: the sensor logic runs once if
+ * SENSOR_POLL_MS (500) have passed since the last cycle */
 static void tick_sensor_cycle(void)
 {
-	for (int i = 0; i < 5; i++) {
-		app_cb.on_timer();
+	app_cb.on_timer();
+}
+
+/* A pilot change is accepted once the J1772 debounce has seen it in
+ * that many fresh scans: one per sensor cycle, 500ms apart from at_ms */
+static void tick_pilot_debounce(uint32_t at_ms)
+{
+	struct evse_pilot_config cfg;
+
+	evse_pilot_config_get(&cfg);
+	for (int i = 0; i < cfg.debounce; i++) {
+		mock_uptime_ms = at_ms + (uint32_t)i * 500;
+		tick_sensor_cycle();
 	}
 }
 
@@ -409,6 +480,7 @@ static void init_app_for_timer_tests(void)
 	mock_sidewalk_ready = true;
 
 	app_cb.init(mock_platform_api_get());
+	pilot_tuning_defaults(true);
 	/* Clear sends from init */
 	mock_send_count = 0;
 }
@@ -427,10 +499,12 @@ static void test_on_timer_j1772_change_triggers_send(void)
 {
 	init_app_for_timer_tests();
 
-	/* Change J1772 from A to C */
+	/* Change J1772 from A to C: held until the debounce accepts it */
 	mock_adc_values[0] = 1489;
 	mock_uptime_ms = timer_test_base + 1000;
 	tick_sensor_cycle();
+	assert(mock_send_count == 0);
+	tick_pilot_debounce(timer_test_base + 1500);
 	assert(mock_send_count == 1);
 }
 
@@ -449,6 +523,49 @@ static void test_on_timer_thermostat_change_triggers_send(void)
 {
 	init_app_for_timer_tests();
 
+	/* Cool call turns on: recorded when the edge arrives, sent by the
+	 * next sensor cycle */
+	mock_uptime_ms = timer_test_base + 1000;
+	assert(mock_gpio_edge(&app_cb, 2, 1, timer_test_base + 950) == 1);
+	assert(mock_send_count == 0);
+	tick_sensor_cycle();
+	assert(mock_send_count == 1);
+
+	/* The next tick sees nothing new */
+	mock_uptime_ms = timer_test_base + 1500;
+	tick_sensor_cycle();
+	assert(mock_send_count == 1);
+}
+
+static void test_thermostat_edge_burst_sends_once(void)
+{
+	init_app_for_timer_tests();
+	uint16_t before = event_buffer_count();
+
+	/* A chattering contact: every change is recorded at its edge */
+	for (int i = 0; i < 6; i++) {
+		mock_uptime_ms = timer_test_base + 1000 + (uint32_t)i * 60;
+		assert(mock_gpio_edge(&app_cb, 2, !(i & 1), mock_uptime_ms) == 1);
+	}
+	assert(mock_send_count == 0);
+	assert(event_buffer_count() == before + 6);
+
+	/* One uplink for the burst, with the state it ended in */
+	mock_uptime_ms = timer_test_base + 1500;
+	tick_sensor_cycle();
+	assert(mock_send_count == 1);
+
+	struct event_snapshot snap;
+	assert(event_buffer_get_latest(&snap));
+	assert(snap.thermostat_flags == 0);
+}
+
+static void test_on_timer_thermostat_polled_before_edge_api(void)
+{
+	init_app_for_timer_tests();
+	app_cb.init(polled_platform());
+	mock_send_count = 0;
+
 	/* Turn on cool call */
 	mock_gpio_values[2] = 1;
 	mock_uptime_ms = timer_test_base + 1000;
@@ -456,6 +573,25 @@ static void test_on_timer_thermostat_change_triggers_send(void)
 	assert(mock_send_count == 1);
 }
 
+static void test_thermostat_edge_snapshot_time(void)
+{
+	init_app_for_timer_tests();
+	uint8_t sync_cmd[] = {0x30,
+		0x40, 0x42, 0x0F, 0x00,   /* epoch = 1000000 */
+		0x00, 0x00, 0x00, 0x00};
+	time_sync_process_cmd(sync_cmd, sizeof(sync_cmd));
+
+	/* Compressor called at +2.3s; the batch arrives at +4.9s */
+	mock_uptime_ms = timer_test_base + 4900;
+	assert(mock_gpio_edge(&app_cb, 2, 1, timer_test_base + 2300) == 1);
+
+	struct event_snapshot snap;
+	assert(event_buffer_get_latest(&snap));
+	assert(snap.thermostat_flags == THERMOSTAT_FLAG_COOL);
+	assert(snap.timestamp == 1000002);
+	assert(thermostat_inputs_changed_ms() == timer_test_base + 2300);
+}
+
 static void test_on_timer_heartbeat_sends_after_60s(void)
 {
 	init_app_for_timer_tests();
@@ -478,12 +614,23 @@ static void test_on_timer_no_heartbeat_before_60s(void)
 
 static void test_on_timer_multiple_changes_one_send(void)
 {
+	/* Polled, so both changes land in one tick */
 	init_app_for_timer_tests();
+	app_cb.init(polled_platform());
+	pilot_tuning_defaults(true);
+	mock_send_count = 0;
 
-	/* Change J1772 AND thermostat in the same tick */
-	mock_adc_values[0] = 1489;  /* A -> C */
+	/* J1772 A -> C, accepted in the same tick the thermostat changes */
+	struct evse_pilot_config cfg;
+	evse_pilot_config_get(&cfg);
+	mock_adc_values[0] = 1489;
+	for (int i = 0; i < cfg.debounce - 1; i++) {
+		mock_uptime_ms = timer_test_base + 1000 + (uint32_t)i * 500;
+		tick_sensor_cycle();
+	}
+	assert(mock_send_count == 0);
 	mock_gpio_values[2] = 1;    /* cool on */
-	mock_uptime_ms = timer_test_base + 1000;
+	mock_uptime_ms = timer_test_base + 1000 + (uint32_t)cfg.debounce * 500;
 	tick_sensor_cycle();
 	assert(mock_send_count == 1);  /* one send, not two */
 }
@@ -492,10 +639,9 @@ static void test_on_timer_settled_after_change_no_send(void)
 {
 	init_app_for_timer_tests();
 
-	/* First tick: change triggers live send */
+	/* Change triggers a live send once debounced */
 	mock_adc_values[0] = 1489;
-	mock_uptime_ms = timer_test_base + 1000;
-	tick_sensor_cycle();
+	tick_pilot_debounce(timer_test_base + 1000);
 	assert(mock_send_count == 1);
 
 	/* Second tick: same values, no live send (no change, no heartbeat).
@@ -867,6 +1013,7 @@ static void test_selftest_fault_flags_coexist_with_thermostat(void)
 	/* Set thermostat bits */
 	mock_gpio_values[2] = 1;  /* cool */
 	platform = mock_platform_api_get();
+	thermostat_inputs_init();
 	uint8_t therm = thermostat_inputs_flags_get();  /* 0x02 */
 
 	/* Cause selftest fault */
@@ -916,7 +1063,8 @@ static void test_diag_build_response_format(void)
 	int ret = diag_request_build_response(buf);
 	assert(ret == DIAG_PAYLOAD_SIZE);
 	assert(buf[0] == DIAG_MAGIC);       /* 0xE6 */
-	assert(buf[1] == DIAG_VERSION);     /* 0x01 */
+	assert(buf[1] == DIAG_VERSION);     /* 0x02 */
+	assert(DIAG_PAYLOAD_SIZE <= APP_TX_MTU_LORA);
 }
 
 static void test_diag_app_version(void)
@@ -1081,6 +1229,28 @@ static void test_diag_event_buffer_pending(void)
 	assert(buf[12] == 1);
 }
 
+static void test_diag_airtime_budget_remaining(void)
+{
+	init_diag();
+	airtime_budget_init();
+
+	uint8_t buf[DIAG_PAYLOAD_SIZE];
+	diag_request_build_response(buf);
+	assert((buf[15] | (buf[16] << 8)) == AIRTIME_HOURLY_BUDGET_MS);
+
+	/* A LoRa uplink draws the budget down by its estimated airtime */
+	airtime_budget_spend(0x04, 15, mock_uptime_ms);
+	uint32_t cost_ms = (airtime_estimate_us(AIRTIME_LINK_LORA, 15) + 999) / 1000;
+	diag_request_build_response(buf);
+	assert((uint32_t)(buf[15] | (buf[16] << 8)) == AIRTIME_HOURLY_BUDGET_MS - cost_ms);
+
+	/* The diag response itself is accounted too */
+	uint8_t cmd[] = {DIAG_REQUEST_CMD_TYPE};
+	diag_request_process_cmd(cmd, sizeof(cmd));
+	diag_request_build_response(buf);
+	assert((uint32_t)(buf[15] | (buf[16] << 8)) < AIRTIME_HOURLY_BUDGET_MS - cost_ms);
+}
+
 static void test_diag_process_cmd_sends_response(void)
 {
 	init_diag();
@@ -1165,11 +1335,32 @@ static void init_led_engine(void)
 	platform = mock_platform_api_get();
 	selftest_reset();
 	platform = mock_platform_api_get();
+	evse_sensors_init();
+	pilot_tuning_defaults(true);
 	led_engine_init();
 	/* Force commissioning to exit (uptime > 300s) */
 	led_engine_tick();
 }
 
+/* The mock table as a platform without LED patterns (API v8): the
+ * engine steps the pattern itself with led_set() */
+static const struct platform_api *stepped_platform(void)
+{
+	static struct platform_api stepped;
+
+	stepped = *mock_platform_api_get();
+	stepped.version = PLATFORM_API_VERSION_GPIO_EDGE;
+	return &stepped;
+}
+
+static void init_led_engine_stepped(void)
+{
+	init_led_engine();
+	platform = stepped_platform();
+	led_engine_init();
+	led_engine_tick();
+}
+
 static void test_led_idle_default(void)
 {
 	init_led_engine();
@@ -1290,6 +1481,7 @@ static void test_led_ac_priority(void)
 	init_led_engine();
 	/* Cool call active + charging paused = AC priority */
 	mock_gpio_values[2] = 1;
+	thermostat_inputs_init();
 	charge_control_set(false, 0);
 	led_engine_tick();
 	assert(led_engine_get_active_priority() == LED_PRI_AC_PRIORITY);
@@ -1298,8 +1490,14 @@ static void test_led_ac_priority(void)
 static void test_led_charging_state_c(void)
 {
 	init_led_engine();
-	mock_adc_values[0] = 1489;  /* State C */
-	led_engine_tick();
+	mock_adc_values[0] = 1489;  /* State C, accepted after the debounce */
+	struct evse_pilot_config cfg;
+	evse_pilot_config_get(&cfg);
+	for (int i = 1; i <= cfg.debounce; i++) {
+		assert(led_engine_get_active_priority() != LED_PRI_CHARGING);
+		mock_uptime_ms += 500;
+		led_engine_tick();
+	}
 	assert(led_engine_get_active_priority() == LED_PRI_CHARGING);
 }
 
@@ -1309,7 +1507,7 @@ static void test_led_charging_state_c(void)
 
 static void test_led_error_toggles_every_tick(void)
 {
-	init_led_engine();
+	init_led_engine_stepped();
 	/* Cause error via ADC failures */
 	led_engine_report_adc_result(false);
 	led_engine_report_adc_result(false);
@@ -1338,7 +1536,7 @@ static void test_led_commission_5on_5off(void)
 	platform = mock_platform_api_get();
 	platform = mock_platform_api_get();
 	selftest_reset();
-	platform = mock_platform_api_get();
+	platform = stepped_platform();
 	led_engine_init();
 
 	mock_led_call_count = 0;
@@ -1358,7 +1556,7 @@ static void test_led_commission_5on_5off(void)
 
 static void test_led_idle_blip(void)
 {
-	init_led_engine();
+	init_led_engine_stepped();
 	/* Re-init engine to reset step counter (init_led_engine ticked once) */
 	led_engine_init();
 	/* Force commissioning exit again (uptime is already past 300s) */
@@ -1385,8 +1583,8 @@ static void test_led_idle_blip(void)
 
 static void test_led_solid_on_charging(void)
 {
-	init_led_engine();
-	mock_adc_values[0] = 1489;  /* State C */
+	init_led_engine_stepped();
+	pilot_set_settled(1489);  /* State C */
 	mock_led_call_count = 0;
 
 	for (int i = 0; i < 5; i++) {
@@ -1400,7 +1598,7 @@ static void test_led_solid_on_charging(void)
 
 static void test_led_pattern_resets_on_priority_change(void)
 {
-	init_led_engine();
+	init_led_engine_stepped();
 	mock_led_call_count = 0;
 
 	/* Start in idle, tick a couple */
@@ -1408,7 +1606,7 @@ static void test_led_pattern_resets_on_priority_change(void)
 	led_engine_tick();
 
 	/* Switch to charging — pattern should restart */
-	mock_adc_values[0] = 1489;
+	pilot_set_settled(1489);
 	mock_led_call_count = 0;
 	led_engine_tick();
 	assert(led_engine_get_active_priority() == LED_PRI_CHARGING);
@@ -1523,11 +1721,11 @@ static void test_led_restores_after_selftest(void)
 {
 	init_led_engine();
 	/* Switch to charging */
-	mock_adc_values[0] = 1489;
+	pilot_set_settled(1489);
 	led_engine_tick();
 	assert(led_engine_get_active_priority() == LED_PRI_CHARGING);
 	/* Back to idle */
-	mock_adc_values[0] = 2980;
+	pilot_set_settled(2980);
 	led_engine_tick();
 	assert(led_engine_get_active_priority() == LED_PRI_IDLE);
 }
@@ -1538,7 +1736,7 @@ static void test_led_restores_after_selftest(void)
 
 static void test_led_button_ack_3_blinks(void)
 {
-	init_led_engine();
+	init_led_engine_stepped();
 	mock_led_call_count = 0;
 	led_engine_button_ack();
 
@@ -1573,7 +1771,7 @@ static void test_led_button_ack_blocked_by_error(void)
 }
 
 /* ================================================================== */
-/*  LED engine: timer decimation                                       */
+/*  Timer: sensor cycle and LED ticks                                  */
 /* ================================================================== */
 
 static void test_led_timer_interval_100(void)
@@ -1585,25 +1783,189 @@ static void test_led_timer_interval_100(void)
 	assert(mock_timer_interval == 100);
 }
 
-static void test_led_decimation_sensors_every_5th(void)
+static void test_sensor_cycle_every_500ms(void)
 {
 	init_app_for_timer_tests();
 
 	/* Change J1772 state */
-	mock_adc_values[0] = 1489;
-	mock_uptime_ms = timer_test_base + 1000;
+	pilot_set_settled(1489);
 
-	/* First 4 ticks: LED ticks but sensor logic doesn't run */
-	for (int i = 0; i < 4; i++) {
+	/* LED ticks only: the sensor cycle is 500ms after init */
+	for (uint32_t t = 100; t < 500; t += 100) {
+		mock_uptime_ms = timer_test_base + t;
 		app_cb.on_timer();
 	}
 	assert(mock_send_count == 0);  /* no sensor change detected yet */
 
-	/* 5th tick: sensor logic runs, detects change */
+	/* Sensor logic runs, detects change */
+	mock_uptime_ms = timer_test_base + 500;
 	app_cb.on_timer();
 	assert(mock_send_count == 1);
 }
 
+static void test_led_next_ms_idle_blip(void)
+{
+	init_led_engine_stepped();
+	led_engine_init();
+	led_engine_notify_uplink_sent();
+	mock_led_call_count = 0;
+
+	led_engine_tick();  /* blip: one tick ON */
+	assert(led_engine_next_ms() == 100);
+	led_engine_tick();  /* then 99 ticks OFF */
+	assert(led_engine_next_ms() == 9900);
+
+	/* Catching up the 99 ticks drives the LED once: the next blip */
+	led_engine_advance(99);
+	assert(mock_led_call_count == 3);
+	assert(mock_led_calls[2].on == true);
+	assert(led_engine_next_ms() == 100);
+}
+
+static void test_led_next_ms_solid_and_ack(void)
+{
+	init_led_engine_stepped();
+	pilot_set_settled(1489);  /* State C */
+	led_engine_tick();
+	assert(led_engine_get_active_priority() == LED_PRI_CHARGING);
+	assert(led_engine_next_ms() == UINT32_MAX);
+
+	/* The ack overlay steps every tick; skipped ticks use it up first */
+	led_engine_button_ack();
+	assert(led_engine_next_ms() == 100);
+	mock_led_call_count = 0;
+	led_engine_advance(6);
+	assert(mock_led_call_count == 1);
+	assert(mock_led_calls[0].on == false);
+	assert(led_engine_next_ms() == 100);
+
+	led_engine_tick();
+	assert(mock_led_calls[1].on == true);
+	assert(led_engine_next_ms() == UINT32_MAX);
+}
+
+static void test_timer_wakes_do_not_postpone(void)
+{
+	init_app_for_timer_tests();
+	led_engine_notify_uplink_sent();
+	mock_deliver_sends(&app_cb, 0, NULL);
+	/* Sleeping from one 5s idle pilot poll to the next */
+	for (int i = 0; i < 100 && mock_timer_interval != 5000; i++) {
+		mock_timer_run(&app_cb, mock_timer_due_ms);
+	}
+	assert(mock_timer_interval == 5000);
+
+	/* Downlinks 50ms apart, mid-sleep: the first restarts the timer,
+	 * the second leaves it due where it was */
+	mock_uptime_ms += 1000;
+	uint8_t ts_cmd[] = {0x30, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+	app_cb.on_msg_received(ts_cmd, sizeof(ts_cmd));
+	uint32_t due = mock_timer_due_ms;
+	assert(due == mock_uptime_ms + 100);
+	mock_uptime_ms += 50;
+	app_cb.on_msg_received(ts_cmd, sizeof(ts_cmd));
+	assert(mock_timer_due_ms == due);
+
+	/* That fire runs a sensor cycle and wants the same wait as before
+	 * the wake; the timer still runs at 100ms, so it is re-armed */
+	assert(mock_timer_run(&app_cb, due) == 1);
+	assert(mock_timer_interval == 5000);
+	assert(mock_timer_due_ms == due + 5000);
+}
+
+/* ================================================================== */
+/*  LED engine: patterns played by the platform (API v9)               */
+/* ================================================================== */
+
+static void test_led_pattern_uploaded_on_priority_change(void)
+{
+	init_led_engine();
+	assert(mock_led_pattern_count == 1);
+	assert(mock_led_patterns[0].led_id == LED_GREEN);
+	assert(mock_led_patterns[0].repeat == PLATFORM_LED_REPEAT_FOREVER);
+	assert(mock_led_patterns[0].count == 2);  /* idle blip */
+	assert(mock_led_patterns[0].steps[0].ticks == 1 && mock_led_patterns[0].steps[0].on);
+	assert(mock_led_patterns[0].steps[1].ticks == 99 && !mock_led_patterns[0].steps[1].on);
+	assert(led_engine_next_ms() == UINT32_MAX);
+
+	/* Same priority: no upload, no led_set */
+	mock_led_call_count = 0;
+	led_engine_advance(250);
+	led_engine_tick();
+	assert(mock_led_pattern_count == 1);
+	assert(mock_led_call_count == 0);
+
+	pilot_set_settled(1489);  /* State C */
+	led_engine_tick();
+	assert(led_engine_get_active_priority() == LED_PRI_CHARGING);
+	assert(mock_led_pattern_count == 2);
+	assert(mock_led_patterns[1].count == 1 && mock_led_patterns[1].steps[0].on);
+	assert(mock_led_call_count == 0);
+}
+
+static void test_led_pattern_ack_one_shot(void)
+{
+	init_led_engine();
+	pilot_set_settled(1489);  /* State C */
+	led_engine_tick();
+	assert(mock_led_pattern_count == 2);
+
+	/* The ack plays once, then the charging pattern is uploaded again */
+	led_engine_button_ack();
+	assert(led_engine_next_ms() == 100);
+	led_engine_tick();
+	assert(mock_led_pattern_count == 3);
+	assert(mock_led_patterns[2].count == 6 && mock_led_patterns[2].repeat == 1);
+	assert(led_engine_next_ms() == 600);
+
+	led_engine_advance(6);
+	assert(mock_led_pattern_count == 4);
+	assert(mock_led_patterns[3].repeat == PLATFORM_LED_REPEAT_FOREVER);
+	assert(mock_led_patterns[3].count == 1);
+	assert(led_engine_next_ms() == UINT32_MAX);
+	assert(mock_led_call_count == 0);
+}
+
+static void test_led_pattern_failure_steps_in_software(void)
+{
+	init_led_engine();
+	mock_led_pattern_return = -5;  /* -EIO */
+	mock_log_wrn_count = 0;
+	mock_led_call_count = 0;
+	led_engine_init();
+	led_engine_tick();
+	assert(mock_log_wrn_count == 1);
+	assert(mock_led_call_count == 1);
+	assert(mock_led_calls[0].on);  /* idle blip */
+
+	/* Stays in software: no retry, the pattern steps with led_set */
+	led_engine_tick();
+	assert(mock_log_wrn_count == 1);
+	assert(mock_led_call_count == 2);
+	assert(led_engine_next_ms() == 9900);
+}
+
+static void test_timer_rearmed_for_next_deadline(void)
+{
+	init_app_for_timer_tests();
+	led_engine_notify_uplink_sent();
+	mock_deliver_sends(&app_cb, 0, NULL);
+
+	/* Idle, nothing pending: 20s take a handful of wakeups, not 200 */
+	assert(mock_timer_run(&app_cb, timer_test_base + 20000) < 20);
+
+	/* Fire on until the timer sleeps longer than one tick */
+	while (mock_timer_interval <= 100) {
+		mock_timer_run(&app_cb, mock_timer_due_ms);
+	}
+
+	/* A downlink wakes the app within one tick */
+	uint8_t ts_cmd[] = {0x30, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+	app_cb.on_msg_received(ts_cmd, sizeof(ts_cmd));
+	assert(mock_timer_interval == 100);
+	assert(mock_timer_due_ms == mock_uptime_ms + 100);
+}
+
 /* ================================================================== */
 /*  delay_window: time-based charge pause/resume                       */
 /* ================================================================== */
@@ -2124,6 +2486,22 @@ static void test_charge_now_expires_after_30min(void)
 	assert(charge_now_is_active() == false);
 }
 
+static void test_charge_now_next_ms_counts_down(void)
+{
+	init_charge_now_test();
+	assert(charge_now_next_ms() == UINT32_MAX);
+	charge_now_activate();
+	assert(charge_now_next_ms() == CHARGE_NOW_DURATION_MS);
+
+	mock_uptime_ms = 2000000 + (29UL * 60 * 1000);
+	assert(charge_now_next_ms() == 60000);
+	mock_uptime_ms = 2000000 + (31UL * 60 * 1000);
+	assert(charge_now_next_ms() == 0);
+
+	charge_now_cancel();
+	assert(charge_now_next_ms() == UINT32_MAX);
+}
+
 static void test_charge_now_unplug_cancels(void)
 {
 	init_charge_now_test();
@@ -2197,19 +2575,23 @@ static void init_button_test(void)
 	led_engine_notify_uplink_sent();
 }
 
+/* The button settles on `level` at at_ms: the platform's edge reaches the
+ * app through on_gpio_edges, then a 500ms tick runs the press timeouts */
+static void button_edge(int level, uint32_t at_ms)
+{
+	mock_uptime_ms = at_ms;
+	assert(mock_gpio_edge(&app_cb, 3, level, at_ms) == 1);
+	selftest_trigger_tick();
+}
+
 static void test_single_press_activates_charge_now(void)
 {
 	init_button_test();
 	assert(charge_now_is_active() == false);
 
-	/* Simulate single button press: pressed for 1 tick, released */
-	mock_gpio_values[3] = 1;
-	selftest_trigger_tick();  /* rising edge detected, press_count=1, single_press_pending=true */
-
-	mock_gpio_values[3] = 0;
-	/* Advance time by 500ms (1 tick) */
-	mock_uptime_ms = 3000500;
-	selftest_trigger_tick();  /* button released, <1.5s, still pending */
+	/* Simulate single button press: pressed, released 500ms later */
+	button_edge(1, 3000000);  /* press_count=1, single_press_pending=true */
+	button_edge(0, 3000500);  /* button released, <1.5s, still pending */
 	assert(charge_now_is_active() == false);
 
 	/* Advance to 1.5s after press */
@@ -2224,13 +2606,8 @@ static void test_five_presses_trigger_selftest_not_charge_now(void)
 
 	/* 5 rapid presses within 5s */
 	for (int i = 0; i < 5; i++) {
-		mock_gpio_values[3] = 1;
-		mock_uptime_ms = 3000000 + (i * 600);
-		selftest_trigger_tick();
-
-		mock_gpio_values[3] = 0;
-		mock_uptime_ms = 3000000 + (i * 600) + 200;
-		selftest_trigger_tick();
+		button_edge(1, 3000000 + (i * 600));
+		button_edge(0, 3000000 + (i * 600) + 200);
 	}
 
 	/* Self-test should be running, not Charge Now */
@@ -2247,9 +2624,7 @@ static void test_long_press_cancels_charge_now(void)
 	assert(charge_now_is_active() == true);
 
 	/* Simulate long press: button held for 3s */
-	mock_gpio_values[3] = 1;
-	mock_uptime_ms = 3100000;
-	selftest_trigger_tick();  /* rising edge */
+	button_edge(1, 3100000);
 
 	/* Hold for 3 seconds */
 	mock_uptime_ms = 3103000;
@@ -2263,9 +2638,7 @@ static void test_long_press_without_charge_now_is_noop(void)
 	assert(charge_now_is_active() == false);
 
 	/* Long press when charge_now is not active — should not crash */
-	mock_gpio_values[3] = 1;
-	mock_uptime_ms = 3100000;
-	selftest_trigger_tick();
+	button_edge(1, 3100000);
 
 	mock_uptime_ms = 3103000;
 	selftest_trigger_tick();
@@ -2277,27 +2650,51 @@ static void test_two_presses_no_charge_now(void)
 	init_button_test();
 
 	/* Two presses: should NOT activate charge now */
-	mock_gpio_values[3] = 1;
-	mock_uptime_ms = 3000000;
+	button_edge(1, 3000000);
+	button_edge(0, 3000200);
+	button_edge(1, 3000600);
+	button_edge(0, 3000800);
+
+	/* Wait past single-press timeout */
+	mock_uptime_ms = 3002500;
 	selftest_trigger_tick();
 
-	mock_gpio_values[3] = 0;
-	mock_uptime_ms = 3000200;
+	assert(charge_now_is_active() == false);
+}
+
+static void test_press_between_ticks_activates_charge_now(void)
+{
+	init_button_test();
+
+	/* A 150ms tap with no tick in between: polling every 500ms could
+	 * miss it entirely */
+	mock_uptime_ms = 3000100;
+	assert(mock_gpio_edge(&app_cb, 3, 1, 3000100) == 1);
+	mock_uptime_ms = 3000250;
+	assert(mock_gpio_edge(&app_cb, 3, 0, 3000250) == 1);
+
+	mock_uptime_ms = 3001600;
 	selftest_trigger_tick();
+	assert(charge_now_is_active() == true);
+}
 
+static void test_button_polled_before_edge_api(void)
+{
+	init_button_test();
+	platform = polled_platform();
+	selftest_trigger_init();
+
+	/* Pressed for one tick, released */
 	mock_gpio_values[3] = 1;
-	mock_uptime_ms = 3000600;
 	selftest_trigger_tick();
-
 	mock_gpio_values[3] = 0;
-	mock_uptime_ms = 3000800;
+	mock_uptime_ms = 3000500;
 	selftest_trigger_tick();
+	assert(charge_now_is_active() == false);
 
-	/* Wait past single-press timeout */
-	mock_uptime_ms = 3002500;
+	mock_uptime_ms = 3001500;
 	selftest_trigger_tick();
-
-	assert(charge_now_is_active() == false);
+	assert(charge_now_is_active() == true);
 }
 
 /* ================================================================== */
@@ -2870,15 +3267,14 @@ static void drain_test_init(uint32_t uptime)
 
 	app_cb.init(mock_platform_api_get());
 	app_cb.on_ready(true);
+	pilot_tuning_defaults(false);
 }
 
-/** Advance uptime and pump 5 timer ticks (= one sensor cycle) */
+/** Advance uptime and fire the timer (one sensor cycle if 500ms passed) */
 static void drain_pump(uint32_t uptime)
 {
 	mock_uptime_ms = uptime;
-	for (int i = 0; i < 5; i++) {
-		app_cb.on_timer();
-	}
+	app_cb.on_timer();
 }
 
 static void test_drain_sends_buffered_events(void)
@@ -2886,9 +3282,8 @@ static void test_drain_sends_buffered_events(void)
 	drain_test_init(0);
 
 	/* Trigger a state change to generate a live send + buffer entry */
-	mock_uptime_ms = 100;
 	mock_adc_values[0] = 5980;  /* State B */
-	drain_pump(100);
+	drain_pump(500);
 	int sends_after_change = mock_send_count;
 	assert(sends_after_change >= 1);
 
@@ -2898,11 +3293,16 @@ static void test_drain_sends_buffered_events(void)
 	int sends_after_second = mock_send_count;
 	assert(sends_after_second > sends_after_change);
 
-	/* Now in idle state with buffered events. Pump at 5s intervals
-	 * to let drain happen (rate limit = 5s). */
-	int prev_count = mock_send_count;
-	drain_pump(12000);  /* 6s after last send */
-	assert(mock_send_count > prev_count);
+	/* Idle ticks drain the buffered events (rate limit = 5s). Both fit
+	 * in one batched v0x0B frame. */
+	drain_pump(12000);
+	int batched = 0;
+	for (int i = 0; i < mock_send_count; i++) {
+		if (mock_sends[i].data[1] == 0x0B) {
+			batched += mock_sends[i].data[2];
+		}
+	}
+	assert(batched == event_buffer_count());
 }
 
 static void test_drain_respects_rate_limit(void)
@@ -2911,7 +3311,7 @@ static void test_drain_respects_rate_limit(void)
 
 	/* Generate buffered events: two state changes */
 	mock_adc_values[0] = 5980;  /* State B */
-	drain_pump(100);
+	drain_pump(500);
 
 	mock_adc_values[0] = 2980;  /* Back to A */
 	drain_pump(6000);
@@ -2932,7 +3332,7 @@ static void test_drain_cursor_resets_on_trim(void)
 
 	/* Generate events */
 	mock_adc_values[0] = 5980;
-	drain_pump(100);
+	drain_pump(500);
 	mock_adc_values[0] = 2980;
 	drain_pump(6000);
 
@@ -2952,6 +3352,586 @@ static void test_drain_cursor_resets_on_trim(void)
 	assert(mock_send_count >= sends_before_trim);
 }
 
+/** Timestamp of entry i in a v0x0B batch frame */
+static uint32_t batch_timestamp(int idx, int entry)
+{
+	const uint8_t *d = mock_sends[idx].data;
+	assert(d[0] == 0xE5 && d[1] == 0x0B);
+	assert(entry < d[2]);
+	uint32_t base = d[3] | (d[4] << 8) | (d[5] << 16) | ((uint32_t)d[6] << 24);
+	size_t pos = 7;
+	for (int i = 0; i < entry; i++) {
+		pos += (d[pos + 2] & 0x08) ? 5 : 4;
+	}
+	return base + (d[pos] | (d[pos + 1] << 8));
+}
+
+static void test_drain_no_resend_after_partial_trim(void)
+{
+	drain_test_init(0);
+	uint8_t ts_cmd[] = {0x30, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+	app_cb.on_msg_received(ts_cmd, sizeof(ts_cmd));
+
+	/* Five live state changes -> five buffered entries (two LoRa batches) */
+	static const int adc[] = {2234, 2980, 2234, 2980, 2234};  /* B A B A B */
+	for (int i = 0; i < 5; i++) {
+		mock_adc_values[0] = adc[i];
+		drain_pump(500 + i * 6000);
+	}
+	assert(event_buffer_count() >= 5);
+
+	struct event_snapshot e0, e3;
+	assert(event_buffer_peek_at(0, &e0));
+	assert(event_buffer_peek_at(3, &e3));
+
+	/* First batch carries e0..e2 */
+	drain_pump(30000);
+	int first = mock_send_count - 1;
+	assert(mock_sends[first].data[2] == 3);
+	assert(batch_timestamp(first, 0) == e0.timestamp);
+
+	/* ACK covers only e0 — drain continues at e3, no re-send of e1/e2 */
+	event_buffer_trim(e0.timestamp);
+	drain_pump(36000);
+	assert(mock_send_count == first + 2);
+	assert(batch_timestamp(mock_send_count - 1, 0) == e3.timestamp);
+}
+
+static void test_flapping_transitions_go_out_live(void)
+{
+	drain_test_init(0);
+
+	/* Vehicle flaps B/C/B/C one sensor cycle apart */
+	static const int adc[] = {2234, 1489, 2234, 1489};
+	static const uint8_t state[] = {J1772_STATE_B, J1772_STATE_C,
+					J1772_STATE_B, J1772_STATE_C};
+	for (int i = 0; i < 4; i++) {
+		mock_adc_values[0] = adc[i];
+		drain_pump(1000 + i * 500);
+	}
+
+	/* Let the queue flush through idle cycles */
+	for (uint32_t t = 3000; t <= 20000; t += 500) {
+		drain_pump(t);
+	}
+
+	/* Every transition went out as its own v0x0A uplink, in order,
+	 * before any drain frame */
+	int live = 0;
+	for (int i = 0; i < mock_send_count && live < 4; i++) {
+		if (mock_sends[i].data[1] != 0x0A) {
+			break;
+		}
+		assert(mock_sends[i].data[2] == state[live]);
+		live++;
+	}
+	assert(live == 4);
+	assert(app_tx_queue_depth() == 0);
+}
+
+/* Lossy-link drain: every confirmed v0x0B entry, counted by timestamp */
+#define LOSSY_BACKLOG  40
+#define LOSSY_BASE_TS  0x00200000
+static int lossy_confirmed[LOSSY_BACKLOG];
+static int lossy_frames;
+
+static void lossy_record(const uint8_t *d, size_t len)
+{
+	if (len < 7 || d[0] != 0xE5 || d[1] != 0x0B) {
+		return;  /* live uplink */
+	}
+	lossy_frames++;
+	uint32_t base = d[3] | (d[4] << 8) | (d[5] << 16) | ((uint32_t)d[6] << 24);
+	size_t pos = 7;
+	for (int i = 0; i < d[2]; i++) {
+		uint32_t ts = base + (d[pos] | (d[pos + 1] << 8));
+		if (ts >= LOSSY_BASE_TS) {
+			int idx = (int)(ts - LOSSY_BASE_TS) / 10;
+			assert(idx < LOSSY_BACKLOG);
+			lossy_confirmed[idx]++;
+		}
+		pos += (d[pos + 2] & 0x08) ? 5 : 4;
+	}
+}
+
+static void test_drain_lossy_link_delivers_each_entry_once(void)
+{
+	drain_test_init(0);
+	memset(lossy_confirmed, 0, sizeof(lossy_confirmed));
+	lossy_frames = 0;
+
+	/* Live change turns the drain on; its own entry is not counted */
+	mock_adc_values[0] = 2234;
+	drain_pump(500);
+	mock_deliver_sends(&app_cb, 0, NULL);
+
+	for (int i = 0; i < LOSSY_BACKLOG; i++) {
+		struct event_snapshot s = {
+			.timestamp = LOSSY_BASE_TS + i * 10,
+			.j1772_state = (uint8_t)(i % 3),
+			.transition_reason = (i % 7 == 0) ? 1 : 0,
+		};
+		event_buffer_add(&s);
+	}
+
+	/* 30% of frames fail; the radio reports after every sensor cycle */
+	int errors_seen = 0;
+	uint32_t t = 6000;
+	for (int cycle = 0; cycle < 600; cycle++, t += 6000) {
+		drain_pump(t);
+		int pending = mock_pending_count;
+		errors_seen += pending - mock_deliver_sends(&app_cb, 30, lossy_record);
+
+		int done = 0;
+		for (int i = 0; i < LOSSY_BACKLOG; i++) {
+			done += (lossy_confirmed[i] > 0);
+		}
+		if (done == LOSSY_BACKLOG && drain_inflight_count() == 0) {
+			break;
+		}
+	}
+
+	/* No loss and no duplicate delivery despite the failures */
+	assert(errors_seen > 0);
+	assert(drain_inflight_retries() > 0);
+	for (int i = 0; i < LOSSY_BACKLOG; i++) {
+		assert(lossy_confirmed[i] == 1);
+	}
+	assert(drain_inflight_count() == 0);
+	assert(lossy_frames >= LOSSY_BACKLOG / APP_TX_BATCH_MAX);
+}
+
+static int pending_batches(void)
+{
+	int n = 0;
+	for (int i = 0; i < mock_pending_count; i++) {
+		n += (mock_pending[i].data[1] == 0x0B);
+	}
+	mock_pending_count = 0;
+	return n;
+}
+
+static void test_drain_timeout_retries_unconfirmed_frame(void)
+{
+	drain_test_init(0);
+	mock_adc_values[0] = 2234;
+	drain_pump(500);
+	mock_deliver_sends(&app_cb, 0, NULL);
+
+	struct event_snapshot s = { .timestamp = LOSSY_BASE_TS };
+	event_buffer_add(&s);
+	drain_pump(6000);
+	assert(pending_batches() == 1);
+	assert(drain_inflight_count() == 1);
+	/* ...and the radio never reports back */
+
+	/* Still waiting just before the confirm timeout */
+	drain_pump(6000 + DRAIN_CONFIRM_TIMEOUT_MS - 1000);
+	drain_pump(6000 + DRAIN_CONFIRM_TIMEOUT_MS - 500);
+	assert(pending_batches() == 0);
+
+	/* Timed out: counts as a failure, retried after the first backoff */
+	uint32_t t = 6000 + DRAIN_CONFIRM_TIMEOUT_MS + 1000;
+	drain_pump(t);
+	assert(pending_batches() == 0);
+	drain_pump(t + DRAIN_RETRY_BASE_MS);
+	assert(pending_batches() == 1);
+	assert(drain_inflight_retries() == 1);
+}
+
+static void test_drain_untracked_before_msg_ids(void)
+{
+	drain_test_init(0);
+	struct platform_api old = *mock_platform_api_get();
+	old.version = PLATFORM_API_VERSION_MSG_ID - 1;
+	app_cb.init(&old);
+	app_cb.on_ready(true);
+	mock_adc_values[0] = 2234;
+	drain_pump(500);
+	mock_deliver_sends(&app_cb, 0, NULL);
+
+	/* The mock still returns ids; an older platform's value means nothing */
+	struct event_snapshot s = { .timestamp = LOSSY_BASE_TS };
+	event_buffer_add(&s);
+	drain_pump(6000);
+	assert(pending_batches() == 1);
+	assert(drain_inflight_count() == 0);
+
+	/* Counted as delivered on send: never retried */
+	mock_pending_count = 0;
+	drain_pump(6000 + DRAIN_CONFIRM_TIMEOUT_MS + DRAIN_RETRY_BASE_MS + 1000);
+	assert(pending_batches() == 0);
+	assert(drain_inflight_retries() == 0);
+	app_cb.init(mock_platform_api_get());
+}
+
+static void test_event_log_persist_and_restore(void)
+{
+	drain_test_init(0);
+	uint8_t ts_cmd[] = {0x30, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+	app_cb.on_msg_received(ts_cmd, sizeof(ts_cmd));
+
+	mock_adc_values[0] = 2234;  /* B */
+	drain_pump(500);
+	mock_adc_values[0] = 2980;  /* A */
+	drain_pump(6000);
+	mock_adc_values[0] = 2234;  /* B */
+	drain_pump(12000);
+
+	/* Every buffered snapshot went to the platform log */
+	int n = event_buffer_count();
+	assert(n >= 3);
+	assert(mock_log_count == n);
+
+	struct event_snapshot e0, e1;
+	assert(event_buffer_peek_at(0, &e0));
+	assert(event_buffer_peek_at(1, &e1));
+
+	/* ACK trims the log too */
+	uint8_t ack_cmd[] = {0x30, 0x00, 0x01, 0x00, 0x00, 0, 0, 0, 0};
+	ack_cmd[5] = e0.timestamp & 0xFF;
+	ack_cmd[6] = (e0.timestamp >> 8) & 0xFF;
+	ack_cmd[7] = (e0.timestamp >> 16) & 0xFF;
+	ack_cmd[8] = (e0.timestamp >> 24) & 0xFF;
+	app_cb.on_msg_received(ack_cmd, sizeof(ack_cmd));
+	assert(mock_log_trim_count == 2);
+	assert(mock_log_last_trim == e0.timestamp);
+	assert(mock_log_count == n - 1);
+
+	/* Reset: RAM buffer comes back from the log, oldest un-ACKed first */
+	app_cb.init(mock_platform_api_get());
+	assert(event_buffer_count() == n - 1);
+	struct event_snapshot r0;
+	assert(event_buffer_peek_at(0, &r0));
+	assert(memcmp(&r0, &e1, sizeof(r0)) == 0);
+}
+
+static void test_event_log_absent_on_old_platform(void)
+{
+	drain_test_init(0);
+	struct platform_api old = *mock_platform_api_get();
+	old.version = PLATFORM_API_VERSION_EVENT_LOG - 1;
+	app_cb.init(&old);
+
+	mock_adc_values[0] = 2234;
+	mock_uptime_ms = 500;
+	app_cb.on_timer();
+	assert(event_buffer_count() >= 1);
+	assert(mock_log_append_count == 0);
+	app_cb.init(mock_platform_api_get());
+}
+
+/* ================================================================== */
+/*  Tickless timer: wakeups per simulated day                          */
+/* ================================================================== */
+
+/* Virtual-time day on the mock timer: the app re-arms it for its next
+ * deadline and the radio confirms every uplink within a minute. A fixed
+ * 100ms tick is DAY_MS / 100 = 864000 wakeups. */
+#define DAY_MS  86400000u
+
+static uint32_t wakeups_per_day(const struct platform_api *api, int pilot_mv)
+{
+	drain_test_init(0);
+	app_cb.init(api);
+	mock_adc_values[0] = pilot_mv;
+
+	uint32_t fires = 0;
+	for (uint32_t t = 60000; t <= DAY_MS; t += 60000) {
+		fires += mock_timer_run(&app_cb, t);
+		mock_deliver_sends(&app_cb, 0, NULL);
+	}
+	return fires;
+}
+
+static void test_wakeups_per_day(void)
+{
+	/* No vehicle: the 5s pilot poll plus the idle LED blip */
+	uint32_t idle = wakeups_per_day(stepped_platform(), 2980);
+	assert(idle < DAY_MS / 100 / 20);
+
+	/* LED patterns played by the platform: the 5s pilot poll and one
+	 * wake per minute for the uplink confirmation */
+	uint32_t idle_hw = wakeups_per_day(mock_platform_api_get(), 2980);
+	assert(idle_hw <= DAY_MS / 5000 + DAY_MS / 60000);
+	assert(idle_hw < idle * 3 / 4);
+
+	/* Vehicle plugged in: the 500ms sensor cycle */
+	uint32_t connected = wakeups_per_day(mock_platform_api_get(), 2234);
+	assert(connected >= DAY_MS / 500);
+	assert(connected < DAY_MS / 100 / 4);
+
+	printf("\n    wakeups/day at a fixed 100ms: %u; idle %u (%u with LED patterns), "
+	       "vehicle connected %u  ", DAY_MS / 100, idle, idle_hw, connected);
+	app_cb.init(mock_platform_api_get());
+}
+
+/* ================================================================== */
+/*  ADC cache: CPU-awake time of sensor reads                          */
+/* ================================================================== */
+
+/* Per-operation CPU-awake estimates for the nRF52840 at 64 MHz (not
+ * measured on hardware). A blocking adc_read_dt() takes the ADC lock,
+ * starts the SAADC, waits out the ~12us conversion, then the END
+ * interrupt wakes the thread again: too short to sleep through. A scan
+ * is the driver's interval timer ISR plus the SAADC ISR converting and
+ * publishing the scan. A cached read is a few loads. */
+#define AWAKE_BLOCKING_READ_US  60
+#define AWAKE_SCAN_US           20
+#define AWAKE_CACHED_READ_US    1
+
+/* A burst scan adds, per extra sampling, the interval timer ISR and an
+ * SAADC END interrupt into the driver callback. Reading a burst copies
+ * and sorts 16 samples. */
+#define AWAKE_BURST_SAMPLING_US 4
+#define AWAKE_BURST_READ_US     3
+
+/* Starting a burst: the k_timer ISR, the work item and adc_read_async()
+ * setting up the sequence and enabling the SAADC */
+#define AWAKE_BURST_START_US    15
+
+#define AWAKE_RUN_MS            60000
+#define AWAKE_TICK_MS           100
+
+/* One minute of app ticks on `api`, pilot flipping B <-> C every 10s */
+static void awake_run(const struct platform_api *api)
+{
+	drain_test_init(0);
+	app_cb.init(api);
+	app_cb.on_ready(true);
+	mock_adc_read_count = 0;
+	mock_adc_get_count = 0;
+	mock_adc_burst_count = 0;
+
+	for (uint32_t t = 0; t < AWAKE_RUN_MS; t += AWAKE_TICK_MS) {
+		mock_uptime_ms = t;
+		mock_adc_values[0] = (t / 10000) % 2 ? 1489 : 2234;
+		app_cb.on_timer();
+	}
+}
+
+static void test_adc_cache_cpu_awake_time(void)
+{
+	struct platform_api old = *mock_platform_api_get();
+	old.version = PLATFORM_API_VERSION_ADC_CACHE - 1;
+
+	awake_run(&old);
+	int blocking = mock_adc_read_count;
+	assert(mock_adc_get_count == 0);
+
+	struct platform_api v6 = *mock_platform_api_get();
+	v6.version = PLATFORM_API_VERSION_ADC_CACHE;
+
+	awake_run(&v6);
+	int cached = mock_adc_get_count;
+	assert(mock_adc_read_count == 0);
+	assert(cached == blocking);     /* same reads, now from memory */
+
+	uint32_t scans = AWAKE_RUN_MS / ADC_SAMPLER_PERIOD_MS;
+	uint32_t before_us = (uint32_t)blocking * AWAKE_BLOCKING_READ_US;
+	uint32_t after_us = scans * AWAKE_SCAN_US + (uint32_t)cached * AWAKE_CACHED_READ_US;
+
+	printf("\n    %d reads/min: %u us awake blocking, %u us with %u scans (-%u%%)  ",
+	       blocking, before_us, after_us, scans, 100 - after_us * 100 / before_us);
+	assert(after_us * 2 < before_us);
+
+	app_cb.init(mock_platform_api_get());
+}
+
+/* Oversampling costs CPU time: compared here with taking the same
+ * ADC_SAMPLER_BURST samplings in each blocking read */
+static void test_adc_burst_cpu_awake_time(void)
+{
+	awake_run(mock_platform_api_get());
+	int reads = mock_adc_burst_count;
+	assert(mock_adc_read_count == 0 && mock_adc_get_count == 0);
+
+	uint32_t scans = AWAKE_RUN_MS / ADC_SAMPLER_PERIOD_MS;
+	uint32_t extra_us = (ADC_SAMPLER_BURST - 1) * AWAKE_BURST_SAMPLING_US;
+	uint32_t blocking_us = (uint32_t)reads * (AWAKE_BLOCKING_READ_US + extra_us);
+	uint32_t burst_us = scans * (AWAKE_SCAN_US + extra_us) +
+			    (uint32_t)reads * AWAKE_BURST_READ_US;
+
+	printf("\n    %d reads/min of %d samplings: %u us awake blocking, %u us with bursts (-%u%%)  ",
+	       reads, ADC_SAMPLER_BURST, blocking_us, burst_us,
+	       100 - burst_us * 100 / blocking_us);
+	assert(burst_us < blocking_us);
+
+	app_cb.init(mock_platform_api_get());
+}
+
+/* A burst started per scan against one endless sequence repeating into
+ * alternating buffers. The driver spaces every sampling of a sequence
+ * by the same interval, so the endless one samples at the burst gap all
+ * the time; the burst pays a start per scan and sees a pilot change up
+ * to one period late. */
+static void test_adc_continuous_scan_cost(void)
+{
+	uint32_t scans = AWAKE_RUN_MS / ADC_SAMPLER_PERIOD_MS;
+	uint32_t burst_us = scans * (AWAKE_BURST_START_US + AWAKE_SCAN_US +
+				     (ADC_SAMPLER_BURST - 1) * AWAKE_BURST_SAMPLING_US);
+	uint32_t start_us = scans * AWAKE_BURST_START_US;
+	uint32_t samplings = AWAKE_RUN_MS * 1000u / ADC_SAMPLER_BURST_GAP_US;
+	uint32_t continuous_us = samplings * AWAKE_BURST_SAMPLING_US +
+				 scans * AWAKE_SCAN_US;
+
+	printf("\n    per min: %u us awake with bursts (%u us starting them), "
+	       "%u us continuous; pilot seen up to %u ms late  ",
+	       burst_us, start_us, continuous_us, ADC_SAMPLER_PERIOD_MS);
+	assert(burst_us * 100 < continuous_us);
+}
+
+/* ================================================================== */
+/*  J1772 pilot: trace replay                                          */
+/* ================================================================== */
+
+/* EXP-013 kept only summaries of the field telemetry, so the traces are
+ * rebuilt from them by a seeded generator. Each 500ms scan is a burst
+ * of ADC_SAMPLER_BURST samples ADC_SAMPLER_BURST_GAP_US apart; the
+ * single-sample baseline classifies the first sample of each burst. */
+
+#define REPLAY_SCANS       1200    /* 10 minutes */
+#define REPLAY_PWM_DUTY    530     /* per mille: 32A offered */
+
+enum replay_trace {
+	TRACE_SESSION,      /* A, B, B+PWM, C+PWM, B+PWM, A; 2.2% 0mV dropouts */
+	TRACE_DRIFT,        /* C sagging across the B/C threshold (Feb 18) */
+	TRACE_FLOATING,     /* floating input, 0-1024mV, rare A spikes (Feb 20) */
+};
+
+static const char *const replay_names[] = { "session", "drift", "floating" };
+
+static uint32_t replay_rand;
+
+static uint32_t replay_next(uint32_t range)
+{
+	replay_rand = replay_rand * 1103515245u + 12345u;
+	return (replay_rand >> 8) % range;
+}
+
+/* Level and PWM of the session trace at scan n */
+static int session_level(int n, bool *pwm)
+{
+	*pwm = n >= 180 && n < 1140;
+	if (n < 120 || n >= 1140) {
+		return 2980;
+	}
+	return n < 240 || n >= 1080 ? 2234 : 1489;
+}
+
+static void replay_scan(enum replay_trace t, int n, int16_t *burst)
+{
+	replay_rand = 0x5EED0000u ^ ((uint32_t)t << 24) ^ ((uint32_t)n * 2654435761u);
+	uint32_t phase_us = replay_next(1000);
+
+	for (int s = 0; s < ADC_SAMPLER_BURST; s++) {
+		int mv;
+
+		if (t == TRACE_SESSION) {
+			bool pwm;
+			int level = session_level(n, &pwm);
+			uint32_t at = (phase_us + (uint32_t)s * ADC_SAMPLER_BURST_GAP_US) % 1000;
+
+			mv = pwm && at >= REPLAY_PWM_DUTY ? 0 : level + (int)replay_next(61) - 30;
+			if (replay_next(1000) < 22) {
+				mv = 0;
+			}
+		} else if (t == TRACE_DRIFT) {
+			int tri = n % 240 < 120 ? n % 240 : 240 - n % 240;
+
+			mv = 1950 - (tri * 200) / 120 + (int)replay_next(61) - 30;
+		} else {
+			mv = replay_next(2) ? (int)replay_next(21) : (int)replay_next(1025);
+			if (s == 0 && replay_next(100) < 3) {
+				mv = 2700 + (int)replay_next(570);
+			}
+		}
+		burst[s] = (int16_t)(mv > 0 ? mv : 0);
+	}
+}
+
+struct replay_result {
+	uint32_t transitions;
+	int uplinks;
+};
+
+static struct replay_result replay(enum replay_trace t, const struct platform_api *api,
+				   const struct evse_pilot_config *cfg)
+{
+	int16_t burst[ADC_SAMPLER_BURST];
+
+	replay_scan(t, 0, burst);
+	drain_test_init(0);
+	memcpy(mock_adc_burst, burst, sizeof(burst));
+	mock_adc_burst_len = ADC_SAMPLER_BURST;
+	mock_adc_values[0] = burst[0];
+	mock_adc_scan_ms = ADC_SAMPLER_PERIOD_MS;
+	assert(evse_pilot_config_set(cfg) == 0);
+	app_cb.init(api);
+	app_cb.on_ready(true);
+	mock_send_count = 0;
+
+	for (uint32_t tick = 1; tick < REPLAY_SCANS * 5; tick++) {
+		mock_uptime_ms = tick * 100;
+		if (mock_uptime_ms % ADC_SAMPLER_PERIOD_MS == 0) {
+			replay_scan(t, (int)(mock_uptime_ms / ADC_SAMPLER_PERIOD_MS), burst);
+			memcpy(mock_adc_burst, burst, sizeof(burst));
+			mock_adc_values[0] = burst[0];
+		}
+		app_cb.on_timer();
+		mock_deliver_sends(&app_cb, 0, NULL);
+	}
+
+	struct evse_pilot_stats st;
+	evse_pilot_stats_get(&st);
+	return (struct replay_result){ st.transitions, mock_send_count };
+}
+
+static void test_pilot_trace_replay(void)
+{
+	/* Before: one conversion per scan, bare threshold ladder */
+	struct platform_api single = *mock_platform_api_get();
+	single.version = PLATFORM_API_VERSION_ADC_CACHE;
+	struct evse_pilot_config ladder, tuned;
+	evse_pilot_config_defaults(&tuned);
+	ladder = tuned;
+	ladder.hysteresis_mv = 0;
+	ladder.debounce = 1;
+
+	struct replay_result before[3], after[3];
+	uint32_t before_t = 0, after_t = 0;
+	int before_up = 0, after_up = 0;
+
+	printf("\n");
+	for (int t = TRACE_SESSION; t <= TRACE_FLOATING; t++) {
+		before[t] = replay((enum replay_trace)t, &single, &ladder);
+		after[t] = replay((enum replay_trace)t, mock_platform_api_get(), &tuned);
+		printf("    %-8s %4u -> %u transitions, %3d -> %d uplinks\n",
+		       replay_names[t], before[t].transitions, after[t].transitions,
+		       before[t].uplinks, after[t].uplinks);
+		before_t += before[t].transitions;
+		after_t += after[t].transitions;
+		before_up += before[t].uplinks;
+		after_up += after[t].uplinks;
+	}
+	printf("    total    %4u -> %u transitions (-%u%%), %3d -> %d uplinks (-%d%%)  ",
+	       before_t, after_t, (before_t - after_t) * 100 / before_t,
+	       before_up, after_up, (before_up - after_up) * 100 / before_up);
+
+	/* The session's four real changes, and only those */
+	assert(after[TRACE_SESSION].transitions == 4);
+	assert(after[TRACE_DRIFT].transitions == 0);
+	assert(after[TRACE_FLOATING].transitions * 10 < before[TRACE_FLOATING].transitions);
+	for (int t = TRACE_SESSION; t <= TRACE_FLOATING; t++) {
+		assert(after[t].uplinks < before[t].uplinks);
+	}
+
+	mock_adc_scan_ms = 0;
+	mock_adc_burst_len = 0;
+	pilot_tuning_defaults(true);
+	app_cb.init(mock_platform_api_get());
+}
+
 /* ================================================================== */
 /*  cmd_auth: HMAC-SHA256 command authentication                       */
 /* ================================================================== */
@@ -2977,6 +3957,14 @@ static const uint8_t tag_delay_window[] = {
 	0xe3, 0xae, 0x1f, 0xa5, 0x15, 0x66, 0x47, 0x08
 };
 
+static const uint8_t tag_pilot_config[] = {
+	0xf0, 0x27, 0x06, 0x17, 0x0e, 0xa0, 0x79, 0x9f
+};
+
+static const uint8_t tag_pilot_reset[] = {
+	0xd2, 0x1c, 0x5c, 0xb4, 0x1b, 0xf1, 0xc0, 0x41
+};
+
 static void cmd_auth_test_setup(void)
 {
 	mock_platform_api_reset();
@@ -3133,11 +4121,55 @@ static void test_rx_auth_unsigned_delay_window_rejected(void)
 	assert(mock_log_err_count > 0);
 }
 
+/* 2650/1850/1100/300 mV, 200 mV band, 4 reads, trimmed mean */
+static const uint8_t pilot_config_payload[PILOT_CONFIG_PAYLOAD_SIZE] = {
+	0x50, 0x5a, 0x0a, 0x3a, 0x07, 0x4c, 0x04, 0x2c, 0x01, 0x14, 0x14
+};
+
+static void test_rx_auth_signed_pilot_config_accepted(void)
+{
+	cmd_auth_test_setup();
+	pilot_tuning_defaults(true);
+
+	uint8_t msg[PILOT_CONFIG_PAYLOAD_SIZE + CMD_AUTH_TAG_SIZE];
+	memcpy(msg, pilot_config_payload, PILOT_CONFIG_PAYLOAD_SIZE);
+	memcpy(msg + PILOT_CONFIG_PAYLOAD_SIZE, tag_pilot_config, CMD_AUTH_TAG_SIZE);
+	app_rx_process_msg(msg, sizeof(msg));
+
+	struct evse_pilot_config cfg;
+	evse_pilot_config_get(&cfg);
+	assert(cfg.threshold_mv[0] == 2650 && cfg.threshold_mv[3] == 300);
+	assert(cfg.hysteresis_mv == 200);
+	assert(cfg.debounce == 4);
+	assert(cfg.filter == EVSE_PILOT_FILTER_TRIMMED_MEAN);
+
+	/* Signed bare 0x50 restores the defaults */
+	uint8_t reset[1 + CMD_AUTH_TAG_SIZE] = {0x50};
+	memcpy(reset + 1, tag_pilot_reset, CMD_AUTH_TAG_SIZE);
+	app_rx_process_msg(reset, sizeof(reset));
+	evse_pilot_config_get(&cfg);
+	assert(cfg.hysteresis_mv == 150 && cfg.debounce == 3);
+}
+
+static void test_rx_auth_unsigned_pilot_config_rejected(void)
+{
+	cmd_auth_test_setup();
+	pilot_tuning_defaults(true);
+
+	app_rx_process_msg(pilot_config_payload, sizeof(pilot_config_payload));
+
+	struct evse_pilot_config cfg;
+	evse_pilot_config_get(&cfg);
+	assert(cfg.hysteresis_mv == 150);
+	assert(mock_log_err_count > 0);
+}
+
 static void test_rx_auth_mtu_fits(void)
 {
 	/* Verify signed payloads fit in 19-byte LoRa MTU */
 	assert(4 + CMD_AUTH_TAG_SIZE <= 19);   /* legacy charge control */
 	assert(10 + CMD_AUTH_TAG_SIZE <= 19);  /* delay window */
+	assert(PILOT_CONFIG_PAYLOAD_SIZE + CMD_AUTH_TAG_SIZE <= 19);
 }
 
 /* ================================================================== */
@@ -3186,6 +4218,9 @@ int main(void)
 	RUN_TEST(test_on_timer_j1772_change_triggers_send);
 	RUN_TEST(test_on_timer_current_change_no_send_stubbed);
 	RUN_TEST(test_on_timer_thermostat_change_triggers_send);
+	RUN_TEST(test_thermostat_edge_burst_sends_once);
+	RUN_TEST(test_on_timer_thermostat_polled_before_edge_api);
+	RUN_TEST(test_thermostat_edge_snapshot_time);
 	RUN_TEST(test_on_timer_heartbeat_sends_after_60s);
 	RUN_TEST(test_on_timer_no_heartbeat_before_60s);
 	RUN_TEST(test_on_timer_multiple_changes_one_send);
@@ -3235,6 +4270,7 @@ int main(void)
 	RUN_TEST(test_diag_state_flags_selftest_fail);
 	RUN_TEST(test_diag_state_flags_time_synced);
 	RUN_TEST(test_diag_event_buffer_pending);
+	RUN_TEST(test_diag_airtime_budget_remaining);
 	RUN_TEST(test_diag_process_cmd_sends_response);
 	RUN_TEST(test_diag_process_cmd_wrong_type);
 	RUN_TEST(test_diag_process_cmd_null_data);
@@ -3275,9 +4311,18 @@ int main(void)
 	RUN_TEST(test_led_button_ack_3_blinks);
 	RUN_TEST(test_led_button_ack_blocked_by_error);
 
-	printf("\nled_engine timer:\n");
+	printf("\nsensor cycle and LED ticks:\n");
 	RUN_TEST(test_led_timer_interval_100);
-	RUN_TEST(test_led_decimation_sensors_every_5th);
+	RUN_TEST(test_sensor_cycle_every_500ms);
+	RUN_TEST(test_led_next_ms_idle_blip);
+	RUN_TEST(test_led_next_ms_solid_and_ack);
+	RUN_TEST(test_timer_rearmed_for_next_deadline);
+	RUN_TEST(test_timer_wakes_do_not_postpone);
+
+	printf("\nled_engine patterns on the platform:\n");
+	RUN_TEST(test_led_pattern_uploaded_on_priority_change);
+	RUN_TEST(test_led_pattern_ack_one_shot);
+	RUN_TEST(test_led_pattern_failure_steps_in_software);
 
 	printf("\ndelay_window:\n");
 	RUN_TEST(test_delay_window_no_window_not_paused);
@@ -3313,6 +4358,7 @@ int main(void)
 	RUN_TEST(test_charge_now_cloud_pause_ignored);
 	RUN_TEST(test_charge_now_delay_window_ignored);
 	RUN_TEST(test_charge_now_expires_after_30min);
+	RUN_TEST(test_charge_now_next_ms_counts_down);
 	RUN_TEST(test_charge_now_unplug_cancels);
 	RUN_TEST(test_charge_now_state_b_does_not_cancel);
 	RUN_TEST(test_charge_now_cancel_when_not_active_is_noop);
@@ -3324,6 +4370,8 @@ int main(void)
 	RUN_TEST(test_long_press_cancels_charge_now);
 	RUN_TEST(test_long_press_without_charge_now_is_noop);
 	RUN_TEST(test_two_presses_no_charge_now);
+	RUN_TEST(test_press_between_ticks_activates_charge_now);
+	RUN_TEST(test_button_polled_before_edge_api);
 
 	printf("\nevent_filter:\n");
 	RUN_TEST(test_event_filter_no_write_when_unchanged);
@@ -3364,6 +4412,22 @@ int main(void)
 	RUN_TEST(test_drain_sends_buffered_events);
 	RUN_TEST(test_drain_respects_rate_limit);
 	RUN_TEST(test_drain_cursor_resets_on_trim);
+	RUN_TEST(test_drain_no_resend_after_partial_trim);
+	RUN_TEST(test_flapping_transitions_go_out_live);
+	RUN_TEST(test_drain_lossy_link_delivers_each_entry_once);
+	RUN_TEST(test_drain_timeout_retries_unconfirmed_frame);
+	RUN_TEST(test_drain_untracked_before_msg_ids);
+	RUN_TEST(test_event_log_persist_and_restore);
+	RUN_TEST(test_event_log_absent_on_old_platform);
+
+	printf("\ntickless timer:\n");
+	RUN_TEST(test_wakeups_per_day);
+
+	printf("\nADC cache:\n");
+	RUN_TEST(test_adc_cache_cpu_awake_time);
+	RUN_TEST(test_adc_burst_cpu_awake_time);
+	RUN_TEST(test_adc_continuous_scan_cost);
+	RUN_TEST(test_pilot_trace_replay);
 
 	printf("\ncmd_auth HMAC:\n");
 	RUN_TEST(test_cmd_auth_set_key_ok);
@@ -3381,6 +4445,8 @@ int main(void)
 	RUN_TEST(test_rx_auth_bad_tag_legacy_rejected);
 	RUN_TEST(test_rx_auth_signed_delay_window_accepted);
 	RUN_TEST(test_rx_auth_unsigned_delay_window_rejected);
+	RUN_TEST(test_rx_auth_signed_pilot_config_accepted);
+	RUN_TEST(test_rx_auth_unsigned_pilot_config_rejected);
 	RUN_TEST(test_rx_auth_mtu_fits);
 
 	printf("\n=== %d/%d tests passed ===\n\n", tests_passed, tests_run);
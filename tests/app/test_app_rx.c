@@ -7,11 +7,17 @@
 #include "app_platform.h"
 #include "app_rx.h"
 #include "charge_control.h"
+#include "evse_sensors.h"
+#include "pilot_config.h"
 
 void setUp(void)
 {
+	struct evse_pilot_config cfg;
+
 	platform = mock_platform_api_init();
 	charge_control_init();
+	evse_pilot_config_defaults(&cfg);
+	evse_pilot_config_set(&cfg);
 }
 
 void tearDown(void) {}
@@ -53,6 +59,56 @@ void test_unknown_cmd_type_logged(void)
 	TEST_ASSERT_GREATER_THAN(0, mock_log_wrn_count);
 }
 
+/* --- Pilot config dispatch (0x50, no auth key) --- */
+
+void test_pilot_config_applied(void)
+{
+	/* 2700/1900/1150/400 mV, 100 mV band, 5 reads, median */
+	uint8_t cmd[] = {0x50, 0x8c, 0x0a, 0x6c, 0x07, 0x7e, 0x04, 0x90, 0x01, 10, 0x05};
+	app_rx_process_msg(cmd, sizeof(cmd));
+
+	struct evse_pilot_config cfg;
+	evse_pilot_config_get(&cfg);
+	TEST_ASSERT_EQUAL_UINT16(2700, cfg.threshold_mv[0]);
+	TEST_ASSERT_EQUAL_UINT16(1900, cfg.threshold_mv[1]);
+	TEST_ASSERT_EQUAL_UINT16(1150, cfg.threshold_mv[2]);
+	TEST_ASSERT_EQUAL_UINT16(400, cfg.threshold_mv[3]);
+	TEST_ASSERT_EQUAL_UINT16(100, cfg.hysteresis_mv);
+	TEST_ASSERT_EQUAL_UINT8(5, cfg.debounce);
+	TEST_ASSERT_EQUAL_UINT8(EVSE_PILOT_FILTER_MEDIAN, cfg.filter);
+}
+
+void test_pilot_config_reset(void)
+{
+	uint8_t cmd[] = {0x50, 0x8c, 0x0a, 0x6c, 0x07, 0x7e, 0x04, 0x90, 0x01, 10, 0x05};
+	app_rx_process_msg(cmd, sizeof(cmd));
+	uint8_t reset[] = {0x50};
+	app_rx_process_msg(reset, sizeof(reset));
+
+	struct evse_pilot_config cfg, def;
+	evse_pilot_config_get(&cfg);
+	evse_pilot_config_defaults(&def);
+	TEST_ASSERT_EQUAL_MEMORY(&def, &cfg, sizeof(cfg));
+}
+
+void test_pilot_config_invalid_rejected(void)
+{
+	/* B/C above A/B */
+	uint8_t cmd[] = {0x50, 0x8c, 0x0a, 0x00, 0x0b, 0x7e, 0x04, 0x90, 0x01, 10, 0x05};
+	app_rx_process_msg(cmd, sizeof(cmd));
+	/* Debounce 0 */
+	uint8_t cmd2[] = {0x50, 0x8c, 0x0a, 0x6c, 0x07, 0x7e, 0x04, 0x90, 0x01, 10, 0x00};
+	app_rx_process_msg(cmd2, sizeof(cmd2));
+	/* Truncated */
+	app_rx_process_msg(cmd, 6);
+
+	struct evse_pilot_config cfg;
+	evse_pilot_config_get(&cfg);
+	TEST_ASSERT_EQUAL_UINT16(2600, cfg.threshold_mv[0]);
+	TEST_ASSERT_EQUAL_UINT8(3, cfg.debounce);
+	TEST_ASSERT_GREATER_OR_EQUAL_INT(3, mock_log_err_count);
+}
+
 /* --- Safety: NULL/zero inputs --- */
 
 void test_null_data_safe(void)
@@ -90,6 +146,9 @@ int main(void)
 	RUN_TEST(test_charge_allow);
 	RUN_TEST(test_charge_pause);
 	RUN_TEST(test_unknown_cmd_type_logged);
+	RUN_TEST(test_pilot_config_applied);
+	RUN_TEST(test_pilot_config_reset);
+	RUN_TEST(test_pilot_config_invalid_rejected);
 	RUN_TEST(test_null_data_safe);
 	RUN_TEST(test_zero_length_safe);
 	RUN_TEST(test_short_charge_cmd_ignored);
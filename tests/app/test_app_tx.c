@@ -1,5 +1,6 @@
 /*
- * Unit tests for app_tx.c — v0x0A payload formatting and rate-limited sending
+ * Unit tests for app_tx.c — v0x0A payload formatting, v0x0B batched drain
+ * frames, and the rate-limited live uplink queue
  */
 
 #include "unity.h"
@@ -11,6 +12,8 @@
 #include "charge_control.h"
 #include "time_sync.h"
 #include "evse_payload.h"
+#include "event_buffer.h"
+#include <stdio.h>
 
 void setUp(void)
 {
@@ -61,12 +64,13 @@ void test_rate_limit_blocks(void)
 {
 	mock_uptime_ms = 1000;
 	app_tx_send_evse_data();
-	TEST_ASSERT_EQUAL_INT(1, mock_send_count);
+	app_tx_send_evse_data();
+	TEST_ASSERT_EQUAL_INT(2, mock_send_count);
 
-	/* Within 5s, should be rate-limited */
+	/* Burst budget spent: within 5s, further sends are held back */
 	mock_uptime_ms = 4000;
 	app_tx_send_evse_data();
-	TEST_ASSERT_EQUAL_INT(1, mock_send_count);
+	TEST_ASSERT_EQUAL_INT(2, mock_send_count);
 }
 
 void test_rate_limit_allows_after_interval(void)
@@ -81,6 +85,213 @@ void test_rate_limit_allows_after_interval(void)
 	TEST_ASSERT_EQUAL_INT(2, mock_send_count);
 }
 
+void test_wait_ms_until_budget_allows(void)
+{
+	mock_uptime_ms = 1000;
+	TEST_ASSERT_EQUAL_UINT32(0, app_tx_wait_ms(false));
+	app_tx_send_evse_data();
+	app_tx_send_evse_data();
+
+	/* The next live uplink in 5s of refill, a drain frame in 10s */
+	mock_uptime_ms = 2000;
+	TEST_ASSERT_EQUAL_UINT32(4000, app_tx_wait_ms(false));
+	TEST_ASSERT_EQUAL_UINT32(9000, app_tx_wait_ms(true));
+
+	mock_sidewalk_ready = false;
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, app_tx_wait_ms(false));
+}
+
+/* --- Live uplink queue --- */
+
+static void set_state(uint32_t now, int state)
+{
+	mock_uptime_ms = now;
+	evse_sensors_simulate_state(state, 600000);
+}
+
+/* Advance in 500 ms poll cycles, flushing the queue like app_on_timer */
+static void run_until(uint32_t end)
+{
+	while (mock_uptime_ms < end) {
+		mock_uptime_ms += 500;
+		app_tx_flush();
+	}
+}
+
+void test_flapping_vehicle_every_transition_sent_in_order(void)
+{
+	/* B/C flapping every second: B C B C B */
+	static const int states[] = {
+		J1772_STATE_B, J1772_STATE_C, J1772_STATE_B, J1772_STATE_C, J1772_STATE_B,
+	};
+	for (int i = 0; i < 5; i++) {
+		set_state(1000 + i * 1000, states[i]);
+		TEST_ASSERT_EQUAL_INT(0, app_tx_send_evse_data());
+	}
+	/* Two went out live (burst), the rest wait for budget */
+	TEST_ASSERT_EQUAL_INT(2, mock_send_count);
+	TEST_ASSERT_EQUAL_UINT8(3, app_tx_queue_depth());
+
+	run_until(20000);
+	TEST_ASSERT_EQUAL_INT(5, mock_send_count);
+	for (int i = 0; i < 5; i++) {
+		TEST_ASSERT_EQUAL_UINT8(states[i], mock_sends[i].data[2]);
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, app_tx_queue_dropped());
+}
+
+void test_flapping_latency_beats_drain(void)
+{
+	/* Old behaviour: the 2nd transition waited for the drain path, at
+	 * best one idle cycle after the 5s window. Now it goes out at once
+	 * and the 3rd within one refill interval. */
+	set_state(1000, J1772_STATE_B);
+	app_tx_send_evse_data();
+	set_state(1500, J1772_STATE_C);
+	app_tx_send_evse_data();
+	TEST_ASSERT_EQUAL_INT(2, mock_send_count);
+
+	set_state(2000, J1772_STATE_B);
+	app_tx_send_evse_data();
+	run_until(6000);
+	TEST_ASSERT_EQUAL_INT(3, mock_send_count);
+	TEST_ASSERT_EQUAL_UINT8(J1772_STATE_B, mock_sends[2].data[2]);
+}
+
+void test_sustained_flapping_keeps_airtime_flat(void)
+{
+	/* 2 minutes of a transition every second: never more uplinks than
+	 * the burst plus one per 5s refill */
+	int state = J1772_STATE_B;
+	for (uint32_t t = 1000; t <= 121000; t += 1000) {
+		set_state(t, state);
+		app_tx_send_evse_data();
+		app_tx_flush();
+		state = (state == J1772_STATE_B) ? J1772_STATE_C : J1772_STATE_B;
+	}
+	TEST_ASSERT_LESS_OR_EQUAL_INT(2 + 120000 / 5000, mock_send_count);
+	TEST_ASSERT_TRUE(app_tx_queue_dropped() > 0);
+	TEST_ASSERT_LESS_OR_EQUAL_INT(APP_TX_QUEUE_DEPTH, app_tx_queue_depth());
+}
+
+void test_transition_replaces_queued_heartbeat(void)
+{
+	set_state(1000, J1772_STATE_A);
+	app_tx_send_evse_data();
+	app_tx_send_evse_data();              /* burst spent */
+	app_tx_send_heartbeat();              /* queued */
+	TEST_ASSERT_EQUAL_UINT8(1, app_tx_queue_depth());
+
+	set_state(2000, J1772_STATE_B);
+	app_tx_send_evse_data();
+	TEST_ASSERT_EQUAL_UINT8(1, app_tx_queue_depth());
+	TEST_ASSERT_EQUAL_UINT32(1, app_tx_queue_coalesced());
+
+	run_until(20000);
+	TEST_ASSERT_EQUAL_INT(3, mock_send_count);
+	TEST_ASSERT_EQUAL_UINT8(J1772_STATE_B, mock_sends[2].data[2]);
+}
+
+void test_heartbeat_behind_queued_transition_dropped(void)
+{
+	set_state(1000, J1772_STATE_B);
+	app_tx_send_evse_data();
+	set_state(1100, J1772_STATE_C);
+	app_tx_send_evse_data();
+	set_state(1200, J1772_STATE_B);
+	app_tx_send_evse_data();              /* queued */
+
+	app_tx_send_heartbeat();
+	TEST_ASSERT_EQUAL_UINT8(1, app_tx_queue_depth());
+	run_until(30000);
+	TEST_ASSERT_EQUAL_INT(3, mock_send_count);
+}
+
+void test_repeated_transition_coalesced_to_newest(void)
+{
+	uint8_t sync_cmd[] = { 0x30, 0x00, 0x10, 0x00, 0x00, 0, 0, 0, 0 };
+	mock_uptime_ms = 0;
+	time_sync_process_cmd(sync_cmd, sizeof(sync_cmd));
+
+	set_state(1000, J1772_STATE_B);
+	app_tx_send_evse_data();
+	app_tx_send_evse_data();
+	set_state(2000, J1772_STATE_C);
+	app_tx_send_evse_data();
+	set_state(3000, J1772_STATE_C);
+	app_tx_send_evse_data();              /* same state: refresh only */
+	TEST_ASSERT_EQUAL_UINT8(1, app_tx_queue_depth());
+
+	run_until(20000);
+	TEST_ASSERT_EQUAL_INT(3, mock_send_count);
+	uint32_t ts = mock_sends[2].data[8] | (mock_sends[2].data[9] << 8) |
+		      (mock_sends[2].data[10] << 16) | ((uint32_t)mock_sends[2].data[11] << 24);
+	TEST_ASSERT_EQUAL_UINT32(0x1000 + 3, ts);
+}
+
+void test_drain_waits_behind_live_queue(void)
+{
+	struct event_snapshot snap = { .timestamp = 500, .j1772_state = 1 };
+
+	set_state(1000, J1772_STATE_B);
+	app_tx_send_evse_data();
+	set_state(1100, J1772_STATE_C);
+	app_tx_send_evse_data();
+	set_state(1200, J1772_STATE_B);
+	app_tx_send_evse_data();              /* queued */
+
+	mock_uptime_ms = 30000;               /* bucket full again */
+	TEST_ASSERT_EQUAL_INT(0, app_tx_send_batch(&snap, 1, NULL));
+	TEST_ASSERT_EQUAL_INT(1, app_tx_flush());
+	/* Drain only spends from a full bucket */
+	TEST_ASSERT_EQUAL_INT(0, app_tx_send_batch(&snap, 1, NULL));
+	mock_uptime_ms = 35000;
+	TEST_ASSERT_EQUAL_INT(1, app_tx_send_batch(&snap, 1, NULL));
+}
+
+void test_queue_held_while_not_ready(void)
+{
+	set_state(1000, J1772_STATE_B);
+	app_tx_send_evse_data();
+	app_tx_send_evse_data();
+	set_state(1100, J1772_STATE_C);
+	app_tx_send_evse_data();              /* queued */
+
+	mock_sidewalk_ready = false;
+	run_until(20000);
+	TEST_ASSERT_EQUAL_INT(2, mock_send_count);
+	TEST_ASSERT_EQUAL_UINT8(1, app_tx_queue_depth());
+
+	mock_sidewalk_ready = true;
+	run_until(21000);
+	TEST_ASSERT_EQUAL_INT(3, mock_send_count);
+}
+
+void test_platform_backpressure_keeps_uplink_queued(void)
+{
+	struct event_snapshot snap = { .timestamp = 500, .j1772_state = 1 };
+
+	/* Platform message pool full: nothing lost, nothing spent */
+	mock_send_return = PLATFORM_SEND_NOBUFS;
+	set_state(1000, J1772_STATE_B);
+	TEST_ASSERT_EQUAL_INT(0, app_tx_send_evse_data());
+	TEST_ASSERT_EQUAL_UINT8(1, app_tx_queue_depth());
+	TEST_ASSERT_EQUAL_INT(0, app_tx_flush());
+	TEST_ASSERT_EQUAL_UINT8(1, app_tx_queue_depth());
+
+	mock_send_return = 0;
+	TEST_ASSERT_EQUAL_INT(1, app_tx_flush());
+	TEST_ASSERT_EQUAL_UINT8(0, app_tx_queue_depth());
+	TEST_ASSERT_EQUAL_UINT8(J1772_STATE_B, mock_sends[2].data[2]);
+
+	/* Drain frames read it as rate-limited and keep the bucket */
+	mock_uptime_ms = 30000;
+	mock_send_return = PLATFORM_SEND_NOBUFS;
+	TEST_ASSERT_EQUAL_INT(0, app_tx_send_batch(&snap, 1, NULL));
+	mock_send_return = 0;
+	TEST_ASSERT_EQUAL_INT(1, app_tx_send_batch(&snap, 1, NULL));
+}
+
 /* --- Payload field encoding (bytes 0-6: same as v0x06) --- */
 
 void test_j1772_state_at_byte2(void)
@@ -119,6 +330,7 @@ void test_current_little_endian(void)
 void test_thermostat_flags_in_byte7_bit_1(void)
 {
 	mock_gpio_values[2] = 1; /* cool */
+	thermostat_inputs_init(); /* level read when it subscribes to edges */
 	mock_adc_values[0] = 3000;
 
 	app_tx_send_evse_data();
@@ -145,6 +357,7 @@ void test_charge_not_allowed_clears_bit2(void)
 void test_charge_allowed_coexists_with_thermostat(void)
 {
 	mock_gpio_values[2] = 1; /* cool */
+	thermostat_inputs_init(); /* level read when it subscribes to edges */
 	mock_adc_values[0] = 3000;
 	charge_control_set(true, 0);
 
@@ -224,6 +437,209 @@ void test_set_ready_flag(void)
 	TEST_ASSERT_FALSE(app_tx_is_ready());
 }
 
+/* --- Batched drain frame (v0x0B) --- */
+
+static struct event_snapshot batch_snap(uint32_t ts, uint8_t state, uint16_t ma)
+{
+	struct event_snapshot s = {
+		.timestamp = ts,
+		.pilot_voltage_mv = 2234,
+		.current_ma = ma,
+		.j1772_state = state,
+	};
+	return s;
+}
+
+void test_batch_header_and_entries(void)
+{
+	struct event_snapshot snaps[2] = {
+		batch_snap(0x01020304, 1, 0),
+		batch_snap(0x01020304 + 300, 2, 16000),
+	};
+	snaps[1].thermostat_flags = THERMOSTAT_FLAG_COOL;
+	snaps[1].charge_flags = EVENT_FLAG_CHARGE_ALLOWED;
+
+	TEST_ASSERT_EQUAL_INT(2, app_tx_send_batch(snaps, 2, NULL));
+	TEST_ASSERT_EQUAL(APP_TX_BATCH_HDR_SIZE + 2 * APP_TX_BATCH_ENTRY_SIZE,
+			  mock_last_send_len);
+
+	const uint8_t *d = mock_last_send_buf;
+	TEST_ASSERT_EQUAL_UINT8(0xE5, d[0]);
+	TEST_ASSERT_EQUAL_UINT8(0x0B, d[1]);
+	TEST_ASSERT_EQUAL_UINT8(2, d[2]);
+	TEST_ASSERT_EQUAL_UINT8(0x04, d[3]);
+	TEST_ASSERT_EQUAL_UINT8(0x01, d[6]);
+
+	/* Entry 0: offset 0, state 1, no flags, 0 mA */
+	TEST_ASSERT_EQUAL_UINT8(0, d[7]);
+	TEST_ASSERT_EQUAL_UINT8(0, d[8]);
+	TEST_ASSERT_EQUAL_UINT8(0x01, d[9]);
+	TEST_ASSERT_EQUAL_UINT8(0, d[10]);
+
+	/* Entry 1: offset 300, state 2, cool + allowed in high nibble, 80 x 200 mA */
+	TEST_ASSERT_EQUAL_UINT8(300 & 0xFF, d[11]);
+	TEST_ASSERT_EQUAL_UINT8(300 >> 8, d[12]);
+	TEST_ASSERT_EQUAL_UINT8(0x02 | (0x06 << 4), d[13]);
+	TEST_ASSERT_EQUAL_UINT8(80, d[14]);
+}
+
+void test_batch_reason_adds_byte(void)
+{
+	struct event_snapshot snaps[2] = {
+		batch_snap(1000, 2, 0),
+		batch_snap(1010, 1, 0),
+	};
+	snaps[0].transition_reason = TRANSITION_REASON_CLOUD_CMD;
+
+	TEST_ASSERT_EQUAL_INT(2, app_tx_send_batch(snaps, 2, NULL));
+	TEST_ASSERT_EQUAL(APP_TX_BATCH_HDR_SIZE + 2 * APP_TX_BATCH_ENTRY_SIZE + 1,
+			  mock_last_send_len);
+	TEST_ASSERT_EQUAL_UINT8(0x02 | 0x08, mock_last_send_buf[9]);
+	TEST_ASSERT_EQUAL_UINT8(TRANSITION_REASON_CLOUD_CMD, mock_last_send_buf[11]);
+	TEST_ASSERT_EQUAL_UINT8(10, mock_last_send_buf[12]);
+}
+
+void test_batch_fits_lora_mtu(void)
+{
+	struct event_snapshot snaps[10];
+	for (int i = 0; i < 10; i++) {
+		snaps[i] = batch_snap(1000 + i, 1, 0);
+	}
+	TEST_ASSERT_EQUAL_INT(3, app_tx_send_batch(snaps, 10, NULL));
+	TEST_ASSERT_TRUE(mock_last_send_len <= APP_TX_MTU_LORA);
+}
+
+void test_batch_uses_ble_mtu_on_ble_only_link(void)
+{
+	struct event_snapshot snaps[APP_TX_BATCH_MAX];
+	for (int i = 0; i < APP_TX_BATCH_MAX; i++) {
+		snaps[i] = batch_snap(1000 + i, 1, 0);
+	}
+	mock_link_mask = 0x01;  /* SID_LINK_TYPE_1 = BLE */
+	TEST_ASSERT_EQUAL_INT(APP_TX_BATCH_MAX, app_tx_send_batch(snaps, APP_TX_BATCH_MAX, NULL));
+	TEST_ASSERT_TRUE(mock_last_send_len <= APP_TX_MTU_BLE);
+}
+
+void test_batch_splits_on_clock_step_and_long_gap(void)
+{
+	struct event_snapshot snaps[3] = {
+		batch_snap(5000, 1, 0),
+		batch_snap(4000, 1, 0),   /* clock stepped back */
+		batch_snap(4001, 1, 0),
+	};
+	TEST_ASSERT_EQUAL_INT(1, app_tx_send_batch(snaps, 3, NULL));
+
+	struct event_snapshot gap[2] = {
+		batch_snap(5000, 1, 0),
+		batch_snap(5000 + 0x10000, 1, 0),
+	};
+	mock_uptime_ms += 5000;
+	TEST_ASSERT_EQUAL_INT(1, app_tx_send_batch(gap, 2, NULL));
+}
+
+void test_batch_current_saturates(void)
+{
+	struct event_snapshot s = batch_snap(1000, 2, 60000);
+	TEST_ASSERT_EQUAL_INT(1, app_tx_send_batch(&s, 1, NULL));
+	TEST_ASSERT_EQUAL_UINT8(0xFF, mock_last_send_buf[10]);
+}
+
+void test_batch_rate_limited_and_not_ready(void)
+{
+	struct event_snapshot s = batch_snap(1000, 1, 0);
+	mock_uptime_ms = 10000;
+	TEST_ASSERT_EQUAL_INT(1, app_tx_send_batch(&s, 1, NULL));
+	mock_uptime_ms = 11000;
+	TEST_ASSERT_EQUAL_INT(0, app_tx_send_batch(&s, 1, NULL));
+
+	mock_uptime_ms = 20000;
+	mock_sidewalk_ready = false;
+	TEST_ASSERT_EQUAL_INT(-1, app_tx_send_batch(&s, 1, NULL));
+	TEST_ASSERT_EQUAL_INT(-1, app_tx_send_batch(NULL, 1, NULL));
+}
+
+void test_batch_reports_platform_msg_id(void)
+{
+	struct event_snapshot s = batch_snap(1000, 1, 0);
+	uint32_t id = 0;
+
+	TEST_ASSERT_EQUAL_INT(1, app_tx_send_batch(&s, 1, &id));
+	TEST_ASSERT_EQUAL_UINT32(mock_sends[0].msg_id, id);
+	TEST_ASSERT_TRUE(id > 0);
+
+	/* Platform refusing the frame: -1, id untouched */
+	mock_uptime_ms += 5000;
+	mock_send_return = -5;
+	id = 77;
+	TEST_ASSERT_EQUAL_INT(-1, app_tx_send_batch(&s, 1, &id));
+	TEST_ASSERT_EQUAL_UINT32(77, id);
+}
+
+/*
+ * LoRa time-on-air (Semtech AN1200.13) for an app payload of len bytes:
+ * SF7, 125 kHz, CR 4/5, 8-symbol preamble, explicit header, CRC on.
+ * Sidewalk framing adds a fixed per-frame overhead on top, so real
+ * savings are larger than this payload-only figure.
+ */
+static uint32_t lora_airtime_us(size_t len)
+{
+	const int sf = 7;
+	const uint32_t tsym_us = (1u << sf) * 1000000u / 125000u;  /* 1024 us */
+	int num = 8 * (int)len - 4 * sf + 28 + 16;
+	int den = 4 * sf;
+	int blocks = (num > 0) ? (num + den - 1) / den : 0;
+	uint32_t nsym = 8 + blocks * 5;
+	return (uint32_t)((8 * 4 + 17) * tsym_us / 4) + nsym * tsym_us;  /* preamble 8 + 4.25 */
+}
+
+static void drain_report(int mask, const char *name, int backlog)
+{
+	struct event_snapshot snaps[64];
+	for (int i = 0; i < backlog; i++) {
+		snaps[i] = batch_snap(100000 + i * 300, (uint8_t)(i % 3), (i % 3 == 2) ? 32000 : 0);
+	}
+
+	/* Single-snapshot v0x0A drain */
+	int single_frames = backlog;
+	uint32_t single_air = backlog * lora_airtime_us(15);
+
+	/* Batched v0x0B drain */
+	mock_link_mask = mask;
+	int frames = 0, sent = 0;
+	uint32_t air = 0;
+	while (sent < backlog) {
+		mock_uptime_ms += 5000;
+		int n = app_tx_send_batch(&snaps[sent], backlog - sent, NULL);
+		TEST_ASSERT_TRUE(n > 0);
+		sent += n;
+		frames++;
+		air += lora_airtime_us(mock_last_send_len);
+	}
+
+	if (mask == 0x01) {
+		/* BLE airtime is negligible; the win is connection events */
+		printf("  %s drain of %d: %d uplinks -> %d (%d fewer)\n",
+		       name, backlog, single_frames, frames, single_frames - frames);
+	} else {
+		printf("  %s drain of %d: %d uplinks -> %d (%d fewer), "
+		       "%u.%03u s -> %u.%03u s payload airtime (%u%% saved)\n",
+		       name, backlog, single_frames, frames, single_frames - frames,
+		       single_air / 1000000, (single_air / 1000) % 1000,
+		       air / 1000000, (air / 1000) % 1000,
+		       100 - (air * 100 / single_air));
+	}
+
+	TEST_ASSERT_EQUAL_INT(backlog, sent);
+	TEST_ASSERT_TRUE(frames * 3 <= single_frames + 2);
+	TEST_ASSERT_TRUE(air < single_air);
+}
+
+void test_bench_full_drain_savings(void)
+{
+	drain_report(4, "LoRa", 50);
+	drain_report(1, "BLE", 50);
+}
+
 /* --- main --- */
 
 int main(void)
@@ -239,6 +655,18 @@ int main(void)
 	/* Rate limiting */
 	RUN_TEST(test_rate_limit_blocks);
 	RUN_TEST(test_rate_limit_allows_after_interval);
+	RUN_TEST(test_wait_ms_until_budget_allows);
+
+	/* Live uplink queue */
+	RUN_TEST(test_flapping_vehicle_every_transition_sent_in_order);
+	RUN_TEST(test_flapping_latency_beats_drain);
+	RUN_TEST(test_sustained_flapping_keeps_airtime_flat);
+	RUN_TEST(test_transition_replaces_queued_heartbeat);
+	RUN_TEST(test_heartbeat_behind_queued_transition_dropped);
+	RUN_TEST(test_repeated_transition_coalesced_to_newest);
+	RUN_TEST(test_drain_waits_behind_live_queue);
+	RUN_TEST(test_queue_held_while_not_ready);
+	RUN_TEST(test_platform_backpressure_keeps_uplink_queued);
 
 	/* Field encoding */
 	RUN_TEST(test_j1772_state_at_byte2);
@@ -260,5 +688,16 @@ int main(void)
 	RUN_TEST(test_no_api_returns_error);
 	RUN_TEST(test_set_ready_flag);
 
+	/* Batched drain frame */
+	RUN_TEST(test_batch_header_and_entries);
+	RUN_TEST(test_batch_reason_adds_byte);
+	RUN_TEST(test_batch_fits_lora_mtu);
+	RUN_TEST(test_batch_uses_ble_mtu_on_ble_only_link);
+	RUN_TEST(test_batch_splits_on_clock_step_and_long_gap);
+	RUN_TEST(test_batch_current_saturates);
+	RUN_TEST(test_batch_rate_limited_and_not_ready);
+	RUN_TEST(test_batch_reports_platform_msg_id);
+	RUN_TEST(test_bench_full_drain_savings);
+
 	return UNITY_END();
 }
@@ -1,8 +1,9 @@
 /*
  * Host-side unit tests for the platform boot path.
  *
- * Tests discover_app_image(), app_route_message(), and
- * app_set_timer_interval() — all defined in app.c.
+ * Tests discover_app_image(), init_app_image(), app_route_message(), and
+ * app_set_timer_interval() — all defined in app.c — and the A/B slot
+ * boot record in ota_boot.c, on mock flash.
  *
  * Compiles app.c against mock headers (tests/mock_include/) and mock
  * implementations (mock_boot.c) on the host.  This is the Grenning
@@ -10,12 +11,14 @@
  *
  * Covers:
  * - App image discovery: magic, version, reject reasons
+ * - A/B slots: selection, trial boots, fallback, rollback, record wear
  * - Message routing: OTA (0x20) vs app dispatch, NULL safety
  * - Timer interval bounds validation
  */
 
 #include <app.h>
 #include <platform_api.h>
+#include <ota_boot.h>
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -40,7 +43,9 @@ static int tests_passed;
 /* ------------------------------------------------------------------ */
 
 extern const struct app_callbacks *test_app_cb_addr;
+extern const struct app_callbacks *test_app_cb_b;
 extern void discover_app_image(void);
+extern void init_app_image(void);
 
 /* ------------------------------------------------------------------ */
 /*  Observable mock state from mock_boot.c                              */
@@ -48,6 +53,18 @@ extern void discover_app_image(void);
 
 extern int mock_ota_process_msg_called;
 extern void mock_ota_reset(void);
+extern bool mock_tx_ready;
+
+/* mock_flash.c */
+extern uint8_t mock_flash_mem[];
+extern int mock_flash_write_count;
+extern int mock_flash_erase_count;
+extern int mock_reboot_count;
+extern struct k_work_delayable *mock_work_scheduled;
+extern void mock_flash_reset(void);
+extern void mock_work_run_scheduled(void);
+
+#define MOCK_FLASH_BASE 0x90000
 
 /* ------------------------------------------------------------------ */
 /*  Mock app callback table with controllable magic/version             */
@@ -75,7 +92,18 @@ static int mock_init(const struct platform_api *api)
 	return 0;
 }
 
+static int mock_init_b_count;
+static int mock_init_b_result;
+
+static int mock_init_b(const struct platform_api *api)
+{
+	(void)api;
+	mock_init_b_count++;
+	return mock_init_b_result;
+}
+
 static struct app_callbacks test_cb;
+static struct app_callbacks test_cb_b;   /* slot B's build */
 
 static void setup_valid_cb(void)
 {
@@ -84,6 +112,11 @@ static void setup_valid_cb(void)
 	test_cb.version = APP_CALLBACK_VERSION;
 	test_cb.init = mock_init;
 	test_cb.on_msg_received = mock_on_msg_received;
+
+	memset(&test_cb_b, 0, sizeof(test_cb_b));
+	test_cb_b.magic = APP_CALLBACK_MAGIC;
+	test_cb_b.version = APP_CALLBACK_VERSION;
+	test_cb_b.init = mock_init_b;
 }
 
 static void reset_all(void)
@@ -91,8 +124,16 @@ static void reset_all(void)
 	mock_on_msg_received_count = 0;
 	mock_on_msg_received_len = 0;
 	mock_init_count = 0;
+	mock_init_b_count = 0;
+	mock_init_b_result = 0;
+	mock_tx_ready = false;
 	mock_ota_reset();
 	memset(mock_on_msg_received_data, 0, sizeof(mock_on_msg_received_data));
+
+	/* Erased boot record: slot A, no slot B table */
+	mock_flash_reset();
+	ota_boot_init();
+	test_app_cb_b = NULL;
 }
 
 /* ================================================================== */
@@ -304,6 +345,389 @@ static void test_null_on_msg_received_callback(void)
 	assert(mock_ota_process_msg_called == 0);
 }
 
+/* ================================================================== */
+/*  A/B slots                                                           */
+/* ================================================================== */
+
+static uint32_t test_crc32(const uint8_t *p, uint32_t len)
+{
+	uint32_t crc = ~0u;
+	for (uint32_t i = 0; i < len; i++) {
+		crc ^= p[i];
+		for (int j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+static uint8_t *slot_mem(uint8_t slot)
+{
+	return &mock_flash_mem[ota_boot_slot_addr(slot) - MOCK_FLASH_BASE];
+}
+
+/* Put an image in a slot's flash (the callback tables themselves come
+ * from test_cb / test_cb_b) and return its record */
+static struct ota_boot_image put_slot_image(uint8_t slot, uint32_t size, uint8_t seed)
+{
+	uint8_t *mem = slot_mem(slot);
+
+	for (uint32_t i = 0; i < size; i++) {
+		mem[i] = (uint8_t)(i * 13 + seed);
+	}
+	struct ota_boot_image img = {
+		.size = size,
+		.crc32 = test_crc32(mem, size),
+		.version = seed,
+	};
+	return img;
+}
+
+/* OTA wrote slot B and activated it; the device reboots into it */
+static void boot_into_slot_b(void)
+{
+	struct ota_boot_image img = put_slot_image(OTA_SLOT_B, 5000, 2);
+
+	assert(ota_boot_activate(OTA_SLOT_B, &img) == 0);
+	test_app_cb_b = &test_cb_b;
+	assert(ota_boot_init() == OTA_SLOT_B);
+	discover_app_image();
+}
+
+static void test_erased_record_boots_slot_a(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+	test_app_cb_b = &test_cb_b;
+
+	assert(ota_boot_init() == OTA_SLOT_A);
+	discover_app_image();
+
+	assert(app_get_callbacks() == &test_cb);
+	assert(!ota_boot_in_trial());
+	/* A device that never had an A/B update gets no records */
+	assert(mock_flash_write_count == 0);
+
+	/* Slot B holds no recorded image: never a fallback */
+	assert(ota_boot_slot_valid(OTA_SLOT_A));
+	assert(!ota_boot_slot_valid(OTA_SLOT_B));
+}
+
+static void test_activated_slot_boots_on_trial(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+
+	boot_into_slot_b();
+
+	assert(app_get_callbacks() == &test_cb_b);
+	assert(ota_boot_active_slot() == OTA_SLOT_B);
+	assert(ota_boot_in_trial());
+	/* Flipping slots did not copy or erase anything */
+	assert(mock_flash_erase_count == 0);
+}
+
+static void test_unconfirmed_trial_rolls_back_after_max_boots(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+
+	boot_into_slot_b();
+	for (int i = 1; i < OTA_BOOT_TRIAL_BOOTS; i++) {
+		/* Crashes before its first uplink */
+		assert(ota_boot_init() == OTA_SLOT_B);
+		assert(ota_boot_in_trial());
+	}
+
+	assert(ota_boot_init() == OTA_SLOT_A);
+	assert(!ota_boot_in_trial());
+	discover_app_image();
+	assert(app_get_callbacks() == &test_cb);
+
+	/* Slot B is never booted again */
+	assert(ota_boot_init() == OTA_SLOT_A);
+	assert(!ota_boot_slot_valid(OTA_SLOT_B));
+}
+
+static void test_confirmed_slot_keeps_booting(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+
+	boot_into_slot_b();
+	ota_boot_confirm();
+	assert(!ota_boot_in_trial());
+
+	int writes = mock_flash_write_count;
+	for (int i = 0; i < 2 * OTA_BOOT_TRIAL_BOOTS; i++) {
+		assert(ota_boot_init() == OTA_SLOT_B);
+		assert(!ota_boot_in_trial());
+	}
+	/* Confirmed: boots append nothing */
+	assert(mock_flash_write_count == writes);
+}
+
+static void test_bad_active_slot_falls_back(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+
+	boot_into_slot_b();
+	ota_boot_confirm();
+
+	/* Slot B's table is damaged: slot A's image still passes */
+	test_cb_b.magic = 0xFFFFFFFF;
+	assert(ota_boot_init() == OTA_SLOT_B);
+	discover_app_image();
+
+	assert(app_get_callbacks() == &test_cb);
+	assert(app_get_reject_reason() == NULL);
+	assert(ota_boot_active_slot() == OTA_SLOT_A);
+	assert(ota_boot_init() == OTA_SLOT_A);
+}
+
+static void test_fallback_needs_intact_image(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+	test_app_cb_b = &test_cb_b;
+
+	/* B, then A again through the inactive slot; both recorded */
+	struct ota_boot_image b = put_slot_image(OTA_SLOT_B, 5000, 2);
+	assert(ota_boot_activate(OTA_SLOT_B, &b) == 0);
+	ota_boot_confirm();
+	struct ota_boot_image a = put_slot_image(OTA_SLOT_A, 7000, 3);
+	assert(ota_boot_activate(OTA_SLOT_A, &a) == 0);
+	ota_boot_confirm();
+	assert(ota_boot_init() == OTA_SLOT_A);
+	assert(ota_boot_slot_valid(OTA_SLOT_B));
+
+	/* Slot B's flash no longer matches its record (e.g. reused as
+	 * staging): A's bad table has nothing to fall back to */
+	slot_mem(OTA_SLOT_B)[100] ^= 0x01;
+	assert(ota_boot_init() == OTA_SLOT_A);
+	test_cb.magic = 0;
+	discover_app_image();
+
+	assert(!app_image_valid());
+	assert(strcmp(app_get_reject_reason(), "bad magic") == 0);
+	assert(ota_boot_active_slot() == OTA_SLOT_A);
+}
+
+static void test_trial_init_failure_rolls_back_in_place(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+
+	boot_into_slot_b();
+	mock_init_b_result = -5;
+	init_app_image();
+
+	/* Slot A's app started right away, no reboot */
+	assert(mock_init_b_count == 1);
+	assert(mock_init_count == 1);
+	assert(app_get_callbacks() == &test_cb);
+	assert(mock_reboot_count == 0);
+	assert(ota_boot_active_slot() == OTA_SLOT_A);
+	assert(ota_boot_init() == OTA_SLOT_A);
+}
+
+static void test_confirmed_init_failure_does_not_roll_back(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+
+	boot_into_slot_b();
+	ota_boot_confirm();
+	mock_init_b_result = -5;
+	init_app_image();
+
+	assert(!app_image_valid());
+	assert(mock_init_count == 0);
+	assert(ota_boot_active_slot() == OTA_SLOT_B);
+}
+
+static void test_silent_trial_rolls_back(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+
+	boot_into_slot_b();
+	init_app_image();
+	assert(app_get_callbacks() == &test_cb_b);
+
+	/* Minutes without a link do not count */
+	for (int i = 0; i < 60; i++) {
+		assert(mock_work_scheduled != NULL);
+		mock_work_run_scheduled();
+	}
+	assert(ota_boot_in_trial());
+
+	/* Link up, still no uplink: rolled back after 30 minutes */
+	mock_tx_ready = true;
+	for (int i = 0; i < 29; i++) {
+		mock_work_run_scheduled();
+	}
+	assert(ota_boot_in_trial());
+	assert(mock_reboot_count == 0);
+	mock_work_run_scheduled();
+
+	assert(mock_reboot_count == 1);
+	assert(mock_work_scheduled == NULL);
+	assert(ota_boot_init() == OTA_SLOT_A);
+}
+
+static void test_uplink_confirms_trial(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+	mock_tx_ready = true;
+
+	boot_into_slot_b();
+	init_app_image();
+	mock_work_run_scheduled();
+
+	/* First uplink sent (sidewalk_dispatch.c) */
+	ota_boot_confirm();
+	mock_work_run_scheduled();
+
+	assert(mock_work_scheduled == NULL);
+	assert(mock_reboot_count == 0);
+	assert(ota_boot_init() == OTA_SLOT_B);
+	assert(!ota_boot_in_trial());
+}
+
+static void test_torn_record_is_skipped(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+
+	boot_into_slot_b();
+
+	/* Power lost while programming CONFIRM: half the record is there */
+	uint8_t *rec = &mock_flash_mem[OTA_BOOT_RECORD_ADDR - MOCK_FLASH_BASE];
+	int slot = 0;
+	while (rec[slot * 16 + 12] != 0xFF) {
+		slot++;
+	}
+	struct ota_boot_rec torn = { .kind = OTA_BOOT_REC_CONFIRM, .slot = OTA_SLOT_B };
+	memcpy(&rec[slot * 16], &torn, 8);
+
+	/* Still on trial, and the next append goes after the torn slot */
+	assert(ota_boot_init() == OTA_SLOT_B);
+	assert(ota_boot_in_trial());
+	ota_boot_confirm();
+	assert(ota_boot_init() == OTA_SLOT_B);
+	assert(!ota_boot_in_trial());
+}
+
+static void test_record_page_compacts(void)
+{
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+
+	struct ota_boot_image b = put_slot_image(OTA_SLOT_B, 5000, 2);
+	struct ota_boot_image a = put_slot_image(OTA_SLOT_A, 6000, 3);
+
+	/* 100 A/B updates, 2 records each, then 60 more activations of B */
+	for (int i = 0; i < 100; i++) {
+		assert(ota_boot_activate(i % 2 ? OTA_SLOT_A : OTA_SLOT_B,
+					 i % 2 ? &a : &b) == 0);
+		ota_boot_confirm();
+	}
+	for (int i = 0; i < 60; i++) {
+		assert(ota_boot_activate(OTA_SLOT_B, &b) == 0);
+	}
+	assert(ota_boot_init() == OTA_SLOT_B);
+	assert(ota_boot_in_trial());
+
+	/* 261 records: compacted once, into the spare page, which was
+	 * still erased */
+	assert(mock_flash_erase_count == 0);
+
+	/* The snapshot kept both slots' images and the trial */
+	struct ota_boot_image img;
+	assert(ota_boot_slot_image(OTA_SLOT_A, &img) && img.crc32 == a.crc32);
+	assert(ota_boot_slot_image(OTA_SLOT_B, &img) && img.crc32 == b.crc32);
+	assert(ota_boot_init() == OTA_SLOT_B);
+	assert(ota_boot_init() == OTA_SLOT_B);
+	assert(ota_boot_init() == OTA_SLOT_A);      /* trial boots used up */
+	assert(ota_boot_slot_valid(OTA_SLOT_A));
+}
+
+static uint8_t *record_page(uint8_t page)
+{
+	return &mock_flash_mem[OTA_BOOT_RECORD_ADDR + page * OTA_FLASH_PAGE_SIZE -
+			       MOCK_FLASH_BASE];
+}
+
+static void test_compaction_survives_power_loss(void)
+{
+	static uint8_t full[OTA_FLASH_PAGE_SIZE];
+	static uint8_t spare[OTA_FLASH_PAGE_SIZE];
+
+	reset_all();
+	setup_valid_cb();
+	test_app_cb_addr = &test_cb;
+
+	struct ota_boot_image b = put_slot_image(OTA_SLOT_B, 5000, 2);
+	struct ota_boot_image a = put_slot_image(OTA_SLOT_A, 6000, 3);
+
+	/* Slot B confirmed, then IMAGE records up to the end of page 0 */
+	assert(ota_boot_activate(OTA_SLOT_B, &b) == 0);
+	ota_boot_confirm();
+	for (int i = 0; i < (int)OTA_BOOT_SLOTS - 3; i++) {
+		assert(ota_boot_set_image(OTA_SLOT_A, &a) == 0);
+	}
+	memcpy(full, record_page(0), sizeof(full));
+
+	/* Activating A compacts into page 1 */
+	assert(ota_boot_activate(OTA_SLOT_A, &a) == 0);
+	memcpy(spare, record_page(1), sizeof(spare));
+	assert(memcmp(full, record_page(0), sizeof(full)) == 0);
+
+	/* Power lost before the header: page 0 still boots B, confirmed */
+	memset(record_page(1), 0xFF, sizeof(struct ota_boot_rec));
+	assert(ota_boot_init() == OTA_SLOT_B);
+	assert(!ota_boot_in_trial());
+
+	/* ... or with the header half programmed */
+	memcpy(record_page(1), spare, 8);
+	assert(ota_boot_init() == OTA_SLOT_B);
+	assert(!ota_boot_in_trial());
+
+	/* Header in: page 1 is current */
+	memcpy(record_page(1), spare, sizeof(spare));
+	assert(ota_boot_init() == OTA_SLOT_A);
+	assert(ota_boot_in_trial());
+	ota_boot_confirm();
+
+	/* The next compaction goes back to page 0, erasing it first */
+	int erases = mock_flash_erase_count;
+
+	for (int i = 0; i < (int)OTA_BOOT_SLOTS; i++) {
+		assert(ota_boot_set_image(OTA_SLOT_B, &b) == 0);
+	}
+	assert(mock_flash_erase_count == erases + 1);
+	assert(ota_boot_init() == OTA_SLOT_A);
+	assert(!ota_boot_in_trial());
+
+	struct ota_boot_image img;
+	assert(ota_boot_slot_image(OTA_SLOT_B, &img) && img.crc32 == b.crc32);
+}
+
 /* ================================================================== */
 /*  Main                                                                */
 /* ================================================================== */
@@ -319,6 +743,21 @@ int main(void)
 	RUN_TEST(test_version_zero_mismatch);
 	RUN_TEST(test_rediscover_clears_previous_state);
 
+	printf("\n--- A/B Slots ---\n");
+	RUN_TEST(test_erased_record_boots_slot_a);
+	RUN_TEST(test_activated_slot_boots_on_trial);
+	RUN_TEST(test_unconfirmed_trial_rolls_back_after_max_boots);
+	RUN_TEST(test_confirmed_slot_keeps_booting);
+	RUN_TEST(test_bad_active_slot_falls_back);
+	RUN_TEST(test_fallback_needs_intact_image);
+	RUN_TEST(test_trial_init_failure_rolls_back_in_place);
+	RUN_TEST(test_confirmed_init_failure_does_not_roll_back);
+	RUN_TEST(test_silent_trial_rolls_back);
+	RUN_TEST(test_uplink_confirms_trial);
+	RUN_TEST(test_torn_record_is_skipped);
+	RUN_TEST(test_record_page_compacts);
+	RUN_TEST(test_compaction_survives_power_loss);
+
 	printf("\n--- Message Routing ---\n");
 	RUN_TEST(test_ota_message_routed_to_ota_engine);
 	RUN_TEST(test_non_ota_message_routed_to_app);
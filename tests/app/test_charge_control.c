@@ -6,10 +6,14 @@
 #include "mock_platform_api.h"
 #include "app_platform.h"
 #include "charge_control.h"
+#include "delay_window.h"
+#include "time_sync.h"
 
 void setUp(void)
 {
 	platform = mock_platform_api_init();
+	time_sync_init();
+	delay_window_init();
 	charge_control_init();
 }
 
@@ -107,6 +111,76 @@ void test_tick_noop_without_resume(void)
 	TEST_ASSERT_EQUAL_INT(count_before, mock_gpio_set_call_count);
 }
 
+/* --- Next deadline --- */
+
+void test_next_ms_none_without_timer(void)
+{
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, charge_control_next_ms());
+	charge_control_set(false, 0);
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, charge_control_next_ms());
+}
+
+void test_next_ms_auto_resume(void)
+{
+	mock_uptime_ms = 10000;
+	charge_control_set(false, 1);
+	TEST_ASSERT_EQUAL_UINT32(60000, charge_control_next_ms());
+
+	mock_uptime_ms = 10000 + 45000;
+	TEST_ASSERT_EQUAL_UINT32(15000, charge_control_next_ms());
+
+	mock_uptime_ms = 10000 + 61000;
+	TEST_ASSERT_EQUAL_UINT32(0, charge_control_next_ms());
+	charge_control_tick();
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, charge_control_next_ms());
+}
+
+static void sync_epoch(uint32_t epoch)
+{
+	uint8_t cmd[9] = {0x30,
+		epoch & 0xFF, (epoch >> 8) & 0xFF, (epoch >> 16) & 0xFF, epoch >> 24,
+		0, 0, 0, 0};
+	time_sync_process_cmd(cmd, sizeof(cmd));
+}
+
+static void set_window(uint32_t start, uint32_t end)
+{
+	uint8_t cmd[DELAY_WINDOW_PAYLOAD_SIZE] = {0x10, DELAY_WINDOW_SUBTYPE,
+		start & 0xFF, (start >> 8) & 0xFF, (start >> 16) & 0xFF, start >> 24,
+		end & 0xFF, (end >> 8) & 0xFF, (end >> 16) & 0xFF, end >> 24};
+	TEST_ASSERT_EQUAL_INT(0, delay_window_process_cmd(cmd, sizeof(cmd)));
+}
+
+void test_next_ms_delay_window_edges(void)
+{
+	mock_uptime_ms = 5000;
+	sync_epoch(1000);
+	set_window(1060, 1120);
+
+	/* Waiting for the start */
+	TEST_ASSERT_EQUAL_UINT32(60000, charge_control_next_ms());
+
+	/* Started but not applied yet: due now */
+	mock_uptime_ms = 5000 + 60000;
+	TEST_ASSERT_EQUAL_UINT32(0, charge_control_next_ms());
+	charge_control_tick();
+	TEST_ASSERT_FALSE(charge_control_is_allowed());
+
+	/* Paused: due once past the end */
+	TEST_ASSERT_EQUAL_UINT32(61000, charge_control_next_ms());
+	mock_uptime_ms = 5000 + 121000;
+	TEST_ASSERT_EQUAL_UINT32(0, charge_control_next_ms());
+	charge_control_tick();
+	TEST_ASSERT_TRUE(charge_control_is_allowed());
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, charge_control_next_ms());
+}
+
+void test_next_ms_window_ignored_without_sync(void)
+{
+	set_window(1060, 1120);
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, charge_control_next_ms());
+}
+
 /* --- Process command --- */
 
 void test_process_cmd_valid_allow(void)
@@ -160,6 +234,10 @@ int main(void)
 	RUN_TEST(test_auto_resume_not_yet);
 	RUN_TEST(test_tick_noop_when_allowed);
 	RUN_TEST(test_tick_noop_without_resume);
+	RUN_TEST(test_next_ms_none_without_timer);
+	RUN_TEST(test_next_ms_auto_resume);
+	RUN_TEST(test_next_ms_delay_window_edges);
+	RUN_TEST(test_next_ms_window_ignored_without_sync);
 	RUN_TEST(test_process_cmd_valid_allow);
 	RUN_TEST(test_process_cmd_valid_pause);
 	RUN_TEST(test_process_cmd_wrong_type);
@@ -0,0 +1,226 @@
+/*
+ * Unit tests for drain_inflight.c — msg_id to sequence-range tracking,
+ * retransmit backoff, and confirm timeouts for event-buffer drain frames.
+ */
+
+#include "unity.h"
+#include <drain_inflight.h>
+
+void setUp(void)
+{
+	drain_inflight_init();
+}
+
+void tearDown(void) { }
+
+static void test_confirm_frees_slot(void)
+{
+	drain_inflight_sent(7, 100, 3, 1000);
+	TEST_ASSERT_EQUAL_UINT8(1, drain_inflight_count());
+	TEST_ASSERT_TRUE(drain_inflight_confirm(7));
+	TEST_ASSERT_EQUAL_UINT8(0, drain_inflight_count());
+
+	/* A second confirm (or an unrelated id) is ignored */
+	TEST_ASSERT_FALSE(drain_inflight_confirm(7));
+	TEST_ASSERT_FALSE(drain_inflight_fail(99, 2000));
+}
+
+static void test_zero_msg_id_is_not_tracked(void)
+{
+	drain_inflight_sent(0, 100, 3, 1000);
+	TEST_ASSERT_EQUAL_UINT8(0, drain_inflight_count());
+	TEST_ASSERT_FALSE(drain_inflight_confirm(0));
+}
+
+static void test_table_full_blocks_new_frames(void)
+{
+	for (uint32_t i = 0; i < DRAIN_INFLIGHT_SLOTS; i++) {
+		TEST_ASSERT_TRUE(drain_inflight_can_send());
+		drain_inflight_sent(i + 1, i * 10, 10, 0);
+	}
+	TEST_ASSERT_FALSE(drain_inflight_can_send());
+	drain_inflight_confirm(2);
+	TEST_ASSERT_TRUE(drain_inflight_can_send());
+}
+
+static void test_fail_schedules_retry_after_backoff(void)
+{
+	uint32_t first;
+	uint8_t count;
+
+	drain_inflight_sent(5, 40, 6, 1000);
+	TEST_ASSERT_TRUE(drain_inflight_fail(5, 2000));
+
+	TEST_ASSERT_EQUAL_INT(-1, drain_inflight_due(2000 + DRAIN_RETRY_BASE_MS - 1,
+						     &first, &count));
+	int slot = drain_inflight_due(2000 + DRAIN_RETRY_BASE_MS, &first, &count);
+	TEST_ASSERT_TRUE(slot >= 0);
+	TEST_ASSERT_EQUAL_UINT32(40, first);
+	TEST_ASSERT_EQUAL_UINT8(6, count);
+}
+
+static void test_backoff_doubles_and_caps(void)
+{
+	uint32_t first;
+	uint8_t count;
+	uint32_t now = 0;
+	uint32_t expect = DRAIN_RETRY_BASE_MS;
+
+	drain_inflight_sent(1, 0, 1, now);
+	for (uint32_t id = 1; id <= 10; id++) {
+		drain_inflight_fail(id, now);
+		TEST_ASSERT_EQUAL_INT(-1, drain_inflight_due(now + expect - 1, &first, &count));
+		now += expect;
+		int slot = drain_inflight_due(now, &first, &count);
+		TEST_ASSERT_TRUE(slot >= 0);
+		drain_inflight_resent(slot, id + 1, first, count, now);
+
+		expect *= 2;
+		if (expect > DRAIN_RETRY_MAX_MS) {
+			expect = DRAIN_RETRY_MAX_MS;
+		}
+	}
+	TEST_ASSERT_EQUAL_UINT32(10, drain_inflight_retries());
+}
+
+static void test_unconfirmed_frame_times_out(void)
+{
+	uint32_t first;
+	uint8_t count;
+
+	drain_inflight_sent(3, 8, 2, 1000);
+	TEST_ASSERT_EQUAL_INT(-1, drain_inflight_due(1000 + DRAIN_CONFIRM_TIMEOUT_MS - 1,
+						     &first, &count));
+	/* Timeout converts to a failure; retry after the first backoff */
+	uint32_t t = 1000 + DRAIN_CONFIRM_TIMEOUT_MS;
+	TEST_ASSERT_EQUAL_INT(-1, drain_inflight_due(t, &first, &count));
+	TEST_ASSERT_TRUE(drain_inflight_due(t + DRAIN_RETRY_BASE_MS, &first, &count) >= 0);
+}
+
+static void test_late_confirm_clears_retry(void)
+{
+	uint32_t first;
+	uint8_t count;
+
+	drain_inflight_sent(3, 8, 2, 1000);
+	uint32_t t = 1000 + DRAIN_CONFIRM_TIMEOUT_MS;
+	TEST_ASSERT_EQUAL_INT(-1, drain_inflight_due(t, &first, &count));
+
+	/* A late error leaves the backoff alone */
+	TEST_ASSERT_FALSE(drain_inflight_fail(3, t + 5000));
+	TEST_ASSERT_TRUE(drain_inflight_due(t + DRAIN_RETRY_BASE_MS, &first, &count) >= 0);
+
+	/* The frame got through after all: the range is not sent again */
+	TEST_ASSERT_TRUE(drain_inflight_confirm(3));
+	TEST_ASSERT_EQUAL_UINT8(0, drain_inflight_count());
+	TEST_ASSERT_EQUAL_INT(-1, drain_inflight_due(t + DRAIN_RETRY_BASE_MS, &first, &count));
+
+	/* Once resent under a new id, the old one no longer matches */
+	drain_inflight_sent(4, 20, 2, t);
+	drain_inflight_due(t + DRAIN_CONFIRM_TIMEOUT_MS, &first, &count);
+	int slot = drain_inflight_due(t + DRAIN_CONFIRM_TIMEOUT_MS + DRAIN_RETRY_BASE_MS,
+				      &first, &count);
+	TEST_ASSERT_TRUE(slot >= 0);
+	drain_inflight_resent(slot, 5, first, count, t + DRAIN_CONFIRM_TIMEOUT_MS);
+	TEST_ASSERT_FALSE(drain_inflight_confirm(4));
+	TEST_ASSERT_TRUE(drain_inflight_confirm(5));
+}
+
+static void test_oldest_due_range_first(void)
+{
+	uint32_t first;
+	uint8_t count;
+
+	drain_inflight_sent(1, 50, 3, 0);
+	drain_inflight_sent(2, 20, 3, 0);
+	drain_inflight_fail(1, 0);
+	drain_inflight_fail(2, 0);
+	TEST_ASSERT_TRUE(drain_inflight_due(DRAIN_RETRY_BASE_MS, &first, &count) >= 0);
+	TEST_ASSERT_EQUAL_UINT32(20, first);
+}
+
+static void test_partial_retransmit_keeps_remainder_due(void)
+{
+	uint32_t first;
+	uint8_t count;
+
+	/* Range of 10 fails; the retry frame only carries 4 (smaller MTU) */
+	drain_inflight_sent(1, 100, 10, 0);
+	drain_inflight_fail(1, 0);
+	int slot = drain_inflight_due(DRAIN_RETRY_BASE_MS, &first, &count);
+	drain_inflight_resent(slot, 2, first, 4, DRAIN_RETRY_BASE_MS);
+
+	/* Nothing due while the retry frame is in flight */
+	TEST_ASSERT_EQUAL_INT(-1, drain_inflight_due(DRAIN_RETRY_BASE_MS + 1, &first, &count));
+
+	/* Once it confirms, the other 6 are due right away */
+	TEST_ASSERT_TRUE(drain_inflight_confirm(2));
+	TEST_ASSERT_TRUE(drain_inflight_due(DRAIN_RETRY_BASE_MS + 1, &first, &count) >= 0);
+	TEST_ASSERT_EQUAL_UINT32(104, first);
+	TEST_ASSERT_EQUAL_UINT8(6, count);
+}
+
+static void test_resend_skips_acked_entries(void)
+{
+	uint32_t first;
+	uint8_t count;
+
+	drain_inflight_sent(1, 100, 5, 0);
+	drain_inflight_fail(1, 0);
+	int slot = drain_inflight_due(DRAIN_RETRY_BASE_MS, &first, &count);
+
+	/* Cloud ACKed 100..102 meanwhile: only 103..104 go out */
+	drain_inflight_resent(slot, 2, 103, 2, DRAIN_RETRY_BASE_MS);
+	TEST_ASSERT_TRUE(drain_inflight_confirm(2));
+	TEST_ASSERT_EQUAL_UINT8(0, drain_inflight_count());
+}
+
+static void test_next_ms_tracks_earliest_slot(void)
+{
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, drain_inflight_next_ms(0));
+
+	/* Awaiting confirm: the timeout */
+	drain_inflight_sent(1, 100, 3, 1000);
+	TEST_ASSERT_EQUAL_UINT32(DRAIN_CONFIRM_TIMEOUT_MS - 500, drain_inflight_next_ms(1500));
+
+	/* Failed: the retry, earlier than the timeout */
+	drain_inflight_sent(2, 103, 3, 2000);
+	drain_inflight_fail(2, 2000);
+	TEST_ASSERT_EQUAL_UINT32(DRAIN_RETRY_BASE_MS - 1000, drain_inflight_next_ms(3000));
+	TEST_ASSERT_EQUAL_UINT32(0, drain_inflight_next_ms(2000 + DRAIN_RETRY_BASE_MS));
+
+	/* Timed out but not yet collected */
+	drain_inflight_init();
+	drain_inflight_sent(3, 106, 3, 5000);
+	TEST_ASSERT_EQUAL_UINT32(0, drain_inflight_next_ms(5000 + DRAIN_CONFIRM_TIMEOUT_MS));
+}
+
+static void test_drop_releases_slot(void)
+{
+	uint32_t first;
+	uint8_t count;
+
+	drain_inflight_sent(1, 100, 5, 0);
+	drain_inflight_fail(1, 0);
+	int slot = drain_inflight_due(DRAIN_RETRY_BASE_MS, &first, &count);
+	drain_inflight_drop(slot);
+	TEST_ASSERT_EQUAL_UINT8(0, drain_inflight_count());
+}
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_confirm_frees_slot);
+	RUN_TEST(test_zero_msg_id_is_not_tracked);
+	RUN_TEST(test_table_full_blocks_new_frames);
+	RUN_TEST(test_fail_schedules_retry_after_backoff);
+	RUN_TEST(test_backoff_doubles_and_caps);
+	RUN_TEST(test_unconfirmed_frame_times_out);
+	RUN_TEST(test_late_confirm_clears_retry);
+	RUN_TEST(test_oldest_due_range_first);
+	RUN_TEST(test_partial_retransmit_keeps_remainder_due);
+	RUN_TEST(test_resend_skips_acked_entries);
+	RUN_TEST(test_drop_releases_slot);
+	RUN_TEST(test_next_ms_tracks_earliest_slot);
+	return UNITY_END();
+}
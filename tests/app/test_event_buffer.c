@@ -1,11 +1,14 @@
 /*
  * Unit tests for event_buffer module (TASK-034)
  *
- * Tests: insert, wrap, get_latest, trim by watermark, edge cases.
+ * Tests: insert, wrap, get_latest, trim by watermark, edge cases,
+ * delta-encoding round trips, sequence cursors, and an entries-per-byte
+ * benchmark.
  */
 
 #include "unity.h"
 #include "event_buffer.h"
+#include <stdio.h>
 #include <string.h>
 
 void setUp(void) { event_buffer_init(); }
@@ -29,7 +32,7 @@ static struct event_snapshot make_snap(uint32_t ts, uint8_t state)
 
 void test_empty_buffer_count_is_zero(void)
 {
-	TEST_ASSERT_EQUAL_UINT8(0, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(0, event_buffer_count());
 }
 
 void test_empty_buffer_get_latest_returns_false(void)
@@ -49,7 +52,7 @@ void test_add_one_entry(void)
 	struct event_snapshot snap = make_snap(1000, 1);
 	event_buffer_add(&snap);
 
-	TEST_ASSERT_EQUAL_UINT8(1, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(1, event_buffer_count());
 	TEST_ASSERT_EQUAL_UINT32(1000, event_buffer_oldest_timestamp());
 	TEST_ASSERT_EQUAL_UINT32(1000, event_buffer_newest_timestamp());
 }
@@ -74,7 +77,7 @@ void test_add_fills_to_capacity(void)
 		event_buffer_add(&s);
 	}
 
-	TEST_ASSERT_EQUAL_UINT8(EVENT_BUFFER_CAPACITY, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(EVENT_BUFFER_CAPACITY, event_buffer_count());
 	TEST_ASSERT_EQUAL_UINT32(1, event_buffer_oldest_timestamp());
 	TEST_ASSERT_EQUAL_UINT32(EVENT_BUFFER_CAPACITY, event_buffer_newest_timestamp());
 }
@@ -91,7 +94,7 @@ void test_wrap_overwrites_oldest(void)
 	struct event_snapshot extra = make_snap(EVENT_BUFFER_CAPACITY + 1, 2);
 	event_buffer_add(&extra);
 
-	TEST_ASSERT_EQUAL_UINT8(EVENT_BUFFER_CAPACITY, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(EVENT_BUFFER_CAPACITY, event_buffer_count());
 	TEST_ASSERT_EQUAL_UINT32(2, event_buffer_oldest_timestamp());
 	TEST_ASSERT_EQUAL_UINT32(EVENT_BUFFER_CAPACITY + 1, event_buffer_newest_timestamp());
 }
@@ -104,7 +107,7 @@ void test_wrap_multiple_overwrites(void)
 		event_buffer_add(&s);
 	}
 
-	TEST_ASSERT_EQUAL_UINT8(EVENT_BUFFER_CAPACITY, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(EVENT_BUFFER_CAPACITY, event_buffer_count());
 	TEST_ASSERT_EQUAL_UINT32(11, event_buffer_oldest_timestamp());
 	TEST_ASSERT_EQUAL_UINT32(EVENT_BUFFER_CAPACITY + 10, event_buffer_newest_timestamp());
 }
@@ -119,7 +122,7 @@ void test_trim_removes_old_entries(void)
 	/* Trim everything at or before timestamp 500 */
 	event_buffer_trim(500);
 
-	TEST_ASSERT_EQUAL_UINT8(5, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(5, event_buffer_count());
 	TEST_ASSERT_EQUAL_UINT32(600, event_buffer_oldest_timestamp());
 	TEST_ASSERT_EQUAL_UINT32(1000, event_buffer_newest_timestamp());
 }
@@ -134,7 +137,7 @@ void test_trim_all_entries(void)
 	/* Watermark newer than all entries */
 	event_buffer_trim(100);
 
-	TEST_ASSERT_EQUAL_UINT8(0, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(0, event_buffer_count());
 	TEST_ASSERT_EQUAL_UINT32(0, event_buffer_oldest_timestamp());
 }
 
@@ -148,7 +151,7 @@ void test_trim_no_entries_when_watermark_older(void)
 	/* Watermark older than all entries — nothing trimmed */
 	event_buffer_trim(50);
 
-	TEST_ASSERT_EQUAL_UINT8(5, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(5, event_buffer_count());
 	TEST_ASSERT_EQUAL_UINT32(100, event_buffer_oldest_timestamp());
 }
 
@@ -156,7 +159,7 @@ void test_trim_empty_buffer(void)
 {
 	/* Should not crash */
 	event_buffer_trim(1000);
-	TEST_ASSERT_EQUAL_UINT8(0, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(0, event_buffer_count());
 }
 
 void test_trim_exact_watermark(void)
@@ -169,7 +172,7 @@ void test_trim_exact_watermark(void)
 
 	event_buffer_trim(100);
 
-	TEST_ASSERT_EQUAL_UINT8(1, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(1, event_buffer_count());
 	TEST_ASSERT_EQUAL_UINT32(200, event_buffer_oldest_timestamp());
 }
 
@@ -181,15 +184,15 @@ void test_trim_after_wrap(void)
 		event_buffer_add(&s);
 	}
 
-	/* Oldest should be entry #6 (timestamp 60), newest #55 (timestamp 550) */
+	/* Oldest should be entry #6 (timestamp 60) */
 	TEST_ASSERT_EQUAL_UINT32(60, event_buffer_oldest_timestamp());
 
 	/* Trim up to 200 — removes entries 60..200 (15 entries: 60,70,...,200) */
 	event_buffer_trim(200);
 
 	TEST_ASSERT_EQUAL_UINT32(210, event_buffer_oldest_timestamp());
-	TEST_ASSERT_EQUAL_UINT32(550, event_buffer_newest_timestamp());
-	TEST_ASSERT_EQUAL_UINT8(35, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT32((EVENT_BUFFER_CAPACITY + 5) * 10, event_buffer_newest_timestamp());
+	TEST_ASSERT_EQUAL_UINT16(EVENT_BUFFER_CAPACITY - 15, event_buffer_count());
 }
 
 void test_add_after_trim(void)
@@ -200,13 +203,13 @@ void test_add_after_trim(void)
 	}
 
 	event_buffer_trim(3);
-	TEST_ASSERT_EQUAL_UINT8(2, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(2, event_buffer_count());
 
 	/* Add more after trim */
 	struct event_snapshot s = make_snap(10, 2);
 	event_buffer_add(&s);
 
-	TEST_ASSERT_EQUAL_UINT8(3, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(3, event_buffer_count());
 	TEST_ASSERT_EQUAL_UINT32(4, event_buffer_oldest_timestamp());
 	TEST_ASSERT_EQUAL_UINT32(10, event_buffer_newest_timestamp());
 }
@@ -214,7 +217,7 @@ void test_add_after_trim(void)
 void test_null_snap_ignored(void)
 {
 	event_buffer_add(NULL);
-	TEST_ASSERT_EQUAL_UINT8(0, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(0, event_buffer_count());
 }
 
 void test_null_out_returns_false(void)
@@ -251,10 +254,447 @@ void test_reinit_clears_buffer(void)
 {
 	struct event_snapshot s = make_snap(100, 1);
 	event_buffer_add(&s);
-	TEST_ASSERT_EQUAL_UINT8(1, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(1, event_buffer_count());
 
 	event_buffer_init();
-	TEST_ASSERT_EQUAL_UINT8(0, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(0, event_buffer_count());
+}
+
+/* --- Delta encoding --- */
+
+static void assert_snap_equal(const struct event_snapshot *exp,
+			      const struct event_snapshot *act)
+{
+	TEST_ASSERT_EQUAL_UINT32(exp->timestamp, act->timestamp);
+	TEST_ASSERT_EQUAL_UINT16(exp->pilot_voltage_mv, act->pilot_voltage_mv);
+	TEST_ASSERT_EQUAL_UINT16(exp->current_ma, act->current_ma);
+	TEST_ASSERT_EQUAL_UINT8(exp->j1772_state, act->j1772_state);
+	TEST_ASSERT_EQUAL_UINT8(exp->thermostat_flags, act->thermostat_flags);
+	TEST_ASSERT_EQUAL_UINT8(exp->charge_flags, act->charge_flags);
+	TEST_ASSERT_EQUAL_UINT8(exp->transition_reason, act->transition_reason);
+}
+
+void test_peek_at_round_trips_every_field(void)
+{
+	struct event_snapshot in[] = {
+		{ 1000,    2980,     0, 1, 0x00, 0x01, 0 },
+		{ 1000,    2234,     0, 2, 0x00, 0x01, 0 },   /* same second */
+		{ 1002,    1489, 32000, 3, 0x02, 0x01, 0 },
+		{ 1302,    1490, 31850, 3, 0x02, 0x01, 0 },
+		{ 1602,    1488, 31990, 3, 0x02, 0x01, 0 },   /* repeated delta */
+		{ 90000,   2234,     0, 2, 0x00, 0x00, 2 },   /* large gap */
+		{ 500,        0, 65535, 6, 0xFF, 0xFF, 255 }, /* clock stepped back */
+		{ 0xFFFFFFFFu, 65535, 0, 0, 0x00, 0x00, 0 },
+	};
+	uint16_t n = sizeof(in) / sizeof(in[0]);
+
+	for (uint16_t i = 0; i < n; i++) {
+		event_buffer_add(&in[i]);
+	}
+
+	TEST_ASSERT_EQUAL_UINT16(n, event_buffer_count());
+	for (uint16_t i = 0; i < n; i++) {
+		struct event_snapshot out;
+		TEST_ASSERT_TRUE(event_buffer_peek_at(i, &out));
+		assert_snap_equal(&in[i], &out);
+	}
+}
+
+void test_unchanged_heartbeat_costs_one_byte(void)
+{
+	for (uint32_t i = 0; i < 10; i++) {
+		struct event_snapshot s = make_snap(1000 + i * 300, 1);
+		event_buffer_add(&s);
+	}
+
+	/* Entry 0 is held decoded; entry 1 carries a 2-byte varint delta;
+	 * entries 2..9 repeat that delta and are header-only. */
+	TEST_ASSERT_EQUAL_UINT16(10, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(3 + 8, event_buffer_bytes_used());
+}
+
+void test_byte_budget_evicts_oldest(void)
+{
+	/* Every entry changes every field — records are far larger than
+	 * one byte, so the byte ring fills long before the entry cap. */
+	uint32_t ts = 100;
+	for (uint32_t i = 0; i < EVENT_BUFFER_CAPACITY; i++) {
+		struct event_snapshot s = {0};
+		ts += 200 + (i % 2) * 100;
+		s.timestamp = ts;
+		s.pilot_voltage_mv = (i % 2) ? 2980 : 1489;
+		s.current_ma = (i % 2) ? 0 : 30000;
+		s.j1772_state = (i % 2) ? 1 : 3;
+		s.charge_flags = (i % 2);
+		event_buffer_add(&s);
+	}
+
+	TEST_ASSERT_TRUE(event_buffer_count() < EVENT_BUFFER_CAPACITY);
+	TEST_ASSERT_TRUE(event_buffer_bytes_used() <= EVENT_BUFFER_BYTES);
+	TEST_ASSERT_EQUAL_UINT32(ts, event_buffer_newest_timestamp());
+
+	/* Still decodes correctly after many evictions and ring wraps */
+	struct event_snapshot last;
+	TEST_ASSERT_TRUE(event_buffer_peek_at(event_buffer_count() - 1, &last));
+	TEST_ASSERT_EQUAL_UINT32(ts, last.timestamp);
+
+	struct event_snapshot prev;
+	TEST_ASSERT_TRUE(event_buffer_peek_at(event_buffer_count() - 2, &prev));
+	TEST_ASSERT_TRUE(prev.timestamp < ts);
+	TEST_ASSERT_NOT_EQUAL(prev.j1772_state, last.j1772_state);
+}
+
+void test_trim_then_refill_after_wrap(void)
+{
+	for (uint32_t i = 0; i < EVENT_BUFFER_CAPACITY * 2; i++) {
+		struct event_snapshot s = make_snap(i * 7 + 1, (uint8_t)(1 + i % 3));
+		s.pilot_voltage_mv = (uint16_t)(2000 + (i % 3) * 450);
+		event_buffer_add(&s);
+	}
+
+	uint32_t newest = event_buffer_newest_timestamp();
+	event_buffer_trim(newest - 70);
+	TEST_ASSERT_EQUAL_UINT16(10, event_buffer_count());
+
+	for (uint16_t i = 0; i < event_buffer_count(); i++) {
+		struct event_snapshot out;
+		uint32_t n = (newest - 1) / 7 - 9 + i;
+		TEST_ASSERT_TRUE(event_buffer_peek_at(i, &out));
+		TEST_ASSERT_EQUAL_UINT32(n * 7 + 1, out.timestamp);
+		TEST_ASSERT_EQUAL_UINT8(1 + n % 3, out.j1772_state);
+		TEST_ASSERT_EQUAL_UINT16(2000 + (n % 3) * 450, out.pilot_voltage_mv);
+	}
+}
+
+/* --- Sequence cursors --- */
+
+void test_cursor_reads_in_order(void)
+{
+	for (uint32_t i = 0; i < 5; i++) {
+		struct event_snapshot s = make_snap((i + 1) * 100, (uint8_t)i);
+		event_buffer_add(&s);
+	}
+
+	event_buffer_cursor_t cur;
+	event_buffer_cursor_init(&cur);
+	TEST_ASSERT_EQUAL_UINT16(5, event_buffer_cursor_remaining(&cur));
+
+	for (uint32_t i = 0; i < 5; i++) {
+		struct event_snapshot out;
+		TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));
+		TEST_ASSERT_EQUAL_UINT32((i + 1) * 100, out.timestamp);
+		TEST_ASSERT_EQUAL_UINT8(i, out.j1772_state);
+		event_buffer_cursor_advance(&cur);
+	}
+
+	struct event_snapshot out;
+	TEST_ASSERT_FALSE(event_buffer_cursor_peek(&cur, &out));
+	TEST_ASSERT_EQUAL_UINT16(0, event_buffer_cursor_remaining(&cur));
+
+	/* New entries become readable without re-init */
+	struct event_snapshot s = make_snap(600, 2);
+	event_buffer_add(&s);
+	TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));
+	TEST_ASSERT_EQUAL_UINT32(600, out.timestamp);
+}
+
+void test_cursor_stable_across_partial_trim(void)
+{
+	for (uint32_t i = 0; i < 6; i++) {
+		struct event_snapshot s = make_snap((i + 1) * 100, 1);
+		event_buffer_add(&s);
+	}
+
+	event_buffer_cursor_t cur;
+	event_buffer_cursor_init(&cur);
+	struct event_snapshot out;
+	for (int i = 0; i < 3; i++) {
+		TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));
+		event_buffer_cursor_advance(&cur);
+	}
+
+	/* ACK covers only the first entry — cursor must not move back */
+	event_buffer_trim(100);
+	TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));
+	TEST_ASSERT_EQUAL_UINT32(400, out.timestamp);
+	TEST_ASSERT_EQUAL_UINT16(3, event_buffer_cursor_remaining(&cur));
+}
+
+void test_cursor_skips_forward_past_trimmed_entries(void)
+{
+	for (uint32_t i = 0; i < 6; i++) {
+		struct event_snapshot s = make_snap((i + 1) * 100, 1);
+		event_buffer_add(&s);
+	}
+
+	event_buffer_cursor_t cur;
+	event_buffer_cursor_init(&cur);
+
+	/* Cloud already has entries the cursor never read */
+	event_buffer_trim(400);
+
+	struct event_snapshot out;
+	TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));
+	TEST_ASSERT_EQUAL_UINT32(500, out.timestamp);
+	TEST_ASSERT_EQUAL_UINT32(event_buffer_oldest_seq(), cur.seq);
+}
+
+void test_cursor_survives_full_trim_and_overflow(void)
+{
+	event_buffer_cursor_t cur;
+	event_buffer_cursor_init(&cur);
+
+	for (uint32_t i = 0; i < 4; i++) {
+		struct event_snapshot s = make_snap((i + 1) * 10, 1);
+		event_buffer_add(&s);
+	}
+	struct event_snapshot out;
+	TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));
+	event_buffer_cursor_advance(&cur);
+	TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));  /* caches entry 1 */
+
+	event_buffer_trim(1000);
+	TEST_ASSERT_FALSE(event_buffer_cursor_peek(&cur, &out));
+
+	/* Overflow past the entry cap; cursor lands on the oldest survivor */
+	for (uint32_t i = 0; i < EVENT_BUFFER_CAPACITY + 3; i++) {
+		struct event_snapshot s = make_snap(2000 + i, 3);
+		event_buffer_add(&s);
+	}
+	TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));
+	TEST_ASSERT_EQUAL_UINT32(2003, out.timestamp);
+	TEST_ASSERT_EQUAL_UINT8(3, out.j1772_state);
+	TEST_ASSERT_EQUAL_UINT16(EVENT_BUFFER_CAPACITY, event_buffer_cursor_remaining(&cur));
+
+	/* Sequential reads through the cache match random access */
+	for (uint16_t i = 0; i < EVENT_BUFFER_CAPACITY; i += 37) {
+		struct event_snapshot direct;
+		cur.seq = event_buffer_oldest_seq() + i;
+		TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));
+		TEST_ASSERT_TRUE(event_buffer_peek_at(i, &direct));
+		assert_snap_equal(&direct, &out);
+	}
+}
+
+void test_trim_is_tail_advance_only(void)
+{
+	for (uint32_t i = 0; i < 20; i++) {
+		struct event_snapshot s = make_snap((i + 1) * 100, (uint8_t)(i % 3));
+		event_buffer_add(&s);
+	}
+	uint16_t bytes = event_buffer_bytes_used();
+	uint32_t seq = event_buffer_oldest_seq();
+
+	event_buffer_trim(500);
+	TEST_ASSERT_EQUAL_UINT32(seq + 5, event_buffer_oldest_seq());
+	TEST_ASSERT_TRUE(event_buffer_bytes_used() < bytes);
+
+	/* Full ACK empties the ring in one step; sequence keeps counting */
+	event_buffer_trim(2000);
+	TEST_ASSERT_EQUAL_UINT16(0, event_buffer_count());
+	TEST_ASSERT_EQUAL_UINT16(0, event_buffer_bytes_used());
+	TEST_ASSERT_EQUAL_UINT32(seq + 20, event_buffer_oldest_seq());
+}
+
+void test_trim_later_waits_for_pending(void)
+{
+	for (uint32_t i = 0; i < 6; i++) {
+		struct event_snapshot s = make_snap((i + 1) * 100, 1);
+		event_buffer_add(&s);
+	}
+	TEST_ASSERT_FALSE(event_buffer_trim_pending());
+
+	/* Requested from the Sidewalk thread: nothing moves until applied */
+	event_buffer_trim_later(200);
+	event_buffer_trim_later(300);
+	TEST_ASSERT_EQUAL_UINT16(6, event_buffer_count());
+
+	/* The latest watermark wins, once */
+	TEST_ASSERT_TRUE(event_buffer_trim_pending());
+	TEST_ASSERT_EQUAL_UINT32(400, event_buffer_oldest_timestamp());
+	TEST_ASSERT_FALSE(event_buffer_trim_pending());
+	TEST_ASSERT_EQUAL_UINT16(3, event_buffer_count());
+}
+
+void test_cursor_rejects_stale_cache_offset(void)
+{
+	for (uint32_t i = 0; i < 8; i++) {
+		struct event_snapshot s = make_snap((i + 1) * 100, (uint8_t)(i % 3));
+		event_buffer_add(&s);
+	}
+
+	event_buffer_cursor_t cur;
+	struct event_snapshot out;
+	event_buffer_cursor_init(&cur);
+	cur.seq = event_buffer_oldest_seq() + 2;
+	TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));
+
+	/* Trim everything, refill fewer bytes: the cached sequence is
+	 * buffered again but its offset lies past the used bytes */
+	event_buffer_trim(1000);
+	for (uint32_t i = 0; i < 3; i++) {
+		struct event_snapshot s = make_snap(2000 + i * 100, 2);
+		event_buffer_add(&s);
+	}
+	cur.seq = event_buffer_oldest_seq();
+	cur.cache_seq = cur.seq;
+	TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));
+	TEST_ASSERT_EQUAL_UINT32(2000, out.timestamp);
+
+	event_buffer_cursor_advance(&cur);
+	TEST_ASSERT_TRUE(event_buffer_cursor_peek(&cur, &out));
+	TEST_ASSERT_EQUAL_UINT32(2100, out.timestamp);
+}
+
+/* --- Benchmark: entries per byte on charge-session traces --- */
+
+/*
+ * Traces are generated deterministically from the field behaviour
+ * recorded in EXP-013 and the device_events table: heartbeats every
+ * 5 min with a few mV of pilot jitter, plug-in / charge / TOU pause
+ * sessions with ~300 mA current wander, and a wandering-pilot fault day
+ * that flips state every 1-3 s.
+ */
+
+#define TRACE_MAX  1200
+
+static struct event_snapshot trace[TRACE_MAX];
+static uint16_t trace_len;
+static uint32_t lcg_state;
+
+static uint32_t lcg(void)
+{
+	lcg_state = lcg_state * 1103515245u + 12345u;
+	return (lcg_state >> 16) & 0x7FFF;
+}
+
+static void trace_push(uint32_t ts, uint16_t mv, uint16_t ma, uint8_t state,
+		       uint8_t charge_flags, uint8_t reason)
+{
+	if (trace_len < TRACE_MAX) {
+		struct event_snapshot *s = &trace[trace_len++];
+		s->timestamp = ts;
+		s->pilot_voltage_mv = mv;
+		s->current_ma = ma;
+		s->j1772_state = state;
+		s->thermostat_flags = 0;
+		s->charge_flags = charge_flags;
+		s->transition_reason = reason;
+	}
+}
+
+static uint32_t trace_heartbeats(uint32_t ts, uint16_t n, uint16_t mv,
+				 uint16_t ma, uint8_t state, uint8_t charge_flags)
+{
+	for (uint16_t i = 0; i < n; i++) {
+		/* 500ms tick alignment makes the odd interval 301 s */
+		ts += (lcg() % 8 == 0) ? 301 : 300;
+		uint16_t jitter_mv = (uint16_t)(lcg() % 9);
+		uint16_t amps = ma ? (uint16_t)(ma - 300 + lcg() % 600) : 0;
+		trace_push(ts, (uint16_t)(mv - 4 + jitter_mv), amps, state, charge_flags, 0);
+	}
+	return ts;
+}
+
+static void gen_idle_day(void)
+{
+	trace_len = 0;
+	lcg_state = 1;
+	trace_heartbeats(4000000, 288, 2980, 0, 1, 1);
+}
+
+static void gen_charge_sessions(void)
+{
+	trace_len = 0;
+	lcg_state = 2;
+	uint32_t ts = 4000000;
+
+	for (int day = 0; day < 3; day++) {
+		ts = trace_heartbeats(ts, 200, 2980, 0, 1, 1);         /* idle, state A */
+		ts += 37;
+		trace_push(ts, 2234, 0, 2, 1, 0);                         /* plug in: B */
+		ts += 3;
+		trace_push(ts, 1489, 31800, 3, 1, 0);                     /* charging: C */
+		ts = trace_heartbeats(ts, 12, 1489, 32000, 3, 1);
+		ts += 120;
+		trace_push(ts, 2234, 0, 2, 0, 2);                         /* TOU pause */
+		ts = trace_heartbeats(ts, 48, 2234, 0, 2, 0);
+		ts += 2;
+		trace_push(ts, 1489, 31900, 3, 1, 2);                     /* TOU resume */
+		ts = trace_heartbeats(ts, 30, 1489, 32000, 3, 1);
+		ts += 55;
+		trace_push(ts, 2234, 0, 2, 1, 0);                         /* full: B */
+		ts = trace_heartbeats(ts, 40, 2234, 0, 2, 1);
+		ts += 900;
+		trace_push(ts, 2980, 0, 1, 1, 0);                         /* unplug: A */
+	}
+}
+
+static void gen_wandering_pilot(void)
+{
+	static const uint16_t state_mv[] = { 2980, 2234, 1489, 745, 0 };
+	trace_len = 0;
+	lcg_state = 3;
+	uint32_t ts = 4000000;
+
+	for (uint16_t i = 0; i < 600; i++) {
+		uint8_t st = (uint8_t)(lcg() % 5);
+		ts += 1 + lcg() % 3;
+		trace_push(ts, (uint16_t)(state_mv[st] + lcg() % 200),
+			   (uint16_t)(lcg() % 4000), (uint8_t)(st + 1), 1, 0);
+	}
+}
+
+static void bench_trace(const char *name, void (*gen)(void))
+{
+	gen();
+	event_buffer_init();
+	for (uint16_t i = 0; i < trace_len; i++) {
+		event_buffer_add(&trace[i]);
+	}
+
+	uint16_t cnt = event_buffer_count();
+	uint16_t bytes = event_buffer_bytes_used();
+	TEST_ASSERT_TRUE(cnt > 1);
+
+	/* Retained window must decode back to the tail of the trace */
+	for (uint16_t i = 0; i < cnt; i++) {
+		struct event_snapshot out;
+		TEST_ASSERT_TRUE(event_buffer_peek_at(i, &out));
+		assert_snap_equal(&trace[trace_len - cnt + i], &out);
+	}
+
+	/* The ring holds cnt-1 records; base+head add 2 decoded snapshots */
+	float per_byte = (float)(cnt - 1) / (float)(bytes ? bytes : 1);
+	uint16_t fits = (uint16_t)(per_byte * EVENT_BUFFER_BYTES) + 1;
+	if (fits > EVENT_BUFFER_CAPACITY) {
+		fits = EVENT_BUFFER_CAPACITY;
+	}
+	printf("  %-16s %4u/%4u entries kept, %3u B ring: %.3f entries/byte "
+	       "(flat 12B: %.3f), ~%u entries per %u B (was %u)\n",
+	       name, cnt, trace_len, bytes, per_byte,
+	       1.0f / sizeof(struct event_snapshot), fits,
+	       EVENT_BUFFER_BYTES, EVENT_BUFFER_BYTES / (unsigned)sizeof(struct event_snapshot));
+}
+
+void test_bench_entries_per_byte(void)
+{
+	printf("\n");
+	bench_trace("idle_day", gen_idle_day);
+	uint16_t idle = event_buffer_count();
+
+	bench_trace("charge_sessions", gen_charge_sessions);
+	uint16_t sessions = event_buffer_count();
+
+	bench_trace("wandering_pilot", gen_wandering_pilot);
+	uint16_t wandering = event_buffer_count();
+
+	/* Versus the flat 50-entry layout: idle heartbeats >= 5x, charge
+	 * sessions (current wander on every heartbeat) >= 4x, and the
+	 * fault-day worst case, where every field changes, >= 1.5x. */
+	TEST_ASSERT_TRUE(idle >= 250);
+	TEST_ASSERT_TRUE(sessions >= 200);
+	TEST_ASSERT_TRUE(wandering >= 75);
 }
 
 /* --- Runner --- */
@@ -281,5 +721,17 @@ int main(void)
 	RUN_TEST(test_null_out_returns_false);
 	RUN_TEST(test_snapshot_fields_preserved);
 	RUN_TEST(test_reinit_clears_buffer);
+	RUN_TEST(test_peek_at_round_trips_every_field);
+	RUN_TEST(test_unchanged_heartbeat_costs_one_byte);
+	RUN_TEST(test_byte_budget_evicts_oldest);
+	RUN_TEST(test_trim_then_refill_after_wrap);
+	RUN_TEST(test_cursor_reads_in_order);
+	RUN_TEST(test_cursor_stable_across_partial_trim);
+	RUN_TEST(test_cursor_skips_forward_past_trimmed_entries);
+	RUN_TEST(test_cursor_survives_full_trim_and_overflow);
+	RUN_TEST(test_trim_is_tail_advance_only);
+	RUN_TEST(test_trim_later_waits_for_pending);
+	RUN_TEST(test_cursor_rejects_stale_cache_offset);
+	RUN_TEST(test_bench_entries_per_byte);
 	return UNITY_END();
 }
@@ -0,0 +1,314 @@
+/*
+ * Host-side tests for the persistent event log (platform module).
+ *
+ * Runs event_log.c + ota_flash.c against the RAM-backed mock flash,
+ * simulating reboots with event_log_init() and power loss by tearing
+ * slots directly in mock_flash_mem.
+ */
+
+#include "unity.h"
+#include <event_log.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+extern uint8_t mock_flash_mem[];
+extern int mock_flash_read_count;
+extern int mock_flash_write_count;
+extern int mock_flash_erase_count;
+extern void mock_flash_reset(void);
+
+#define MOCK_FLASH_BASE 0x90000
+
+/* 12-byte record shaped like struct event_snapshot: key first */
+struct test_rec {
+	uint32_t key;
+	uint8_t  body[8];
+};
+
+static int append_key(uint32_t key)
+{
+	struct test_rec r;
+	r.key = key;
+	memset(r.body, (uint8_t)key, sizeof(r.body));
+	return event_log_append(&r, sizeof(r));
+}
+
+static uint32_t read_key(uint32_t index)
+{
+	struct test_rec r;
+	TEST_ASSERT_EQUAL_INT(0, event_log_read(index, &r, sizeof(r)));
+	TEST_ASSERT_EQUAL_UINT8((uint8_t)r.key, r.body[7]);
+	return r.key;
+}
+
+static uint8_t *slot_mem(uint32_t page, uint32_t slot)
+{
+	return &mock_flash_mem[EVENT_LOG_FLASH_ADDR - MOCK_FLASH_BASE +
+			       page * OTA_FLASH_PAGE_SIZE + slot * EVENT_LOG_SLOT_SIZE];
+}
+
+void setUp(void)
+{
+	mock_flash_reset();
+	event_log_init();
+}
+
+void tearDown(void) { }
+
+/* ------------------------------------------------------------------ */
+/*  Basics                                                             */
+/* ------------------------------------------------------------------ */
+
+static void test_empty_log(void)
+{
+	struct test_rec r;
+	TEST_ASSERT_EQUAL_UINT32(0, event_log_count());
+	TEST_ASSERT_EQUAL_INT(-ENOENT, event_log_read(0, &r, sizeof(r)));
+}
+
+static void test_append_read_in_order(void)
+{
+	for (uint32_t k = 1; k <= 20; k++) {
+		TEST_ASSERT_EQUAL_INT(0, append_key(k));
+	}
+	TEST_ASSERT_EQUAL_UINT32(20, event_log_count());
+	for (uint32_t i = 0; i < 20; i++) {
+		TEST_ASSERT_EQUAL_UINT32(i + 1, read_key(i));
+	}
+}
+
+static void test_bad_length_rejected(void)
+{
+	uint8_t big[EVENT_LOG_RECORD_MAX + 1] = {0};
+	TEST_ASSERT_EQUAL_INT(-EINVAL, event_log_append(big, sizeof(big)));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, event_log_append(big, 0));
+	TEST_ASSERT_EQUAL_UINT32(0, event_log_count());
+}
+
+static void test_one_aligned_program_per_record(void)
+{
+	append_key(1);  /* first append also writes the page header */
+	int writes = mock_flash_write_count;
+	int erases = mock_flash_erase_count;
+
+	for (uint32_t k = 2; k <= 50; k++) {
+		append_key(k);
+	}
+	TEST_ASSERT_EQUAL_INT(49, mock_flash_write_count - writes);
+	TEST_ASSERT_EQUAL_INT(0, mock_flash_erase_count - erases);
+}
+
+static void test_sequential_read_is_constant_cost(void)
+{
+	for (uint32_t k = 1; k <= 600; k++) {
+		append_key(k);
+	}
+	int reads = mock_flash_read_count;
+	for (uint32_t i = 0; i < 600; i++) {
+		read_key(i);
+	}
+	/* One slot read per record, plus a page header hop now and then */
+	TEST_ASSERT_LESS_OR_EQUAL_INT(600 + 8, mock_flash_read_count - reads);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Reboot and power loss                                              */
+/* ------------------------------------------------------------------ */
+
+static void test_records_survive_reboot(void)
+{
+	for (uint32_t k = 1; k <= 300; k++) {
+		append_key(k);
+	}
+	TEST_ASSERT_EQUAL_INT(0, event_log_init());
+	TEST_ASSERT_EQUAL_UINT32(300, event_log_count());
+	TEST_ASSERT_EQUAL_UINT32(1, read_key(0));
+	TEST_ASSERT_EQUAL_UINT32(300, read_key(299));
+
+	/* Appends after reboot continue behind the existing records */
+	append_key(301);
+	TEST_ASSERT_EQUAL_UINT32(301, read_key(300));
+}
+
+static void test_torn_append_skipped(void)
+{
+	for (uint32_t k = 1; k <= 5; k++) {
+		append_key(k);
+	}
+	/* Power lost mid-program of record 5: half the slot still erased */
+	memset(slot_mem(0, 5) + 8, 0xFF, 8);
+
+	event_log_init();
+	TEST_ASSERT_EQUAL_UINT32(4, event_log_count());
+
+	/* The torn slot is never reused; the next append lands after it */
+	append_key(6);
+	TEST_ASSERT_EQUAL_UINT32(5, event_log_count());
+	TEST_ASSERT_EQUAL_UINT32(4, read_key(3));
+	TEST_ASSERT_EQUAL_UINT32(6, read_key(4));
+
+	event_log_init();
+	TEST_ASSERT_EQUAL_UINT32(5, event_log_count());
+}
+
+static void test_trim_persists_across_reboot(void)
+{
+	for (uint32_t k = 1; k <= 100; k++) {
+		append_key(k);
+	}
+	TEST_ASSERT_EQUAL_INT(0, event_log_trim(60));
+	TEST_ASSERT_EQUAL_UINT32(40, event_log_count());
+	TEST_ASSERT_EQUAL_UINT32(61, read_key(0));
+
+	event_log_init();
+	TEST_ASSERT_EQUAL_UINT32(40, event_log_count());
+	TEST_ASSERT_EQUAL_UINT32(61, read_key(0));
+}
+
+static void test_trim_never_regresses(void)
+{
+	for (uint32_t k = 1; k <= 10; k++) {
+		append_key(k);
+	}
+	event_log_trim(8);
+	event_log_trim(3);
+	TEST_ASSERT_EQUAL_UINT32(2, event_log_count());
+}
+
+static void test_trim_all_then_append(void)
+{
+	for (uint32_t k = 1; k <= 10; k++) {
+		append_key(k);
+	}
+	event_log_trim(10);
+	TEST_ASSERT_EQUAL_UINT32(0, event_log_count());
+
+	append_key(11);
+	TEST_ASSERT_EQUAL_UINT32(1, event_log_count());
+	TEST_ASSERT_EQUAL_UINT32(11, read_key(0));
+}
+
+static void test_clock_step_back_keeps_new_records(void)
+{
+	for (uint32_t k = 1001; k <= 1010; k++) {
+		append_key(k);
+	}
+	event_log_trim(1005);
+
+	/* The clock stepped back: newer records carry older keys */
+	append_key(200);
+	append_key(201);
+	TEST_ASSERT_EQUAL_UINT32(7, event_log_count());
+	TEST_ASSERT_EQUAL_UINT32(1006, read_key(0));
+	TEST_ASSERT_EQUAL_UINT32(201, read_key(6));
+
+	/* ...and are still there after a reboot */
+	event_log_init();
+	TEST_ASSERT_EQUAL_UINT32(7, event_log_count());
+	TEST_ASSERT_EQUAL_UINT32(200, read_key(5));
+
+	/* A trim past the old keys stops where the clock stepped back */
+	event_log_trim(1005);
+	TEST_ASSERT_EQUAL_UINT32(7, event_log_count());
+	event_log_trim(1010);
+	TEST_ASSERT_EQUAL_UINT32(2, event_log_count());
+	TEST_ASSERT_EQUAL_UINT32(200, read_key(0));
+
+	/* Once the cloud ACKs them on the new clock, they go too */
+	event_log_trim(201);
+	TEST_ASSERT_EQUAL_UINT32(0, event_log_count());
+	event_log_init();
+	TEST_ASSERT_EQUAL_UINT32(0, event_log_count());
+}
+
+/* ------------------------------------------------------------------ */
+/*  Ring rotation and wear                                             */
+/* ------------------------------------------------------------------ */
+
+static void test_overflow_drops_oldest_page(void)
+{
+	uint32_t total = EVENT_LOG_CAPACITY + 10;
+	for (uint32_t k = 1; k <= total; k++) {
+		append_key(k);
+	}
+	/* Rotating onto the first page dropped its SLOTS_PER_PAGE records */
+	uint32_t expect = total - EVENT_LOG_SLOTS_PER_PAGE;
+	TEST_ASSERT_EQUAL_UINT32(expect, event_log_count());
+	TEST_ASSERT_EQUAL_UINT32(EVENT_LOG_SLOTS_PER_PAGE + 1, read_key(0));
+	TEST_ASSERT_EQUAL_UINT32(total, read_key(expect - 1));
+
+	event_log_init();
+	TEST_ASSERT_EQUAL_UINT32(expect, event_log_count());
+	TEST_ASSERT_EQUAL_UINT32(EVENT_LOG_SLOTS_PER_PAGE + 1, read_key(0));
+}
+
+static void test_watermark_survives_page_recycle(void)
+{
+	for (uint32_t k = 1; k <= 50; k++) {
+		append_key(k);
+	}
+	event_log_trim(50);
+
+	/* Push the page holding the TRIM slot out of the ring */
+	for (uint32_t k = 51; k <= 50 + EVENT_LOG_CAPACITY; k++) {
+		append_key(k);
+	}
+	event_log_init();
+
+	/* Nothing <= 50 resurrected; newest record still last */
+	TEST_ASSERT_TRUE(read_key(0) > 50);
+	TEST_ASSERT_EQUAL_UINT32(50 + EVENT_LOG_CAPACITY,
+				 read_key(event_log_count() - 1));
+}
+
+static void test_bench_erases_per_10k_events(void)
+{
+	int erases = mock_flash_erase_count;
+	int writes = mock_flash_write_count;
+
+	/* Cloud ACKs every 50 events, as TIME_SYNC would */
+	for (uint32_t k = 1; k <= 10000; k++) {
+		TEST_ASSERT_EQUAL_INT(0, append_key(k));
+		if (k % 50 == 0) {
+			event_log_trim(k - 10);
+		}
+	}
+	erases = mock_flash_erase_count - erases;
+	writes = mock_flash_write_count - writes;
+
+	printf("  10k events: %d page erases, %d programs (%d record slots/page)\n",
+	       erases, writes, EVENT_LOG_SLOTS_PER_PAGE);
+
+	/* One erase per filled page; TRIM slots add ~2% */
+	TEST_ASSERT_LESS_OR_EQUAL_INT(10000 / EVENT_LOG_SLOTS_PER_PAGE + 3, erases);
+	TEST_ASSERT_LESS_OR_EQUAL_INT(10000 + 10000 / 50 + erases, writes);
+	TEST_ASSERT_EQUAL_UINT32(10, event_log_count());
+}
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	/* Basics */
+	RUN_TEST(test_empty_log);
+	RUN_TEST(test_append_read_in_order);
+	RUN_TEST(test_bad_length_rejected);
+	RUN_TEST(test_one_aligned_program_per_record);
+	RUN_TEST(test_sequential_read_is_constant_cost);
+
+	/* Reboot and power loss */
+	RUN_TEST(test_records_survive_reboot);
+	RUN_TEST(test_torn_append_skipped);
+	RUN_TEST(test_trim_persists_across_reboot);
+	RUN_TEST(test_trim_never_regresses);
+	RUN_TEST(test_trim_all_then_append);
+	RUN_TEST(test_clock_step_back_keeps_new_records);
+
+	/* Ring rotation and wear */
+	RUN_TEST(test_overflow_drops_oldest_page);
+	RUN_TEST(test_watermark_survives_page_recycle);
+	RUN_TEST(test_bench_erases_per_10k_events);
+
+	return UNITY_END();
+}
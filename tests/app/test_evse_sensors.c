@@ -6,10 +6,15 @@
 #include "mock_platform_api.h"
 #include "app_platform.h"
 #include "evse_sensors.h"
+#include <string.h>
 
 void setUp(void)
 {
+	struct evse_pilot_config cfg;
+
 	platform = mock_platform_api_init();
+	evse_pilot_config_defaults(&cfg);
+	evse_pilot_config_set(&cfg);
 	evse_sensors_init();
 	/* Cancel any leftover simulation */
 	evse_sensors_simulate_state(0, 0);
@@ -115,6 +120,344 @@ void test_adc_error_propagated(void)
 	TEST_ASSERT_EQUAL_INT(-5, evse_pilot_voltage_read(&mv));
 }
 
+/* --- Cached readings (platform API v6+) --- */
+
+void test_pilot_read_uses_cache(void)
+{
+	struct platform_api v6 = *mock_platform_api_get();
+	v6.version = PLATFORM_API_VERSION_ADC_CACHE;
+	platform = &v6;
+
+	mock_adc_values[0] = 2200;
+	uint16_t mv;
+	TEST_ASSERT_EQUAL_INT(0, evse_pilot_voltage_read(&mv));
+	TEST_ASSERT_EQUAL_UINT16(2200, mv);
+	TEST_ASSERT_EQUAL_INT(1, mock_adc_get_count);
+	TEST_ASSERT_EQUAL_INT(0, mock_adc_read_count);
+	platform = mock_platform_api_get();
+}
+
+void test_pilot_read_blocking_before_first_scan(void)
+{
+	mock_adc_values[0] = 2200;
+	mock_adc_no_sample = true;
+	uint16_t mv;
+	TEST_ASSERT_EQUAL_INT(0, evse_pilot_voltage_read(&mv));
+	TEST_ASSERT_EQUAL_UINT16(2200, mv);
+	TEST_ASSERT_EQUAL_INT(1, mock_adc_read_count);
+}
+
+void test_pilot_read_blocking_on_old_platform(void)
+{
+	struct platform_api old = *mock_platform_api_get();
+	old.version = PLATFORM_API_VERSION_ADC_CACHE - 1;
+	platform = &old;
+
+	mock_adc_values[0] = 1500;
+	uint16_t mv;
+	TEST_ASSERT_EQUAL_INT(0, evse_pilot_voltage_read(&mv));
+	TEST_ASSERT_EQUAL_UINT16(1500, mv);
+	TEST_ASSERT_EQUAL_INT(0, mock_adc_get_count);
+	TEST_ASSERT_EQUAL_INT(1, mock_adc_read_count);
+	platform = mock_platform_api_get();
+}
+
+void test_cached_read_error_not_retried_blocking(void)
+{
+	mock_adc_fail[0] = true;
+	uint16_t mv;
+	TEST_ASSERT_EQUAL_INT(-1, evse_pilot_voltage_read(&mv));
+	TEST_ASSERT_EQUAL_INT(0, mock_adc_read_count);
+}
+
+/* --- Burst readings (platform API v6+) --- */
+
+static void set_burst(const int16_t *mv, int n)
+{
+	memcpy(mock_adc_burst, mv, (size_t)n * sizeof(mv[0]));
+	mock_adc_burst_len = n;
+}
+
+void test_pilot_read_uses_burst(void)
+{
+	mock_adc_values[0] = 2200;
+	uint16_t mv;
+	TEST_ASSERT_EQUAL_INT(0, evse_pilot_voltage_read(&mv));
+	TEST_ASSERT_EQUAL_UINT16(2200, mv);
+	TEST_ASSERT_EQUAL_INT(1, mock_adc_burst_count);
+	TEST_ASSERT_EQUAL_INT(0, mock_adc_get_count);
+	TEST_ASSERT_EQUAL_INT(0, mock_adc_read_count);
+}
+
+void test_burst_median_rejects_spikes(void)
+{
+	static const int16_t burst[] = { 2230, 3269, 2240, 2236, 900, 2238, 2232 };
+	set_burst(burst, 7);
+	uint16_t mv;
+	TEST_ASSERT_EQUAL_INT(0, evse_pilot_voltage_read(&mv));
+	TEST_ASSERT_EQUAL_UINT16(2236, mv);
+}
+
+void test_burst_median_of_even_count(void)
+{
+	static const int16_t burst[] = { 1500, 1480, 1490, 1520 };
+	set_burst(burst, 4);
+	uint16_t mv;
+	TEST_ASSERT_EQUAL_INT(0, evse_pilot_voltage_read(&mv));
+	TEST_ASSERT_EQUAL_UINT16(1495, mv);
+}
+
+void test_burst_trimmed_mean(void)
+{
+	struct evse_pilot_config cfg;
+	evse_pilot_config_get(&cfg);
+	cfg.filter = EVSE_PILOT_FILTER_TRIMMED_MEAN;
+	TEST_ASSERT_EQUAL_INT(0, evse_pilot_config_set(&cfg));
+
+	/* Lowest and highest quarter dropped: mean of 1480..1510 */
+	static const int16_t burst[] = { 1500, 3000, 1480, 1490, 400, 1520, 1510, 1000 };
+	set_burst(burst, 8);
+	uint16_t mv;
+	TEST_ASSERT_EQUAL_INT(0, evse_pilot_voltage_read(&mv));
+	TEST_ASSERT_EQUAL_UINT16(1495, mv);
+}
+
+void test_burst_pwm_low_phase_ignored(void)
+{
+	/* 1 kHz PWM at 25% duty: state C high phase, -12V low phase reads 0 */
+	int16_t burst[16] = { 0 };
+	for (int i = 0; i < 4; i++) {
+		burst[i + 5] = 1489;
+	}
+	set_burst(burst, 16);
+
+	j1772_state_t state;
+	uint16_t mv;
+	TEST_ASSERT_EQUAL_INT(0, evse_j1772_state_get(&state, &mv));
+	TEST_ASSERT_EQUAL_UINT16(1489, mv);
+	TEST_ASSERT_EQUAL(J1772_STATE_C, state);
+}
+
+void test_burst_all_low_is_state_e(void)
+{
+	static const int16_t burst[] = { 0, 12, 0, 40, 0, 0, 8, 0 };
+	set_burst(burst, 8);
+
+	j1772_state_t state;
+	TEST_ASSERT_EQUAL_INT(0, evse_j1772_state_get(&state, NULL));
+	TEST_ASSERT_EQUAL(J1772_STATE_E, state);
+}
+
+void test_burst_error_propagated(void)
+{
+	mock_adc_fail[0] = true;
+	j1772_state_t state;
+	TEST_ASSERT_EQUAL_INT(-1, evse_j1772_state_get(&state, NULL));
+	TEST_ASSERT_EQUAL(J1772_STATE_UNKNOWN, state);
+	TEST_ASSERT_EQUAL_INT(0, mock_adc_read_count);
+}
+
+void test_burst_blocking_before_first_scan(void)
+{
+	mock_adc_values[0] = 1500;
+	mock_adc_no_sample = true;
+	uint16_t mv;
+	TEST_ASSERT_EQUAL_INT(0, evse_pilot_voltage_read(&mv));
+	TEST_ASSERT_EQUAL_UINT16(1500, mv);
+	TEST_ASSERT_EQUAL_INT(1, mock_adc_read_count);
+}
+
+/* --- Hysteresis and debounce --- */
+
+/* One reading from a new scan 500ms after the last */
+static j1772_state_t scan(int mv)
+{
+	j1772_state_t state;
+
+	mock_adc_values[0] = mv;
+	mock_uptime_ms += 500;
+	TEST_ASSERT_EQUAL_INT(0, evse_j1772_state_get(&state, NULL));
+	return state;
+}
+
+static j1772_state_t scans(int mv, int n)
+{
+	j1772_state_t state = J1772_STATE_UNKNOWN;
+
+	for (int i = 0; i < n; i++) {
+		state = scan(mv);
+	}
+	return state;
+}
+
+void test_first_reading_accepted_without_debounce(void)
+{
+	TEST_ASSERT_EQUAL(J1772_STATE_C, scan(1489));
+}
+
+void test_change_needs_consecutive_scans(void)
+{
+	scan(2234);
+	TEST_ASSERT_EQUAL(J1772_STATE_B, scan(1489));
+	TEST_ASSERT_EQUAL(J1772_STATE_B, scan(1489));
+	TEST_ASSERT_EQUAL(J1772_STATE_C, scan(1489));
+
+	struct evse_pilot_stats st;
+	evse_pilot_stats_get(&st);
+	TEST_ASSERT_EQUAL_UINT32(1, st.transitions);
+	TEST_ASSERT_EQUAL_UINT32(0, st.suppressed);
+}
+
+void test_settling_while_change_pending(void)
+{
+	scan(2234);
+	TEST_ASSERT_FALSE(evse_pilot_settling());
+	scan(1489);
+	TEST_ASSERT_TRUE(evse_pilot_settling());
+	scan(1489);
+	TEST_ASSERT_TRUE(evse_pilot_settling());
+	scan(1489);
+	TEST_ASSERT_FALSE(evse_pilot_settling());   /* accepted */
+
+	/* A blip back to the accepted state ends it too */
+	scan(2234);
+	TEST_ASSERT_TRUE(evse_pilot_settling());
+	scan(1489);
+	TEST_ASSERT_FALSE(evse_pilot_settling());
+}
+
+void test_rereading_a_scan_does_not_count(void)
+{
+	scan(2234);
+	scan(1489);
+
+	/* The LED engine and the sensor poll both read this scan */
+	j1772_state_t state;
+	for (int i = 0; i < 5; i++) {
+		TEST_ASSERT_EQUAL_INT(0, evse_j1772_state_get(&state, NULL));
+		TEST_ASSERT_EQUAL(J1772_STATE_B, state);
+	}
+	TEST_ASSERT_EQUAL(J1772_STATE_B, scan(1489));
+	TEST_ASSERT_EQUAL(J1772_STATE_C, scan(1489));
+}
+
+void test_blocking_reads_each_count(void)
+{
+	struct platform_api old = *mock_platform_api_get();
+	old.version = PLATFORM_API_VERSION_ADC_CACHE - 1;
+	platform = &old;
+
+	j1772_state_t state;
+	mock_adc_values[0] = 2234;
+	evse_j1772_state_get(&state, NULL);
+	mock_adc_values[0] = 1489;
+	evse_j1772_state_get(&state, NULL);
+	evse_j1772_state_get(&state, NULL);
+	TEST_ASSERT_EQUAL(J1772_STATE_B, state);
+	evse_j1772_state_get(&state, NULL);
+	TEST_ASSERT_EQUAL(J1772_STATE_C, state);
+	platform = mock_platform_api_get();
+}
+
+void test_interrupted_change_suppressed(void)
+{
+	scan(2234);
+	scan(1489);
+	scan(1489);
+	TEST_ASSERT_EQUAL(J1772_STATE_B, scan(2234));
+	TEST_ASSERT_EQUAL(J1772_STATE_B, scan(1489));   /* count restarts */
+	TEST_ASSERT_EQUAL(J1772_STATE_B, scan(2980));   /* other candidate */
+	TEST_ASSERT_EQUAL(J1772_STATE_B, scans(2234, 5));
+
+	struct evse_pilot_stats st;
+	evse_pilot_stats_get(&st);
+	TEST_ASSERT_EQUAL_UINT32(0, st.transitions);
+	TEST_ASSERT_EQUAL_UINT32(3, st.suppressed);
+}
+
+void test_hysteresis_holds_state_near_threshold(void)
+{
+	/* B/C threshold 1850 mV, band 150 mV */
+	scan(2234);
+	TEST_ASSERT_EQUAL(J1772_STATE_B, scans(1760, 5));
+	TEST_ASSERT_EQUAL(J1772_STATE_B, scans(1701, 5));
+	TEST_ASSERT_EQUAL(J1772_STATE_C, scans(1700, 3));
+	TEST_ASSERT_EQUAL(J1772_STATE_C, scans(1990, 5));
+	TEST_ASSERT_EQUAL(J1772_STATE_C, scans(2000, 5));
+	TEST_ASSERT_EQUAL(J1772_STATE_B, scans(2001, 3));
+}
+
+void test_hysteresis_spans_two_boundaries(void)
+{
+	/* A straight to C: both crossings are past their bands */
+	scan(2980);
+	TEST_ASSERT_EQUAL(J1772_STATE_C, scans(1489, 3));
+}
+
+void test_init_resets_classifier(void)
+{
+	scan(2234);
+	scan(1489);
+	evse_sensors_init();
+	TEST_ASSERT_EQUAL(J1772_STATE_C, scan(1489));
+
+	struct evse_pilot_stats st;
+	evse_pilot_stats_get(&st);
+	TEST_ASSERT_EQUAL_UINT32(0, st.transitions);
+}
+
+/* --- Tuning --- */
+
+void test_config_defaults(void)
+{
+	struct evse_pilot_config cfg;
+	evse_pilot_config_get(&cfg);
+	TEST_ASSERT_EQUAL_UINT16(2600, cfg.threshold_mv[0]);
+	TEST_ASSERT_EQUAL_UINT16(1850, cfg.threshold_mv[1]);
+	TEST_ASSERT_EQUAL_UINT16(1100, cfg.threshold_mv[2]);
+	TEST_ASSERT_EQUAL_UINT16(350, cfg.threshold_mv[3]);
+	TEST_ASSERT_EQUAL_UINT16(150, cfg.hysteresis_mv);
+	TEST_ASSERT_EQUAL_UINT8(3, cfg.debounce);
+	TEST_ASSERT_EQUAL_UINT8(EVSE_PILOT_FILTER_MEDIAN, cfg.filter);
+}
+
+void test_config_rejects_invalid(void)
+{
+	struct evse_pilot_config def, cfg;
+	evse_pilot_config_defaults(&def);
+
+	TEST_ASSERT_EQUAL_INT(-1, evse_pilot_config_set(NULL));
+	cfg = def; cfg.debounce = 0;
+	TEST_ASSERT_EQUAL_INT(-1, evse_pilot_config_set(&cfg));
+	cfg = def; cfg.debounce = EVSE_PILOT_DEBOUNCE_MAX + 1;
+	TEST_ASSERT_EQUAL_INT(-1, evse_pilot_config_set(&cfg));
+	cfg = def; cfg.filter = 2;
+	TEST_ASSERT_EQUAL_INT(-1, evse_pilot_config_set(&cfg));
+	cfg = def; cfg.threshold_mv[2] = 1850;
+	TEST_ASSERT_EQUAL_INT(-1, evse_pilot_config_set(&cfg));
+	cfg = def; cfg.threshold_mv[3] = 1200;
+	TEST_ASSERT_EQUAL_INT(-1, evse_pilot_config_set(&cfg));
+	cfg = def; cfg.hysteresis_mv = 375;   /* bands meet at 750 mV gaps */
+	TEST_ASSERT_EQUAL_INT(-1, evse_pilot_config_set(&cfg));
+
+	evse_pilot_config_get(&cfg);
+	TEST_ASSERT_EQUAL_MEMORY(&def, &cfg, sizeof(cfg));
+}
+
+void test_config_applies(void)
+{
+	struct evse_pilot_config cfg;
+	evse_pilot_config_defaults(&cfg);
+	cfg.threshold_mv[1] = 2000;
+	cfg.hysteresis_mv = 0;
+	cfg.debounce = 1;
+	TEST_ASSERT_EQUAL_INT(0, evse_pilot_config_set(&cfg));
+
+	scan(2234);
+	TEST_ASSERT_EQUAL(J1772_STATE_C, scan(1999));
+	TEST_ASSERT_EQUAL(J1772_STATE_B, scan(2001));
+}
+
 /* --- Current clamp (stubbed — no hardware on WisBlock prototype) --- */
 
 void test_current_clamp_stub_returns_zero(void)
@@ -192,6 +535,34 @@ int main(void)
 	RUN_TEST(test_pilot_voltage_no_api);
 	RUN_TEST(test_adc_error_propagated);
 
+	RUN_TEST(test_pilot_read_uses_cache);
+	RUN_TEST(test_pilot_read_blocking_before_first_scan);
+	RUN_TEST(test_pilot_read_blocking_on_old_platform);
+	RUN_TEST(test_cached_read_error_not_retried_blocking);
+
+	RUN_TEST(test_pilot_read_uses_burst);
+	RUN_TEST(test_burst_median_rejects_spikes);
+	RUN_TEST(test_burst_median_of_even_count);
+	RUN_TEST(test_burst_trimmed_mean);
+	RUN_TEST(test_burst_pwm_low_phase_ignored);
+	RUN_TEST(test_burst_all_low_is_state_e);
+	RUN_TEST(test_burst_error_propagated);
+	RUN_TEST(test_burst_blocking_before_first_scan);
+
+	RUN_TEST(test_first_reading_accepted_without_debounce);
+	RUN_TEST(test_change_needs_consecutive_scans);
+	RUN_TEST(test_settling_while_change_pending);
+	RUN_TEST(test_rereading_a_scan_does_not_count);
+	RUN_TEST(test_blocking_reads_each_count);
+	RUN_TEST(test_interrupted_change_suppressed);
+	RUN_TEST(test_hysteresis_holds_state_near_threshold);
+	RUN_TEST(test_hysteresis_spans_two_boundaries);
+	RUN_TEST(test_init_resets_classifier);
+
+	RUN_TEST(test_config_defaults);
+	RUN_TEST(test_config_rejects_invalid);
+	RUN_TEST(test_config_applies);
+
 	RUN_TEST(test_current_clamp_stub_returns_zero);
 
 	RUN_TEST(test_simulation_overrides_adc);
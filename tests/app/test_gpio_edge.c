@@ -0,0 +1,230 @@
+/*
+ * Unit tests for gpio_edge.c — per-pin debounce of raw GPIO interrupts
+ * and the settled-change queue behind platform gpio_subscribe().
+ */
+
+#include "unity.h"
+#include <gpio_edge.h>
+#include <errno.h>
+
+static struct platform_gpio_edge out[GPIO_EDGE_QUEUE];
+
+static size_t collect(uint32_t now_ms, uint32_t *next)
+{
+	size_t n = 0;
+	uint32_t left = gpio_edge_collect(now_ms, out, GPIO_EDGE_QUEUE, &n);
+
+	if (next) {
+		*next = left;
+	}
+	return n;
+}
+
+void setUp(void)
+{
+	gpio_edge_init();
+}
+
+void tearDown(void) { }
+
+static void test_subscribe_errors(void)
+{
+	TEST_ASSERT_EQUAL_INT(-EINVAL, gpio_edge_subscribe(-1, 0, 20));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, gpio_edge_subscribe(GPIO_EDGE_MAX_PINS, 0, 20));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, gpio_edge_subscribe(2, 0, GPIO_EDGE_DEBOUNCE_MAX_MS + 1));
+	TEST_ASSERT_FALSE(gpio_edge_subscribed(2));
+	TEST_ASSERT_EQUAL_INT(0, gpio_edge_subscribe(2, 0, GPIO_EDGE_DEBOUNCE_MAX_MS));
+	TEST_ASSERT_TRUE(gpio_edge_subscribed(2));
+	TEST_ASSERT_FALSE(gpio_edge_subscribed(-1));
+}
+
+static void test_unsubscribed_pin_ignored(void)
+{
+	TEST_ASSERT_EQUAL_UINT32(0, gpio_edge_isr(1, 1, 100));
+	TEST_ASSERT_EQUAL(0, collect(200, NULL));
+
+	struct gpio_edge_stats st;
+
+	gpio_edge_stats(&st);
+	TEST_ASSERT_EQUAL_UINT32(0, st.edges);
+}
+
+static void test_clean_edge_settles_after_debounce(void)
+{
+	uint32_t next;
+
+	gpio_edge_subscribe(2, 0, 50);
+	TEST_ASSERT_EQUAL_UINT32(50, gpio_edge_isr(2, 1, 1000));
+
+	/* Still inside the debounce time: nothing yet, 20 ms to go */
+	TEST_ASSERT_EQUAL(0, collect(1030, &next));
+	TEST_ASSERT_EQUAL_UINT32(20, next);
+
+	TEST_ASSERT_EQUAL(1, collect(1050, &next));
+	TEST_ASSERT_EQUAL_UINT32(0, next);
+	TEST_ASSERT_EQUAL_UINT8(2, out[0].pin);
+	TEST_ASSERT_EQUAL_UINT8(1, out[0].level);
+	TEST_ASSERT_EQUAL_UINT32(1000, out[0].at_ms);
+
+	/* Delivered once */
+	TEST_ASSERT_EQUAL(0, collect(1100, NULL));
+}
+
+static void test_burst_stamped_with_first_edge(void)
+{
+	gpio_edge_subscribe(3, 0, 20);
+	gpio_edge_isr(3, 1, 500);
+	gpio_edge_isr(3, 0, 503);
+	gpio_edge_isr(3, 1, 507);
+	TEST_ASSERT_EQUAL_UINT32(20, gpio_edge_isr(3, 1, 510));
+
+	/* Settles 20 ms after the last edge, not the first */
+	TEST_ASSERT_EQUAL(0, collect(525, NULL));
+	TEST_ASSERT_EQUAL(1, collect(530, NULL));
+	TEST_ASSERT_EQUAL_UINT32(500, out[0].at_ms);
+	TEST_ASSERT_EQUAL_UINT8(1, out[0].level);
+}
+
+static void test_bounce_back_not_queued(void)
+{
+	gpio_edge_subscribe(3, 1, 20);
+	gpio_edge_isr(3, 0, 100);
+	gpio_edge_isr(3, 1, 104);
+	TEST_ASSERT_EQUAL(0, collect(200, NULL));
+
+	struct gpio_edge_stats st;
+
+	gpio_edge_stats(&st);
+	TEST_ASSERT_EQUAL_UINT32(2, st.edges);
+	TEST_ASSERT_EQUAL_UINT32(1, st.bounces);
+	TEST_ASSERT_EQUAL_UINT32(0, st.delivered);
+}
+
+static void test_interrupt_without_change(void)
+{
+	gpio_edge_subscribe(2, 1, 50);
+	TEST_ASSERT_EQUAL_UINT32(0, gpio_edge_isr(2, 1, 100));
+	TEST_ASSERT_EQUAL(0, collect(1000, NULL));
+}
+
+static void test_zero_debounce_settles_next_ms(void)
+{
+	gpio_edge_subscribe(2, 0, 0);
+	TEST_ASSERT_EQUAL_UINT32(1, gpio_edge_isr(2, 1, 100));
+	TEST_ASSERT_EQUAL(1, collect(100, NULL));
+	TEST_ASSERT_EQUAL_UINT32(100, out[0].at_ms);
+}
+
+static void test_overdue_settle_before_next_edge(void)
+{
+	/* The work queue never ran for the first change: the next edge
+	 * settles it, then opens its own burst */
+	gpio_edge_subscribe(2, 0, 50);
+	gpio_edge_isr(2, 1, 1000);
+	gpio_edge_isr(2, 0, 2000);
+	TEST_ASSERT_EQUAL(1, collect(2010, NULL));
+	TEST_ASSERT_EQUAL_UINT8(1, out[0].level);
+	TEST_ASSERT_EQUAL_UINT32(1000, out[0].at_ms);
+
+	TEST_ASSERT_EQUAL(1, collect(2050, NULL));
+	TEST_ASSERT_EQUAL_UINT8(0, out[0].level);
+	TEST_ASSERT_EQUAL_UINT32(2000, out[0].at_ms);
+}
+
+static void test_resubscribe_changes_debounce_only(void)
+{
+	gpio_edge_subscribe(2, 0, 50);
+	gpio_edge_isr(2, 1, 100);
+	gpio_edge_subscribe(2, 0, 10);
+	TEST_ASSERT_EQUAL(1, collect(110, NULL));
+	TEST_ASSERT_EQUAL_UINT8(1, out[0].level);
+}
+
+static void test_pins_batched_in_settle_order(void)
+{
+	uint32_t next;
+
+	gpio_edge_subscribe(2, 0, 50);
+	gpio_edge_subscribe(3, 0, 20);
+	gpio_edge_isr(2, 1, 100);
+	gpio_edge_isr(3, 1, 110);
+
+	/* Button settled at 130, thermostat at 150 */
+	TEST_ASSERT_EQUAL(1, collect(130, &next));
+	TEST_ASSERT_EQUAL_UINT8(3, out[0].pin);
+	TEST_ASSERT_EQUAL_UINT32(20, next);
+
+	gpio_edge_isr(3, 0, 140);
+	TEST_ASSERT_EQUAL(2, collect(200, &next));
+	TEST_ASSERT_EQUAL_UINT8(2, out[0].pin);
+	TEST_ASSERT_EQUAL_UINT8(3, out[1].pin);
+	TEST_ASSERT_EQUAL_UINT8(0, out[1].level);
+	TEST_ASSERT_EQUAL_UINT32(0, next);
+}
+
+static void test_full_queue_drops_change(void)
+{
+	gpio_edge_subscribe(2, 0, 0);
+	for (uint32_t i = 0; i <= GPIO_EDGE_QUEUE; i++) {
+		gpio_edge_isr(2, (int)((i + 1) & 1), 100 + i * 10);
+	}
+	/* The ninth edge settled the eighth change into the last slot; the
+	 * ninth itself is dropped when collected */
+	TEST_ASSERT_EQUAL(GPIO_EDGE_QUEUE, collect(1000, NULL));
+	TEST_ASSERT_EQUAL_UINT32(100, out[0].at_ms);
+	TEST_ASSERT_EQUAL_UINT32(100 + (GPIO_EDGE_QUEUE - 1) * 10, out[GPIO_EDGE_QUEUE - 1].at_ms);
+
+	struct gpio_edge_stats st;
+
+	gpio_edge_stats(&st);
+	TEST_ASSERT_EQUAL_UINT32(1, st.dropped);
+	TEST_ASSERT_EQUAL_UINT32(GPIO_EDGE_QUEUE, st.delivered);
+
+	/* The dropped change still moved the stable level */
+	TEST_ASSERT_EQUAL_UINT32(0, gpio_edge_isr(2, 1, 2000));
+}
+
+static void test_collect_limited_to_max(void)
+{
+	size_t n = 0;
+
+	gpio_edge_subscribe(0, 0, 0);
+	gpio_edge_subscribe(1, 0, 0);
+	gpio_edge_isr(0, 1, 100);
+	gpio_edge_isr(1, 1, 100);
+
+	gpio_edge_collect(200, out, 1, &n);
+	TEST_ASSERT_EQUAL(1, n);
+	TEST_ASSERT_EQUAL_UINT8(0, out[0].pin);
+	gpio_edge_collect(200, out, 1, &n);
+	TEST_ASSERT_EQUAL(1, n);
+	TEST_ASSERT_EQUAL_UINT8(1, out[0].pin);
+}
+
+static void test_settle_across_uptime_wrap(void)
+{
+	gpio_edge_subscribe(3, 0, 20);
+	gpio_edge_isr(3, 1, 0xFFFFFFF0u);
+	TEST_ASSERT_EQUAL(0, collect(0xFFFFFFFFu, NULL));
+	TEST_ASSERT_EQUAL(1, collect(4, NULL));
+	TEST_ASSERT_EQUAL_UINT32(0xFFFFFFF0u, out[0].at_ms);
+}
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_subscribe_errors);
+	RUN_TEST(test_unsubscribed_pin_ignored);
+	RUN_TEST(test_clean_edge_settles_after_debounce);
+	RUN_TEST(test_burst_stamped_with_first_edge);
+	RUN_TEST(test_bounce_back_not_queued);
+	RUN_TEST(test_interrupt_without_change);
+	RUN_TEST(test_zero_debounce_settles_next_ms);
+	RUN_TEST(test_overdue_settle_before_next_edge);
+	RUN_TEST(test_resubscribe_changes_debounce_only);
+	RUN_TEST(test_pins_batched_in_settle_order);
+	RUN_TEST(test_full_queue_drops_change);
+	RUN_TEST(test_collect_limited_to_max);
+	RUN_TEST(test_settle_across_uptime_wrap);
+	return UNITY_END();
+}
@@ -0,0 +1,118 @@
+/*
+ * Unit tests for led_pattern.c — LED pattern steps to the PWM sequence
+ * behind platform led_pattern().
+ */
+
+#include "unity.h"
+#include <led_pattern.h>
+#include <errno.h>
+#include <string.h>
+
+static struct led_pattern_seq seq;
+
+void setUp(void)
+{
+	memset(&seq, 0, sizeof(seq));
+}
+
+void tearDown(void) { }
+
+static void test_one_value_per_tick(void)
+{
+	/* OTA double-blink: on-off-on-pause */
+	const struct platform_led_step s[] = { {1, 1}, {1, 0}, {1, 1}, {7, 0} };
+
+	TEST_ASSERT_EQUAL_INT(0, led_pattern_build(s, 4, &seq));
+	TEST_ASSERT_EQUAL_UINT16(10, seq.length);
+	TEST_ASSERT_EQUAL_UINT16(0, seq.refresh);
+	TEST_ASSERT_EQUAL_HEX16(LED_PATTERN_ON, seq.values[0]);
+	TEST_ASSERT_EQUAL_HEX16(LED_PATTERN_OFF, seq.values[1]);
+	TEST_ASSERT_EQUAL_HEX16(LED_PATTERN_ON, seq.values[2]);
+	for (int i = 3; i < 10; i++) {
+		TEST_ASSERT_EQUAL_HEX16(LED_PATTERN_OFF, seq.values[i]);
+	}
+}
+
+static void test_common_divisor_becomes_refresh(void)
+{
+	/* 1 s on, 1 s off: two values, each held for 10 periods */
+	const struct platform_led_step s[] = { {10, 1}, {10, 0} };
+
+	TEST_ASSERT_EQUAL_INT(0, led_pattern_build(s, 2, &seq));
+	TEST_ASSERT_EQUAL_UINT16(2, seq.length);
+	TEST_ASSERT_EQUAL_UINT16(9, seq.refresh);
+	TEST_ASSERT_EQUAL_HEX16(LED_PATTERN_ON, seq.values[0]);
+	TEST_ASSERT_EQUAL_HEX16(LED_PATTERN_OFF, seq.values[1]);
+}
+
+static void test_partial_divisor(void)
+{
+	/* Heartbeat: 2 on, 18 off -> 1 on, 9 off at 2 periods each */
+	const struct platform_led_step s[] = { {2, 1}, {18, 0} };
+
+	TEST_ASSERT_EQUAL_INT(0, led_pattern_build(s, 2, &seq));
+	TEST_ASSERT_EQUAL_UINT16(10, seq.length);
+	TEST_ASSERT_EQUAL_UINT16(1, seq.refresh);
+}
+
+static void test_solid_is_one_value(void)
+{
+	const struct platform_led_step s[] = { {1, 1} };
+
+	TEST_ASSERT_EQUAL_INT(0, led_pattern_build(s, 1, &seq));
+	TEST_ASSERT_EQUAL_UINT16(1, seq.length);
+	TEST_ASSERT_EQUAL_HEX16(LED_PATTERN_ON, seq.values[0]);
+}
+
+static void test_idle_blip_fits(void)
+{
+	const struct platform_led_step s[] = { {1, 1}, {99, 0} };
+
+	TEST_ASSERT_EQUAL_INT(0, led_pattern_build(s, 2, &seq));
+	TEST_ASSERT_EQUAL_UINT16(100, seq.length);
+	TEST_ASSERT_EQUAL_HEX16(LED_PATTERN_ON, seq.values[0]);
+	TEST_ASSERT_EQUAL_HEX16(LED_PATTERN_OFF, seq.values[99]);
+}
+
+static void test_full_on_and_off_duty(void)
+{
+	TEST_ASSERT_EQUAL_HEX16(LED_PATTERN_COUNTERTOP, LED_PATTERN_ON & 0x7FFF);
+	TEST_ASSERT_EQUAL_HEX16(0, LED_PATTERN_OFF & 0x7FFF);
+}
+
+static void test_rejects_bad_steps(void)
+{
+	const struct platform_led_step zero[] = { {1, 1}, {0, 0} };
+	const struct platform_led_step many[PLATFORM_LED_MAX_STEPS + 1] = { {1, 1} };
+	const struct platform_led_step coprime[] = { {1, 1}, {LED_PATTERN_MAX_VALUES, 0} };
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, led_pattern_build(zero, 0, &seq));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, led_pattern_build(zero, 2, &seq));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, led_pattern_build(many, PLATFORM_LED_MAX_STEPS + 1, &seq));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, led_pattern_build(coprime, 2, &seq));
+	TEST_ASSERT_EQUAL_UINT16(0, seq.length);
+}
+
+static void test_long_steps_fit_when_scaled(void)
+{
+	/* 25.5 s on, 25.5 s off: 2 values held 255 periods each */
+	const struct platform_led_step s[] = { {255, 1}, {255, 0} };
+
+	TEST_ASSERT_EQUAL_INT(0, led_pattern_build(s, 2, &seq));
+	TEST_ASSERT_EQUAL_UINT16(2, seq.length);
+	TEST_ASSERT_EQUAL_UINT16(254, seq.refresh);
+}
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_one_value_per_tick);
+	RUN_TEST(test_common_divisor_becomes_refresh);
+	RUN_TEST(test_partial_divisor);
+	RUN_TEST(test_solid_is_one_value);
+	RUN_TEST(test_idle_blip_fits);
+	RUN_TEST(test_full_on_and_off_duty);
+	RUN_TEST(test_rejects_bad_steps);
+	RUN_TEST(test_long_steps_fit_when_scaled);
+	return UNITY_END();
+}
@@ -0,0 +1,161 @@
+/*
+ * Unit tests for msg_pool.c — fixed-slot allocator behind platform
+ * send_msg() and Sidewalk status events.
+ */
+
+#include "unity.h"
+#include <msg_pool.h>
+#include <string.h>
+
+struct test_msg {
+	uint32_t token;
+	uint8_t data[19];
+};
+
+MSG_POOL_DEFINE(test_pool, struct test_msg, 4);
+MSG_POOL_DEFINE(wide_pool, uint32_t, 32);
+
+static void reset_pool(struct msg_pool *pool)
+{
+	atomic_set(&pool->used, 0);
+	atomic_set(&pool->high_water, 0);
+	atomic_set(&pool->exhausted, 0);
+}
+
+void setUp(void)
+{
+	reset_pool(&test_pool);
+	reset_pool(&wide_pool);
+}
+
+void tearDown(void) { }
+
+static void test_alloc_returns_distinct_slots(void)
+{
+	struct test_msg *a = msg_pool_alloc(&test_pool);
+	struct test_msg *b = msg_pool_alloc(&test_pool);
+
+	TEST_ASSERT_NOT_NULL(a);
+	TEST_ASSERT_NOT_NULL(b);
+	TEST_ASSERT_TRUE(a != b);
+
+	/* Slots do not overlap */
+	memset(a, 0xAA, sizeof(*a));
+	memset(b, 0x55, sizeof(*b));
+	TEST_ASSERT_EQUAL_HEX8(0xAA, a->data[18]);
+}
+
+static void test_exhaustion_returns_null_and_counts(void)
+{
+	for (int i = 0; i < 4; i++) {
+		TEST_ASSERT_NOT_NULL(msg_pool_alloc(&test_pool));
+	}
+	TEST_ASSERT_NULL(msg_pool_alloc(&test_pool));
+	TEST_ASSERT_NULL(msg_pool_alloc(&test_pool));
+
+	struct msg_pool_stats st;
+	msg_pool_stats(&test_pool, &st);
+	TEST_ASSERT_EQUAL_UINT8(4, st.slots);
+	TEST_ASSERT_EQUAL_UINT8(4, st.in_use);
+	TEST_ASSERT_EQUAL_UINT32(2, st.exhausted);
+}
+
+static void test_free_makes_slot_reusable(void)
+{
+	void *slots[4];
+	for (int i = 0; i < 4; i++) {
+		slots[i] = msg_pool_alloc(&test_pool);
+	}
+	msg_pool_free(&test_pool, slots[2]);
+	TEST_ASSERT_EQUAL_PTR(slots[2], msg_pool_alloc(&test_pool));
+}
+
+static void test_high_water_survives_free(void)
+{
+	void *a = msg_pool_alloc(&test_pool);
+	void *b = msg_pool_alloc(&test_pool);
+	void *c = msg_pool_alloc(&test_pool);
+	msg_pool_free(&test_pool, a);
+	msg_pool_free(&test_pool, b);
+	msg_pool_free(&test_pool, c);
+	msg_pool_alloc(&test_pool);
+
+	struct msg_pool_stats st;
+	msg_pool_stats(&test_pool, &st);
+	TEST_ASSERT_EQUAL_UINT8(1, st.in_use);
+	TEST_ASSERT_EQUAL_UINT8(3, st.high_water);
+	TEST_ASSERT_EQUAL_UINT32(0, st.exhausted);
+}
+
+static void test_free_ignores_foreign_pointers(void)
+{
+	struct test_msg outside;
+	void *a = msg_pool_alloc(&test_pool);
+
+	msg_pool_free(&test_pool, NULL);
+	msg_pool_free(&test_pool, &outside);
+
+	struct msg_pool_stats st;
+	msg_pool_stats(&test_pool, &st);
+	TEST_ASSERT_EQUAL_UINT8(1, st.in_use);
+	msg_pool_free(&test_pool, a);
+	msg_pool_stats(&test_pool, &st);
+	TEST_ASSERT_EQUAL_UINT8(0, st.in_use);
+}
+
+static void test_full_width_pool(void)
+{
+	for (int i = 0; i < 32; i++) {
+		TEST_ASSERT_NOT_NULL(msg_pool_alloc(&wide_pool));
+	}
+	TEST_ASSERT_NULL(msg_pool_alloc(&wide_pool));
+
+	struct msg_pool_stats st;
+	msg_pool_stats(&wide_pool, &st);
+	TEST_ASSERT_EQUAL_UINT8(32, st.in_use);
+	TEST_ASSERT_EQUAL_UINT8(32, st.high_water);
+}
+
+static void test_uplink_burst_never_allocates_past_pool(void)
+{
+	/* Producer outruns the consumer 3:1 for 100 ticks: every refused
+	 * alloc is counted, none hands out a slot twice */
+	void *queued[4];
+	int depth = 0, sent = 0, refused = 0;
+
+	for (int tick = 0; tick < 100; tick++) {
+		for (int i = 0; i < 3; i++) {
+			void *m = msg_pool_alloc(&test_pool);
+			if (!m) {
+				refused++;
+				continue;
+			}
+			for (int j = 0; j < depth; j++) {
+				TEST_ASSERT_TRUE(queued[j] != m);
+			}
+			queued[depth++] = m;
+		}
+		msg_pool_free(&test_pool, queued[0]);
+		memmove(&queued[0], &queued[1], (size_t)(--depth) * sizeof(queued[0]));
+		sent++;
+	}
+
+	struct msg_pool_stats st;
+	msg_pool_stats(&test_pool, &st);
+	TEST_ASSERT_EQUAL_UINT32((uint32_t)refused, st.exhausted);
+	TEST_ASSERT_EQUAL_UINT8(4, st.high_water);
+	TEST_ASSERT_EQUAL_INT(300, sent + refused + depth);
+}
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_alloc_returns_distinct_slots);
+	RUN_TEST(test_exhaustion_returns_null_and_counts);
+	RUN_TEST(test_free_makes_slot_reusable);
+	RUN_TEST(test_high_water_survives_free);
+	RUN_TEST(test_free_ignores_foreign_pointers);
+	RUN_TEST(test_full_width_pool);
+	RUN_TEST(test_uplink_burst_never_allocates_past_pool);
+	return UNITY_END();
+}
@@ -0,0 +1,141 @@
+/*
+ * Unit tests for msg_track.c — Sidewalk message ids back to the
+ * send_msg() tokens reported to the app.
+ */
+
+#include "unity.h"
+#include <msg_track.h>
+
+void setUp(void)
+{
+	msg_track_init();
+}
+
+void tearDown(void) { }
+
+static void test_take_returns_token_once(void)
+{
+	TEST_ASSERT_EQUAL_UINT32(0, msg_track_add(100, 7, true));
+	TEST_ASSERT_EQUAL_UINT32(7, msg_track_take(100, NULL));
+	TEST_ASSERT_EQUAL_UINT32(0, msg_track_take(100, NULL));
+
+	struct msg_track_stats st;
+
+	msg_track_stats(&st);
+	TEST_ASSERT_EQUAL_UINT32(1, st.tracked);
+	TEST_ASSERT_EQUAL_UINT32(1, st.untracked);
+	TEST_ASSERT_EQUAL_UINT8(0, st.in_use);
+	TEST_ASSERT_EQUAL_UINT8(1, st.high_water);
+}
+
+static void test_unknown_id_untracked(void)
+{
+	msg_track_add(1, 10, true);
+	TEST_ASSERT_EQUAL_UINT32(0, msg_track_take(2, NULL));
+	TEST_ASSERT_EQUAL_UINT32(10, msg_track_take(1, NULL));
+}
+
+static void test_results_out_of_order(void)
+{
+	for (uint16_t i = 0; i < 5; i++) {
+		msg_track_add(i, 100u + i, true);
+	}
+	TEST_ASSERT_EQUAL_UINT32(103, msg_track_take(3, NULL));
+	TEST_ASSERT_EQUAL_UINT32(100, msg_track_take(0, NULL));
+	TEST_ASSERT_EQUAL_UINT32(104, msg_track_take(4, NULL));
+	TEST_ASSERT_EQUAL_UINT32(101, msg_track_take(1, NULL));
+	TEST_ASSERT_EQUAL_UINT32(102, msg_track_take(2, NULL));
+}
+
+static void test_full_pool_and_stack_queue_fit(void)
+{
+	/* 8 uplinks queued in the platform plus 8 held by the stack */
+	for (uint16_t i = 0; i < MSG_TRACK_SLOTS; i++) {
+		TEST_ASSERT_EQUAL_UINT32(0, msg_track_add(i, 1u + i, true));
+	}
+	for (uint16_t i = 0; i < MSG_TRACK_SLOTS; i++) {
+		TEST_ASSERT_EQUAL_UINT32(1u + i, msg_track_take(i, NULL));
+	}
+
+	struct msg_track_stats st;
+
+	msg_track_stats(&st);
+	TEST_ASSERT_EQUAL_UINT32(0, st.evicted);
+	TEST_ASSERT_EQUAL_UINT8(MSG_TRACK_SLOTS, st.high_water);
+}
+
+static void test_full_table_evicts_oldest(void)
+{
+	for (uint16_t i = 0; i < MSG_TRACK_SLOTS; i++) {
+		msg_track_add(i, 1u + i, true);
+	}
+	/* The second-oldest result came back: its slot is free, no eviction */
+	msg_track_take(1, NULL);
+	TEST_ASSERT_EQUAL_UINT32(0, msg_track_add(500, 500, true));
+
+	/* Full again: the oldest (id 0) goes, not the slot after the last */
+	TEST_ASSERT_EQUAL_UINT32(1, msg_track_add(501, 501, true));
+	TEST_ASSERT_EQUAL_UINT32(0, msg_track_take(0, NULL));
+	TEST_ASSERT_EQUAL_UINT32(3, msg_track_add(502, 502, true));
+	TEST_ASSERT_EQUAL_UINT32(500, msg_track_take(500, NULL));
+	TEST_ASSERT_EQUAL_UINT32(502, msg_track_take(502, NULL));
+
+	struct msg_track_stats st;
+
+	msg_track_stats(&st);
+	TEST_ASSERT_EQUAL_UINT32(2, st.evicted);
+	TEST_ASSERT_EQUAL_UINT32(1, st.untracked);
+	TEST_ASSERT_EQUAL_UINT8(MSG_TRACK_SLOTS - 2, st.in_use);
+}
+
+static void test_reused_id_replaces_pair(void)
+{
+	msg_track_add(9, 1, true);
+	TEST_ASSERT_EQUAL_UINT32(1, msg_track_add(9, 2, true));
+	TEST_ASSERT_EQUAL_UINT32(2, msg_track_take(9, NULL));
+	TEST_ASSERT_EQUAL_UINT32(0, msg_track_take(9, NULL));
+
+	struct msg_track_stats st;
+
+	msg_track_stats(&st);
+	TEST_ASSERT_EQUAL_UINT32(1, st.evicted);
+	TEST_ASSERT_EQUAL_UINT8(0, st.in_use);
+}
+
+static void test_platform_uplink_is_not_the_apps(void)
+{
+	bool app = true;
+
+	/* An OTA ACK sent while the app's own uplink is still out */
+	msg_track_add(20, 30, false);
+	msg_track_add(21, 31, true);
+
+	TEST_ASSERT_EQUAL_UINT32(30, msg_track_take(20, &app));
+	TEST_ASSERT_FALSE(app);
+	TEST_ASSERT_EQUAL_UINT32(31, msg_track_take(21, &app));
+	TEST_ASSERT_TRUE(app);
+
+	/* Unknown ids are never the app's */
+	app = true;
+	TEST_ASSERT_EQUAL_UINT32(0, msg_track_take(22, &app));
+	TEST_ASSERT_FALSE(app);
+
+	/* A reused id takes the new uplink's origin */
+	msg_track_add(23, 40, true);
+	msg_track_add(23, 41, false);
+	TEST_ASSERT_EQUAL_UINT32(41, msg_track_take(23, &app));
+	TEST_ASSERT_FALSE(app);
+}
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_take_returns_token_once);
+	RUN_TEST(test_unknown_id_untracked);
+	RUN_TEST(test_results_out_of_order);
+	RUN_TEST(test_full_pool_and_stack_queue_fit);
+	RUN_TEST(test_full_table_evicts_oldest);
+	RUN_TEST(test_reused_id_replaces_pair);
+	RUN_TEST(test_platform_uplink_is_not_the_apps);
+	return UNITY_END();
+}
@@ -9,17 +9,22 @@
 
 #include "unity.h"
 #include <ota_update.h>
+#include <ota_boot.h>
 #include <platform_api.h>
+#include <zephyr/drivers/flash.h>
 #include <string.h>
 
 /* Mock flash externs from mock Zephyr headers */
 extern uint8_t mock_flash_mem[];
 extern int mock_flash_read_count;
+extern size_t mock_flash_read_bytes;
 extern int mock_flash_write_count;
 extern int mock_flash_erase_count;
 extern int mock_flash_fail_at_page;
 extern int mock_reboot_count;
+extern uint16_t mock_flash_page_erases[];
 extern void mock_flash_reset(void);
+extern void mock_work_run_scheduled(void);
 
 #define MOCK_FLASH_BASE 0x90000
 
@@ -29,6 +34,23 @@ static void flash_peek(uint32_t addr, void *buf, size_t len)
 	memcpy(buf, &mock_flash_mem[addr - MOCK_FLASH_BASE], len);
 }
 
+static void flash_put(uint32_t addr, const void *data, size_t len)
+{
+	memcpy(&mock_flash_mem[addr - MOCK_FLASH_BASE], data, len);
+}
+
+static uint32_t test_crc32(const uint8_t *data, size_t len)
+{
+	uint32_t crc = ~0u;
+	for (size_t i = 0; i < len; i++) {
+		crc ^= data[i];
+		for (int j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
 /* Uplink capture */
 static uint8_t send_buf[64];
 static size_t send_len;
@@ -117,6 +139,17 @@ static void enter_receiving_delta(uint32_t total_size, uint16_t chunk_size,
 	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
 }
 
+/* Send a zero-filled chunk, e.g. to complete a session. Staging is
+ * written through a write combiner, so chunk data is only guaranteed to be
+ * in flash once the last chunk has arrived. */
+static void send_filler_chunk(uint16_t chunk_idx, uint16_t chunk_size)
+{
+	uint8_t data[15] = { 0 };
+	uint8_t msg[19];
+	size_t msg_len = build_chunk_msg(msg, chunk_idx, data, chunk_size);
+	ota_process_msg(msg, msg_len);
+}
+
 /* ------------------------------------------------------------------ */
 /*  setUp / tearDown                                                    */
 /* ------------------------------------------------------------------ */
@@ -127,6 +160,7 @@ void setUp(void)
 	send_count = 0;
 	send_len = 0;
 	memset(send_buf, 0, sizeof(send_buf));
+	ota_boot_init();
 	ota_init(mock_send);
 }
 
@@ -153,16 +187,18 @@ static void test_chunk_writes_correct_data(void)
 	size_t msg_len = build_chunk_msg(msg, 0, pattern, 15);
 	ota_process_msg(msg, msg_len);
 
-	/* Verify data was written to staging at offset 0 */
-	uint8_t readback[15];
-	flash_peek(OTA_STAGING_ADDR, readback, 15);
-	TEST_ASSERT_EQUAL_MEMORY(pattern, readback, 15);
-
 	/* Verify ACK was sent */
 	TEST_ASSERT_EQUAL_INT(1, send_count);
 	TEST_ASSERT_EQUAL_HEX8(OTA_CMD_TYPE, send_buf[0]);
 	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_ACK, send_buf[1]);
 	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+
+	/* Verify data was written to staging at offset 0 */
+	send_filler_chunk(1, 15);
+	send_filler_chunk(2, 15);
+	uint8_t readback[15];
+	flash_peek(OTA_STAGING_ADDR, readback, 15);
+	TEST_ASSERT_EQUAL_MEMORY(pattern, readback, 15);
 }
 
 static void test_chunk_1_writes_at_correct_offset(void)
@@ -185,6 +221,7 @@ static void test_chunk_1_writes_at_correct_offset(void)
 	uint8_t msg1[19];
 	size_t len1 = build_chunk_msg(msg1, 1, data1, 15);
 	ota_process_msg(msg1, len1);
+	send_filler_chunk(2, 15);
 
 	/* Verify chunk 1 data at staging + 15 */
 	uint8_t readback[15];
@@ -267,6 +304,8 @@ static void test_delta_bitmap_chunk_0(void)
 	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
 
 	/* Verify the data was written to staging at chunk 0 offset */
+	send_filler_chunk(1, 15);
+	send_filler_chunk(2, 15);
 	uint8_t readback[15];
 	flash_peek(OTA_STAGING_ADDR, readback, 15);
 	TEST_ASSERT_EQUAL_MEMORY(data, readback, 15);
@@ -294,6 +333,7 @@ static void test_delta_bitmap_chunk_127(void)
 	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
 
 	/* Verify data at staging + 127*15 */
+	send_filler_chunk(0, 15);
 	uint8_t readback[15];
 	flash_peek(OTA_STAGING_ADDR + (uint32_t)127 * 15, readback, 15);
 	TEST_ASSERT_EQUAL_MEMORY(data, readback, 15);
@@ -325,6 +365,7 @@ static void test_delta_bitmap_edge_indices(void)
 	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
 
 	/* Verify both chunks in flash */
+	send_filler_chunk(0, 15);
 	uint8_t rb7[15], rb8[15];
 	flash_peek(OTA_STAGING_ADDR + 7 * 15, rb7, 15);
 	flash_peek(OTA_STAGING_ADDR + 8 * 15, rb8, 15);
@@ -518,6 +559,981 @@ static void test_chunk_payload_too_short_rejected(void)
 	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_SIZE_ERR, send_buf[2]);
 }
 
+/* ------------------------------------------------------------------ */
+/*  Receive-time digests: validation without reading the image back    */
+/* ------------------------------------------------------------------ */
+
+#define DIGEST_IMAGE_SIZE (3 * OTA_FLASH_PAGE_SIZE + 300)
+
+static uint8_t digest_old[DIGEST_IMAGE_SIZE];
+static uint8_t digest_new[DIGEST_IMAGE_SIZE];
+
+static void fill_digest_images(void)
+{
+	for (uint32_t i = 0; i < DIGEST_IMAGE_SIZE; i++) {
+		digest_old[i] = (uint8_t)((i * 7) ^ (i >> 8));
+	}
+	memcpy(digest_new, digest_old, sizeof(digest_new));
+}
+
+#define DIGEST_PAGES ((DIGEST_IMAGE_SIZE + OTA_FLASH_PAGE_SIZE - 1) / OTA_FLASH_PAGE_SIZE)
+
+/* Reading the cache: the record, then the journal up to its first erased
+ * slot (one record per page, DONE, erased) */
+#define CACHE_READ_BYTES (sizeof(struct ota_metadata) + \
+			  (DIGEST_PAGES + 2) * sizeof(struct ota_journal_rec))
+
+static void journal_put(uint16_t slot, uint16_t page, uint32_t page_crc)
+{
+	struct ota_journal_rec rec = { .page_crc32 = page_crc, .page = page };
+	rec.check = (uint16_t)test_crc32((const uint8_t *)&rec,
+					 offsetof(struct ota_journal_rec, check));
+	flash_put(OTA_JOURNAL_ADDR + slot * sizeof(rec), &rec, sizeof(rec));
+}
+
+/* Primary holds digest_old and the metadata page caches its CRCs, as an
+ * apply would have left them */
+static void install_primary_cache(void)
+{
+	struct ota_metadata meta = {
+		.magic = OTA_META_MAGIC,
+		.state = OTA_META_STATE_APPLYING,
+		.image_size = DIGEST_IMAGE_SIZE,
+		.image_crc32 = test_crc32(digest_old, DIGEST_IMAGE_SIZE),
+		.app_version = 1,
+		.total_pages = DIGEST_PAGES,
+	};
+	uint16_t page = 0;
+	for (uint32_t off = 0; off < DIGEST_IMAGE_SIZE; off += OTA_FLASH_PAGE_SIZE, page++) {
+		uint32_t n = DIGEST_IMAGE_SIZE - off;
+		if (n > OTA_FLASH_PAGE_SIZE) {
+			n = OTA_FLASH_PAGE_SIZE;
+		}
+		journal_put(page, page, test_crc32(&digest_old[off], n));
+	}
+	journal_put(page, OTA_JOURNAL_DONE, meta.image_crc32);
+	flash_put(OTA_APP_PRIMARY_ADDR, digest_old, DIGEST_IMAGE_SIZE);
+	flash_put(OTA_METADATA_ADDR, &meta, sizeof(meta));
+}
+
+static void test_full_session_validates_without_reading_back(void)
+{
+	fill_digest_images();
+	digest_new[100] ^= 0xFF;
+	uint32_t size = 48 * 12;
+	uint8_t start[18];
+	build_start_msg(start, size, 48, 12, test_crc32(digest_new, size), 2);
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+
+	mock_flash_read_count = 0;
+	uint8_t msg[16];
+	for (uint16_t i = 0; i < 48; i++) {
+		size_t n = build_chunk_msg(msg, i, &digest_new[i * 12], 12);
+		ota_process_msg(msg, n);
+	}
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+	TEST_ASSERT_EQUAL_INT(0, mock_flash_read_count);
+}
+
+static void test_full_session_crc_mismatch_detected_on_receipt(void)
+{
+	fill_digest_images();
+	uint8_t start[18];
+	build_start_msg(start, 24, 2, 12, test_crc32(digest_new, 24) ^ 1, 2);
+	ota_process_msg(start, sizeof(start));
+
+	uint8_t msg[16];
+	for (uint16_t i = 0; i < 2; i++) {
+		size_t n = build_chunk_msg(msg, i, &digest_new[i * 12], 12);
+		ota_process_msg(msg, n);
+	}
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_ERROR, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_CRC_ERR, send_buf[2]);
+}
+
+/* One changed chunk in page 1: validation reads the cache record, that
+ * page of primary and the chunk from staging, nothing else */
+static void test_delta_with_primary_cache_reads_touched_page_only(void)
+{
+	fill_digest_images();
+	install_primary_cache();
+	uint16_t chunk = 300;                   /* offset 4500, page 1 */
+	memset(&digest_new[chunk * 15], 0x5A, 15);
+
+	uint8_t start[18];
+	build_start_msg(start, DIGEST_IMAGE_SIZE, 1, 15,
+			test_crc32(digest_new, DIGEST_IMAGE_SIZE), 2);
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+
+	mock_flash_read_bytes = 0;
+	uint8_t msg[19];
+	size_t n = build_chunk_msg(msg, chunk, &digest_new[chunk * 15], 15);
+	ota_process_msg(msg, n);
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+	TEST_ASSERT_EQUAL_UINT32(CACHE_READ_BYTES + OTA_FLASH_PAGE_SIZE + 15,
+				 mock_flash_read_bytes);
+}
+
+static void test_delta_without_cache_reads_every_page(void)
+{
+	fill_digest_images();
+	flash_put(OTA_APP_PRIMARY_ADDR, digest_old, DIGEST_IMAGE_SIZE);
+	uint16_t chunk = 300;
+	memset(&digest_new[chunk * 15], 0x5A, 15);
+
+	uint8_t start[18];
+	build_start_msg(start, DIGEST_IMAGE_SIZE, 1, 15,
+			test_crc32(digest_new, DIGEST_IMAGE_SIZE), 2);
+	ota_process_msg(start, sizeof(start));
+
+	mock_flash_read_bytes = 0;
+	uint8_t msg[19];
+	size_t n = build_chunk_msg(msg, chunk, &digest_new[chunk * 15], 15);
+	ota_process_msg(msg, n);
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+	TEST_ASSERT_EQUAL_UINT32(sizeof(struct ota_metadata) +
+				 DIGEST_IMAGE_SIZE + 15, mock_flash_read_bytes);
+}
+
+static void test_start_already_applied_answered_from_cache(void)
+{
+	fill_digest_images();
+	install_primary_cache();
+
+	mock_flash_read_bytes = 0;
+	uint8_t start[18];
+	build_start_msg(start, DIGEST_IMAGE_SIZE, 1, 15,
+			test_crc32(digest_old, DIGEST_IMAGE_SIZE), 1);
+	ota_process_msg(start, sizeof(start));
+
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+	TEST_ASSERT_EQUAL_UINT32(CACHE_READ_BYTES, mock_flash_read_bytes);
+}
+
+static void test_start_new_image_skips_primary_crc_with_cache(void)
+{
+	fill_digest_images();
+	install_primary_cache();
+	digest_new[0] ^= 0xFF;
+
+	mock_flash_read_bytes = 0;
+	uint8_t start[18];
+	build_start_msg(start, DIGEST_IMAGE_SIZE, 1, 15,
+			test_crc32(digest_new, DIGEST_IMAGE_SIZE), 2);
+	ota_process_msg(start, sizeof(start));
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+	/* Plus the receive checkpoint header, to see if this is a resume */
+	TEST_ASSERT_EQUAL_UINT32(CACHE_READ_BYTES + sizeof(struct ota_rx_session),
+				 mock_flash_read_bytes);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Program/erase counts: write combining, unchanged pages skipped      */
+/* ------------------------------------------------------------------ */
+
+/* 48 chunks of 12 bytes reach staging in three programs instead of one
+ * per chunk: the runs flushed by the checkpoints after chunks 16 and 32,
+ * and the rest at the end. Each checkpoint adds its record, and
+ * validation the word that ends the session. */
+static void test_full_session_programs_staging_in_runs(void)
+{
+	fill_digest_images();
+	uint32_t size = 48 * 12;
+	uint8_t start[18];
+	build_start_msg(start, size, 48, 12, test_crc32(digest_new, size), 2);
+	ota_process_msg(start, sizeof(start));
+
+	mock_flash_write_count = 0;
+	uint8_t msg[16];
+	for (uint16_t i = 0; i < 48; i++) {
+		size_t n = build_chunk_msg(msg, i, &digest_new[i * 12], 12);
+		ota_process_msg(msg, n);
+	}
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_INT(3 + 2 + 1, mock_flash_write_count);
+	uint8_t readback[48 * 12];
+	flash_peek(OTA_STAGING_ADDR, readback, size);
+	TEST_ASSERT_EQUAL_MEMORY(digest_new, readback, size);
+}
+
+/* Two adjacent changed chunks in page 1: the apply erases and programs
+ * that page only, the other three are journaled as they are */
+static void test_delta_apply_erases_only_changed_pages(void)
+{
+	uint32_t magic = APP_CALLBACK_MAGIC;
+
+	fill_digest_images();
+	memcpy(digest_old, &magic, sizeof(magic));   /* checked after apply */
+	memcpy(digest_new, &magic, sizeof(magic));
+	install_primary_cache();
+	uint16_t chunk = 300;                   /* offset 4500, page 1 */
+	memset(&digest_new[chunk * 15], 0x5A, 30);
+
+	uint8_t start[18];
+	build_start_msg(start, DIGEST_IMAGE_SIZE, 2, 15,
+			test_crc32(digest_new, DIGEST_IMAGE_SIZE), 2);
+	ota_process_msg(start, sizeof(start));
+
+	mock_flash_write_count = 0;
+	uint8_t msg[19];
+	for (uint16_t i = chunk; i < chunk + 2; i++) {
+		size_t n = build_chunk_msg(msg, i, &digest_new[i * 15], 15);
+		ota_process_msg(msg, n);
+	}
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	/* One 30-byte run, and the word that ends the receive session */
+	TEST_ASSERT_EQUAL_INT(2, mock_flash_write_count);
+
+	mock_flash_write_count = 0;
+	mock_flash_erase_count = 0;
+	memset(mock_flash_page_erases, 0, MOCK_FLASH_PAGES * sizeof(uint16_t));
+	mock_work_run_scheduled();
+	TEST_ASSERT_EQUAL_INT(1, mock_reboot_count);
+
+	uint32_t first = (OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE) / MOCK_FLASH_PAGE_SIZE;
+	for (uint32_t page = 0; page < DIGEST_PAGES; page++) {
+		TEST_ASSERT_EQUAL_UINT16(page == 1, mock_flash_page_erases[first + page]);
+	}
+	/* Erases: metadata page, page 1. Programs: the record, page 1, one
+	 * journal record per page, DONE */
+	TEST_ASSERT_EQUAL_INT(2, mock_flash_erase_count);
+	TEST_ASSERT_EQUAL_INT(2 + DIGEST_PAGES + 1, mock_flash_write_count);
+	TEST_ASSERT_EQUAL_MEMORY(digest_new,
+				 &mock_flash_mem[OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE],
+				 DIGEST_IMAGE_SIZE);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Large delta images: chunk tracking across the whole staging area    */
+/* ------------------------------------------------------------------ */
+
+#define BIG_CHUNKS     10000
+#define BIG_IMAGE_SIZE (BIG_CHUNKS * 15)
+
+static uint8_t big_old[BIG_IMAGE_SIZE];
+static uint8_t big_new[BIG_IMAGE_SIZE];
+
+/* Primary holds big_old; big_new starts as a copy of it */
+static void fill_big_images(void)
+{
+	uint32_t magic = APP_CALLBACK_MAGIC;
+
+	for (uint32_t i = 0; i < BIG_IMAGE_SIZE; i++) {
+		big_old[i] = (uint8_t)((i * 13) ^ (i >> 9));
+	}
+	memcpy(big_old, &magic, sizeof(magic));
+	memcpy(big_new, big_old, sizeof(big_new));
+	flash_put(OTA_APP_PRIMARY_ADDR, big_old, BIG_IMAGE_SIZE);
+}
+
+/* Change the given chunks of big_new, send them as a delta session, and
+ * apply it */
+static void run_big_delta(const uint16_t *chunks, uint16_t count)
+{
+	for (uint16_t i = 0; i < count; i++) {
+		uint32_t off = (uint32_t)chunks[i] * 15;
+		for (uint32_t b = (off ? 0 : 4); b < 15; b++) {
+			big_new[off + b] ^= 0xA5;
+		}
+	}
+
+	uint8_t start[18];
+	build_start_msg(start, BIG_IMAGE_SIZE, count, 15,
+			test_crc32(big_new, BIG_IMAGE_SIZE), 2);
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+
+	uint8_t msg[19];
+	for (uint16_t i = 0; i < count; i++) {
+		size_t n = build_chunk_msg(msg, chunks[i],
+					   &big_new[(uint32_t)chunks[i] * 15], 15);
+		ota_process_msg(msg, n);
+	}
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+
+	memset(mock_flash_page_erases, 0, MOCK_FLASH_PAGES * sizeof(uint16_t));
+	mock_work_run_scheduled();
+	TEST_ASSERT_EQUAL_INT(1, mock_reboot_count);
+	TEST_ASSERT_EQUAL_MEMORY(big_new,
+				 &mock_flash_mem[OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE],
+				 BIG_IMAGE_SIZE);
+}
+
+static void test_delta_10k_chunks_sparse_out_of_order(void)
+{
+	/* Word, summary-word and image edges, sent out of order */
+	static const uint16_t chunks[] = {
+		9999, 0, 5000, 1024, 1023, 31, 32, 2047, 2048, 9998,
+	};
+	uint16_t count = sizeof(chunks) / sizeof(chunks[0]);
+
+	fill_big_images();
+	run_big_delta(chunks, count);
+
+	/* Only the pages holding changed chunks were rewritten */
+	uint32_t first = (OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE) / MOCK_FLASH_PAGE_SIZE;
+	uint32_t erased = 0;
+	for (uint32_t p = 0; p < (BIG_IMAGE_SIZE + 4095) / 4096; p++) {
+		erased += mock_flash_page_erases[first + p];
+	}
+	/* Pages 0 (chunks 0, 31, 32), 3 (1023, 1024), 7 (2047, 2048),
+	 * 18 (5000) and 36 (9998, 9999) */
+	TEST_ASSERT_EQUAL_UINT32(5, erased);
+}
+
+static void test_delta_10k_chunks_dense(void)
+{
+	/* Every 3rd chunk plus a solid run across a summary boundary */
+	static uint16_t chunks[BIG_CHUNKS];
+	uint16_t count = 0;
+
+	for (uint16_t i = 0; i < BIG_CHUNKS; i++) {
+		if (i % 3 == 0 || (i >= 3000 && i < 3200)) {
+			chunks[count++] = i;
+		}
+	}
+	fill_big_images();
+	run_big_delta(chunks, count);
+}
+
+static void test_delta_duplicate_beyond_1024_acked(void)
+{
+	fill_big_images();
+	uint8_t start[18];
+	build_start_msg(start, BIG_IMAGE_SIZE, 2, 15, 0x12345678, 2);
+	ota_process_msg(start, sizeof(start));
+
+	uint8_t msg[19];
+	size_t n = build_chunk_msg(msg, 8000, &big_new[8000 * 15], 15);
+	ota_process_msg(msg, n);
+	ota_process_msg(msg, n);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+}
+
+static void test_delta_start_rejects_untrackable_image(void)
+{
+	/* The whole staging area fits at 15-byte chunks... */
+	uint8_t start[18];
+	build_start_msg(start, OTA_STAGING_SIZE, 3, 15, 0x12345678, 2);
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+
+	/* ...but not at 14-byte chunks */
+	ota_abort();
+	build_start_msg(start, OTA_STAGING_SIZE, 3, 14, 0x12345678, 2);
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_ACK, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_SIZE_ERR, send_buf[2]);
+	TEST_ASSERT_NOT_EQUAL(OTA_PHASE_RECEIVING, ota_get_phase());
+}
+
+static void test_start_rejects_bad_chunk_size(void)
+{
+	uint8_t start[18];
+
+	/* Chunk size 0 has no chunk count */
+	build_start_msg(start, 150, 10, 0, 0x12345678, 2);
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_SIZE_ERR, send_buf[2]);
+	TEST_ASSERT_NOT_EQUAL(OTA_PHASE_RECEIVING, ota_get_phase());
+
+	/* 2-byte chunks over 128 KiB: 65536 chunks, which wrapped to 0 in
+	 * 16 bits and passed the bitmap capacity check */
+	build_start_msg(start, 0x20000, 3, 2, 0x12345678, 2);
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_SIZE_ERR, send_buf[2]);
+	TEST_ASSERT_NOT_EQUAL(OTA_PHASE_RECEIVING, ota_get_phase());
+
+	/* Below the delta minimum even for a small image */
+	build_start_msg(start, 150, 3, OTA_DELTA_MIN_CHUNK_SIZE - 1, 0x12345678, 2);
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_SIZE_ERR, send_buf[2]);
+	TEST_ASSERT_NOT_EQUAL(OTA_PHASE_RECEIVING, ota_get_phase());
+
+	/* A full image may still use small chunks */
+	build_start_msg(start, 150, 75, 2, 0x12345678, 2);
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+}
+
+/* ------------------------------------------------------------------ */
+/*  Resumable receive: checkpoints survive a reboot                     */
+/* ------------------------------------------------------------------ */
+
+#define RESUME_CHUNKS ((DIGEST_IMAGE_SIZE + 14) / 15)
+
+static uint16_t ack_next(void)
+{
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_ACK, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+	return send_buf[3] | (send_buf[4] << 8);
+}
+
+/* Power loss: RAM state and the write combiner's pending run are gone */
+static void simulate_reboot(void)
+{
+	ota_init(mock_send);
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_IDLE, ota_get_phase());
+}
+
+static void send_digest_chunks(uint16_t first, uint16_t end)
+{
+	uint8_t msg[19];
+
+	for (uint16_t i = first; i < end; i++) {
+		uint32_t off = (uint32_t)i * 15;
+		uint16_t n = (off + 15 > DIGEST_IMAGE_SIZE) ? DIGEST_IMAGE_SIZE - off : 15;
+		size_t len = build_chunk_msg(msg, i, &digest_new[off], n);
+		ota_process_msg(msg, len);
+	}
+}
+
+static void start_digest_full(uint8_t *start)
+{
+	build_start_msg(start, DIGEST_IMAGE_SIZE, RESUME_CHUNKS, 15,
+			test_crc32(digest_new, DIGEST_IMAGE_SIZE), 2);
+	ota_process_msg(start, 18);
+}
+
+static void test_full_session_resumes_after_reboot(void)
+{
+	fill_digest_images();
+	uint8_t start[18];
+	start_digest_full(start);
+	TEST_ASSERT_EQUAL_UINT16(0, ack_next());
+
+	/* Checkpoints after chunks 16, 32 and 48; chunks 48-61 were still
+	 * in the write combiner */
+	send_digest_chunks(0, 62);
+	simulate_reboot();
+
+	mock_flash_erase_count = 0;
+	mock_flash_write_count = 0;
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+	TEST_ASSERT_EQUAL_UINT16(48, ack_next());
+	TEST_ASSERT_EQUAL_UINT16(48, send_buf[5] | (send_buf[6] << 8));
+	TEST_ASSERT_EQUAL_INT(0, mock_flash_erase_count);   /* staging kept */
+	TEST_ASSERT_EQUAL_INT(0, mock_flash_write_count);
+
+	send_digest_chunks(48, RESUME_CHUNKS);
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+
+	static uint8_t readback[DIGEST_IMAGE_SIZE];
+	flash_peek(OTA_STAGING_ADDR, readback, DIGEST_IMAGE_SIZE);
+	TEST_ASSERT_EQUAL_MEMORY(digest_new, readback, DIGEST_IMAGE_SIZE);
+
+	/* Validation ended the session: the next START begins again */
+	simulate_reboot();
+	start_digest_full(start);
+	TEST_ASSERT_EQUAL_UINT16(0, ack_next());
+}
+
+static void test_delta_session_resumes_after_reboot(void)
+{
+	uint16_t chunks[40];
+
+	fill_digest_images();
+	flash_put(OTA_APP_PRIMARY_ADDR, digest_old, DIGEST_IMAGE_SIZE);
+	for (uint16_t i = 0; i < 40; i++) {
+		chunks[i] = 3 + i * 20;
+		digest_new[chunks[i] * 15] ^= 0xFF;
+	}
+
+	uint8_t start[18];
+	build_start_msg(start, DIGEST_IMAGE_SIZE, 40, 15,
+			test_crc32(digest_new, DIGEST_IMAGE_SIZE), 2);
+	ota_process_msg(start, sizeof(start));
+	for (uint16_t i = 0; i < 35; i++) {
+		send_digest_chunks(chunks[i], chunks[i] + 1);
+	}
+	simulate_reboot();
+
+	/* The cloud resends from the 33rd changed chunk */
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_UINT16(32, ack_next());
+	for (uint16_t i = 32; i < 40; i++) {
+		send_digest_chunks(chunks[i], chunks[i] + 1);
+	}
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+}
+
+static void test_start_for_other_image_starts_over(void)
+{
+	fill_digest_images();
+	uint8_t start[18];
+	start_digest_full(start);
+	send_digest_chunks(0, 40);
+	simulate_reboot();
+
+	digest_new[0] ^= 0xFF;
+	start_digest_full(start);
+	TEST_ASSERT_EQUAL_UINT16(0, ack_next());
+
+	uint8_t b;
+	flash_peek(OTA_STAGING_ADDR, &b, 1);
+	TEST_ASSERT_EQUAL_HEX8(0xFF, b);
+
+	send_digest_chunks(0, RESUME_CHUNKS);
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+}
+
+static void test_resume_skips_torn_checkpoint(void)
+{
+	fill_digest_images();
+	uint8_t start[18];
+	start_digest_full(start);
+	send_digest_chunks(0, 40);
+
+	/* The checkpoint after chunk 32 was cut short */
+	uint8_t torn = 0x00;
+	flash_put(OTA_RX_RECS_ADDR + sizeof(struct ota_rx_rec) + 6, &torn, 1);
+	simulate_reboot();
+
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_UINT16(16, ack_next());
+
+	/* Chunks 16-31 are staged already: compared, not programmed again.
+	 * Only the checkpoint after chunk 32 is written. */
+	mock_flash_write_count = 0;
+	send_digest_chunks(16, 32);
+	TEST_ASSERT_EQUAL_INT(1, mock_flash_write_count);
+
+	send_digest_chunks(32, RESUME_CHUNKS);
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+}
+
+static void test_repeated_start_reports_progress(void)
+{
+	fill_digest_images();
+	uint8_t start[18];
+	start_digest_full(start);
+	send_digest_chunks(0, 5);
+
+	/* START again without a reboot (its ACK was lost): nothing erased */
+	mock_flash_erase_count = 0;
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_UINT16(5, ack_next());
+	TEST_ASSERT_EQUAL_INT(0, mock_flash_erase_count);
+
+	send_digest_chunks(5, RESUME_CHUNKS);
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+}
+
+static void test_abort_ends_resumable_session(void)
+{
+	fill_digest_images();
+	uint8_t start[18];
+	start_digest_full(start);
+	send_digest_chunks(0, 40);
+
+	uint8_t abort_msg[2] = { OTA_CMD_TYPE, OTA_SUB_ABORT };
+	ota_process_msg(abort_msg, sizeof(abort_msg));
+	simulate_reboot();
+
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_UINT16(0, ack_next());
+}
+
+static void test_patch_session_not_checkpointed(void)
+{
+	fill_digest_images();
+	uint8_t start[19];
+	start_digest_full(start);
+	send_digest_chunks(0, 40);
+	simulate_reboot();
+
+	/* A patch session replaces the full one and writes no header */
+	build_start_msg(start, DIGEST_IMAGE_SIZE, 100, 15,
+			test_crc32(digest_new, DIGEST_IMAGE_SIZE), 2);
+	start[18] = OTA_START_FLAGS_PATCH;
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_UINT16(0, ack_next());
+
+	struct ota_rx_session hdr;
+	flash_peek(OTA_RX_STATE_ADDR, &hdr, sizeof(hdr));
+	TEST_ASSERT_NOT_EQUAL(OTA_RX_MAGIC, hdr.magic);
+}
+
+/* A 9,000-chunk delta fills the checkpoint page about halfway through:
+ * it is rewritten with one record per non-empty bitmap word, and the
+ * session still resumes from it */
+static void test_delta_checkpoints_compact_and_resume(void)
+{
+	static uint16_t chunks[BIG_CHUNKS];
+	uint16_t count = 0;
+
+	fill_big_images();
+	for (uint16_t i = 0; i < BIG_CHUNKS; i++) {
+		if (i % 10 != 0) {
+			chunks[count++] = i;
+			big_new[(uint32_t)i * 15 + 7] ^= 0x5A;
+		}
+	}
+
+	uint8_t start[18];
+	build_start_msg(start, BIG_IMAGE_SIZE, count, 15,
+			test_crc32(big_new, BIG_IMAGE_SIZE), 2);
+	ota_process_msg(start, sizeof(start));
+
+	uint8_t msg[19];
+	mock_flash_erase_count = 0;
+	for (uint16_t i = 0; i < 8010; i++) {
+		size_t n = build_chunk_msg(msg, chunks[i],
+					   &big_new[(uint32_t)chunks[i] * 15], 15);
+		ota_process_msg(msg, n);
+	}
+	TEST_ASSERT_EQUAL_INT(1, mock_flash_erase_count);
+	simulate_reboot();
+
+	/* Checkpointed at 8000 received, less chunk 8888: its last 3 bytes
+	 * were a partial word, still in the write combiner */
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_UINT16(7999, ack_next());
+	for (uint16_t i = 7999; i < count; i++) {
+		size_t n = build_chunk_msg(msg, chunks[i],
+					   &big_new[(uint32_t)chunks[i] * 15], 15);
+		ota_process_msg(msg, n);
+	}
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+
+	mock_work_run_scheduled();
+	TEST_ASSERT_EQUAL_INT(1, mock_reboot_count);
+	TEST_ASSERT_EQUAL_MEMORY(big_new,
+				 &mock_flash_mem[OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE],
+				 BIG_IMAGE_SIZE);
+}
+
+/* ------------------------------------------------------------------ */
+/*  A/B slots: receive into the inactive slot, no copy                  */
+/* ------------------------------------------------------------------ */
+
+#define AB_IMAGE_SIZE (48 * 12)
+
+/* digest_new with a callback table magic, as activation checks it */
+static struct ota_boot_image ab_image(void)
+{
+	uint32_t magic = APP_CALLBACK_MAGIC;
+
+	fill_digest_images();
+	memcpy(digest_new, &magic, sizeof(magic));
+	struct ota_boot_image img = {
+		.size = AB_IMAGE_SIZE,
+		.crc32 = test_crc32(digest_new, AB_IMAGE_SIZE),
+		.version = 2,
+	};
+	return img;
+}
+
+static void ab_start(const struct ota_boot_image *img, uint16_t chunks, uint8_t flags)
+{
+	uint8_t start[19];
+	build_start_msg(start, img->size, chunks, 12, img->crc32, img->version);
+	start[18] = flags;
+	ota_process_msg(start, sizeof(start));
+}
+
+static void ab_send_chunks(void)
+{
+	uint8_t msg[16];
+	for (uint16_t i = 0; i < 48; i++) {
+		size_t n = build_chunk_msg(msg, i, &digest_new[i * 12], 12);
+		ota_process_msg(msg, n);
+	}
+}
+
+/* Slot B on a device that never had an A/B update: received straight
+ * into slot B, activated on trial, primary left alone */
+static void test_slot_b_session_activates_without_copy(void)
+{
+	struct ota_boot_image img = ab_image();
+
+	ab_start(&img, 48, OTA_START_FLAGS_SLOT_B);
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+	ab_send_chunks();
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+
+	mock_flash_erase_count = 0;
+	mock_flash_write_count = 0;
+	memset(mock_flash_page_erases, 0, MOCK_FLASH_PAGES * sizeof(uint16_t));
+	mock_work_run_scheduled();
+
+	TEST_ASSERT_EQUAL_INT(1, mock_reboot_count);
+	/* The first boot record and its page header, no erase: nothing
+	 * copied, nothing cleaned up */
+	TEST_ASSERT_EQUAL_INT(0, mock_flash_erase_count);
+	TEST_ASSERT_EQUAL_INT(2, mock_flash_write_count);
+	TEST_ASSERT_EQUAL_MEMORY(digest_new,
+				 &mock_flash_mem[OTA_SLOT_B_ADDR - MOCK_FLASH_BASE],
+				 AB_IMAGE_SIZE);
+
+	TEST_ASSERT_EQUAL_UINT8(OTA_SLOT_B, ota_boot_init());
+	TEST_ASSERT_TRUE(ota_boot_in_trial());
+	struct ota_boot_image rec;
+	TEST_ASSERT_TRUE(ota_boot_slot_image(OTA_SLOT_B, &rec));
+	TEST_ASSERT_EQUAL_HEX32(img.crc32, rec.crc32);
+	TEST_ASSERT_EQUAL_UINT32(2, rec.version);
+}
+
+/* Slot B runs: slot A's build goes into slot A directly and drops the
+ * primary page CRCs cached by an earlier copy */
+static void test_slot_a_session_while_b_runs(void)
+{
+	struct ota_boot_image img = ab_image();
+	struct ota_metadata meta;
+
+	install_primary_cache();
+	flash_put(OTA_SLOT_B_ADDR, digest_new, AB_IMAGE_SIZE);
+	TEST_ASSERT_EQUAL_INT(0, ota_boot_activate(OTA_SLOT_B, &img));
+	ota_boot_confirm();
+	digest_new[AB_IMAGE_SIZE - 1] ^= 0xFF;
+	img.crc32 = test_crc32(digest_new, AB_IMAGE_SIZE);
+
+	ab_start(&img, 48, 0);
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+	flash_peek(OTA_METADATA_ADDR, &meta, sizeof(meta));
+	TEST_ASSERT_NOT_EQUAL(OTA_META_MAGIC, meta.magic);
+
+	ab_send_chunks();
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	mock_work_run_scheduled();
+
+	TEST_ASSERT_EQUAL_INT(1, mock_reboot_count);
+	TEST_ASSERT_EQUAL_MEMORY(digest_new,
+				 &mock_flash_mem[OTA_SLOT_A_ADDR - MOCK_FLASH_BASE],
+				 AB_IMAGE_SIZE);
+	TEST_ASSERT_EQUAL_UINT8(OTA_SLOT_A, ota_boot_init());
+	TEST_ASSERT_TRUE(ota_boot_slot_valid(OTA_SLOT_B));
+}
+
+static void test_slot_b_start_while_b_runs_rejected(void)
+{
+	struct ota_boot_image img = ab_image();
+
+	TEST_ASSERT_EQUAL_INT(0, ota_boot_activate(OTA_SLOT_B, &img));
+	ota_boot_confirm();
+	img.crc32 ^= 1;
+
+	ab_start(&img, 48, OTA_START_FLAGS_SLOT_B);
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_IDLE, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_ACK, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_SLOT_ERR, send_buf[2]);
+}
+
+/* Slot B runs: a delta for slot A is received straight into slot A, and
+ * its unchanged chunks are copied from slot B, not from what A held */
+static void test_delta_for_slot_a_while_b_runs(void)
+{
+	struct ota_boot_image img = ab_image();
+	static uint8_t running[AB_IMAGE_SIZE];
+
+	memcpy(running, digest_new, AB_IMAGE_SIZE);
+	flash_put(OTA_SLOT_B_ADDR, running, AB_IMAGE_SIZE);
+	TEST_ASSERT_EQUAL_INT(0, ota_boot_activate(OTA_SLOT_B, &img));
+	ota_boot_confirm();
+	flash_put(OTA_SLOT_A_ADDR, digest_old, AB_IMAGE_SIZE);
+
+	/* Chunks 3 and 20 of 36 change */
+	memset(&digest_new[3 * 16], 0xA5, 16);
+	memset(&digest_new[20 * 16], 0x5A, 16);
+	img.crc32 = test_crc32(digest_new, AB_IMAGE_SIZE);
+
+	uint8_t start[19];
+	uint8_t msg[20];
+	build_start_msg(start, AB_IMAGE_SIZE, 2, 16, img.crc32, img.version);
+	start[18] = 0;
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+	ota_process_msg(msg, build_chunk_msg(msg, 3, &digest_new[3 * 16], 16));
+	ota_process_msg(msg, build_chunk_msg(msg, 20, &digest_new[20 * 16], 16));
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+
+	mock_work_run_scheduled();
+
+	TEST_ASSERT_EQUAL_INT(1, mock_reboot_count);
+	TEST_ASSERT_EQUAL_MEMORY(digest_new,
+				 &mock_flash_mem[OTA_SLOT_A_ADDR - MOCK_FLASH_BASE],
+				 AB_IMAGE_SIZE);
+	TEST_ASSERT_EQUAL_MEMORY(running,
+				 &mock_flash_mem[OTA_SLOT_B_ADDR - MOCK_FLASH_BASE],
+				 AB_IMAGE_SIZE);
+	TEST_ASSERT_EQUAL_UINT8(OTA_SLOT_A, ota_boot_init());
+	TEST_ASSERT_TRUE(ota_boot_in_trial());
+	TEST_ASSERT_TRUE(ota_boot_slot_valid(OTA_SLOT_B));
+}
+
+/* The trial slot's fallback must not be overwritten before it confirms */
+static void test_start_rejected_during_trial(void)
+{
+	struct ota_boot_image img = ab_image();
+
+	TEST_ASSERT_EQUAL_INT(0, ota_boot_activate(OTA_SLOT_B, &img));
+	ota_boot_init();
+	img.crc32 ^= 1;
+
+	ab_start(&img, 48, 0);
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_IDLE, ota_get_phase());
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_NO_SESSION, send_buf[2]);
+}
+
+/* A COMPLETE lost before the slot flip: the running slot's record says
+ * the image is there, without reading flash */
+static void test_start_already_applied_answered_from_slot_record(void)
+{
+	struct ota_boot_image img = ab_image();
+
+	TEST_ASSERT_EQUAL_INT(0, ota_boot_activate(OTA_SLOT_B, &img));
+	ota_boot_init();
+
+	mock_flash_read_count = 0;
+	ab_start(&img, 48, OTA_START_FLAGS_SLOT_B);
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+	TEST_ASSERT_EQUAL_INT(0, mock_flash_read_count);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Bitmap ACKs: delta chunks ACKed every N with the receive bitfield  */
+/* ------------------------------------------------------------------ */
+
+/* Delta session over a 100-chunk image that asks for a bitmap ACK
+ * every `every` chunks */
+static void enter_receiving_delta_acked(uint16_t delta_count, uint8_t every)
+{
+	uint8_t start[19];
+	build_start_msg(start, 1500, delta_count, 15, 0x12345678, 1);
+	start[18] = every << OTA_START_FLAGS_ACK_SHIFT;
+	ota_process_msg(start, sizeof(start));
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+	send_count = 0;
+}
+
+static uint16_t ack_u16(size_t off)
+{
+	return send_buf[off] | (send_buf[off + 1] << 8);
+}
+
+static uint64_t ack_bitmap(void)
+{
+	uint64_t bits = 0;
+	for (int i = 7; i >= 0; i--) {
+		bits = (bits << 8) | send_buf[9 + i];
+	}
+	return bits;
+}
+
+static void test_bitmap_ack_every_n_chunks(void)
+{
+	enter_receiving_delta_acked(20, 4);
+
+	send_filler_chunk(40, 15);
+	send_filler_chunk(41, 15);
+	send_filler_chunk(42, 15);
+	TEST_ASSERT_EQUAL_INT(0, send_count);
+
+	/* 43 lost in transit */
+	send_filler_chunk(44, 15);
+	TEST_ASSERT_EQUAL_INT(1, send_count);
+	TEST_ASSERT_EQUAL_size_t(OTA_ACK_BITMAP_LEN, send_len);
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_ACK, send_buf[1]);
+	TEST_ASSERT_EQUAL_HEX8(OTA_STATUS_OK, send_buf[2]);
+	TEST_ASSERT_EQUAL_UINT16(4, ack_u16(5));
+	TEST_ASSERT_EQUAL_UINT16(32, ack_u16(7));
+	TEST_ASSERT_EQUAL_HEX64(0x1700, ack_bitmap());
+
+	/* The next ACK waits for four more chunks */
+	send_filler_chunk(43, 15);
+	send_filler_chunk(45, 15);
+	send_filler_chunk(46, 15);
+	TEST_ASSERT_EQUAL_INT(1, send_count);
+	send_filler_chunk(47, 15);
+	TEST_ASSERT_EQUAL_INT(2, send_count);
+	TEST_ASSERT_EQUAL_UINT16(8, ack_u16(5));
+	TEST_ASSERT_EQUAL_HEX64(0xFF00, ack_bitmap());
+}
+
+static void test_bitmap_ack_based_on_lowest_new_chunk(void)
+{
+	enter_receiving_delta_acked(20, 4);
+
+	send_filler_chunk(70, 15);
+	send_filler_chunk(35, 15);
+	send_filler_chunk(36, 15);
+	send_filler_chunk(37, 15);
+	TEST_ASSERT_EQUAL_INT(1, send_count);
+	TEST_ASSERT_EQUAL_UINT16(32, ack_u16(7));
+	TEST_ASSERT_EQUAL_HEX64((1ull << 3) | (1ull << 4) | (1ull << 5) | (1ull << 38),
+				ack_bitmap());
+}
+
+static void test_bitmap_ack_on_duplicate_at_once(void)
+{
+	enter_receiving_delta_acked(20, 8);
+
+	send_filler_chunk(10, 15);
+	TEST_ASSERT_EQUAL_INT(0, send_count);
+
+	send_filler_chunk(10, 15);
+	TEST_ASSERT_EQUAL_INT(1, send_count);
+	TEST_ASSERT_EQUAL_size_t(OTA_ACK_BITMAP_LEN, send_len);
+	TEST_ASSERT_EQUAL_UINT16(1, ack_u16(5));
+	TEST_ASSERT_EQUAL_UINT16(0, ack_u16(7));
+	TEST_ASSERT_EQUAL_HEX64(1ull << 10, ack_bitmap());
+}
+
+static void test_bitmap_ack_last_chunk_completes(void)
+{
+	enter_receiving_delta_acked(3, 8);
+
+	send_filler_chunk(1, 15);
+	send_filler_chunk(2, 15);
+	send_filler_chunk(99, 15);
+
+	/* Nothing but the COMPLETE */
+	TEST_ASSERT_EQUAL_INT(1, send_count);
+	TEST_ASSERT_EQUAL_HEX8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_NOT_EQUAL(OTA_PHASE_RECEIVING, ota_get_phase());
+}
+
+static void test_ack_interval_ignored_outside_delta(void)
+{
+	uint8_t start[19];
+	build_start_msg(start, 150, 10, 15, 0x12345678, 1);
+	start[18] = 4 << OTA_START_FLAGS_ACK_SHIFT;
+	ota_process_msg(start, sizeof(start));
+	send_count = 0;
+
+	send_filler_chunk(0, 15);
+	TEST_ASSERT_EQUAL_INT(1, send_count);
+	TEST_ASSERT_EQUAL_size_t(OTA_ACK_LEN, send_len);
+}
+
 /* ------------------------------------------------------------------ */
 /*  Main                                                               */
 /* ------------------------------------------------------------------ */
@@ -551,5 +1567,49 @@ int main(void)
 	RUN_TEST(test_delta_chunk_beyond_image_rejected);
 	RUN_TEST(test_chunk_payload_too_short_rejected);
 
+	/* Receive-time digests */
+	RUN_TEST(test_full_session_validates_without_reading_back);
+	RUN_TEST(test_full_session_crc_mismatch_detected_on_receipt);
+	RUN_TEST(test_delta_with_primary_cache_reads_touched_page_only);
+	RUN_TEST(test_delta_without_cache_reads_every_page);
+	RUN_TEST(test_start_already_applied_answered_from_cache);
+	RUN_TEST(test_start_new_image_skips_primary_crc_with_cache);
+
+	/* Program/erase counts */
+	RUN_TEST(test_full_session_programs_staging_in_runs);
+	RUN_TEST(test_delta_apply_erases_only_changed_pages);
+
+	/* Large delta images */
+	RUN_TEST(test_delta_10k_chunks_sparse_out_of_order);
+	RUN_TEST(test_delta_10k_chunks_dense);
+	RUN_TEST(test_delta_duplicate_beyond_1024_acked);
+	RUN_TEST(test_delta_start_rejects_untrackable_image);
+	RUN_TEST(test_start_rejects_bad_chunk_size);
+
+	/* Resumable receive */
+	RUN_TEST(test_full_session_resumes_after_reboot);
+	RUN_TEST(test_delta_session_resumes_after_reboot);
+	RUN_TEST(test_start_for_other_image_starts_over);
+	RUN_TEST(test_resume_skips_torn_checkpoint);
+	RUN_TEST(test_repeated_start_reports_progress);
+	RUN_TEST(test_abort_ends_resumable_session);
+	RUN_TEST(test_patch_session_not_checkpointed);
+	RUN_TEST(test_delta_checkpoints_compact_and_resume);
+
+	/* A/B slots */
+	RUN_TEST(test_slot_b_session_activates_without_copy);
+	RUN_TEST(test_slot_a_session_while_b_runs);
+	RUN_TEST(test_slot_b_start_while_b_runs_rejected);
+	RUN_TEST(test_delta_for_slot_a_while_b_runs);
+	RUN_TEST(test_start_rejected_during_trial);
+	RUN_TEST(test_start_already_applied_answered_from_slot_record);
+
+	/* Bitmap ACKs */
+	RUN_TEST(test_bitmap_ack_every_n_chunks);
+	RUN_TEST(test_bitmap_ack_based_on_lowest_new_chunk);
+	RUN_TEST(test_bitmap_ack_on_duplicate_at_once);
+	RUN_TEST(test_bitmap_ack_last_chunk_completes);
+	RUN_TEST(test_ack_interval_ignored_outside_delta);
+
 	return UNITY_END();
 }
@@ -0,0 +1,246 @@
+/*
+ * Host-side tests for the OTA flash helpers.
+ *
+ * Covers ota_flash_write() alignment padding, the write combiner that
+ * gathers OTA chunks into word-aligned runs, and the compare helpers the
+ * apply path uses to skip pages that did not change. The mock flash has
+ * NOR semantics (programming only clears bits), so a padding byte that is
+ * not 0xFF shows up as corrupted neighbouring data, and a third program
+ * of a word between erases fails as nWRITE says.
+ */
+
+#include "unity.h"
+#include <ota_flash.h>
+#include <ota_update.h>
+#include <string.h>
+
+extern uint8_t mock_flash_mem[];
+extern int mock_flash_write_count;
+extern uint8_t mock_flash_word_writes[];
+extern int mock_flash_nwrite_errors;
+extern void mock_flash_reset(void);
+
+#define MOCK_FLASH_BASE 0x90000
+#define BASE            OTA_STAGING_ADDR
+
+static uint8_t *flash_at(uint32_t addr)
+{
+	return &mock_flash_mem[addr - MOCK_FLASH_BASE];
+}
+
+static uint8_t data[1024];
+
+void setUp(void)
+{
+	mock_flash_reset();
+	for (size_t i = 0; i < sizeof(data); i++) {
+		data[i] = (uint8_t)(i * 7 + 1);
+	}
+}
+
+void tearDown(void) { }
+
+/* ------------------------------------------------------------------ */
+/*  ota_flash_write                                                     */
+/* ------------------------------------------------------------------ */
+
+static void test_write_unaligned_short_is_one_program(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_write(BASE + 3, data, 15));
+	TEST_ASSERT_EQUAL_INT(1, mock_flash_write_count);
+	TEST_ASSERT_EQUAL_MEMORY(data, flash_at(BASE + 3), 15);
+	TEST_ASSERT_EQUAL_HEX8(0xFF, *flash_at(BASE + 2));
+	TEST_ASSERT_EQUAL_HEX8(0xFF, *flash_at(BASE + 18));
+}
+
+static void test_write_unaligned_long(void)
+{
+	/* Longer than the padding buffer: used to fail with -ENOMEM */
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_write(BASE + 1, data, 601));
+	TEST_ASSERT_EQUAL_MEMORY(data, flash_at(BASE + 1), 601);
+	TEST_ASSERT_EQUAL_HEX8(0xFF, *flash_at(BASE));
+	TEST_ASSERT_EQUAL_HEX8(0xFF, *flash_at(BASE + 602));
+	/* Head word, body, tail word */
+	TEST_ASSERT_EQUAL_INT(3, mock_flash_write_count);
+}
+
+static void test_write_padding_keeps_neighbours(void)
+{
+	/* Bytes already programmed on both sides of the target range */
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_write(BASE, data, 2));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_write(BASE + 43, data + 43, 5));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_write(BASE + 2, data + 2, 41));
+	TEST_ASSERT_EQUAL_MEMORY(data, flash_at(BASE), 48);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Write combiner                                                      */
+/* ------------------------------------------------------------------ */
+
+static struct ota_flash_writer w;
+
+static void test_writer_combines_chunks_into_runs(void)
+{
+	ota_flash_writer_init(&w);
+
+	/* 40 chunks of 15 bytes: two full runs go out as they fill */
+	for (uint32_t off = 0; off < 600; off += 15) {
+		TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_put(&w, BASE + off,
+							      data + off, 15));
+	}
+	TEST_ASSERT_EQUAL_INT(2, mock_flash_write_count);
+	TEST_ASSERT_EQUAL_MEMORY(data, flash_at(BASE), 2 * OTA_FLASH_RUN_SIZE);
+	TEST_ASSERT_EQUAL_HEX8(0xFF, *flash_at(BASE + 2 * OTA_FLASH_RUN_SIZE));
+
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_finish(&w));
+	TEST_ASSERT_EQUAL_INT(3, mock_flash_write_count);
+	TEST_ASSERT_EQUAL_MEMORY(data, flash_at(BASE), 600);
+
+	/* Nothing new: no program */
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_flush(&w));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_finish(&w));
+	TEST_ASSERT_EQUAL_INT(3, mock_flash_write_count);
+}
+
+static void test_writer_unaligned_start(void)
+{
+	ota_flash_writer_init(&w);
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_write(BASE, data, 3));
+
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_put(&w, BASE + 3, data + 3, 300));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_finish(&w));
+	TEST_ASSERT_EQUAL_MEMORY(data, flash_at(BASE), 303);
+	TEST_ASSERT_EQUAL_HEX8(0xFF, *flash_at(BASE + 303));
+}
+
+static void test_writer_flush_mid_word_then_continue(void)
+{
+	uint32_t at;
+
+	ota_flash_writer_init(&w);
+
+	/* The word holding bytes 12-14 stays in RAM until it is complete */
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_put(&w, BASE, data, 15));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_flush(&w));
+	TEST_ASSERT_EQUAL_MEMORY(data, flash_at(BASE), 12);
+	TEST_ASSERT_TRUE(ota_flash_is_erased(BASE + 12, 4));
+	TEST_ASSERT_EQUAL_size_t(3, ota_flash_writer_held(&w, &at));
+	TEST_ASSERT_EQUAL_HEX32(BASE + 12, at);
+
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_put(&w, BASE + 15, data + 15, 15));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_flush(&w));
+	TEST_ASSERT_EQUAL_MEMORY(data, flash_at(BASE), 28);
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_finish(&w));
+	TEST_ASSERT_EQUAL_MEMORY(data, flash_at(BASE), 30);
+	TEST_ASSERT_EQUAL_size_t(0, ota_flash_writer_held(&w, &at));
+
+	/* Every word programmed once */
+	TEST_ASSERT_EQUAL_INT(3, mock_flash_write_count);
+	for (uint32_t i = 0; i < 8; i++) {
+		TEST_ASSERT_EQUAL_UINT8(1, mock_flash_word_writes[(BASE - MOCK_FLASH_BASE) / 4 + i]);
+	}
+}
+
+static void test_writer_shared_word_programmed_twice(void)
+{
+	ota_flash_writer_init(&w);
+
+	/* Chunk 1 finished alone, then chunk 0 ends in the same word */
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_put(&w, BASE + 15, data + 15, 15));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_finish(&w));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_put(&w, BASE, data, 15));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_finish(&w));
+	TEST_ASSERT_EQUAL_MEMORY(data, flash_at(BASE), 30);
+	TEST_ASSERT_EQUAL_UINT8(2, mock_flash_word_writes[(BASE - MOCK_FLASH_BASE) / 4 + 3]);
+
+	/* A third program of that word is past nWRITE and fails */
+	TEST_ASSERT_NOT_EQUAL(0, ota_flash_write(BASE + 12, data, 1));
+	TEST_ASSERT_EQUAL_INT(1, mock_flash_nwrite_errors);
+	mock_flash_nwrite_errors = 0;
+}
+
+static void test_writer_gap_starts_new_run(void)
+{
+	ota_flash_writer_init(&w);
+
+	/* Sparse delta chunks 2, 3 and 7 */
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_put(&w, BASE + 30, data + 30, 15));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_put(&w, BASE + 45, data + 45, 15));
+	TEST_ASSERT_EQUAL_INT(0, mock_flash_write_count);
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_put(&w, BASE + 105, data + 105, 15));
+	TEST_ASSERT_EQUAL_INT(1, mock_flash_write_count);   /* chunks 2-3 */
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_finish(&w));
+	TEST_ASSERT_EQUAL_INT(2, mock_flash_write_count);
+
+	TEST_ASSERT_EQUAL_MEMORY(data + 30, flash_at(BASE + 30), 30);
+	TEST_ASSERT_EQUAL_MEMORY(data + 105, flash_at(BASE + 105), 15);
+	TEST_ASSERT_TRUE(ota_flash_is_erased(BASE + 60, 45));
+
+	/* A chunk filling the gap afterwards shares words with both sides */
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_put(&w, BASE + 90, data + 90, 15));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_finish(&w));
+	TEST_ASSERT_EQUAL_MEMORY(data + 90, flash_at(BASE + 90), 30);
+	TEST_ASSERT_EQUAL_MEMORY(data + 30, flash_at(BASE + 30), 30);
+}
+
+static void test_writer_init_drops_unflushed(void)
+{
+	ota_flash_writer_init(&w);
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_put(&w, BASE, data, 15));
+	ota_flash_writer_init(&w);
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_writer_finish(&w));
+	TEST_ASSERT_EQUAL_INT(0, mock_flash_write_count);
+	TEST_ASSERT_TRUE(ota_flash_is_erased(BASE, 16));
+}
+
+/* ------------------------------------------------------------------ */
+/*  Compare helpers                                                     */
+/* ------------------------------------------------------------------ */
+
+static void test_equals_and_is_erased(void)
+{
+	TEST_ASSERT_TRUE(ota_flash_is_erased(BASE, OTA_FLASH_PAGE_SIZE));
+	TEST_ASSERT_EQUAL_INT(0, ota_flash_write(BASE + 1000, data, 600));
+
+	TEST_ASSERT_TRUE(ota_flash_equals(BASE + 1000, data, 600));
+	TEST_ASSERT_FALSE(ota_flash_equals(BASE + 1000, data + 1, 600));
+	TEST_ASSERT_FALSE(ota_flash_is_erased(BASE, OTA_FLASH_PAGE_SIZE));
+	TEST_ASSERT_TRUE(ota_flash_is_erased(BASE, 1000));
+	TEST_ASSERT_TRUE(ota_flash_is_erased(BASE + 1600, 7));
+	TEST_ASSERT_FALSE(ota_flash_is_erased(BASE + 1597, 7));
+
+	/* Last byte of the range differs */
+	*flash_at(BASE + 1599) = 0;
+	TEST_ASSERT_FALSE(ota_flash_equals(BASE + 1000, data, 600));
+
+	/* Outside the flash: never equal, never erased */
+	TEST_ASSERT_FALSE(ota_flash_equals(0x10, data, 4));
+	TEST_ASSERT_FALSE(ota_flash_is_erased(0x10, 4));
+}
+
+/* ------------------------------------------------------------------ */
+/*  Main                                                               */
+/* ------------------------------------------------------------------ */
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	/* ota_flash_write */
+	RUN_TEST(test_write_unaligned_short_is_one_program);
+	RUN_TEST(test_write_unaligned_long);
+	RUN_TEST(test_write_padding_keeps_neighbours);
+
+	/* Write combiner */
+	RUN_TEST(test_writer_combines_chunks_into_runs);
+	RUN_TEST(test_writer_unaligned_start);
+	RUN_TEST(test_writer_flush_mid_word_then_continue);
+	RUN_TEST(test_writer_shared_word_programmed_twice);
+	RUN_TEST(test_writer_gap_starts_new_run);
+	RUN_TEST(test_writer_init_drops_unflushed);
+
+	/* Compare helpers */
+	RUN_TEST(test_equals_and_is_erased);
+
+	return UNITY_END();
+}
@@ -0,0 +1,472 @@
+/*
+ * Host-side tests for the streaming OTA decompressor.
+ *
+ * Covers ota_lz.c directly (bit decoding across feed boundaries, window
+ * wrap, sink blocks, corrupt-stream checks) and compressed OTA sessions
+ * through ota_process_msg(): START with OTA_START_FLAGS_COMPRESSED, chunks
+ * decoded into staging, then the normal CRC validation.
+ *
+ * Streams are assembled with a small bit writer here, except one vector
+ * produced by the cloud encoder (aws/ota_compress.py) to pin the format.
+ */
+
+#include "unity.h"
+#include <ota_lz.h>
+#include <ota_update.h>
+#include <platform_api.h>
+#include <errno.h>
+#include <string.h>
+
+extern uint8_t mock_flash_mem[];
+extern void mock_flash_reset(void);
+
+#define MOCK_FLASH_BASE 0x90000
+#define CHUNK_SIZE      15
+
+/* Uplink capture */
+static uint8_t send_buf[64];
+static size_t send_len;
+static int send_count;
+
+static int mock_send(const uint8_t *data, size_t len)
+{
+	if (len <= sizeof(send_buf)) {
+		memcpy(send_buf, data, len);
+	}
+	send_len = len;
+	send_count++;
+	return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Helpers                                                            */
+/* ------------------------------------------------------------------ */
+
+static uint8_t window[OTA_LZ_WINDOW_SIZE];
+static uint8_t image[12288];
+static uint8_t stream[12288];
+static size_t stream_len;
+static uint32_t stream_bits;
+static uint8_t stream_nbits;
+
+/* RAM sink: decoded bytes land in out[], sink calls are recorded */
+static uint8_t out[12288];
+static size_t out_len;
+static int sink_calls;
+static size_t sink_max;
+
+static int ram_sink(void *ctx, const uint8_t *data, size_t len)
+{
+	(void)ctx;
+	memcpy(&out[out_len], data, len);
+	out_len += len;
+	sink_calls++;
+	if (len > sink_max) {
+		sink_max = len;
+	}
+	return 0;
+}
+
+static int failing_sink(void *ctx, const uint8_t *data, size_t len)
+{
+	(void)ctx;
+	(void)data;
+	(void)len;
+	return -EIO;
+}
+
+static const uint8_t *flash_at(uint32_t addr)
+{
+	return &mock_flash_mem[addr - MOCK_FLASH_BASE];
+}
+
+static uint32_t test_crc32(const uint8_t *data, size_t len)
+{
+	uint32_t crc = ~0u;
+	for (size_t i = 0; i < len; i++) {
+		crc ^= data[i];
+		for (int j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+static void put_bits(uint32_t value, uint8_t n)
+{
+	stream_bits = (stream_bits << n) | value;
+	stream_nbits += n;
+	while (stream_nbits >= 8) {
+		stream_nbits -= 8;
+		stream[stream_len++] = (uint8_t)(stream_bits >> stream_nbits);
+	}
+	stream_bits &= (1u << stream_nbits) - 1;
+}
+
+static void put_literal(uint8_t b)
+{
+	put_bits(0x100 | b, 9);
+}
+
+static void put_backref(uint32_t dist, uint32_t count)
+{
+	put_bits(0, 1);
+	put_bits(dist - 1, OTA_LZ_WINDOW_BITS);
+	put_bits(count - 1, OTA_LZ_LOOKAHEAD_BITS);
+}
+
+static void put_end(void)
+{
+	if (stream_nbits) {
+		put_bits(0, 8 - stream_nbits);
+	}
+}
+
+static void lz_start(struct ota_lz *z, uint32_t size)
+{
+	ota_lz_init(z, window, size, ram_sink, NULL);
+}
+
+static int feed_in_steps(struct ota_lz *z, size_t step)
+{
+	for (size_t off = 0; off < stream_len; off += step) {
+		size_t n = (stream_len - off < step) ? stream_len - off : step;
+		int err = ota_lz_feed(z, &stream[off], n);
+		if (err) {
+			return err;
+		}
+	}
+	return ota_lz_finish(z);
+}
+
+/* A repetitive image longer than the window, and a stream for it that
+ * mixes literals with short and long-distance back-references */
+static size_t build_long_image(void)
+{
+	size_t len = 0;
+
+	for (int i = 0; i < 64; i++) {
+		image[len] = (uint8_t)(i * 37);
+		put_literal(image[len++]);
+	}
+	while (len < 9000) {
+		uint32_t dist = (len % 3 == 0) ? 64 : (len > 4096 ? 4096 : 17);
+		for (int k = 0; k < 16; k++, len++) {
+			image[len] = image[len - dist];
+		}
+		put_backref(dist, 16);
+		image[len] = (uint8_t)len;
+		put_literal(image[len++]);
+	}
+	put_end();
+	return len;
+}
+
+static void build_start_msg(uint8_t *msg, uint32_t total_size, uint16_t total_chunks,
+			    uint32_t crc32, uint8_t flags)
+{
+	msg[0] = OTA_CMD_TYPE;
+	msg[1] = OTA_SUB_START;
+	for (int i = 0; i < 4; i++) {
+		msg[2 + i] = (uint8_t)(total_size >> (8 * i));
+		msg[10 + i] = (uint8_t)(crc32 >> (8 * i));
+		msg[14 + i] = (uint8_t)(2 >> (8 * i));
+	}
+	msg[6] = (uint8_t)total_chunks;
+	msg[7] = (uint8_t)(total_chunks >> 8);
+	msg[8] = CHUNK_SIZE;
+	msg[9] = 0;
+	msg[18] = flags;
+}
+
+/* Start a compressed session for image[0..size) and send the stream */
+static void run_lz_session(uint32_t size)
+{
+	uint16_t chunks = (stream_len + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	uint8_t msg[19];
+
+	build_start_msg(msg, size, chunks, test_crc32(image, size),
+			OTA_START_FLAGS_COMPRESSED);
+	ota_process_msg(msg, sizeof(msg));
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+
+	for (uint16_t i = 0; i < chunks && ota_get_phase() == OTA_PHASE_RECEIVING; i++) {
+		uint8_t chunk[4 + CHUNK_SIZE];
+		size_t off = (size_t)i * CHUNK_SIZE;
+		size_t n = (stream_len - off < CHUNK_SIZE) ? stream_len - off : CHUNK_SIZE;
+
+		chunk[0] = OTA_CMD_TYPE;
+		chunk[1] = OTA_SUB_CHUNK;
+		chunk[2] = (uint8_t)i;
+		chunk[3] = (uint8_t)(i >> 8);
+		memcpy(&chunk[4], &stream[off], n);
+		ota_process_msg(chunk, 4 + n);
+	}
+}
+
+void setUp(void)
+{
+	mock_flash_reset();
+	send_count = 0;
+	send_len = 0;
+	memset(send_buf, 0, sizeof(send_buf));
+	stream_len = 0;
+	stream_bits = 0;
+	stream_nbits = 0;
+	out_len = 0;
+	sink_calls = 0;
+	sink_max = 0;
+	ota_init(mock_send);
+}
+
+void tearDown(void) { }
+
+/* ------------------------------------------------------------------ */
+/*  Decoder                                                            */
+/* ------------------------------------------------------------------ */
+
+/* Produced by aws/ota_compress.py compress() for
+ * b"EVSE monitor " * 4 + bytes(range(20)) */
+static const uint8_t cloud_vector[] = {
+	0xa2, 0xd5, 0xaa, 0x74, 0x59, 0x05, 0xb6, 0xdf, 0x6e, 0xb4, 0xdd,
+	0x2d, 0xf7, 0x29, 0x00, 0x03, 0x18, 0x01, 0x9e, 0x00, 0xcf, 0x80,
+	0x40, 0x60, 0x50, 0x38, 0x24, 0x16, 0x0d, 0x07, 0x84, 0x42, 0x61,
+	0x50, 0xb8, 0x64, 0x36, 0x1d, 0x0f, 0x88, 0x44, 0x62, 0x51, 0x30,
+};
+
+static void test_cloud_vector_decodes(void)
+{
+	struct ota_lz z;
+	uint8_t expect[72];
+
+	for (int i = 0; i < 4; i++) {
+		memcpy(&expect[i * 13], "EVSE monitor ", 13);
+	}
+	for (int i = 0; i < 20; i++) {
+		expect[52 + i] = (uint8_t)i;
+	}
+
+	memcpy(stream, cloud_vector, sizeof(cloud_vector));
+	stream_len = sizeof(cloud_vector);
+	lz_start(&z, sizeof(expect));
+	TEST_ASSERT_EQUAL_INT(0, feed_in_steps(&z, CHUNK_SIZE));
+	TEST_ASSERT_EQUAL_UINT32(sizeof(expect), out_len);
+	TEST_ASSERT_EQUAL_MEMORY(expect, out, sizeof(expect));
+}
+
+static void test_byte_at_a_time_matches_whole_feed(void)
+{
+	struct ota_lz z;
+	size_t len = build_long_image();
+
+	lz_start(&z, len);
+	TEST_ASSERT_EQUAL_INT(0, feed_in_steps(&z, 1));
+	TEST_ASSERT_EQUAL_UINT32(len, out_len);
+	TEST_ASSERT_EQUAL_MEMORY(image, out, len);
+
+	out_len = 0;
+	lz_start(&z, len);
+	TEST_ASSERT_EQUAL_INT(0, feed_in_steps(&z, stream_len));
+	TEST_ASSERT_EQUAL_MEMORY(image, out, len);
+}
+
+static void test_backrefs_reach_across_window_wrap(void)
+{
+	struct ota_lz z;
+	size_t len = build_long_image();
+
+	/* The image is more than twice the window, so distance-4096 copies
+	 * read history that has already wrapped */
+	TEST_ASSERT_TRUE(len > 2 * OTA_LZ_WINDOW_SIZE);
+	lz_start(&z, len);
+	TEST_ASSERT_EQUAL_INT(0, feed_in_steps(&z, 7));
+	TEST_ASSERT_EQUAL_MEMORY(image, out, len);
+}
+
+static void test_sink_gets_fixed_blocks_and_a_tail(void)
+{
+	struct ota_lz z;
+	size_t len = build_long_image();
+
+	lz_start(&z, len);
+	TEST_ASSERT_EQUAL_INT(0, feed_in_steps(&z, CHUNK_SIZE));
+	TEST_ASSERT_EQUAL_INT((len + OTA_LZ_SINK_BLOCK - 1) / OTA_LZ_SINK_BLOCK,
+			      sink_calls);
+	TEST_ASSERT_EQUAL_UINT32(OTA_LZ_SINK_BLOCK, sink_max);
+}
+
+static void test_distance_before_start_rejected(void)
+{
+	struct ota_lz z;
+
+	put_literal('A');
+	put_literal('B');
+	put_backref(3, 4);
+	put_end();
+
+	lz_start(&z, 6);
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, ota_lz_feed(&z, stream, stream_len));
+	/* A failed decoder stays failed */
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, ota_lz_feed(&z, stream, 1));
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, ota_lz_finish(&z));
+}
+
+static void test_output_past_size_rejected(void)
+{
+	struct ota_lz z;
+
+	put_literal('A');
+	put_backref(1, 8);
+	put_end();
+
+	lz_start(&z, 5);
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, ota_lz_feed(&z, stream, stream_len));
+}
+
+static void test_trailing_input_rejected(void)
+{
+	struct ota_lz z;
+
+	put_literal('A');
+	put_literal('B');
+	put_end();
+	stream[stream_len++] = 0x00;   /* a whole byte past the image */
+
+	lz_start(&z, 2);
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, ota_lz_feed(&z, stream, stream_len));
+}
+
+static void test_padding_is_not_decoded(void)
+{
+	struct ota_lz z;
+
+	/* 2 literals = 18 bits; the 6 zero pad bits would start a
+	 * back-reference if the decoder did not stop at out_size */
+	put_literal('O');
+	put_literal('K');
+	put_end();
+
+	lz_start(&z, 2);
+	TEST_ASSERT_EQUAL_INT(0, feed_in_steps(&z, 1));
+	TEST_ASSERT_EQUAL_MEMORY("OK", out, 2);
+}
+
+static void test_short_stream_fails_finish(void)
+{
+	struct ota_lz z;
+
+	put_literal('A');
+	put_backref(1, 16);
+	put_end();
+
+	lz_start(&z, 40);
+	TEST_ASSERT_EQUAL_INT(0, ota_lz_feed(&z, stream, stream_len));
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, ota_lz_finish(&z));
+}
+
+static void test_sink_error_propagates(void)
+{
+	struct ota_lz z;
+	size_t len = build_long_image();
+
+	ota_lz_init(&z, window, len, failing_sink, NULL);
+	TEST_ASSERT_EQUAL_INT(-EIO, ota_lz_feed(&z, stream, stream_len));
+}
+
+/* ------------------------------------------------------------------ */
+/*  Compressed OTA sessions                                            */
+/* ------------------------------------------------------------------ */
+
+static void test_session_compressed_completes_with_crc(void)
+{
+	size_t len = build_long_image();
+
+	run_lz_session(len);
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_UINT8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_UINT8(OTA_STATUS_OK, send_buf[2]);
+	TEST_ASSERT_EQUAL_MEMORY(image, flash_at(OTA_STAGING_ADDR), len);
+}
+
+static void test_session_compressed_is_not_delta_mode(void)
+{
+	/* The stream needs far fewer chunks than the image; it must still be
+	 * received sequentially rather than as sparse delta chunks */
+	size_t len = build_long_image();
+
+	TEST_ASSERT_TRUE(stream_len < len / 2);
+	run_lz_session(len);
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+}
+
+static void test_session_corrupt_stream_acks_patch_err(void)
+{
+	put_literal('A');
+	put_backref(9, 4);
+	for (int i = 0; i < 40; i++) {
+		put_literal('x');
+	}
+	put_end();
+	memset(image, 0, 45);
+
+	run_lz_session(45);
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_ERROR, ota_get_phase());
+	TEST_ASSERT_EQUAL_UINT8(OTA_SUB_ACK, send_buf[1]);
+	TEST_ASSERT_EQUAL_UINT8(OTA_STATUS_PATCH_ERR, send_buf[2]);
+}
+
+static void test_session_short_stream_completes_with_patch_err(void)
+{
+	put_literal('A');
+	put_backref(1, 16);
+	put_end();
+	memset(image, 'A', 40);
+
+	run_lz_session(40);
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_ERROR, ota_get_phase());
+	TEST_ASSERT_EQUAL_UINT8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_UINT8(OTA_STATUS_PATCH_ERR, send_buf[2]);
+}
+
+static void test_session_compressed_patch_rejected(void)
+{
+	uint8_t msg[19];
+
+	build_start_msg(msg, 1000, 10, 0x12345678,
+			OTA_START_FLAGS_PATCH | OTA_START_FLAGS_COMPRESSED);
+	ota_process_msg(msg, sizeof(msg));
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_IDLE, ota_get_phase());
+	TEST_ASSERT_EQUAL_UINT8(OTA_SUB_ACK, send_buf[1]);
+	TEST_ASSERT_EQUAL_UINT8(OTA_STATUS_PATCH_ERR, send_buf[2]);
+}
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	/* Decoder */
+	RUN_TEST(test_cloud_vector_decodes);
+	RUN_TEST(test_byte_at_a_time_matches_whole_feed);
+	RUN_TEST(test_backrefs_reach_across_window_wrap);
+	RUN_TEST(test_sink_gets_fixed_blocks_and_a_tail);
+	RUN_TEST(test_distance_before_start_rejected);
+	RUN_TEST(test_output_past_size_rejected);
+	RUN_TEST(test_trailing_input_rejected);
+	RUN_TEST(test_padding_is_not_decoded);
+	RUN_TEST(test_short_stream_fails_finish);
+	RUN_TEST(test_sink_error_propagates);
+
+	/* Sessions */
+	RUN_TEST(test_session_compressed_completes_with_crc);
+	RUN_TEST(test_session_compressed_is_not_delta_mode);
+	RUN_TEST(test_session_corrupt_stream_acks_patch_err);
+	RUN_TEST(test_session_short_stream_completes_with_patch_err);
+	RUN_TEST(test_session_compressed_patch_rejected);
+
+	return UNITY_END();
+}
@@ -0,0 +1,487 @@
+/*
+ * Host-side tests for the streaming OTA binary patcher.
+ *
+ * Covers ota_patch.c directly (format decoding, window flushes, bounds
+ * and base-image checks) and patch-mode OTA sessions through
+ * ota_process_msg(): START with OTA_START_FLAGS_PATCH, sequential patch
+ * chunks rebuilt into staging, then the normal CRC validation.
+ *
+ * Patches are hand-assembled here, except one vector produced by the
+ * cloud encoder (aws/ota_patch.py) to pin the wire format.
+ */
+
+#include "unity.h"
+#include <ota_patch.h>
+#include <ota_update.h>
+#include <platform_api.h>
+#include <errno.h>
+#include <string.h>
+
+extern uint8_t mock_flash_mem[];
+extern void mock_flash_reset(void);
+
+#define MOCK_FLASH_BASE 0x90000
+#define CHUNK_SIZE      15
+
+/* Uplink capture */
+static uint8_t send_buf[64];
+static size_t send_len;
+static int send_count;
+
+static int mock_send(const uint8_t *data, size_t len)
+{
+	if (len <= sizeof(send_buf)) {
+		memcpy(send_buf, data, len);
+	}
+	send_len = len;
+	send_count++;
+	return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Helpers                                                            */
+/* ------------------------------------------------------------------ */
+
+static uint8_t old_img[8192];
+static uint8_t new_img[8192];
+static uint8_t patch[8192];
+static size_t patch_len;
+
+static void flash_put(uint32_t addr, const void *data, size_t len)
+{
+	memcpy(&mock_flash_mem[addr - MOCK_FLASH_BASE], data, len);
+}
+
+static const uint8_t *flash_at(uint32_t addr)
+{
+	return &mock_flash_mem[addr - MOCK_FLASH_BASE];
+}
+
+static uint32_t test_crc32(const uint8_t *data, size_t len)
+{
+	uint32_t crc = ~0u;
+	for (size_t i = 0; i < len; i++) {
+		crc ^= data[i];
+		for (int j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+static void fill_old(size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		old_img[i] = (uint8_t)((i * 7 + 3) ^ (i >> 5));
+	}
+	flash_put(OTA_APP_PRIMARY_ADDR, old_img, len);
+}
+
+static void put_byte(uint8_t b)
+{
+	patch[patch_len++] = b;
+}
+
+static void put_varint(uint32_t v)
+{
+	while (v >= 0x80) {
+		put_byte((uint8_t)(v | 0x80));
+		v >>= 7;
+	}
+	put_byte((uint8_t)v);
+}
+
+static void put_header(const uint8_t *old, uint32_t old_size)
+{
+	uint32_t crc = test_crc32(old, old_size);
+
+	patch_len = 0;
+	put_byte('E'); put_byte('V'); put_byte('P'); put_byte('1');
+	for (int i = 0; i < 4; i++) {
+		put_byte((uint8_t)(old_size >> (8 * i)));
+	}
+	for (int i = 0; i < 4; i++) {
+		put_byte((uint8_t)(crc >> (8 * i)));
+	}
+}
+
+/* Record: seek, copy diff_len old bytes unchanged, then extra bytes */
+static void put_copy_insert(int32_t seek, uint32_t diff_len,
+			    const uint8_t *extra, uint32_t extra_len)
+{
+	put_varint(seek >= 0 ? (uint32_t)seek << 1 : ((uint32_t)-seek << 1) - 1);
+	put_varint(diff_len);
+	put_varint(extra_len);
+	if (diff_len) {
+		put_varint(diff_len);   /* one zero run */
+		put_varint(0);
+	}
+	for (uint32_t i = 0; i < extra_len; i++) {
+		put_byte(extra[i]);
+	}
+}
+
+/* Feed the patch to the patcher in pieces of `step` bytes */
+static int feed_in_steps(struct ota_patch *p, size_t step)
+{
+	for (size_t off = 0; off < patch_len; off += step) {
+		size_t n = (patch_len - off < step) ? patch_len - off : step;
+		int err = ota_patch_feed(p, &patch[off], n);
+		if (err) {
+			return err;
+		}
+	}
+	return ota_patch_finish(p);
+}
+
+static void build_start_msg(uint8_t *msg, uint32_t total_size, uint16_t total_chunks,
+			    uint32_t crc32, uint8_t flags)
+{
+	msg[0] = OTA_CMD_TYPE;
+	msg[1] = OTA_SUB_START;
+	for (int i = 0; i < 4; i++) {
+		msg[2 + i] = (uint8_t)(total_size >> (8 * i));
+		msg[10 + i] = (uint8_t)(crc32 >> (8 * i));
+		msg[14 + i] = (uint8_t)(2 >> (8 * i));
+	}
+	msg[6] = (uint8_t)total_chunks;
+	msg[7] = (uint8_t)(total_chunks >> 8);
+	msg[8] = CHUNK_SIZE;
+	msg[9] = 0;
+	msg[18] = flags;
+}
+
+/* Start a patch-mode session for new_img[0..new_len) and send the patch */
+static void run_patch_session(uint32_t new_len)
+{
+	uint16_t chunks = (patch_len + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	uint8_t msg[19];
+
+	build_start_msg(msg, new_len, chunks, test_crc32(new_img, new_len),
+			OTA_START_FLAGS_PATCH);
+	ota_process_msg(msg, sizeof(msg));
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+
+	for (uint16_t i = 0; i < chunks && ota_get_phase() == OTA_PHASE_RECEIVING; i++) {
+		uint8_t chunk[4 + CHUNK_SIZE];
+		size_t off = (size_t)i * CHUNK_SIZE;
+		size_t n = (patch_len - off < CHUNK_SIZE) ? patch_len - off : CHUNK_SIZE;
+
+		chunk[0] = OTA_CMD_TYPE;
+		chunk[1] = OTA_SUB_CHUNK;
+		chunk[2] = (uint8_t)i;
+		chunk[3] = (uint8_t)(i >> 8);
+		memcpy(&chunk[4], &patch[off], n);
+		ota_process_msg(chunk, 4 + n);
+	}
+}
+
+void setUp(void)
+{
+	mock_flash_reset();
+	send_count = 0;
+	send_len = 0;
+	memset(send_buf, 0, sizeof(send_buf));
+	ota_init(mock_send);
+}
+
+void tearDown(void) { }
+
+/* ------------------------------------------------------------------ */
+/*  Patcher                                                            */
+/* ------------------------------------------------------------------ */
+
+/* Produced by aws/ota_patch.py make_patch() for the images built below:
+ * 8 bytes inserted at offset 40, and byte 60 of the old image + 1. */
+static const uint8_t cloud_vector[] = {
+	0x45, 0x56, 0x50, 0x31, 0x60, 0x00, 0x00, 0x00, 0xed, 0x28, 0x86,
+	0xee, 0x00, 0x28, 0x08, 0x28, 0x00, 0x4e, 0x45, 0x57, 0x43, 0x4f,
+	0x44, 0x45, 0x21, 0x00, 0x38, 0x00, 0x14, 0x01, 0x01, 0x23, 0x00,
+};
+
+static void test_cloud_vector_rebuilds_image(void)
+{
+	uint8_t old[96];
+	uint8_t expect[104];
+
+	for (int i = 0; i < 96; i++) {
+		old[i] = (uint8_t)(i * 7 + 3);
+	}
+	memcpy(expect, old, 40);
+	memcpy(&expect[40], "NEWCODE!", 8);
+	memcpy(&expect[48], &old[40], 56);
+	expect[68] = (uint8_t)(old[60] + 1);
+	flash_put(OTA_APP_PRIMARY_ADDR, old, sizeof(old));
+
+	/* Byte-at-a-time, as the worst case of chunk boundaries */
+	memcpy(patch, cloud_vector, sizeof(cloud_vector));
+	patch_len = sizeof(cloud_vector);
+
+	struct ota_patch p;
+	ota_patch_init(&p, OTA_APP_PRIMARY_ADDR, OTA_STAGING_ADDR, sizeof(expect));
+	TEST_ASSERT_EQUAL_INT(0, feed_in_steps(&p, 1));
+	TEST_ASSERT_EQUAL_MEMORY(expect, flash_at(OTA_STAGING_ADDR), sizeof(expect));
+}
+
+static void test_insert_shifts_image_through_window(void)
+{
+	static const uint8_t ins[37] = "a function grew by thirty-seven bytes";
+	const uint32_t old_len = 6000;
+
+	fill_old(old_len);
+	memcpy(new_img, old_img, 1000);
+	memcpy(&new_img[1000], ins, sizeof(ins));
+	memcpy(&new_img[1000 + sizeof(ins)], &old_img[1000], old_len - 1000);
+	uint32_t new_len = old_len + sizeof(ins);
+
+	put_header(old_img, old_len);
+	put_copy_insert(0, 1000, ins, sizeof(ins));
+	put_copy_insert(0, old_len - 1000, NULL, 0);
+
+	/* Framing costs less than two chunks on top of the inserted bytes */
+	TEST_ASSERT_LESS_THAN(2 * CHUNK_SIZE + sizeof(ins), patch_len);
+
+	struct ota_patch p;
+	ota_patch_init(&p, OTA_APP_PRIMARY_ADDR, OTA_STAGING_ADDR, new_len);
+	TEST_ASSERT_EQUAL_INT(0, feed_in_steps(&p, CHUNK_SIZE));
+	TEST_ASSERT_TRUE(ota_patch_done(&p));
+	TEST_ASSERT_EQUAL_MEMORY(new_img, flash_at(OTA_STAGING_ADDR), new_len);
+}
+
+static void test_diff_literals_add_to_old_bytes(void)
+{
+	fill_old(512);
+	memcpy(new_img, old_img, 512);
+	new_img[300] += 4;      /* a branch target moved by one word */
+	new_img[301] += 0xFF;   /* wraps */
+
+	put_header(old_img, 512);
+	put_varint(0);          /* seek */
+	put_varint(512);        /* diff_len */
+	put_varint(0);          /* extra_len */
+	put_varint(300);        /* zeros */
+	put_varint(2);          /* lits */
+	put_byte(4);
+	put_byte(0xFF);
+	put_varint(210);
+	put_varint(0);
+
+	struct ota_patch p;
+	ota_patch_init(&p, OTA_APP_PRIMARY_ADDR, OTA_STAGING_ADDR, 512);
+	TEST_ASSERT_EQUAL_INT(0, feed_in_steps(&p, 7));
+	TEST_ASSERT_EQUAL_MEMORY(new_img, flash_at(OTA_STAGING_ADDR), 512);
+}
+
+static void test_backward_seek_copies_earlier_code(void)
+{
+	fill_old(400);
+	/* new = old[200..400) followed by old[0..200) */
+	memcpy(new_img, &old_img[200], 200);
+	memcpy(&new_img[200], old_img, 200);
+
+	put_header(old_img, 400);
+	put_copy_insert(200, 200, NULL, 0);
+	put_copy_insert(-400, 200, NULL, 0);
+
+	struct ota_patch p;
+	ota_patch_init(&p, OTA_APP_PRIMARY_ADDR, OTA_STAGING_ADDR, 400);
+	TEST_ASSERT_EQUAL_INT(0, feed_in_steps(&p, CHUNK_SIZE));
+	TEST_ASSERT_EQUAL_MEMORY(new_img, flash_at(OTA_STAGING_ADDR), 400);
+}
+
+static void test_wrong_base_image_rejected(void)
+{
+	fill_old(256);
+	put_header(old_img, 256);
+	put_copy_insert(0, 256, NULL, 0);
+
+	mock_flash_mem[OTA_APP_PRIMARY_ADDR + 17 - MOCK_FLASH_BASE] ^= 0x01;
+
+	struct ota_patch p;
+	ota_patch_init(&p, OTA_APP_PRIMARY_ADDR, OTA_STAGING_ADDR, 256);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, ota_patch_feed(&p, patch, patch_len));
+}
+
+static void test_bad_magic_rejected(void)
+{
+	fill_old(64);
+	put_header(old_img, 64);
+	patch[3] = '2';
+
+	struct ota_patch p;
+	ota_patch_init(&p, OTA_APP_PRIMARY_ADDR, OTA_STAGING_ADDR, 64);
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, ota_patch_feed(&p, patch, patch_len));
+}
+
+static void test_diff_past_old_image_rejected(void)
+{
+	fill_old(100);
+	put_header(old_img, 100);
+	put_copy_insert(50, 51, NULL, 0);
+
+	struct ota_patch p;
+	ota_patch_init(&p, OTA_APP_PRIMARY_ADDR, OTA_STAGING_ADDR, 101);
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, ota_patch_feed(&p, patch, patch_len));
+}
+
+static void test_output_past_new_size_rejected(void)
+{
+	static const uint8_t extra[8] = "overflow";
+
+	fill_old(100);
+	put_header(old_img, 100);
+	put_copy_insert(0, 100, extra, sizeof(extra));
+
+	struct ota_patch p;
+	ota_patch_init(&p, OTA_APP_PRIMARY_ADDR, OTA_STAGING_ADDR, 104);
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, ota_patch_feed(&p, patch, patch_len));
+}
+
+static void test_trailing_bytes_rejected(void)
+{
+	fill_old(100);
+	put_header(old_img, 100);
+	put_copy_insert(0, 100, NULL, 0);
+	put_byte(0);
+
+	struct ota_patch p;
+	ota_patch_init(&p, OTA_APP_PRIMARY_ADDR, OTA_STAGING_ADDR, 100);
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, ota_patch_feed(&p, patch, patch_len));
+}
+
+static void test_short_patch_fails_finish(void)
+{
+	fill_old(100);
+	put_header(old_img, 100);
+	put_copy_insert(0, 60, NULL, 0);
+
+	struct ota_patch p;
+	ota_patch_init(&p, OTA_APP_PRIMARY_ADDR, OTA_STAGING_ADDR, 100);
+	TEST_ASSERT_EQUAL_INT(0, ota_patch_feed(&p, patch, patch_len));
+	TEST_ASSERT_FALSE(ota_patch_done(&p));
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, ota_patch_finish(&p));
+}
+
+/* ------------------------------------------------------------------ */
+/*  Patch-mode OTA sessions                                            */
+/* ------------------------------------------------------------------ */
+
+static void test_session_patch_completes_with_crc(void)
+{
+	static const uint8_t ins[20] = "inserted twenty byte";
+	const uint32_t old_len = 3000;
+
+	fill_old(old_len);
+	memcpy(new_img, old_img, 2000);
+	memcpy(&new_img[2000], ins, sizeof(ins));
+	memcpy(&new_img[2000 + sizeof(ins)], &old_img[2000], old_len - 2000);
+	uint32_t new_len = old_len + sizeof(ins);
+
+	put_header(old_img, old_len);
+	put_copy_insert(0, 2000, ins, sizeof(ins));
+	put_copy_insert(0, old_len - 2000, NULL, 0);
+
+	run_patch_session(new_len);
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_UINT8(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_UINT8(OTA_STATUS_OK, send_buf[2]);
+	TEST_ASSERT_EQUAL_MEMORY(new_img, flash_at(OTA_STAGING_ADDR), new_len);
+	/* The old image is untouched until apply */
+	TEST_ASSERT_EQUAL_MEMORY(old_img, flash_at(OTA_APP_PRIMARY_ADDR), old_len);
+}
+
+static void test_session_patch_is_not_delta_mode(void)
+{
+	/* A patch needs far fewer chunks than the image; it must still be
+	 * received sequentially rather than as sparse delta chunks */
+	fill_old(1000);
+	memcpy(new_img, old_img, 1000);
+	new_img[999] = 'X';
+	put_header(old_img, 1000);
+	put_copy_insert(0, 999, (const uint8_t *)"X", 1);
+
+	run_patch_session(1000);
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_UINT8(OTA_STATUS_OK, send_buf[2]);
+}
+
+static void test_session_wrong_base_acks_patch_err(void)
+{
+	fill_old(1000);
+	memcpy(new_img, old_img, 1000);
+	new_img[0] ^= 0xFF;
+	put_header(old_img, 1000);
+	put_copy_insert(0, 1000, NULL, 0);
+
+	mock_flash_mem[OTA_APP_PRIMARY_ADDR + 500 - MOCK_FLASH_BASE] ^= 0x55;
+	run_patch_session(1000);
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_ERROR, ota_get_phase());
+	TEST_ASSERT_EQUAL_UINT8(OTA_SUB_ACK, send_buf[1]);
+	TEST_ASSERT_EQUAL_UINT8(OTA_STATUS_PATCH_ERR, send_buf[2]);
+}
+
+static void test_session_duplicate_chunk_not_fed_twice(void)
+{
+	static const uint8_t ins[30] = "thirty bytes of brand new code";
+
+	fill_old(600);
+	memcpy(new_img, ins, sizeof(ins));
+	memcpy(&new_img[sizeof(ins)], old_img, 600);
+	put_header(old_img, 600);
+	put_copy_insert(0, 0, ins, sizeof(ins));
+	put_copy_insert(0, 600, NULL, 0);
+
+	uint16_t chunks = (patch_len + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	uint8_t msg[4 + CHUNK_SIZE];
+
+	build_start_msg(msg, 630, chunks, test_crc32(new_img, 630), OTA_START_FLAGS_PATCH);
+	ota_process_msg(msg, 19);
+
+	for (uint16_t i = 0; i < chunks; i++) {
+		size_t off = (size_t)i * CHUNK_SIZE;
+		size_t n = (patch_len - off < CHUNK_SIZE) ? patch_len - off : CHUNK_SIZE;
+
+		msg[0] = OTA_CMD_TYPE;
+		msg[1] = OTA_SUB_CHUNK;
+		msg[2] = (uint8_t)i;
+		msg[3] = (uint8_t)(i >> 8);
+		memcpy(&msg[4], &patch[off], n);
+		ota_process_msg(msg, 4 + n);
+		if (i == 1) {
+			/* Lost ACK: the cloud resends chunk 1 */
+			ota_process_msg(msg, 4 + n);
+			TEST_ASSERT_EQUAL_UINT8(OTA_STATUS_OK, send_buf[2]);
+		}
+	}
+
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_COMPLETE, ota_get_phase());
+	TEST_ASSERT_EQUAL_MEMORY(new_img, flash_at(OTA_STAGING_ADDR), 630);
+}
+
+int main(void)
+{
+	UNITY_BEGIN();
+
+	/* Patcher */
+	RUN_TEST(test_cloud_vector_rebuilds_image);
+	RUN_TEST(test_insert_shifts_image_through_window);
+	RUN_TEST(test_diff_literals_add_to_old_bytes);
+	RUN_TEST(test_backward_seek_copies_earlier_code);
+	RUN_TEST(test_wrong_base_image_rejected);
+	RUN_TEST(test_bad_magic_rejected);
+	RUN_TEST(test_diff_past_old_image_rejected);
+	RUN_TEST(test_output_past_new_size_rejected);
+	RUN_TEST(test_trailing_bytes_rejected);
+	RUN_TEST(test_short_patch_fails_finish);
+
+	/* Sessions */
+	RUN_TEST(test_session_patch_completes_with_crc);
+	RUN_TEST(test_session_patch_is_not_delta_mode);
+	RUN_TEST(test_session_wrong_base_acks_patch_err);
+	RUN_TEST(test_session_duplicate_chunk_not_fed_twice);
+
+	return UNITY_END();
+}
@@ -8,7 +8,10 @@
 
 #include "unity.h"
 #include <ota_update.h>
+#include <event_log.h>
 #include <platform_api.h>
+#include <zephyr/drivers/flash.h>
+#include <stdio.h>
 #include <string.h>
 
 /* Mock flash externs from mock Zephyr headers */
@@ -18,6 +21,8 @@ extern int mock_flash_write_count;
 extern int mock_flash_erase_count;
 extern int mock_flash_fail_at_page;
 extern int mock_reboot_count;
+extern uint16_t mock_flash_page_erases[];
+extern uint64_t mock_flash_busy_us;
 extern void mock_flash_reset(void);
 
 #define MOCK_FLASH_BASE 0x90000
@@ -174,10 +179,10 @@ static void test_recovery_full_apply_from_scratch(void)
 	flash_peek(OTA_APP_PRIMARY_ADDR, &magic, sizeof(magic));
 	TEST_ASSERT_EQUAL_HEX32(APP_CALLBACK_MAGIC, magic);
 
-	/* Metadata should be cleared */
-	struct ota_metadata meta;
-	flash_peek(OTA_METADATA_ADDR, &meta, sizeof(meta));
-	TEST_ASSERT_NOT_EQUAL(OTA_META_MAGIC, meta.magic);
+	/* Journal closed: the next boot does not resume again */
+	mock_reboot_count = 0;
+	TEST_ASSERT_FALSE(ota_boot_recovery_check());
+	TEST_ASSERT_EQUAL_INT(0, mock_reboot_count);
 }
 
 static void test_recovery_resumes_at_page_3_of_5(void)
@@ -257,6 +262,30 @@ static void test_recovery_already_complete(void)
 	TEST_ASSERT_EQUAL_INT(1, mock_reboot_count);
 }
 
+static void test_recovery_preserves_event_log(void)
+{
+	uint32_t image_size = 5 * OTA_FLASH_PAGE_SIZE;
+	uint32_t crc = prepare_staging_image(image_size);
+
+	/* Stale bytes from an older, larger image, and a live event log */
+	uint32_t stale = OTA_APP_PRIMARY_ADDR + 8 * OTA_FLASH_PAGE_SIZE;
+	memset(&mock_flash_mem[stale - MOCK_FLASH_BASE], 0x5A, 16);
+	memset(&mock_flash_mem[EVENT_LOG_FLASH_ADDR - MOCK_FLASH_BASE], 0xA5,
+	       EVENT_LOG_FLASH_SIZE);
+
+	write_test_metadata(OTA_META_STATE_APPLYING, image_size, crc, 10, 0, 5);
+
+	TEST_ASSERT_TRUE(ota_boot_recovery_check());
+
+	uint8_t b;
+	flash_peek(stale, &b, 1);
+	TEST_ASSERT_EQUAL_HEX8(0xFF, b);
+	for (uint32_t off = 0; off < EVENT_LOG_FLASH_SIZE; off += OTA_FLASH_PAGE_SIZE / 2) {
+		flash_peek(EVENT_LOG_FLASH_ADDR + off, &b, 1);
+		TEST_ASSERT_EQUAL_HEX8(0xA5, b);
+	}
+}
+
 /* ------------------------------------------------------------------ */
 /*  Magic verification after apply                                     */
 /* ------------------------------------------------------------------ */
@@ -367,6 +396,274 @@ static void test_phase_str_idle(void)
 	TEST_ASSERT_NOT_NULL(ota_phase_str(OTA_PHASE_IDLE));
 }
 
+/* ------------------------------------------------------------------ */
+/*  Apply journal: progress appended, primary cache, torn slots        */
+/* ------------------------------------------------------------------ */
+
+static uint32_t test_crc32(const uint8_t *p, uint32_t len)
+{
+	uint32_t crc = ~0u;
+	for (uint32_t i = 0; i < len; i++) {
+		crc ^= p[i];
+		for (int j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+static uint32_t primary_page_crc(uint32_t page, uint32_t len)
+{
+	return test_crc32(&mock_flash_mem[OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE +
+					  page * OTA_FLASH_PAGE_SIZE], len);
+}
+
+static void journal_peek(uint16_t slot, struct ota_journal_rec *rec)
+{
+	flash_peek(OTA_JOURNAL_ADDR + slot * sizeof(*rec), rec, sizeof(*rec));
+}
+
+static void journal_put(uint16_t slot, uint16_t page, uint32_t page_crc)
+{
+	struct ota_journal_rec rec = { .page_crc32 = page_crc, .page = page };
+	rec.check = (uint16_t)test_crc32((const uint8_t *)&rec,
+					 offsetof(struct ota_journal_rec, check));
+	flash_put(OTA_JOURNAL_ADDR + slot * sizeof(rec), &rec, sizeof(rec));
+}
+
+/* Apply an image from page 0 through boot recovery; returns its CRC */
+static uint32_t apply_from_scratch(uint32_t image_size)
+{
+	uint32_t total_pages = (image_size + OTA_FLASH_PAGE_SIZE - 1) / OTA_FLASH_PAGE_SIZE;
+	uint32_t crc = prepare_staging_image(image_size);
+
+	write_test_metadata(OTA_META_STATE_APPLYING, image_size, crc, 10, 0, total_pages);
+	TEST_ASSERT_TRUE(ota_boot_recovery_check());
+	return crc;
+}
+
+static void test_apply_journals_page_crcs(void)
+{
+	uint32_t image_size = OTA_FLASH_PAGE_SIZE + 1000;
+	uint32_t crc = apply_from_scratch(image_size);
+	struct ota_journal_rec rec;
+
+	journal_peek(0, &rec);
+	TEST_ASSERT_EQUAL_UINT16(0, rec.page);
+	TEST_ASSERT_EQUAL_HEX32(primary_page_crc(0, OTA_FLASH_PAGE_SIZE), rec.page_crc32);
+	journal_peek(1, &rec);
+	TEST_ASSERT_EQUAL_UINT16(1, rec.page);
+	TEST_ASSERT_EQUAL_HEX32(primary_page_crc(1, 1000), rec.page_crc32);
+	journal_peek(2, &rec);
+	TEST_ASSERT_EQUAL_UINT16(OTA_JOURNAL_DONE, rec.page);
+	TEST_ASSERT_EQUAL_HEX32(crc, rec.page_crc32);
+	journal_peek(3, &rec);
+	TEST_ASSERT_EQUAL_HEX16(0xFFFF, rec.check);     /* erased */
+
+	/* The record itself was not rewritten */
+	struct ota_metadata meta;
+	flash_peek(OTA_METADATA_ADDR, &meta, sizeof(meta));
+	TEST_ASSERT_EQUAL_HEX32(OTA_META_MAGIC, meta.magic);
+	TEST_ASSERT_EQUAL_UINT32(0, meta.pages_copied);
+}
+
+static void test_recovery_resumes_after_torn_journal_slot(void)
+{
+	uint32_t image_size = 3 * OTA_FLASH_PAGE_SIZE;
+	uint32_t crc = prepare_staging_image(image_size);
+
+	/* Pages 0-1 copied and journaled; power lost while programming the
+	 * record of page 2, after its copy had started */
+	memcpy(&mock_flash_mem[OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE],
+	       &mock_flash_mem[OTA_STAGING_ADDR - MOCK_FLASH_BASE],
+	       2 * OTA_FLASH_PAGE_SIZE);
+	write_test_metadata(OTA_META_STATE_APPLYING, image_size, crc, 10, 0, 3);
+	journal_put(0, 0, primary_page_crc(0, OTA_FLASH_PAGE_SIZE));
+	journal_put(1, 1, primary_page_crc(1, OTA_FLASH_PAGE_SIZE));
+	struct ota_journal_rec torn = { .page_crc32 = 0x12340000, .page = 2, .check = 0xFF00 };
+	flash_put(OTA_JOURNAL_ADDR + 2 * sizeof(torn), &torn, sizeof(torn));
+
+	TEST_ASSERT_TRUE(ota_boot_recovery_check());
+
+	/* Only page 2 was copied again */
+	uint32_t first = (OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE) / MOCK_FLASH_PAGE_SIZE;
+	TEST_ASSERT_EQUAL_UINT16(0, mock_flash_page_erases[first]);
+	TEST_ASSERT_EQUAL_UINT16(0, mock_flash_page_erases[first + 1]);
+	TEST_ASSERT_EQUAL_UINT16(1, mock_flash_page_erases[first + 2]);
+
+	/* Its record and DONE went after the torn slot */
+	struct ota_journal_rec rec;
+	journal_peek(3, &rec);
+	TEST_ASSERT_EQUAL_UINT16(2, rec.page);
+	TEST_ASSERT_EQUAL_HEX32(primary_page_crc(2, OTA_FLASH_PAGE_SIZE), rec.page_crc32);
+	journal_peek(4, &rec);
+	TEST_ASSERT_EQUAL_UINT16(OTA_JOURNAL_DONE, rec.page);
+
+	mock_reboot_count = 0;
+	TEST_ASSERT_FALSE(ota_boot_recovery_check());
+	TEST_ASSERT_EQUAL_INT(0, mock_reboot_count);
+}
+
+static void test_boot_keeps_matching_primary_cache(void)
+{
+	apply_from_scratch(2 * OTA_FLASH_PAGE_SIZE);
+	mock_reboot_count = 0;
+
+	TEST_ASSERT_FALSE(ota_boot_recovery_check());
+	TEST_ASSERT_EQUAL_INT(0, mock_reboot_count);
+
+	struct ota_metadata meta;
+	flash_peek(OTA_METADATA_ADDR, &meta, sizeof(meta));
+	TEST_ASSERT_EQUAL_HEX32(OTA_META_MAGIC, meta.magic);
+}
+
+static void test_boot_drops_stale_primary_cache(void)
+{
+	apply_from_scratch(2 * OTA_FLASH_PAGE_SIZE);
+
+	/* Primary reflashed by a debugger behind OTA's back */
+	mock_flash_mem[OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE + 5000] ^= 0xFF;
+
+	TEST_ASSERT_FALSE(ota_boot_recovery_check());
+
+	struct ota_metadata meta;
+	flash_peek(OTA_METADATA_ADDR, &meta, sizeof(meta));
+	TEST_ASSERT_NOT_EQUAL(OTA_META_MAGIC, meta.magic);
+}
+
+/* Wear and latency of progress tracking over a 32-page apply. Erasing and
+ * rewriting the record after each page cost one erase of the metadata
+ * page per page copied (plus one to finish); the journal costs none. */
+static void test_apply_journal_wear_and_latency(void)
+{
+	uint32_t pages = 32;
+	uint32_t meta_page = (OTA_METADATA_ADDR - MOCK_FLASH_BASE) / MOCK_FLASH_PAGE_SIZE;
+	uint32_t first = (OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE) / MOCK_FLASH_PAGE_SIZE;
+
+	uint32_t crc = prepare_staging_image(pages * OTA_FLASH_PAGE_SIZE);
+	write_test_metadata(OTA_META_STATE_APPLYING, pages * OTA_FLASH_PAGE_SIZE,
+			    crc, 10, 0, pages);
+	int writes_before = mock_flash_write_count;
+
+	TEST_ASSERT_TRUE(ota_boot_recovery_check());
+
+	uint32_t erases = 0;
+	for (uint32_t p = 0; p < MOCK_FLASH_PAGES; p++) {
+		erases += mock_flash_page_erases[p];
+	}
+	uint32_t image_erases = 0;
+	for (uint32_t p = first; p < first + pages; p++) {
+		TEST_ASSERT_EQUAL_UINT16(1, mock_flash_page_erases[p]);
+		image_erases++;
+	}
+	uint32_t stale_erases = erases - image_erases;
+
+	/* Metadata page: not erased at all during the copy */
+	TEST_ASSERT_EQUAL_UINT16(0, mock_flash_page_erases[meta_page]);
+
+	/* Page data plus one 8-byte record per page and one DONE record */
+	uint64_t page_words = (uint64_t)pages * (OTA_FLASH_PAGE_SIZE / 4);
+	uint64_t journal_words = (uint64_t)(pages + 1) * (sizeof(struct ota_journal_rec) / 4);
+	TEST_ASSERT_EQUAL_UINT64((uint64_t)erases * MOCK_FLASH_ERASE_US +
+				 (page_words + journal_words) * MOCK_FLASH_WORD_US,
+				 mock_flash_busy_us);
+	TEST_ASSERT_EQUAL_INT(2 * (int)pages + 1, mock_flash_write_count - writes_before);
+
+	uint64_t journal_us = journal_words * MOCK_FLASH_WORD_US;
+	uint64_t rewrite_us = (uint64_t)(pages + 1) *
+			      (MOCK_FLASH_ERASE_US +
+			       (sizeof(struct ota_metadata) / 4) * MOCK_FLASH_WORD_US);
+	printf("  %u-page apply: %u image + %u stale page erases, 0 metadata erases "
+	       "(was %u); progress %llu us (was %llu us)\n",
+	       pages, image_erases, stale_erases, pages + 1,
+	       (unsigned long long)journal_us, (unsigned long long)rewrite_us);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Unchanged pages: no erase, no program                               */
+/* ------------------------------------------------------------------ */
+
+/* Power lost after page 2 was copied but before its journal record: the
+ * resume finds primary already holding it and only journals it */
+static void test_recovery_skips_page_copied_before_journal(void)
+{
+	uint32_t image_size = 4 * OTA_FLASH_PAGE_SIZE;
+	uint32_t crc = prepare_staging_image(image_size);
+
+	memcpy(&mock_flash_mem[OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE],
+	       &mock_flash_mem[OTA_STAGING_ADDR - MOCK_FLASH_BASE],
+	       3 * OTA_FLASH_PAGE_SIZE);
+	write_test_metadata(OTA_META_STATE_APPLYING, image_size, crc, 10, 0, 4);
+	journal_put(0, 0, primary_page_crc(0, OTA_FLASH_PAGE_SIZE));
+	journal_put(1, 1, primary_page_crc(1, OTA_FLASH_PAGE_SIZE));
+
+	TEST_ASSERT_TRUE(ota_boot_recovery_check());
+
+	uint32_t first = (OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE) / MOCK_FLASH_PAGE_SIZE;
+	TEST_ASSERT_EQUAL_UINT16(0, mock_flash_page_erases[first + 2]);
+	TEST_ASSERT_EQUAL_UINT16(1, mock_flash_page_erases[first + 3]);
+
+	struct ota_journal_rec rec;
+	journal_peek(2, &rec);
+	TEST_ASSERT_EQUAL_UINT16(2, rec.page);
+	TEST_ASSERT_EQUAL_HEX32(primary_page_crc(2, OTA_FLASH_PAGE_SIZE), rec.page_crc32);
+	journal_peek(4, &rec);
+	TEST_ASSERT_EQUAL_UINT16(OTA_JOURNAL_DONE, rec.page);
+}
+
+/* Full-image apply of a 32-page update that changes 2 pages over a 34-page
+ * image: only the changed pages and the two pages the old image had past
+ * the new end are erased. Before, every image page and every page up to
+ * the event log was erased and every image page programmed. */
+static void test_full_apply_skips_unchanged_pages(void)
+{
+	uint32_t pages = 32;
+	uint32_t first = (OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE) / MOCK_FLASH_PAGE_SIZE;
+	uint32_t log_page = (EVENT_LOG_FLASH_ADDR - MOCK_FLASH_BASE) / MOCK_FLASH_PAGE_SIZE;
+	uint8_t *primary = &mock_flash_mem[OTA_APP_PRIMARY_ADDR - MOCK_FLASH_BASE];
+
+	uint32_t crc = prepare_staging_image(pages * OTA_FLASH_PAGE_SIZE);
+	memcpy(primary, &mock_flash_mem[OTA_STAGING_ADDR - MOCK_FLASH_BASE],
+	       pages * OTA_FLASH_PAGE_SIZE);
+	primary[5 * OTA_FLASH_PAGE_SIZE + 17] ^= 0x01;
+	primary[21 * OTA_FLASH_PAGE_SIZE - 1] ^= 0x80;
+	memset(&primary[pages * OTA_FLASH_PAGE_SIZE], 0x42, 2 * OTA_FLASH_PAGE_SIZE);
+	write_test_metadata(OTA_META_STATE_APPLYING, pages * OTA_FLASH_PAGE_SIZE,
+			    crc, 10, 0, pages);
+	int writes_before = mock_flash_write_count;
+
+	TEST_ASSERT_TRUE(ota_boot_recovery_check());
+
+	uint32_t image_erases = 0, stale_erases = 0;
+	for (uint32_t p = first; p < first + pages; p++) {
+		TEST_ASSERT_EQUAL_UINT16(p == first + 5 || p == first + 20,
+					 mock_flash_page_erases[p]);
+		image_erases += mock_flash_page_erases[p];
+	}
+	for (uint32_t p = first + pages; p < log_page; p++) {
+		TEST_ASSERT_EQUAL_UINT16(p < first + pages + 2, mock_flash_page_erases[p]);
+		stale_erases += mock_flash_page_erases[p];
+	}
+	TEST_ASSERT_EQUAL_MEMORY(&mock_flash_mem[OTA_STAGING_ADDR - MOCK_FLASH_BASE],
+				 primary, pages * OTA_FLASH_PAGE_SIZE);
+	TEST_ASSERT_TRUE(ota_flash_is_erased(OTA_APP_PRIMARY_ADDR +
+					     pages * OTA_FLASH_PAGE_SIZE,
+					     2 * OTA_FLASH_PAGE_SIZE));
+
+	/* Two page programs, one journal record per page, DONE */
+	TEST_ASSERT_EQUAL_INT(2 + (int)pages + 1, mock_flash_write_count - writes_before);
+
+	uint64_t page_us = MOCK_FLASH_ERASE_US + (OTA_FLASH_PAGE_SIZE / 4) * MOCK_FLASH_WORD_US;
+	uint64_t was_us = (uint64_t)pages * page_us +
+			  (uint64_t)(log_page - first - pages) * MOCK_FLASH_ERASE_US;
+	uint64_t now_us = (uint64_t)image_erases * page_us +
+			  (uint64_t)stale_erases * MOCK_FLASH_ERASE_US;
+	printf("  %u-page apply, 2 pages changed: %u image + %u stale page erases "
+	       "(was %u + %u); NVMC busy %llu ms (was %llu ms)\n",
+	       pages, image_erases, stale_erases, pages, log_page - first - pages,
+	       (unsigned long long)now_us / 1000, (unsigned long long)was_us / 1000);
+}
+
 /* ------------------------------------------------------------------ */
 /*  Main                                                               */
 /* ------------------------------------------------------------------ */
@@ -386,6 +683,16 @@ int main(void)
 	RUN_TEST(test_recovery_resumes_at_page_3_of_5);
 	RUN_TEST(test_recovery_last_page_partial);
 	RUN_TEST(test_recovery_already_complete);
+	RUN_TEST(test_recovery_preserves_event_log);
+	RUN_TEST(test_apply_journals_page_crcs);
+	RUN_TEST(test_recovery_resumes_after_torn_journal_slot);
+	RUN_TEST(test_boot_keeps_matching_primary_cache);
+	RUN_TEST(test_boot_drops_stale_primary_cache);
+	RUN_TEST(test_apply_journal_wear_and_latency);
+
+	/* Unchanged pages */
+	RUN_TEST(test_recovery_skips_page_copied_before_journal);
+	RUN_TEST(test_full_apply_skips_unchanged_pages);
 
 	/* Magic verification */
 	RUN_TEST(test_recovery_fails_bad_magic);
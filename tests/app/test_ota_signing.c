@@ -9,6 +9,7 @@
  *   - Full mode: CRC OK + sig FAIL → COMPLETE SIG_ERR, ERROR phase
  *   - Unsigned image (no flags): no verification, COMPLETE OK
  *   - Delta mode: signature verification on merged image
+ *   - Streaming: images beyond the old 16KB verify buffer hash page by page
  *
  * NOTE: Uses chunk_size=12 (4-byte aligned) to avoid mock flash
  * alignment issues. See MEMORY.md "Mock flash alignment" note.
@@ -22,15 +23,20 @@
 /* Mock flash externs */
 extern uint8_t mock_flash_mem[];
 extern int mock_reboot_count;
+extern size_t mock_flash_read_bytes;
 extern void mock_flash_reset(void);
 
 /* Mock signing externs */
 extern void mock_ota_signing_reset(void);
 extern void mock_ota_signing_set_result(int result);
 extern int mock_ota_signing_get_call_count(void);
+extern size_t mock_ota_signing_get_hashed_len(void);
+extern uint32_t mock_ota_signing_get_hashed_crc(void);
+extern const uint8_t *mock_ota_signing_get_sig(void);
 
 #define MOCK_FLASH_BASE 0x90000
 #define TEST_CHUNK_SIZE 12  /* 4-byte aligned for mock flash compat */
+#define TEST_DELTA_CHUNK_SIZE 16  /* aligned, and >= OTA_DELTA_MIN_CHUNK_SIZE */
 
 /* Uplink capture */
 static uint8_t send_buf[64];
@@ -126,9 +132,9 @@ static uint16_t prepare_firmware(uint8_t *buf, uint16_t fw_data_size,
 	/* Write APP_CALLBACK_MAGIC at start */
 	uint32_t magic = APP_CALLBACK_MAGIC;
 	memcpy(buf, &magic, 4);
-	/* Fill rest with pattern */
+	/* Fill rest with pattern (not page-periodic, so misplaced pages show) */
 	for (uint16_t i = 4; i < fw_data_size; i++) {
-		buf[i] = (uint8_t)(i & 0xFF);
+		buf[i] = (uint8_t)((i & 0xFF) ^ (i >> 8));
 	}
 	uint16_t total = fw_data_size;
 	if (append_sig) {
@@ -317,7 +323,7 @@ void test_delta_mode_signed_ok(void)
 	uint8_t fw[256];
 	uint16_t fw_data = 120;
 	uint16_t total_size = prepare_firmware(fw, fw_data, true); /* 184 */
-	uint16_t chunk_size = TEST_CHUNK_SIZE;
+	uint16_t chunk_size = TEST_DELTA_CHUNK_SIZE;
 	uint32_t fw_crc = test_crc32(fw, total_size);
 
 	/* Write "old" firmware to primary: same but byte 4 different */
@@ -350,7 +356,7 @@ void test_delta_mode_signed_fail(void)
 	/* Delta OTA with signed firmware, mock verify returns -1 → SIG_ERR */
 	uint8_t fw[256];
 	uint16_t total_size = prepare_firmware(fw, 120, true); /* 184 */
-	uint16_t chunk_size = TEST_CHUNK_SIZE;
+	uint16_t chunk_size = TEST_DELTA_CHUNK_SIZE;
 	uint32_t fw_crc = test_crc32(fw, total_size);
 
 	/* Write "old" firmware to primary (differ at byte 4) */
@@ -377,6 +383,107 @@ void test_delta_mode_signed_fail(void)
 	TEST_ASSERT_EQUAL_INT(OTA_PHASE_ERROR, ota_get_phase());
 }
 
+/* ------------------------------------------------------------------ */
+/*  Streaming verification beyond one RAM buffer                       */
+/* ------------------------------------------------------------------ */
+
+static uint8_t big_fw[40000 + OTA_SIG_SIZE];
+static uint8_t big_old[40000 + OTA_SIG_SIZE];
+
+void test_full_mode_signed_image_larger_than_ram_buffer(void)
+{
+	/* 40KB signed image: ten flash pages hashed through a 4KB buffer */
+	uint16_t fw_data = 40000;
+	uint16_t size = prepare_firmware(big_fw, fw_data, true);
+
+	mock_ota_signing_set_result(0);
+	uint8_t status = do_full_ota(big_fw, size, TEST_CHUNK_SIZE, true);
+
+	TEST_ASSERT_EQUAL_INT(OTA_STATUS_OK, status);
+	TEST_ASSERT_EQUAL_INT(1, mock_ota_signing_get_call_count());
+	TEST_ASSERT_EQUAL_UINT32(fw_data, mock_ota_signing_get_hashed_len());
+	TEST_ASSERT_EQUAL_HEX32(test_crc32(big_fw, fw_data),
+				mock_ota_signing_get_hashed_crc());
+	TEST_ASSERT_EQUAL_MEMORY(&big_fw[fw_data], mock_ota_signing_get_sig(),
+				 OTA_SIG_SIZE);
+}
+
+void test_full_mode_signed_hashed_on_receipt(void)
+{
+	/* The image is hashed as chunks arrive: validation reads back only
+	 * the 64-byte signature */
+	uint16_t fw_data = 40000;
+	uint16_t size = prepare_firmware(big_fw, fw_data, true);
+	uint16_t total_chunks = (size + TEST_CHUNK_SIZE - 1) / TEST_CHUNK_SIZE;
+
+	uint8_t start[19];
+	build_start_msg_with_flags(start, size, total_chunks, TEST_CHUNK_SIZE,
+				   test_crc32(big_fw, size), 1,
+				   OTA_START_FLAGS_SIGNED);
+	ota_process_msg(start, 19);
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+
+	mock_ota_signing_set_result(0);
+	mock_flash_read_bytes = 0;
+	uint8_t chunk_msg[64];
+	for (uint16_t i = 0; i < total_chunks; i++) {
+		uint32_t offset = (uint32_t)i * TEST_CHUNK_SIZE;
+		uint16_t n = (offset + TEST_CHUNK_SIZE > size) ? size - offset
+							       : TEST_CHUNK_SIZE;
+		size_t msg_len = build_chunk_msg(chunk_msg, i, &big_fw[offset], n);
+		ota_process_msg(chunk_msg, msg_len);
+	}
+
+	TEST_ASSERT_EQUAL_INT(OTA_STATUS_OK, send_buf[2]);
+	TEST_ASSERT_EQUAL_UINT32(OTA_SIG_SIZE, mock_flash_read_bytes);
+	TEST_ASSERT_EQUAL_UINT32(fw_data, mock_ota_signing_get_hashed_len());
+	TEST_ASSERT_EQUAL_HEX32(test_crc32(big_fw, fw_data),
+				mock_ota_signing_get_hashed_crc());
+	TEST_ASSERT_EQUAL_MEMORY(&big_fw[fw_data], mock_ota_signing_get_sig(),
+				 OTA_SIG_SIZE);
+}
+
+void test_delta_mode_signed_image_larger_than_ram_buffer(void)
+{
+	/* 18KB signed delta: changed chunks on both sides of a page boundary
+	 * and the signature tail; the rest comes from primary */
+	uint16_t chunk_size = 20;
+	uint16_t fw_data = 18000;
+	uint16_t total_size = prepare_firmware(big_fw, fw_data, true);
+	uint16_t full_chunks = (total_size + chunk_size - 1) / chunk_size;
+
+	memcpy(big_old, big_fw, total_size);
+	big_old[4] ^= 0xFF;                     /* chunk 0 */
+	big_old[4100] ^= 0xFF;                  /* chunk 205, page 1 */
+	big_old[fw_data + 10] ^= 0xFF;          /* signature bytes */
+	flash_put(OTA_APP_PRIMARY_ADDR, big_old, total_size);
+
+	uint16_t changed[3] = { 0, 4100 / chunk_size, (fw_data + 10) / chunk_size };
+	uint8_t start[19];
+	build_start_msg_with_flags(start, total_size, 3, chunk_size,
+				   test_crc32(big_fw, total_size), 1,
+				   OTA_START_FLAGS_SIGNED);
+	ota_process_msg(start, 19);
+	TEST_ASSERT_EQUAL_INT(OTA_PHASE_RECEIVING, ota_get_phase());
+
+	mock_ota_signing_set_result(0);
+	uint8_t chunk_msg[64];
+	for (int i = 0; i < 3; i++) {
+		uint32_t off = (uint32_t)changed[i] * chunk_size;
+		uint16_t n = (changed[i] == full_chunks - 1) ? total_size - off : chunk_size;
+		size_t msg_len = build_chunk_msg(chunk_msg, changed[i], &big_fw[off], n);
+		ota_process_msg(chunk_msg, msg_len);
+	}
+
+	TEST_ASSERT_EQUAL_INT(OTA_SUB_COMPLETE, send_buf[1]);
+	TEST_ASSERT_EQUAL_INT(OTA_STATUS_OK, send_buf[2]);
+	TEST_ASSERT_EQUAL_UINT32(fw_data, mock_ota_signing_get_hashed_len());
+	TEST_ASSERT_EQUAL_HEX32(test_crc32(big_fw, fw_data),
+				mock_ota_signing_get_hashed_crc());
+	TEST_ASSERT_EQUAL_MEMORY(&big_fw[fw_data], mock_ota_signing_get_sig(),
+				 OTA_SIG_SIZE);
+}
+
 /* ------------------------------------------------------------------ */
 /*  CRC failure takes priority over signature check                    */
 /* ------------------------------------------------------------------ */
@@ -438,6 +545,11 @@ int main(void)
 	RUN_TEST(test_delta_mode_signed_ok);
 	RUN_TEST(test_delta_mode_signed_fail);
 
+	/* Streaming */
+	RUN_TEST(test_full_mode_signed_image_larger_than_ram_buffer);
+	RUN_TEST(test_full_mode_signed_hashed_on_receipt);
+	RUN_TEST(test_delta_mode_signed_image_larger_than_ram_buffer);
+
 	/* CRC priority */
 	RUN_TEST(test_crc_failure_before_sig_check);
 
@@ -7,6 +7,7 @@
 #include "app_platform.h"
 #include "selftest_trigger.h"
 #include "selftest.h"
+#include "charge_now.h"
 #include <string.h>
 
 static int mock_send_called;
@@ -32,6 +33,22 @@ static void setup_partial_fail(int adc0, int gpio2)
 	mock_gpio_values[2] = gpio2;
 }
 
+/* Helper: the button goes to `level` at mock_uptime_ms. Subscribed
+ * (API v8+), the platform delivers it as an edge; polled, the next
+ * tick reads it. */
+static void button(int level)
+{
+	mock_gpio_values[PIN_CHARGE_NOW_BUTTON] = level;
+	if (mock_gpio_subscribed[PIN_CHARGE_NOW_BUTTON]) {
+		struct platform_gpio_edge edge = {
+			.at_ms = mock_uptime_ms,
+			.pin = PIN_CHARGE_NOW_BUTTON,
+			.level = (uint8_t)level,
+		};
+		TEST_ASSERT_TRUE(selftest_trigger_on_edge(&edge));
+	}
+}
+
 /* Helper: simulate N button presses within a time window.
  * Stops immediately after a press triggers the selftest (no extra tick). */
 static void simulate_presses(int count, uint32_t start_ms, uint32_t interval_ms)
@@ -39,18 +56,20 @@ static void simulate_presses(int count, uint32_t start_ms, uint32_t interval_ms)
 	for (int i = 0; i < count; i++) {
 		/* Button down */
 		mock_uptime_ms = start_ms + (i * interval_ms * 2);
-		mock_gpio_values[PIN_CHARGE_NOW_BUTTON] = 1;
-		selftest_trigger_tick();
+		button(1);
+		if (!selftest_trigger_is_running()) {
+			selftest_trigger_tick();
+		}
 
 		/* If selftest was triggered, release button and stop */
 		if (selftest_trigger_is_running()) {
-			mock_gpio_values[PIN_CHARGE_NOW_BUTTON] = 0;
+			button(0);
 			return;
 		}
 
 		/* Button up */
 		mock_uptime_ms = start_ms + (i * interval_ms * 2) + interval_ms;
-		mock_gpio_values[PIN_CHARGE_NOW_BUTTON] = 0;
+		button(0);
 		selftest_trigger_tick();
 	}
 }
@@ -135,15 +154,144 @@ void test_button_ignored_while_running(void)
 	TEST_ASSERT_TRUE(selftest_trigger_is_running());
 
 	/* More presses while running — should be ignored (still blinking) */
-	mock_gpio_values[PIN_CHARGE_NOW_BUTTON] = 1;
+	button(1);
 	selftest_trigger_tick();
-	mock_gpio_values[PIN_CHARGE_NOW_BUTTON] = 0;
+	button(0);
 	selftest_trigger_tick();
 
 	/* Should still be in blinking state (not restarted) */
 	TEST_ASSERT_TRUE(selftest_trigger_is_running());
 }
 
+/* ------------------------------------------------------------------ */
+/*  Edge interrupts (API v8+)                                          */
+/* ------------------------------------------------------------------ */
+
+void test_subscribes_button_edges(void)
+{
+	TEST_ASSERT_TRUE(mock_gpio_subscribed[PIN_CHARGE_NOW_BUTTON]);
+	TEST_ASSERT_EQUAL_UINT32(BUTTON_DEBOUNCE_MS, mock_gpio_debounce_ms[PIN_CHARGE_NOW_BUTTON]);
+}
+
+void test_short_presses_between_ticks_count(void)
+{
+	/* Five 40ms presses inside one 500ms tick: polling sees none */
+	for (int i = 0; i < TRIGGER_PRESS_COUNT; i++) {
+		mock_uptime_ms = 1000 + i * 80;
+		button(1);
+		mock_uptime_ms += 40;
+		button(0);
+	}
+	TEST_ASSERT_TRUE(selftest_trigger_is_running());
+}
+
+void test_other_pin_edges_not_taken(void)
+{
+	struct platform_gpio_edge cool = { .at_ms = 1000, .pin = 2, .level = 1 };
+
+	TEST_ASSERT_FALSE(selftest_trigger_on_edge(&cool));
+	simulate_presses(4, 1000, 200);
+	TEST_ASSERT_FALSE(selftest_trigger_is_running());
+}
+
+void test_single_press_timed_from_edge(void)
+{
+	charge_now_init();
+	mock_uptime_ms = 1000;
+	button(1);
+	mock_uptime_ms = 1100;
+	button(0);
+
+	/* 1.5s after the press edge, not after a tick that saw it */
+	mock_uptime_ms = 2450;
+	selftest_trigger_tick();
+	TEST_ASSERT_FALSE(charge_now_is_active());
+	mock_uptime_ms = 2500;
+	selftest_trigger_tick();
+	TEST_ASSERT_TRUE(charge_now_is_active());
+}
+
+void test_long_press_timed_from_edge(void)
+{
+	charge_now_init();
+	charge_now_activate();
+	mock_uptime_ms = 1000;
+	button(1);
+
+	mock_uptime_ms = 3900;
+	selftest_trigger_tick();
+	TEST_ASSERT_TRUE(charge_now_is_active());
+	mock_uptime_ms = 4000;
+	selftest_trigger_tick();
+	TEST_ASSERT_FALSE(charge_now_is_active());
+}
+
+void test_polled_without_edge_api(void)
+{
+	static struct platform_api polled;
+
+	polled = *mock_platform_api_get();
+	polled.version = PLATFORM_API_VERSION_ADC_BURST;
+	platform = &polled;
+	mock_gpio_subscribed[PIN_CHARGE_NOW_BUTTON] = false;
+	selftest_trigger_init();
+	TEST_ASSERT_FALSE(mock_gpio_subscribed[PIN_CHARGE_NOW_BUTTON]);
+
+	simulate_presses(5, 1000, 200);
+	TEST_ASSERT_TRUE(selftest_trigger_is_running());
+}
+
+void test_next_ms_press_timeouts(void)
+{
+	charge_now_init();
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, selftest_trigger_next_ms());
+
+	/* Held: the long press is next */
+	mock_uptime_ms = 1000;
+	button(1);
+	mock_uptime_ms = 1200;
+	TEST_ASSERT_EQUAL_UINT32(LONG_PRESS_MS - 200, selftest_trigger_next_ms());
+
+	/* Released: the single-press timeout from the press edge */
+	button(0);
+	mock_uptime_ms = 1500;
+	TEST_ASSERT_EQUAL_UINT32(SINGLE_PRESS_TIMEOUT_MS - 500, selftest_trigger_next_ms());
+	mock_uptime_ms = 2600;
+	TEST_ASSERT_EQUAL_UINT32(0, selftest_trigger_next_ms());
+
+	selftest_trigger_tick();
+	TEST_ASSERT_TRUE(charge_now_is_active());
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, selftest_trigger_next_ms());
+}
+
+void test_next_ms_every_tick_while_blinking(void)
+{
+	simulate_presses(5, 1000, 200);
+	TEST_ASSERT_TRUE(selftest_trigger_is_running());
+	TEST_ASSERT_EQUAL_UINT32(0, selftest_trigger_next_ms());
+	run_blinks_to_completion();
+	TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, selftest_trigger_next_ms());
+}
+
+void test_next_ms_every_tick_when_polled(void)
+{
+	mock_gpio_subscribed[PIN_CHARGE_NOW_BUTTON] = false;
+	mock_gpio_subscribe_return = -19;
+	selftest_trigger_init();
+	TEST_ASSERT_EQUAL_UINT32(0, selftest_trigger_next_ms());
+}
+
+void test_polled_when_button_not_fitted(void)
+{
+	mock_gpio_subscribed[PIN_CHARGE_NOW_BUTTON] = false;
+	mock_gpio_subscribe_return = -19;  /* -ENODEV */
+	selftest_trigger_init();
+	TEST_ASSERT_FALSE(mock_gpio_subscribed[PIN_CHARGE_NOW_BUTTON]);
+
+	simulate_presses(5, 1000, 200);
+	TEST_ASSERT_TRUE(selftest_trigger_is_running());
+}
+
 /* ------------------------------------------------------------------ */
 /*  Blink codes — all pass (3 green, 0 red)                           */
 /* ------------------------------------------------------------------ */
@@ -288,7 +436,7 @@ void test_returns_to_idle_after_completion(void)
 	TEST_ASSERT_FALSE(selftest_trigger_is_running());
 
 	/* One idle tick with button released to reset edge detection */
-	mock_gpio_values[PIN_CHARGE_NOW_BUTTON] = 0;
+	button(0);
 	selftest_trigger_tick();
 
 	/* Can trigger again */
@@ -361,6 +509,16 @@ int main(void)
 	RUN_TEST(test_five_presses_outside_window_no_trigger);
 	RUN_TEST(test_old_presses_expire);
 	RUN_TEST(test_button_ignored_while_running);
+	RUN_TEST(test_subscribes_button_edges);
+	RUN_TEST(test_short_presses_between_ticks_count);
+	RUN_TEST(test_other_pin_edges_not_taken);
+	RUN_TEST(test_single_press_timed_from_edge);
+	RUN_TEST(test_long_press_timed_from_edge);
+	RUN_TEST(test_polled_without_edge_api);
+	RUN_TEST(test_next_ms_press_timeouts);
+	RUN_TEST(test_next_ms_every_tick_while_blinking);
+	RUN_TEST(test_next_ms_every_tick_when_polled);
+	RUN_TEST(test_polled_when_button_not_fitted);
 
 	/* Blink codes */
 	RUN_TEST(test_blink_all_pass_green_count);
@@ -156,7 +156,8 @@ void test_evse_status_returns_zero(void)
 
 void test_evse_status_prints_j1772_state(void)
 {
-	mock_adc_values[0] = 3000; /* State A */
+	mock_adc_values[0] = 3000; /* State A, read fresh: no debounce */
+	evse_sensors_init();
 	app_cb.on_shell_cmd("evse", "status", capture_print, capture_error);
 
 	TEST_ASSERT_TRUE(print_output_contains("J1772 state"));
@@ -170,6 +171,7 @@ void test_evse_status_prints_voltage(void)
 
 	TEST_ASSERT_TRUE(print_output_contains("Pilot voltage"));
 	TEST_ASSERT_TRUE(print_output_contains("2200 mV"));
+	TEST_ASSERT_TRUE(print_output_contains("150 mV hysteresis, 3-read debounce"));
 }
 
 void test_evse_status_prints_current(void)
@@ -330,15 +332,19 @@ void test_hvac_status_prints_flags(void)
 
 	TEST_ASSERT_TRUE(print_output_contains("Thermostat flags"));
 	TEST_ASSERT_TRUE(print_output_contains("Cool"));
+	TEST_ASSERT_TRUE(print_output_contains("Input: edge interrupts, no change yet"));
 }
 
 void test_hvac_status_cool_on(void)
 {
-	mock_gpio_values[2] = 1; /* cool on */
+	/* Cool call edge that started 100 ms ago */
+	mock_uptime_ms = 5000;
+	TEST_ASSERT_EQUAL_INT(1, mock_gpio_edge(&app_cb, 2, 1, 4900));
 
 	app_cb.on_shell_cmd("hvac", "status", capture_print, capture_error);
 
 	TEST_ASSERT_TRUE(print_output_contains("Cool: ON"));
+	TEST_ASSERT_TRUE(print_output_contains("last change 100 ms ago"));
 }
 
 void test_hvac_null_args_shows_status(void)
@@ -0,0 +1,212 @@
+/*
+ * Unit tests for sidewalk_evq.c — the Sidewalk thread's work queue:
+ * class priority, sid_process() coalescing, per-class drops, and
+ * synthetic radio/uplink event storms.
+ */
+
+#include "unity.h"
+#include <sidewalk_evq.h>
+#include <errno.h>
+#include <stdio.h>
+
+static struct sidewalk_evq q;
+
+/* Handlers are only compared and called, never given a real context */
+static int process_runs;
+static void h_process(struct sidewalk_ctx *sid, void *ctx) { (void)sid; (void)ctx; process_runs++; }
+static void h_status(struct sidewalk_ctx *sid, void *ctx) { (void)sid; (void)ctx; }
+static void h_send(struct sidewalk_ctx *sid, void *ctx) { (void)sid; (void)ctx; }
+
+static int freed;
+static void count_free(void *ctx) { (void)ctx; freed++; }
+
+static int push(enum sidewalk_evq_class cls, void (*h)(struct sidewalk_ctx *, void *),
+		uintptr_t tag)
+{
+	struct sidewalk_evq_event ev = { .handler = h, .ctx = (void *)tag };
+	return sidewalk_evq_push(&q, cls, &ev);
+}
+
+void setUp(void)
+{
+	sidewalk_evq_init(&q);
+	process_runs = 0;
+	freed = 0;
+}
+
+void tearDown(void) { }
+
+static void test_empty_queue_pops_nothing(void)
+{
+	struct sidewalk_evq_event ev;
+	TEST_ASSERT_FALSE(sidewalk_evq_pop(&q, &ev));
+	TEST_ASSERT_EQUAL_UINT8(0, q.stats.depth);
+}
+
+static void test_classes_served_in_priority_order(void)
+{
+	struct sidewalk_evq_event ev;
+
+	push(SIDEWALK_EVQ_UPLINK, h_send, 1);
+	push(SIDEWALK_EVQ_UPLINK, h_send, 2);
+	push(SIDEWALK_EVQ_CONTROL, h_status, 3);
+	push(SIDEWALK_EVQ_RADIO, h_process, 0);
+
+	uintptr_t order[4];
+	for (int i = 0; i < 4; i++) {
+		TEST_ASSERT_TRUE(sidewalk_evq_pop(&q, &ev));
+		order[i] = (ev.handler == h_process) ? 0 : (uintptr_t)ev.ctx;
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, order[0]);
+	TEST_ASSERT_EQUAL_UINT32(3, order[1]);
+	TEST_ASSERT_EQUAL_UINT32(1, order[2]);   /* FIFO within a class */
+	TEST_ASSERT_EQUAL_UINT32(2, order[3]);
+	TEST_ASSERT_FALSE(sidewalk_evq_pop(&q, &ev));
+}
+
+static void test_pending_process_requests_coalesce(void)
+{
+	struct sidewalk_evq_event ev;
+
+	for (int i = 0; i < 100; i++) {
+		TEST_ASSERT_EQUAL_INT(0, push(SIDEWALK_EVQ_RADIO, h_process, 0));
+	}
+	TEST_ASSERT_EQUAL_UINT8(1, q.stats.depth);
+	TEST_ASSERT_EQUAL_UINT32(99, q.stats.coalesced);
+
+	/* Once taken, the next request queues again */
+	TEST_ASSERT_TRUE(sidewalk_evq_pop(&q, &ev));
+	push(SIDEWALK_EVQ_RADIO, h_process, 0);
+	TEST_ASSERT_EQUAL_UINT8(1, q.stats.depth);
+}
+
+static void test_coalesced_event_ctx_is_freed(void)
+{
+	struct sidewalk_evq_event ev = { .handler = h_process, .ctx_free = count_free };
+
+	sidewalk_evq_push(&q, SIDEWALK_EVQ_RADIO, &ev);
+	sidewalk_evq_push(&q, SIDEWALK_EVQ_RADIO, &ev);
+	TEST_ASSERT_EQUAL_INT(1, freed);
+}
+
+static void test_other_classes_do_not_coalesce(void)
+{
+	push(SIDEWALK_EVQ_CONTROL, h_status, 0);
+	push(SIDEWALK_EVQ_CONTROL, h_status, 0);
+	push(SIDEWALK_EVQ_UPLINK, h_send, 0);
+	push(SIDEWALK_EVQ_UPLINK, h_send, 0);
+	TEST_ASSERT_EQUAL_UINT8(4, q.stats.depth);
+	TEST_ASSERT_EQUAL_UINT32(0, q.stats.coalesced);
+}
+
+static void test_full_uplink_class_drops_without_blocking_control(void)
+{
+	for (int i = 0; i < SIDEWALK_EVQ_DEPTH; i++) {
+		TEST_ASSERT_EQUAL_INT(0, push(SIDEWALK_EVQ_UPLINK, h_send, (uintptr_t)i));
+	}
+	TEST_ASSERT_EQUAL_INT(-ENOMSG, push(SIDEWALK_EVQ_UPLINK, h_send, 99));
+	TEST_ASSERT_EQUAL_UINT32(1, q.stats.dropped[SIDEWALK_EVQ_UPLINK]);
+
+	TEST_ASSERT_EQUAL_INT(0, push(SIDEWALK_EVQ_CONTROL, h_status, 0));
+	TEST_ASSERT_EQUAL_INT(0, push(SIDEWALK_EVQ_RADIO, h_process, 0));
+	TEST_ASSERT_EQUAL_UINT32(0, q.stats.dropped[SIDEWALK_EVQ_CONTROL]);
+	TEST_ASSERT_EQUAL_UINT8(SIDEWALK_EVQ_DEPTH + 2, q.stats.high_water);
+}
+
+static void test_invalid_class_rejected(void)
+{
+	TEST_ASSERT_EQUAL_INT(-EINVAL, push(SIDEWALK_EVQ_CLASSES, h_send, 0));
+	TEST_ASSERT_EQUAL_UINT8(0, q.stats.depth);
+}
+
+/* Deterministic LCG so storms are reproducible */
+static uint32_t rng = 1;
+static uint32_t next_rand(void)
+{
+	rng = rng * 1103515245u + 12345u;
+	return (rng >> 16) & 0x7FFF;
+}
+
+static void test_radio_storm_never_drops_and_keeps_order(void)
+{
+	/* Each tick: every other tick a burst of up to 40 radio callbacks
+	 * (as from ISR), a status change 1 in 10, an uplink 1 in 2; the
+	 * thread handles one event. Offered load is over capacity, so the
+	 * lowest class must absorb all of the loss. */
+	struct sidewalk_evq_event ev;
+	uint32_t next_uplink = 0, next_expected = 0;
+	uint32_t uplinks_sent = 0, uplinks_dropped = 0, callbacks = 0;
+
+	rng = 1;
+	for (int tick = 0; tick < 10000; tick++) {
+		uint32_t burst = (next_rand() % 2) ? next_rand() % 41 : 0;
+		for (uint32_t i = 0; i < burst; i++) {
+			TEST_ASSERT_EQUAL_INT(0, push(SIDEWALK_EVQ_RADIO, h_process, 0));
+			callbacks++;
+		}
+		if (next_rand() % 10 == 0) {
+			TEST_ASSERT_EQUAL_INT(0, push(SIDEWALK_EVQ_CONTROL, h_status, 0));
+		}
+		if (next_rand() % 2 == 0) {
+			if (push(SIDEWALK_EVQ_UPLINK, h_send, next_uplink) == 0) {
+				uplinks_sent++;
+			} else {
+				uplinks_dropped++;
+			}
+			next_uplink++;
+		}
+
+		if (sidewalk_evq_pop(&q, &ev)) {
+			if (ev.handler == h_send) {
+				/* Uplinks keep their relative order, gaps = drops */
+				TEST_ASSERT_TRUE((uintptr_t)ev.ctx >= next_expected);
+				next_expected = (uint32_t)(uintptr_t)ev.ctx + 1;
+			} else {
+				ev.handler(NULL, ev.ctx);
+			}
+		}
+	}
+
+	TEST_ASSERT_EQUAL_UINT32(0, q.stats.dropped[SIDEWALK_EVQ_RADIO]);
+	TEST_ASSERT_EQUAL_UINT32(0, q.stats.dropped[SIDEWALK_EVQ_CONTROL]);
+	TEST_ASSERT_EQUAL_UINT32(uplinks_dropped, q.stats.dropped[SIDEWALK_EVQ_UPLINK]);
+	TEST_ASSERT_LESS_OR_EQUAL_UINT8(3 * SIDEWALK_EVQ_DEPTH, q.stats.high_water);
+	TEST_ASSERT_TRUE(q.stats.coalesced > callbacks / 2);
+	TEST_ASSERT_TRUE(uplinks_sent > 0);
+	TEST_ASSERT_TRUE(uplinks_dropped > 0);
+
+	printf("  storm: %u radio callbacks -> %d sid_process runs, "
+	       "uplinks %u queued / %u dropped, high-water %u\n",
+	       callbacks, process_runs, uplinks_sent, uplinks_dropped,
+	       q.stats.high_water);
+}
+
+static void test_uplink_flood_does_not_delay_process(void)
+{
+	/* App floods uplinks; a radio event arriving behind them is still
+	 * the next thing the thread runs */
+	struct sidewalk_evq_event ev;
+
+	for (int i = 0; i < SIDEWALK_EVQ_DEPTH + 5; i++) {
+		push(SIDEWALK_EVQ_UPLINK, h_send, (uintptr_t)i);
+	}
+	push(SIDEWALK_EVQ_RADIO, h_process, 0);
+	TEST_ASSERT_TRUE(sidewalk_evq_pop(&q, &ev));
+	TEST_ASSERT_EQUAL_PTR(h_process, ev.handler);
+	TEST_ASSERT_EQUAL_UINT32(5, q.stats.dropped[SIDEWALK_EVQ_UPLINK]);
+}
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_empty_queue_pops_nothing);
+	RUN_TEST(test_classes_served_in_priority_order);
+	RUN_TEST(test_pending_process_requests_coalesce);
+	RUN_TEST(test_coalesced_event_ctx_is_freed);
+	RUN_TEST(test_other_classes_do_not_coalesce);
+	RUN_TEST(test_full_uplink_class_drops_without_blocking_control);
+	RUN_TEST(test_invalid_class_rejected);
+	RUN_TEST(test_radio_storm_never_drops_and_keeps_order);
+	RUN_TEST(test_uplink_flood_does_not_delay_process);
+	return UNITY_END();
+}
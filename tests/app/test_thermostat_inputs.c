@@ -7,6 +7,29 @@
 #include "app_platform.h"
 #include "thermostat_inputs.h"
 
+/* Platform without edge interrupts (API v7): every read polls the pin */
+static struct platform_api polled;
+
+static void use_polled_platform(void)
+{
+	polled = *mock_platform_api_get();
+	polled.version = PLATFORM_API_VERSION_ADC_BURST;
+	platform = &polled;
+	thermostat_inputs_init();
+}
+
+static void cool_edge(int level, uint32_t at_ms)
+{
+	struct platform_gpio_edge edge = {
+		.at_ms = at_ms,
+		.pin = THERMOSTAT_PIN_COOL,
+		.level = (uint8_t)level,
+	};
+
+	mock_gpio_values[THERMOSTAT_PIN_COOL] = level;
+	TEST_ASSERT_TRUE(thermostat_inputs_on_edge(&edge));
+}
+
 void setUp(void)
 {
 	platform = mock_platform_api_init();
@@ -19,12 +42,14 @@ void tearDown(void) {}
 
 void test_cool_call_high(void)
 {
+	use_polled_platform();
 	mock_gpio_values[2] = 1;
 	TEST_ASSERT_TRUE(thermostat_inputs_cool_call_get());
 }
 
 void test_cool_call_low(void)
 {
+	use_polled_platform();
 	mock_gpio_values[2] = 0;
 	TEST_ASSERT_FALSE(thermostat_inputs_cool_call_get());
 }
@@ -33,16 +58,73 @@ void test_cool_call_low(void)
 
 void test_flags_cool_only(void)
 {
+	use_polled_platform();
 	mock_gpio_values[2] = 1;
 	TEST_ASSERT_EQUAL_UINT8(THERMOSTAT_FLAG_COOL, thermostat_inputs_flags_get());
 }
 
 void test_flags_none(void)
 {
+	use_polled_platform();
 	mock_gpio_values[2] = 0;
 	TEST_ASSERT_EQUAL_UINT8(0x00, thermostat_inputs_flags_get());
 }
 
+/* --- Edge interrupts (API v8+) --- */
+
+void test_subscribes_cool_call_edges(void)
+{
+	TEST_ASSERT_TRUE(thermostat_inputs_edge_driven());
+	TEST_ASSERT_TRUE(mock_gpio_subscribed[THERMOSTAT_PIN_COOL]);
+	TEST_ASSERT_EQUAL_UINT32(THERMOSTAT_DEBOUNCE_MS, mock_gpio_debounce_ms[THERMOSTAT_PIN_COOL]);
+}
+
+void test_initial_level_read_at_subscribe(void)
+{
+	mock_gpio_values[2] = 1;
+	thermostat_inputs_init();
+	TEST_ASSERT_TRUE(thermostat_inputs_cool_call_get());
+	TEST_ASSERT_EQUAL_UINT32(0, thermostat_inputs_changed_ms());
+}
+
+void test_edges_drive_cool_call(void)
+{
+	cool_edge(1, 1234);
+	TEST_ASSERT_TRUE(thermostat_inputs_cool_call_get());
+	TEST_ASSERT_EQUAL_UINT8(THERMOSTAT_FLAG_COOL, thermostat_inputs_flags_get());
+	TEST_ASSERT_EQUAL_UINT32(1234, thermostat_inputs_changed_ms());
+
+	cool_edge(0, 98765);
+	TEST_ASSERT_FALSE(thermostat_inputs_cool_call_get());
+	TEST_ASSERT_EQUAL_UINT32(98765, thermostat_inputs_changed_ms());
+}
+
+void test_level_between_edges_not_polled(void)
+{
+	/* A glitch the platform filtered never reaches the app */
+	mock_gpio_values[2] = 1;
+	TEST_ASSERT_FALSE(thermostat_inputs_cool_call_get());
+}
+
+void test_other_pin_edge_not_taken(void)
+{
+	struct platform_gpio_edge button = { .at_ms = 10, .pin = 3, .level = 1 };
+
+	TEST_ASSERT_FALSE(thermostat_inputs_on_edge(&button));
+	TEST_ASSERT_FALSE(thermostat_inputs_cool_call_get());
+	TEST_ASSERT_EQUAL_UINT32(0, thermostat_inputs_changed_ms());
+}
+
+void test_subscribe_failure_falls_back_to_polling(void)
+{
+	mock_gpio_subscribe_return = -19;  /* -ENODEV */
+	thermostat_inputs_init();
+	TEST_ASSERT_FALSE(thermostat_inputs_edge_driven());
+
+	mock_gpio_values[2] = 1;
+	TEST_ASSERT_TRUE(thermostat_inputs_cool_call_get());
+}
+
 /* --- main --- */
 
 int main(void)
@@ -53,6 +135,12 @@ int main(void)
 	RUN_TEST(test_cool_call_low);
 	RUN_TEST(test_flags_cool_only);
 	RUN_TEST(test_flags_none);
+	RUN_TEST(test_subscribes_cool_call_edges);
+	RUN_TEST(test_initial_level_read_at_subscribe);
+	RUN_TEST(test_edges_drive_cool_call);
+	RUN_TEST(test_level_between_edges_not_polled);
+	RUN_TEST(test_other_pin_edge_not_taken);
+	RUN_TEST(test_subscribe_failure_falls_back_to_polling);
 
 	return UNITY_END();
 }
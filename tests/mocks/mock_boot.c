@@ -2,7 +2,8 @@
  * Mock implementations for platform dependencies when testing app.c on the host.
  *
  * Provides stub implementations for Sidewalk, OTA, LED, and config functions
- * that app.c calls. Only the OTA mock tracks calls (for routing tests).
+ * that app.c calls. Only the OTA mock tracks calls (for routing tests), and
+ * the Sidewalk ready state is settable (for the trial image deadline).
  */
 
 #include <stdint.h>
@@ -76,6 +77,13 @@ void sidewalk_event_autostart(void)
 {
 }
 
+bool mock_tx_ready;
+
+bool tx_state_is_ready(void)
+{
+	return mock_tx_ready;
+}
+
 /* ------------------------------------------------------------------ */
 /*  LED / config stubs                                                  */
 /* ------------------------------------------------------------------ */
@@ -110,3 +118,14 @@ int sidewalk_dispatch_register_gatt_auth(void)
 /* ------------------------------------------------------------------ */
 
 const struct platform_api platform_api_table = {0};
+
+int platform_send_ota_msg(const uint8_t *data, size_t len)
+{
+	(void)data; (void)len;
+	return 0;
+}
+
+int platform_adc_start(void)
+{
+	return 0;
+}
@@ -7,6 +7,7 @@
 
 /* These must match the externs in zephyr/drivers/flash.h and zephyr/device.h */
 #include <zephyr/device.h>
+#include <zephyr/kernel.h>
 
 struct device mock_flash_device = { .name = "mock_flash" };
 
@@ -14,17 +15,40 @@ struct device mock_flash_device = { .name = "mock_flash" };
 
 uint8_t mock_flash_mem[MOCK_FLASH_SIZE];
 int mock_flash_read_count;
+size_t mock_flash_read_bytes;
 int mock_flash_write_count;
 int mock_flash_erase_count;
 int mock_flash_fail_at_page = -1;
+uint16_t mock_flash_page_erases[MOCK_FLASH_SIZE / 4096];
+uint8_t mock_flash_word_writes[MOCK_FLASH_SIZE / 4];
+int mock_flash_nwrite_errors;
+uint64_t mock_flash_busy_us;
 int mock_reboot_count;
+struct k_work_delayable *mock_work_scheduled;
 
 void mock_flash_reset(void)
 {
 	memset(mock_flash_mem, 0xFF, MOCK_FLASH_SIZE);
 	mock_flash_read_count = 0;
+	mock_flash_read_bytes = 0;
 	mock_flash_write_count = 0;
 	mock_flash_erase_count = 0;
 	mock_flash_fail_at_page = -1;
+	memset(mock_flash_page_erases, 0, sizeof(mock_flash_page_erases));
+	memset(mock_flash_word_writes, 0, sizeof(mock_flash_word_writes));
+	mock_flash_nwrite_errors = 0;
+	mock_flash_busy_us = 0;
 	mock_reboot_count = 0;
+	mock_work_scheduled = NULL;
+}
+
+/* Fire the pending delayed work item, as if its delay had elapsed */
+void mock_work_run_scheduled(void)
+{
+	struct k_work_delayable *w = mock_work_scheduled;
+
+	mock_work_scheduled = NULL;
+	if (w && w->handler) {
+		w->handler(&w->work);
+	}
 }
@@ -1,20 +1,31 @@
 /*
- * Mock OTA signing — provides controllable ota_verify_signature() for tests.
+ * Mock OTA signing — provides controllable ota_verify_*() for tests.
  *
  * Tests call mock_ota_signing_set_result() to control the return value,
  * allowing verification of the full signing flow in ota_update.c without
- * a real ED25519 implementation.
+ * a real ED25519 implementation. The bytes fed through ota_verify_update()
+ * are counted and CRC'd so tests can check exactly what was hashed.
  */
 
 #include <ota_signing.h>
+#include <stdbool.h>
+#include <string.h>
 
 static int mock_verify_result;
 static int mock_verify_call_count;
+static size_t mock_hashed_len;
+static uint32_t mock_hashed_crc;
+static uint8_t mock_last_sig[OTA_SIG_SIZE];
+static bool mock_hash_active;
 
 void mock_ota_signing_reset(void)
 {
 	mock_verify_result = 0;
 	mock_verify_call_count = 0;
+	mock_hashed_len = 0;
+	mock_hashed_crc = 0;
+	mock_hash_active = false;
+	memset(mock_last_sig, 0, sizeof(mock_last_sig));
 }
 
 void mock_ota_signing_set_result(int result)
@@ -27,11 +38,61 @@ int mock_ota_signing_get_call_count(void)
 	return mock_verify_call_count;
 }
 
-int ota_verify_signature(const uint8_t *data, size_t len, const uint8_t *sig)
+/* Length and CRC32 (IEEE) of the data hashed by the last verification */
+size_t mock_ota_signing_get_hashed_len(void)
+{
+	return mock_hashed_len;
+}
+
+uint32_t mock_ota_signing_get_hashed_crc(void)
+{
+	return mock_hashed_crc;
+}
+
+const uint8_t *mock_ota_signing_get_sig(void)
+{
+	return mock_last_sig;
+}
+
+int ota_verify_begin(void)
 {
-	(void)data;
-	(void)len;
-	(void)sig;
+	mock_hashed_len = 0;
+	mock_hashed_crc = 0;
+	mock_hash_active = true;
+	return 0;
+}
+
+int ota_verify_update(const uint8_t *data, size_t len)
+{
+	if (!mock_hash_active) {
+		return -1;
+	}
+	uint32_t crc = ~mock_hashed_crc;
+	for (size_t i = 0; i < len; i++) {
+		crc ^= data[i];
+		for (int j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+	mock_hashed_crc = ~crc;
+	mock_hashed_len += len;
+	return 0;
+}
+
+int ota_verify_finish(const uint8_t *sig)
+{
+	if (!mock_hash_active) {
+		return -1;
+	}
+	mock_hash_active = false;
+	memcpy(mock_last_sig, sig, OTA_SIG_SIZE);
 	mock_verify_call_count++;
 	return mock_verify_result;
 }
+
+int ota_verify_signature(const uint8_t *data, size_t len, const uint8_t *sig)
+{
+	ota_verify_begin();
+	ota_verify_update(data, len);
+	return ota_verify_finish(sig);
+}
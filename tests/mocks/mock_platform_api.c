@@ -14,13 +14,26 @@
 
 int  mock_adc_values[4];
 bool mock_adc_fail[4];
+bool mock_adc_no_sample;
+int  mock_adc_read_count;
+int  mock_adc_get_count;
+int16_t mock_adc_burst[MOCK_ADC_BURST_MAX];
+int  mock_adc_burst_len;
+int  mock_adc_burst_count;
+uint32_t mock_adc_scan_ms;
 
 int  mock_gpio_values[4];
 bool mock_gpio_fail[4];
 bool mock_gpio_readback_fail[4];
+int  mock_gpio_subscribe_return;
+
+bool     mock_gpio_subscribed[4];
+uint32_t mock_gpio_debounce_ms[4];
+int      mock_gpio_subscribe_count;
 
 uint32_t mock_uptime_ms;
 bool     mock_sidewalk_ready;
+int      mock_link_mask;
 
 /* --- Observable outputs: sends --- */
 
@@ -28,6 +41,12 @@ struct mock_send_record mock_sends[MOCK_MAX_SENDS];
 int    mock_send_count;
 int    mock_send_return;
 
+struct mock_send_record mock_pending[MOCK_MAX_PENDING];
+int    mock_pending_count;
+
+static uint32_t mock_next_msg_id;
+static uint32_t mock_rand_state;
+
 /* Legacy aliases */
 uint8_t *mock_last_send_buf = mock_sends[0].data;
 size_t   mock_last_send_len;
@@ -48,6 +67,15 @@ char mock_last_log[256];
 /* --- Observable outputs: timer --- */
 
 uint32_t mock_timer_interval;
+int      mock_timer_set_count;
+uint32_t mock_timer_due_ms;
+
+/* --- Observable outputs: LED patterns --- */
+
+struct mock_led_pattern mock_led_patterns[MOCK_MAX_LED_PATTERNS];
+int  mock_led_pattern_count;
+int  mock_led_pattern_return;
+bool mock_led_pattern_playing[4];
 
 /* --- Observable outputs: LEDs --- */
 
@@ -58,6 +86,14 @@ bool mock_led_last_on;
 int mock_led_call_count;
 struct mock_led_record mock_led_calls[MOCK_MAX_LED_CALLS];
 
+/* --- Persistent record log --- */
+
+uint8_t  mock_log_records[MOCK_LOG_CAPACITY][MOCK_LOG_REC_SIZE];
+int      mock_log_count;
+int      mock_log_append_count;
+int      mock_log_trim_count;
+uint32_t mock_log_last_trim;
+
 bool mock_led_states[4];
 int  mock_led_on_count[4];
 
@@ -65,17 +101,58 @@ int  mock_led_on_count[4];
 
 static int stub_send_msg(const uint8_t *data, size_t len)
 {
+	uint32_t id = (mock_send_return < 0) ? 0 : ++mock_next_msg_id;
+	size_t copy = len < MOCK_SEND_BUF_SIZE ? len : MOCK_SEND_BUF_SIZE;
+
 	if (data && mock_send_count < MOCK_MAX_SENDS) {
-		size_t copy = len < MOCK_SEND_BUF_SIZE ? len : MOCK_SEND_BUF_SIZE;
 		memcpy(mock_sends[mock_send_count].data, data, copy);
 		mock_sends[mock_send_count].len = len;
+		mock_sends[mock_send_count].msg_id = id;
+	}
+	if (data && id && mock_pending_count < MOCK_MAX_PENDING) {
+		memcpy(mock_pending[mock_pending_count].data, data, copy);
+		mock_pending[mock_pending_count].len = len;
+		mock_pending[mock_pending_count].msg_id = id;
+		mock_pending_count++;
 	}
 	/* Also update legacy last-send aliases */
 	if (data && len <= sizeof(mock_sends[0].data)) {
 		mock_last_send_len = len;
 	}
 	mock_send_count++;
-	return mock_send_return;
+	return (mock_send_return < 0) ? mock_send_return : (int)id;
+}
+
+int mock_deliver_sends(const struct app_callbacks *cb, int error_pct,
+		       void (*delivered)(const uint8_t *data, size_t len))
+{
+	int ok = 0;
+
+	/* Snapshot the list: callbacks may queue new sends */
+	struct mock_send_record batch[MOCK_MAX_PENDING];
+	int n = mock_pending_count;
+	memcpy(batch, mock_pending, n * sizeof(batch[0]));
+	mock_pending_count = 0;
+
+	for (int i = 0; i < n; i++) {
+		mock_rand_state = mock_rand_state * 1103515245u + 12345u;
+		bool fail = (int)((mock_rand_state >> 16) % 100) < error_pct;
+
+		if (fail) {
+			if (cb && cb->on_send_error) {
+				cb->on_send_error(batch[i].msg_id, -5);
+			}
+			continue;
+		}
+		if (delivered) {
+			delivered(batch[i].data, batch[i].len);
+		}
+		if (cb && cb->on_msg_sent) {
+			cb->on_msg_sent(batch[i].msg_id);
+		}
+		ok++;
+	}
+	return ok;
 }
 
 static bool stub_is_ready(void)
@@ -85,7 +162,7 @@ static bool stub_is_ready(void)
 
 static int stub_get_link_mask(void)
 {
-	return 4; /* SID_LINK_TYPE_3 = LoRa */
+	return mock_link_mask;
 }
 
 static int stub_set_link_mask(uint32_t mask)
@@ -101,6 +178,7 @@ static int stub_factory_reset(void)
 
 static int stub_adc_read_mv(int channel)
 {
+	mock_adc_read_count++;
 	if (channel < 0 || channel >= 4) {
 		return -1;
 	}
@@ -110,6 +188,53 @@ static int stub_adc_read_mv(int channel)
 	return mock_adc_values[channel];
 }
 
+static uint32_t mock_adc_scan_time(void)
+{
+	return mock_adc_scan_ms ? mock_uptime_ms - mock_uptime_ms % mock_adc_scan_ms
+				: mock_uptime_ms;
+}
+
+static int stub_adc_get_mv(int channel, uint32_t *sample_ms)
+{
+	mock_adc_get_count++;
+	if (mock_adc_no_sample) {
+		return PLATFORM_ADC_NO_SAMPLE;
+	}
+	if (channel < 0 || channel >= 4 || mock_adc_fail[channel]) {
+		return -1;
+	}
+	if (sample_ms) {
+		*sample_ms = mock_adc_scan_time();
+	}
+	return mock_adc_values[channel];
+}
+
+static int stub_adc_get_burst(int channel, int16_t *mv, size_t max, uint32_t *sample_ms)
+{
+	mock_adc_burst_count++;
+	if (mock_adc_no_sample) {
+		return PLATFORM_ADC_NO_SAMPLE;
+	}
+	if (channel < 0 || channel >= 4 || mock_adc_fail[channel] || max == 0) {
+		return -1;
+	}
+	if (sample_ms) {
+		*sample_ms = mock_adc_scan_time();
+	}
+	if (mock_adc_burst_len == 0) {
+		/* Negative values stand in for errors, as in adc_get_mv */
+		if (mock_adc_values[channel] < 0) {
+			return mock_adc_values[channel];
+		}
+		mv[0] = (int16_t)mock_adc_values[channel];
+		return 1;
+	}
+	size_t n = (size_t)mock_adc_burst_len < max ? (size_t)mock_adc_burst_len : max;
+
+	memcpy(mv, mock_adc_burst, n * sizeof(mv[0]));
+	return (int)n;
+}
+
 static int stub_gpio_get(int pin_index)
 {
 	if (pin_index < 0 || pin_index >= 4) {
@@ -124,6 +249,39 @@ static int stub_gpio_get(int pin_index)
 	return mock_gpio_values[pin_index];
 }
 
+static int stub_gpio_subscribe(int pin_index, uint32_t debounce_ms)
+{
+	mock_gpio_subscribe_count++;
+	if (pin_index < 0 || pin_index >= 4 || debounce_ms > 1000) {
+		return -22;  /* -EINVAL */
+	}
+	if (mock_gpio_subscribe_return < 0) {
+		return mock_gpio_subscribe_return;
+	}
+	mock_gpio_subscribed[pin_index] = true;
+	mock_gpio_debounce_ms[pin_index] = debounce_ms;
+	return 0;
+}
+
+int mock_gpio_edge(const struct app_callbacks *cb, int pin, int level, uint32_t at_ms)
+{
+	if (pin < 0 || pin >= 4) {
+		return 0;
+	}
+	mock_gpio_values[pin] = level;
+	if (!mock_gpio_subscribed[pin] || !cb || !cb->on_gpio_edges) {
+		return 0;
+	}
+
+	struct platform_gpio_edge edge = {
+		.at_ms = at_ms,
+		.pin = (uint8_t)pin,
+		.level = (uint8_t)(level ? 1 : 0),
+	};
+	cb->on_gpio_edges(&edge, 1);
+	return 1;
+}
+
 static int stub_gpio_set(int pin_index, int val)
 {
 	mock_gpio_set_call_count++;
@@ -147,9 +305,27 @@ static void stub_reboot(void)
 static int stub_set_timer_interval(uint32_t interval_ms)
 {
 	mock_timer_interval = interval_ms;
+	mock_timer_due_ms = mock_uptime_ms + interval_ms;
+	mock_timer_set_count++;
 	return 0;
 }
 
+uint32_t mock_timer_run(const struct app_callbacks *cb, uint32_t end_ms)
+{
+	uint32_t fires = 0;
+
+	while (mock_timer_interval && (int32_t)(mock_timer_due_ms - end_ms) <= 0) {
+		mock_uptime_ms = mock_timer_due_ms;
+		mock_timer_due_ms += mock_timer_interval;
+		fires++;
+		if (cb && cb->on_timer) {
+			cb->on_timer();
+		}
+	}
+	mock_uptime_ms = end_ms;
+	return fires;
+}
+
 static void stub_log_inf(const char *fmt, ...)
 {
 	va_list args;
@@ -184,6 +360,7 @@ static void stub_led_set(int led_id, bool on)
 	mock_led_last_on = on;
 
 	if (led_id >= 0 && led_id < 4) {
+		mock_led_pattern_playing[led_id] = false;
 		mock_led_states[led_id] = on;
 		if (on) {
 			mock_led_on_count[led_id]++;
@@ -197,6 +374,28 @@ static void stub_led_set(int led_id, bool on)
 	mock_led_call_count++;
 }
 
+static int stub_led_pattern(int led_id, const struct platform_led_step *steps,
+			    size_t count, uint8_t repeat)
+{
+	if (mock_led_pattern_return < 0) {
+		return mock_led_pattern_return;
+	}
+	if (led_id < 0 || led_id >= 4 || !count || count > PLATFORM_LED_MAX_STEPS) {
+		return -22;  /* -EINVAL */
+	}
+	if (mock_led_pattern_count < MOCK_MAX_LED_PATTERNS) {
+		struct mock_led_pattern *p = &mock_led_patterns[mock_led_pattern_count];
+
+		p->led_id = led_id;
+		memcpy(p->steps, steps, count * sizeof(*steps));
+		p->count = count;
+		p->repeat = repeat;
+	}
+	mock_led_pattern_count++;
+	mock_led_pattern_playing[led_id] = true;
+	return 0;
+}
+
 static void stub_shell_print(const char *fmt, ...)
 {
 	(void)fmt;
@@ -229,6 +428,53 @@ static bool stub_mfg_get_dev_id(uint8_t *id_out)
 	return true;
 }
 
+static int stub_log_append(const void *rec, size_t len)
+{
+	mock_log_append_count++;
+	if (len == 0 || len > MOCK_LOG_REC_SIZE) {
+		return -22;  /* -EINVAL */
+	}
+	if (mock_log_count == MOCK_LOG_CAPACITY) {
+		/* Full: drop oldest, like the flash log dropping a page */
+		memmove(mock_log_records[0], mock_log_records[1],
+			(MOCK_LOG_CAPACITY - 1) * MOCK_LOG_REC_SIZE);
+		mock_log_count--;
+	}
+	memset(mock_log_records[mock_log_count], 0, MOCK_LOG_REC_SIZE);
+	memcpy(mock_log_records[mock_log_count], rec, len);
+	mock_log_count++;
+	return 0;
+}
+
+static int stub_log_read(uint32_t index, void *rec, size_t len)
+{
+	if (index >= (uint32_t)mock_log_count) {
+		return -2;  /* -ENOENT */
+	}
+	memcpy(rec, mock_log_records[index],
+	       len < MOCK_LOG_REC_SIZE ? len : MOCK_LOG_REC_SIZE);
+	return 0;
+}
+
+static int stub_log_trim(uint32_t key_watermark)
+{
+	mock_log_trim_count++;
+	mock_log_last_trim = key_watermark;
+
+	int keep = 0;
+	for (int i = 0; i < mock_log_count; i++) {
+		uint32_t key;
+		memcpy(&key, mock_log_records[i], sizeof(key));
+		if (key > key_watermark) {
+			memmove(mock_log_records[keep], mock_log_records[i],
+				MOCK_LOG_REC_SIZE);
+			keep++;
+		}
+	}
+	mock_log_count = keep;
+	return 0;
+}
+
 /* --- Singleton API table --- */
 
 static struct platform_api mock_api;
@@ -269,6 +515,17 @@ const struct platform_api *mock_platform_api_init(void)
 	mock_api.mfg_get_version = stub_mfg_get_version;
 	mock_api.mfg_get_dev_id  = stub_mfg_get_dev_id;
 
+	mock_api.log_append = stub_log_append;
+	mock_api.log_read   = stub_log_read;
+	mock_api.log_trim   = stub_log_trim;
+
+	mock_api.adc_get_mv = stub_adc_get_mv;
+	mock_api.adc_get_burst = stub_adc_get_burst;
+
+	mock_api.gpio_subscribe = stub_gpio_subscribe;
+
+	mock_api.led_pattern = stub_led_pattern;
+
 	return &mock_api;
 }
 
@@ -281,9 +538,20 @@ void mock_platform_api_reset(void)
 {
 	memset(mock_adc_values, 0, sizeof(mock_adc_values));
 	memset(mock_adc_fail, 0, sizeof(mock_adc_fail));
+	mock_adc_no_sample  = false;
+	mock_adc_read_count = 0;
+	mock_adc_get_count  = 0;
+	memset(mock_adc_burst, 0, sizeof(mock_adc_burst));
+	mock_adc_burst_len   = 0;
+	mock_adc_burst_count = 0;
+	mock_adc_scan_ms     = 0;
 	memset(mock_gpio_values, 0, sizeof(mock_gpio_values));
 	memset(mock_gpio_fail, 0, sizeof(mock_gpio_fail));
 	memset(mock_gpio_readback_fail, 0, sizeof(mock_gpio_readback_fail));
+	mock_gpio_subscribe_return = 0;
+	memset(mock_gpio_subscribed, 0, sizeof(mock_gpio_subscribed));
+	memset(mock_gpio_debounce_ms, 0, sizeof(mock_gpio_debounce_ms));
+	mock_gpio_subscribe_count = 0;
 
 	mock_gpio_set_last_pin  = -1;
 	mock_gpio_set_last_val  = -1;
@@ -291,12 +559,16 @@ void mock_platform_api_reset(void)
 
 	mock_uptime_ms      = 0;
 	mock_sidewalk_ready = true;  /* default to ready */
+	mock_link_mask      = 4;     /* SID_LINK_TYPE_3 = LoRa */
 
 	memset(mock_sends, 0, sizeof(mock_sends));
 	mock_last_send_buf = mock_sends[0].data;
 	mock_last_send_len = 0;
 	mock_send_count    = 0;
 	mock_send_return   = 0;
+	mock_pending_count = 0;
+	mock_next_msg_id   = 0;
+	mock_rand_state    = 1;
 
 	mock_led_set_count = 0;
 	mock_led_last_id   = 0;
@@ -306,10 +578,23 @@ void mock_platform_api_reset(void)
 	memset(mock_led_states, 0, sizeof(mock_led_states));
 	memset(mock_led_on_count, 0, sizeof(mock_led_on_count));
 
+	memset(mock_led_patterns, 0, sizeof(mock_led_patterns));
+	mock_led_pattern_count = 0;
+	mock_led_pattern_return = 0;
+	memset(mock_led_pattern_playing, 0, sizeof(mock_led_pattern_playing));
+
 	mock_log_inf_count = 0;
 	mock_log_err_count = 0;
 	mock_log_wrn_count = 0;
 	memset(mock_last_log, 0, sizeof(mock_last_log));
 
 	mock_timer_interval = 0;
+	mock_timer_set_count = 0;
+	mock_timer_due_ms = 0;
+
+	memset(mock_log_records, 0, sizeof(mock_log_records));
+	mock_log_count        = 0;
+	mock_log_append_count = 0;
+	mock_log_trim_count   = 0;
+	mock_log_last_trim    = 0;
 }
@@ -17,29 +17,49 @@ extern "C" {
 #define MOCK_MAX_SENDS     16
 #define MOCK_SEND_BUF_SIZE 64
 #define MOCK_MAX_LED_CALLS 512
+#define MOCK_LOG_CAPACITY  64
+#define MOCK_LOG_REC_SIZE  12
+#define MOCK_MAX_PENDING   32
+#define MOCK_ADC_BURST_MAX 16
+#define MOCK_MAX_LED_PATTERNS 64
 
 /* --- Configurable inputs --- */
 
 extern int  mock_adc_values[4];
-extern bool mock_adc_fail[4];           /* adc_read_mv returns -1 */
+extern bool mock_adc_fail[4];           /* adc_read_mv/adc_get_mv return -1 */
+extern bool mock_adc_no_sample;         /* adc_get_mv: PLATFORM_ADC_NO_SAMPLE */
+extern int  mock_adc_read_count;        /* blocking adc_read_mv calls */
+extern int  mock_adc_get_count;         /* cached adc_get_mv calls */
+extern int16_t mock_adc_burst[MOCK_ADC_BURST_MAX];  /* adc_get_burst samples */
+extern int  mock_adc_burst_len;         /* 0: one sample, mock_adc_values[ch] */
+extern int  mock_adc_burst_count;       /* adc_get_burst calls */
+extern uint32_t mock_adc_scan_ms;       /* scan period: sample_ms is the last
+					 * multiple of it; 0 = uptime itself */
 
 extern int  mock_gpio_values[4];
 extern bool mock_gpio_fail[4];          /* gpio_get returns -1 */
 extern bool mock_gpio_readback_fail[4]; /* gpio_get returns !value */
+extern int  mock_gpio_subscribe_return; /* <0: gpio_subscribe fails with it */
 
 extern uint32_t mock_uptime_ms;
 extern bool     mock_sidewalk_ready;
+extern int      mock_link_mask;         /* get_link_mask result (default LoRa) */
 
 /* --- Observable outputs: sends --- */
 
 struct mock_send_record {
-	uint8_t data[MOCK_SEND_BUF_SIZE];
-	size_t  len;
+	uint8_t  data[MOCK_SEND_BUF_SIZE];
+	size_t   len;
+	uint32_t msg_id;
 };
 
 extern struct mock_send_record mock_sends[MOCK_MAX_SENDS];
 extern int    mock_send_count;
-extern int    mock_send_return;
+extern int    mock_send_return;         /* <0: send_msg fails with it; else msg ids 1, 2, ... */
+
+/* Accepted sends not yet confirmed or failed (see mock_deliver_sends) */
+extern struct mock_send_record mock_pending[MOCK_MAX_PENDING];
+extern int    mock_pending_count;
 
 /* Legacy aliases (point to sends[0]) */
 extern uint8_t *mock_last_send_buf;
@@ -51,6 +71,12 @@ extern int mock_gpio_set_last_pin;
 extern int mock_gpio_set_last_val;
 extern int mock_gpio_set_call_count;
 
+/* --- Observable outputs: GPIO edge subscriptions --- */
+
+extern bool     mock_gpio_subscribed[4];
+extern uint32_t mock_gpio_debounce_ms[4];
+extern int      mock_gpio_subscribe_count;
+
 /* --- Observable outputs: logging --- */
 
 extern int  mock_log_inf_count;
@@ -61,6 +87,8 @@ extern char mock_last_log[256];
 /* --- Observable outputs: timer --- */
 
 extern uint32_t mock_timer_interval;
+extern int      mock_timer_set_count;
+extern uint32_t mock_timer_due_ms;      /* uptime of the next on_timer */
 
 /* --- Observable outputs: LEDs --- */
 
@@ -80,6 +108,28 @@ extern struct mock_led_record mock_led_calls[MOCK_MAX_LED_CALLS];
 extern bool mock_led_states[4];
 extern int  mock_led_on_count[4];
 
+/* --- Observable outputs: LED patterns (API v9 led_pattern) --- */
+
+struct mock_led_pattern {
+	int     led_id;
+	struct platform_led_step steps[PLATFORM_LED_MAX_STEPS];
+	size_t  count;
+	uint8_t repeat;
+};
+
+extern struct mock_led_pattern mock_led_patterns[MOCK_MAX_LED_PATTERNS];
+extern int  mock_led_pattern_count;     /* accepted uploads, oldest first */
+extern int  mock_led_pattern_return;    /* <0: led_pattern fails with it */
+extern bool mock_led_pattern_playing[4]; /* uploaded, not since led_set */
+
+/* --- Persistent record log (RAM-backed; survives app re-init, not reset) --- */
+
+extern uint8_t  mock_log_records[MOCK_LOG_CAPACITY][MOCK_LOG_REC_SIZE];
+extern int      mock_log_count;          /* untrimmed records */
+extern int      mock_log_append_count;
+extern int      mock_log_trim_count;
+extern uint32_t mock_log_last_trim;
+
 /* Initialize and return the mock platform API table */
 const struct platform_api *mock_platform_api_init(void);
 
@@ -89,6 +139,31 @@ const struct platform_api *mock_platform_api_get(void);
 /* Reset all mock state — call in setUp() */
 void mock_platform_api_reset(void);
 
+/*
+ * Play the radio for every pending send: each one fails with
+ * probability error_pct (seeded LCG, reproducible across runs) via
+ * cb->on_send_error, otherwise it is reported through cb->on_msg_sent
+ * and handed to delivered() if non-NULL. Returns the number delivered.
+ */
+int mock_deliver_sends(const struct app_callbacks *cb, int error_pct,
+		       void (*delivered)(const uint8_t *data, size_t len));
+
+/*
+ * Play the platform's edge work item: `pin` settled on `level` after a
+ * change that started at at_ms. Sets mock_gpio_values[pin] and, if the
+ * app subscribed the pin, delivers the edge to cb->on_gpio_edges as a
+ * batch of one. Returns 1 if delivered, 0 if not subscribed.
+ */
+int mock_gpio_edge(const struct app_callbacks *cb, int pin, int level, uint32_t at_ms);
+
+/*
+ * Play the platform timer up to end_ms: fire cb->on_timer at each due
+ * time, advancing mock_uptime_ms to it. Like app.c's k_timer, the timer
+ * is periodic and set_timer_interval restarts it from the current
+ * uptime. Leaves mock_uptime_ms at end_ms; returns the number of fires.
+ */
+uint32_t mock_timer_run(const struct app_callbacks *cb, uint32_t end_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,10 +5,15 @@
 #ifndef MOCK_SIDEWALK_DISPATCH_H
 #define MOCK_SIDEWALK_DISPATCH_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 struct sid_event_callbacks;  /* forward declaration, full def in sidewalk.h */
 
 void sidewalk_dispatch_fill_callbacks(struct sid_event_callbacks *cbs,
 				      void *context);
 int sidewalk_dispatch_register_gatt_auth(void);
+void sidewalk_dispatch_track_msg(uint16_t sid_id, uint32_t token, bool app);
+void sidewalk_dispatch_send_failed(uint32_t token, int error);
 
 #endif /* MOCK_SIDEWALK_DISPATCH_H */
@@ -3,7 +3,7 @@
  * Implements flash_read/write/erase using RAM buffers that simulate
  * the nRF52840 flash regions relevant to OTA:
  *   - App primary:  0x90000 (256KB)
- *   - OTA metadata: 0xCFF00 (256B)
+ *   - OTA journal:  0xCF000 (3840B), metadata 0xCFF00 (256B)
  *   - OTA staging:  0xD0000 (~148KB)
  */
 #ifndef ZEPHYR_FLASH_H_MOCK
@@ -20,9 +20,25 @@
 
 extern uint8_t mock_flash_mem[MOCK_FLASH_SIZE];
 extern int mock_flash_read_count;
+extern size_t mock_flash_read_bytes;
 extern int mock_flash_write_count;
 extern int mock_flash_erase_count;
 extern int mock_flash_fail_at_page;  /* -1 = no failure; >= 0 = fail at this page erase */
+
+/* Wear and timing model: erases per 4KB page, and time the NVMC would be
+ * busy at the nRF52840's worst-case erase and word-program times */
+#define MOCK_FLASH_PAGE_SIZE   4096
+#define MOCK_FLASH_PAGES       (MOCK_FLASH_SIZE / MOCK_FLASH_PAGE_SIZE)
+#define MOCK_FLASH_ERASE_US    85000   /* tERASEPAGE */
+#define MOCK_FLASH_WORD_US     41      /* tWRITE, per 32-bit word */
+extern uint16_t mock_flash_page_erases[MOCK_FLASH_PAGES];
+
+/* The NVMC programs a 32-bit word at most twice between erases (nWRITE);
+ * a third program fails and is counted */
+#define MOCK_FLASH_NWRITE      2
+extern uint8_t mock_flash_word_writes[MOCK_FLASH_SIZE / 4];
+extern int mock_flash_nwrite_errors;
+extern uint64_t mock_flash_busy_us;
 extern int mock_reboot_count;
 
 /* Initialize mock flash to all 0xFF (erased state) */
@@ -33,6 +49,7 @@ static inline int flash_read(const struct device *dev, uint32_t addr,
 {
 	(void)dev;
 	mock_flash_read_count++;
+	mock_flash_read_bytes += len;
 	if (addr < MOCK_FLASH_BASE || addr + len > MOCK_FLASH_BASE + MOCK_FLASH_SIZE) {
 		return -1;
 	}
@@ -48,7 +65,22 @@ static inline int flash_write(const struct device *dev, uint32_t addr,
 	if (addr < MOCK_FLASH_BASE || addr + len > MOCK_FLASH_BASE + MOCK_FLASH_SIZE) {
 		return -1;
 	}
-	memcpy(&mock_flash_mem[addr - MOCK_FLASH_BASE], data, len);
+	for (size_t w = (addr - MOCK_FLASH_BASE) / 4;
+	     len && w <= (addr - MOCK_FLASH_BASE + len - 1) / 4; w++) {
+		if (mock_flash_word_writes[w] >= MOCK_FLASH_NWRITE) {
+			mock_flash_nwrite_errors++;
+			return -5;
+		}
+	}
+	for (size_t w = (addr - MOCK_FLASH_BASE) / 4;
+	     len && w <= (addr - MOCK_FLASH_BASE + len - 1) / 4; w++) {
+		mock_flash_word_writes[w]++;
+	}
+	/* NOR programming only clears bits: 0xFF padding leaves bytes as-is */
+	for (size_t i = 0; i < len; i++) {
+		mock_flash_mem[addr - MOCK_FLASH_BASE + i] &= ((const uint8_t *)data)[i];
+	}
+	mock_flash_busy_us += (uint64_t)((len + 3) / 4) * MOCK_FLASH_WORD_US;
 	return 0;
 }
 
@@ -64,6 +96,11 @@ static inline int flash_erase(const struct device *dev, uint32_t addr, size_t si
 		return -1;
 	}
 	memset(&mock_flash_mem[addr - MOCK_FLASH_BASE], 0xFF, size);
+	memset(&mock_flash_word_writes[(addr - MOCK_FLASH_BASE) / 4], 0, size / 4);
+	for (size_t off = 0; off < size; off += MOCK_FLASH_PAGE_SIZE) {
+		mock_flash_page_erases[(addr - MOCK_FLASH_BASE + off) / MOCK_FLASH_PAGE_SIZE]++;
+		mock_flash_busy_us += MOCK_FLASH_ERASE_US;
+	}
 	return 0;
 }
 
@@ -38,18 +38,33 @@ static inline void k_timer_stop(struct k_timer *t)
 
 /* k_work stubs */
 struct k_work { int dummy; };
-struct k_work_delayable { struct k_work work; };
+struct k_work_delayable {
+	struct k_work work;
+	void (*handler)(struct k_work *work);
+};
+
+/* Last item scheduled and not cancelled; tests run it with
+ * mock_work_run_scheduled() (mock_flash.c) */
+extern struct k_work_delayable *mock_work_scheduled;
 
 #define K_WORK_DEFINE(name, handler) \
 	struct k_work name = {0}
 
 #define K_WORK_DELAYABLE_DEFINE(name, fn) \
-	struct k_work_delayable name = { .work = { .dummy = 0 } }
+	struct k_work_delayable name = { .work = { .dummy = 0 }, .handler = fn }
 
 #define K_MSEC(ms) ((uint32_t)(ms))
 #define K_SECONDS(s) ((s) * 1000)
 #define ARG_UNUSED(x) (void)(x)
 
+/* sys/util.h */
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
 static inline int k_work_submit(struct k_work *w)
 {
 	(void)w;
@@ -58,13 +73,16 @@ static inline int k_work_submit(struct k_work *w)
 
 static inline int k_work_schedule(struct k_work_delayable *w, int delay)
 {
-	(void)w; (void)delay;
+	(void)delay;
+	mock_work_scheduled = w;
 	return 0;
 }
 
 static inline int k_work_cancel_delayable(struct k_work_delayable *w)
 {
-	(void)w;
+	if (mock_work_scheduled == w) {
+		mock_work_scheduled = NULL;
+	}
 	return 0;
 }
 